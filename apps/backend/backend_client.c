@@ -88,6 +88,192 @@ ce_find_byid(struct client_entry *ce_list,
     return NULL;
 }
 
+/*! Write as much as possible of a client output queue to its socket
+ * @param[in]  ce  Client entry
+ * @retval     1   Queue drained
+ * @retval     0   Socket buffer full, queue remains (partially)
+ * @retval    -1   Error, errno set (eg EPIPE if client closed)
+ */
+static int
+client_obuf_flush(struct client_entry *ce)
+{
+    ssize_t n;
+
+    while (ce->ce_obpos < ce->ce_oblen){
+        if ((n = send(ce->ce_s, ce->ce_obuf + ce->ce_obpos,
+                      ce->ce_oblen - ce->ce_obpos, MSG_DONTWAIT)) < 0){
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            return -1;
+        }
+        ce->ce_obpos += n;
+    }
+    free(ce->ce_obuf);
+    ce->ce_obuf = NULL;
+    ce->ce_oblen = 0;
+    ce->ce_obpos = 0;
+    return 1;
+}
+
+/*! Writable-socket event callback: drain the client output queue
+ * Registered by client_msg_send() when a message does not fit in the socket
+ * buffer, unregistered when the queue is drained or the client disappears.
+ * @param[in]  s    Socket
+ * @param[in]  arg  Client entry
+ * @retval     0    OK
+ * @retval    -1    Error: terminates backend
+ */
+static int
+client_obuf_cb(int   s,
+               void *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    int                  ret;
+
+    if ((ret = client_obuf_flush(ce)) < 0){
+        switch (errno){
+        case EPIPE:
+        case ECONNRESET:
+            clicon_log(LOG_WARNING, "client %d reset with pending reply", ce->ce_nr);
+            backend_client_rm(ce->ce_handle, ce); /* also unregisters and frees the queue */
+            return 0;
+        default:
+            clicon_err(OE_UNIX, errno, "send");
+            return -1;
+        }
+    }
+    if (ret == 1)
+        clixon_event_unreg_fd_write(s, client_obuf_cb);
+    return 0;
+}
+
+/*! Send a framed message given as two segments, queueing what the socket does not accept
+ * Replaces blocking clicon_msg_send() on the backend side: the part of the
+ * message not accepted by the socket buffer is queued on the client entry and
+ * drained from a writable-fd event, so one session reading slowly cannot stall
+ * the event loop. Framing is kept intact since all output to the client goes
+ * through the queue while it is non-empty.
+ * Taking header and body as separate segments (sent with sendmsg/iovec) lets a
+ * reply body be sent straight out of the cbuf it was assembled in, without
+ * first copying it into a contiguous multi-MB frame.
+ * @param[in]  ce    Client entry
+ * @param[in]  buf0  First segment (frame header, or a whole encoded msg)
+ * @param[in]  len0  Length of first segment
+ * @param[in]  buf1  Second segment (body) or NULL
+ * @param[in]  len1  Length of second segment
+ * @retval     0     OK (sent or queued)
+ * @retval    -1     Error, errno set (eg EPIPE if client closed)
+ */
+static int
+client_send_buf(struct client_entry *ce,
+                char                *buf0,
+                size_t               len0,
+                char                *buf1,
+                size_t               len1)
+{
+    struct msghdr mh = {0,};
+    struct iovec  iov[2];
+    size_t        len = len0 + len1;
+    size_t        n = 0;
+    ssize_t       w;
+    char         *obuf;
+    int           was_empty;
+
+    if (ce->ce_obuf == NULL){ /* Queue empty: write directly */
+        while (n < len){
+            iov[0].iov_base = buf0 + (n < len0 ? n : len0);
+            iov[0].iov_len  = n < len0 ? len0 - n : 0;
+            iov[1].iov_base = buf1 + (n < len0 ? 0 : n - len0);
+            iov[1].iov_len  = n < len0 ? len1 : len - n;
+            mh.msg_iov = iov;
+            mh.msg_iovlen = 2;
+            if ((w = sendmsg(ce->ce_s, &mh, MSG_DONTWAIT)) < 0){
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                return -1;
+            }
+            n += w;
+        }
+        if (n == len)
+            return 0;
+    }
+    /* Append the remainder to the queue */
+    was_empty = (ce->ce_obuf == NULL);
+    if ((obuf = realloc(ce->ce_obuf, ce->ce_oblen + (len - n))) == NULL){
+        clicon_err(OE_UNIX, errno, "realloc");
+        return -1;
+    }
+    if (n < len0){
+        memcpy(obuf + ce->ce_oblen, buf0 + n, len0 - n);
+        if (len1)
+            memcpy(obuf + ce->ce_oblen + (len0 - n), buf1, len1);
+    }
+    else if (len1)
+        memcpy(obuf + ce->ce_oblen, buf1 + (n - len0), len - n);
+    ce->ce_obuf = obuf;
+    ce->ce_oblen += len - n;
+    if (was_empty &&
+        clixon_event_reg_fd_write(ce->ce_s, client_obuf_cb, ce, "client output queue") < 0)
+        return -1;
+    return 0;
+}
+
+/*! Send an encoded clicon msg to a client, via the output queue
+ * @param[in]  ce   Client entry
+ * @param[in]  msg  Encoded clicon msg
+ * @retval     0    OK (sent or queued)
+ * @retval    -1    Error, errno set (eg EPIPE if client closed)
+ */
+static int
+client_msg_send(struct client_entry *ce,
+                struct clicon_msg   *msg)
+{
+    clicon_debug(CLIXON_DBG_MSG, "Send: %s", msg->op_body);
+    return client_send_buf(ce, (char*)msg, ntohl(msg->op_len), NULL, 0);
+}
+
+/*! Send a reply to a client rpc request, via the output queue
+ * The body is sent directly from the caller buffer with only the fixed frame
+ * header assembled here, no contiguous reply frame is built.
+ * @param[in]  ce      Client entry
+ * @param[in]  data    Returned data as byte-string
+ * @param[in]  datalen Length of returned data
+ * @retval     0       OK
+ * @retval    -1       Error, errno set
+ * @see send_msg_reply  blocking variant used by other roles
+ */
+static int
+client_send_reply(struct client_entry *ce,
+                  char                *data,
+                  uint32_t             datalen)
+{
+    struct clicon_msg hdr = {0,};
+    uint32_t          off = 0;
+    uint32_t          seg;
+
+    if (ce->ce_reply != NULL){ /* In-process dispatch: capture instead of send */
+        if (cbuf_append_buf(ce->ce_reply, data, datalen) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            return -1;
+        }
+        return 0;
+    }
+    /* Large bodies go out as chunked segments (reassembled in clicon_msg_rcv)
+     * so the client never needs the total length up front
+     */
+    do {
+        seg = datalen - off;
+        if (seg > CLICON_MSG_CHUNK_SIZE)
+            seg = CLICON_MSG_CHUNK_SIZE;
+        hdr.op_len = htonl((uint32_t)(sizeof(hdr) + seg) |
+                           (off + seg < datalen ? CLICON_MSG_FLAG_MORE : 0));
+        if (client_send_buf(ce, (char*)&hdr, sizeof(hdr), data + off, seg) < 0)
+            return -1;
+        off += seg;
+    } while (off < datalen);
+    return 0;
+}
+
 /*! Stream callback for netconf stream notification (RFC 5277)
  * @param[in]  h     Clicon handle
  * @param[in]  op    0:event, 1:rm
@@ -102,7 +288,10 @@ ce_event_cb(clicon_handle h,
             void         *arg)
 {
     struct client_entry *ce = (struct client_entry *)arg;
-    
+    struct clicon_msg   *msg = NULL;
+    cbuf                *cb = NULL;
+    char                *str;
+
     clicon_debug(1, "%s op:%d", __FUNCTION__, op);
     switch (op){
     case 1:
@@ -111,13 +300,43 @@ ce_event_cb(clicon_handle h,
             backend_client_rm(h, ce);
         break;
     default:
-        if (send_msg_notify_xml(h, ce->ce_s, event) < 0){
+        /* Backpressure: a subscriber that does not read its socket must not grow
+         * its output queue unboundedly, drop the notification instead
+         */
+        if (ce->ce_obuf != NULL &&
+            ce->ce_oblen - ce->ce_obpos >= BACKEND_NOTIFY_QUEUE_MAX){
+            clicon_log(LOG_WARNING, "client %d: output queue full, notification dropped", ce->ce_nr);
+            break;
+        }
+        /* Notifications go through the client output queue (not send_msg_notify_xml)
+         * so they cannot interleave with a partially written reply frame
+         */
+        if ((str = stream_notify_cache_get(h, event)) != NULL){
+            /* Event already serialized once for this fan-out */
+            if ((msg = clicon_msg_encode(0, "%s", str)) == NULL)
+                break;
+        }
+        else {
+            if ((cb = cbuf_new()) == NULL){
+                clicon_err(OE_PLUGIN, errno, "cbuf_new");
+                break;
+            }
+            if (clixon_xml2cbuf(cb, event, 0, 0, -1, 0) < 0)
+                break;
+            if ((msg = clicon_msg_encode(0, "%s", cbuf_get(cb))) == NULL)
+                break;
+        }
+        if (client_msg_send(ce, msg) < 0){
             if (errno == ECONNRESET || errno == EPIPE){
                 clicon_log(LOG_WARNING, "client %d reset", ce->ce_nr);
             }
             break;
         }
     }
+    if (msg)
+        free(msg);
+    if (cb)
+        cbuf_free(cb);
     return 0;
 }
 
@@ -180,6 +399,7 @@ backend_monitoring_state_get(clicon_handle h,
     int                  retval = -1;
     cbuf                *cb = NULL;
     struct client_entry *ce;
+    struct backend_stats bs = {{0,},};
     char                 timestr[28];
     int                  ret;
 
@@ -219,9 +439,33 @@ backend_monitoring_state_get(clicon_handle h,
         cprintf(cb, "<in-bad-rpcs>%u</in-bad-rpcs>", ce->ce_in_bad_rpcs);
         cprintf(cb, "<out-rpc-errors>%u</out-rpc-errors>", ce->ce_out_rpc_errors);
         cprintf(cb, "<out-notifications>%u</out-notifications>", 0);
+        cprintf(cb, "<%s:memory-bytes xmlns:%s=\"%s\">%" PRIu64 "</%s:memory-bytes>",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX, CLIXON_LIB_NS,
+                ce->ce_mem + (uint64_t)(ce->ce_oblen - ce->ce_obpos),
+                CLIXON_LIB_PREFIX);
+        cprintf(cb, "<%s:peak-memory-bytes xmlns:%s=\"%s\">%" PRIu64 "</%s:peak-memory-bytes>",
+                CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX, CLIXON_LIB_NS,
+                ce->ce_mem_peak,
+                CLIXON_LIB_PREFIX);
         cprintf(cb, "</session>");
     }
     cprintf(cb, "</sessions>");
+    /* Global statistics: closed-session totals plus live sessions, aggregated
+     * only here instead of maintained per rpc dispatch */
+    if (backend_stats_get(h, &bs) < 0)
+        goto done;
+    cprintf(cb, "<statistics>");
+    if (time2str(bs.bs_start_time, timestr, sizeof(timestr)) < 0){
+        clicon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    cprintf(cb, "<netconf-start-time>%s</netconf-start-time>", timestr);
+    cprintf(cb, "<in-sessions>%u</in-sessions>", bs.bs_in_sessions);
+    cprintf(cb, "<dropped-sessions>%u</dropped-sessions>", bs.bs_dropped_sessions);
+    cprintf(cb, "<in-rpcs>%u</in-rpcs>", bs.bs_in_rpcs);
+    cprintf(cb, "<in-bad-rpcs>%u</in-bad-rpcs>", bs.bs_in_bad_rpcs);
+    cprintf(cb, "<out-rpc-errors>%u</out-rpc-errors>", bs.bs_out_rpc_errors);
+    cprintf(cb, "</statistics>");
     cprintf(cb, "</netconf-state>");
     if ((ret = clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, xret, xerr)) < 0)
         goto done;
@@ -238,6 +482,53 @@ backend_monitoring_state_get(clicon_handle h,
     goto done;
 }
 
+/*! Map "candidate" to the session's private candidate datastore
+ *
+ * With CLICON_PRIVATE_CANDIDATE set, each session edits its own candidate,
+ * forked lazily from running on first reference (a cheap pointer share in
+ * copy-on-write cache mode, see xmldb_copy). The running serial at fork time
+ * is recorded for the optimistic conflict check in candidate_commit().
+ * Any other datastore name, or the option unset, passes through unchanged.
+ * @param[in]  h   Clicon handle
+ * @param[in]  ce  Client entry
+ * @param[in]  db  Datastore name as given by the client, can be NULL
+ * @retval     db  Effective datastore name
+ * @retval     NULL Error forking private candidate, clicon_err called
+ */
+char *
+client_candidate(clicon_handle        h,
+                 struct client_entry *ce,
+                 char                *db)
+{
+    cbuf *cb = NULL;
+
+    if (db == NULL || strcmp(db, "candidate") != 0)
+        return db;
+    if (!clicon_option_bool(h, "CLICON_PRIVATE_CANDIDATE"))
+        return db;
+    if (ce->ce_candidate == NULL){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            return NULL;
+        }
+        cprintf(cb, "candidate-%u", ce->ce_id);
+        if ((ce->ce_candidate = strdup(cbuf_get(cb))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            cbuf_free(cb);
+            return NULL;
+        }
+        cbuf_free(cb);
+        if (xmldb_copy(h, "running", ce->ce_candidate) < 0)
+            return NULL;
+        if (xmldb_modified_set(h, ce->ce_candidate, 0) < 0)
+            return NULL;
+        if (xmldb_base_serial_set(h, ce->ce_candidate,
+                                  xmldb_serial_get(h, "running")) < 0)
+            return NULL;
+    }
+    return ce->ce_candidate;
+}
+
 /*! Remove client entry state
  * Close down everything wrt clients (eg sockets, subscriptions)
  * Finally actually remove client struct in handle
@@ -291,10 +582,21 @@ backend_client_rm(clicon_handle        h,
         if (c == ce){
             if (ce->ce_s){
                 clixon_event_unreg_fd(ce->ce_s, from_client);
+                if (ce->ce_obuf){
+                    clixon_event_unreg_fd_write(ce->ce_s, client_obuf_cb);
+                    free(ce->ce_obuf);
+                    ce->ce_obuf = NULL;
+                    ce->ce_oblen = 0;
+                    ce->ce_obpos = 0;
+                }
                 close(ce->ce_s);
                 ce->ce_s = 0;
                 if (release_all_dbs(h, ce->ce_id) < 0)
                     return -1;
+                /* Uncommitted private candidate changes are discarded with the session */
+                if (ce->ce_candidate &&
+                    xmldb_delete(h, ce->ce_candidate) < 0)
+                    return -1;
             }
             break;
         }
@@ -318,36 +620,8 @@ clixon_stats_datastore_get(clicon_handle h,
                            char         *dbname,
                            cbuf         *cb)
 {
-    int       retval = -1;
-    cxobj    *xt = NULL;
-    uint64_t  nr = 0;
-    size_t    sz = 0;
-    cxobj    *xn = NULL;
-    
-    /* This is the db cache */
-
-    if ((xt = xmldb_cache_get(h, dbname)) == NULL){
-        /* Trigger cache if no exist */
-        if (xmldb_get(h, dbname, NULL, "/", &xn) < 0)
-            goto done;
-        xt = xmldb_cache_get(h, dbname);
-    }
-    if (xt == NULL){
-        cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name><nr>0</nr><size>0</size></datastore>",
-                CLIXON_LIB_NS, dbname);
-    }
-    else{
-        if (xml_stats(xt, &nr, &sz) < 0)
-            goto done;
-        cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name><nr>%" PRIu64 "</nr>"
-                "<size>%zu</size></datastore>",
-                CLIXON_LIB_NS, dbname, nr, sz);
-    }
-    retval = 0;
- done:
-    if (xn)
-        xml_free(xn);
-    return retval;
+    /* Incrementally maintained per-module counters, no full tree walk */
+    return xmldb_modstats_get(h, dbname, cb);
 }
 
 /*! Get clixon per datastore stats
@@ -446,6 +720,11 @@ from_client_edit_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((target = client_candidate(h, ce, target)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -482,6 +761,21 @@ from_client_edit_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    /* RFC 5717: deny if an edited top-level subtree overlaps a partial lock
+     * held by another session, see xmldb_plock() */
+    x = NULL;
+    while ((x = xml_child_each(xc, x, CX_ELMNT)) != NULL){
+        cbuf_reset(cbx);
+        cprintf(cbx, "/%s", xml_name(x));
+        if ((iddb = xmldb_plock_conflict(h, target, myid, cbuf_get(cbx))) != 0){
+            cbuf_reset(cbx);
+            cprintf(cbx, "Operation failed, subtree /%s is partially locked by session %u",
+                    xml_name(x), iddb);
+            if (netconf_in_use(cbret, "protocol", cbuf_get(cbx)) < 0)
+                goto done;
+            goto ok;
+        }
+    }
     /* <config> yang spec may be set to anyxml by ingress yang check,...*/
     if (xml_spec(xc) != NULL)
         xml_spec_set(xc, NULL);
@@ -525,6 +819,9 @@ from_client_edit_config(clicon_handle h,
      */
     if (xml_sort_recurse(xc) < 0)
         goto done;
+    /* The request tree is discarded after the edit: let xmldb_put move leaf
+     * values out of it instead of copying, see XML_FLAG_STEAL */
+    xml_flag_set(xc, XML_FLAG_STEAL);
     if ((ret = xmldb_put(h, target, operation, xc, username, cbret)) < 0){
         if (netconf_operation_failed(cbret, "protocol", clicon_err_reason)< 0)
             goto done;
@@ -567,14 +864,14 @@ from_client_edit_config(clicon_handle h,
                 break;
             }
         }
-        if ((ret = candidate_commit(h, NULL, "candidate", myid, VL_FULL, cbret)) < 0){ /* Assume validation fail, nofatal */
+        if ((ret = candidate_commit(h, NULL, target, myid, VL_FULL, cbret)) < 0){ /* Assume validation fail, nofatal */
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                 goto done;
-            xmldb_copy(h, "running", "candidate");
+            xmldb_copy(h, "running", target);
             goto ok;
         }
         if (ret == 0){ /* discard */
-            if (xmldb_copy(h, "running", "candidate") < 0){
+            if (xmldb_copy(h, "running", target) < 0){
                 if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                     goto done;
                 goto ok;
@@ -659,6 +956,11 @@ from_client_copy_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((source = client_candidate(h, ce, source)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     if ((target = netconf_db_find(xe, "target")) == NULL){
         if (netconf_missing_element(cbret, "protocol", "target", NULL) < 0)
             goto done;
@@ -670,6 +972,11 @@ from_client_copy_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((target = client_candidate(h, ce, target)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -741,6 +1048,11 @@ from_client_delete_config(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((target = client_candidate(h, ce, target)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     /* Check if target locked by other client */
     iddb = xmldb_islocked(h, target);
     if (iddb && myid != iddb){
@@ -826,6 +1138,11 @@ from_client_lock(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((db = client_candidate(h, ce, db)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     /*
      * A lock MUST not be granted if either of the following conditions is true:
      * 1) A lock is already held by any NETCONF session or another entity.
@@ -836,10 +1153,18 @@ from_client_lock(clicon_handle h,
             goto done;
         goto ok;
     }
-    /* 2) The target configuration is <candidate>, it has already been modified, and 
+    /* RFC 5717: a whole-db lock must not be granted if any partial lock is
+     * held by another session */
+    if ((iddb = xmldb_plock_conflict(h, db, id, "/")) != 0){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, a partial lock is held by another session") < 0)
+            goto done;
+        goto ok;
+    }
+    /* 2) The target configuration is <candidate>, it has already been modified, and
      *    these changes have not been committed or rolled back.
      */
-    if (strcmp(db, "candidate") == 0 &&
+    if (strncmp(db, "candidate", strlen("candidate")) == 0 && /* shared or private, see client_candidate */
         xmldb_modified_get(h, db)){
         if (netconf_lock_denied(cbret, "<session-id>0</session-id>",
                                 "Operation failed, candidate has already been modified and the changes have not been committed or rolled back (RFC 6241 7.5)") < 0)
@@ -913,8 +1238,13 @@ from_client_unlock(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((db = client_candidate(h, ce, db)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     iddb = xmldb_islocked(h, db);
-    /* 
+    /*
      * An unlock operation will not succeed if any of the following
      * conditions are true:
      * 1) the specified lock is not currently active
@@ -950,6 +1280,151 @@ from_client_unlock(clicon_handle h,
     return retval;
 }
 
+/*! Lock parts of the running datastore, RFC 5717
+ * The scope of the lock is the union of the given select expressions, allowing
+ * sessions editing disjoint subtrees to work concurrently, see xmldb_plock()
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_partial_lock(clicon_handle h,
+                         cxobj        *xe,
+                         cbuf         *cbret,
+                         void         *arg,
+                         void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t             id = ce->ce_id;
+    uint32_t             iddb = 0;
+    uint32_t             lockid = 0;
+    cvec                *selects = NULL;
+    cg_var              *cv;
+    cxobj               *x;
+    char                *body;
+    cbuf                *cbx = NULL; /* Assist cbuf */
+    int                  ret;
+
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((selects = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    x = NULL;
+    while ((x = xml_child_each(xe, x, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(x), "select") != 0)
+            continue;
+        if ((body = xml_body(x)) == NULL || strlen(body) == 0){
+            if (netconf_invalid_value(cbret, "protocol", "select is empty") < 0)
+                goto done;
+            goto ok;
+        }
+        if (cvec_add_string(selects, NULL, body) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    }
+    if (cvec_len(selects) == 0){
+        if (netconf_missing_element(cbret, "protocol", "select", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    /* RFC 5717 Sec 2: the target of partial-lock is always running */
+    if ((ret = xmldb_plock(h, "running", id, selects, &lockid, &iddb)) < 0)
+        goto done;
+    if (ret == 0){
+        cprintf(cbx, "<session-id>%u</session-id>", iddb);
+        if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, a conflicting lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<lock-id xmlns=\"%s\">%u</lock-id>", NETCONF_PARTIAL_LOCK_NAMESPACE, lockid);
+    cv = NULL;
+    while ((cv = cvec_each(selects, cv)) != NULL){
+        cprintf(cbret, "<locked-node xmlns=\"%s\">", NETCONF_PARTIAL_LOCK_NAMESPACE);
+        if (xml_chardata_cbuf_append(cbret, cv_string_get(cv)) < 0)
+            goto done;
+        cprintf(cbret, "</locked-node>");
+    }
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (selects)
+        cvec_free(selects);
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
+
+/*! Release a partial lock previously obtained with partial-lock, RFC 5717
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_partial_unlock(clicon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t             id = ce->ce_id;
+    uint32_t             iddb = 0;
+    uint32_t             lockid = 0;
+    char                *lockstr;
+    cbuf                *cbx = NULL; /* Assist cbuf */
+    int                  ret;
+
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((lockstr = xml_find_body(xe, "lock-id")) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "lock-id", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = netconf_parse_uint32("lock-id", lockstr, NULL, 0, cbret, &lockid)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    if ((ret = xmldb_punlock(h, "running", id, lockid, &iddb)) < 0)
+        goto done;
+    if (ret == 0){
+        if (iddb != 0){
+            cprintf(cbx, "<session-id>%u</session-id>", iddb);
+            if (netconf_lock_denied(cbret, cbuf_get(cbx), "Unlock failed, lock held by other session") < 0)
+                goto done;
+        }
+        else if (netconf_invalid_value(cbret, "protocol", "Unlock failed, no such lock-id") < 0)
+            goto done;
+        goto ok;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    if (cbx)
+        cbuf_free(cbx);
+    return retval;
+}
+
 /*! Request graceful termination of a NETCONF session.
  * @param[in]  h       Clicon handle 
  * @param[in]  xe      Request: <rpc><xn></rpc> 
@@ -972,6 +1447,7 @@ from_client_close_session(clicon_handle h,
     if (release_all_dbs(h, id) < 0)
         return -1;
     stream_ss_delete_all(h, ce_event_cb, (void*)ce);
+    ce->ce_graceful = 1; /* Not a dropped session, see backend_stats_get */
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
     return 0;
 }
@@ -1160,9 +1636,7 @@ from_client_get_schema(clicon_handle h,
     yang_stmt  *ymod;
     yang_stmt  *ymatch;
     yang_stmt  *yrev;
-    cbuf       *cbyang = NULL;
     cbuf       *cbmsg = NULL;
-    const char *filename;    
 
     if ((yspec =  clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_YANG, ENOENT, "No yang spec");
@@ -1233,29 +1707,22 @@ from_client_get_schema(clicon_handle h,
     }
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><data xmlns=\"%s\">",
             NETCONF_BASE_NAMESPACE, NETCONF_MONITORING_NAMESPACE);
-    if ((cbyang = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
+    /* Escaped schema content is cached per file, a controller refetching all
+     * schemas on reconnect is served from memory */
+    if (netconf_schema_content(h, ymatch, cbret) < 0)
         goto done;
-    }
-    if ((filename = yang_filename_get(ymatch)) != NULL){
-        if (clicon_file_cbuf(filename, cbyang) < 0)
-            goto done;
-    }
-    xml_chardata_cbuf_append(cbret, cbuf_get(cbyang));
     cprintf(cbret, "</data></rpc-reply>");
  ok:
     retval = 0;
  done:
     if (cbmsg)
         cbuf_free(cbmsg);
-    if (cbyang)
-        cbuf_free(cbyang);
     if (nsc)
         xml_nsctx_free(nsc);
     return retval;
 }
 
-/*! Set debug level. 
+/*! Set debug level.
  * @param[in]  h       Clicon handle 
  * @param[in]  xe      Request: <rpc><xn></rpc> 
  * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
@@ -1312,12 +1779,74 @@ from_client_ping(clicon_handle h,
     return 0;
 }
 
+/*! Explain an xpath: parsed plan, fastpath eligibility and measured evaluation
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xpath_explain  which produces the report
+ */
+static int
+from_client_xpath_explain(clicon_handle h,
+                          cxobj        *xe,
+                          cbuf         *cbret,
+                          void         *arg,
+                          void         *regarg)
+{
+    int        retval = -1;
+    char      *xpath;
+    char      *db = "running";
+    char      *str;
+    yang_stmt *yspec;
+    cvec      *nsc;          /* canonical, borrowed from yspec: do not free */
+    cxobj     *xret = NULL;
+    cbuf      *cb = NULL;
+
+    if ((xpath = xml_find_body(xe, "xpath")) == NULL){
+        if (netconf_missing_element(cbret, "application", "xpath", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((str = xml_find_body(xe, "db")) != NULL)
+        db = str;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((nsc = xml_nsctx_yangspec_canonical(yspec)) == NULL)
+        goto done;
+    if (xmldb_get(h, db, nsc, "/", &xret) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (xpath_explain(xret, nsc, xpath, cb) < 0)
+        goto done;
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\"><explain xmlns=\"%s\">",
+            NETCONF_BASE_NAMESPACE, CLIXON_LIB_NS);
+    if (xml_chardata_cbuf_append(cbret, cbuf_get(cb)) < 0)
+        goto done;
+    cprintf(cbret, "</explain></rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
 /*! Check liveness of backend daemon,  just send a reply
- * @param[in]  h       Clicon handle 
- * @param[in]  xe      Request: <rpc><xn></rpc> 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
  * @param[in]  arg     client-entry
- * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @param[in]  regarg  User argument given at rpc_callback_register()
  * @retval     0       OK
  * @retval    -1       Error
  */
@@ -1359,22 +1888,126 @@ from_client_stats(clicon_handle h,
             goto done;
     }
     ym = NULL;
-    while ((ym = yn_each(clicon_nacm_ext_yang(h), ym)) != NULL) {    
+    while ((ym = yn_each(clicon_nacm_ext_yang(h), ym)) != NULL) {
         if (clixon_stats_module_get(h, ym, cbret) < 0)
             goto done;
     }
+    if (clixon_rpc_stats_get(h, cbret) < 0)
+        goto done;
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
     return retval;
 }
 
+/*! Get write serial of a datastore, so clients can detect change without reading content
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xmldb_serial_get
+ */
+static int
+from_client_datastore_serial(clicon_handle h,
+                             cxobj        *xe,
+                             cbuf         *cbret,
+                             void         *arg,
+                             void         *regarg)
+{
+    int   retval = -1;
+    char *db;
+
+    if ((db = xml_find_body(xe, "db")) == NULL){
+        if (netconf_missing_element(cbret, "application", "db", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<serial xmlns=\"%s\">%" PRIu32 "</serial>", CLIXON_LIB_NS,
+            xmldb_serial_get(h, db));
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Compute difference between two datastores server-side, return only the delta
+ *
+ * The diff runs against the cached trees and the reply holds the differing
+ * subtrees plus their ancestor context, so transfer is proportional to the
+ * change, see xmldb_diff.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+from_client_datastore_diff(clicon_handle h,
+                           cxobj        *xe,
+                           cbuf         *cbret,
+                           void         *arg,
+                           void         *regarg)
+{
+    int    retval = -1;
+    char  *db1;
+    char  *db2;
+    cxobj *xd1 = NULL;
+    cxobj *xd2 = NULL;
+    cxobj *xerr = NULL;
+    int    ret;
+
+    if ((db1 = xml_find_body(xe, "source")) == NULL){
+        if (netconf_missing_element(cbret, "application", "source", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((db2 = xml_find_body(xe, "target")) == NULL){
+        if (netconf_missing_element(cbret, "application", "target", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = xmldb_diff(h, db1, db2, &xd1, &xd2, &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    cprintf(cbret, "<source xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clixon_xml2cbuf(cbret, xd1, 0, 0, -1, 1) < 0)
+        goto done;
+    cprintf(cbret, "</source>");
+    cprintf(cbret, "<target xmlns=\"%s\">", CLIXON_LIB_NS);
+    if (clixon_xml2cbuf(cbret, xd2, 0, 0, -1, 1) < 0)
+        goto done;
+    cprintf(cbret, "</target>");
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    if (xd1)
+        xml_free(xd1);
+    if (xd2)
+        xml_free(xd2);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
 /*! Request restart of specific plugins
- * @param[in]  h       Clicon handle 
- * @param[in]  xe      Request: <rpc><xn></rpc> 
- * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error.. 
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
  * @param[in]  arg     client-entry
- * @param[in]  regarg  User argument given at rpc_callback_register() 
+ * @param[in]  regarg  User argument given at rpc_callback_register()
  * @retval     0       OK
  * @retval    -1       Error
  */
@@ -1531,8 +2164,10 @@ from_client_msg(clicon_handle        h,
     char                *rpcprefix;
     char                *namespace = NULL;
     int                  nr = 0;
-    
+    struct timespec      tspan;
+
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    clock_gettime(CLOCK_MONOTONIC, &tspan);
     yspec = clicon_dbspec_yang(h); 
     /* Return netconf message. Should be filled in by the dispatch(sub) functions 
      * as wither rpc-error or by positive response.
@@ -1541,10 +2176,14 @@ from_client_msg(clicon_handle        h,
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
-    /* Decode msg from client -> xml top (ct) and session id 
+    clixon_rpc_stats_start(h, NULL);
+    /* Decode msg from client -> xml top (ct) and session id
      * Bind is a part of the decode function
      */
-    if ((ret = clicon_msg_decode(msg, yspec, &op_id, &xt, &xret)) < 0){
+    clixon_rpc_stats_stage_begin(h, RPC_STATS_PARSE);
+    ret = clicon_msg_decode(msg, yspec, &op_id, &xt, &xret);
+    clixon_rpc_stats_stage_end(h, RPC_STATS_PARSE);
+    if (ret < 0){
         if (netconf_malformed_message(cbret, "XML parse error") < 0)
             goto done;
         goto reply;
@@ -1607,6 +2246,7 @@ from_client_msg(clicon_handle        h,
         ce->ce_in_rpcs++; /* Track all RPCs */
     }
     else if (strcmp(rpcname, "hello") == 0){
+        clixon_rpc_stats_name(h, rpcname);
         if ((ret = from_client_hello(h, x, ce, cbret)) <0)
             goto done;
         goto reply;
@@ -1635,8 +2275,11 @@ from_client_msg(clicon_handle        h,
     username = xml_find_value(x, "username");
     /* May be used by callbacks, etc */
     clicon_username_set(h, username);
+    /* Adopt a trace context propagated by the frontend, or sample locally */
+    clixon_trace_start(h, xml_find_value(x, "trace"));
     while ((xe = xml_child_each(x, xe, CX_ELMNT)) != NULL) {
         rpc = xml_name(xe);
+        clixon_rpc_stats_name(h, rpc);
         if ((ye = xml_spec(xe)) == NULL){
             if (netconf_operation_not_supported(cbret, "protocol", rpc) < 0)
                 goto done;
@@ -1657,6 +2300,7 @@ from_client_msg(clicon_handle        h,
          * 1: Permit, skip NACM
          * Therefore, xnacm=NULL means no NACM checks needed.
          */
+        clixon_rpc_stats_stage_begin(h, RPC_STATS_NACM);
         if ((ret = nacm_access_pre(h, ce->ce_username, username, &xnacm)) < 0)
             goto done;
         /* Cache XML NACM tree here. Use with caution, only valid on from_client_msg stack 
@@ -1679,8 +2323,12 @@ from_client_msg(clicon_handle        h,
                 goto reply;
             }
         }
+        clixon_rpc_stats_stage_end(h, RPC_STATS_NACM);
         clicon_err_reset();
-        if ((ret = rpc_callback_call(h, xe, ce, &nr, cbret)) < 0){
+        clixon_rpc_stats_stage_begin(h, RPC_STATS_PLUGIN);
+        ret = rpc_callback_call(h, xe, ce, &nr, cbret);
+        clixon_rpc_stats_stage_end(h, RPC_STATS_PLUGIN);
+        if (ret < 0){
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
                 goto done;
             clicon_log(LOG_NOTICE, "%s Error in rpc_callback_call:%s", __FUNCTION__, xml_name(xe));
@@ -1709,15 +2357,16 @@ from_client_msg(clicon_handle        h,
         if (netconf_operation_failed(cbret, "application", clicon_errno?clicon_err_reason:"unknown")< 0)
             goto done;
     // XXX    clicon_debug(CLIXON_DBG_MSG, "Reply:%s", cbuf_get(cbret));
-    /* XXX problem here is that cbret has not been parsed so may contain 
+    /* XXX problem here is that cbret has not been parsed so may contain
        parse errors */
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
+    clixon_rpc_stats_stage_begin(h, RPC_STATS_SERIALIZE);
+    if (client_send_reply(ce, cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
         switch (errno){
         case EPIPE:
-            /* man (2) write: 
-             * EPIPE  fd is connected to a pipe or socket whose reading end is 
-             * closed.  When this happens the writing process will also receive 
-             * a SIGPIPE signal. 
+            /* man (2) write:
+             * EPIPE  fd is connected to a pipe or socket whose reading end is
+             * closed.  When this happens the writing process will also receive
+             * a SIGPIPE signal.
              * In Clixon this means a client, eg restconf, netconf or cli closes
              * the (UNIX domain) socket.
              */
@@ -1728,6 +2377,10 @@ from_client_msg(clicon_handle        h,
             goto done;
         }
     }
+    clixon_rpc_stats_stage_end(h, RPC_STATS_SERIALIZE);
+    clixon_rpc_stats_done(h);
+    clixon_trace_span(h, "backend.rpc", &tspan);
+    clixon_trace_stop(h);
     // ok:
     retval = 0;
   done:  
@@ -1751,6 +2404,86 @@ from_client_msg(clicon_handle        h,
     return retval;// -1 here terminates backend
 }
 
+/*! Dispatch an rpc from a co-located (in-process) frontend, bypassing the IPC socket
+ *
+ * Registered as clicon_rpc dispatcher by backend_client_dispatch_init. The encoded
+ * request is handed straight to from_client_msg with the same session and NACM
+ * semantics as a socket client, but the reply is captured from the client entry
+ * (see client_send_reply) instead of being framed and written to a socket.
+ * @param[in]  h        Clicon handle
+ * @param[in]  msg      Encoded request message
+ * @param[in]  arg      Client entry of the in-process session
+ * @param[out] retdata  Reply as malloc:ed string, free by caller
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see clicon_rpc_dispatch_register
+ */
+static int
+backend_client_dispatch(clicon_handle      h,
+                        struct clicon_msg *msg,
+                        void              *arg,
+                        char             **retdata)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+
+    if ((ce->ce_reply = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (from_client_msg(h, ce, msg) < 0)
+        goto done;
+    if ((*retdata = strdup(cbuf_get(ce->ce_reply))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (ce->ce_reply){
+        cbuf_free(ce->ce_reply);
+        ce->ce_reply = NULL;
+    }
+    return retval;
+}
+
+/*! Create the in-process client session and register the rpc dispatcher
+ *
+ * Rpc:s made from within the backend process itself (eg backend plugins using
+ * the clicon_rpc_* functions) are dispatched as direct function calls into
+ * from_client_msg instead of traversing serialize-socket-parse via CLICON_SOCK.
+ * Besides removing the IPC round-trip, such calls would deadlock the
+ * single-threaded backend waiting for its own reply if made over the socket.
+ * All in-process callers share one client entry, credentialed as the backend
+ * process owner like a unix socket peer.
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+backend_client_dispatch_init(clicon_handle h)
+{
+    int                  retval = -1;
+    struct sockaddr      addr = {0,};
+    struct client_entry *ce;
+    char                *name = NULL;
+
+    addr.sa_family = AF_UNIX;
+    if ((ce = backend_client_add(h, &addr)) == NULL)
+        goto done;
+    /* Same credentials as a unix socket peer: the backend process owner */
+    if (uid2name(geteuid(), &name) < 0)
+        goto done;
+    ce->ce_username = name;
+    name = NULL;
+    if (clicon_rpc_dispatch_register(h, backend_client_dispatch, ce) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (name)
+        free(name);
+    return retval;
+}
+
 /*! An internal clicon message has arrived from a client. Receive and dispatch.
  * @param[in]   s    Socket where message arrived. read from this.
  * @param[in]   arg  Client entry (from).
@@ -1776,7 +2509,13 @@ from_client(int   s,
     if (clicon_msg_rcv(ce->ce_s, &msg, &eof) < 0)
         goto done;
     if (eof)
-        backend_client_rm(h, ce); 
+        backend_client_rm(h, ce);
+    else if ((ntohl(msg->op_len) & CLICON_MSG_LEN_MASK) - sizeof(*msg) == sizeof(CLICON_MSG_PING_BODY) &&
+             memcmp(msg->op_body, CLICON_MSG_PING_BODY, sizeof(CLICON_MSG_PING_BODY)) == 0){
+        /* Liveness probe, answered before any XML parsing, see clicon_rpc_ping */
+        if (client_send_reply(ce, CLICON_MSG_PONG_BODY, sizeof(CLICON_MSG_PONG_BODY)) < 0)
+            goto done;
+    }
     else
         if (from_client_msg(h, ce, msg) < 0)
             goto done;
@@ -1818,6 +2557,13 @@ backend_rpc_init(clicon_handle h)
     if (rpc_callback_register(h, from_client_unlock, NULL,
                       NETCONF_BASE_NAMESPACE, "unlock") < 0)
         goto done;
+    /* RFC 5717 partial locks */
+    if (rpc_callback_register(h, from_client_partial_lock, NULL,
+                      NETCONF_PARTIAL_LOCK_NAMESPACE, "partial-lock") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_partial_unlock, NULL,
+                      NETCONF_PARTIAL_LOCK_NAMESPACE, "partial-unlock") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_get, NULL,
                       NETCONF_BASE_NAMESPACE, "get") < 0)
         goto done;
@@ -1863,6 +2609,24 @@ backend_rpc_init(clicon_handle h)
     if (rpc_callback_register(h, from_client_stats, NULL,
                               CLIXON_LIB_NS, "stats") < 0)
         goto done;
+    if (rpc_callback_register(h, from_client_xpath_explain, NULL,
+                              CLIXON_LIB_NS, "xpath-explain") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_serial, NULL,
+                              CLIXON_LIB_NS, "datastore-serial") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_datastore_diff, NULL,
+                              CLIXON_LIB_NS, "datastore-diff") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_get_batch, NULL,
+                              CLIXON_LIB_NS, "get-batch") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_commit_queue, NULL,
+                              CLIXON_LIB_NS, "commit-queue") < 0)
+        goto done;
+    if (rpc_callback_register(h, from_client_rollback, NULL,
+                              CLIXON_LIB_NS, "rollback") < 0)
+        goto done;
     if (rpc_callback_register(h, from_client_restart_plugin, NULL,
                               CLIXON_LIB_NS, "restart-plugin") < 0)
         goto done;
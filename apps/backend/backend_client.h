@@ -59,17 +59,34 @@ struct client_entry{
                                            netconf-monitoring state */
     char                 *ce_source_host; /* Host identifier of the NETCONF client */
     struct timeval        ce_time;    /* Time at the server at which the session was established. */
+    int                   ce_graceful; /* Session ended with close-session: not counted in
+                                          dropped-sessions, see backend_stats_get */
     uint32_t              ce_in_rpcs ;       /* Number of correct <rpc> messages received. */
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
+    char                 *ce_obuf;   /* Queued output not yet accepted by the socket, so that a
+                                        client slow to read a large reply does not block the
+                                        single-threaded backend for all other sessions */
+    size_t                ce_oblen;  /* Total bytes in ce_obuf */
+    size_t                ce_obpos;  /* Bytes of ce_obuf already written to the socket */
+    uint64_t              ce_mem;    /* Bytes of reply trees currently held on behalf of this
+                                        session, see CLICON_SESSION_MEMORY_BUDGET */
+    uint64_t              ce_mem_peak; /* High-water mark of ce_mem plus queued output */
+    cbuf                 *ce_reply;  /* In-process dispatch: capture the rpc reply here instead
+                                        of writing it to the socket, see backend_client_dispatch */
+    char                 *ce_candidate; /* Name of this session's private candidate datastore,
+                                        forked lazily from running, NULL if none,
+                                        see CLICON_PRIVATE_CANDIDATE / client_candidate() */
 };
 
 /*
  * Prototypes
  */ 
 int backend_monitoring_state_get(clicon_handle h, yang_stmt *yspec, char *xpath, cvec *nsc, cxobj **xret, cxobj **xerr);
+char *client_candidate(clicon_handle h, struct client_entry *ce, char *db);
 int backend_client_rm(clicon_handle h, struct client_entry *ce);
 int from_client(int fd, void *arg);
+int backend_client_dispatch_init(clicon_handle h);
 int backend_rpc_init(clicon_handle h);
 
 #endif  /* _BACKEND_CLIENT_H_ */
@@ -100,11 +100,31 @@ generic_validate(clicon_handle       h,
     int        ret;
     cbuf      *cb = NULL;
 
-    /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
-        goto done;
-    if (ret == 0)
-        goto fail;
+    /* All entries. If the incremental option is set validate only the subtrees
+     * the diff touched plus the constraints on their ancestor axis. Deletions
+     * force the full pass since an untouched leafref elsewhere may reference a
+     * deleted node. */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL") &&
+        td->td_dlen == 0){
+        for (i=0; i<td->td_alen; i++){
+            if ((ret = xml_yang_validate_subtree(h, td->td_avec[i], xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        for (i=0; i<td->td_clen; i++){
+            if ((ret = xml_yang_validate_subtree(h, td->td_tcvec[i], xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+    }
+    else{
+        if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0) 
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
     /* changed entries */
     for (i=0; i<td->td_clen; i++){
         x2 = td->td_tcvec[i]; /* target changed */
@@ -133,6 +153,173 @@ generic_validate(clicon_handle       h,
     goto done;
 }
 
+/*
+ * Startup fast-boot
+ * A stamp file next to the datastore records a content hash of the db file
+ * and a hash of the loaded module set, written after a successful startup
+ * validation+commit. If both match on the next boot, the stored verdict is
+ * trusted and generic YANG validation is skipped; plugins still get the full
+ * transaction. Gated on CLICON_STARTUP_FASTBOOT, default disabled.
+ */
+#define FASTBOOT_STAMP_SUFFIX ".fastboot"
+
+/*! FNV-1a over a byte buffer, chainable via fnv
+ */
+static uint64_t
+fastboot_hash_buf(uint64_t    fnv,
+                  const char *buf,
+                  size_t      len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++){
+        fnv ^= (uint8_t)buf[i];
+        fnv *= 0x100000001b3ULL;
+    }
+    return fnv;
+}
+
+/*! Compute content hash of db file and hash of loaded module set
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Datastore name
+ * @param[out] chash  Content hash of datastore file
+ * @param[out] shash  Hash of module names and revisions of loaded yspec
+ * @retval     0      OK
+ * @retval    -1      Error (including datastore file not readable)
+ */
+static int
+fastboot_hashes(clicon_handle h,
+                const char   *db,
+                uint64_t     *chash,
+                uint64_t     *shash)
+{
+    int        retval = -1;
+    char      *filename = NULL;
+    FILE      *fp = NULL;
+    char       buf[BUFSIZ];
+    size_t     len;
+    uint64_t   fnv = 0xcbf29ce484222325ULL;
+    yang_stmt *yspec;
+    yang_stmt *ym = NULL;
+    yang_stmt *yrev;
+    char      *s;
+
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((fp = fopen(filename, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        fnv = fastboot_hash_buf(fnv, buf, len);
+    if (ferror(fp)){
+        clicon_err(OE_UNIX, errno, "fread(%s)", filename);
+        goto done;
+    }
+    *chash = fnv;
+    /* Module set: names and revisions of all loaded modules */
+    fnv = 0xcbf29ce484222325ULL;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, 0, "Yang spec not set");
+        goto done;
+    }
+    while ((ym = yn_each(yspec, ym)) != NULL){
+        if ((s = yang_argument_get(ym)) != NULL)
+            fnv = fastboot_hash_buf(fnv, s, strlen(s)+1);
+        if ((yrev = yang_find(ym, Y_REVISION, NULL)) != NULL &&
+            (s = yang_argument_get(yrev)) != NULL)
+            fnv = fastboot_hash_buf(fnv, s, strlen(s)+1);
+    }
+    *shash = fnv;
+    retval = 0;
+ done:
+    if (fp)
+        fclose(fp);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Check if db content and schema match the recorded fast-boot stamp
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Datastore name
+ * @retval     1   Stamp matches: db was validated with this schema before
+ * @retval     0   No stamp / no match / fast-boot disabled
+ * @retval    -1   Error
+ */
+static int
+startup_fastboot_match(clicon_handle h,
+                       const char   *db)
+{
+    int      retval = -1;
+    char    *filename = NULL;
+    char     stampfile[MAXPATHLEN];
+    FILE    *fp = NULL;
+    uint64_t chash;
+    uint64_t shash;
+    unsigned long long c0;
+    unsigned long long s0;
+
+    if (!clicon_option_bool(h, "CLICON_STARTUP_FASTBOOT"))
+        goto nomatch;
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    snprintf(stampfile, sizeof(stampfile), "%s%s", filename, FASTBOOT_STAMP_SUFFIX);
+    if ((fp = fopen(stampfile, "r")) == NULL)
+        goto nomatch; /* No stamp: full validation */
+    if (fscanf(fp, "%llx %llx", &c0, &s0) != 2)
+        goto nomatch;
+    if (fastboot_hashes(h, db, &chash, &shash) < 0)
+        goto done;
+    if (chash != (uint64_t)c0 || shash != (uint64_t)s0)
+        goto nomatch;
+    retval = 1;
+ done:
+    if (fp)
+        fclose(fp);
+    if (filename)
+        free(filename);
+    return retval;
+ nomatch:
+    retval = 0;
+    goto done;
+}
+
+/*! Record fast-boot stamp after successful validation+commit of db
+ * Errors are logged, not fatal: a missing stamp only costs a full validation.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Datastore name
+ * @retval     0   OK
+ */
+static int
+startup_fastboot_record(clicon_handle h,
+                        const char   *db)
+{
+    char    *filename = NULL;
+    char     stampfile[MAXPATHLEN];
+    FILE    *fp = NULL;
+    uint64_t chash;
+    uint64_t shash;
+
+    if (!clicon_option_bool(h, "CLICON_STARTUP_FASTBOOT"))
+        return 0;
+    if (xmldb_db2file(h, db, &filename) < 0)
+        return 0;
+    snprintf(stampfile, sizeof(stampfile), "%s%s", filename, FASTBOOT_STAMP_SUFFIX);
+    if (fastboot_hashes(h, db, &chash, &shash) < 0 ||
+        (fp = fopen(stampfile, "w")) == NULL){
+        clicon_log(LOG_WARNING, "%s: could not write %s: %s",
+                   __FUNCTION__, stampfile, strerror(errno));
+        free(filename);
+        return 0;
+    }
+    fprintf(fp, "%llx %llx\n",
+            (unsigned long long)chash, (unsigned long long)shash);
+    fclose(fp);
+    free(filename);
+    return 0;
+}
+
 /*! Common startup validation
  * Get db, upgrade it w potential transformed XML, populate it w yang spec,
  * sort it, validate it by triggering a transaction
@@ -298,14 +485,22 @@ startup_common(clicon_handle       h,
         goto done;
 
     /* 5. Make generic validation on all new or changed data.
-       Note this is only call that uses 3-values */
-    clicon_debug(1, "Validating startup %s", db);
-    if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
+       Note this is only call that uses 3-values
+       Skipped if the fast-boot stamp shows this db content was already
+       validated with this schema, see startup_fastboot_match */
+    if ((ret = startup_fastboot_match(h, db)) < 0)
         goto done;
-    if (ret == 0){
-        if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
+    if (ret == 1)
+        clicon_debug(1, "Fast-boot %s: unchanged since last validated commit, skipping validation", db);
+    else{
+        clicon_debug(1, "Validating startup %s", db);
+        if ((ret = generic_validate(h, yspec, td, &xret)) < 0)
             goto done;
-        goto fail; /* STARTUP_INVALID */
+        if (ret == 0){
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
+                goto done;
+            goto fail; /* STARTUP_INVALID */
+        }
     }
     /* 6. Call plugin transaction validate callbacks */
     if (plugin_transaction_validate_all(h, td) < 0)
@@ -445,6 +640,8 @@ startup_commit(clicon_handle  h,
         goto fail;
     /* 10. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
+    /* Record fast-boot stamp: this db content validated with current schema */
+    startup_fastboot_record(h, db);
     retval = 1;
  done:
     if (td){
@@ -485,10 +682,11 @@ validate_common(clicon_handle       h,
     cxobj      *xn;
     int         ret;
     
+    CLIXON_PROBE2(validate_common_start, db, td->td_id);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_FATAL, 0, "No DB_SPEC");
         goto done;
-    }   
+    }
     /* This is the state we are going to */
     if ((ret = xmldb_get0(h, db, YB_MODULE, NULL, "/", 0, 0, &td->td_target, NULL, xret)) < 0)
         goto done;
@@ -560,6 +758,7 @@ validate_common(clicon_handle       h,
         goto done;
     retval = 1;
  done:
+    CLIXON_PROBE4(validate_common_end, db, td->td_alen, td->td_dlen, td->td_clen);
     return retval;
  fail:
     retval = 0;
@@ -590,6 +789,7 @@ candidate_validate(clicon_handle h,
         clicon_err(OE_CFG, EINVAL, "db or cbret is NULL");
         goto done;
     }
+    clixon_rpc_stats_stage_begin(h, RPC_STATS_VALIDATE);
     /* 1. Start transaction */
     if ((td = transaction_new()) == NULL)
         goto done;
@@ -624,6 +824,7 @@ candidate_validate(clicon_handle h,
     plugin_transaction_end_all(h, td);
     retval = 1;
  done:
+    clixon_rpc_stats_stage_end(h, RPC_STATS_VALIDATE);
     if (xret)
         xml_free(xret);
      if (td){
@@ -639,6 +840,230 @@ candidate_validate(clicon_handle h,
     goto done;
 }
 
+/*! Build the config-diff notification edit list from a commit transaction delta
+ *
+ * Serializes the add/delete/change vectors computed by validate_common as a
+ * list of <edit> elements that a client can apply to a local mirror of
+ * running: deletes as purge-by-path, adds and changes as merge-into-parent.
+ * Must be called while the diff vectors still point into valid trees, ie
+ * before xmldb_copy().
+ * @param[in]  h    Clicon handle
+ * @param[in]  td   Transaction data with diff vectors
+ * @param[out] cbp  Edit list as XML cbuf, NULL if nothing to push (no
+ *                  subscribers or empty diff). Free with cbuf_free
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see config-diff in clixon-lib.yang
+ */
+static int
+commit_diff_build(clicon_handle       h,
+                  transaction_data_t *td,
+                  cbuf              **cbp)
+{
+    int             retval = -1;
+    cbuf           *cb = NULL;
+    char           *path = NULL;
+    cvec           *nsc = NULL;
+    cxobj          *xn;
+    cxobj          *xp;
+    cxobj          *xv = NULL;
+    event_stream_t *es;
+    int             i;
+
+    *cbp = NULL;
+    /* Only build the delta if someone actually subscribes to it */
+    if ((es = stream_find(h, "CONFIGDIFF")) == NULL ||
+        es->es_subscription == NULL)
+        goto ok;
+    if (td->td_dlen == 0 && td->td_alen == 0 && td->td_clen == 0)
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<td->td_dlen; i++){ /* deleted: only in running */
+        xn = td->td_dvec[i];
+        if (xml2xpath(xn, NULL, &path) < 0)
+            goto done;
+        cprintf(cb, "<edit><op>delete</op><path>");
+        if (xml_chardata_cbuf_append(cb, path) < 0)
+            goto done;
+        cprintf(cb, "</path></edit>");
+        free(path);
+        path = NULL;
+    }
+    for (i=0; i<td->td_alen + td->td_clen; i++){ /* added + changed: merge new subtree */
+        xn = i < td->td_alen ? td->td_avec[i] : td->td_tcvec[i - td->td_alen];
+        if ((xp = xml_parent(xn)) != NULL && xml_parent(xp) != NULL){
+            if (xml2xpath(xp, NULL, &path) < 0)
+                goto done;
+        }
+        cprintf(cb, "<edit><op>merge</op><path>");
+        if (xml_chardata_cbuf_append(cb, path?path:"/") < 0)
+            goto done;
+        cprintf(cb, "</path><value>");
+        /* Copy the subtree and make its namespace context explicit */
+        if ((xv = xml_dup(xn)) == NULL)
+            goto done;
+        if (xml_nsctx_node(xn, &nsc) < 0)
+            goto done;
+        if (xmlns_set_all(xv, nsc) < 0)
+            goto done;
+        if (clixon_xml2cbuf(cb, xv, 0, 0, -1, 0) < 0)
+            goto done;
+        cprintf(cb, "</value></edit>");
+        xml_free(xv);
+        xv = NULL;
+        xml_nsctx_free(nsc);
+        nsc = NULL;
+        if (path){
+            free(path);
+            path = NULL;
+        }
+    }
+    *cbp = cb;
+    cb = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (path)
+        free(path);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (xv)
+        xml_free(xv);
+    return retval;
+}
+
+/*
+ * Rollback history ring, see CLICON_ROLLBACK_HISTORY
+ * After each successful commit the running cache tree is archived by taking a
+ * reader reference on it (see xmldb_ref_incr). The reference forces the
+ * datastore copy-on-write machinery to clone before the next modification, so
+ * the archived tree stays immutable without being copied at archive time.
+ * Archiving is thus constant-time; memory is one tree per retained distinct
+ * generation since sharing is tree-granular. An archived generation can be
+ * restored with the rollback RPC, which commits it through the regular
+ * candidate_commit() transaction path so plugins see the diff against running.
+ */
+#define ROLLBACK_RING_PTR "rollback-ring"
+
+/* Scratch datastore used to stage an archived tree for commit */
+#define ROLLBACK_RING_DB  "rollback-tmp"
+
+/* One archived commit generation */
+struct rollback_ent{
+    cxobj         *re_xml;    /* Archived running tree (reader-referenced) */
+    uint32_t       re_serial; /* Write serial of running when archived */
+    struct timeval re_tv;     /* When the commit completed */
+};
+
+/* Ring of archived generations, oldest at rr_head. Stored on the handle
+ * under ROLLBACK_RING_PTR, entries follow the header in the same allocation */
+struct rollback_ring{
+    int                 rr_size;  /* Capacity: CLICON_ROLLBACK_HISTORY */
+    int                 rr_len;   /* Nr of valid entries */
+    int                 rr_head;  /* Index of oldest entry */
+    struct rollback_ent rr_ent[]; /* rr_size entries */
+};
+
+/*! Archive the current running tree in the rollback history ring
+ *
+ * Called after a successful commit. Takes a reader reference on the running
+ * cache tree instead of copying it, evicting (releasing) the oldest entry if
+ * the ring is full. No-op if CLICON_ROLLBACK_HISTORY is 0 or running is not
+ * cached (only cached trees can be retained by reference).
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+rollback_ring_push(clicon_handle h)
+{
+    int                   retval = -1;
+    int                   size;
+    cxobj                *x;
+    struct rollback_ring *rr = NULL;
+    struct rollback_ent  *re;
+
+    if ((size = clicon_option_int(h, "CLICON_ROLLBACK_HISTORY")) <= 0)
+        return 0;
+    if ((x = xmldb_cache_get(h, "running")) == NULL)
+        return 0;
+    clicon_ptr_get(h, ROLLBACK_RING_PTR, (void**)&rr);
+    if (rr == NULL){
+        if ((rr = malloc(sizeof(*rr) + size*sizeof(struct rollback_ent))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(rr, 0, sizeof(*rr) + size*sizeof(struct rollback_ent));
+        rr->rr_size = size;
+        if (clicon_ptr_set(h, ROLLBACK_RING_PTR, rr) < 0){
+            free(rr);
+            goto done;
+        }
+    }
+    if (rr->rr_len == rr->rr_size){ /* Full: evict oldest */
+        if (xmldb_ref_release(h, rr->rr_ent[rr->rr_head].re_xml) < 0)
+            goto done;
+        rr->rr_head = (rr->rr_head + 1) % rr->rr_size;
+        rr->rr_len--;
+    }
+    if (xmldb_ref_incr(h, x) < 0)
+        goto done;
+    re = &rr->rr_ent[(rr->rr_head + rr->rr_len) % rr->rr_size];
+    re->re_xml = x;
+    re->re_serial = xmldb_serial_get(h, "running");
+    gettimeofday(&re->re_tv, NULL);
+    rr->rr_len++;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get the archived generation nr commits back from current running
+ *
+ * @param[in]  h   Clicon handle
+ * @param[in]  nr  Nr of commits back, 1 is the generation before the last commit
+ * @retval     re  Archived entry
+ * @retval     NULL No such entry (history shorter than nr, or disabled)
+ */
+static struct rollback_ent *
+rollback_ring_get(clicon_handle h,
+                  uint32_t      nr)
+{
+    struct rollback_ring *rr = NULL;
+
+    clicon_ptr_get(h, ROLLBACK_RING_PTR, (void**)&rr);
+    if (rr == NULL || nr >= (uint32_t)rr->rr_len)
+        return NULL;
+    return &rr->rr_ent[(rr->rr_head + rr->rr_len - 1 - nr) % rr->rr_size];
+}
+
+/*! Free the rollback history ring, releasing all archived tree references
+ *
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ * @see backend_terminate
+ */
+int
+rollback_ring_free(clicon_handle h)
+{
+    struct rollback_ring *rr = NULL;
+    int                   i;
+
+    clicon_ptr_get(h, ROLLBACK_RING_PTR, (void**)&rr);
+    if (rr == NULL)
+        return 0;
+    for (i = 0; i < rr->rr_len; i++)
+        xmldb_ref_release(h, rr->rr_ent[(rr->rr_head + i) % rr->rr_size].re_xml);
+    free(rr);
+    clicon_ptr_del(h, ROLLBACK_RING_PTR);
+    return 0;
+}
+
 /*! Do a diff between candidate and running, then start a commit transaction
  *
  * The code reverts changes if the commit fails. But if the revert
@@ -667,7 +1092,22 @@ candidate_commit(clicon_handle h,
     int                 ret;
     cxobj              *xret = NULL;
     yang_stmt          *yspec;
+    cbuf               *cbdiff = NULL;
+    struct timespec     tspan;
+    uint32_t            base;
 
+    CLIXON_PROBE2(candidate_commit_start, db, myid);
+    /* Private candidate (see CLICON_PRIVATE_CANDIDATE): optimistic concurrency
+     * check, fail if another session committed to running after this candidate
+     * was forked from it. The session must discard-changes (re-fork) and
+     * re-apply its edits. */
+    base = xmldb_base_serial_get(h, db);
+    if (base != 0 && base != xmldb_serial_get(h, "running")){
+        if (netconf_in_use(cbret, "application",
+                           "Commit failed, running was modified by another session since this private candidate was created: discard changes and re-apply") < 0)
+            goto done;
+        goto fail;
+    }
     /* 1. Start transaction */
     if ((td = transaction_new()) == NULL)
         goto done;
@@ -677,8 +1117,10 @@ candidate_commit(clicon_handle h,
      */
     switch (vlev){
     case VL_FULL:
+        clock_gettime(CLOCK_MONOTONIC, &tspan);
         if ((ret = validate_common(h, db, td, &xret)) < 0)
             goto done;
+        clixon_trace_span(h, "backend.commit.validate", &tspan);
         break;
     default:
         ret = 1;
@@ -713,23 +1155,53 @@ candidate_commit(clicon_handle h,
     }
 
     /* 7. Call plugin transaction commit callbacks */
+    clock_gettime(CLOCK_MONOTONIC, &tspan);
     if (plugin_transaction_commit_all(h, td) < 0)
         goto done;
     /* After commit, make a post-commit call (sure that all plugins have committed) */
     if (plugin_transaction_commit_done_all(h, td) < 0)
         goto done;
-     
+    clixon_trace_span(h, "backend.commit.plugins", &tspan);
+
+    /* Build the commit delta for the CONFIGDIFF stream while the diff vectors
+     * still point into the source/target trees, pushed after copy below */
+    if (commit_diff_build(h, td, &cbdiff) < 0)
+        goto done;
+
     /* Clear cached trees from default values and marking */
     if (xmldb_get0_clear(h, td->td_target) < 0)
         goto done;
     if (xmldb_get0_clear(h, td->td_src) < 0)
         goto done;
 
-    /* 8. Success: Copy candidate to running 
+    /* 8. Success: Copy candidate to running
      */
+    clock_gettime(CLOCK_MONOTONIC, &tspan);
     if (xmldb_copy(h, db, "running") < 0)
         goto done;
     xmldb_modified_set(h, db, 0); /* reset dirty bit */
+    /* Private candidate: rebase on the running generation just produced so
+     * follow-up commits from this session pass the concurrency check */
+    if (base != 0 &&
+        xmldb_base_serial_set(h, db, xmldb_serial_get(h, "running")) < 0)
+        goto done;
+    /* With coalesced datastore writes, commit still promises persistence:
+     * force running to stable storage, see CLICON_XMLDB_WRITE_COALESCE */
+    if (clicon_option_int(h, "CLICON_XMLDB_WRITE_COALESCE") > 0 &&
+        xmldb_barrier(h, "running") < 0)
+        goto done;
+    clixon_trace_span(h, "backend.commit.datastore", &tspan);
+    /* Push the commit delta to CONFIGDIFF subscribers so they can patch a
+     * local mirror of running instead of re-reading the full config */
+    if (cbdiff &&
+        stream_notify(h, "CONFIGDIFF",
+                      "<config-diff xmlns=\"%s\"><serial>%u</serial>%s</config-diff>",
+                      CLIXON_LIB_NS, xmldb_serial_get(h, "running"),
+                      cbuf_get(cbdiff)) < 0)
+        goto done;
+    /* Archive this generation in the rollback history ring, see CLICON_ROLLBACK_HISTORY */
+    if (rollback_ring_push(h) < 0)
+        goto done;
     /* Here pointers to old (source) tree are obsolete */
     if (td->td_dvec){
         td->td_dlen = 0;
@@ -743,9 +1215,10 @@ candidate_commit(clicon_handle h,
 
     /* 9. Call plugin transaction end callbacks */
     plugin_transaction_end_all(h, td);
-    
+
     retval = 1;
  done:
+    CLIXON_PROBE3(candidate_commit_end, db, myid, retval);
     /* In case of failure (or error), call plugin transaction termination callbacks */
     if (td){
         if (retval < 1)
@@ -754,6 +1227,8 @@ candidate_commit(clicon_handle h,
         xmldb_get0_free(h, &td->td_src);
         transaction_free(td);
     }
+    if (cbdiff)
+        cbuf_free(cbdiff);
     if (xret)
         xml_free(xret);
     return retval;
@@ -762,6 +1237,224 @@ candidate_commit(clicon_handle h,
     goto done;
 }
 
+/*
+ * Commit queue, see CLICON_COMMIT_QUEUE
+ * The commit RPC returns to the client after validation; the commit itself,
+ * including plugin hardware propagation, runs from an event-loop timeout on a
+ * snapshot of candidate. Entries execute strictly in order, one per timeout,
+ * so each queued commit is diffed against the running produced by its
+ * predecessor. State is queryable with the commit-queue RPC.
+ */
+/* Commit queue entry states, see commit_queue_status_str() */
+#define CQ_PENDING   0
+#define CQ_EXECUTING 1
+#define CQ_COMPLETED 2
+#define CQ_FAILED    3
+
+/* Keep at most this many completed/failed entries for commit-queue queries */
+#define COMMIT_QUEUE_KEEP 32
+
+/* Commit queue entry, one per queued commit */
+struct commit_queue_entry{
+    struct commit_queue_entry *cq_next;
+    uint32_t       cq_id;      /* Queue entry id, monotonically increasing */
+    uint32_t       cq_sessid;  /* Originating client/session id */
+    int            cq_status;  /* See CQ_* */
+    struct timeval cq_tv;      /* When enqueued */
+    char          *cq_reason;  /* Error reason if failed */
+};
+
+static struct commit_queue_entry *_commit_queue = NULL; /* Oldest first */
+static uint32_t                   _commit_queue_nextid = 0;
+static int                        _commit_queue_armed = 0;
+
+/*! Map commit queue entry state to string
+ */
+static char *
+commit_queue_status_str(int status)
+{
+    switch (status){
+    case CQ_PENDING:   return "pending";
+    case CQ_EXECUTING: return "executing";
+    case CQ_COMPLETED: return "completed";
+    case CQ_FAILED:    return "failed";
+    }
+    return "unknown";
+}
+
+/*! Event-loop timeout executing the oldest pending commit queue entry
+ * A commit failure is recorded in the entry (plugin rollback is handled by
+ * candidate_commit internally, running is not updated) and does not stop the
+ * queue or the backend; only internal errors return -1.
+ * @param[in] fd   Ignored
+ * @param[in] arg  Clicon handle
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+static int
+commit_queue_timeout(int   fd,
+                     void *arg)
+{
+    int                        retval = -1;
+    clicon_handle              h = (clicon_handle)arg;
+    struct commit_queue_entry *cq;
+    cbuf                      *cbq = NULL;
+    cbuf                      *cbret = NULL;
+    struct timeval             now;
+    int                        ret;
+
+    _commit_queue_armed = 0;
+    for (cq = _commit_queue; cq; cq = cq->cq_next)
+        if (cq->cq_status == CQ_PENDING)
+            break;
+    if (cq == NULL)
+        goto ok;
+    if ((cbq = cbuf_new()) == NULL || (cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbq, "commit-queue-%u", cq->cq_id);
+    cq->cq_status = CQ_EXECUTING;
+    if ((ret = candidate_commit(h, NULL, cbuf_get(cbq), cq->cq_sessid, VL_FULL, cbret)) < 1){
+        cq->cq_status = CQ_FAILED;
+        if ((cq->cq_reason = strdup(ret == 0 ? cbuf_get(cbret) : clicon_err_reason)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        clicon_log(LOG_WARNING, "commit-queue: entry %u from session %u failed: %s",
+                   cq->cq_id, cq->cq_sessid, cq->cq_reason);
+    }
+    else
+        cq->cq_status = CQ_COMPLETED;
+    if (xmldb_delete(h, cbuf_get(cbq)) < 0)
+        goto done;
+    /* More pending entries: execute the next on a fresh timeout */
+    for (cq = cq->cq_next; cq; cq = cq->cq_next)
+        if (cq->cq_status == CQ_PENDING)
+            break;
+    if (cq != NULL){
+        gettimeofday(&now, NULL);
+        if (clixon_event_reg_timeout(now, commit_queue_timeout, h, "commit queue") < 0)
+            goto done;
+        _commit_queue_armed++;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cbq)
+        cbuf_free(cbq);
+    if (cbret)
+        cbuf_free(cbret);
+    return retval;
+}
+
+/*! Snapshot candidate onto the commit queue and arm the executor
+ * Called after validation has succeeded, so the client sees early validation
+ * failures synchronously while hardware propagation continues asynchronously.
+ * @param[in]  h     Clicon handle
+ * @param[in]  myid  Client/session id of the committing session
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+commit_queue_enqueue(clicon_handle h,
+                     uint32_t      myid)
+{
+    int                         retval = -1;
+    struct commit_queue_entry  *cq = NULL;
+    struct commit_queue_entry **prev;
+    cbuf                       *cbq = NULL;
+    int                         ndone = 0;
+
+    /* Prune oldest completed/failed entries beyond the keep limit */
+    for (cq = _commit_queue; cq; cq = cq->cq_next)
+        if (cq->cq_status == CQ_COMPLETED || cq->cq_status == CQ_FAILED)
+            ndone++;
+    prev = &_commit_queue;
+    while (ndone > COMMIT_QUEUE_KEEP && (cq = *prev) != NULL){
+        if (cq->cq_status == CQ_COMPLETED || cq->cq_status == CQ_FAILED){
+            *prev = cq->cq_next;
+            if (cq->cq_reason)
+                free(cq->cq_reason);
+            free(cq);
+            ndone--;
+        }
+        else
+            prev = &cq->cq_next;
+    }
+    if ((cbq = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbq, "commit-queue-%u", ++_commit_queue_nextid);
+    if (xmldb_copy(h, "candidate", cbuf_get(cbq)) < 0)
+        goto done;
+    xmldb_modified_set(h, "candidate", 0); /* snapshot taken, reset dirty bit */
+    if ((cq = calloc(1, sizeof(*cq))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    cq->cq_id = _commit_queue_nextid;
+    cq->cq_sessid = myid;
+    cq->cq_status = CQ_PENDING;
+    gettimeofday(&cq->cq_tv, NULL);
+    /* Append at tail: entries execute in order */
+    prev = &_commit_queue;
+    while (*prev)
+        prev = &(*prev)->cq_next;
+    *prev = cq;
+    if (!_commit_queue_armed){
+        if (clixon_event_reg_timeout(cq->cq_tv, commit_queue_timeout, h, "commit queue") < 0)
+            goto done;
+        _commit_queue_armed++;
+    }
+    retval = 0;
+ done:
+    if (cbq)
+        cbuf_free(cbq);
+    return retval;
+}
+
+/*! Query commit queue state, clixon-lib commit-queue RPC
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see commit_queue_enqueue
+ */
+int
+from_client_commit_queue(clicon_handle h,
+                         cxobj        *xe,
+                         cbuf         *cbret,
+                         void         *arg,
+                         void         *regarg)
+{
+    int                        retval = -1;
+    struct commit_queue_entry *cq;
+
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    for (cq = _commit_queue; cq; cq = cq->cq_next){
+        cprintf(cbret, "<entry xmlns=\"%s\">", CLIXON_LIB_NS);
+        cprintf(cbret, "<id>%u</id>", cq->cq_id);
+        cprintf(cbret, "<session>%u</session>", cq->cq_sessid);
+        cprintf(cbret, "<status>%s</status>", commit_queue_status_str(cq->cq_status));
+        if (cq->cq_reason){
+            cprintf(cbret, "<reason>");
+            if (xml_chardata_cbuf_append(cbret, cq->cq_reason) < 0)
+                goto done;
+            cprintf(cbret, "</reason>");
+        }
+        cprintf(cbret, "</entry>");
+    }
+    cprintf(cbret, "</rpc-reply>");
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Commit the candidate configuration as the device's new current configuration
  *
  * @param[in]  h       Clicon handle 
@@ -803,11 +1496,17 @@ from_client_commit(clicon_handle h,
     cbuf                *cbx = NULL; /* Assist cbuf */
     int                  ret;
     yang_stmt           *yspec;
+    char                *db;
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL) {
         clicon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
+    if ((db = client_candidate(h, ce, "candidate")) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
 
     if (if_feature(yspec, "ietf-netconf", "confirmed-commit")) {
         if ((ret = from_client_confirmed_commit(h, xe, myid, cbret)) < 0)
@@ -827,7 +1526,29 @@ from_client_commit(clicon_handle h,
             goto done;
         goto ok;
     }
-    if ((ret = candidate_commit(h, xe, "candidate", myid, VL_FULL, cbret)) < 0){ /* Assume validation fail, nofatal */
+    /* Commit queue: return to the client after validation while the commit
+     * itself runs asynchronously, see CLICON_COMMIT_QUEUE. Confirmed-commits
+     * need the synchronous path for rollback timer handling, and private
+     * candidates commit synchronously so the concurrency check result can be
+     * reported to the client, see CLICON_PRIVATE_CANDIDATE */
+    if (clicon_option_bool(h, "CLICON_COMMIT_QUEUE") &&
+        strcmp(db, "candidate") == 0 &&
+        xml_find_type(xe, NULL, "confirmed", CX_ELMNT) == NULL &&
+        xml_find_type(xe, NULL, "persist", CX_ELMNT) == NULL &&
+        xml_find_type(xe, NULL, "persist-id", CX_ELMNT) == NULL){
+        if ((ret = candidate_validate(h, db, cbret)) < 0){
+            if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
+                goto done;
+            goto ok;
+        }
+        if (ret == 0) /* Validation failed, cbret set */
+            goto ok;
+        if (commit_queue_enqueue(h, myid) < 0)
+            goto done;
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+        goto ok;
+    }
+    if ((ret = candidate_commit(h, xe, db, myid, VL_FULL, cbret)) < 0){ /* Assume validation fail, nofatal */
         clicon_debug(1, "Commit candidate failed");
         if (ret < 0)
             if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
@@ -868,25 +1589,35 @@ from_client_discard_changes(clicon_handle h,
     uint32_t             myid = ce->ce_id;
     uint32_t             iddb;
     cbuf                *cbx = NULL; /* Assist cbuf */
-    
+    char                *db;
+
+    if ((db = client_candidate(h, ce, "candidate")) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     /* Check if target locked by other client */
-    iddb = xmldb_islocked(h, "candidate");
+    iddb = xmldb_islocked(h, db);
     if (iddb && myid != iddb){
         if ((cbx = cbuf_new()) == NULL){
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
-        }       
+        }
         cprintf(cbx, "<session-id>%u</session-id>", iddb);
         if (netconf_lock_denied(cbret, cbuf_get(cbx), "Operation failed, lock is already held") < 0)
             goto done;
         goto ok;
     }
-    if (xmldb_copy(h, "running", "candidate") < 0){
+    if (xmldb_copy(h, "running", db) < 0){
         if (netconf_operation_failed(cbret, "application", clicon_err_reason)< 0)
             goto done;
         goto ok;
     }
-    xmldb_modified_set(h, "candidate", 0); /* reset dirty bit */
+    xmldb_modified_set(h, db, 0); /* reset dirty bit */
+    /* Private candidate: a discard re-forks from current running */
+    if (strcmp(db, "candidate") != 0 &&
+        xmldb_base_serial_set(h, db, xmldb_serial_get(h, "running")) < 0)
+        goto done;
     cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
  ok:
     retval = 0;
@@ -913,9 +1644,10 @@ from_client_validate(clicon_handle h,
                      void         *arg,
                      void         *regarg)
 {
-    int   retval = -1;
-    int   ret;
-    char *db;
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    int                  ret;
+    char                *db;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if ((db = netconf_db_find(xe, "source")) == NULL){
@@ -923,6 +1655,11 @@ from_client_validate(clicon_handle h,
             goto done;
         goto ok;
     }
+    if ((db = client_candidate(h, ce, db)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
     if ((ret = candidate_validate(h, db, cbret)) < 0)
         goto done;
     if (ret == 1)
@@ -933,6 +1670,93 @@ from_client_validate(clicon_handle h,
     return retval;
 } /* from_client_validate */
 
+/*! Roll running back to an archived generation from the rollback history ring
+ *
+ * Clixon-specific RPC, see clixon-lib.yang and CLICON_ROLLBACK_HISTORY.
+ * The archived tree is staged in a scratch datastore and committed through the
+ * regular candidate_commit() path, so validation and plugin transaction
+ * callbacks see exactly the diff between the archived generation and running.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK. This may indicate both ok and err msg back to client
+ * @retval    -1       Error
+ */
+int
+from_client_rollback(clicon_handle h,
+                     cxobj        *xe,
+                     cbuf         *cbret,
+                     void         *arg,
+                     void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    uint32_t             myid = ce->ce_id;
+    uint32_t             iddb;
+    char                *db = ROLLBACK_RING_DB;
+    char                *str;
+    uint32_t             nr = 0;
+    struct rollback_ent *re;
+    cxobj               *xcopy = NULL;
+    int                  dbstaged = 0;
+    int                  ret;
+
+    if ((str = xml_find_body(xe, "nr")) == NULL){
+        if (netconf_missing_element(cbret, "protocol", "nr", NULL) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = netconf_parse_uint32("nr", str, NULL, 0, cbret, &nr)) < 0)
+        goto done;
+    if (ret == 0) /* error in cbret */
+        goto ok;
+    if (nr == 0 || (re = rollback_ring_get(h, nr)) == NULL){
+        if (netconf_operation_failed(cbret, "application",
+                                     "No archived configuration that many commits back, see CLICON_ROLLBACK_HISTORY") < 0)
+            goto done;
+        goto ok;
+    }
+    /* Check if target locked by other client */
+    iddb = xmldb_islocked(h, "running");
+    if (iddb && myid != iddb){
+        if (netconf_in_use(cbret, "protocol", "Operation failed, lock is already held") < 0)
+            goto done;
+        goto ok;
+    }
+    /* Stage the archived tree in a scratch db. The archived tree is shared
+     * with datastore caches and must not be modified, hence the copy */
+    if ((xcopy = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (xml_copy(re->re_xml, xcopy) < 0)
+        goto done;
+    xml_name_set(xcopy, NETCONF_INPUT_CONFIG);
+    if (xmldb_db_reset(h, db) < 0)
+        goto done;
+    dbstaged = 1;
+    if ((ret = xmldb_put(h, db, OP_REPLACE, xcopy, clicon_username_get(h), cbret)) < 0)
+        goto done;
+    if (ret == 0) /* error in cbret */
+        goto ok;
+    if ((ret = candidate_commit(h, NULL, db, myid, VL_FULL, cbret)) < 0){
+        clicon_debug(1, "Rollback commit failed");
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        goto ok;
+    }
+    if (ret == 1)
+        cprintf(cbret, "<rpc-reply xmlns=\"%s\"><ok/></rpc-reply>", NETCONF_BASE_NAMESPACE);
+ ok:
+    retval = 0;
+ done:
+    if (dbstaged)
+        xmldb_delete(h, db);
+    if (xcopy)
+        xml_free(xcopy);
+    return retval;
+} /* from_client_rollback */
+
 /*! Restart specific backend plugins without full backend restart
  * Note, depending on plugin callbacks, there may be other dependencies which may make this
  * difficult in the general case.
@@ -584,10 +584,19 @@ handle_confirmed_commit(clicon_handle h,
             goto done;
         } else if (db_exists == 0) {
             // db does not yet exists
-            if (xmldb_copy(h, "running", "rollback") < 0) {
+            /* The snapshot copies (or COW-shares) the cache and defers the
+             * file write out of the commit RPC path */
+            if (xmldb_copy_defer(h, "running", "rollback") < 0) {
                 clicon_err(OE_DAEMON, 0, "there was an error while copying the running configuration to rollback database.");
                 goto done;
             };
+            /* A persistent confirmed-commit promises to survive a restart:
+             * barrier the rollback file to stable storage. Ephemeral ones are
+             * resolved in-process and take the deferred write */
+            if (confirmed_commit_state_get(h) == PERSISTENT &&
+                xmldb_barrier(h, "rollback") < 0) {
+                goto done;
+            }
         }
 
         if (schedule_rollback_event(h, confirm_timeout) < 0) {
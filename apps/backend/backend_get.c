@@ -73,6 +73,76 @@
 #include "backend_handle.h"
 #include "backend_get.h"
 
+/*! Account a reply tree held on behalf of a session against its memory budget
+ *
+ * The reply trees of get/get-config are the dominant per-session heap use: a
+ * single client selecting a huge subtree can otherwise OOM the backend. The
+ * accounted bytes are released by get_mem_release when the tree is freed.
+ * @param[in]  h      Clicon handle
+ * @param[in]  ce     Client session, NULL means no accounting
+ * @param[in]  xret   Reply tree just read, eg by xmldb_get0
+ * @param[out] szp    Accounted size in bytes, pass to get_mem_release
+ * @param[out] cbret  Return xml tree: netconf resource-denied if budget exceeded
+ * @retval     1      OK, accounted
+ * @retval     0      Budget exceeded, cbret set, nothing accounted
+ * @retval    -1      Error
+ * @see CLICON_SESSION_MEMORY_BUDGET
+ */
+static int
+get_mem_account(clicon_handle        h,
+                struct client_entry *ce,
+                cxobj               *xret,
+                size_t              *szp,
+                cbuf                *cbret)
+{
+    int      retval = -1;
+    uint64_t nr = 0;
+    size_t   sz = 0;
+    uint32_t budget;
+
+    *szp = 0;
+    if (ce == NULL || xret == NULL)
+        goto ok;
+    if (xml_stats(xret, &nr, &sz) < 0)
+        goto done;
+    budget = clicon_option_int(h, "CLICON_SESSION_MEMORY_BUDGET");
+    /* Queued output not yet accepted by the client socket counts against the budget */
+    if (budget != 0 &&
+        ce->ce_mem + (ce->ce_oblen - ce->ce_obpos) + sz > budget){
+        if (netconf_resource_denied(cbret, "application",
+                                    "Session memory budget exceeded, see CLICON_SESSION_MEMORY_BUDGET") < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    ce->ce_mem += sz;
+    if (ce->ce_mem + (ce->ce_oblen - ce->ce_obpos) > ce->ce_mem_peak)
+        ce->ce_mem_peak = ce->ce_mem + (ce->ce_oblen - ce->ce_obpos);
+    *szp = sz;
+ ok:
+    retval = 1;
+ done:
+    return retval;
+}
+
+/*! Release bytes accounted by get_mem_account
+ * @param[in]  ce    Client session, NULL means no accounting
+ * @param[in]  sz    Accounted size as returned by get_mem_account
+ * @retval     0     OK
+ */
+static int
+get_mem_release(struct client_entry *ce,
+                size_t               sz)
+{
+    if (ce != NULL){
+        if (sz <= ce->ce_mem)
+            ce->ce_mem -= sz;
+        else
+            ce->ce_mem = 0;
+    }
+    return 0;
+}
+
 /*!
  * Maybe should be in the restconf client instead of backend?
  * @param[in]     h       Clicon handle
@@ -598,6 +668,7 @@ get_list_pagination(clicon_handle        h,
     int             ret;
     uint32_t        iddb; /* DBs lock, if any */
     int             locked;
+    size_t          accsz = 0;
     cbuf           *cberr = NULL; 
     cxobj         **xvec = NULL;
     size_t          xlen;
@@ -721,7 +792,10 @@ get_list_pagination(clicon_handle        h,
             goto done;
         break;
     }/* switch content */
-
+    if ((ret = get_mem_account(h, ce, xret, &accsz, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
     if (list_config){
 #ifdef LIST_PAGINATION_REMAINING
         /* Get total/remaining
@@ -804,6 +878,7 @@ get_list_pagination(clicon_handle        h,
  ok:
     retval = 0;
  done:
+    get_mem_release(ce, accsz);
     if (xvec)
         free(xvec);
     if (cbmsg)
@@ -819,9 +894,108 @@ get_list_pagination(clicon_handle        h,
     return retval;
 }
 
+/*
+ * Reply cache for repeated config reads, see get_cache_lookup()
+ * Telemetry collectors typically issue the same get-config filter periodically while
+ * running is unchanged: cache the serialized <rpc-reply> keyed on request parameters
+ * and NACM user, and serve it as long as the datastore write serial is unchanged.
+ */
+#define GET_CACHE_NAME       "backend-get-cache"
+/* Flush all entries when the cache reaches this many, bounds memory use */
+#define GET_CACHE_MAXENTRIES 64
+
+/*! Lookup a config read reply in the reply cache
+ *
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Database name, for serial check
+ * @param[in]  cbkey  Cache key: db, xpath, username, depth, with-defaults
+ * @param[out] cbret  On hit, cached reply is appended here
+ * @retval     1      Hit, cbret contains the reply
+ * @retval     0      Miss (no entry, or entry stale and dropped)
+ */
+static int
+get_cache_lookup(clicon_handle h,
+                 char         *db,
+                 cbuf         *cbkey,
+                 cbuf         *cbret)
+{
+    clicon_hash_t *gc = NULL;
+    void          *val;
+    size_t         vlen;
+    uint32_t       serial;
+
+    clicon_ptr_get(h, GET_CACHE_NAME, (void**)&gc);
+    if (gc == NULL)
+        return 0;
+    if ((val = clicon_hash_value(gc, cbuf_get(cbkey), &vlen)) == NULL)
+        return 0;
+    memcpy(&serial, val, sizeof(serial));
+    if (serial != xmldb_serial_get(h, db)){ /* db written since entry was stored */
+        clicon_hash_del(gc, cbuf_get(cbkey));
+        return 0;
+    }
+    cprintf(cbret, "%s", (char*)val + sizeof(serial));
+    return 1;
+}
+
+/*! Store a config read reply in the reply cache
+ *
+ * The entry value is the db write serial captured before the read, followed by the
+ * serialized reply, so that a later write to db invalidates the entry (serial mismatch).
+ * @param[in]  h      Clicon handle
+ * @param[in]  cbkey  Cache key, see get_cache_lookup
+ * @param[in]  serial Datastore write serial at the time of the read
+ * @param[in]  reply  Serialized <rpc-reply> as appended to cbret
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+get_cache_store(clicon_handle h,
+                cbuf         *cbkey,
+                uint32_t      serial,
+                char         *reply)
+{
+    int            retval = -1;
+    clicon_hash_t *gc = NULL;
+    char         **keys = NULL;
+    size_t         nkeys = 0;
+    void          *val = NULL;
+    size_t         vlen;
+    int            i;
+
+    clicon_ptr_get(h, GET_CACHE_NAME, (void**)&gc);
+    if (gc == NULL){
+        if ((gc = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_ptr_set(h, GET_CACHE_NAME, gc) < 0)
+            goto done;
+    }
+    if (clicon_hash_keys(gc, &keys, &nkeys) < 0)
+        goto done;
+    if (nkeys >= GET_CACHE_MAXENTRIES)
+        for (i = 0; i < nkeys; i++)
+            clicon_hash_del(gc, keys[i]);
+    vlen = sizeof(serial) + strlen(reply) + 1;
+    if ((val = malloc(vlen)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memcpy(val, &serial, sizeof(serial));
+    memcpy((char*)val + sizeof(serial), reply, strlen(reply) + 1);
+    if (clicon_hash_add(gc, cbuf_get(cbkey), val, vlen) == NULL)
+        goto done;
+    retval = 0;
+ done:
+    if (val)
+        free(val);
+    if (keys)
+        free(keys);
+    return retval;
+}
+
 /*! Common get/get-config code for retrieving  configuration and state information.
  *
- * @param[in]  h       Clicon handle 
+ * @param[in]  h       Clicon handle
  * @param[in]  ce      Client entry, for locking
  * @param[in]  xe      Request: <rpc><xn></rpc> 
  * @param[in]  content Get config/state/both
@@ -865,6 +1039,10 @@ get_common(clicon_handle        h,
     uint32_t        limit = 0;
     withdefaults_type wdef;
     char             *wdefstr;
+    cbuf             *cbkey = NULL;
+    uint32_t          cache_serial = 0;
+    size_t            cbret_offset = 0;
+    size_t            accsz = 0;
 
 #ifdef NETCONF_DEFAULT_RETRIEVAL_REPORT_ALL
     /* Clixon 6.0 backward compatibly for NETCONF get/get-config behavior */
@@ -941,11 +1119,31 @@ get_common(clicon_handle        h,
             goto done;
         goto ok;
     }
+    /* Reply cache: config-only reads (no state: state may change without a db write) are
+     * served from cached serialized replies while the db write serial is unchanged
+     */
+    if (content == CONTENT_CONFIG){
+        if ((cbkey = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbkey, "%s;%s;%s;%" PRId32 ";%d",
+                db, xpath?xpath:"/", username?username:"", depth, wdef);
+        if (get_cache_lookup(h, db, cbkey, cbret) == 1)
+            goto ok;
+        cache_serial = xmldb_serial_get(h, db);
+        cbret_offset = cbuf_len(cbret);
+    }
     /* Read configuration */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
-        /* specific xpath */
-        if (xmldb_get0(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, wdef, &xret, NULL, NULL) < 0) {
+        /* specific xpath. Depth is pushed into the retrieval copy: nodes below the
+         * depth cut are never copied, defaulted or NACM-checked. Only for config:
+         * state reads merge plugin data into the tree and may validate it, which
+         * needs the full subtree, so they rely on the serializer cut alone
+         */
+        if (xmldb_get0_depth(h, db, YB_MODULE, nsc, xpath?xpath:"/", 1, wdef,
+                             depth, &xret, NULL, NULL) < 0) {
             if ((cbmsg = cbuf_new()) == NULL){
                 clicon_err(OE_UNIX, errno, "cbuf_new");
                 goto done;
@@ -1041,16 +1239,26 @@ get_common(clicon_handle        h,
         if (xml_apply(xret, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
             goto done;
     }
+    if ((ret = get_mem_account(h, ce, xret, &accsz, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
     if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
         goto done;
     if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, cbret) < 0)
         goto done;
+    if (cbkey != NULL &&
+        get_cache_store(h, cbkey, cache_serial, cbuf_get(cbret) + cbret_offset) < 0)
+        goto done;
  ok:
     retval = 0;
  done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+    get_mem_release(ce, accsz);
+    if (cbkey)
+        cbuf_free(cbkey);
     if (xvec)
         free(xvec);
     if (xret)
@@ -1098,6 +1306,12 @@ from_client_get_config(clicon_handle h,
         clicon_err(OE_XML, 0, "db not found");
         goto done;
     }
+    if ((db = client_candidate(h, ce, db)) == NULL){
+        if (netconf_operation_failed(cbret, "application", clicon_err_reason) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     retval = get_common(h, ce, xe, CONTENT_CONFIG, db, cbret);
  done:
     return retval;
@@ -1131,3 +1345,277 @@ from_client_get(clicon_handle h,
         content = netconf_content_str2int(attr);
     return get_common(h, ce, xe, content, "running", cbret);
 }
+
+/*! Evaluate several filter expressions in one rpc over a single retrieved tree
+ *
+ * Collectors polling many subtrees otherwise issue one get per filter, each with
+ * its own datastore retrieval, NACM setup and tree walk. Here running (and plugin
+ * state) is retrieved once and NACM read-access pruning is applied once to the
+ * shared tree; each filter is then an xpath evaluation plus a marked copy of the
+ * matches with ancestor context, returned as a labeled result section.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[out] cbret   Return xml tree, eg <rpc-reply>..., <rpc-error..
+ * @param[in]  arg     client-entry
+ * @param[in]  regarg  User argument given at rpc_callback_register()
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see from_client_get  single-filter equivalent
+ */
+int
+from_client_get_batch(clicon_handle h,
+                      cxobj        *xe,
+                      cbuf         *cbret,
+                      void         *arg,
+                      void         *regarg)
+{
+    int                  retval = -1;
+    struct client_entry *ce = (struct client_entry *)arg;
+    netconf_content      content = CONTENT_ALL;
+    withdefaults_type    wdef;
+    yang_stmt           *yspec;
+    char                *username;
+    char                *str;
+    char                *select;
+    cxobj               *xret = NULL;
+    cxobj               *xpart = NULL;
+    cxobj               *xerr = NULL;
+    cxobj               *xnacm;
+    cxobj               *xf;
+    cxobj               *x;
+    cvec                *nsc0 = NULL;
+    cbuf                *cbmsg = NULL;
+    cbuf                *cbreason = NULL;
+    size_t               nfilter = 0;
+    char               **labels = NULL;
+    char               **xpaths = NULL;
+    cvec               **nscs = NULL;
+    cxobj              **xvec = NULL;
+    size_t               xlen;
+    size_t               accsz = 0;
+    int                  ret;
+    int                  i;
+    int                  j;
+
+#ifdef NETCONF_DEFAULT_RETRIEVAL_REPORT_ALL
+    /* Clixon 6.0 backward compatibly for NETCONF get/get-config behavior */
+    wdef = WITHDEFAULTS_REPORT_ALL;
+#else
+    wdef = WITHDEFAULTS_EXPLICIT;
+#endif
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    username = clicon_username_get(h);
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((str = xml_find_body(xe, "content")) != NULL)
+        content = netconf_content_str2int(str);
+    if ((str = xml_find_body(xe, "with-defaults")) != NULL)
+        wdef = withdefaults_str2int(str);
+    xf = NULL;
+    while ((xf = xml_child_each(xe, xf, CX_ELMNT)) != NULL)
+        if (strcmp(xml_name(xf), "filter") == 0)
+            nfilter++;
+    if (nfilter == 0){
+        if (netconf_bad_element(cbret, "application", "filter", "At least one filter is required") < 0)
+            goto done;
+        goto ok;
+    }
+    if ((labels = calloc(nfilter, sizeof(char*))) == NULL ||
+        (xpaths = calloc(nfilter, sizeof(char*))) == NULL ||
+        (nscs = calloc(nfilter, sizeof(cvec*))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Canonicalize all filters before retrieving anything so an invalid select
+     * fails the rpc up-front rather than after a partial reply
+     */
+    i = 0;
+    xf = NULL;
+    while ((xf = xml_child_each(xe, xf, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xf), "filter") != 0)
+            continue;
+        labels[i] = xml_find_body(xf, "label");
+        if ((select = xml_find_body(xf, "select")) == NULL)
+            select = "/";
+        /* Namespace context for the xpath: declarations in scope on <filter> */
+        else if (xml_nsctx_node(xf, &nsc0) < 0)
+            goto done;
+        if ((ret = xpath2canonical(select, nsc0, yspec, &xpaths[i], &nscs[i], &cbreason)) < 0)
+            goto done;
+        if (nsc0){
+            xml_nsctx_free(nsc0);
+            nsc0 = NULL;
+        }
+        if (ret == 0){
+            if (netconf_bad_element(cbret, "application", "select", cbuf_get(cbreason)) < 0)
+                goto done;
+            goto ok;
+        }
+        i++;
+    }
+    /* Retrieve running once, whole tree: shared by all filters */
+    switch (content){
+    case CONTENT_CONFIG:
+    case CONTENT_ALL:
+        if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, wdef, &xret, NULL, NULL) < 0) {
+            if ((cbmsg = cbuf_new()) == NULL){
+                clicon_err(OE_UNIX, errno, "cbuf_new");
+                goto done;
+            }
+            cprintf(cbmsg, "Get running datastore: %s", clicon_err_reason);
+            if (netconf_operation_failed(cbret, "application", cbuf_get(cbmsg)) < 0)
+                goto done;
+            goto ok;
+        }
+        break;
+    case CONTENT_NONCONFIG:
+        if ((xret = xml_new(DATASTORE_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)/* Only top tree */
+            goto done;
+        break;
+    }/* switch content */
+    if (content != CONTENT_CONFIG){
+        if ((ret = get_statedata(h, "/", NULL, wdef, &xret)) < 0)
+            goto done;
+        if (ret == 0){ /* Error from callback (error in xret) */
+            if (clixon_xml2cbuf(cbret, xret, 0, 0, -1, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        if (clicon_option_bool(h, "CLICON_VALIDATE_STATE_XML")){
+            /* Check XML by validating it, see get_common. The whole config tree is
+             * present in case the state data references config data
+             */
+            if ((ret = xml_yang_validate_all_top(h, xret, &xerr)) < 0)
+                goto done;
+            if (ret > 0 &&
+                (ret = xml_yang_validate_add(h, xret, &xerr)) < 0)
+                goto done;
+            if (ret == 0){
+                clicon_debug_xml(1, xret, "VALIDATE_STATE");
+                if (clixon_netconf_internal_error(xerr,
+                                                  ". Internal error, state callback returned invalid XML",
+                                                  NULL) < 0)
+                    goto done;
+                if (clixon_xml2cbuf(cbret, xerr, 0, 0, -1, 0) < 0)
+                    goto done;
+                goto ok;
+            }
+        } /* CLICON_VALIDATE_STATE_XML */
+    }
+    if (content == CONTENT_NONCONFIG){ /* state only, all config should be removed now */
+        if (xml_non_config_data(xret, NULL) < 0)
+            goto done;
+        if (xml_tree_prune_flagged_sub(xret, XML_FLAG_MARK, 1, NULL) < 0)
+            goto done;
+        if (xml_apply(xret, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_MARK) < 0)
+            goto done;
+    }
+    if ((ret = get_mem_account(h, ce, xret, &accsz, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    /* Shared NACM pass: read-access pruning is applied once to the shared tree,
+     * all filters then evaluate against the already access-checked data
+     */
+    if ((xnacm = clicon_nacm_cache(h)) != NULL){
+        if (xpath_vec(xret, NULL, "/", &xvec, &xlen) < 0)
+            goto done;
+        if (nacm_datanode_read(h, xret, xvec, xlen, username, xnacm) < 0)
+            goto done;
+        free(xvec);
+        xvec = NULL;
+    }
+    cprintf(cbret, "<rpc-reply xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    for (i=0; i<nfilter; i++){
+        cprintf(cbret, "<result xmlns=\"%s\"><label>", CLIXON_LIB_NS);
+        if (labels[i] && xml_chardata_cbuf_append(cbret, labels[i]) < 0)
+            goto done;
+        cprintf(cbret, "</label>");
+        if (xpath_vec(xret, nscs[i], "%s", &xvec, &xlen, xpaths[i]?xpaths[i]:"/") < 0)
+            goto done;
+        if (xlen == 0)
+            cprintf(cbret, "<data/>");
+        else{
+            /* Mark matches and ancestors, copy to a fresh tree: the shared tree must
+             * not be pruned in place since later filters evaluate against it too
+             */
+            for (j=0; j<xlen; j++){
+                if (xvec[j] == xret){
+                    /* "/" matches the top symbol itself: mark all children instead so
+                     * the copy yields the whole tree
+                     */
+                    x = NULL;
+                    while ((x = xml_child_each(xret, x, CX_ELMNT)) != NULL)
+                        xml_flag_set(x, XML_FLAG_MARK);
+                }
+                else{
+                    xml_flag_set(xvec[j], XML_FLAG_MARK);
+                    xml_apply_ancestor(xvec[j], (xml_applyfn_t*)xml_flag_set, (void*)XML_FLAG_CHANGE);
+                }
+            }
+            if ((xpart = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_copy_marked(xret, xpart) < 0)
+                goto done;
+            /* Clear flags via the match vector, see xmldb_get_cache for rationale */
+            for (j=0; j<xlen; j++){
+                if (xvec[j] == xret){
+                    x = NULL;
+                    while ((x = xml_child_each(xret, x, CX_ELMNT)) != NULL)
+                        xml_flag_reset(x, XML_FLAG_MARK);
+                }
+                else{
+                    xml_flag_reset(xvec[j], XML_FLAG_MARK);
+                    xml_apply_ancestor(xvec[j], (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CHANGE);
+                }
+            }
+            if (xml_apply(xpart, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                          (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
+                goto done;
+            if (clixon_xml2cbuf(cbret, xpart, 0, 0, -1, 0) < 0)
+                goto done;
+            xml_free(xpart);
+            xpart = NULL;
+        }
+        free(xvec);
+        xvec = NULL;
+        cprintf(cbret, "</result>");
+    }
+    cprintf(cbret, "</rpc-reply>");
+ ok:
+    retval = 0;
+ done:
+    clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+    get_mem_release(ce, accsz);
+    if (xvec)
+        free(xvec);
+    if (xpart)
+        xml_free(xpart);
+    if (xret)
+        xml_free(xret);
+    if (xerr)
+        xml_free(xerr);
+    if (nsc0)
+        xml_nsctx_free(nsc0);
+    if (cbreason)
+        cbuf_free(cbreason);
+    if (cbmsg)
+        cbuf_free(cbmsg);
+    if (nscs){
+        for (i=0; i<nfilter; i++)
+            if (nscs[i])
+                xml_nsctx_free(nscs[i]);
+        free(nscs);
+    }
+    if (xpaths){
+        for (i=0; i<nfilter; i++)
+            if (xpaths[i])
+                free(xpaths[i]);
+        free(xpaths);
+    }
+    if (labels)
+        free(labels);
+    return retval;
+}
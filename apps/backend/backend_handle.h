@@ -43,6 +43,19 @@
  * Prototypes 
  * not exported.
  */
+/* Server-global netconf-monitoring statistics, see RFC 6022 Section 2.1.5.
+ * The rpc counters on the handle hold totals of closed sessions only; live
+ * sessions keep plain per-client_entry counters updated inline and are folded
+ * in lazily when the state is read, see backend_stats_get */
+struct backend_stats{
+    struct timeval bs_start_time;       /* When the backend handle was created */
+    uint32_t       bs_in_sessions;      /* Sessions started */
+    uint32_t       bs_dropped_sessions; /* Sessions ended other than by close-session */
+    uint32_t       bs_in_rpcs;          /* Correct <rpc> messages received */
+    uint32_t       bs_in_bad_rpcs;      /* Incorrect <rpc> messages received */
+    uint32_t       bs_out_rpc_errors;   /* <rpc-error> replies sent */
+};
+
 /* backend handles. Defined in clixon_backend_handle.c */
 clicon_handle backend_handle_init(void);
 
@@ -56,4 +69,6 @@ int backend_client_delete(clicon_handle h, struct client_entry *ce);
 
 int backend_client_print(clicon_handle h, FILE *f);
 
+int backend_stats_get(clicon_handle h, struct backend_stats *bs);
+
 #endif  /* _BACKEND_HANDLE_H_ */
@@ -102,6 +102,8 @@ backend_terminate(clicon_handle h)
     clicon_debug(1, "%s", __FUNCTION__);
     if ((ss = clicon_socket_get(h)) != -1)
         close(ss);
+    /* Release archived rollback generations before dropping datastore caches */
+    rollback_ring_free(h);
     /* Disconnect datastore */
     xmldb_disconnect(h);
     /* Clear module state caches */
@@ -109,7 +111,8 @@ backend_terminate(clicon_handle h)
         xml_free(x);
     if ((x = clicon_modst_cache_get(h, 1)) != NULL)
         xml_free(x);
-    /* Free changelog */
+    /* Free changelog and its compiled plan */
+    xml_changelog_plan_free(h);
     if ((x = clicon_xml_changelog_get(h)) != NULL)
         xml_free(x);
     if ((yspec = clicon_dbspec_yang(h)) != NULL){
@@ -119,6 +122,7 @@ backend_terminate(clicon_handle h)
         ys_free(yspec);
     if ((yspec = clicon_nacm_ext_yang(h)) != NULL)
         ys_free(yspec);
+    yang_file_index_free(h);
     if ((nsctx = clicon_nsctx_global_get(h)) != NULL)
         cvec_free(nsctx);
     if ((x = clicon_nacm_ext(h)) != NULL)
@@ -126,6 +130,7 @@ backend_terminate(clicon_handle h)
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     confirmed_commit_free(h);
+    clixon_rpc_stats_exit(h);
     stream_publish_exit();
     /* Delete all plugins, RPC callbacks, and upgrade callbacks */
     clixon_plugin_module_exit(h);
@@ -705,7 +710,12 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clicon_log_string_limit_set(sz);
-    
+
+    /* Defer log writes to the event loop, see clicon_log_async_init */
+    if ((sz = clicon_option_int(h, "CLICON_LOG_BUFFER")) > 0)
+        if (clicon_log_async_init(sz) < 0)
+            goto done;
+
 #ifndef HAVE_LIBXML2
     if (clicon_yang_regexp(h) ==  REGEXP_LIBXML2){
         clicon_err(OE_FATAL, 0, "CLICON_YANG_REGEXP set to libxml2, but HAVE_LIBXML2 not set (Either change CLICON_YANG_REGEXP to posix, or run: configure --with-libxml2))");
@@ -774,6 +784,23 @@ main(int    argc,
     if (xmldb_connect(h) < 0)
         goto done;
 
+    /* Start asynchronous readahead of the datastore files: the file I/O overlaps
+     * the CPU-bound plugin load and YANG parsing below, so the files are in the
+     * page cache when the startup code parses them
+     */
+    if (xmldb_prefetch(h, "running") < 0)
+        goto done;
+    if (xmldb_prefetch(h, "startup") < 0)
+        goto done;
+
+    /* Enable per-RPC timing breakdown if CLICON_RPC_STATS is set */
+    if (clixon_rpc_stats_init(h) < 0)
+        goto done;
+
+    /* Enable sampled transaction tracing if CLICON_TRACE_SAMPLING is set */
+    if (clixon_trace_init(h) < 0)
+        goto done;
+
     /* Set default namespace according to CLICON_NAMESPACE_NETCONF_DEFAULT */
     xml_nsctx_namespace_netconf_default(h);
     
@@ -1032,8 +1059,10 @@ main(int    argc,
         clicon_err(OE_DAEMON, errno, "Setting signal");
         goto done;
     }
-    /* This is in case restconf daemon forked using process-control API */
-    if (set_signal(SIGCHLD, backend_sig_child, NULL) < 0){
+    /* This is in case restconf daemon forked using process-control API.
+     * Event-loop dispatched: SIGCHLD storms coalesce into one fd event (signalfd)
+     * instead of one EINTR wait restart per child */
+    if (clixon_event_reg_signal(SIGCHLD, backend_sig_child) < 0){
         clicon_err(OE_DAEMON, errno, "Setting signal");
         goto done;
     }
@@ -1056,14 +1085,30 @@ main(int    argc,
 
     /* Start session-id for clients */
     clicon_session_id_set(h, 1);
+    /* In-process rpc dispatch for frontends co-located in the backend process,
+     * eg plugins using clicon_rpc_*: direct function call instead of socket IPC */
+    if (backend_client_dispatch_init(h) < 0)
+        goto done;
 #if 0 /* debug */
     /* Enable this to get prints of datastore and session status */
     if (0 && clicon_debug_get() && 
         backend_timer_setup(0, h) < 0)
         goto done;
 #endif
+    /* Predefined stream where commit deltas are pushed, so clients can patch a
+     * local mirror of running instead of re-reading the full config,
+     * see config-diff in clixon-lib.yang */
+    if (stream_add(h, "CONFIGDIFF", "Configuration commit diffs", 0, NULL) < 0)
+        goto done;
+    /* Predefined stream for RFC 8641-style periodic subscriptions, served from
+     * the running datastore cache with per-subscriber xpath filters,
+     * see push-update in clixon-lib.yang and CLICON_STREAM_PUSH_PERIOD */
+    if (stream_add(h, "YANGPUSH", "Periodic datastore push updates", 0, NULL) < 0)
+        goto done;
     if (stream_timer_setup(0, h) < 0)
         goto done;
+    if (stream_push_timer(0, h) < 0)
+        goto done;
     /* Just before event-loop, after socket bind/listen */
     clicon_log(LOG_NOTICE, "%s: %u Started", __PROGRAM__, getpid());
     if (clixon_event_loop(h) < 0)
@@ -642,6 +642,7 @@ plugin_transaction_begin_all(clicon_handle       h,
     clixon_plugin_t *cp = NULL;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    CLIXON_PROBE4(transaction_begin, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         if (plugin_transaction_begin_one(cp, h, td) < 0)
             goto done;
@@ -701,6 +702,7 @@ plugin_transaction_validate_all(clicon_handle       h,
     int            retval = -1;
     clixon_plugin_t *cp = NULL;
 
+    CLIXON_PROBE4(transaction_validate, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         if (plugin_transaction_validate_one(cp, h, td) < 0)
             goto done;
@@ -762,6 +764,7 @@ plugin_transaction_complete_all(clicon_handle       h,
     int            retval = -1;
     clixon_plugin_t *cp = NULL;
 
+    CLIXON_PROBE4(transaction_complete, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         if (plugin_transaction_complete_one(cp, h, td) < 0)
             goto done;
@@ -788,6 +791,8 @@ plugin_transaction_revert_all(clicon_handle       h,
     int                retval = 0;
     clixon_plugin_t     *cp = NULL;
     trans_cb_t        *fn;
+
+    CLIXON_PROBE2(transaction_revert, td->td_id, nr);
     
     while ((cp = clixon_plugin_each_revert(h, cp, nr)) != NULL) {
         if ((fn = clixon_plugin_api_get(cp)->ca_trans_revert) == NULL)
@@ -855,6 +860,7 @@ plugin_transaction_commit_all(clicon_handle       h,
     clixon_plugin_t *cp = NULL;
     int            i=0;
     
+    CLIXON_PROBE4(transaction_commit, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         i++;
         if (plugin_transaction_commit_one(cp, h, td) < 0){
@@ -918,6 +924,7 @@ plugin_transaction_commit_done_all(clicon_handle       h,
     int            retval = -1;
     clixon_plugin_t *cp = NULL;
 
+    CLIXON_PROBE4(transaction_commit_done, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         if (plugin_transaction_commit_done_one(cp, h, td) < 0)
             goto done;
@@ -977,6 +984,7 @@ plugin_transaction_end_all(clicon_handle h,
     clixon_plugin_t *cp = NULL;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    CLIXON_PROBE4(transaction_end, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         if (plugin_transaction_end_one(cp, h, td) < 0)
             goto done;
@@ -1029,6 +1037,7 @@ plugin_transaction_abort_all(clicon_handle       h,
     clixon_plugin_t *cp = NULL;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    CLIXON_PROBE4(transaction_abort, td->td_id, td->td_alen, td->td_dlen, td->td_clen);
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
         if (plugin_transaction_abort_one(cp, h, td) < 0)
             ; /* dont abort on error */
@@ -82,6 +82,11 @@
  * @retval     s    Socket file descriptor (see socket(2))
  * @retval    -1    Error
  */
+/* Listen backlog of the backend server socket. Clients arrive in bursts, eg
+ * parallel CLI fan-out: give the kernel queue headroom while the event loop
+ * drains, see backend_accept_client */
+#define BACKEND_LISTEN_BACKLOG 128
+
 static int
 config_socket_init_ipv4(clicon_handle h,
                         char         *dst)
@@ -111,10 +116,16 @@ config_socket_init_ipv4(clicon_handle h,
         goto err;
     }
     clicon_debug(1, "Listen on server socket at %s:%hu", dst, port);
-    if (listen(s, 5) < 0){
+    if (listen(s, BACKEND_LISTEN_BACKLOG) < 0){
         clicon_err(OE_UNIX, errno, "listen");
         goto err;
     }
+    /* Non-blocking so a connection burst can be drained in one wakeup without
+     * the last accept blocking, see backend_accept_client */
+    if (fcntl(s, F_SETFL, O_NONBLOCK) < 0){
+        clicon_err(OE_UNIX, errno, "fcntl(O_NONBLOCK)");
+        goto err;
+    }
     return s;
   err:
     close(s);
@@ -178,10 +189,16 @@ config_socket_init_unix(clicon_handle h,
         goto err;
     }
     clicon_debug(1, "Listen on server socket at %s", addr.sun_path);
-    if (listen(s, 5) < 0){
+    if (listen(s, BACKEND_LISTEN_BACKLOG) < 0){
         clicon_err(OE_UNIX, errno, "listen");
         goto err;
     }
+    /* Non-blocking so a connection burst can be drained in one wakeup without
+     * the last accept blocking, see backend_accept_client */
+    if (fcntl(s, F_SETFL, O_NONBLOCK) < 0){
+        clicon_err(OE_UNIX, errno, "fcntl(O_NONBLOCK)");
+        goto err;
+    }
     return s;
   err:
     close(s);
@@ -218,19 +235,19 @@ backend_socket_init(clicon_handle h)
     return -1;
 }
 
-/*! Accept new socket client
- * @param[in]  fd   Socket (unix or ip)
- * @param[in]  arg  typecast clicon_handle
+/*! Set up one accepted client connection
+ * @param[in]  h    Clicon handle
+ * @param[in]  s    Accepted data socket
+ * @param[in]  from Peer address
+ * @retval     0    OK
+ * @retval    -1    Error
  */
-int
-backend_accept_client(int   fd,
-                      void *arg) 
+static int
+backend_accept_client_one(clicon_handle    h,
+                          int              s,
+                          struct sockaddr *from)
 {
     int                  retval = -1;
-    clicon_handle        h = (clicon_handle)arg;
-    int                  s;
-    struct sockaddr      from = {0,};
-    socklen_t            len;
     struct client_entry *ce;
     char                *name = NULL;
 #ifdef HAVE_SO_PEERCRED        /* Linux. */
@@ -241,19 +258,13 @@ backend_accept_client(int   fd,
     uid_t                guid;
 #endif
 
-    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    len = sizeof(from);
-    if ((s = accept(fd, &from, &len)) < 0){
-        clicon_err(OE_UNIX, errno, "accept");
-        goto done;
-    }
-    if ((ce = backend_client_add(h, &from)) == NULL)
+    if ((ce = backend_client_add(h, from)) == NULL)
         goto done;
 
-    /* 
-     * Get credentials of connected peer - only for unix socket 
+    /*
+     * Get credentials of connected peer - only for unix socket
      */
-    switch (from.sa_family){
+    switch (from->sa_family){
     case AF_UNIX:
 #if defined(HAVE_SO_PEERCRED)
         clen =  sizeof(cr);
@@ -299,3 +310,41 @@ backend_accept_client(int   fd,
         free(name);
     return retval;
 }
+
+/*! Accept new socket client(s)
+ *
+ * The server socket is non-blocking: drain all pending connections in one
+ * event-loop wakeup instead of one accept per wakeup, so connection bursts,
+ * eg parallel CLI fan-out, do not back up in the kernel accept queue.
+ * @param[in]  fd   Socket (unix or ip)
+ * @param[in]  arg  typecast clicon_handle
+ */
+int
+backend_accept_client(int   fd,
+                      void *arg)
+{
+    int             retval = -1;
+    clicon_handle   h = (clicon_handle)arg;
+    int             s;
+    struct sockaddr from;
+    socklen_t       len;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    while (1){
+        memset(&from, 0, sizeof(from));
+        len = sizeof(from);
+        if ((s = accept(fd, &from, &len)) < 0){
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break; /* Queue drained */
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue; /* Peer gave up while queued */
+            clicon_err(OE_UNIX, errno, "accept");
+            goto done;
+        }
+        if (backend_accept_client_one(h, s, &from) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
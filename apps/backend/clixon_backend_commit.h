@@ -73,10 +73,13 @@ int startup_commit(clicon_handle h, char *db, cbuf *cbret);
 int candidate_validate(clicon_handle h, char *db, cbuf *cbret);
 int candidate_commit(clicon_handle h, cxobj *xe, char *db, uint32_t myid,
                      validate_level vlev, cbuf *cbret);
+int rollback_ring_free(clicon_handle h);
 
 int from_client_commit(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
+int from_client_commit_queue(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_discard_changes(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_validate(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
+int from_client_rollback(clicon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_restart_one(clicon_handle h, clixon_plugin_t *cp, cbuf *cbret);
 int load_failsafe(clicon_handle h, char *phase);
 
@@ -89,18 +89,36 @@ struct backend_handle {
     clicon_hash_t           *bh_data;      /* internal clicon data (HDR) */
     clicon_hash_t           *ch_db_elmnt;  /* xml datastore element cache data */
     event_stream_t          *bh_stream;    /* notification streams, see clixon_stream.[ch] */
-    
+    struct clicon_option_cache bh_optcache; /* typed snapshot of hot options (HDR) */
+
     /* ------ end of common handle ------ */
     struct client_entry     *bh_ce_list;   /* The client list */
     int                      bh_ce_nr;     /* Number of clients, just increment */
+    struct client_entry     *bh_ce_pool;   /* Recycled client entries, see backend_client_add */
+    int                      bh_ce_poolnr; /* Nr of entries in pool */
+    struct backend_stats     bh_stats;     /* Global statistics, closed-session totals only:
+                                              live sessions are folded in on read, see
+                                              backend_stats_get */
 };
 
+/* Cap of recycled client entries kept for reuse. Short-lived frontend sessions
+ * (one per CLI command) churn entries: reuse bounds the malloc/free traffic
+ * during connection bursts while keeping idle footprint small */
+#define BACKEND_CE_POOL_MAX 64
+
 /*! Creates and returns a clicon config handle for other CLICON API calls
  */
 clicon_handle
 backend_handle_init(void)
 {
-    return clicon_handle_init0(sizeof(struct backend_handle));
+    clicon_handle          h;
+    struct backend_handle *bh;
+
+    if ((h = clicon_handle_init0(sizeof(struct backend_handle))) == NULL)
+        return NULL;
+    bh = handle(h);
+    gettimeofday(&bh->bh_stats.bs_start_time, NULL); /* netconf-start-time */
+    return h;
 }
 
 /*! Deallocates a backend handle, including all client structs
@@ -110,6 +128,7 @@ backend_handle_init(void)
 int
 backend_handle_exit(clicon_handle h)
 {
+    struct backend_handle *bh = handle(h);
     struct client_entry   *ce;
 
     /* only delete client structs, not close sockets, etc, see backend_client_rm WHY NOT? */
@@ -120,6 +139,11 @@ backend_handle_exit(clicon_handle h)
         }
         backend_client_delete(h, ce);
     }
+    /* Drain the recycled-entry pool */
+    while ((ce = bh->bh_ce_pool) != NULL){
+        bh->bh_ce_pool = ce->ce_next;
+        free(ce);
+    }
     clicon_handle_exit(h); /* frees h and options (and streams) */
     return 0;
 }
@@ -137,7 +161,12 @@ backend_client_add(clicon_handle    h,
     struct backend_handle *bh = handle(h);
     struct client_entry   *ce;
 
-    if ((ce = (struct client_entry *)malloc(sizeof(*ce))) == NULL){
+    /* Reuse a recycled entry if available, see backend_client_delete */
+    if ((ce = bh->bh_ce_pool) != NULL){
+        bh->bh_ce_pool = ce->ce_next;
+        bh->bh_ce_poolnr--;
+    }
+    else if ((ce = (struct client_entry *)malloc(sizeof(*ce))) == NULL){
         clicon_err(OE_PLUGIN, errno, "malloc");
         return NULL;
     }
@@ -153,6 +182,7 @@ backend_client_add(clicon_handle    h,
     clicon_session_id_set(h, ce->ce_id + 1);
     gettimeofday(&ce->ce_time, NULL);
     bh->bh_ce_list = ce;
+    bh->bh_stats.bs_in_sessions++;
     return ce;
 }
 
@@ -185,13 +215,28 @@ backend_client_delete(clicon_handle        h,
     for (c = *ce_prev; c; c = c->ce_next){
         if (c == ce){
             *ce_prev = c->ce_next;
+            /* Fold the departing session's counters into the global totals */
+            bh->bh_stats.bs_in_rpcs += ce->ce_in_rpcs;
+            bh->bh_stats.bs_in_bad_rpcs += ce->ce_in_bad_rpcs;
+            bh->bh_stats.bs_out_rpc_errors += ce->ce_out_rpc_errors;
+            if (!ce->ce_graceful)
+                bh->bh_stats.bs_dropped_sessions++;
             if (ce->ce_username)
                 free(ce->ce_username);
             if (ce->ce_transport)
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
-            free(ce);
+            if (ce->ce_candidate)
+                free(ce->ce_candidate);
+            /* Recycle the entry for the next client, see backend_client_add */
+            if (bh->bh_ce_poolnr < BACKEND_CE_POOL_MAX){
+                ce->ce_next = bh->bh_ce_pool;
+                bh->bh_ce_pool = ce;
+                bh->bh_ce_poolnr++;
+            }
+            else
+                free(ce);
             break;
         }
         ce_prev = &c->ce_next;
@@ -199,6 +244,32 @@ backend_client_delete(clicon_handle        h,
     return 0;
 }
 
+/*! Get global netconf-monitoring statistics, aggregated over live sessions
+ *
+ * The handle holds closed-session totals only; the per-session counters of
+ * live sessions are plain fields updated inline on rpc dispatch and folded in
+ * here, so reading the statistics is the only place that aggregates.
+ * @param[in]  h   Clicon handle
+ * @param[out] bs  Statistics
+ * @retval     0   OK
+ * @see RFC 6022 Section 2.1.5
+ */
+int
+backend_stats_get(clicon_handle         h,
+                  struct backend_stats *bs)
+{
+    struct backend_handle *bh = handle(h);
+    struct client_entry   *ce;
+
+    *bs = bh->bh_stats;
+    for (ce = bh->bh_ce_list; ce; ce = ce->ce_next){
+        bs->bs_in_rpcs += ce->ce_in_rpcs;
+        bs->bs_in_bad_rpcs += ce->ce_in_bad_rpcs;
+        bs->bs_out_rpc_errors += ce->ce_out_rpc_errors;
+    }
+    return 0;
+}
+
 /*! Debug print backend clients
  * @param[in]  h   Clicon handle
  * @param[in]  f   UNIX output stream
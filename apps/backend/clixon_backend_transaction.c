@@ -201,6 +201,150 @@ transaction_clen(transaction_data td)
     return ((transaction_data_t *)td)->td_clen;
 }
 
+/*! Find existing group for a schema node in the group vector being built
+ * The diff vectors are in document order so consecutive nodes usually share schema
+ * node: check the last group first, then fall back to linear search (the number of
+ * distinct schema nodes in a diff is small).
+ */
+static transaction_group *
+transaction_group_find(transaction_group **tgv,
+                       size_t              tglen,
+                       yang_stmt          *y)
+{
+    size_t i;
+
+    if (tglen && tgv[tglen-1]->tg_yang == y)
+        return tgv[tglen-1];
+    for (i=0; i<tglen; i++)
+        if (tgv[i]->tg_yang == y)
+            return tgv[i];
+    return NULL;
+}
+
+/*! Group one transaction diff vector by YANG schema node for batched processing
+ *
+ * Instead of iterating dvec/avec/scvec/tcvec node-by-node, a plugin can request the
+ * nodes batched per schema node and program system state with bulk operations,
+ * eg one netlink batch for all added route entries.
+ * The groups reference the transaction diff nodes directly (no copies) and are only
+ * valid for the duration of the callback; free with transaction_groups_free().
+ * For TG_OP_CHANGE, tg_svec[i] and tg_tvec[i] form the same source/target pairs as
+ * scvec/tcvec.
+ * @param[in]  td     Transaction data
+ * @param[in]  op     Which diff vector to group, see enum transaction_group_op
+ * @param[out] tgvp   Vector of groups, in document order of first occurrence
+ * @param[out] tglenp Length of group vector
+ * @retval     0      OK
+ * @retval     -1     Error
+ * @code
+ * transaction_group **tgv = NULL;
+ * size_t              tglen = 0;
+ * if (transaction_groups_new(td, TG_OP_ADD, &tgv, &tglen) < 0)
+ *    err;
+ * for (i=0; i<tglen; i++)
+ *    ; // program all clixon_xvec_len(tgv[i]->tg_tvec) nodes in one operation
+ * transaction_groups_free(tgv, tglen);
+ * @endcode
+ * @see transaction_groups_free
+ */
+int
+transaction_groups_new(transaction_data            td,
+                       enum transaction_group_op   op,
+                       transaction_group        ***tgvp,
+                       size_t                     *tglenp)
+{
+    int                 retval = -1;
+    transaction_data_t *tdt = (transaction_data_t *)td;
+    transaction_group **tgv = NULL;
+    transaction_group **tmp;
+    transaction_group  *tg;
+    size_t              tglen = 0;
+    cxobj             **svec = NULL;
+    cxobj             **tvec = NULL;
+    int                 len = 0;
+    yang_stmt          *y;
+    int                 i;
+
+    switch (op){
+    case TG_OP_DEL:
+        svec = tdt->td_dvec;
+        len = tdt->td_dlen;
+        break;
+    case TG_OP_ADD:
+        tvec = tdt->td_avec;
+        len = tdt->td_alen;
+        break;
+    case TG_OP_CHANGE:
+        svec = tdt->td_scvec;
+        tvec = tdt->td_tcvec;
+        len = tdt->td_clen;
+        break;
+    default:
+        clicon_err(OE_CFG, EINVAL, "Unknown group op %d", op);
+        goto done;
+    }
+    for (i=0; i<len; i++){
+        /* Group on target schema node where there is one (same as source for CHANGE).
+         * Nodes without bound schema (anyxml contents etc) end up in one NULL group. */
+        y = xml_spec(tvec ? tvec[i] : svec[i]);
+        if ((tg = transaction_group_find(tgv, tglen, y)) == NULL){
+            if ((tmp = realloc(tgv, (tglen+1)*sizeof(*tgv))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                goto done;
+            }
+            tgv = tmp;
+            if ((tg = malloc(sizeof(*tg))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(tg, 0, sizeof(*tg));
+            tg->tg_yang = y;
+            tgv[tglen++] = tg; /* link first so error cleanup in done frees it */
+            if (svec && (tg->tg_svec = clixon_xvec_new()) == NULL)
+                goto done;
+            if (tvec && (tg->tg_tvec = clixon_xvec_new()) == NULL)
+                goto done;
+        }
+        if (svec && clixon_xvec_append(tg->tg_svec, svec[i]) < 0)
+            goto done;
+        if (tvec && clixon_xvec_append(tg->tg_tvec, tvec[i]) < 0)
+            goto done;
+    }
+    *tgvp = tgv;
+    tgv = NULL;
+    *tglenp = tglen;
+    retval = 0;
+ done:
+    if (tgv)
+        transaction_groups_free(tgv, tglen);
+    return retval;
+}
+
+/*! Free group vector returned by transaction_groups_new
+ * Frees the groups and their vectors, not the XML nodes which belong to the transaction.
+ * @param[in]  tgv   Vector of groups (may be NULL)
+ * @param[in]  tglen Length of group vector
+ * @retval     0     OK
+ */
+int
+transaction_groups_free(transaction_group **tgv,
+                        size_t              tglen)
+{
+    size_t i;
+
+    if (tgv == NULL)
+        return 0;
+    for (i=0; i<tglen; i++){
+        if (tgv[i]->tg_svec)
+            clixon_xvec_free(tgv[i]->tg_svec);
+        if (tgv[i]->tg_tvec)
+            clixon_xvec_free(tgv[i]->tg_tvec);
+        free(tgv[i]);
+    }
+    free(tgv);
+    return 0;
+}
+
 /*! Print info about transaction on FILE, including what has changed
  *
  * @param[in] f   stdio FILE
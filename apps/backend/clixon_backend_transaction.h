@@ -42,6 +42,27 @@
 #ifndef _CLIXON_BACKEND_TRANSACTION_H_
 #define _CLIXON_BACKEND_TRANSACTION_H_
 
+/*
+ * Types
+ */
+/*! One batch of transaction diff nodes sharing the same YANG schema node
+ * For example, all added /routes/route list entries of a commit form one group,
+ * so that a plugin can program them with one bulk operation instead of per-node calls.
+ * @see transaction_groups_new
+ */
+typedef struct {
+    yang_stmt   *tg_yang;  /* YANG schema node common to all nodes in the group */
+    clixon_xvec *tg_svec;  /* Source nodes: deleted or source-changed, NULL for ADD groups */
+    clixon_xvec *tg_tvec;  /* Target nodes: added or target-changed, NULL for DEL groups */
+} transaction_group;
+
+/* Which transaction diff vector to group, see transaction_groups_new */
+enum transaction_group_op{
+    TG_OP_DEL = 0,  /* Deleted nodes (dvec) */
+    TG_OP_ADD,      /* Added nodes (avec) */
+    TG_OP_CHANGE,   /* Changed node pairs (scvec/tcvec) */
+};
+
 /*
  * Prototypes
  */
@@ -61,6 +82,10 @@ cxobj **transaction_scvec(transaction_data td);
 cxobj **transaction_tcvec(transaction_data td);
 size_t  transaction_clen(transaction_data td);
 
+int transaction_groups_new(transaction_data td, enum transaction_group_op op,
+                           transaction_group ***tgvp, size_t *tglenp);
+int transaction_groups_free(transaction_group **tgv, size_t tglen);
+
 int transaction_print(FILE *f, transaction_data th);
 int transaction_dbg(clicon_handle h, int dbglevel, transaction_data th, const char *msg);
 int transaction_log(clicon_handle h, transaction_data th, int level, const char *op);
@@ -71,6 +71,13 @@
 #include "cli_plugin.h"
 #include "cli_common.h"
 
+/* Bulk-load accumulation tree attached to the handle with clicon_ptr.
+ * When set, cli_dbxml appends its edits here instead of sending one edit-config
+ * per command; the whole tree is sent as a single edit-config when the load is
+ * done, see load_config_file
+ */
+#define CLI_BULK_EDIT_NAME "cli-bulk-edit"
+
 /*! Register log notification stream
  * @param[in] h       Clicon handle
  * @param[in] stream  Event stream. CLICON is predefined, others are application-defined
@@ -295,6 +302,7 @@ cli_dbxml(clicon_handle       h,
     yang_stmt *y = NULL;        /* yang spec of xpath */
     cxobj     *xtop = NULL;     /* xpath root */
     cxobj     *xerr = NULL;
+    cxobj     *xbulk = NULL;    /* bulk-load accumulation tree, NULL normally */
     int        ret;
     cg_var    *cv;
     int        cvv_i = 0;
@@ -367,6 +375,15 @@ cli_dbxml(clicon_handle       h,
      */
     if ((ret = xml_apply0(xbot, CX_ELMNT, identityref_add_ns, yspec)) < 0)
         goto done;
+    /* Bulk load: accumulate edits, sent as a single edit-config by load_config_file */
+    clicon_ptr_get(h, CLI_BULK_EDIT_NAME, (void**)&xbulk);
+    if (xbulk != NULL){
+        while (xml_child_nr(xtop) > 0)
+            if (xml_addsub(xbulk, xml_child_i(xtop, 0)) < 0)
+                goto done;
+        retval = 0;
+        goto done;
+    }
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
@@ -810,18 +827,22 @@ compare_xmls(cxobj           *xc1,
 }
 
 /*! Compare two dbs using XML. Write to file and run diff
+ *
+ * The diff is computed by the backend against its cached trees and only the
+ * differing subtrees plus ancestor context are transferred and rendered, so
+ * the comparison is proportional to the change and not to the datastore
+ * size, see clicon_rpc_datastore_diff.
  * @param[in]   h     Clicon handle
- * @param[in]   cvv  
+ * @param[in]   cvv
  * @param[in]   argv  arg: 0 as xml, 1: as text
  */
 int
-compare_dbs(clicon_handle h, 
-            cvec         *cvv, 
+compare_dbs(clicon_handle h,
+            cvec         *cvv,
             cvec         *argv)
 {
-    cxobj *xc1 = NULL; /* running xml */
-    cxobj *xc2 = NULL; /* candidate xml */
-    cxobj *xerr = NULL;
+    cxobj *xc1 = NULL; /* running delta xml */
+    cxobj *xc2 = NULL; /* candidate delta xml */
     int    retval = -1;
     enum format_enum format;
 
@@ -833,24 +854,14 @@ compare_dbs(clicon_handle h,
         format = FORMAT_TEXT;
     else
         format = FORMAT_XML;
-    if (clicon_rpc_get_config(h, NULL, "running", "/", NULL, NULL, &xc1) < 0)
-        goto done;
-    if ((xerr = xpath_first(xc1, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "Get configuration", NULL);
+    if (clicon_rpc_datastore_diff(h, "running", "candidate", &xc1, &xc2) < 0)
         goto done;
-    }
-    if (clicon_rpc_get_config(h, NULL, "candidate", "/", NULL, NULL, &xc2) < 0)
-        goto done;
-    if ((xerr = xpath_first(xc2, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "Get configuration", NULL);
-        goto done;
-    }
     if (compare_xmls(xc1, xc2, format) < 0) /* astext? */
         goto done;
     retval = 0;
   done:
     if (xc1)
-        xml_free(xc1);    
+        xml_free(xc1);
     if (xc2)
         xml_free(xc2);
     return retval;
@@ -861,11 +872,13 @@ compare_dbs(clicon_handle h,
  * Note that the CLI function makes no Validation of the XML sent to the backend
  * @param[in] h     CLICON handle
  * @param[in] cvv   Vector of variables (where <varname> is found)
- * @param[in] argv  A string: "<varname> <operation> [<format>]"
+ * @param[in] argv  A string: "<varname> <operation> [<format> [bulk]]"
  *   <varname> is name of a variable occuring in "cvv" containing filename
  *   <operation> : merge or replace
  *   <format>  "text"|"xml"|"json"|"cli"|"netconf" (see format_enum)
- * 
+ *   "bulk"  For the cli format: accumulate the edits of all commands and send them
+ *           as a single edit-config instead of one backend round trip per command
+ *
  * @note that "filename" is local on client filesystem not backend. 
  * @note file is assumed to have a dummy top-tag, eg <clicon></clicon>
  * @code
@@ -893,11 +906,14 @@ load_config_file(clicon_handle h,
     char            *formatstr = NULL;
     enum format_enum format = FORMAT_XML;
     yang_stmt       *yspec;
-    cxobj           *xerr = NULL; 
+    cxobj           *xerr = NULL;
     char            *lineptr = NULL;
+    char            *bulkstr;
+    int              bulk = 0;
+    cxobj           *xbulk = NULL;
 
     if (cvec_len(argv) < 2 || cvec_len(argv) > 4){
-        clicon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <dbname>,<varname>[,<format>]",
+        clicon_err(OE_PLUGIN, EINVAL, "Received %d arguments. Expected: <dbname>,<varname>[,<format>[,bulk]]",
                    cvec_len(argv));
         goto done;
     }
@@ -912,6 +928,18 @@ load_config_file(clicon_handle h,
             goto done;
         }
     }
+    if (cvec_len(argv) > 3){
+        bulkstr = cv_string_get(cvec_i(argv, 3));
+        if (strcmp(bulkstr, "bulk") != 0){
+            clicon_err(OE_PLUGIN, 0, "Expected \"bulk\": %s", bulkstr);
+            goto done;
+        }
+        if (format != FORMAT_CLI){
+            clicon_err(OE_PLUGIN, 0, "bulk is only applicable to the cli format");
+            goto done;
+        }
+        bulk = 1;
+    }
     varstr = cv_string_get(cvec_i(argv, 0));
     opstr  = cv_string_get(cvec_i(argv, 1));
     if (strcmp(opstr, "merge") == 0) 
@@ -971,6 +999,14 @@ load_config_file(clicon_handle h,
             int           evalresult = 0;    /* if result == 1, calback result */
             size_t        n;
 
+            if (bulk){
+                /* Commands accumulate their edits here instead of sending one
+                 * edit-config each, see cli_dbxml */
+                if ((xbulk = xml_new(NETCONF_INPUT_CONFIG, NULL, CX_ELMNT)) == NULL)
+                    goto done;
+                if (clicon_ptr_set(h, CLI_BULK_EDIT_NAME, xbulk) < 0)
+                    goto done;
+            }
             while(!cligen_exiting(cli_cligen(h))) {
                 lineptr = NULL; n = 0;
                 if (getline(&lineptr, &n, fp) < 0){
@@ -978,10 +1014,10 @@ load_config_file(clicon_handle h,
                         clicon_err(OE_UNIX, errno, "getline");
                         goto done;
                     }
-                    goto ok; /* eof, skip backend rpc since this is done by cli code */
+                    break; /* eof */
                 }
                 if (clicon_parse(h, lineptr, &mode, &result, &evalresult) < 0)
-                    goto done;  
+                    goto done;
                 if (result != 1) /* Not unique match */
                     goto done;
                 if (evalresult < 0)
@@ -991,7 +1027,18 @@ load_config_file(clicon_handle h,
                     lineptr = NULL;
                 }
             }
-            break;
+            if (xbulk != NULL){
+                clicon_ptr_set(h, CLI_BULK_EDIT_NAME, NULL);
+                if (xml_child_nr(xbulk) > 0){
+                    if ((cbxml = cbuf_new()) == NULL)
+                        goto done;
+                    if (clixon_xml2cbuf(cbxml, xbulk, 0, 0, -1, 0) < 0)
+                        goto done;
+                    if (clicon_rpc_edit_config(h, "candidate", OP_NONE, cbuf_get(cbxml)) < 0)
+                        goto done;
+                }
+            }
+            goto ok; /* skip backend rpc below since this is done by cli code */
         }
     default:
         clicon_err(OE_PLUGIN, 0, "format: %s not implemented", formatstr);
@@ -1016,10 +1063,14 @@ load_config_file(clicon_handle h,
  ok:
     ret = 0;
  done:
+    if (xbulk){
+        clicon_ptr_set(h, CLI_BULK_EDIT_NAME, NULL);
+        xml_free(xbulk);
+    }
     if (cbxml)
         cbuf_free(cbxml);
     if (lineptr)
-        free(lineptr); 
+        free(lineptr);
    if (xerr)
         xml_free(xerr);
     if (xt)
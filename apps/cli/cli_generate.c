@@ -88,9 +88,12 @@ You can see which CLISPEC it generates via clixon_cli -D 2:
 #include <stdlib.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <syslog.h>
 #include <signal.h>
 #include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -1298,8 +1301,242 @@ yang2cli_post(clicon_handle h,
     return retval;
 }
 
+/*---------------------------------------------------------------
+ * Generated clispec disk cache
+ * If CLICON_CLI_AUTOCLI_CACHE_DIR is set, the CLIgen spec text generated from YANG
+ * is saved to a file there, keyed by a digest of the generation inputs. Later CLI
+ * invocations with the same modules and autocli config parse the cached text
+ * instead of traversing YANG in yang2cli_stmt, cutting startup time for scripted
+ * one-shot commands. Post-processing still runs on the parsed trees per module.
+ * The compiled parse-trees themselves are not serialized: cg_obj is internal to
+ * CLIgen and holds resolved callback pointers, so reload goes through
+ * cligen_parse_str on the cached text, mapped copy-on-write from the file.
+ */
+
+/* Name of the cache file within CLICON_CLI_AUTOCLI_CACHE_DIR */
+#define AUTOCLI_CACHE_FILE "autocli.cli"
+
+/* First line of the cache file: magic followed by input digest in hex */
+#define AUTOCLI_CACHE_MAGIC "#clixon-autocli-cache"
+
+/* Separator line preceding each module section in the cache file */
+#define AUTOCLI_CACHE_MODULE "#autocli-module"
+
+/*! Digest of the autocli generation inputs: modules, revisions and autocli config
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Top-level Yang statement of type Y_SPEC
+ * @retval     digest djb2 hash of the inputs
+ */
+static uint32_t
+yang2cli_cache_digest(clicon_handle h,
+                      yang_stmt    *yspec)
+{
+    uint32_t   digest = 5381; /* djb2 */
+    yang_stmt *ymod;
+    yang_stmt *yrev;
+    cxobj     *xautocli;
+    cbuf      *cb = NULL;
+    char      *str;
+    int        i;
+
+#ifdef CLIXON_VERSION
+    for (str = CLIXON_VERSION; *str; str++)
+        digest = (digest << 5) + digest + (uint32_t)*str;
+#endif
+    ymod = NULL;
+    while ((ymod = yn_each(yspec, ymod)) != NULL){
+        for (str = yang_argument_get(ymod); str && *str; str++)
+            digest = (digest << 5) + digest + (uint32_t)*str;
+        if ((yrev = yang_find(ymod, Y_REVISION, NULL)) != NULL)
+            for (str = yang_argument_get(yrev); str && *str; str++)
+                digest = (digest << 5) + digest + (uint32_t)*str;
+    }
+    /* Autocli config decides module filtering, modes and completion style */
+    if ((xautocli = clicon_conf_autocli(h)) != NULL &&
+        (cb = cbuf_new()) != NULL){
+        if (clixon_xml2cbuf(cb, xautocli, 0, 0, -1, 0) == 0)
+            for (i = 0; i < cbuf_len(cb); i++)
+                digest = (digest << 5) + digest + (uint32_t)cbuf_get(cb)[i];
+        cbuf_free(cb);
+    }
+    return digest;
+}
+
+/*! Parse one generated module section: mirrors the generation path in yang2cli_yspec
+ * @param[in]  h     Clixon handle
+ * @param[in]  ymod  Yang module the text was generated from
+ * @param[in]  text  Generated CLIgen spec text for the module
+ * @param[out] pt0   Parse-tree to merge into
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+yang2cli_module_parse(clicon_handle h,
+                      yang_stmt    *ymod,
+                      char         *text,
+                      parse_tree   *pt0)
+{
+    int         retval = -1;
+    parse_tree *pt = NULL;
+    char       *prefix;
+    cg_obj     *co;
+    int         i;
+    int         config;
+
+    if ((prefix = yang_find_myprefix(ymod)) == NULL){
+        clicon_err(OE_YANG, 0, "Module %s lacks prefix", yang_argument_get(ymod)); /* shouldnt happen */
+        goto done;
+    }
+    if ((pt = pt_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "pt_new");
+        goto done;
+    }
+    /* Parse the buffer using cligen parser. load cli syntax */
+    if (cligen_parse_str(cli_cligen(h), text, "yang2cli", pt, NULL) < 0)
+        goto done;
+    /* Add prefix: assume new are appended */
+    for (i=0; i<pt_len_get(pt); i++){
+        if ((co = pt_vec_i_get(pt, i)) != NULL)
+            co_prefix_set(co, prefix);
+    }
+    /* Post-processing, iterate over the generated cligen parse-tree with corresponding yang */
+    config = 1;
+    if (yang2cli_post(h, NULL, pt, 0, ymod, NULL, &config) < 0)
+        goto done;
+    if (cligen_parsetree_merge(pt0, NULL, pt) < 0){
+        clicon_err(OE_YANG, errno, "cligen_parsetree_merge");
+        goto done;
+    }
+    pt_free(pt, 1);
+    pt = NULL;
+    retval = 0;
+ done:
+    if (pt)
+        pt_free(pt, 1);
+    return retval;
+}
+
+/*! Try loading generated clispec from the cache file
+ * The file is mapped copy-on-write rather than read into a heap buffer: the
+ * section terminators below are poked into the private mapping while untouched
+ * pages stay backed by the page cache and are shared between CLI starts.
+ * Any mismatch - missing file, stale digest, unknown module, parse failure - is
+ * not an error: the caller falls back to generating from YANG and rewrites the file.
+ * @param[in]     h        Clixon handle
+ * @param[in]     yspec    Top-level Yang statement of type Y_SPEC
+ * @param[in]     digest   Expected input digest, see yang2cli_cache_digest
+ * @param[in]     filename Cache file path
+ * @param[in,out] pt0p     Empty parse-tree, replaced by the loaded tree on success
+ * @param[out]    loaded   Set if the cache was valid and *pt0p replaced
+ * @retval        0        OK
+ * @retval       -1        Error
+ */
+static int
+yang2cli_cache_load(clicon_handle h,
+                    yang_stmt    *yspec,
+                    uint32_t      digest,
+                    char         *filename,
+                    parse_tree  **pt0p,
+                    int          *loaded)
+{
+    int         retval = -1;
+    int         fd = -1;
+    char       *buf = MAP_FAILED;
+    struct stat st = {0,};
+    char       *line;
+    char       *modname;
+    char       *text = NULL;
+    yang_stmt  *ymod = NULL;
+    parse_tree *ptc = NULL;
+    uint32_t    d = 0;
+
+    *loaded = 0;
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        goto ok;
+    if (fstat(fd, &st) < 0 || st.st_size == 0)
+        goto ok;
+    if ((buf = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+        goto ok;
+    /* The writer ends every section with a newline, reuse the last one as
+     * string terminator (a page past end-of-file cannot be mapped) */
+    if (buf[st.st_size-1] != '\n')
+        goto ok; /* truncated file */
+    buf[st.st_size-1] = '\0';
+    /* First line: magic and digest */
+    if (strncmp(buf, AUTOCLI_CACHE_MAGIC " ", strlen(AUTOCLI_CACHE_MAGIC)+1) != 0)
+        goto ok;
+    if (sscanf(buf + strlen(AUTOCLI_CACHE_MAGIC), " %x", &d) != 1 || d != digest)
+        goto ok;
+    if ((ptc = pt_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "pt_new");
+        goto done;
+    }
+    /* Split into module sections, each starts with a separator line */
+    line = buf;
+    while ((line = strstr(line, "\n" AUTOCLI_CACHE_MODULE " ")) != NULL){
+        *line = '\0'; /* terminate previous section text */
+        modname = line + strlen(AUTOCLI_CACHE_MODULE) + 2;
+        if ((line = strchr(modname, '\n')) == NULL)
+            goto ok; /* truncated file */
+        *line++ = '\0';
+        /* Parse the previous module section, now that its text is terminated */
+        if (ymod != NULL &&
+            yang2cli_module_parse(h, ymod, text, ptc) < 0)
+            goto ok; /* stale text, regenerate */
+        if ((ymod = yang_find_module_by_name(yspec, modname)) == NULL)
+            goto ok; /* module set changed beyond digest, regenerate */
+        text = line;
+    }
+    if (ymod != NULL &&
+        yang2cli_module_parse(h, ymod, text, ptc) < 0)
+        goto ok;
+    /* Hand the staged tree to the caller instead of copying it into the empty
+     * tree with cligen_parsetree_merge */
+    pt_free(*pt0p, 1);
+    *pt0p = ptc;
+    ptc = NULL;
+    clicon_debug(1, "%s loaded generated autocli from %s", __FUNCTION__, filename);
+    *loaded = 1;
+ ok:
+    retval = 0;
+ done:
+    if (ptc)
+        pt_free(ptc, 1);
+    if (buf != MAP_FAILED)
+        munmap(buf, st.st_size);
+    if (fd >= 0)
+        close(fd);
+    return retval;
+}
+
+/*! Write generated clispec module sections to the cache file
+ * A write failure is logged but not fatal: the cache is an optimization only.
+ * @param[in]  h        Clixon handle
+ * @param[in]  filename Cache file path
+ * @param[in]  digest   Input digest, see yang2cli_cache_digest
+ * @param[in]  cbcache  Module sections accumulated during generation
+ * @retval     0        OK
+ */
+static int
+yang2cli_cache_write(clicon_handle h,
+                     char         *filename,
+                     uint32_t      digest,
+                     cbuf         *cbcache)
+{
+    FILE *f;
+
+    if ((f = fopen(filename, "w")) == NULL){
+        clicon_log(LOG_WARNING, "%s: fopen %s: %s", __FUNCTION__, filename, strerror(errno));
+        return 0;
+    }
+    fprintf(f, AUTOCLI_CACHE_MAGIC " %x\n", digest);
+    fputs(cbuf_get(cbcache), f);
+    fclose(f);
+    return 0;
+}
+
 /*! Generate clispec for all modules in yspec (except excluded)
- * 
+ *
  * @param[in]  h         Clixon handle
  * @param[in]  yspec     Top-level Yang statement of type Y_SPEC
  * @param[in]  treename  Name of tree
@@ -1324,7 +1561,12 @@ yang2cli_yspec(clicon_handle      h,
     cg_obj         *co;
     int             i;
     int             config;
-    
+    char           *cachedir;
+    char            filename[MAXPATHLEN] = {0,};
+    uint32_t        digest = 0;
+    cbuf           *cbcache = NULL;
+    int             loaded = 0;
+
     if ((pt0 = pt_new()) == NULL){
         clicon_err(OE_UNIX, errno, "pt_new");
         goto done;
@@ -1333,9 +1575,21 @@ yang2cli_yspec(clicon_handle      h,
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
+    /* If a cache dir is configured, try loading previously generated clispec */
+    if ((cachedir = clicon_option_str(h, "CLICON_CLI_AUTOCLI_CACHE_DIR")) != NULL){
+        digest = yang2cli_cache_digest(h, yspec);
+        snprintf(filename, sizeof(filename), "%s/%s", cachedir, AUTOCLI_CACHE_FILE);
+        if (yang2cli_cache_load(h, yspec, digest, filename, &pt0, &loaded) < 0)
+            goto done;
+        if (!loaded &&
+            (cbcache = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+    }
     /* Traverse YANG, loop through all modules and generate CLI */
     ymod = NULL;
-    while ((ymod = yn_each(yspec, ymod)) != NULL){
+    while (!loaded && (ymod = yn_each(yspec, ymod)) != NULL){
         /* Filter module name according to cli_autocli.yang setting
          * Default is pass and ordering is significant
          */
@@ -1348,6 +1602,11 @@ yang2cli_yspec(clicon_handle      h,
             goto done;
         if (cbuf_len(cb) == 0)
             continue;
+        if (cbcache){
+            cprintf(cbcache, AUTOCLI_CACHE_MODULE " %s\n", yang_argument_get(ymod));
+            cbuf_append_str(cbcache, cbuf_get(cb));
+            cprintf(cbcache, "\n");
+        }
         /* Note Tie-break of same top-level symbol: prefix is NYI
          * Needs to move cligen_parse_str() call here instead of later
          */
@@ -1394,6 +1653,10 @@ yang2cli_yspec(clicon_handle      h,
         pt_free(pt, 1);
         pt = NULL;
     } /* ymod */
+    /* Save generated text for later invocations with the same inputs */
+    if (cbcache &&
+        yang2cli_cache_write(h, filename, digest, cbcache) < 0)
+        goto done;
     /* Resolve the expand callback functions in the generated syntax.
      * This "should" only be GENERATE_EXPAND_XMLDB
      * handle=NULL for global namespace, this means expand callbacks must be in
@@ -1419,11 +1682,45 @@ yang2cli_yspec(clicon_handle      h,
         pt_free(pt, 1);
     if (pt0)
         pt_free(pt0, 1);
+    if (cbcache)
+        cbuf_free(cbcache);
     if (cb)
         cbuf_free(cb);
     return retval;
 }
 
+/*! Run deferred autocli generation, no-op unless generation is pending
+ *
+ * With CLICON_CLI_AUTOCLI_LAZY, startup only records that generation is pending so
+ * the prompt appears immediately; the clispec is generated here, called before the
+ * first command is read or evaluated. Sessions that exit without a command never
+ * pay for generation. Finer, per-subtree laziness would require a tree-reference
+ * resolve hook inside CLIgen, which is not available.
+ * @param[in]  h  Clixon handle
+ * @retval     0  OK
+ * @retval    -1  Error
+ * @see autocli_start where the pending flag is set
+ */
+int
+yang2cli_lazy(clicon_handle h)
+{
+    int   retval = -1;
+    char *str = NULL;
+    int   printgen;
+
+    if (clicon_data_get(h, AUTOCLI_LAZY_PENDING, &str) < 0 || str == NULL)
+        return 0; /* not pending */
+    printgen = (strcmp(str, "1") == 0);
+    /* Clear first: a generation error should not repeat on every command */
+    if (clicon_data_del(h, AUTOCLI_LAZY_PENDING) < 0)
+        goto done;
+    if (yang2cli_yspec(h, clicon_dbspec_yang(h), AUTOCLI_TREENAME, printgen) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Init yang2cli
  *
  * Initialize CLIgen generation from YANG models.
@@ -53,10 +53,16 @@
  */
 #define AUTOCLI_TREENAME "basemodel"
 
+/* Clixon data name used to flag that autocli generation is deferred to first command,
+ * value is the printgen flag. Set in autocli_start, consumed by yang2cli_lazy
+ */
+#define AUTOCLI_LAZY_PENDING "autocli-lazy-pending"
+
 /*
  * Prototypes
  */
 int yang2cli_yspec(clicon_handle h, yang_stmt *yspec, char *treename, int printgen);
+int yang2cli_lazy(clicon_handle h);
 int yang2cli_init(clicon_handle h);
 
 #endif  /* _CLI_GENERATE_H_ */
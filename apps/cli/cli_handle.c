@@ -84,6 +84,7 @@ struct cli_handle {
     clicon_hash_t  *cl_data;     /* internal clicon data (HDR) */
     clicon_hash_t  *ch_db_elmnt; /* xml datastore element cache data */
     event_stream_t *cl_stream;   /* notification streams, see clixon_stream.[ch] */
+    struct clicon_option_cache cl_optcache; /* typed snapshot of hot options (HDR) */
     /* ------ end of common handle ------ */
 
     cligen_handle   cl_cligen;   /* cligen handle */
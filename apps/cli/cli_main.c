@@ -398,8 +398,13 @@ autocli_start(clicon_handle h,
     if (yang2cli_init(h) < 0)
         goto done;
     yspec = clicon_dbspec_yang(h);
+    if (clicon_option_bool(h, "CLICON_CLI_AUTOCLI_LAZY")){
+        /* Defer generation to first command, see yang2cli_lazy */
+        if (clicon_data_set(h, AUTOCLI_LAZY_PENDING, printgen ? "1" : "0") < 0)
+            goto done;
+    }
     /* The actual generating call from yang to clispec for the complete yang spec */
-    if (yang2cli_yspec(h, yspec, AUTOCLI_TREENAME, printgen) < 0)
+    else if (yang2cli_yspec(h, yspec, AUTOCLI_TREENAME, printgen) < 0)
         goto done;
     /* XXX Create pre-5.5 tree-refs for backward compatibility */    
     if (autocli_trees_default(h) < 0)
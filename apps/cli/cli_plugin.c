@@ -567,6 +567,9 @@ clicon_parse(clicon_handle  h,
     cligen_handle     ch;
     
     ch = cli_cligen(h);
+    /* Deferred autocli generation, no-op unless pending */
+    if (yang2cli_lazy(h) < 0)
+        goto done;
     if (clicon_get_logflags()&CLICON_LOG_STDOUT)
         f = stdout;
     else
@@ -779,6 +782,9 @@ clicon_cliread(clicon_handle h,
     }
     cligen_ph_active_set_byname(cli_cligen(h), mode->csm_name);
 
+    /* Deferred autocli generation, no-op unless pending: completion needs the trees */
+    if (yang2cli_lazy(h) < 0)
+        goto done;
     clicon_err_reset();
     if (cliread(cli_cligen(h), stringp) < 0){
         cli_handler_err(stdout);
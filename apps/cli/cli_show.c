@@ -73,6 +73,101 @@
 #include "cli_autocli.h"
 #include "cli_common.h" /* internal functions */
 
+/* Completion cache for expand_dbvar, see CLICON_CLI_EXPAND_CACHE:
+ * maps "<db>:<xpath>" to the expansion values read at a datastore write
+ * serial; a hit at the same serial is served without fetching the config.
+ * Flushed wholesale when full.
+ */
+#define EXPAND_CACHE_MAX 128
+struct expand_cache{
+    uint32_t ec_serial;   /* Datastore write serial the values were read at */
+    cvec    *ec_commands; /* Expansion values */
+};
+static clicon_hash_t *_expand_cache = NULL;
+
+/*! Lookup cached expansion values, append to commands on hit
+ * @param[in]  key      Cache key: "<db>:<xpath>"
+ * @param[in]  serial   Current write serial of the db, see clicon_rpc_datastore_serial
+ * @param[out] commands Expansion vector appended to on hit
+ * @retval     1        Hit, commands appended
+ * @retval     0        Miss or stale
+ */
+static int
+expand_cache_get(char     *key,
+                 uint32_t  serial,
+                 cvec     *commands)
+{
+    struct expand_cache *ec;
+    size_t               len = 0;
+    cg_var              *cv;
+
+    if (_expand_cache == NULL)
+        return 0;
+    if ((ec = clicon_hash_value(_expand_cache, key, &len)) == NULL ||
+        len != sizeof(*ec))
+        return 0;
+    if (ec->ec_serial != serial)
+        return 0;
+    cv = NULL;
+    while ((cv = cvec_each(ec->ec_commands, cv)) != NULL)
+        cvec_add_string(commands, NULL, cv_string_get(cv));
+    return 1;
+}
+
+/*! Cache expansion values read at a given write serial
+ * @param[in]  key      Cache key: "<db>:<xpath>"
+ * @param[in]  serial   Write serial of the db the values were read at
+ * @param[in]  commands Expansion vector as filled by expand_dbvar
+ * @param[in]  offset   First index in commands added by this expansion
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+expand_cache_put(char     *key,
+                 uint32_t  serial,
+                 cvec     *commands,
+                 int       offset)
+{
+    struct expand_cache  ec0 = {0};
+    struct expand_cache *ec;
+    size_t               len = 0;
+    char               **keys = NULL;
+    size_t               klen = 0;
+    int                  i;
+
+    if (_expand_cache != NULL &&
+        clicon_hash_keys(_expand_cache, &keys, &klen) == 0 &&
+        klen >= EXPAND_CACHE_MAX){
+        /* Full: flush wholesale and start over */
+        for (i=0; i<klen; i++)
+            if ((ec = clicon_hash_value(_expand_cache, keys[i], &len)) != NULL &&
+                len == sizeof(*ec) && ec->ec_commands)
+                cvec_free(ec->ec_commands);
+        clicon_hash_free(_expand_cache);
+        _expand_cache = NULL;
+    }
+    if (keys)
+        free(keys);
+    if (_expand_cache == NULL &&
+        (_expand_cache = clicon_hash_init()) == NULL)
+        return -1;
+    if ((ec = clicon_hash_value(_expand_cache, key, &len)) != NULL &&
+        len == sizeof(*ec) && ec->ec_commands)
+        cvec_free(ec->ec_commands); /* replaced below */
+    if ((ec0.ec_commands = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        return -1;
+    }
+    for (i=offset; i<cvec_len(commands); i++)
+        cvec_add_string(ec0.ec_commands, NULL, cv_string_get(cvec_i(commands, i)));
+    ec0.ec_serial = serial;
+    if (clicon_hash_add(_expand_cache, key, &ec0, sizeof(ec0)) == NULL){
+        cvec_free(ec0.ec_commands);
+        return -1;
+    }
+    return 0;
+}
+
 /*! Given an xpath encoded in a cbuf, append a second xpath into the first
  *
  * The method reuses prefixes from xpath1 if they exist, otherwise the module prefix
@@ -214,7 +309,11 @@ expand_dbvar(void   *h,
     cbuf            *cbxpath = NULL;
     yang_stmt       *ypath;
     yang_stmt       *ytype;
-    
+    cbuf            *cbkey = NULL;
+    uint32_t         serial = 0;
+    int              usecache = 0;
+    int              len0 = 0;
+
     if (argv == NULL || cvec_len(argv) != 2){
         clicon_err(OE_PLUGIN, EINVAL, "requires arguments: <db> <xmlkeyfmt>");
         goto done;
@@ -308,8 +407,24 @@ expand_dbvar(void   *h,
         if (xpath_append(cbxpath, yang_argument_get(ypath), y, nsc) < 0)
             goto done;
     }
+    /* Serve repeated completions locally while the datastore is unchanged:
+     * one lightweight serial roundtrip replaces config fetch and xpath eval
+     */
+    if (clicon_option_bool(h, "CLICON_CLI_EXPAND_CACHE")){
+        if ((cbkey = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbkey, "%s:%s", dbstr, cbuf_get(cbxpath));
+        if (clicon_rpc_datastore_serial(h, dbstr, &serial) < 0)
+            goto done;
+        usecache = 1;
+        if (expand_cache_get(cbuf_get(cbkey), serial, commands) == 1)
+            goto ok;
+        len0 = cvec_len(commands);
+    }
     /* Get configuration based on cbxpath */
-    if (clicon_rpc_get_config(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, &xt) < 0) 
+    if (clicon_rpc_get_config(h, NULL, dbstr, cbuf_get(cbxpath), nsc, NULL, &xt) < 0)
         goto done;
     if ((xe = xpath_first(xt, NULL, "/rpc-error")) != NULL){
         clixon_netconf_error(xe, "Get configuration", NULL);
@@ -353,9 +468,14 @@ expand_dbvar(void   *h,
             cvec_add_string(commands, NULL, bodystr);
         }
     }
+    if (usecache &&
+        expand_cache_put(cbuf_get(cbkey), serial, commands, len0) < 0)
+        goto done;
  ok:
     retval = 0;
   done:
+    if (cbkey)
+        cbuf_free(cbkey);
     if (cbxpath)
         cbuf_free(cbxpath);
     if (xerr)
@@ -405,6 +525,135 @@ show_yang(clicon_handle h,
     return retval;
 }
 
+/*! Context for rendering config subtrees as they arrive in a streaming show
+ * @see cli_show_stream_cb
+ */
+struct show_stream {
+    clicon_handle    ss_h;          /* Clixon handle */
+    enum format_enum ss_format;     /* Output format: XML, TEXT or CLI */
+    int              ss_pretty;     /* Pretty-print */
+    char            *ss_prepend;    /* CLI prefix to prepend cli syntax */
+    char            *ss_xpath;      /* XPath selecting nodes to print */
+    cvec            *ss_nsc;        /* Namespace context of ss_xpath */
+    int              ss_skiptop;    /* If set, show only children of matched nodes */
+    char            *ss_extdefault; /* with-defaults propriatary extensions */
+    cxobj           *ss_xdata;      /* Scratch data root subtrees are evaluated under */
+    int              ss_wrap;       /* XPath matches the reply root: print data wrapper */
+    int              ss_wrapped;    /* Set once the wrapper open tag has been printed */
+    int              ss_nr;         /* Nr of printed nodes */
+};
+
+/*! Render one top-level config subtree of a get-config reply as it is parsed
+ *
+ * Streaming counterpart of the render loop in cli_show_common: called for
+ * each subtree under <data> as soon as it is completely parsed, see
+ * clicon_rpc_get_config_cb. The subtree is moved under a scratch <data> root
+ * so that absolute xpaths resolve the same way as in the buffered path, the
+ * matching nodes are printed and flushed, and the subtree is freed. Peak tree
+ * memory is thereby one top-level subtree and output starts before the whole
+ * reply has been processed.
+ * @param[in]  x    Completely parsed subtree, attached to the reply skeleton
+ * @param[in]  arg  struct show_stream
+ * @retval     0    OK
+ * @retval    -1    Abort parse, clicon_err called
+ */
+static int
+cli_show_stream_cb(cxobj *x,
+                   void  *arg)
+{
+    int                 retval = -1;
+    struct show_stream *ss = (struct show_stream *)arg;
+    clicon_handle       h = ss->ss_h;
+    cxobj             **vec = NULL;
+    size_t              veclen = 0;
+    cxobj              *xerr = NULL;
+    cxobj              *xp;
+    int                 ret;
+    int                 i;
+
+    /* Depth also matches children of rpc-error: leave non-data nodes in the
+     * reply skeleton for the error check in cli_show_common */
+    if (xml_parent(x) == NULL ||
+        strcmp(xml_name(xml_parent(x)), NETCONF_OUTPUT_DATA) != 0)
+        goto ok;
+    if (xml_rm(x) < 0)
+        goto done;
+    if (xml_addsub(ss->ss_xdata, x) < 0)
+        goto done;
+    if ((ret = xml_bind_yang0(h, x, YB_MODULE, clicon_dbspec_yang(h), &xerr)) < 0)
+        goto done;
+    if (ret == 0){
+        clixon_netconf_error(xerr, "Get configuration", NULL);
+        goto done;
+    }
+    /* Special tagged modes: strip wd:default=true attribute and (optionally) nodes associated with it */
+    if (ss->ss_extdefault &&
+        (strcmp(ss->ss_extdefault, "report-all-tagged-strip") == 0 ||
+         strcmp(ss->ss_extdefault, "report-all-tagged-default") == 0)){
+        if (purge_tagged_nodes(x, IETF_NETCONF_WITH_DEFAULTS_ATTR_NAMESPACE, "default", "true",
+                               strcmp(ss->ss_extdefault, "report-all-tagged-strip")
+                               ) < 0)
+            goto done;
+        /* Remove empty containers, may purge the subtree itself */
+        if (xml_defaults_nopresence(ss->ss_xdata, 2) < 0)
+            goto done;
+        if (xml_child_nr_type(ss->ss_xdata, CX_ELMNT) == 0){
+            x = NULL;
+            goto ok;
+        }
+    }
+    if (ss->ss_wrap){
+        /* The xpath matches the reply root itself: print the data wrapper once
+         * and each subtree one level below, as the buffered path does in one go */
+        if (ss->ss_wrapped == 0){
+            cligen_output(stdout, "<%s xmlns=\"%s\">", NETCONF_OUTPUT_DATA, NETCONF_BASE_NAMESPACE);
+            if (ss->ss_pretty)
+                cligen_output(stdout, "\n");
+            ss->ss_wrapped = 1;
+        }
+        if (clixon_xml2file(stdout, x, 1, ss->ss_pretty, cligen_output, 0, 1) < 0)
+            goto done;
+        ss->ss_nr++;
+    }
+    else {
+        if (xpath_vec(ss->ss_xdata, ss->ss_nsc, "%s", &vec, &veclen, ss->ss_xpath) < 0)
+            goto done;
+        for (i=0; i<veclen; i++){
+            xp = vec[i];
+            /* Print configuration according to format */
+            switch (ss->ss_format){
+            case FORMAT_XML:
+                if (clixon_xml2file(stdout, xp, 0, ss->ss_pretty, cligen_output, ss->ss_skiptop, 1) < 0)
+                    goto done;
+                break;
+            case FORMAT_TEXT: /* XXX does not handle multiple leaf-list */
+                if (clixon_txt2file(stdout, xp, 0, cligen_output, ss->ss_skiptop, 1) < 0)
+                    goto done;
+                break;
+            case FORMAT_CLI:
+                if (clixon_cli2file(h, stdout, xp, ss->ss_prepend, cligen_output, ss->ss_skiptop) < 0) /* cli syntax */
+                    goto done;
+                break;
+            default:
+                break;
+            }
+        }
+        ss->ss_nr += veclen;
+    }
+    /* First-byte latency: hand each subtree to the pager as it is rendered */
+    fflush(stdout);
+ ok:
+    retval = 0;
+ done:
+    if (retval == 0 && x != NULL && xml_parent(x) == ss->ss_xdata)
+        retval = xml_purge(x);
+    if (vec)
+        free(vec);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
 /*! Common internal show routine for several show cli callbacks
  *
  * @param[in] h            Clixon handle
@@ -433,18 +682,62 @@ cli_show_common(clicon_handle    h,
                 int              skiptop
                 )
 {
-    int           retval = -1;    
+    int           retval = -1;
     cxobj        *xt = NULL;
     cxobj        *xerr;
     cxobj       **vec = NULL;
     size_t        veclen;
     cxobj        *xp;
     int           i;
+    struct show_stream ss = {0,};
 
     if (state && strcmp(db, "running") != 0){
         clicon_err(OE_FATAL, 0, "Show state only for running database, not %s", db);
         goto done;
     }
+    /* Stream: fetch and print subtree-by-subtree instead of materializing the
+     * whole reply as one tree, which bounds memory and starts output before
+     * the whole reply is processed on large configurations, see
+     * cli_show_stream_cb. JSON and NETCONF need the whole matched set for
+     * their framing and state data uses another rpc: those keep the buffered
+     * path below. A root-matching xpath needs the data wrapper printed around
+     * the subtrees, only done for XML. */
+    if (state == 0 && xpath != NULL &&
+        (format == FORMAT_XML || format == FORMAT_TEXT || format == FORMAT_CLI) &&
+        (skiptop || format == FORMAT_XML || strcmp(xpath, "/") != 0)){
+        ss.ss_h = h;
+        ss.ss_format = format;
+        ss.ss_pretty = pretty;
+        ss.ss_prepend = prepend;
+        ss.ss_xpath = xpath;
+        ss.ss_nsc = nsc;
+        ss.ss_skiptop = skiptop;
+        ss.ss_extdefault = extdefault;
+        ss.ss_wrap = (skiptop == 0 && strcmp(xpath, "/") == 0);
+        if ((ss.ss_xdata = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xmlns_set(ss.ss_xdata, NULL, NETCONF_BASE_NAMESPACE) < 0)
+            goto done;
+        if (clicon_rpc_get_config_cb(h, NULL, db, xpath, nsc, withdefault,
+                                     cli_show_stream_cb, &ss, &xt) < 0)
+            goto done;
+        if ((xerr = xpath_first(xt, NULL, "rpc-reply/rpc-error")) != NULL){
+            clixon_netconf_error(xerr, "Get configuration", NULL);
+            goto done;
+        }
+        if (ss.ss_wrap){
+            if (ss.ss_wrapped)
+                cligen_output(stdout, "</%s>\n", NETCONF_OUTPUT_DATA);
+            else if (xpath_first(xt, NULL, "rpc-reply/data") != NULL)
+                cligen_output(stdout, "<%s xmlns=\"%s\"/>\n", NETCONF_OUTPUT_DATA, NETCONF_BASE_NAMESPACE);
+            else
+                cligen_output(stdout, "<%s/>\n", NETCONF_OUTPUT_DATA);
+        }
+        else if (format == FORMAT_XML && !pretty && ss.ss_nr)
+            cligen_output(stdout, "\n");
+        retval = 0;
+        goto done;
+    }
     if (state == 0){     /* Get configuration-only from a database */
         if (clicon_rpc_get_config(h, NULL, db, xpath, nsc, withdefault, &xt) < 0)
             goto done;
@@ -523,6 +816,8 @@ cli_show_common(clicon_handle    h,
         cligen_output(stdout, "{}\n");
     retval = 0;
 done:
+    if (ss.ss_xdata)
+        xml_free(ss.ss_xdata);
     if (vec)
         free(vec);
     if (xt)
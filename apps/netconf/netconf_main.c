@@ -88,6 +88,239 @@ static int ignore_packet_errors = 1;
 /* Hello request received */
 static int _netconf_hello_nr = 0;
 
+/* Streamed rpc-reply output, see netconf_output_stream().
+ * Instead of serializing the complete reply before the first byte is written,
+ * the reply tree is serialized in bounded segments which are written as
+ * RFC 6242 chunks (or raw data with a trailing end-of-message marker for EOM
+ * framing) as the output fd becomes writable, overlapping serialization with
+ * the SSH transport and bounding frontend memory.
+ */
+#define NETCONF_STREAM_CHUNK (64*1024) /* Segment target size */
+
+struct netconf_stream{
+    clixon_xml_cursor   *ns_cursor;  /* Serializer cursor into ns_xret */
+    cxobj               *ns_xret;    /* Reply tree, owned while streaming */
+    cbuf                *ns_data;    /* Staging buffer for one serialized segment */
+    cbuf                *ns_buf;     /* Current framed segment being written */
+    size_t               ns_pos;     /* Bytes of ns_buf already written */
+    netconf_framing_type ns_framing; /* Framing type of this reply */
+    int                  ns_s;       /* Output socket (eg 1 - stdout) */
+    int                  ns_fflags;  /* Original fd flags, O_NONBLOCK restored at teardown */
+    int                  ns_eof;     /* Cursor exhausted, postamble appended to ns_buf */
+    int                  ns_registered; /* Write event callback registered */
+};
+static struct netconf_stream *_netconf_stream = NULL;
+
+static int netconf_output_stream_cb(int s, void *arg);
+
+/*! Free in-flight streamed reply state, restore fd flags, unregister write event
+ */
+static int
+netconf_stream_free(void)
+{
+    struct netconf_stream *ns;
+
+    if ((ns = _netconf_stream) == NULL)
+        return 0;
+    if (ns->ns_registered)
+        clixon_event_unreg_fd_write(ns->ns_s, netconf_output_stream_cb);
+    (void)fcntl(ns->ns_s, F_SETFL, ns->ns_fflags);
+    if (ns->ns_cursor)
+        clixon_xml_cursor_free(ns->ns_cursor);
+    if (ns->ns_xret)
+        xml_free(ns->ns_xret);
+    if (ns->ns_data)
+        cbuf_free(ns->ns_data);
+    if (ns->ns_buf)
+        cbuf_free(ns->ns_buf);
+    free(ns);
+    _netconf_stream = NULL;
+    return 0;
+}
+
+/*! Fill the next framed segment of the streamed reply into ns_buf
+ * @retval  0  OK, ns_buf holds the next segment (or ns_eof set)
+ * @retval -1  Error
+ */
+static int
+netconf_stream_fill(struct netconf_stream *ns)
+{
+    int eof = 0;
+
+    cbuf_reset(ns->ns_buf);
+    cbuf_reset(ns->ns_data);
+    if (clixon_xml_cursor_chunk(ns->ns_cursor, ns->ns_data, NETCONF_STREAM_CHUNK, &eof) < 0)
+        return -1;
+    switch (ns->ns_framing){
+    case NETCONF_SSH_EOM:
+        if (cbuf_len(ns->ns_data))
+            cbuf_append_buf(ns->ns_buf, cbuf_get(ns->ns_data), cbuf_len(ns->ns_data));
+        if (eof)
+            cprintf(ns->ns_buf, "]]>]]>");     /* RFC4742 end-of-message marker */
+        break;
+    case NETCONF_SSH_CHUNKED:
+        if (cbuf_len(ns->ns_data)){            /* RFC6242 chunk */
+            cprintf(ns->ns_buf, "\n#%zu\n", (size_t)cbuf_len(ns->ns_data));
+            cbuf_append_buf(ns->ns_buf, cbuf_get(ns->ns_data), cbuf_len(ns->ns_data));
+        }
+        if (eof)
+            cprintf(ns->ns_buf, "\n##\n");     /* RFC6242 end-of-chunks */
+        break;
+    }
+    ns->ns_eof = eof;
+    ns->ns_pos = 0;
+    return 0;
+}
+
+/*! Write as much of ns_buf as the output fd accepts
+ * @retval  1  Segment completely written
+ * @retval  0  Would block, remainder pending
+ * @retval -1  Error
+ */
+static int
+netconf_stream_write(struct netconf_stream *ns)
+{
+    ssize_t len;
+
+    while (ns->ns_pos < (size_t)cbuf_len(ns->ns_buf)){
+        if ((len = write(ns->ns_s,
+                         cbuf_get(ns->ns_buf) + ns->ns_pos,
+                         cbuf_len(ns->ns_buf) - ns->ns_pos)) < 0){
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            if (errno == EPIPE)
+                clicon_debug(1, "%s write err SIGPIPE", __FUNCTION__);
+            else
+                clicon_log(LOG_ERR, "%s: write: %s", __FUNCTION__, strerror(errno));
+            return -1;
+        }
+        ns->ns_pos += len;
+    }
+    return 1;
+}
+
+/*! Write event callback: advance the in-flight streamed reply
+ * Fills and writes framed segments until the fd would block or the reply is
+ * complete, in which case the stream state is torn down.
+ */
+static int
+netconf_output_stream_cb(int   s,
+                         void *arg)
+{
+    struct netconf_stream *ns;
+    int                    ret;
+
+    if ((ns = _netconf_stream) == NULL)
+        return 0;
+    while (1){
+        if (ns->ns_pos >= (size_t)cbuf_len(ns->ns_buf)){
+            if (ns->ns_eof)
+                break; /* Reply complete */
+            if (netconf_stream_fill(ns) < 0)
+                goto err;
+        }
+        if ((ret = netconf_stream_write(ns)) < 0)
+            goto err;
+        if (ret == 0){ /* Would block: wait for next write event */
+            if (!ns->ns_registered){
+                if (clixon_event_reg_fd_write(ns->ns_s, netconf_output_stream_cb, arg,
+                                              "netconf streamed reply") < 0)
+                    goto err;
+                ns->ns_registered = 1;
+            }
+            return 0;
+        }
+    }
+    netconf_stream_free();
+    return 0;
+ err:
+    netconf_stream_free();
+    return -1;
+}
+
+/*! Flush any in-flight streamed reply with blocking writes
+ * Called before another frame is processed (or another reply sent) so that
+ * replies cannot interleave on the output fd.
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK, no stream in flight
+ * @retval    -1   Error
+ */
+static int
+netconf_stream_drain(clicon_handle h)
+{
+    struct netconf_stream *ns;
+    int                    ret;
+
+    if ((ns = _netconf_stream) == NULL)
+        return 0;
+    (void)fcntl(ns->ns_s, F_SETFL, ns->ns_fflags); /* blocking writes */
+    while (1){
+        if (ns->ns_pos >= (size_t)cbuf_len(ns->ns_buf)){
+            if (ns->ns_eof)
+                break;
+            if (netconf_stream_fill(ns) < 0)
+                goto err;
+        }
+        if ((ret = netconf_stream_write(ns)) < 0)
+            goto err;
+    }
+    netconf_stream_free();
+    return 0;
+ err:
+    netconf_stream_free();
+    return -1;
+}
+
+/*! Stream an rpc-reply: serialize and write in segments as the fd is writable
+ *
+ * Takes ownership of the reply tree (*xretp) on success.
+ * @param[in]     h       Clixon handle
+ * @param[in]     framing Netconf framing type
+ * @param[in,out] xretp   Reply tree owning xc, consumed and set to NULL
+ * @param[in]     xc      rpc-reply element to serialize
+ * @retval        0       OK, reply written or in flight
+ * @retval       -1       Error
+ */
+static int
+netconf_output_stream(clicon_handle        h,
+                      netconf_framing_type framing,
+                      cxobj              **xretp,
+                      cxobj               *xc)
+{
+    struct netconf_stream *ns = NULL;
+
+    if ((ns = calloc(1, sizeof(*ns))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    ns->ns_s = 1;
+    ns->ns_framing = framing;
+    if ((ns->ns_cursor = clixon_xml_cursor_new(xc, 0, 0, 0)) == NULL)
+        goto err;
+    if ((ns->ns_data = cbuf_new()) == NULL ||
+        (ns->ns_buf = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto err;
+    }
+    ns->ns_xret = *xretp;
+    *xretp = NULL;
+    ns->ns_fflags = fcntl(ns->ns_s, F_GETFL, 0);
+    (void)fcntl(ns->ns_s, F_SETFL, ns->ns_fflags | O_NONBLOCK);
+    ns->ns_eof = 0;
+    _netconf_stream = ns;
+    /* Kick off: common case completes inline without blocking */
+    return netconf_output_stream_cb(ns->ns_s, h);
+ err:
+    if (ns->ns_cursor)
+        clixon_xml_cursor_free(ns->ns_cursor);
+    if (ns->ns_data)
+        cbuf_free(ns->ns_data);
+    if (ns->ns_buf)
+        cbuf_free(ns->ns_buf);
+    free(ns);
+    return -1;
+}
+
 /*! Copy attributes from incoming request to reply. Skip already present (dont overwrite)
  *
  * RFC 6241:
@@ -169,7 +402,7 @@ netconf_hello_msg(clicon_handle h,
             if (strncmp(body, NETCONF_BASE_CAPABILITY_1_0, strlen(NETCONF_BASE_CAPABILITY_1_0)) == 0) /* RFC 4741 */
                 foundbase_10++;
             else if (strncmp(body, NETCONF_BASE_CAPABILITY_1_1, strlen(NETCONF_BASE_CAPABILITY_1_1)) == 0 &&
-                     clicon_option_int(h, "CLICON_NETCONF_BASE_CAPABILITY") > 0){ /* RFC 6241 */
+                     clicon_optcache(h)->oc_netconf_base_capability > 0){ /* RFC 6241 */
                 foundbase_11++;
                 clicon_option_int_set(h, "netconf-framing", NETCONF_SSH_CHUNKED); /* enable chunked enc */
             }
@@ -274,16 +507,24 @@ netconf_rpc_message(clicon_handle h,
         /* Copy attributes from incoming request to reply. Skip already present (dont overwrite) */
         if (netconf_add_request_attr(xrpc, xc) < 0)
             goto done;
-        if ((cbret = cbuf_new()) == NULL){ 
-            clicon_err(OE_XML, errno, "cbuf_new");
-            goto done;
+        if (*eof == 0){
+            /* Stream the reply: segments are written as serialization proceeds
+             * instead of buffering the complete reply first */
+            if (netconf_output_stream(h, framing, &xret, xc) < 0)
+                goto done;
+        }
+        else { /* Session is closing: write the reply synchronously */
+            if ((cbret = cbuf_new()) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_new");
+                goto done;
+            }
+            if (clixon_xml2cbuf(cbret, xc, 0, 0, -1, 0) < 0)
+                goto done;
+            if (netconf_output_encap(framing, cbret) < 0)
+                goto done;
+            if (netconf_output(1, cbret, "rpc-reply") < 0)
+                goto done;
         }
-        if (clixon_xml2cbuf(cbret, xml_child_i(xret,0), 0, 0, -1, 0) < 0)
-            goto done;
-        if (netconf_output_encap(framing, cbret) < 0)
-            goto done;
-        if (netconf_output(1, cbret, "rpc-reply") < 0)
-            goto done;
     }
  ok:
     retval = 0;
@@ -406,6 +647,10 @@ netconf_input_frame(clicon_handle h,
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     clicon_debug(CLIXON_DBG_MSG, "Recv ext: %s", cbuf_get(cb));
+    /* A streamed reply still in flight must be flushed before the next frame
+     * is processed so replies cannot interleave (eg pipelined rpcs) */
+    if (netconf_stream_drain(h) < 0)
+        goto done;
     framing = clicon_option_int(h, "netconf-framing");
     yspec = clicon_dbspec_yang(h);
     if ((str = strdup(cbuf_get(cb))) == NULL){
@@ -579,33 +824,36 @@ netconf_input_cb(int   s,
             clixon_exit_set(1);     
             goto ok;
         }
-        for (i=0; i<len; i++){
-            if (buf[i] == 0)
-                continue; /* Skip NULL chars (eg from terminals) */
-            if (clicon_option_int(h, "netconf-framing") == NETCONF_SSH_CHUNKED){
-                /* Track chunked framing defined in RFC6242 */
-                if ((ret = netconf_input_chunked_framing(buf[i], &frame_state, &frame_size)) < 0)
+        if (clicon_option_int(h, "netconf-framing") == NETCONF_SSH_CHUNKED){
+            /* Track chunked framing defined in RFC6242: block-oriented, chunk-data is
+             * copied in whole blocks instead of one character at a time
+             */
+            size_t off = 0;
+            size_t nr;
+
+            while (off < (size_t)len){
+                if ((ret = netconf_input_chunked_framing_buf((char*)buf+off, len-off,
+                                                             &frame_state, &frame_size,
+                                                             cb, &nr)) < 0)
                     goto done;
-                switch (ret){
-                case 1: /* chunk-data */
-                    cprintf(cb, "%c", buf[i]);
-                    break;
-                case 2: /* end-of-data */
+                off += nr;
+                if (ret == 2){ /* end-of-data */
                     /* Somewhat complex error-handling:
                      * Ignore packet errors, UNLESS an explicit termination request (eof)
                      */
                     if (netconf_input_frame(h, cb, &eof) < 0 &&
-                        !ignore_packet_errors) 
-                        goto done; 
+                        !ignore_packet_errors)
+                        goto done;
                     if (eof)
                         goto done;
                     cbuf_reset(cb);
-                    break;
-                default:
-                    break;
                 }
             }
-            else{
+        }
+        else{
+            for (i=0; i<len; i++){
+                if (buf[i] == 0)
+                    continue; /* Skip NULL chars (eg from terminals) */
                 cprintf(cb, "%c", buf[i]);
                 if (detect_endtag("]]>]]>", buf[i], &frame_state)){
                     frame_state = 0;
@@ -614,7 +862,7 @@ netconf_input_cb(int   s,
                     *(((char*)cbuf_get(cb)) + cbuf_len(cb) - strlen("]]>]]>")) = '\0';
                     if (netconf_input_frame(h, cb, &eof) < 0 &&
                         !ignore_packet_errors) // default is to ignore errors
-                        goto done; 
+                        goto done;
                     if (eof)
                         goto done;
                     cbuf_reset(cb);
@@ -686,6 +934,7 @@ netconf_terminate(clicon_handle h)
     cvec       *nsctx;
     cxobj      *x;
     
+    netconf_stream_free(); /* Drop any in-flight streamed reply */
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
     clicon_rpc_close_session(h);
@@ -158,35 +158,132 @@ api_http_data_err(clicon_handle  h,
     return retval;
 }
 
+/*
+ * The files served are typically a small fixed set (eg a webui bundle) requested
+ * repeatedly: keep recently served files open together with their stat results,
+ * so a hot request costs one revalidating stat() instead of the per-component
+ * symlink walk plus open in http_data_check_file_path.
+ */
+#define HTTP_DATA_CACHE_LEN 8
+
+/* One cached served file, see http_data_cache_get/http_data_cache_put */
+struct http_data_cache {
+    char       *hc_path;  /* Malloced file path, NULL if entry free */
+    int         hc_fd;    /* Open file descriptor, owned by the cache */
+    struct stat hc_stat;  /* Stat of the file when it was validated */
+};
+static struct http_data_cache _http_data_cache[HTTP_DATA_CACHE_LEN] = {{0,}};
+static int _http_data_evict = 0; /* Round-robin eviction index */
+
+/*! Look up a served file in the cache and revalidate it
+ * A hit hands out a dup of the cached descriptor: the caller owns and closes it
+ * while the cached one stays open. Dup:ed descriptors share one file offset so
+ * all body readers use offset-explicit i/o.
+ * @param[in]  path  File path
+ * @param[out] fdp   Dup:ed open file descriptor, owned by caller
+ * @param[out] stp   Stat of the file
+ * @retval     1     Hit, fdp and stp set
+ * @retval     0     Miss, or file changed since cached (entry evicted)
+ */
+static int
+http_data_cache_get(char        *path,
+                    int         *fdp,
+                    struct stat *stp)
+{
+    struct http_data_cache *hc;
+    struct stat             st;
+    int                     i;
+    int                     fd;
+
+    for (i=0; i<HTTP_DATA_CACHE_LEN; i++){
+        hc = &_http_data_cache[i];
+        if (hc->hc_path == NULL || strcmp(hc->hc_path, path) != 0)
+            continue;
+        /* Revalidate: same inode and unchanged since the full path check */
+        if (stat(path, &st) == 0 &&
+            st.st_dev == hc->hc_stat.st_dev &&
+            st.st_ino == hc->hc_stat.st_ino &&
+            st.st_mtime == hc->hc_stat.st_mtime &&
+            st.st_size == hc->hc_stat.st_size){
+            if ((fd = dup(hc->hc_fd)) < 0)
+                break; /* fall back to the regular open path */
+            *fdp = fd;
+            *stp = hc->hc_stat;
+            return 1;
+        }
+        /* Changed or removed: evict, the caller re-runs the full path check */
+        free(hc->hc_path);
+        hc->hc_path = NULL;
+        close(hc->hc_fd);
+        break;
+    }
+    return 0;
+}
+
+/*! Insert a validated served file into the cache, evicting round-robin
+ * The cache keeps its own dup of fd, the caller keeps ownership of fd itself.
+ * A failed insert is not an error, the cache is an optimization only.
+ * @param[in]  path  File path
+ * @param[in]  fd    Open file descriptor
+ * @param[in]  st    Stat of the open file
+ */
+static void
+http_data_cache_put(char        *path,
+                    int          fd,
+                    struct stat *st)
+{
+    struct http_data_cache *hc;
+    int                     fd1;
+    char                   *p;
+
+    if ((p = strdup(path)) == NULL)
+        return;
+    if ((fd1 = dup(fd)) < 0){
+        free(p);
+        return;
+    }
+    hc = &_http_data_cache[_http_data_evict];
+    _http_data_evict = (_http_data_evict + 1) % HTTP_DATA_CACHE_LEN;
+    if (hc->hc_path){
+        free(hc->hc_path);
+        close(hc->hc_fd);
+    }
+    hc->hc_path = p;
+    hc->hc_fd = fd1;
+    hc->hc_stat = *st;
+}
+
 /*! Check validity of path, may only be regular dir or file
  * No .., soft link, ~, etc
+ * A file that passed the check recently and is unchanged is taken from the
+ * served-file cache without repeating the per-component checks.
  * @param[in]      h       Clicon handle
  * @param[in]      req     Generic Www handle (can be part of clixon handle)
  * @param[in]      prefix  Prefix of path0, where to start file check
  * @param[in,out]  cbpath  Filepath as cbuf, internal redirection may change it
- * @param[out]     fp      Open file, if retval = 1
- * @param[out]     fsz     Size of file, if retval = 1
+ * @param[out]     fdp     Open file descriptor, owned by caller, if retval = 1
+ * @param[out]     stp     Stat of open file, if retval = 1
  * @retval        -1       Error
  * @retval         0       Invalid
- * @retval         1       OK, fp,fsz set
+ * @retval         1       OK, fdp,stp set
  */
 static int
 http_data_check_file_path(clicon_handle h,
                           void         *req,
                           char         *prefix,
                           cbuf         *cbpath,
-                          FILE        **fp,
-                          off_t        *fsz)
+                          int          *fdp,
+                          struct stat  *stp)
 {
     int         retval = -1;
-    struct stat fstat;
+    struct stat fst;
     char       *p;
     int         i;
     int         code = 0;
-    FILE       *f;
+    int         fd;
 
-    if (prefix == NULL || cbpath == NULL || fp == NULL){
-        clicon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or fp is NULL");
+    if (prefix == NULL || cbpath == NULL || fdp == NULL){
+        clicon_err(OE_UNIX, EINVAL, "prefix, cbpath0 or fdp is NULL");
         goto done;
     }
     p = cbuf_get(cbpath);
@@ -195,16 +292,21 @@ http_data_check_file_path(clicon_handle h,
         clicon_err(OE_UNIX, EINVAL, "prefix is not prefix of cbpath");
         goto done;
     }
+    /* Hot path: previously validated and unchanged */
+    if (http_data_cache_get(p, fdp, stp) == 1){
+        retval = 1;
+        goto done;
+    }
     for (i=strlen(prefix); i<strlen(p); i++){
         if (p[i] == '/'){ /* Check valid dir */
             p[i] = '\0';
             /* Ensure not soft link */
-            if (lstat(p, &fstat) < 0){
+            if (lstat(p, &fst) < 0){
                 clicon_debug(1, "%s Error lstat(%s):%s", __FUNCTION__, p, strerror(errno));
                 code = 404;
                 goto invalid;
             }
-            if (!S_ISDIR(fstat.st_mode)){
+            if (!S_ISDIR(fst.st_mode)){
                 clicon_debug(1, "%s Error lstat(%s): Not dir", __FUNCTION__, p);
                 code = 403;
                 goto invalid;
@@ -223,53 +325,59 @@ http_data_check_file_path(clicon_handle h,
         }
     }
     /* Resulting file (ensure not soft link) */
-    if (lstat(p, &fstat) < 0){
+    if (lstat(p, &fst) < 0){
         clicon_debug(1, "%s Error lstat(%s):%s", __FUNCTION__, p, strerror(errno));
         code = 404;
         goto invalid;
     }
 #ifdef HTTP_DATA_INTERNAL_REDIRECT
     /* If dir try redirect, not cbpath is extended */
-    if (S_ISDIR(fstat.st_mode)){
+    if (S_ISDIR(fst.st_mode)){
         cprintf(cbpath, "/%s", HTTP_DATA_INTERNAL_REDIRECT);
         p = cbuf_get(cbpath);
         clicon_debug(1, "%s internal redirect: %s", __FUNCTION__, p);
-        if (lstat(p, &fstat) < 0){
+        if (lstat(p, &fst) < 0){
             clicon_debug(1, "%s Error lstat(%s):%s", __FUNCTION__, p, strerror(errno));
             code = 404;
             goto invalid;
-        }       
+        }
     }
 #endif
-    if (!S_ISREG(fstat.st_mode)){
+    if (!S_ISREG(fst.st_mode)){
         clicon_debug(1, "%s Error lstat(%s): Not regular file", __FUNCTION__, p);
         code = 403;
         goto invalid;
     }
-    *fsz = fstat.st_size;
-    if ((f = fopen(p, "rb")) == NULL){
-        clicon_debug(1, "%s Error fopen(%s) %s", __FUNCTION__, p, strerror(errno));
+    if ((fd = open(p, O_RDONLY)) < 0){
+        clicon_debug(1, "%s Error open(%s) %s", __FUNCTION__, p, strerror(errno));
+        code = 403;
+        goto invalid;
+    }
+    /* Stat of the opened descriptor: closes the lstat/open race */
+    if (fstat(fd, stp) < 0 || !S_ISREG(stp->st_mode)){
+        close(fd);
         code = 403;
         goto invalid;
     }
-    *fp = f;
+    http_data_cache_put(p, fd, stp);
+    *fdp = fd;
     retval = 1; /* OK */
  done:
     return retval;
  invalid:
-    if (api_http_data_err(h, req, code) < 0) 
+    if (api_http_data_err(h, req, code) < 0)
         goto done;
     retval = 0;
     goto done;
 }
                    
 /*! Read file data request
+ * The file is handed to the transport as an open descriptor with
+ * restconf_reply_send_file, not copied through a cbuf.
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
  * @param[in]  pathname  With stripped prefix (eg /data), ultimately a filename
  * @param[in]  head      HEAD not GET
- * @note: primitive file handling, just check if file exists and read it all
- * XXX 1: Buffer copying once too many, see #if 0 below
  */
 static int
 api_http_data_file(clicon_handle h,
@@ -280,18 +388,19 @@ api_http_data_file(clicon_handle h,
     int         retval = -1;
     cbuf       *cbfile = NULL;
     char       *filename = NULL;
-    cbuf       *cbdata = NULL;
-    FILE       *f = NULL;
-    off_t       fsz = 0;
-    long        fsize;
+    int         fd = -1;
+    struct stat st = {0,};
     char       *www_data_root = NULL;
     char       *suffix;
     char       *media;
     int         ret;
-    char       *buf = NULL;
-    size_t      sz;
+    char       *str;
+    char        etag[34];
+    char        lastmod[40];
+    struct tm   tm = {0,};
+    int         notmod = 0;
 
-    clicon_debug(1, "%s", __FUNCTION__);    
+    clicon_debug(1, "%s", __FUNCTION__);
     if ((cbfile = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -306,13 +415,13 @@ api_http_data_file(clicon_handle h,
         if (strlen(pathname) && pathname[0] != '/'){
             clicon_debug(1, "%s Error fopen(%s) pathname not prefixed with /",
                          __FUNCTION__, pathname);
-            if (api_http_data_err(h, req, 404) < 0) 
+            if (api_http_data_err(h, req, 404) < 0)
                 goto done;
             goto ok;
         }
         cprintf(cbfile, "%s", pathname); /* Assume pathname starts with '/' */
     }
-    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &f, &fsz)) < 0)
+    if ((ret = http_data_check_file_path(h, req, www_data_root, cbfile, &fd, &st)) < 0)
         goto done;
     if (ret == 0) /* Invalid, return code set */
         goto ok;
@@ -326,63 +435,46 @@ api_http_data_file(clicon_handle h,
         if ((media = clicon_str2str(mime_map, suffix)) == NULL)
             media = "application/octet-stream";
     }
-    /* Size could have been taken from stat() but this reduces the race condition interval 
-     * There is still one without flock
+    /* Validators for conditional requests, see RFC 7232: Last-Modified as
+     * IMF-fixdate and an entity-tag derived from mtime and size
      */
-    fseek(f, 0, SEEK_END);
-    fsize = ftell(f);
-    /* Extra sanity check, had some problems with wrong file types */
-    if (fsz != fsize){
-        clicon_debug(1, "%s Error file %s size mismatch sz:%zu vs %li",
-                     __FUNCTION__, filename, (size_t)fsz, fsize);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
-            goto done;
-        goto ok;
-    }
-    fseek(f, 0, SEEK_SET);  /* same as rewind(f); */
-    if ((cbdata = cbuf_new_alloc(fsize+1)) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
-        goto done;
-    }
-    /* Unoptimized, no direct read but requires an extra copy,
-     * the cligen buf API should have some mechanism for this case without the extra copy.
+    gmtime_r(&st.st_mtime, &tm);
+    strftime(lastmod, sizeof(lastmod), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    snprintf(etag, sizeof(etag), "\"%lx-%lx\"", (long)st.st_mtime, (long)st.st_size);
+    /* Conditional request: If-None-Match takes precedence over If-Modified-Since.
+     * The date check is by equality with our own Last-Modified string, which
+     * covers clients echoing the validator back; anything else is treated as
+     * stale and the file is served in full.
      */
-    if ((buf = malloc(fsize)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
-        goto done;
-    }
-    if ((ret = fread(buf, fsize, 1, f)) < 0){
-        clicon_err(OE_UNIX, errno, "fread");
-        goto done;
-    }
-    sz = (size_t)ret;
-    if (sz != 1){
-        clicon_debug(1, "%s Error fread(%s) sz:%zu", __FUNCTION__, filename, sz);
-        if (api_http_data_err(h, req, 500) < 0) /* Internal error? */
+    if ((str = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL)
+        notmod = (strstr(str, etag) != NULL);
+    else if ((str = restconf_param_get(h, "HTTP_IF_MODIFIED_SINCE")) != NULL)
+        notmod = (strcmp(str, lastmod) == 0);
+    if (notmod){
+        if (restconf_reply_header(req, "ETag", "%s", etag) < 0)
+            goto done;
+        if (restconf_reply_send(req, 304, NULL, 0) < 0)
             goto done;
         goto ok;
     }
-    if (cbuf_append_buf(cbdata, buf, fsize) < 0){
-        clicon_err(OE_UNIX, errno, "cbuf_append_str");
-        goto done;
-    }
     if (restconf_reply_header(req, "Content-Type", "%s", media) < 0)
         goto done;
-    if (restconf_reply_send(req, 200, cbdata, head) < 0)
+    if (restconf_reply_header(req, "Last-Modified", "%s", lastmod) < 0)
+        goto done;
+    if (restconf_reply_header(req, "ETag", "%s", etag) < 0)
+        goto done;
+    ret = restconf_reply_send_file(req, 200, fd, st.st_size, head);
+    fd = -1; /* consumed by reply-send-file */
+    if (ret < 0)
         goto done;
-    cbdata = NULL; /* consumed by reply-send */
-    clicon_debug(1, "%s Read %s OK", __FUNCTION__, filename);
+    clicon_debug(1, "%s Send %s OK", __FUNCTION__, filename);
  ok:
     retval = 0;
  done:
-    if (buf)
-        free(buf);
-    if (f)
-        fclose(f);
+    if (fd != -1)
+        close(fd);
     if (cbfile)
         cbuf_free(cbfile);
-    if (cbdata)
-        cbuf_free(cbdata);
  return retval;
 }
 
@@ -57,6 +57,7 @@ enum restconf_media{
     /*   For JSON, the existing "application/yang-data+json" media type is
          sufficient, as the JSON format has built-in support for encoding
          arrays. */
+    YANG_DATA_CBOR,      /* "application/yang-data+cbor", RFC 9254 */
 };
 typedef enum restconf_media restconf_media;
 
@@ -45,6 +45,12 @@ int restconf_reply_header(void *req, const char *name, const char *vfmt, ...)  _
 
 /* note cb is consumed dont free */
 int restconf_reply_send(void *req, int code, cbuf *cb, int head);
+int restconf_reply_send_xtree(void *req, int code, cxobj *xtree, int pretty);
+/* note fd is consumed dont close */
+int restconf_reply_send_file(void *req, int code, int fd, off_t size, int head);
+/* Deferred replies over pooled backend sessions, see restconf_backend_rpc */
+int restconf_reply_defer(void *req, int on);
+int restconf_reply_complete(void *req);
 
 cbuf *restconf_get_indata(void *req);
 
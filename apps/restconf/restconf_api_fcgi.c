@@ -67,6 +67,51 @@
 #include "restconf_lib.h"
 #include "restconf_api.h"  /* Virtual api */
 
+/* Per-process scratch buffer for formatting header/body fragments, reused
+ * across requests instead of a malloc/free pair per header. High-water sized:
+ * grows to the largest fragment seen and stays there (the fcgi daemon handles
+ * one request at a time per process). Freed on exit by the OS.
+ */
+static char  *_fcgi_scratch = NULL;
+static size_t _fcgi_scratchlen = 0;
+
+/*! Format into the reusable scratch buffer, growing it on demand
+ * @param[out] lenp  Length of the formatted string (optional)
+ * @param[in]  fmt   Printf format string
+ * @param[in]  ap    Variadic argument list, consumed
+ * @retval     str   Formatted string, valid until the next call
+ * @retval     NULL  Error
+ */
+static char *
+fcgi_scratch_vsprintf(size_t     *lenp,
+                      const char *fmt,
+                      va_list     ap)
+{
+    va_list ap2;
+    size_t  len;
+    char   *p;
+
+    va_copy(ap2, ap);
+    len = vsnprintf(NULL, 0, fmt, ap);
+    if (len + 1 > _fcgi_scratchlen){
+        if ((p = realloc(_fcgi_scratch, len + 1)) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            va_end(ap2);
+            return NULL;
+        }
+        _fcgi_scratch = p;
+        _fcgi_scratchlen = len + 1;
+    }
+    if (vsnprintf(_fcgi_scratch, _fcgi_scratchlen, fmt, ap2) < 0){
+        clicon_err(OE_UNIX, errno, "vsnprintf");
+        va_end(ap2);
+        return NULL;
+    }
+    va_end(ap2);
+    if (lenp)
+        *lenp = len;
+    return _fcgi_scratch;
+}
 
 /*! HTTP headers done, if there is a message body coming next
  * @param[in]  req   Fastcgi request handle
@@ -99,35 +144,22 @@ restconf_reply_header(void       *req0,
 {
     FCGX_Request *req = (FCGX_Request *)req0;
     int        retval = -1;
-    size_t     vlen;
-    char      *value = NULL;
+    char      *value;
     va_list    ap;
-    
+
     if (req == NULL || name == NULL || vfmt == NULL){
         clicon_err(OE_CFG, EINVAL, "req, name or value is NULL");
         return -1;
     }
+    /* Format into the per-process scratch buffer, no malloc per header */
     va_start(ap, vfmt);
-    vlen = vsnprintf(NULL, 0, vfmt, ap);
+    value = fcgi_scratch_vsprintf(NULL, vfmt, ap);
     va_end(ap);
-    /* allocate value string exactly fitting */
-    if ((value = malloc(vlen+1)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
-        goto done;
-    }
-    /* second round: compute actual value */
-    va_start(ap, vfmt);    
-    if (vsnprintf(value, vlen+1, vfmt, ap) < 0){
-        clicon_err(OE_UNIX, errno, "vsnprintf");
-        va_end(ap);
+    if (value == NULL)
         goto done;
-    }
-    va_end(ap);
-    FCGX_FPrintF(req->out, "%s: %s\r\n", name, value); 
+    FCGX_FPrintF(req->out, "%s: %s\r\n", name, value);
     retval = 0;
  done:
-    if (value)
-        free(value);
     return retval;
 }
 
@@ -145,41 +177,26 @@ restconf_reply_body_add(void     *req0,
 {
     FCGX_Request *req = (FCGX_Request *)req0;
     int     retval = -1;
-    size_t  sz;
-    size_t  blen;
-    char   *body = NULL;
+    size_t  blen = 0;
+    char   *body;
     va_list ap;
 
     if (req == NULL || bfmt == NULL){
         clicon_err(OE_CFG, EINVAL, "req or body is NULL");
         return -1;
     }
+    /* Format into the per-process scratch buffer, no malloc per fragment */
     va_start(ap, bfmt);
-    blen = vsnprintf(NULL, 0, bfmt, ap);
+    body = fcgi_scratch_vsprintf(&blen, bfmt, ap);
     va_end(ap);
-    /* allocate body string exactly fitting */
-    if ((body = malloc(blen+1)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
+    if (body == NULL)
         goto done;
-    }
-    /* second round: compute actual body */
-    va_start(ap, bfmt);    
-    if (vsnprintf(body, blen+1, bfmt, ap) < 0){
-        clicon_err(OE_UNIX, errno, "vsnprintf");
-        va_end(ap);
-        goto done;
-    }
-    va_end(ap);
-    FCGX_FPrintF(req->out, "%s", body); 
+    FCGX_FPrintF(req->out, "%s", body);
     /* Increment in/out Content-Length parameter */
-    if (content_len){
-        sz = strlen(body);
-        *content_len += sz;
-    }
+    if (content_len)
+        *content_len += blen;
     retval = 0;
  done:
-    if (body)
-        free(body);
     return retval;
 }
 
@@ -221,6 +238,94 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Send reply of an XML tree
+ *
+ * Fcgi has no flow-controlled output path: serialize the whole body up-front and
+ * send with restconf_reply_send. See the native http/2 variant for true streaming.
+ * @param[in]  req    Fastcgi request handle
+ * @param[in]  code   Status code
+ * @param[in]  xtree  XML tree to serialize as body. Consumed on success, caller
+ *                    frees on error.
+ * @param[in]  pretty Pretty-print the serialized XML
+ * @retval     0      OK
+ * @retval     -1     Error
+ * @see restconf_reply_send
+ */
+int
+restconf_reply_send_xtree(void  *req0,
+                          int    code,
+                          cxobj *xtree,
+                          int    pretty)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xtree, 0, pretty, -1, 0) < 0)
+        goto done;
+    if (restconf_reply_send(req0, code, cb, 0) < 0)
+        goto done;
+    cb = NULL; /* consumed */
+    xml_free(xtree);
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Send HTTP reply with an open file as message body
+ *
+ * Fcgi has no access to the client socket: read the file into a cbuf and send
+ * with restconf_reply_send. See the native variant for the copy-free path.
+ * @param[in]  req   Fastcgi request handle
+ * @param[in]  code  Status code
+ * @param[in]  fd    Open file descriptor of body. Consumed, do not close
+ * @param[in]  size  Size of body, goes into Content-Length
+ * @param[in]  head  Only send headers, dont send body
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see restconf_reply_send
+ */
+int
+restconf_reply_send_file(void  *req0,
+                         int    code,
+                         int    fd,
+                         off_t  size,
+                         int    head)
+{
+    int     retval = -1;
+    cbuf   *cb = NULL;
+    char    buf[BUFSIZ];
+    ssize_t len;
+    off_t   off = 0;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Offset-explicit read: the fd may be dup:ed from the http-data file cache */
+    while (off < size && (len = pread(fd, buf, sizeof(buf), off)) > 0){
+        if (cbuf_append_buf(cb, buf, len) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+        off += len;
+    }
+    if (restconf_reply_send(req0, code, cb, head) < 0)
+        goto done;
+    cb = NULL; /* consumed */
+    retval = 0;
+ done:
+    close(fd);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  * @param[in]  req        Fastcgi request handle
  * @retval     indata     
@@ -231,12 +336,40 @@ cbuf *
 restconf_get_indata(void *req0)
 {
     FCGX_Request *req = (FCGX_Request *)req0;
-    int   c;
+    char  buf[BUFSIZ];
+    int   len;
     cbuf *cb = NULL;
 
     if ((cb = cbuf_new()) == NULL)
         return NULL;
-    while ((c = FCGX_GetChar(req->in)) != -1)
-        cprintf(cb, "%c", c);
+    /* Chunked reads instead of one cprintf per input character */
+    while ((len = FCGX_GetStr(buf, sizeof(buf), req->in)) > 0)
+        if (cbuf_append_buf(cb, buf, len) < 0){
+            cbuf_free(cb);
+            return NULL;
+        }
     return cb;
 }
+
+/*! Defer the reply of the current request, see the native variant
+ * Fcgi replies are always synchronous: never defers
+ * @param[in]  req  Fastcgi request handle
+ * @param[in]  on   Defer on/off, ignored
+ * @retval     0    Deferral not supported, reply synchronously
+ */
+int
+restconf_reply_defer(void *req0,
+                     int   on)
+{
+    return 0;
+}
+
+/*! Complete a reply deferred with restconf_reply_defer: no-op for fcgi
+ * @param[in]  req  Fastcgi request handle
+ * @retval     0    OK
+ */
+int
+restconf_reply_complete(void *req0)
+{
+    return 0;
+}
@@ -120,12 +120,60 @@ restconf_reply_header(void       *req0,
     return retval;
 }
 
+#ifdef WITH_ZSTD
+/*! Compress a reply body with zstd, replacing the cbuf
+ * @param[in,out] cbp  Body cbuf, replaced by the compressed body on success
+ * @retval        0    OK, *cbp replaced
+ * @retval       -1    Error, *cbp untouched
+ */
+static int
+restconf_body_compress(cbuf **cbp)
+{
+    int     retval = -1;
+    cbuf   *cb = *cbp;
+    cbuf   *cz = NULL;
+    char   *buf = NULL;
+    size_t  bound;
+    size_t  zlen;
+
+    bound = ZSTD_compressBound(cbuf_len(cb));
+    if ((buf = malloc(bound)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    zlen = ZSTD_compress(buf, bound, cbuf_get(cb), cbuf_len(cb), ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(zlen)){
+        clicon_err(OE_RESTCONF, 0, "ZSTD_compress: %s", ZSTD_getErrorName(zlen));
+        goto done;
+    }
+    if ((cz = cbuf_new_alloc(zlen+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new_alloc");
+        goto done;
+    }
+    if (cbuf_append_buf(cz, buf, zlen) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+        goto done;
+    }
+    clicon_debug(1, "%s %zu -> %zu", __FUNCTION__, cbuf_len(cb), zlen);
+    cbuf_free(cb);
+    *cbp = cz;
+    cz = NULL;
+    retval = 0;
+ done:
+    if (cz)
+        cbuf_free(cz);
+    if (buf)
+        free(buf);
+    return retval;
+}
+#endif /* WITH_ZSTD */
+
 /*! Send HTTP reply with potential message body
  * @param[in]     req   http request handle
  * @param[in]     code  Status code
  * @param[in]     cb    Body as a cbuf if non-NULL. Note: is consumed
- * @param[in]     head  Only send headers, dont send body. 
- * 
+ * @param[in]     head  Only send headers, dont send body.
+ *
  * Prerequisites: status code set, headers given, body if wanted set
  */
 int
@@ -144,6 +192,17 @@ restconf_reply_send(void  *req0,
     }
     sd->sd_code = code;
     if (cb != NULL){
+#ifdef WITH_ZSTD
+        if (cbuf_len(cb) >= RESTCONF_COMPRESS_MIN &&
+            restconf_compress_negotiate(sd) == 1){
+            if (restconf_body_compress(&cb) < 0)
+                goto done;
+            if (restconf_reply_header(sd, "Content-Encoding", "zstd") < 0)
+                goto done;
+            if (restconf_reply_header(sd, "Vary", "Accept-Encoding") < 0)
+                goto done;
+        }
+#endif
         if (cbuf_len(cb)){
             sd->sd_body_len = cbuf_len(cb); 
             if (head){
@@ -166,6 +225,120 @@ restconf_reply_send(void  *req0,
     return retval;
 }
 
+/*! Send reply of an XML tree, serialized incrementally where the transport allows
+ *
+ * On http/2 the tree is handed to the stream and serialized in chunks from the
+ * nghttp2 data-source read callback as stream flow control admits, so memory per
+ * in-flight reply is bounded by the serializer chunk size instead of the full body.
+ * On http/1 the body is serialized up-front as with restconf_reply_send.
+ * @param[in]  req    Request handle
+ * @param[in]  code   Status code
+ * @param[in]  xtree  XML tree to serialize as body. Consumed on success (freed with
+ *                    the stream), caller frees on error.
+ * @param[in]  pretty Pretty-print the serialized XML
+ * @retval     0      OK
+ * @retval     -1     Error
+ * @see restconf_reply_send
+ */
+int
+restconf_reply_send_xtree(void  *req0,
+                          int    code,
+                          cxobj *xtree,
+                          int    pretty)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+    cbuf                 *cb = NULL;
+
+    clicon_debug(1, "%s code:%d", __FUNCTION__, code);
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        goto done;
+    }
+    if (sd->sd_proto == HTTP_2){
+#ifdef WITH_ZSTD
+        /* No size threshold: length is unknown up-front and streamed replies are
+         * typically large. The data-source callback compresses chunk by chunk */
+        if (restconf_compress_negotiate(sd) == 1){
+            if ((sd->sd_zcctx = ZSTD_createCCtx()) == NULL){
+                clicon_err(OE_UNIX, errno, "ZSTD_createCCtx");
+                goto done;
+            }
+            if (restconf_reply_header(sd, "Content-Encoding", "zstd") < 0)
+                goto done;
+            if (restconf_reply_header(sd, "Vary", "Accept-Encoding") < 0)
+                goto done;
+        }
+#endif
+        if ((sd->sd_xcursor = clixon_xml_cursor_new(xtree, 0, pretty, 0)) == NULL)
+            goto done;
+        sd->sd_xtree = xtree;
+        sd->sd_code = code;
+        sd->sd_body_len = 0; /* unknown up-front: no Content-Length, h2 frames length */
+        retval = 0;
+        goto done;
+    }
+    /* http/1 writes the body from a single cbuf: serialize up-front */
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clixon_xml2cbuf(cb, xtree, 0, pretty, -1, 0) < 0)
+        goto done;
+    if (restconf_reply_send(req0, code, cb, 0) < 0)
+        goto done;
+    cb = NULL; /* consumed */
+    xml_free(xtree);
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Send HTTP reply with an open file as message body, without copying it into a cbuf
+ *
+ * The stream takes ownership of fd and closes it when the body has been sent.
+ * On http/1 the file is written to the socket after the headers, with sendfile
+ * on plain sockets; on http/2 the nghttp2 data-source read callback reads the
+ * file directly into each frame buffer as flow control admits.
+ * @param[in]  req   http request handle
+ * @param[in]  code  Status code
+ * @param[in]  fd    Open file descriptor of body. Consumed, do not close
+ * @param[in]  size  Size of body, goes into Content-Length
+ * @param[in]  head  Only send headers, dont send body
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see restconf_reply_send
+ */
+int
+restconf_reply_send_file(void  *req0,
+                         int    code,
+                         int    fd,
+                         off_t  size,
+                         int    head)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    clicon_debug(1, "%s code:%d size:%zu", __FUNCTION__, code, (size_t)size);
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        close(fd);
+        goto done;
+    }
+    sd->sd_code = code;
+    sd->sd_body_len = size;
+    sd->sd_body_offset = 0;
+    if (head)
+        close(fd);
+    else
+        sd->sd_fd = fd;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Get input data from http request, eg such as curl -X PUT http://... <indata>
  * @param[in]  req        Request handle
  * @note: reuses cbuf from stream-data
@@ -185,3 +358,65 @@ restconf_get_indata(void *req0)
     return cb;
 }
 
+
+/*! Defer the reply of the current request past the return of its handler
+ *
+ * Used by handlers that submit the backend rpc asynchronously over the backend
+ * session pool (see restconf_backend_rpc): no reply is written when the handler
+ * returns, the connection buffers further input, and the reply is sent from
+ * restconf_reply_complete when the rpc completion callback has filled in the
+ * reply fields. Only supported on native http/1: http/2 stream replies are
+ * driven by the nghttp2 session and are not deferred.
+ * @param[in]  req  Http request handle
+ * @param[in]  on   1: defer the reply, 0: cancel a deferral (eg submit declined)
+ * @retval     1    Reply deferred
+ * @retval     0    Deferral not supported (or cancelled), reply synchronously
+ * @retval    -1    Error
+ */
+int
+restconf_reply_defer(void *req0,
+                     int   on)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        goto done;
+    }
+#ifdef HAVE_HTTP1
+    if (on == 0)
+        sd->sd_defer = 0;
+    else if (sd->sd_conn &&
+        (sd->sd_conn->rc_proto == HTTP_10 || sd->sd_conn->rc_proto == HTTP_11)){
+        sd->sd_defer = 1;
+        retval = 1;
+        goto done;
+    }
+#endif
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Complete a reply deferred with restconf_reply_defer
+ * @param[in]  req  Http request handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see restconf_native_deferred_done  which writes the reply and resumes input
+ */
+int
+restconf_reply_complete(void *req0)
+{
+    restconf_stream_data *sd = (restconf_stream_data *)req0;
+
+    if (sd == NULL){
+        clicon_err(OE_CFG, EINVAL, "sd is NULL");
+        return -1;
+    }
+#ifdef HAVE_HTTP1
+    if (sd->sd_defer)
+        return restconf_native_deferred_done(sd);
+#endif
+    return 0;
+}
@@ -306,6 +306,16 @@ api_return_err(clicon_handle  h,
             cprintf(cb, "}\r\n");
         }
         break;
+    case YANG_DATA_CBOR:
+        clicon_debug(1, "%s code:%d", __FUNCTION__, code);
+        /* map(1){ "ietf-restconf:errors" : <error> } */
+        cbuf_append(cb, (5<<5) | 1); /* CBOR map, 1 entry */
+        cbuf_append(cb, (3<<5) | 24); /* CBOR text string, 1-byte length */
+        cbuf_append(cb, strlen("ietf-restconf:errors"));
+        cbuf_append_str(cb, "ietf-restconf:errors");
+        if (clixon_cbor2cbuf(cb, xerr, 0) < 0)
+            goto done;
+        break;
     default: /* Just ignore the body so that there is a reply */
         clicon_err(OE_YANG, EINVAL, "Invalid media type %d", media);
         goto done;
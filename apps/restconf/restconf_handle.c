@@ -88,12 +88,14 @@ struct restconf_handle {
     clicon_hash_t           *rh_data;      /* internal clicon data (HDR) */
     clicon_hash_t           *rh_db_elmnt;  /* xml datastore element cache data */
     event_stream_t          *rh_stream;    /* notification streams, see clixon_stream.[ch] */
-    
+    struct clicon_option_cache rh_optcache; /* typed snapshot of hot options (HDR) */
+
     /* ------ end of common handle ------ */
     clicon_hash_t           *rh_params;      /* restconf parameters, including http headers */
     clixon_auth_type_t       rh_auth_type;   /* authentication type */
     int                      rh_pretty;      /* pretty-print for http replies */
     int                      rh_http_data;   /* enable-http-data (and if-feature http-data) */
+    int                      rh_metrics;     /* enable-metrics (and if-feature metrics) */
     char                    *rh_fcgi_socket; /* if-feature fcgi, XXX: use WITH_RESTCONF_FCGI ? */
 };
 
@@ -272,6 +274,34 @@ restconf_http_data_set(clicon_handle h,
     return 0;
 }
 
+/*! Get restconf metrics enabled
+ * @param[in]  h      Clixon handle
+ * @retval     0      No, metrics disabled
+ * @retval     1      Yes, metrics enabled
+ */
+int
+restconf_metrics_enabled_get(clicon_handle h)
+{
+    struct restconf_handle *rh = handle(h);
+
+    return rh->rh_metrics;
+}
+
+/*! Set restconf metrics enabled
+ * @param[in]  h    Clixon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+restconf_metrics_enabled_set(clicon_handle h,
+                             int           metrics)
+{
+    struct restconf_handle *rh = handle(h);
+
+    rh->rh_metrics = metrics;
+    return 0;
+}
+
 /*! Get restconf fcgi socket path
  * @param[in]  h         Clicon handle
  * @retval     socketpath
@@ -53,6 +53,8 @@ int           restconf_pretty_get(clicon_handle h);
 int           restconf_pretty_set(clicon_handle h, int pretty);
 int           restconf_http_data_get(clicon_handle h);
 int           restconf_http_data_set(clicon_handle h, int http_data);
+int           restconf_metrics_enabled_get(clicon_handle h);
+int           restconf_metrics_enabled_set(clicon_handle h, int metrics);
 char         *restconf_fcgi_socket_get(clicon_handle h);
 int           restconf_fcgi_socket_set(clicon_handle h, char *socketpath);
 
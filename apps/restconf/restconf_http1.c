@@ -42,6 +42,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <ctype.h>
 #include <inttypes.h>
 #include <syslog.h>
 #include <errno.h>
@@ -67,9 +68,226 @@
 #include "clixon_http1_parse.h"
 #include "restconf_http1.h"
 #include "clixon_http_data.h"
+#include "restconf_metrics.h"
 
 /* Size of xml read buffer */
-#define BUFLEN 1024  
+#define BUFLEN 1024
+
+/*
+ * Fast-path HTTP/1 parser for common well-formed requests
+ * Request-line and header scanning driven by a byte-class table, the yacc
+ * parser is kept as fallback for anything unusual (odd whitespace, obs-fold,
+ * malformed pct-escapes, protocol errors), see _http1_parse.
+ * Byte classes mirror the lexer classes in clixon_http1_parse.l
+ */
+#define HTTP1_FAST_TOKEN 0x01 /* token: method and header field names */
+#define HTTP1_FAST_PCHAR 0x02 /* path char, except pct-encoded and "/" */
+#define HTTP1_FAST_QUERY 0x04 /* query char, except pct-encoded */
+
+static unsigned char _http1_fast_class[256] = {0};
+static int           _http1_fast_class_set = 0;
+
+static void
+http1_fast_class_init(void)
+{
+    const char *s;
+    int         i;
+
+    for (i=0; i<128; i++)
+        if (isalnum(i))
+            _http1_fast_class[i] = HTTP1_FAST_TOKEN|HTTP1_FAST_PCHAR|HTTP1_FAST_QUERY;
+    for (s="!#$%&'*+-.^_`|~"; *s; s++)
+        _http1_fast_class[(unsigned char)*s] |= HTTP1_FAST_TOKEN;
+    for (s="-._~!$&'()*+,;=:@"; *s; s++)
+        _http1_fast_class[(unsigned char)*s] |= HTTP1_FAST_PCHAR|HTTP1_FAST_QUERY;
+    for (s="?/"; *s; s++)
+        _http1_fast_class[(unsigned char)*s] |= HTTP1_FAST_QUERY;
+    _http1_fast_class_set = 1;
+}
+
+/*! Fast-path parse of a common well-formed HTTP/1 request
+ *
+ * Produces exactly the side-effects of the grammar actions in
+ * clixon_http1_parse.y: REQUEST_METHOD/REQUEST_URI params, query cvec, proto
+ * digits, one restconf_convert_hdr per non-empty header, body appended to
+ * sd_indata. The whole message is validated before any side-effect is applied,
+ * so a fallback (retval 0) leaves no trace and the yacc parser re-parses from
+ * scratch, giving the same error behavior as before.
+ * @param[in]  h    Clixon handle
+ * @param[in]  rc   Restconf connection
+ * @param[in]  str  Null-terminated HTTP/1 message (mutated temporarily in-place)
+ * @retval     1    Parsed OK, side-effects applied
+ * @retval     0    Not handled here, use the yacc parser
+ * @retval    -1    Error with clicon_err called
+ */
+static int
+http1_parse_fast(clicon_handle  h,
+                 restconf_conn *rc,
+                 char          *str)
+{
+    int                   retval = -1;
+    restconf_stream_data *sd;
+    char                 *p = str;
+    char                 *hdr0;
+    char                 *method0;
+    char                 *methodend;
+    char                 *uri0;
+    char                 *uriend;
+    char                 *query0 = NULL;
+    char                 *queryend = NULL;
+    char                 *name0;
+    char                 *nameend;
+    char                 *val0;
+    char                 *valend;
+    char                  d1;
+    char                  d2;
+    char                  c;
+    char                  c2;
+    int                   ret;
+
+    if (!_http1_fast_class_set)
+        http1_fast_class_init();
+    /* Validation pass: no side-effects until the whole message is accepted */
+    method0 = p;
+    while (_http1_fast_class[(unsigned char)*p] & HTTP1_FAST_TOKEN)
+        p++;
+    methodend = p;
+    if (p == method0 || *p != ' ')
+        goto fallback;
+    p++;
+    if (*p != '/')
+        goto fallback; /* origin-form request-target only */
+    uri0 = p;
+    while (*p == '/' || (_http1_fast_class[(unsigned char)*p] & HTTP1_FAST_PCHAR) || *p == '%'){
+        if (*p == '%'){
+            if (!isxdigit((unsigned char)p[1]) || !isxdigit((unsigned char)p[2]))
+                goto fallback;
+            p += 3;
+        }
+        else
+            p++;
+    }
+    uriend = p;
+    if (*p == '?'){
+        query0 = ++p;
+        while ((_http1_fast_class[(unsigned char)*p] & HTTP1_FAST_QUERY) || *p == '%'){
+            if (*p == '%'){
+                if (!isxdigit((unsigned char)p[1]) || !isxdigit((unsigned char)p[2]))
+                    goto fallback;
+                p += 3;
+            }
+            else
+                p++;
+        }
+        queryend = p;
+        if (queryend == query0)
+            goto fallback; /* Grammar requires a non-empty query after ? */
+    }
+    if (strncmp(p, " HTTP/", 6) != 0)
+        goto fallback;
+    p += 6;
+    if (!isdigit((unsigned char)p[0]) || p[1] != '.' || !isdigit((unsigned char)p[2]))
+        goto fallback;
+    d1 = p[0];
+    d2 = p[2];
+    p += 3;
+    if (p[0] != '\r' || p[1] != '\n')
+        goto fallback;
+    p += 2;
+    hdr0 = p;
+    while (!(p[0] == '\r' && p[1] == '\n')){
+        name0 = p;
+        while (_http1_fast_class[(unsigned char)*p] & HTTP1_FAST_TOKEN)
+            p++;
+        if (p == name0 || *p != ':')
+            goto fallback;
+        p++;
+        while (*p == ' ')
+            p++;
+        while (*p != '\r' && *p != '\n' && *p != '\0'){
+            /* Grammar collapses whitespace runs to one space: keep those on the slow path */
+            if (*p == '\t' || (*p == ' ' && p[1] == ' '))
+                goto fallback;
+            p++;
+        }
+        if (p[0] != '\r' || p[1] != '\n')
+            goto fallback;
+        p += 2;
+    }
+    p += 2;
+    /* Accepted: apply side-effects. Tokens are null-terminated in-place
+     * temporarily, the patched byte is restored after each call
+     */
+    if ((sd = restconf_stream_find(rc, 0)) == NULL){
+        clicon_err(OE_RESTCONF, 0, "stream 0 not found");
+        goto done;
+    }
+    c = *methodend;
+    *methodend = '\0';
+    ret = restconf_param_set(h, "REQUEST_METHOD", method0);
+    *methodend = c;
+    if (ret < 0)
+        goto done;
+    /* Grammar drops one trailing slash of a non-root path */
+    if (uriend > uri0+1 && uriend[-1] == '/')
+        uriend--;
+    c = *uriend;
+    *uriend = '\0';
+    ret = restconf_param_set(h, "REQUEST_URI", uri0);
+    *uriend = c;
+    if (ret < 0)
+        goto done;
+    if (query0 != NULL){
+        c = *queryend;
+        *queryend = '\0';
+        ret = uri_str2cvec(query0, '&', '=', 1, &sd->sd_qvec);
+        *queryend = c;
+        if (ret < 0)
+            goto done;
+    }
+    rc->rc_proto_d1 = d1 - '0';
+    rc->rc_proto_d2 = d2 - '0';
+    p = hdr0;
+    while (!(p[0] == '\r' && p[1] == '\n')){
+        name0 = p;
+        while (_http1_fast_class[(unsigned char)*p] & HTTP1_FAST_TOKEN)
+            p++;
+        nameend = p;
+        p++; /* colon */
+        while (*p == ' ')
+            p++;
+        val0 = p;
+        while (*p != '\r')
+            p++;
+        valend = p;
+        p += 2;
+        while (valend > val0 && valend[-1] == ' ')
+            valend--;
+        if (valend == val0)
+            continue; /* Empty header values are not set, as in the grammar */
+        c = *nameend;
+        *nameend = '\0';
+        c2 = *valend;
+        *valend = '\0';
+        ret = restconf_convert_hdr(h, name0, val0);
+        *nameend = c;
+        *valend = c2;
+        if (ret < 0)
+            goto done;
+    }
+    p += 2;
+    if (*p != '\0' &&
+        cbuf_append_buf(sd->sd_indata, p, strlen(p)) < 0){
+        clicon_err(OE_RESTCONF, errno, "cbuf_append_buf");
+        goto done;
+    }
+    retval = 1;
+ done:
+    return retval;
+ fallback:
+    retval = 0;
+    goto done;
+}
 
 /*! HTTP/1 parsing function. Input is string and side-effect is populating connection structs
  *
@@ -93,6 +311,13 @@ _http1_parse(clicon_handle  h,
     clicon_debug(1, "%s:\n%s", __FUNCTION__, str);
     if (strlen(str) == 0)
         goto ok;
+    /* Fast path for common well-formed requests, falls through to the yacc
+     * parser on anything unusual (and on errors, for uniform error reporting)
+     */
+    if ((ret = http1_parse_fast(h, rc, str)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
     hy.hy_parse_string = str;
     hy.hy_name = filename;
     hy.hy_h = h;
@@ -293,8 +518,9 @@ http1_upgrade_http2(clicon_handle         h,
 #endif /* HAVE_LIBNGHTTP2 */
 
 /*! Construct an HTTP/1 reply (dont actually send it)
+ * Also called from restconf_native_deferred_done when a deferred reply completes
  */
-static int
+int
 restconf_http1_reply(restconf_conn        *rc,
                      restconf_stream_data *sd)
 {
@@ -357,11 +583,13 @@ restconf_http1_path_root(clicon_handle  h,
     char                 *subject = NULL;
     cxobj                *xerr = NULL;
     int                   pretty;
+    struct timeval        t0;
 #ifdef HAVE_LIBNGHTTP2
     int                   ret;
 #endif
-    
+
     clicon_debug(1, "------------");
+    gettimeofday(&t0, NULL);
     pretty = restconf_pretty_get(h);
     if ((sd = restconf_stream_find(rc, 0)) == NULL){
         clicon_err(OE_RESTCONF, EINVAL, "No stream_data");
@@ -430,24 +658,35 @@ restconf_http1_path_root(clicon_handle  h,
     /* Matching algorithm:
      * 1. try well-known
      * 2. try /restconf
-     * 3. try /data
-     * 4. call restconf anyway (because it handles errors a la restconf)
+     * 3. try /metrics
+     * 4. try /data
+     * 5. call restconf anyway (because it handles errors a la restconf)
      * This is for the situation where data is / and /restconf is more specific
      */
     if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0){
         if (api_well_known(h, sd) < 0)
             goto done;
     }
+    else if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN_LIVE) == 0){
+        if (api_well_known_live(h, sd) < 0)
+            goto done;
+    }
     else if (api_path_is_restconf(h)){
         if (api_root_restconf(h, sd, sd->sd_qvec) < 0)
             goto done;
     }
+    else if (api_path_is_metrics(h)){
+        if (api_metrics(h, sd) < 0)
+            goto done;
+    }
     else if (api_path_is_data(h)){
         if (api_http_data(h, sd, sd->sd_qvec) < 0)
             goto done;
     }
     else
         sd->sd_code = 404; /* catch all without body/media */
+    if (restconf_metrics_req(h, &t0) < 0)
+        goto done;
  fail:
    if (restconf_param_del_all(h) < 0)
         goto done;
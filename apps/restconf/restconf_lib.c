@@ -208,6 +208,7 @@ static const map_str2int http_media_map[] = {
     {"application/yang-patch+xml",       YANG_PATCH_XML},
     {"application/yang-patch+json",      YANG_PATCH_JSON},
     {"application/yang-data+xml-list",  YANG_PAGINATION_XML},  /* draft-wwlh-netconf-list-pagination-rc-02 */
+    {"application/yang-data+cbor",       YANG_DATA_CBOR},      /* RFC 9254 */
     {NULL,                            -1}
 };
 
@@ -357,6 +358,8 @@ restconf_terminate(clicon_handle h)
     clicon_debug(1, "%s", __FUNCTION__);
     if ((fs = clicon_socket_get(h)) != -1)
         close(fs);
+    restconf_auth_cache_flush(h);
+    restconf_backend_pool_close(h);
     /* Delete all plugins, and RPC callbacks */
     clixon_plugin_module_exit(h);
 
@@ -637,6 +640,506 @@ restconf_drop_privileges(clicon_handle h)
     return retval;
 }
 
+/*
+ * Authentication verdict cache, see CLICON_RESTCONF_AUTH_CACHE.
+ * Successful verdicts are kept in a move-to-front list keyed on
+ * (auth-type, credential) where the credential is the SSL cert common name or
+ * the HTTP Authorization header, so repeated requests over the same (or an
+ * equally credentialed) connection skip the auth plugin callbacks.
+ * Stored on the handle, flushed with restconf_auth_cache_flush.
+ */
+#define AUTH_CACHE_PTR "restconf-auth-cache"
+#define AUTH_CACHE_MAX 32
+
+struct auth_cache{
+    struct auth_cache *ac_next;
+    clixon_auth_type_t ac_auth_type;
+    char              *ac_cred;  /* Credential the verdict was computed from */
+    char              *ac_user;  /* Authenticated user */
+};
+
+/*! Look up a cached authentication verdict, move hit to front
+ * @param[in]  h          Clicon handle
+ * @param[in]  auth_type  Authentication type
+ * @param[in]  cred       Credential string
+ * @retval     user       Cached authenticated user
+ * @retval     NULL       No cached verdict
+ */
+static char *
+auth_cache_lookup(clicon_handle      h,
+                  clixon_auth_type_t auth_type,
+                  char              *cred)
+{
+    struct auth_cache  *ac;
+    struct auth_cache **acp = NULL;
+
+    clicon_ptr_get(h, AUTH_CACHE_PTR, (void**)&acp);
+    if (acp == NULL)
+        return NULL;
+    for (ac = *acp; ac; ac = ac->ac_next)
+        if (ac->ac_auth_type == auth_type &&
+            strcmp(ac->ac_cred, cred) == 0){
+            if (ac != *acp){ /* Move to front */
+                struct auth_cache **prev;
+                for (prev = acp; *prev != ac; prev = &(*prev)->ac_next)
+                    ;
+                *prev = ac->ac_next;
+                ac->ac_next = *acp;
+                *acp = ac;
+            }
+            return ac->ac_user;
+        }
+    return NULL;
+}
+
+/*! Cache a successful authentication verdict, evict tail at capacity
+ * @param[in]  h          Clicon handle
+ * @param[in]  auth_type  Authentication type
+ * @param[in]  cred       Credential string
+ * @param[in]  user       Authenticated user (copied)
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+static int
+auth_cache_store(clicon_handle      h,
+                 clixon_auth_type_t auth_type,
+                 char              *cred,
+                 char              *user)
+{
+    int                 retval = -1;
+    struct auth_cache  *ac = NULL;
+    struct auth_cache **acp = NULL;
+    int                 nr = 0;
+
+    clicon_ptr_get(h, AUTH_CACHE_PTR, (void**)&acp);
+    if (acp == NULL){
+        if ((acp = calloc(1, sizeof(*acp))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if (clicon_ptr_set(h, AUTH_CACHE_PTR, acp) < 0)
+            goto done;
+    }
+    if ((ac = calloc(1, sizeof(*ac))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ac->ac_auth_type = auth_type;
+    if ((ac->ac_cred = strdup(cred)) == NULL ||
+        (ac->ac_user = strdup(user)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    ac->ac_next = *acp;
+    *acp = ac;
+    ac = NULL;
+    /* Evict at capacity */
+    {
+        struct auth_cache **prev;
+        for (prev = acp; *prev; prev = &(*prev)->ac_next)
+            if (++nr > AUTH_CACHE_MAX)
+                break;
+        if (*prev){
+            ac = *prev;
+            *prev = NULL;
+        }
+    }
+    retval = 0;
+ done:
+    if (ac){
+        if (ac->ac_cred)
+            free(ac->ac_cred);
+        if (ac->ac_user)
+            free(ac->ac_user);
+        free(ac);
+    }
+    return retval;
+}
+
+/*! Flush all cached authentication verdicts
+ * Call when authentication configuration changes under a running daemon.
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ */
+int
+restconf_auth_cache_flush(clicon_handle h)
+{
+    struct auth_cache  *ac;
+    struct auth_cache **acp = NULL;
+
+    clicon_ptr_get(h, AUTH_CACHE_PTR, (void**)&acp);
+    if (acp == NULL)
+        return 0;
+    while ((ac = *acp) != NULL){
+        *acp = ac->ac_next;
+        free(ac->ac_cred);
+        free(ac->ac_user);
+        free(ac);
+    }
+    free(acp);
+    clicon_ptr_del(h, AUTH_CACHE_PTR);
+    return 0;
+}
+
+/*
+ * Backend session pool, see CLICON_RESTCONF_BACKEND_POOL.
+ * A small set of IPC sessions to the backend over which rpc:s are submitted
+ * asynchronously with clicon_rpc_async, so a slow request (eg a GET of a large
+ * datastore) does not hold the event loop and every other request behind the
+ * one shared backend socket. The internal protocol carries no request id in
+ * replies, so correlation is by session: one request in flight per pooled
+ * session, requests beyond the pool size are queued FIFO.
+ * Stored on the handle, closed with restconf_backend_pool_close.
+ */
+#define BACKEND_POOL_PTR "restconf-backend-pool"
+
+struct backend_sess{
+    int      bs_sock;  /* Connected socket to backend, -1 if not connected */
+    uint32_t bs_id;    /* Backend session-id from hello on this socket */
+    int      bs_busy;  /* An rpc is in flight on this session */
+};
+
+struct backend_req{
+    struct backend_req  *br_next;
+    clicon_handle        br_h;
+    void                *br_req;  /* Restconf request handle. NULLed if the http
+                                   * connection closes first, see restconf_backend_detach */
+    restconf_backend_cb *br_cb;   /* Completion callback */
+    void                *br_arg;  /* Callback argument */
+    struct backend_sess *br_bs;   /* Session the request is in flight on, NULL while queued */
+    char                *br_body; /* Message body while queued */
+};
+
+struct backend_pool{
+    struct backend_sess *bp_sess;   /* Session array */
+    int                  bp_len;    /* Nr of sessions, 0: pool disabled */
+    struct backend_req  *bp_flight; /* In-flight requests */
+    struct backend_req  *bp_queue;  /* Waiting requests, FIFO */
+};
+
+/*! Get the backend session pool, created on first use from config
+ * @param[in]  h   Clicon handle
+ * @retval     bp  Pool
+ * @retval     NULL Pool disabled (CLICON_RESTCONF_BACKEND_POOL is 0) or error
+ */
+static struct backend_pool *
+backend_pool_get(clicon_handle h)
+{
+    struct backend_pool *bp = NULL;
+    int                  len = 0;
+
+    clicon_ptr_get(h, BACKEND_POOL_PTR, (void**)&bp);
+    if (bp != NULL)
+        return bp->bp_len ? bp : NULL;
+    if (clicon_option_exists(h, "CLICON_RESTCONF_BACKEND_POOL"))
+        len = clicon_option_int(h, "CLICON_RESTCONF_BACKEND_POOL");
+    if ((bp = calloc(1, sizeof(*bp))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    if (len > 0 &&
+        (bp->bp_sess = calloc(len, sizeof(*bp->bp_sess))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        free(bp);
+        return NULL;
+    }
+    bp->bp_len = len;
+    while (len-- > 0)
+        bp->bp_sess[len].bs_sock = -1;
+    if (clicon_ptr_set(h, BACKEND_POOL_PTR, bp) < 0){
+        if (bp->bp_sess)
+            free(bp->bp_sess);
+        free(bp);
+        return NULL;
+    }
+    return bp->bp_len ? bp : NULL;
+}
+
+/*! Connect a pooled session: socket to the backend plus its own hello
+ * @param[in]  h   Clicon handle
+ * @param[in]  bs  Pool session, connected with session-id on success
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+backend_sess_open(clicon_handle        h,
+                  struct backend_sess *bs)
+{
+    int      retval = -1;
+    int      s = -1;
+    int      s0;
+    int      ret;
+    uint32_t id = 0;
+
+    if (clicon_rpc_connect(h, &s) < 0)
+        goto done;
+    /* The hello machinery sends on the handle's cached socket: point it at the
+     * new session's socket for the exchange and restore afterwards
+     */
+    s0 = clicon_client_socket_get(h);
+    clicon_client_socket_set(h, s);
+    ret = clicon_hello_req(h, NULL, NULL, &id);
+    if (clicon_client_socket_get(h) == -1)
+        s = -1; /* error path closed it */
+    clicon_client_socket_set(h, s0);
+    if (ret < 0)
+        goto done;
+    bs->bs_sock = s;
+    bs->bs_id = id;
+    s = -1;
+    retval = 0;
+ done:
+    if (s != -1)
+        close(s);
+    return retval;
+}
+
+static int backend_rpc_done(int sock, char *ret, int eof, void *arg);
+
+/*! Send a request on a pooled session, marking it busy
+ * @param[in]  h     Clicon handle
+ * @param[in]  bp    Backend session pool
+ * @param[in]  bs    Free pool session
+ * @param[in]  br    Request, linked in-flight on success
+ * @param[in]  body  Message body
+ * @retval     0     OK, backend_rpc_done will be invoked with br
+ * @retval    -1     Error, br not linked
+ */
+static int
+backend_submit(clicon_handle        h,
+               struct backend_pool *bp,
+               struct backend_sess *bs,
+               struct backend_req  *br,
+               char                *body)
+{
+    int                retval = -1;
+    struct clicon_msg *msg = NULL;
+
+    if (bs->bs_sock == -1 &&
+        backend_sess_open(h, bs) < 0)
+        goto done;
+    if ((msg = clicon_msg_encode(bs->bs_id, "%s", body)) == NULL)
+        goto done;
+    if (clicon_rpc_async(bs->bs_sock, msg, 0, backend_rpc_done, br) < 0){
+        close(bs->bs_sock); /* send failed: session unusable */
+        bs->bs_sock = -1;
+        goto done;
+    }
+    bs->bs_busy = 1;
+    br->br_bs = bs;
+    br->br_next = bp->bp_flight;
+    bp->bp_flight = br;
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    return retval;
+}
+
+/*! Completion of a pooled backend rpc: invoke callback, drain the queue
+ *
+ * @param[in]  sock  Socket the reply arrived on
+ * @param[in]  ret   Reply as malloced string, NULL on eof or timeout
+ * @param[in]  eof   Peer closed the session
+ * @param[in]  arg   Request (struct backend_req)
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clicon_rpc_async
+ */
+static int
+backend_rpc_done(int   sock,
+                 char *ret,
+                 int   eof,
+                 void *arg)
+{
+    int                  retval = -1;
+    struct backend_req  *br = (struct backend_req *)arg;
+    struct backend_req  *brq;
+    struct backend_req **prev;
+    struct backend_sess *bs = br->br_bs;
+    struct backend_pool *bp = NULL;
+    clicon_handle        h = br->br_h;
+    cxobj               *xret = NULL;
+
+    clicon_ptr_get(h, BACKEND_POOL_PTR, (void**)&bp);
+    if (bp)
+        for (prev = &bp->bp_flight; *prev; prev = &(*prev)->br_next)
+            if (*prev == br){
+                *prev = br->br_next;
+                break;
+            }
+    if (ret == NULL){ /* eof or timeout: session lost, reconnect lazily */
+        if (bs->bs_sock != -1)
+            close(bs->bs_sock);
+        bs->bs_sock = -1;
+    }
+    else if (clixon_xml_parse_string(ret, YB_NONE, NULL, &xret, NULL) < 0)
+        clicon_log(LOG_WARNING, "%s: invalid XML reply from backend", __FUNCTION__);
+    bs->bs_busy = 0;
+    if (br->br_req != NULL && /* NULL: http connection closed while in flight */
+        br->br_cb(h, br->br_req, xret, br->br_arg) < 0)
+        goto done;
+    /* Drain: submit the oldest queued request on the freed session */
+    while (bp && (brq = bp->bp_queue) != NULL && !bs->bs_busy){
+        bp->bp_queue = brq->br_next;
+        brq->br_next = NULL;
+        if (brq->br_req == NULL){ /* orphaned while queued */
+            free(brq->br_body);
+            free(brq);
+            continue;
+        }
+        if (backend_submit(h, bp, bs, brq, brq->br_body) < 0){
+            /* Session could not be revived: fail the request upwards */
+            (void)brq->br_cb(h, brq->br_req, NULL, brq->br_arg);
+            free(brq->br_body);
+            free(brq);
+            continue;
+        }
+        free(brq->br_body);
+        brq->br_body = NULL;
+    }
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    free(br);
+    if (ret)
+        free(ret);
+    return retval;
+}
+
+/*! Submit an rpc to the backend on a pooled session, reply via callback
+ *
+ * On retval 1 the request is in flight (or queued behind the pool) and cb will
+ * be invoked exactly once from the event loop, with the parsed rpc-reply or
+ * with xret NULL if the backend session was lost; the reply tree is owned by
+ * the pool and freed after cb returns. The caller must have deferred its http
+ * reply, see restconf_reply_defer, and must detach req if the http connection
+ * closes first, see restconf_backend_detach.
+ * @param[in]  h     Clicon handle
+ * @param[in]  req   Generic http request handle, passed to cb
+ * @param[in]  body  Message body (an <rpc>...</rpc> string), copied if queued
+ * @param[in]  cb    Completion callback
+ * @param[in]  arg   Callback argument
+ * @retval     1     Submitted, cb will be invoked
+ * @retval     0     Pool disabled: caller should send the rpc synchronously
+ * @retval    -1     Error
+ */
+int
+restconf_backend_rpc(clicon_handle        h,
+                     void                *req,
+                     cbuf                *body,
+                     restconf_backend_cb *cb,
+                     void                *arg)
+{
+    int                  retval = -1;
+    struct backend_pool *bp;
+    struct backend_sess *bs = NULL;
+    struct backend_req  *br = NULL;
+    struct backend_req **prev;
+    int                  i;
+
+    if ((bp = backend_pool_get(h)) == NULL)
+        return 0;
+    if ((br = calloc(1, sizeof(*br))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    br->br_h = h;
+    br->br_req = req;
+    br->br_cb = cb;
+    br->br_arg = arg;
+    for (i = 0; i < bp->bp_len; i++)
+        if (!bp->bp_sess[i].bs_busy){
+            bs = &bp->bp_sess[i];
+            break;
+        }
+    if (bs == NULL){ /* all sessions busy: queue at FIFO tail */
+        if ((br->br_body = strdup(cbuf_get(body))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        for (prev = &bp->bp_queue; *prev; prev = &(*prev)->br_next)
+            ;
+        *prev = br;
+        br = NULL;
+        retval = 1;
+        goto done;
+    }
+    if (backend_submit(h, bp, bs, br, cbuf_get(body)) < 0)
+        goto done;
+    br = NULL;
+    retval = 1;
+ done:
+    if (br){
+        if (br->br_body)
+            free(br->br_body);
+        free(br);
+    }
+    return retval;
+}
+
+/*! Detach an http request handle from pending backend rpc:s
+ *
+ * Call when an http connection closes while a pooled rpc may be outstanding:
+ * the completion then discards the reply instead of writing to a freed request.
+ * @param[in]  h    Clicon handle
+ * @param[in]  req  Generic http request handle
+ * @retval     0    OK
+ */
+int
+restconf_backend_detach(clicon_handle h,
+                        void         *req)
+{
+    struct backend_pool *bp = NULL;
+    struct backend_req  *br;
+
+    clicon_ptr_get(h, BACKEND_POOL_PTR, (void**)&bp);
+    if (bp == NULL)
+        return 0;
+    for (br = bp->bp_flight; br; br = br->br_next)
+        if (br->br_req == req)
+            br->br_req = NULL;
+    for (br = bp->bp_queue; br; br = br->br_next)
+        if (br->br_req == req)
+            br->br_req = NULL;
+    return 0;
+}
+
+/*! Close the backend session pool
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ */
+int
+restconf_backend_pool_close(clicon_handle h)
+{
+    struct backend_pool *bp = NULL;
+    struct backend_req  *br;
+    int                  i;
+
+    clicon_ptr_get(h, BACKEND_POOL_PTR, (void**)&bp);
+    if (bp == NULL)
+        return 0;
+    for (i = 0; i < bp->bp_len; i++)
+        if (bp->bp_sess[i].bs_sock != -1)
+            close(bp->bp_sess[i].bs_sock);
+    while ((br = bp->bp_flight) != NULL){
+        bp->bp_flight = br->br_next;
+        free(br);
+    }
+    while ((br = bp->bp_queue) != NULL){
+        bp->bp_queue = br->br_next;
+        if (br->br_body)
+            free(br->br_body);
+        free(br);
+    }
+    if (bp->bp_sess)
+        free(bp->bp_sess);
+    free(bp);
+    clicon_ptr_del(h, BACKEND_POOL_PTR);
+    return 0;
+}
+
 /*!
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic Www handle (can be part of clixon handle)
@@ -660,9 +1163,31 @@ restconf_authentication_cb(clicon_handle  h,
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *anonymous = NULL;
-    
+    char              *cred = NULL;
+    char              *cuser;
+
     auth_type = restconf_auth_type_get(h);
     clicon_debug(1, "%s auth-type:%s", __FUNCTION__, clixon_auth_type_int2str(auth_type));
+    /* Cached verdict: skip the auth plugin callbacks for an already seen
+     * credential, see CLICON_RESTCONF_AUTH_CACHE */
+    if (clicon_option_bool(h, "CLICON_RESTCONF_AUTH_CACHE")){
+        switch (auth_type){
+        case CLIXON_AUTH_CLIENT_CERTIFICATE:
+            cred = restconf_param_get(h, "SSL_CN");
+            break;
+        case CLIXON_AUTH_USER:
+            cred = restconf_param_get(h, "HTTP_AUTHORIZATION");
+            break;
+        default:
+            break;
+        }
+        if (cred != NULL &&
+            (cuser = auth_cache_lookup(h, auth_type, cred)) != NULL){
+            clicon_username_set(h, cuser);
+            retval = 1;
+            goto done;
+        }
+    }
     ret = 0;
     authenticated = 0;
     /* ret: -1 Error, 0: Ignore/not handled, 1: OK see authenticated parameter */
@@ -712,6 +1237,9 @@ restconf_authentication_cb(clicon_handle  h,
         goto notauth;
     }
     /* If set but no user, set a dummy user */
+    if (cred != NULL && clicon_username_get(h) != NULL &&
+        auth_cache_store(h, auth_type, cred, clicon_username_get(h)) < 0)
+        goto done;
     retval = 1;
  done:
     clicon_debug(1, "%s retval:%d authenticated:%d user:%s",
@@ -787,9 +1315,23 @@ restconf_config_init(clicon_handle h,
         strcmp(bstr, "true") == 0) {
         restconf_http_data_set(h, 1);
     }
-    else 
+    else
         restconf_http_data_set(h, 0);
 
+    /* Check if enable-metrics is true and that feature is enabled
+     * It is protected by if-feature metrics, which means if the feature is not enabled, its
+     * YANG spec will exist but by ANYDATA
+     */
+    if ((x = xpath_first(xrestconf, nsc, "enable-metrics")) != NULL &&
+        (y = xml_spec(x)) != NULL &&
+        yang_keyword_get(y) != Y_ANYDATA &&
+        (bstr = xml_body(x)) != NULL &&
+        strcmp(bstr, "true") == 0) {
+        restconf_metrics_enabled_set(h, 1);
+    }
+    else
+        restconf_metrics_enabled_set(h, 0);
+
     /* Check if fcgi-socket is true and that feature is enabled
      * It is protected by if-feature fcgi, which means if the feature is not enabled, then 
      * YANG spec will exist but by ANYDATA
@@ -818,6 +1360,7 @@ restconf_config_init(clicon_handle h,
  * @param[in]  port      TCP port
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport Set SO_REUSEPORT before bind, for multi-process accept load-balancing
  * @param[out] ss        Server socket (bound for accept)
  */
 int
@@ -827,6 +1370,7 @@ restconf_socket_init(const char   *netns0,
                      uint16_t      port,
                      int           backlog,
                      int           flags,
+                     int           reuseport,
                      int          *ss)
 {
     int                 retval = -1;
@@ -843,7 +1387,7 @@ restconf_socket_init(const char   *netns0,
         netns = netns0;
     if (clixon_inet2sin(addrtype, addrstr, port, sa, &sa_len) < 0)
         goto done;
-    if (clixon_netns_socket(netns, sa, sa_len, backlog, flags, addrstr, ss) < 0)
+    if (clixon_netns_socket(netns, sa, sa_len, backlog, flags, reuseport, addrstr, ss) < 0)
         goto done;
     clicon_debug(1, "%s ss=%d", __FUNCTION__, *ss);
     retval = 0;
@@ -54,6 +54,7 @@ enum restconf_media{
     YANG_PATCH_JSON, /* "application/yang-patch+json" */
     YANG_PATCH_XML,  /* "application/yang-patch+xml" */
     YANG_PAGINATION_XML, /* draft-wwlh-netconf-list-pagination-rc-02.txt */
+    YANG_DATA_CBOR,  /* "application/yang-data+cbor", RFC 9254 */
 };
 typedef enum restconf_media restconf_media;
 
@@ -94,9 +95,16 @@ int   restconf_insert_attributes(cxobj *xdata, cvec *qvec);
 int   restconf_main_extension_cb(clicon_handle h, yang_stmt *yext, yang_stmt *ys);
 char *restconf_uripath(clicon_handle h);
 int   restconf_drop_privileges(clicon_handle h);
+int   restconf_auth_cache_flush(clicon_handle h);
+/* Completion callback of restconf_backend_rpc: xret is the parsed rpc-reply
+ * (owned by the pool, NULL if the backend session was lost) */
+typedef int (restconf_backend_cb)(clicon_handle h, void *req, cxobj *xret, void *arg);
+int   restconf_backend_rpc(clicon_handle h, void *req, cbuf *body, restconf_backend_cb *cb, void *arg);
+int   restconf_backend_detach(clicon_handle h, void *req);
+int   restconf_backend_pool_close(clicon_handle h);
 int   restconf_authentication_cb(clicon_handle h, void *req, int pretty, restconf_media media_out);
 int   restconf_config_init(clicon_handle h, cxobj *xrestconf);
-int   restconf_socket_init(const char *netns0, const char *addrstr, const char *addrtype, uint16_t port, int backlog, int flags, int *ss);
+int   restconf_socket_init(const char *netns0, const char *addrstr, const char *addrtype, uint16_t port, int backlog, int flags, int reuseport, int *ss);
 
 #endif /* _RESTCONF_LIB_H_ */
 
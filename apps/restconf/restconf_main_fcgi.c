@@ -99,25 +99,28 @@ static int
 fcgi_params_set(clicon_handle h,
                            char        **envp)
 {
-    int   retval = -1;
-    int   i;
-    char *param = NULL;
-    char *val = NULL;
+    int    retval = -1;
+    int    i;
+    char   name[256]; /* Larger than any real param/header name */
+    char  *val;
+    size_t len;
 
     clicon_debug(1, "%s", __FUNCTION__);
     for (i = 0; envp[i] != NULL; i++){ /* on the form <param>=<value> */
-        if (clixon_strsplit(envp[i], '=', &param, &val) < 0)
-            goto done;
-        if (restconf_param_set(h, param, val) < 0)
-            goto done;
-        if (param){
-            free(param);
-            param = NULL;
-        }
-        if (val){
-            free(val);
-            val = NULL;
+        /* Split on the stack instead of two mallocs per header, the hash
+         * copies the value anyway */
+        if ((val = strchr(envp[i], '=')) == NULL)
+            continue;
+        len = val - envp[i];
+        if (len >= sizeof(name)){
+            clicon_debug(1, "%s: parameter name too long, skipped: %s",
+                         __FUNCTION__, envp[i]);
+            continue;
         }
+        memcpy(name, envp[i], len);
+        name[len] = '\0';
+        if (restconf_param_set(h, name, val + 1) < 0)
+            goto done;
     }
     retval = 0;
  done:
@@ -616,6 +619,10 @@ main(int    argc,
                 if (api_well_known(h, req) < 0)
                     goto done;
             }
+            else if (strcmp(path, RESTCONF_WELL_KNOWN_LIVE) == 0){
+                if (api_well_known_live(h, req) < 0)
+                    goto done;
+            }
             else if (api_path_is_restconf(h)){
                 query = restconf_param_get(h, "QUERY_STRING");
                 if (query != NULL && strlen(query))
@@ -127,8 +127,10 @@
 #include <signal.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
+#include <sys/wait.h>
 
 #include <openssl/ssl.h>
 #include <openssl/rand.h>
@@ -177,6 +179,9 @@
 /* Cert verify depth: dont know what to set here? */
 #define VERIFY_DEPTH 5
 
+/* Max nr of SSL sessions kept server-side for session resumption (abbreviated handshakes) */
+#define RESTCONF_SSL_SESSION_CACHE_SIZE 1024
+
 static int             session_id_context = 1;
 
 /*! Set restconf native handle
@@ -437,7 +442,13 @@ restconf_ssl_context_configure(clixon_handle h,
 
     SSL_CTX_set_session_id_context(ctx, (void *)&session_id_context, sizeof(session_id_context));
     SSL_CTX_set_app_data(ctx, h);
-    SSL_CTX_set_session_cache_mode(ctx, 0);
+    /* Server-side session cache for session-id resumption. Session tickets (on by default)
+     * cover clients resuming with tickets, the cache covers session-id based resumption.
+     * Both drop a reconnecting client to an abbreviated handshake, which matters in
+     * reconnect storms, eg after a controller failover.
+     */
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, RESTCONF_SSL_SESSION_CACHE_SIZE);
 
     /* Set the key and cert */
     if (SSL_CTX_use_certificate_chain_file(ctx, server_cert_path) != 1) {
@@ -553,6 +564,15 @@ restconf_accept_client(int   fd,
         clicon_err(OE_UNIX, errno, "accept");
         goto done;
     }
+    if (from.sa_family == AF_INET || from.sa_family == AF_INET6){
+        int one = 1;
+
+        /* Replies go out as one gathered write per response: disable Nagle so
+         * they are not held back waiting for a delayed ACK */
+        if (setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0)
+            clicon_log(LOG_WARNING, "%s: setsockopt TCP_NODELAY: %s",
+                       __FUNCTION__, strerror(errno));
+    }
     switch (from.sa_family){
     case AF_INET:{
         struct sockaddr_in *in = (struct sockaddr_in *)&from;
@@ -704,6 +724,82 @@ restconf_clixon_backend(clicon_handle h,
     goto done;
 }
 
+/* Pre-forked worker processes, see CLICON_RESTCONF_WORKERS
+ * The parent acts as worker 0 and keeps the child pids for termination.
+ * Children set _worker_child and run their own event loop with their own
+ * listen sockets (SO_REUSEPORT), the kernel load-balances accepts among them.
+ */
+static pid_t *_workers = NULL;
+static int    _workers_len = 0;
+static int    _worker_child = 0;
+
+/*! Fork pre-forked restconf worker processes
+ *
+ * Called after the SSL context is created so that TLS session ticket keys are
+ * shared over the fork and session resumption works regardless of which worker
+ * a client lands on. Called before sockets are opened so that each worker binds
+ * its own listen socket with SO_REUSEPORT.
+ * @param[in]  h    Clicon handle
+ * @param[in]  nr   Total number of workers, including the calling process
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @note Workers are not respawned if they die
+ */
+static int
+restconf_workers_fork(clicon_handle h,
+                      int           nr)
+{
+    int   retval = -1;
+    int   i;
+    pid_t pid;
+
+    if (nr < 2)
+        goto ok;
+    if ((_workers = calloc(nr - 1, sizeof(pid_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i = 0; i < nr - 1; i++){
+        if ((pid = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pid == 0){ /* Child worker: no child bookkeeping of its own */
+            _worker_child = 1;
+            free(_workers);
+            _workers = NULL;
+            _workers_len = 0;
+            break;
+        }
+        _workers[_workers_len++] = pid;
+    }
+    clicon_log(LOG_NOTICE, "%s: restconf worker pid: %u", __PROGRAM__, getpid());
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Terminate pre-forked restconf worker processes, parent only
+ * @retval     0    OK
+ */
+static int
+restconf_workers_terminate(void)
+{
+    int i;
+
+    for (i = 0; i < _workers_len; i++){
+        kill(_workers[i], SIGTERM);
+        waitpid(_workers[i], NULL, 0);
+    }
+    if (_workers){
+        free(_workers);
+        _workers = NULL;
+    }
+    _workers_len = 0;
+    return 0;
+}
+
 /*! Per-socket openssl inits
  * @param[in]  h        Clicon handle
  * @param[in]  xs       XML config of single restconf socket
@@ -749,7 +845,9 @@ openssl_init_socket(clicon_handle h,
         }
     }
     else { /* listen/accept */
-        /* Open restconf socket and bind for later accept */
+        /* Open restconf socket and bind for later accept.
+         * With pre-forked workers each worker binds its own socket with SO_REUSEPORT
+         */
         if (restconf_socket_init(netns, address, addrtype, port,
                              SOCKET_LISTEN_BACKLOG,
 #ifdef RESTCONF_OPENSSL_NONBLOCKING
@@ -757,6 +855,7 @@ openssl_init_socket(clicon_handle h,
 #else /* blocking */
                                  0,
 #endif
+                                 clicon_option_int(h, "CLICON_RESTCONF_WORKERS") > 1,
                                  &ss
                                  ) < 0)
             goto done;
@@ -778,7 +877,9 @@ openssl_init_socket(clicon_handle h,
 
     if (rsock->rs_callhome){
         rsock->rs_ss = -1; /* Not applicable from callhome */
-        if (restconf_callhome_timer(rsock, 0) < 0)
+        /* Only the first worker initiates callhome connects, avoid duplicate dial-outs */
+        if (!_worker_child &&
+            restconf_callhome_timer(rsock, 0) < 0)
             goto done;
     }
     else {
@@ -873,6 +974,11 @@ restconf_openssl_init(clicon_handle h,
     }
     rn = restconf_native_handle_get(h);
     rn->rn_ctx = ctx;
+    /* Fork workers after the SSL context (shares TLS session ticket keys) but
+     * before the sockets are opened (each worker binds its own with SO_REUSEPORT)
+     */
+    if (restconf_workers_fork(h, clicon_option_int(h, "CLICON_RESTCONF_WORKERS")) < 0)
+        goto done;
     /* get the list of socket config-data */
     if (xpath_vec(xrestconf, nsc, "socket", &vec, &veclen) < 0)
         goto done;
@@ -1272,6 +1378,10 @@ main(int    argc,
     /* Dump configuration options on debug */
     clicon_option_dump(h, 1);
 
+    /* Enable sampled transaction tracing if CLICON_TRACE_SAMPLING is set */
+    if (clixon_trace_init(h) < 0)
+        goto done;
+
     /* Initialize plugin module by creating a handle holding plugin and callback lists */
     if (clixon_plugin_module_init(h) < 0)
         goto done;
@@ -1317,6 +1427,7 @@ main(int    argc,
     clicon_debug(1, "restconf_main_openssl done");
     if (xrestconf)
         xml_free(xrestconf);
+    restconf_workers_terminate();
     restconf_native_terminate(h);
     restconf_terminate(h);
     return retval;
@@ -230,7 +230,9 @@ api_data_write(clicon_handle h,
     yang_bind      yb;
     char          *xpath = NULL;
     char          *attr;
-        
+    char           tracectx[32];
+    struct timespec tspan;
+
     clicon_debug(1, "%s api_path:\"%s\"",  __FUNCTION__, api_path0);
     clicon_debug(1, "%s data:\"%s\"", __FUNCTION__, data);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
@@ -508,6 +510,8 @@ api_data_write(clicon_handle h,
     cprintf(cbx, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cbx, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        if (clixon_trace_context(h, tracectx, sizeof(tracectx)) > 0)
+            cprintf(cbx, " %s:trace=\"%s\"", CLIXON_LIB_PREFIX, tracectx);
         cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cbx, " xmlns:%s=\"%s\"",
@@ -536,8 +540,10 @@ api_data_write(clicon_handle h,
         goto done;
     cprintf(cbx, "</edit-config></rpc>");
     clicon_debug(1, "%s xml: %s api_path:%s",__FUNCTION__, cbuf_get(cbx), api_path);
+    clock_gettime(CLOCK_MONOTONIC, &tspan);
     if (clicon_rpc_netconf(h, cbuf_get(cbx), &xret, NULL) < 0)
         goto done;
+    clixon_trace_span(h, "restconf.ipc.edit-config", &tspan);
     if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
             goto done;      
@@ -722,6 +728,8 @@ api_data_delete(clicon_handle h,
     char      *username;
     int        ret;
     cxobj     *xe; /* xml error, no free */
+    char       tracectx[32];
+    struct timespec tspan;
 
     clicon_debug(1, "%s api_path:%s", __FUNCTION__, api_path);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
@@ -758,6 +766,8 @@ api_data_delete(clicon_handle h,
     cprintf(cbx, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cbx, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        if (clixon_trace_context(h, tracectx, sizeof(tracectx)) > 0)
+            cprintf(cbx, " %s:trace=\"%s\"", CLIXON_LIB_PREFIX, tracectx);
         cprintf(cbx, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cbx, " xmlns:%s=\"%s\"",
@@ -785,8 +795,10 @@ api_data_delete(clicon_handle h,
     if (clixon_xml2cbuf(cbx, xtop, 0, 0, -1, 0) < 0)
         goto done;
     cprintf(cbx, "</edit-config></rpc>");
+    clock_gettime(CLOCK_MONOTONIC, &tspan);
     if (clicon_rpc_netconf(h, cbuf_get(cbx), &xret, NULL) < 0)
         goto done;
+    clixon_trace_span(h, "restconf.ipc.edit-config", &tspan);
     if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
             goto done;
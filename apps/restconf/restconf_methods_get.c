@@ -48,6 +48,7 @@
 #include <time.h>
 #include <signal.h>
 #include <limits.h>
+#include <inttypes.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 
@@ -66,6 +67,325 @@
 /* Forward */
 static int api_data_pagination(clicon_handle h, void *req, char *api_path, int pi, cvec *qvec, int pretty, restconf_media media_out);
 
+/*! Render and send the reply of a data GET given the get rpc result
+ *
+ * Second half of api_data_get2, shared by the synchronous path and the pooled
+ * asynchronous path (see api_data_get_submit) which reach it with the same
+ * extracted rpc result.
+ * @param[in]     h         Clixon handle
+ * @param[in]     req       Generic www handle
+ * @param[in]     xpath     Xpath of the request (NULL or "/" is the data root)
+ * @param[in]     nsc       Namespace context of xpath
+ * @param[in]     pretty    Set to 1 for pretty-printed xml/json output
+ * @param[in]     media_out Output media
+ * @param[in]     head      If 1 is HEAD, otherwise GET
+ * @param[in]     etag      ETag header value, empty string if none
+ * @param[in]     rpcret    Return value of the get rpc, < 0 is error
+ * @param[in,out] xretp     Extracted rpc result (data or rpc-error), caller owns,
+ *                          set to NULL if consumed by a streamed reply
+ * @retval        0         OK (including error replies sent to the client)
+ * @retval       -1         Error
+ */
+static int
+api_data_get_reply(clicon_handle  h,
+                   void          *req,
+                   char          *xpath,
+                   cvec          *nsc,
+                   int            pretty,
+                   restconf_media media_out,
+                   int            head,
+                   char          *etag,
+                   int            rpcret,
+                   cxobj        **xretp)
+{
+    int     retval = -1;
+    cxobj  *xret = *xretp;
+    cxobj  *xerr = NULL; /* malloced */
+    cxobj  *xe = NULL;   /* not malloced */
+    cbuf   *cbx = NULL;
+    cxobj **xvec = NULL;
+    size_t  xlen;
+    int     i;
+    cxobj  *x;
+    cvec   *nscd = NULL;
+
+    if (rpcret < 0){
+        if (netconf_operation_failed_xml(&xerr, "protocol", clicon_err_reason) < 0)
+            goto done;
+        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    /* We get return via netconf which is complete tree from root
+     * We need to cut that tree to only the object.
+     */
+#if 0 /* DEBUG */
+    if (clicon_debug_get())
+        clicon_debug_xml(1, xret, "%s xret:", __FUNCTION__);
+#endif
+    /* Check if error return  */
+    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Normal return, no error */
+    if ((cbx = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (xpath==NULL || strcmp(xpath,"/")==0){ /* Special case: data root */
+        switch (media_out){
+        case YANG_DATA_XML:
+            if (!head){
+                /* Full datastore replies can be very large: hand the tree to the
+                 * transport for incremental serialization (streamed on native http/2,
+                 * serialized up-front elsewhere) instead of one monolithic cbuf.
+                 */
+                if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
+                    goto done;
+                if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+                    goto done;
+                if (etag[0] &&
+                    restconf_reply_header(req, "ETag", "%s", etag) < 0)
+                    goto done;
+                if (restconf_reply_send_xtree(req, 200, xret, pretty) < 0)
+                    goto done;
+                *xretp = NULL; /* consumed */
+                goto ok;
+            }
+            if (clixon_xml2cbuf(cbx, xret, 0, pretty, -1, 0) < 0) /* Dont print top object?  */
+                goto done;
+            break;
+        case YANG_DATA_JSON:
+            if (clixon_json2cbuf(cbx, xret, pretty, 0, 0) < 0)
+                goto done;
+            break;
+        case YANG_DATA_CBOR:
+            if (clixon_cbor2cbuf(cbx, xret, 0) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    else{
+        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0){
+            if (netconf_operation_failed_xml(&xerr, "application", clicon_err_reason) < 0)
+                goto done;
+            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+                goto done;
+            goto ok;
+        }
+        /* Check if not exists */
+        if (xlen == 0){
+            /* 4.3: If a retrieval request for a data resource represents an
+               instance that does not exist, then an error response containing
+               a "404 Not Found" status-line MUST be returned by the server.
+               The error-tag value "invalid-value" is used in this case. */
+            if (netconf_invalid_value_xml(&xerr, "application", "Instance does not exist") < 0)
+                goto done;
+            /* override invalid-value default 400 with 404 */
+            if (api_return_err0(h, req, xerr, pretty, media_out, 404) < 0)
+                goto done;
+            goto ok;
+        }
+        switch (media_out){
+        case YANG_DATA_XML:
+            for (i=0; i<xlen; i++){
+                x = xvec[i];
+                if (xml_nsctx_node(x, &nscd) < 0)
+                    goto done;
+                if (xmlns_set_all(x, nscd) < 0)
+                    goto done;
+                if (nscd){
+                    cvec_free(nscd);
+                    nscd = NULL;
+                }
+                if (clixon_xml2cbuf(cbx, x, 0, pretty, -1, 0) < 0) /* Dont print top object?  */
+                    goto done;
+            }
+            break;
+        case YANG_DATA_JSON:
+            /* In: <x xmlns="urn:example:clixon">0</x>
+             * Out: {"example:x": {"0"}}
+             */
+            if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
+                goto done;
+            break;
+        case YANG_DATA_CBOR:
+            if (xml2cbor_cbuf_vec(cbx, xvec, xlen) < 0)
+                goto done;
+            break;
+        default:
+            break;
+        }
+    }
+    clicon_debug(1, "%s cbuf:%s", __FUNCTION__, cbuf_get(cbx));
+    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+        goto done;
+    if (etag[0] &&
+        restconf_reply_header(req, "ETag", "%s", etag) < 0)
+        goto done;
+    if (restconf_reply_send(req, 200, cbx, head) < 0)
+        goto done;
+    cbx = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (nscd)
+        cvec_free(nscd);
+    if (cbx)
+        cbuf_free(cbx);
+    if (xerr)
+        xml_free(xerr);
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
+/* Completion state of an asynchronous data GET, see api_data_get_submit */
+struct data_get_state{
+    char          *dg_xpath;     /* malloced, owned */
+    cvec          *dg_nsc;       /* owned */
+    int            dg_pretty;
+    restconf_media dg_media_out;
+    int            dg_head;
+    char           dg_etag[64];  /* ETag header value, empty string if none */
+};
+
+/*! Completion callback of an asynchronous data GET, of type restconf_backend_cb
+ *
+ * Render the reply from the rpc-reply and complete the deferred http reply.
+ * @param[in]  h     Clixon handle
+ * @param[in]  req   Generic www handle, NULL if the connection closed meanwhile
+ * @param[in]  xret  Parsed rpc-reply, owned by the pool, NULL if session lost
+ * @param[in]  arg   Completion state, freed here
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+api_data_get_done(clicon_handle h,
+                  void         *req,
+                  cxobj        *xret,
+                  void         *arg)
+{
+    int                    retval = -1;
+    struct data_get_state *dgs = (struct data_get_state *)arg;
+    cxobj                 *xt = NULL;
+    int                    ret = 0;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (req == NULL) /* Connection closed while the rpc was in flight */
+        goto ok;
+    if (xret == NULL){ /* Backend session lost */
+        clicon_err(OE_PROTO, 0, "backend session closed");
+        ret = -1;
+    }
+    else if (clicon_rpc_get_reply(h, xret, &xt) < 0)
+        ret = -1;
+    if (api_data_get_reply(h, req, dgs->dg_xpath, dgs->dg_nsc, dgs->dg_pretty,
+                           dgs->dg_media_out, dgs->dg_head, dgs->dg_etag, ret, &xt) < 0)
+        goto done;
+    if (restconf_reply_complete(req) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (xt)
+        xml_free(xt);
+    if (dgs->dg_xpath)
+        free(dgs->dg_xpath);
+    if (dgs->dg_nsc)
+        xml_nsctx_free(dgs->dg_nsc);
+    free(dgs);
+    return retval;
+}
+
+/*! Submit the get rpc of a data GET asynchronously over the backend session pool
+ *
+ * If the transport supports deferred replies (native http/1) and the pool is
+ * enabled (CLICON_RESTCONF_BACKEND_POOL), the rpc is submitted without blocking
+ * and the reply is rendered from api_data_get_done, so other requests are served
+ * while the backend works on this one.
+ * @param[in]  h         Clixon handle
+ * @param[in]  req       Generic www handle
+ * @param[in]  xpath     Xpath of the request. Ownership moves to the completion
+ *                       state on retval 1
+ * @param[in]  nsc       Namespace context of xpath. Ownership moves on retval 1
+ * @param[in]  content   Content query parameter
+ * @param[in]  depth     Depth query parameter, -1 is unbounded
+ * @param[in]  defaults  With-defaults query parameter
+ * @param[in]  pretty    Set to 1 for pretty-printed xml/json output
+ * @param[in]  media_out Output media
+ * @param[in]  head      If 1 is HEAD, otherwise GET
+ * @param[in]  etag      ETag header value, empty string if none
+ * @retval     1         Submitted, reply deferred, xpath and nsc consumed
+ * @retval     0         Not submitted, caller performs the rpc synchronously
+ * @retval    -1         Error
+ */
+static int
+api_data_get_submit(clicon_handle   h,
+                    void           *req,
+                    char           *xpath,
+                    cvec           *nsc,
+                    netconf_content content,
+                    int32_t         depth,
+                    char           *defaults,
+                    int             pretty,
+                    restconf_media  media_out,
+                    int             head,
+                    char           *etag)
+{
+    int                    retval = -1;
+    cbuf                  *cb = NULL;
+    struct data_get_state *dgs = NULL;
+    int                    ret;
+
+    if ((ret = restconf_reply_defer(req, 1)) < 0)
+        goto done;
+    if (ret == 0){ /* Transport cannot defer */
+        retval = 0;
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (clicon_rpc_get_body(h, xpath, nsc, content, depth, defaults, cb) < 0)
+        goto done;
+    if ((dgs = calloc(1, sizeof(*dgs))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    dgs->dg_xpath = xpath;
+    dgs->dg_nsc = nsc;
+    dgs->dg_pretty = pretty;
+    dgs->dg_media_out = media_out;
+    dgs->dg_head = head;
+    strncpy(dgs->dg_etag, etag, sizeof(dgs->dg_etag)-1);
+    if ((ret = restconf_backend_rpc(h, req, cb, api_data_get_done, dgs)) < 0)
+        goto done;
+    if (ret == 0){ /* Pool disabled: undo the deferral, reply synchronously */
+        if (restconf_reply_defer(req, 0) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    dgs = NULL; /* consumed by the pool */
+    retval = 1;
+ done:
+    if (retval < 0)
+        (void)restconf_reply_defer(req, 0);
+    if (dgs)
+        free(dgs);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Generic GET (both HEAD and GET)
  * According to restconf 
  * @param[in]  h        Clixon handle
@@ -106,15 +426,10 @@ api_data_get2(clicon_handle  h,
 {
     int        retval = -1;
     char      *xpath = NULL;
-    cbuf      *cbx = NULL;
     yang_stmt *yspec;
     cxobj     *xret = NULL;
     cxobj     *xerr = NULL; /* malloced */
-    cxobj     *xe = NULL;   /* not malloced */
-    cxobj    **xvec = NULL;
-    size_t     xlen;
     int        i;
-    cxobj     *x;
     int        ret;
     cvec      *nsc = NULL;
     char      *attr; /* attribute value string */
@@ -124,8 +439,10 @@ api_data_get2(clicon_handle  h,
     cxobj     *xbot = NULL;
     yang_stmt *y = NULL;
     char      *defaults = NULL;
-    cvec      *nscd = NULL;
-    
+    char       etag[64] = {0,};
+    char      *ifnonematch;
+    uint32_t   serial = 0;
+
     clicon_debug(1, "%s", __FUNCTION__);
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_FATAL, 0, "No DB_SPEC");
@@ -200,128 +517,57 @@ api_data_get2(clicon_handle  h,
         defaults = attr;
     }
 
-    clicon_debug(1, "%s path:%s", __FUNCTION__, xpath);
-    ret = clicon_rpc_get(h, xpath, nsc, content, depth, defaults, &xret);
-
-    if (ret < 0){
-        if (netconf_operation_failed_xml(&xerr, "protocol", clicon_err_reason) < 0)
-            goto done;
-        if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
-            goto done;
-        goto ok;
-    }
-    /* We get return via netconf which is complete tree from root 
-     * We need to cut that tree to only the object.
+    /* Config-only content: derive an ETag from the datastore write serial so pollers can
+     * revalidate with If-None-Match and skip the config retrieval and transfer (RFC 7232).
+     * State content has no serial: it may change without a datastore write.
      */
-#if 0 /* DEBUG */
-    if (clicon_debug_get())
-        clicon_debug_xml(1, xret, "%s xret:", __FUNCTION__);
-#endif
-    /* Check if error return  */
-    if ((xe = xpath_first(xret, NULL, "//rpc-error")) != NULL){
-        if (api_return_err(h, req, xe, pretty, media_out, 0) < 0)
+    if (content == CONTENT_CONFIG){
+        if (clicon_rpc_datastore_serial(h, "running", &serial) < 0)
             goto done;
-        goto ok;
-    }
-    /* Normal return, no error */
-    if ((cbx = cbuf_new()) == NULL){
-        clicon_err(OE_UNIX, errno, "cbuf_new");
-        goto done;
-    }
-    if (xpath==NULL || strcmp(xpath,"/")==0){ /* Special case: data root */
-        switch (media_out){
-        case YANG_DATA_XML:
-            if (clixon_xml2cbuf(cbx, xret, 0, pretty, -1, 0) < 0) /* Dont print top object?  */
+        snprintf(etag, sizeof(etag), "\"running-%" PRIu32 "\"", serial);
+        if ((ifnonematch = restconf_param_get(h, "HTTP_IF_NONE_MATCH")) != NULL &&
+            strcmp(ifnonematch, etag) == 0){
+            if (restconf_reply_header(req, "ETag", "%s", etag) < 0)
                 goto done;
-            break;
-        case YANG_DATA_JSON:
-            if (clixon_json2cbuf(cbx, xret, pretty, 0, 0) < 0)
-                goto done;
-            break;
-        default:
-            break;
-        }
-    }
-    else{
-        if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath) < 0){
-            if (netconf_operation_failed_xml(&xerr, "application", clicon_err_reason) < 0)
-                goto done;
-            if (api_return_err0(h, req, xerr, pretty, media_out, 0) < 0)
+            if (restconf_reply_send(req, 304, NULL, 0) < 0) /* Not modified */
                 goto done;
             goto ok;
         }
-        /* Check if not exists */
-        if (xlen == 0){
-            /* 4.3: If a retrieval request for a data resource represents an 
-               instance that does not exist, then an error response containing 
-               a "404 Not Found" status-line MUST be returned by the server.  
-               The error-tag value "invalid-value" is used in this case. */
-            if (netconf_invalid_value_xml(&xerr, "application", "Instance does not exist") < 0)
-                goto done;
-            /* override invalid-value default 400 with 404 */
-            if (api_return_err0(h, req, xerr, pretty, media_out, 404) < 0)
-                goto done;
-            goto ok;
-        }
-        switch (media_out){
-        case YANG_DATA_XML:
-            for (i=0; i<xlen; i++){
-                x = xvec[i];
-                if (xml_nsctx_node(x, &nscd) < 0)
-                    goto done;
-                if (xmlns_set_all(x, nscd) < 0)
-                    goto done;
-                if (nscd){
-                    cvec_free(nscd);
-                    nscd = NULL;
-                }
-                if (clixon_xml2cbuf(cbx, x, 0, pretty, -1, 0) < 0) /* Dont print top object?  */
-                    goto done;
-            }
-            break;
-        case YANG_DATA_JSON:
-            /* In: <x xmlns="urn:example:clixon">0</x>
-             * Out: {"example:x": {"0"}}
-             */
-            if (xml2json_cbuf_vec(cbx, xvec, xlen, pretty, 0) < 0)
-                goto done;
-            break;
-        default:
-            break;
-        }
     }
-    clicon_debug(1, "%s cbuf:%s", __FUNCTION__, cbuf_get(cbx));
-    if (restconf_reply_header(req, "Content-Type", "%s", restconf_media_int2str(media_out)) < 0)
-        goto done;
-    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+    clicon_debug(1, "%s path:%s", __FUNCTION__, xpath);
+    /* If the pool and transport admit, submit the rpc asynchronously so other
+     * requests on this daemon are served while the backend works on this one
+     */
+    if ((ret = api_data_get_submit(h, req, xpath, nsc, content, depth, defaults,
+                                   pretty, media_out, head, etag)) < 0)
         goto done;
-    if (restconf_reply_send(req, 200, cbx, head) < 0)
+    if (ret == 1){ /* Submitted: reply rendered from api_data_get_done */
+        xpath = NULL; /* consumed */
+        nsc = NULL;   /* consumed */
+        goto ok;
+    }
+    ret = clicon_rpc_get(h, xpath, nsc, content, depth, defaults, &xret);
+    if (api_data_get_reply(h, req, xpath, nsc, pretty, media_out, head, etag,
+                           ret, &xret) < 0)
         goto done;
-    cbx = NULL;
  ok:
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
     if (xpath)
         free(xpath);
-    if (nscd)
-        cvec_free(nscd);
     if (nsc)
         xml_nsctx_free(nsc);
     if (xtop)
         xml_free(xtop);
-    if (cbx)
-        cbuf_free(cbx);
     if (xret)
         xml_free(xret);
     if (xerr)
         xml_free(xerr);
-    if (xvec)
-        free(xvec);
     return retval;
 }
 
-/*! GET Collection 
+/*! GET Collection
  * According to restconf collection draft. Lists, work in progress
  * @param[in]  h        Clixon handle
  * @param[in]  req      Generic Www handle
@@ -0,0 +1,323 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Prometheus-compatible /metrics endpoint.
+ * The daemon maintains plain counters updated inline on the hot paths (request
+ * dispatch, connection and stream setup/teardown); serialization to the
+ * Prometheus text exposition format happens only at scrape time.
+ * Opt-in via clixon-restconf.yang enable-metrics (feature metrics).
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+/* restconf */
+#include "restconf_lib.h"
+#include "restconf_handle.h"
+#include "restconf_api.h"
+#include "restconf_err.h"
+#include "restconf_metrics.h"
+
+/* Request counters are kept per HTTP method, unknown methods share one slot */
+enum metrics_method{
+    METRICS_GET = 0,
+    METRICS_HEAD,
+    METRICS_POST,
+    METRICS_PUT,
+    METRICS_PATCH,
+    METRICS_DELETE,
+    METRICS_OPTIONS,
+    METRICS_OTHER,
+    METRICS_NMETHOD /* Number of entries, keep last */
+};
+
+/* Method label strings, indexed by enum metrics_method */
+static const char *metrics_method_name[METRICS_NMETHOD] = {
+    "GET", "HEAD", "POST", "PUT", "PATCH", "DELETE", "OPTIONS", "other"
+};
+
+/* Counters maintained by the restconf daemon.
+ * Single-threaded event loop and one daemon per process: plain increments on
+ * static counters, no locking needed and updates cannot fail
+ * @see _http_data_cache for a similar per-process singleton
+ */
+struct restconf_metrics{
+    uint64_t rm_req[METRICS_NMETHOD];      /* Requests dispatched, per method */
+    uint64_t rm_req_usec[METRICS_NMETHOD]; /* Summed request wall-time in us, per method */
+    uint64_t rm_conns_total;               /* Connections accepted since start */
+    uint64_t rm_conns_active;              /* Currently open connections */
+    uint64_t rm_streams_total;             /* HTTP/2 streams opened since start */
+    uint64_t rm_streams_active;            /* Currently open HTTP/2 streams */
+};
+static struct restconf_metrics _metrics = {{0,},};
+
+/*! Map an HTTP method string to its counter slot
+ * @param[in]  method  Method string, eg GET, or NULL
+ * @retval     m       Index into per-method counter arrays
+ */
+static enum metrics_method
+metrics_method_lookup(char *method)
+{
+    enum metrics_method m;
+
+    if (method == NULL)
+        return METRICS_OTHER;
+    for (m = 0; m < METRICS_OTHER; m++)
+        if (strcmp(method, metrics_method_name[m]) == 0)
+            return m;
+    return METRICS_OTHER;
+}
+
+/*! Account a dispatched request: count and wall-time by method
+ *
+ * Called at the end of request dispatch in the http/1 and http/2 paths.
+ * No-op if metrics are not enabled.
+ * @param[in]  h    Clixon handle
+ * @param[in]  t0   Time the dispatch started
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+restconf_metrics_req(clicon_handle   h,
+                     struct timeval *t0)
+{
+    struct timeval      t1;
+    struct timeval      td;
+    enum metrics_method m;
+
+    if (restconf_metrics_enabled_get(h) == 0)
+        return 0;
+    m = metrics_method_lookup(restconf_param_get(h, "REQUEST_METHOD"));
+    gettimeofday(&t1, NULL);
+    timersub(&t1, t0, &td);
+    _metrics.rm_req[m]++;
+    _metrics.rm_req_usec[m] += (uint64_t)td.tv_sec*1000000 + td.tv_usec;
+    return 0;
+}
+
+/*! Account a connection opened (delta 1) or closed (delta -1)
+ * No-op if metrics are not enabled.
+ * @param[in]  h      Clixon handle
+ * @param[in]  delta  1 on open, -1 on close
+ * @retval     0      OK
+ */
+int
+restconf_metrics_conn(clicon_handle h,
+                      int           delta)
+{
+    if (restconf_metrics_enabled_get(h) == 0)
+        return 0;
+    if (delta > 0)
+        _metrics.rm_conns_total++;
+    _metrics.rm_conns_active += delta;
+    return 0;
+}
+
+/*! Account an HTTP/2 stream opened (delta 1) or closed (delta -1)
+ * No-op if metrics are not enabled.
+ * @param[in]  h      Clixon handle
+ * @param[in]  delta  1 on open, -1 on close
+ * @retval     0      OK
+ */
+int
+restconf_metrics_stream(clicon_handle h,
+                        int           delta)
+{
+    if (restconf_metrics_enabled_get(h) == 0)
+        return 0;
+    if (delta > 0)
+        _metrics.rm_streams_total++;
+    _metrics.rm_streams_active += delta;
+    return 0;
+}
+
+/*! Check if uri path denotes the metrics endpoint
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     0    No, not the metrics path, or metrics not enabled
+ * @retval     1    Yes, the metrics path
+ * @see api_path_is_data
+ */
+int
+api_path_is_metrics(clicon_handle h)
+{
+    int   retval = 0;
+    char *path = NULL;
+
+    if (restconf_metrics_enabled_get(h) == 0)
+        goto done;
+    if ((path = restconf_uripath(h)) == NULL)
+        goto done;
+    if (strcmp(path, RESTCONF_METRICS_PATH) != 0)
+        goto done;
+    retval = 1;
+ done:
+    if (path)
+        free(path);
+    return retval;
+}
+
+/*! Serialize the counters in the Prometheus text exposition format
+ * @param[in]  rm   Metrics struct
+ * @param[out] cb   Scrape body
+ * @retval     0    OK
+ */
+static int
+metrics_serialize(struct restconf_metrics *rm,
+                  cbuf                    *cb)
+{
+    enum metrics_method m;
+    int                 nfd = 0;
+    int                 ntimeout = 0;
+
+    cprintf(cb, "# HELP clixon_restconf_requests_total Requests dispatched by HTTP method.\n");
+    cprintf(cb, "# TYPE clixon_restconf_requests_total counter\n");
+    for (m = 0; m < METRICS_NMETHOD; m++)
+        cprintf(cb, "clixon_restconf_requests_total{method=\"%s\"} %" PRIu64 "\n",
+                metrics_method_name[m], rm->rm_req[m]);
+    cprintf(cb, "# HELP clixon_restconf_request_duration_seconds_total Summed request wall-time by HTTP method.\n");
+    cprintf(cb, "# TYPE clixon_restconf_request_duration_seconds_total counter\n");
+    for (m = 0; m < METRICS_NMETHOD; m++)
+        cprintf(cb, "clixon_restconf_request_duration_seconds_total{method=\"%s\"} %" PRIu64 ".%06" PRIu64 "\n",
+                metrics_method_name[m],
+                rm->rm_req_usec[m]/1000000, rm->rm_req_usec[m]%1000000);
+    cprintf(cb, "# HELP clixon_restconf_connections_total Connections accepted since start.\n");
+    cprintf(cb, "# TYPE clixon_restconf_connections_total counter\n");
+    cprintf(cb, "clixon_restconf_connections_total %" PRIu64 "\n", rm->rm_conns_total);
+    cprintf(cb, "# HELP clixon_restconf_connections_active Currently open connections.\n");
+    cprintf(cb, "# TYPE clixon_restconf_connections_active gauge\n");
+    cprintf(cb, "clixon_restconf_connections_active %" PRIu64 "\n", rm->rm_conns_active);
+#ifdef HAVE_LIBNGHTTP2
+    cprintf(cb, "# HELP clixon_restconf_http2_streams_total HTTP/2 streams opened since start.\n");
+    cprintf(cb, "# TYPE clixon_restconf_http2_streams_total counter\n");
+    cprintf(cb, "clixon_restconf_http2_streams_total %" PRIu64 "\n", rm->rm_streams_total);
+    cprintf(cb, "# HELP clixon_restconf_http2_streams_active Currently open HTTP/2 streams.\n");
+    cprintf(cb, "# TYPE clixon_restconf_http2_streams_active gauge\n");
+    cprintf(cb, "clixon_restconf_http2_streams_active %" PRIu64 "\n", rm->rm_streams_active);
+#endif
+    clixon_event_stats(&nfd, &ntimeout);
+    cprintf(cb, "# HELP clixon_event_fds Registered event-loop file descriptor handlers.\n");
+    cprintf(cb, "# TYPE clixon_event_fds gauge\n");
+    cprintf(cb, "clixon_event_fds %d\n", nfd);
+    cprintf(cb, "# HELP clixon_event_timeouts Armed event-loop timeouts.\n");
+    cprintf(cb, "# TYPE clixon_event_timeouts gauge\n");
+    cprintf(cb, "clixon_event_timeouts %d\n", ntimeout);
+    return 0;
+}
+
+/*! Metrics scrape request
+ *
+ * Limited to GET, HEAD and OPTIONS, authentication as restconf.
+ * @param[in]  h    Clixon handle
+ * @param[in]  req  Generic Www handle (can be part of clixon handle)
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see api_http_data
+ */
+int
+api_metrics(clicon_handle h,
+            void         *req)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *request_method;
+    int   head = 0;
+    int   options = 0;
+    int   ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (req == NULL){
+        errno = EINVAL;
+        goto done;
+    }
+    request_method = restconf_param_get(h, "REQUEST_METHOD");
+    if (strcmp(request_method, "GET") == 0){
+    }
+    else if (strcmp(request_method, "HEAD") == 0){
+        head = 1;
+    }
+    else if (strcmp(request_method, "OPTIONS") == 0){
+        options = 1;
+    }
+    else {
+        if (restconf_reply_send(req, 405, NULL, 0) < 0) /* method not allowed */
+            goto done;
+        goto ok;
+    }
+    /* Authenticate as restconf
+     * Note, error handling may need change since it is restconf based
+     */
+    if ((ret = restconf_authentication_cb(h, req, 1, 0 /*media_out */)) < 0)
+        goto done;
+    if (ret == 0)
+        goto ok;
+    if (options){
+        if (restconf_reply_header(req, "Allow", "OPTIONS,HEAD,GET") < 0)
+            goto done;
+        if (restconf_reply_send(req, 200, NULL, 0) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (metrics_serialize(&_metrics, cb) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Content-Type", "text/plain; version=0.0.4; charset=utf-8") < 0)
+        goto done;
+    if (restconf_reply_send(req, 200, cb, head) < 0)
+        goto done;
+    cb = NULL;
+ ok:
+    retval = 0;
+ done:
+    clicon_debug(1, "%s %d", __FUNCTION__, retval);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
@@ -41,6 +41,7 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <syslog.h>
 #include <pwd.h>
 #include <ctype.h>
@@ -49,6 +50,9 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/resource.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 #include <openssl/ssl.h>
 #include <openssl/rand.h>
@@ -75,6 +79,7 @@
 #endif
 #ifdef HAVE_HTTP1
 #include "restconf_http1.h"
+#include "restconf_metrics.h"
 #endif
 
 /* Forward */
@@ -115,6 +120,8 @@ restconf_stream_data_new(restconf_conn *rc,
     }
     sd->sd_conn = rc;
     INSQ(sd, rc->rc_streams);
+    if (stream_id != 0) /* http/2 stream, not the http/1 pseudo-stream */
+        restconf_metrics_stream(rc->rc_h, 1);
     return sd;
 }
 
@@ -143,6 +150,10 @@ restconf_stream_find(restconf_conn *rc,
 int
 restconf_stream_free(restconf_stream_data *sd)
 {
+    if (sd->sd_stream_id != 0 && sd->sd_conn)
+        restconf_metrics_stream(sd->sd_conn->rc_h, -1);
+    if (sd->sd_conn) /* Orphan any deferred backend rpc still in flight */
+        restconf_backend_detach(sd->sd_conn->rc_h, sd);
     if (sd->sd_fd != -1) {
         close(sd->sd_fd);
     }
@@ -156,16 +167,58 @@ restconf_stream_free(restconf_stream_data *sd)
         cbuf_free(sd->sd_outp_buf);
     if (sd->sd_body)
         cbuf_free(sd->sd_body);
+    if (sd->sd_xcursor)
+        clixon_xml_cursor_free(sd->sd_xcursor);
+    if (sd->sd_xtree)
+        xml_free(sd->sd_xtree);
     if (sd->sd_path)
         free(sd->sd_path);
     if (sd->sd_settings2)
         free(sd->sd_settings2);
     if (sd->sd_qvec)
         cvec_free(sd->sd_qvec);
+#ifdef WITH_ZSTD
+    if (sd->sd_zcctx)
+        ZSTD_freeCCtx(sd->sd_zcctx);
+    if (sd->sd_zplain)
+        cbuf_free(sd->sd_zplain);
+#endif
     free(sd);
     return 0;
 }
 
+/*! Should the reply body be zstd content-encoded?
+ *
+ * Compression applies when built with --enable-zstd, CLICON_RESTCONF_COMPRESSION is
+ * true and the client lists zstd in Accept-Encoding (RFC 9110 Sec 12.5.3, the zstd
+ * content coding is RFC 8878 Sec 7.2). gzip is not offered: clixon carries no zlib
+ * dependency while libzstd is already optionally linked for the datastore.
+ * Must be called while the request parameters are still set.
+ * @param[in] sd  Http stream
+ * @retval    1   Compress
+ * @retval    0   Send identity
+ * @note The Accept-Encoding check is a substring match which tolerates q-values but
+ *       does not honor an explicit zstd;q=0 opt-out
+ */
+int
+restconf_compress_negotiate(restconf_stream_data *sd)
+{
+#ifdef WITH_ZSTD
+    clicon_handle h = sd->sd_conn->rc_h;
+    char         *ae;
+
+    if (clicon_option_bool(h, "CLICON_RESTCONF_COMPRESSION") == 0)
+        return 0;
+    if ((ae = restconf_param_get(h, "HTTP_ACCEPT_ENCODING")) == NULL)
+        return 0;
+    if (strstr(ae, "zstd") == NULL)
+        return 0;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
 /*! Create restconf connection struct, per connect, ie transient
  *
  * @param[in] h     Clixon handle
@@ -185,11 +238,17 @@ restconf_conn_new(clicon_handle    h,
         return NULL;
     }
     memset(rc, 0, sizeof(restconf_conn));
+    if ((rc->rc_inbuf = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        free(rc);
+        return NULL;
+    }
     rc->rc_h = h;
     rc->rc_s = s;
     rc->rc_callhome = rsock->rs_callhome;
     rc->rc_socket = rsock;
     INSQ(rc, rsock->rs_conns);
+    restconf_metrics_conn(h, 1);
     clicon_debug(1, "%s %p", __FUNCTION__, rc);
     return rc;
 }
@@ -232,6 +291,9 @@ restconf_conn_free(restconf_conn *rc)
             rc1 = NEXTQ(restconf_conn *, rc1);
         } while (rc1 && rc1 != rsock->rs_conns);
     }
+    if (rc->rc_inbuf)
+        cbuf_free(rc->rc_inbuf);
+    restconf_metrics_conn(rc->rc_h, -1);
     free(rc);
     retval = 0;
  done:
@@ -468,6 +530,88 @@ native_buf_write(clicon_handle    h,
     goto done;
 }
 
+/*! Write a file-backed reply body (sd_fd) to the connection socket, after the headers
+ *
+ * Plain sockets use sendfile where available so the file bytes move kernel-to-kernel
+ * without passing through user space; SSL must encrypt in user space so the file is
+ * read in chunks and passed through native_buf_write.
+ * Offset-explicit i/o (pread, sendfile with offset) since sd_fd may be dup:ed from
+ * the http-data file cache where dup:ed descriptors share one file offset.
+ * @param[in]  h        Clixon handle
+ * @param[in]  sd       Http stream, sd_fd/sd_body_len/sd_body_offset describe the body
+ * @param[in]  rc       Connection struct
+ * @param[in]  callfn   For debug
+ * @retval  1  OK
+ * @retval  0  OK, but socket write returned error, caller should close rc
+ * @retval -1  Error
+ * @see native_buf_write
+ */
+static int
+native_file_write(clicon_handle    h,
+                  restconf_stream_data *sd,
+                  restconf_conn   *rc,
+                  const char      *callfn)
+{
+    int     retval = -1;
+    char    buf[BUFSIZ];
+    size_t  chunk;
+    ssize_t len;
+    int     ret;
+#ifdef __linux__
+    off_t   off;
+#endif
+
+    clicon_debug(1, "%s %s len:%zu", __FUNCTION__, callfn, sd->sd_body_len);
+    while (sd->sd_body_offset < sd->sd_body_len){
+#ifdef __linux__
+        if (rc->rc_ssl == NULL){
+            off = sd->sd_body_offset;
+            if ((len = sendfile(rc->rc_s, sd->sd_fd, &off,
+                                sd->sd_body_len - sd->sd_body_offset)) < 0){
+                switch (errno){
+                case EAGAIN:     /* Operation would block */
+                    clicon_debug(1, "%s sendfile EAGAIN", __FUNCTION__);
+                    usleep(10000);
+                    continue;
+                    break;
+                case ECONNRESET: /* Connection reset by peer */
+                case EPIPE:      /* Broken pipe */
+                    goto closed; /* Close socket and ssl */
+                    break;
+                default:
+                    clicon_err(OE_UNIX, errno, "sendfile");
+                    goto done;
+                    break;
+                }
+            }
+            sd->sd_body_offset = off;
+            continue;
+        }
+#endif
+        chunk = sd->sd_body_len - sd->sd_body_offset;
+        if (chunk > sizeof(buf))
+            chunk = sizeof(buf);
+        if ((len = pread(sd->sd_fd, buf, chunk, sd->sd_body_offset)) < 0){
+            clicon_err(OE_UNIX, errno, "pread");
+            goto done;
+        }
+        if (len == 0) /* file truncated under us, cut the body short */
+            break;
+        if ((ret = native_buf_write(h, buf, len, rc, callfn)) < 0)
+            goto done;
+        if (ret == 0)
+            goto closed;
+        sd->sd_body_offset += len;
+    }
+    retval = 1;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    return retval;
+ closed:
+    retval = 0;
+    goto done;
+}
+
 /*! Send early handcoded bad request reply before actual packet received, just after accept
  * @param[in]  h    Clixon handle
  * @param[in]  media
@@ -636,9 +780,102 @@ read_regular(restconf_conn *rc,
 
 #ifdef HAVE_HTTP1
 
+/*! Frame the first http/1 message in the connection input buffer
+ *
+ * Find end-of-headers and scan the header block for the framing-relevant fields
+ * (the message is parsed properly later), so that the parser is only given exactly
+ * one complete message at a time.
+ * @param[in]  str     Input buffer (null-terminated), starts at a message boundary
+ * @param[in]  len     Length of data in input buffer
+ * @param[out] hdrlenp Length of header block including terminating CRLF CRLF,
+ *                     0 if headers incomplete
+ * @param[out] expectp Set to 1 if an Expect: 100-continue header is present
+ * @retval     msglen  Length of first complete message (headers + body)
+ * @retval     0       Message incomplete, read more
+ */
+static size_t
+http1_frame_length(char   *str,
+                   size_t  len,
+                   size_t *hdrlenp,
+                   int    *expectp)
+{
+    char  *hdrend;
+    char  *line;
+    char  *p;
+    size_t hdrlen;
+    long   clen = 0;
+
+    if ((hdrend = strstr(str, "\r\n\r\n")) == NULL)
+        return 0;
+    hdrlen = hdrend - str + 4;
+    for (line = str; line < hdrend; line = p + 2){
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+            clen = strtol(line+15, NULL, 10);
+        else if (strncasecmp(line, "Expect:", 7) == 0){
+            p = line + 7;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (strncasecmp(p, "100-continue", 12) == 0)
+                *expectp = 1;
+        }
+        if ((p = strstr(line, "\r\n")) == NULL)
+            break;
+    }
+    if (clen < 0)
+        clen = 0;
+    *hdrlenp = hdrlen;
+    if (len < hdrlen + clen)
+        return 0;
+    return hdrlen + clen;
+}
+
+/*! Consume a processed message from the connection input buffer, keep pipelined rest
+ *
+ * @param[in]  rc      Restconf connection handle
+ * @param[in]  msglen  Length of the processed message at the head of rc_inbuf
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+http1_consume_msg(restconf_conn *rc,
+                  size_t         msglen)
+{
+    int    retval = -1;
+    size_t inlen;
+    char  *str;
+    char  *rest = NULL;
+
+    inlen = cbuf_len(rc->rc_inbuf);
+    str = cbuf_get(rc->rc_inbuf);
+    if (inlen > msglen){
+        if ((rest = malloc(inlen - msglen)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memcpy(rest, str + msglen, inlen - msglen);
+        cbuf_reset(rc->rc_inbuf);
+        if (cbuf_append_buf(rc->rc_inbuf, rest, inlen - msglen) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append");
+            goto done;
+        }
+    }
+    else
+        cbuf_reset(rc->rc_inbuf);
+    retval = 0;
+ done:
+    if (rest)
+        free(rest);
+    return retval;
+}
+
 /*! Restconf HTTP/1 processing after chunk of bytes read
  *
- * @param[in]  rc           Restconf connection handle 
+ * Append the chunk to the persistent connection input buffer and process every
+ * complete message in it before returning to the event loop, so clients that
+ * pipeline requests on one connection do not pay an event-loop roundtrip (and
+ * a read() each) per request. A trailing partial message is kept in the buffer
+ * across calls.
+ * @param[in]  rc           Restconf connection handle
  * @param[in]  buf          Input buffer
  * @param[in]  n            Length of data in input buffer
  * @param[out] readmore     If set, read data again, do not continue processing
@@ -656,69 +893,76 @@ restconf_http1_process(restconf_conn *rc,
     restconf_stream_data *sd;
     clicon_handle         h;
     int                   ret;
-    int                   status;
     cbuf                 *cberr = NULL;
-    
+    char                 *str;
+    size_t                inlen;
+    size_t                msglen;
+    size_t                hdrlen;
+    int                   expect;
+
     h = rc->rc_h;
     if ((sd = restconf_stream_find(rc, 0)) == NULL){
         clicon_err(OE_RESTCONF, EINVAL, "restconf stream not found");
         goto done;
     }
-    /* Two states for reading:
-     * 1) Initial reading of headers, parse from start
-     * 2) Headers are read / body started, dont parse, just append body
-     */
-    /* Check whole message is read. 
-     * Only way this could happen is that body is read
-     * 0: No Content-Length or 0
-     *    header does not contain Content-Length or is 0
-     *    (OR: message header not fully read SHOULDNT HAPPEN IF BODY READ)
-     * 1: Content-Length found but body has fewer bytes, ie remaining bytes to read
-     * 2: Content-Length found and matches body length. No more bytes to read
-     */
-    if ((ret = http1_check_content_length(h, sd, &status)) < 0)
+    if (n > 0 &&
+        cbuf_append_buf(rc->rc_inbuf, buf, n) < 0){
+        clicon_err(OE_UNIX, errno, "cbuf_append");
         goto done;
-    if (status == 1){   /* Next read: keep header state and only append inbody */
-        if (cbuf_append_buf(sd->sd_indata, buf, n) < 0){
-            clicon_err(OE_UNIX, errno, "cbuf_append");
-            goto done;
-        }
     }
-    else {
-        /* multi-buffer for multiple reads 
-         * This is different from sd_indata that it is before and includes headers
-         */
-        if (cbuf_append_buf(sd->sd_inbuf, buf, n) < 0){
-            clicon_err(OE_UNIX, errno, "cbuf_append");
-            goto done;
-        }
-        if (clixon_http1_parse_string(h, rc, cbuf_get(sd->sd_inbuf)) < 0){
-            /* XXX This does not work for SSL */
-            if (rc->rc_ssl){
-                ret = SSL_pending(rc->rc_ssl);
-            }
-            else if ((ret = clixon_event_poll(rc->rc_s)) < 0)
-                goto done;
-            if (ret > 0){
+    if (sd->sd_defer){
+        /* A reply is pending on a backend rpc: just buffer the input, it is
+         * processed from restconf_native_deferred_done when the reply is sent */
+        retval = 1;
+        goto done;
+    }
+    while ((inlen = cbuf_len(rc->rc_inbuf)) > 0){
+        str = cbuf_get(rc->rc_inbuf);
+        hdrlen = 0;
+        expect = 0;
+        if ((msglen = http1_frame_length(str, inlen, &hdrlen, &expect)) == 0){
+            /* Message incomplete: keep it buffered, the event loop calls again on
+             * more data. If the headers are complete with Expect: 100-continue,
+             * reply Continue (once) so the client sends the body.
+             */
+            if (hdrlen > 0 && expect && sd->sd_continue100 == 0){
+                if (clixon_http1_parse_buf(h, rc, str, hdrlen) < 0)
+                    goto badrequest;
+                if ((ret = http1_check_expect(h, rc, sd)) < 0)
+                    goto done;
+                if (ret == 1){
+                    if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
+                                                rc, __FUNCTION__)) < 0)
+                        goto done;
+                    cvec_reset(sd->sd_outp_hdrs);
+                    cbuf_reset(sd->sd_outp_buf);
+                    sd->sd_continue100 = 1;
+                    if (ret == 0){
+                        if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
+                            goto done;
+                        retval = 0;
+                        goto done;
+                    }
+                }
                 if (http1_native_clear_input(h, sd) < 0)
                     goto done;
-                (*readmore)++;
-                goto ok;
             }
-            /* Return error. Honestly, the sender could just e slow, it should really be a 
-             * timeout here.
+            /* Rest of message may be buffered in the SSL layer where it does not
+             * trigger the event loop: read again if bytes are pending
              */
-            if ((cberr = cbuf_new()) == NULL){
-                clicon_err(OE_UNIX, errno, "cbuf_new");
-                goto done;
-            }
-            cprintf(cberr, "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>%s</error-message></error></errors>", clicon_err_reason);
-            if ((ret = native_send_badrequest(h, "application/yang-data+xml", cbuf_get(cberr), rc)) < 0)
+            if (rc->rc_ssl)
+                ret = SSL_pending(rc->rc_ssl);
+            else if ((ret = clixon_event_poll(rc->rc_s)) < 0)
                 goto done;
-            goto ok;
+            if (ret > 0)
+                (*readmore)++;
+            break;
         }
-        /* Check for Continue and if so reply with 100 Continue 
-         * ret == 1: send reply
+        if (clixon_http1_parse_buf(h, rc, str, msglen) < 0)
+            goto badrequest;
+        sd->sd_continue100 = 0;
+        /* Check for Continue and if so reply with 100 Continue
+         * ret == 1: send reply (client sent the body without waiting)
          */
         if ((ret = http1_check_expect(h, rc, sd)) < 0)
             goto done;
@@ -731,37 +975,122 @@ restconf_http1_process(restconf_conn *rc,
             if (ret == 0){
                 if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
                     goto done;
-                rc = NULL;
                 retval = 0;
                 goto done;
             }
         }
-    }
-    /* Check whole message is read. 
-     * Only way this could happen is that body is read
-     * 0: No Content-Length or 0
-     *    header does not contain Content-Length or is 0
-     *    (OR: message header not fully read SHOULDNT HAPPEN IF BODY READ OK in parse above)
-     * 1: Content-Length found but body has fewer bytes, ie remaining bytes to read
-     * 2: Content-Length found and matches body length. No more bytes to read
+        /* nginx compatible, set HTTPS parameter if SSL */
+        if (rc->rc_ssl)
+            if (restconf_param_set(h, "HTTPS", "https") < 0)
+                goto done;
+        /* main restconf processing */
+        if (restconf_http1_path_root(h, rc) < 0)
+            goto done;
+        if (sd->sd_defer){
+            /* Reply deferred on a pooled backend rpc: consume the message, hold off
+             * the write and stream reset until restconf_native_deferred_done */
+            if (http1_consume_msg(rc, msglen) < 0)
+                goto done;
+            retval = 1;
+            goto done;
+        }
+        if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
+                                    rc, __FUNCTION__)) < 0)
+            goto done;
+        cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
+        cbuf_reset(sd->sd_outp_buf);
+        /* File-backed body (eg static http-data file) follows the headers */
+        if (ret == 1 && sd->sd_fd != -1){
+            if ((ret = native_file_write(h, sd, rc, __FUNCTION__)) < 0)
+                goto done;
+            close(sd->sd_fd);
+            sd->sd_fd = -1;
+        }
+        cbuf_reset(sd->sd_inbuf);
+        cbuf_reset(sd->sd_indata);
+        if (sd->sd_body)
+            cbuf_reset(sd->sd_body);
+        if (sd->sd_qvec){
+            cvec_free(sd->sd_qvec);
+            sd->sd_qvec = NULL;
+        }
+        if (ret == 0 || rc->rc_exit){  /* Server-initiated exit */
+            if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
+                goto done;
+            retval = 0;
+            goto done;
+        }
+        /* Consume the processed message, keep any pipelined rest */
+        if (http1_consume_msg(rc, msglen) < 0)
+            goto done;
+        /* http/2 upgrade is handled by the caller between messages */
+        if (sd->sd_upgrade2)
+            break;
+    } /* while */
+    retval = 1;
+ done:
+    if (cberr)
+        cbuf_free(cberr);
+    return retval;
+ badrequest:
+    /* Parse error on a framed message is a real client error, not a short read:
+     * reply 400 and drop buffered input (no reliable resync point)
      */
-    if ((ret = http1_check_content_length(h, sd, &status)) < 0)
+    if ((cberr = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    if (status == 1){
-        (*readmore)++;
-        goto ok;
     }
-    /* nginx compatible, set HTTPS parameter if SSL */
-    if (rc->rc_ssl)
-        if (restconf_param_set(h, "HTTPS", "https") < 0)
-            goto done;
-    /* main restconf processing */
-    if (restconf_http1_path_root(h, rc) < 0)
+    cprintf(cberr, "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>%s</error-message></error></errors>", clicon_err_reason);
+    if (native_send_badrequest(h, "application/yang-data+xml", cbuf_get(cberr), rc) < 0)
+        goto done;
+    cbuf_reset(rc->rc_inbuf);
+    retval = 1;
+    goto done;
+}
+
+/*! Timeout callback to resume reading on a connection after a deferred reply
+ *
+ * Registered by restconf_native_deferred_done when bytes are buffered in the SSL
+ * layer: they do not trigger the socket event callback by themselves.
+ */
+static int
+restconf_connection_kick(int   fd,
+                         void *arg)
+{
+    restconf_conn *rc = (restconf_conn *)arg;
+
+    return restconf_connection(rc->rc_s, rc);
+}
+
+/*! Complete a deferred http/1 reply when the pooled backend rpc has finished
+ *
+ * The reply fields of sd have been filled in (restconf_reply_send from the rpc
+ * completion callback): serialize and write the reply, then process any input
+ * that was buffered on the connection while the reply was pending.
+ * @param[in]  sd  Http stream with sd_defer set
+ * @retval     0   OK (including connection closed)
+ * @retval    -1   Error
+ * @see restconf_reply_defer  where the reply was deferred
+ */
+int
+restconf_native_deferred_done(restconf_stream_data *sd)
+{
+    int            retval = -1;
+    restconf_conn *rc = sd->sd_conn;
+    clicon_handle  h = rc->rc_h;
+    int            readmore = 0;
+    struct timeval now;
+    int            ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    sd->sd_defer = 0;
+    if (sd->sd_code &&
+        restconf_http1_reply(rc, sd) < 0)
         goto done;
     if ((ret = native_buf_write(h, cbuf_get(sd->sd_outp_buf), cbuf_len(sd->sd_outp_buf),
                                 rc, __FUNCTION__)) < 0)
         goto done;
-    cvec_reset(sd->sd_outp_hdrs); /* Can be done in native_send_reply */
+    cvec_reset(sd->sd_outp_hdrs);
     cbuf_reset(sd->sd_outp_buf);
     cbuf_reset(sd->sd_inbuf);
     cbuf_reset(sd->sd_indata);
@@ -777,14 +1106,27 @@ restconf_http1_process(restconf_conn *rc,
         retval = 0;
         goto done;
     }
- ok:
-    retval = 1;
+    gettimeofday(&rc->rc_t, NULL); /* activity timer */
+    /* Process requests pipelined behind the deferred one */
+    if (cbuf_len(rc->rc_inbuf) > 0){
+        if ((ret = restconf_http1_process(rc, NULL, 0, &readmore)) < 0)
+            goto done;
+        if (ret == 0){
+            retval = 0;
+            goto done;
+        }
+    }
+    if (readmore){
+        gettimeofday(&now, NULL);
+        if (clixon_event_reg_timeout(now, restconf_connection_kick, rc,
+                                     "restconf deferred reply kick") < 0)
+            goto done;
+    }
+    retval = 0;
  done:
-    if (cberr)
-        cbuf_free(cberr);
     return retval;
 }
-#endif
+#endif /* HAVE_HTTP1 */
 
 #ifdef HAVE_LIBNGHTTP2
 #ifdef HAVE_HTTP1
@@ -1036,6 +1378,9 @@ restconf_connection_close1(restconf_conn *rc)
         goto done;
     }
     clixon_event_unreg_fd(rc->rc_s, restconf_connection);
+#ifdef HAVE_HTTP1
+    clixon_event_unreg_timeout(restconf_connection_kick, rc);
+#endif
     /* re-set timer */
     if (rc->rc_callhome){
         if (rsock->rs_periodic)
@@ -1164,13 +1509,235 @@ ssl_alpn_check(clicon_handle        h,
     return retval;
 } /* ssl_alpn_check */
 
+/*! Attempt TLS handshake on an accepted (or connected) socket
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  rc    Restconf connection
+ * @retval     2     Handshake in progress (want read/write), retry when socket is ready
+ * @retval     1     Handshake complete
+ * @retval     0     OK, but connection closed (rc freed)
+ * @retval    -1     Error
+ */
+static int
+restconf_ssl_handshake_try(clicon_handle  h,
+                           restconf_conn *rc)
+{
+    int retval = -1;
+    int ret;
+    int e;
+    int er;
+
+    /* 1: OK, -1 fatal, 0: TLS/SSL handshake was not successful
+     * Both error cases: Call SSL_get_error() with the return value ret
+     */
+    if ((ret = SSL_accept(rc->rc_ssl)) == 1)
+        goto complete;
+    clicon_debug(1, "%s SSL_accept() ret:%d errno:%d", __FUNCTION__, ret, er=errno);
+    e = SSL_get_error(rc->rc_ssl, ret);
+    switch (e){
+    case SSL_ERROR_SSL:                  /* 1 */
+        clicon_debug(1, "%s SSL_ERROR_SSL (non-ssl message on ssl socket)", __FUNCTION__);
+#ifdef HTTP_ON_HTTPS_REPLY
+        SSL_free(rc->rc_ssl);
+        rc->rc_ssl = NULL;
+        if (native_send_badrequest(h, "application/yang-data+xml",
+                                   "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>The plain HTTP request was sent to HTTPS port</error-message></error></errors>", rc) < 0)
+            goto done;
+#endif
+        if (restconf_close_ssl_socket(rc, __FUNCTION__, 1) < 0)
+            goto done;
+        goto closed;
+        break;
+    case SSL_ERROR_SYSCALL:              /* 5 */
+        /* Some non-recoverable, fatal I/O error occurred. The OpenSSL error queue
+           may contain more information on the error. For socket I/O on Unix systems,
+           consult errno for details. If this error occurs then no further I/O
+           operations should be performed on the connection and SSL_shutdown() must
+           not be called.*/
+        clicon_debug(1, "%s SSL_accept() SSL_ERROR_SYSCALL %d", __FUNCTION__, er);
+        if (restconf_close_ssl_socket(rc, __FUNCTION__, 1) < 0)
+            goto done;
+        goto closed;
+        break;
+    case SSL_ERROR_WANT_READ:            /* 2 */
+    case SSL_ERROR_WANT_WRITE:           /* 3 */
+        /* SSL_ERROR_WANT_READ is returned when the last operation was a read operation
+         * from a nonblocking BIO.
+         * That is, it can happen if restconf_socket_init() below is called
+         * with SOCK_NONBLOCK
+         */
+        clicon_debug(1, "%s SSL_ERROR_WANT_READ", __FUNCTION__);
+        retval = 2;
+        goto done;
+        break;
+    case SSL_ERROR_NONE:                 /* 0 */
+    case SSL_ERROR_ZERO_RETURN:          /* 6 */
+    case SSL_ERROR_WANT_CONNECT:         /* 7 */
+    case SSL_ERROR_WANT_ACCEPT:          /* 8 */
+    case SSL_ERROR_WANT_X509_LOOKUP:     /* 4 */
+    case SSL_ERROR_WANT_ASYNC:           /* 8 */
+    case SSL_ERROR_WANT_ASYNC_JOB:       /* 10 */
+#ifdef SSL_ERROR_WANT_CLIENT_HELLO_CB
+    case SSL_ERROR_WANT_CLIENT_HELLO_CB: /* 11 */
+#endif
+    default:
+        clicon_err(OE_SSL, 0, "SSL_accept:%d", e);
+        goto done;
+        break;
+    }
+ complete:
+    retval = 1;
+ done:
+    return retval;
+ closed:
+    retval = 0;
+    goto done;
+} /* restconf_ssl_handshake_try */
+
+/*! Post-handshake connection setup: check ALPN, init http proto, register data socket
+ *
+ * Called when the TLS handshake is complete, or directly for non-TLS sockets.
+ * @param[in]  h     Clixon handle
+ * @param[in]  rc    Restconf connection
+ * @param[out] rcp   Restconf connection, if present and retval=1
+ * @retval     1     OK, connection is up, rcp set
+ * @retval     0     OK, but connection closed
+ * @retval    -1     Error
+ */
+static int
+restconf_ssl_accept_done(clicon_handle   h,
+                         restconf_conn  *rc,
+                         restconf_conn **rcp)
+{
+    int                  retval = -1;
+    int                  ret;
+    const unsigned char *alpn = NULL;
+    unsigned int         alpnlen = 0;
+    restconf_http_proto  proto = HTTP_11;  /* Non-SSL negotiation NYI */
+
+#ifdef HAVE_LIBNGHTTP2
+#ifndef HAVE_HTTP1
+    proto = HTTP_2;     /* If nghttp2 only let default be 2.0  */
+#endif
+#endif
+    if (rc->rc_ssl != NULL){
+        /* Sets data and len to point to the client's requested protocol for this connection. */
+#ifndef OPENSSL_NO_NEXTPROTONEG
+        SSL_get0_next_proto_negotiated(rc->rc_ssl, &alpn, &alpnlen);
+#endif /* !OPENSSL_NO_NEXTPROTONEG */
+        if (alpn == NULL) {
+            /* Returns a pointer to the selected protocol in data with length len. */
+            SSL_get0_alpn_selected(rc->rc_ssl, &alpn, &alpnlen);
+        }
+        if ((ret = ssl_alpn_check(h, alpn, alpnlen, rc, &proto)) < 0)
+            goto done;
+        if (ret == 0)
+            goto closed;
+        clicon_debug(1, "%s proto:%s", __FUNCTION__, restconf_proto2str(proto));
+        /* Get the actual peer, XXX this maybe could be done in ca-auth client-cert code ?
+         * Note this _only_ works if SSL_set1_host() was set previously,...
+         */
+        if ((ret = SSL_get_verify_result(rc->rc_ssl)) == X509_V_OK) { /* for peer cert */
+            const char *peername = SSL_get0_peername(rc->rc_ssl);
+            if (peername != NULL) {
+                /* Name checks were in scope and matched the peername */
+                clicon_debug(1, "%s peername:%s", __FUNCTION__, peername);
+            }
+        }
+    } /* if ssl */
+    rc->rc_proto = proto;
+    switch (rc->rc_proto){
+#ifdef HAVE_HTTP1
+    case HTTP_10:
+    case HTTP_11:
+        /* Create a default stream for http/1 */
+        if (restconf_stream_data_new(rc, 0) == NULL)
+            goto done;
+        break;
+#endif /* HAVE_HTTP1 */
+#ifdef HAVE_LIBNGHTTP2
+    case HTTP_2:{
+        if (http2_session_init(rc) < 0){
+            restconf_close_ssl_socket(rc, __FUNCTION__, 0);
+            goto done;
+        }
+        if (http2_send_server_connection(rc) < 0){
+            restconf_close_ssl_socket(rc, __FUNCTION__, 0);
+            goto done;
+        }
+        break;
+    }
+#endif /* HAVE_LIBNGHTTP2 */
+    default:
+        break;
+    } /* switch proto */
+    gettimeofday(&rc->rc_t, NULL); /* activity timer */
+    if (clixon_event_reg_fd(rc->rc_s, restconf_connection, (void*)rc, "restconf client socket") < 0)
+        goto done;
+    if (rcp)
+        *rcp = rc;
+    retval = 1; /* OK, up */
+ done:
+    clicon_debug(1, "%s retval %d", __FUNCTION__, retval);
+    return retval;
+ closed:
+    retval = 0; /* OK, closed */
+    goto done;
+} /* restconf_ssl_accept_done */
+
+/*! Event callback: continue TLS handshake when the socket is readable/writable
+ *
+ * Registered by restconf_ssl_accept_client when SSL_accept wants read/write on a
+ * non-blocking socket, so that the event loop keeps serving other connections while
+ * this handshake completes, instead of spinning on the handshake inline.
+ * @param[in]  s    Socket
+ * @param[in]  arg  restconf_conn
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+restconf_ssl_handshake_cb(int   s,
+                          void *arg)
+{
+    int              retval = -1;
+    restconf_conn   *rc = (restconf_conn *)arg;
+    clicon_handle    h = rc->rc_h;
+    restconf_socket *rsock = rc->rc_socket;
+    int              ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    /* Unregister before the handshake attempt: restconf_close_ssl_socket may free rc */
+    clixon_event_unreg_fd(s, restconf_ssl_handshake_cb);
+    if ((ret = restconf_ssl_handshake_try(h, rc)) < 0)
+        goto done;
+    if (ret == 2){ /* Still in progress, re-register */
+        if (clixon_event_reg_fd(s, restconf_ssl_handshake_cb, rc, "restconf tls handshake") < 0)
+            goto done;
+        goto ok;
+    }
+    if (ret == 0) /* Closed, rc is freed */
+        goto ok;
+    if ((ret = restconf_ssl_accept_done(h, rc, NULL)) < 0)
+        goto done;
+    /* For synchronous handshakes the callhome idle timer is set by restconf_callhome_cb */
+    if (ret == 1 && rc->rc_callhome &&
+        rsock->rs_periodic && rsock->rs_idle_timeout){
+        if (restconf_idle_timer(rc) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+} /* restconf_ssl_handshake_cb */
+
 /*! Accept new socket client. Note SSL not ip, this applies also to callhome
  * @param[in]  h     Clixon handle
  * @param[in]  s     Socket (unix or ip)
  * @param[in]  rsock Socket struct
  * @param[out] rcp   Restconf connection, if present and retval=1
  * @retval     1     OK, connection is up, rcp set
- * @retval     0     OK, but connection closed
+ * @retval     0     OK, but connection closed or TLS handshake still in progress
  * @retval    -1     Error
  * @see openssl_init_socket where this callback is registered
  */
@@ -1183,21 +1750,9 @@ restconf_ssl_accept_client(clicon_handle    h,
     int                     retval = -1;
     restconf_native_handle *rn = NULL;
     restconf_conn          *rc = NULL;
-    char                   *name = NULL;
     int                     ret;
-    int                     e;
-    int                     er;
-    int                     readmore;
-    const unsigned char    *alpn = NULL;
-    unsigned int            alpnlen = 0;
-    restconf_http_proto     proto = HTTP_11;  /* Non-SSL negotiation NYI */
 
     clicon_debug(1, "%s", __FUNCTION__);
-#ifdef HAVE_LIBNGHTTP2
-#ifndef HAVE_HTTP1
-    proto = HTTP_2;     /* If nghttp2 only let default be 2.0  */
-#endif
-#endif
     if ((rn = restconf_native_handle_get(h)) == NULL){
         clicon_err(OE_XML, EFAULT, "No openssl handle");
         goto done;
@@ -1243,170 +1798,26 @@ restconf_ssl_accept_client(clicon_handle    h,
             clicon_err(OE_SSL, 0, "SSL_set_fd");
             goto done;
         }
-        readmore = 1;
-        while (readmore){
-            readmore = 0;
-            /* 1: OK, -1 fatal, 0: TLS/SSL handshake was not successful
-             * Both error cases: Call SSL_get_error() with the return value ret 
-             */
-            if ((ret = SSL_accept(rc->rc_ssl)) != 1) {
-                clicon_debug(1, "%s SSL_accept() ret:%d errno:%d", __FUNCTION__, ret, er=errno);
-                e = SSL_get_error(rc->rc_ssl, ret);
-                switch (e){
-                case SSL_ERROR_SSL:                  /* 1 */
-                    clicon_debug(1, "%s SSL_ERROR_SSL (non-ssl message on ssl socket)", __FUNCTION__);
-#ifdef HTTP_ON_HTTPS_REPLY
-                    SSL_free(rc->rc_ssl);
-                    rc->rc_ssl = NULL;
-                    if (native_send_badrequest(h, "application/yang-data+xml",
-                                               "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>The plain HTTP request was sent to HTTPS port</error-message></error></errors>", rc) < 0)
-                        goto done;
-#endif
-                    if (restconf_close_ssl_socket(rc, __FUNCTION__, 1) < 0)
-                        goto done;
-                    goto closed;
-                    break;
-                case SSL_ERROR_SYSCALL:              /* 5 */
-                    /* Some non-recoverable, fatal I/O error occurred. The OpenSSL error queue 
-                       may contain more information on the error. For socket I/O on Unix systems, 
-                       consult errno for details. If this error occurs then no further I/O
-                       operations should be performed on the connection and SSL_shutdown() must 
-                       not be called.*/
-                    clicon_debug(1, "%s SSL_accept() SSL_ERROR_SYSCALL %d", __FUNCTION__, er);
-                    if (restconf_close_ssl_socket(rc, __FUNCTION__, 1) < 0)
-                        goto done;
-                    rc = NULL;
-                    goto closed;
-                    break;
-                case SSL_ERROR_WANT_READ:            /* 2 */
-                case SSL_ERROR_WANT_WRITE:           /* 3 */
-                    /* SSL_ERROR_WANT_READ is returned when the last operation was a read operation 
-                     * from a nonblocking BIO. 
-                     * That is, it can happen if restconf_socket_init() below is called 
-                     * with SOCK_NONBLOCK
-                     */
-                    clicon_debug(1, "%s write SSL_ERROR_WANT_READ", __FUNCTION__);
-                    usleep(10000);
-                    readmore = 1;
-                    break;
-                case SSL_ERROR_NONE:                 /* 0 */
-                case SSL_ERROR_ZERO_RETURN:          /* 6 */
-                case SSL_ERROR_WANT_CONNECT:         /* 7 */
-                case SSL_ERROR_WANT_ACCEPT:          /* 8 */
-                case SSL_ERROR_WANT_X509_LOOKUP:     /* 4 */
-                case SSL_ERROR_WANT_ASYNC:           /* 8 */
-                case SSL_ERROR_WANT_ASYNC_JOB:       /* 10 */
-#ifdef SSL_ERROR_WANT_CLIENT_HELLO_CB
-                case SSL_ERROR_WANT_CLIENT_HELLO_CB: /* 11 */
-#endif
-                default:
-                    clicon_err(OE_SSL, 0, "SSL_accept:%d", e);
-                    goto done;
-                    break;
-                }
-            } /* SSL_accept */
-        } /* while(readmore) */
-        /* Sets data and len to point to the client's requested protocol for this connection. */
-#ifndef OPENSSL_NO_NEXTPROTONEG
-        SSL_get0_next_proto_negotiated(rc->rc_ssl, &alpn, &alpnlen);
-#endif /* !OPENSSL_NO_NEXTPROTONEG */
-        if (alpn == NULL) {
-            /* Returns a pointer to the selected protocol in data with length len. */
-            SSL_get0_alpn_selected(rc->rc_ssl, &alpn, &alpnlen);
-        }
-        if ((ret = ssl_alpn_check(h, alpn, alpnlen, rc, &proto)) < 0)
+        if ((ret = restconf_ssl_handshake_try(h, rc)) < 0)
             goto done;
         if (ret == 0)
             goto closed;
-        clicon_debug(1, "%s proto:%s", __FUNCTION__, restconf_proto2str(proto));
-
-#if 0 /* Seems too early to fail here, instead let authentication callback deal with this */
-        /* For client-cert authentication, check if any certs are present,
-        * if not, send bad request
-        * Alt: set SSL_CTX_set_verify(ctx, SSL_VERIFY_FAIL_IF_NO_PEER_CERT)
-        * but then SSL_accept fails.
-        */
-        if (restconf_auth_type_get(h) == CLIXON_AUTH_CLIENT_CERTIFICATE){
-            X509 *peercert;
-
-            if ((peercert = SSL_get_peer_certificate(rc->rc_ssl)) != NULL){
-                X509_free(peercert);
-            }
-            else { /* Get certificates (if available) */
-                if (proto != HTTP_2 &&
-                    native_send_badrequest(h, rc->rc_s, rc->rc_ssl, "application/yang-data+xml",
-                                                  "<errors xmlns=\"urn:ietf:params:xml:ns:yang:ietf-restconf\"><error><error-type>protocol</error-type><error-tag>malformed-message</error-tag><error-message>Peer certificate required</error-message></error></errors>", rc->rc_socket, rc) < 0)
-                    goto done;
-                if (restconf_close_ssl_socket(rc, __FUNCTION__, 0) < 0)
-                    goto done;
-                goto closed;
-            }
-        }
-#endif
-        /* Get the actual peer, XXX this maybe could be done in ca-auth client-cert code ? 
-         * Note this _only_ works if SSL_set1_host() was set previously,...
-         */
-        if ((ret = SSL_get_verify_result(rc->rc_ssl)) == X509_V_OK) { /* for peer cert */
-            const char *peername = SSL_get0_peername(rc->rc_ssl);
-            if (peername != NULL) {
-                /* Name checks were in scope and matched the peername */
-                clicon_debug(1, "%s peername:%s", __FUNCTION__, peername);
-            }
-        }
-#if 0
-        else{
-            clicon_log(LOG_NOTICE, "Cert error: %s", X509_verify_cert_error_string(ret));
-            /* Maybe should return already  here, but to get proper return message need to
-             * continue to http/1 or http/2 handling
-             * @see restconf_connection_sanity
+        if (ret == 2){
+            /* Handshake in progress on a non-blocking socket: continue it from the event
+             * loop instead of blocking all other connections here
              */
-
+            if (clixon_event_reg_fd(rc->rc_s, restconf_ssl_handshake_cb, rc, "restconf tls handshake") < 0)
+                goto done;
+            goto closed; /* Not closed, but not up yet: rcp not set */
         }
-#endif
-#if 0 /* debug */
-        if (clicon_debug_get())
-            restconf_listcerts(rc->rc_ssl);
-#endif
     } /* if ssl */
-    rc->rc_proto = proto;
-    switch (rc->rc_proto){
-#ifdef HAVE_HTTP1
-    case HTTP_10:
-    case HTTP_11:
-        /* Create a default stream for http/1 */
-        if (restconf_stream_data_new(rc, 0) == NULL)
-            goto done;
-        break;
-#endif /* HAVE_HTTP1 */
-#ifdef HAVE_LIBNGHTTP2
-    case HTTP_2:{
-        if (http2_session_init(rc) < 0){
-            restconf_close_ssl_socket(rc, __FUNCTION__, 0);
-            goto done;
-        }
-        if (http2_send_server_connection(rc) < 0){
-            restconf_close_ssl_socket(rc, __FUNCTION__, 0);
-            goto done;
-        }
-        break;
-    }
-#endif /* HAVE_LIBNGHTTP2 */
-    default:
-        break;
-    } /* switch proto */
-    gettimeofday(&rc->rc_t, NULL); /* activity timer */
-    if (clixon_event_reg_fd(rc->rc_s, restconf_connection, (void*)rc, "restconf client socket") < 0)
+    if ((retval = restconf_ssl_accept_done(h, rc, rcp)) < 0)
         goto done;
-    if (rcp)
-        *rcp = rc;
-    retval = 1; /* OK, up */
  done:
     clicon_debug(1, "%s retval %d", __FUNCTION__, retval);
-    if (name)
-        free(name);
     return retval;
  closed:
-    retval = 0; /* OK, closed */
+    retval = 0; /* OK, closed or handshake in progress */
     goto done;
 } /* restconf_ssl_accept_client */
 
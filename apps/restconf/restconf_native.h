@@ -64,10 +64,23 @@ extern "C" {
 #ifndef _RESTCONF_NATIVE_H_
 #define _RESTCONF_NATIVE_H_
 
+#ifdef WITH_ZSTD
+#include <zstd.h> /* reply-body content-encoding, see sd_zcctx */
+#endif
+
+/*
+ * Constants
+ */
+/* Compress reply bodies of at least this size (in bytes) when the client accepts
+ * zstd content-encoding, see restconf_compress_negotiate. Requires --enable-zstd.
+ * Streamed replies of unknown length are compressed regardless of this limit.
+ */
+#define RESTCONF_COMPRESS_MIN 1024
+
 /*
  * Types
  */
-    
+
 /* Forward */
 struct restconf_conn;
 
@@ -76,12 +89,18 @@ struct restconf_conn;
 typedef struct  {
     qelem_t               sd_qelem;     /* List header */
     int32_t               sd_stream_id;
-    int                   sd_fd;        /* XXX Is this used? */
+    int                   sd_fd;        /* File-backed body: open fd or -1, owned by stream.
+                                           Readers use offset-explicit i/o (pread/sendfile) since
+                                           the fd may be dup:ed from the http-data file cache,
+                                           see restconf_reply_send_file */
     cvec                 *sd_outp_hdrs; /* List of output headers */
     cbuf                 *sd_outp_buf;  /* Output buffer */
     cbuf                 *sd_body;      /* http output body as cbuf terminated with \r\n */
     size_t                sd_body_len;  /* Content-Length, note for HEAD body body can be NULL and this non-zero */
     size_t                sd_body_offset; /* Offset into body */
+    cxobj                *sd_xtree;     /* Streamed reply: XML tree serialized incrementally (owned) */
+    clixon_xml_cursor    *sd_xcursor;   /* Streamed reply: serializer cursor into sd_xtree,
+                                           sd_body is used as (refilled) staging buffer */
     cbuf                 *sd_inbuf;     /* Receive/input buf (whole message) */
     cbuf                 *sd_indata;    /* Receive/input data body */
     char                 *sd_path;      /* Uri path, uri-encoded, without args (eg ?) */
@@ -92,6 +111,15 @@ typedef struct  {
     void                 *sd_req;       /* Lib-specific request */
     int                   sd_upgrade2;  /* Upgrade to http/2 */
     uint8_t              *sd_settings2; /* Settings for upgrade to http/2 request */
+    int                   sd_continue100; /* http/1: 100 Continue sent for current message */
+    int                   sd_defer;     /* http/1: reply deferred, a pooled backend rpc is in
+                                         * flight, see restconf_reply_defer */
+#ifdef WITH_ZSTD
+    ZSTD_CCtx            *sd_zcctx;     /* Streamed reply zstd content-encoding context,
+                                           see restconf_sd_read. NULL if identity */
+    cbuf                 *sd_zplain;    /* Streamed reply compression: plaintext staging
+                                           buffer, sd_body holds the compressed output */
+#endif
 } restconf_stream_data;
 
 typedef struct restconf_socket restconf_socket;
@@ -109,6 +137,8 @@ typedef struct restconf_conn {
     int                   rc_proto_d1;  /* parsed version digit 1 */
     int                   rc_proto_d2;  /* parsed version digit 2 */
     int                   rc_s;         /* Connection socket */
+    cbuf                 *rc_inbuf;     /* Persistent http/1 input buffer: may hold a partial
+                                           message and/or several pipelined messages */
     clicon_handle         rc_h;         /* Clixon handle */
     SSL                  *rc_ssl;       /* Structure for SSL connection */
     restconf_stream_data *rc_streams; /* List of http/2 session streams */
@@ -175,12 +205,14 @@ restconf_stream_data *restconf_stream_data_new(restconf_conn *rc, int32_t stream
 restconf_stream_data *restconf_stream_find(restconf_conn *rc, int32_t id);
 int               restconf_stream_free(restconf_stream_data *sd);
 restconf_conn    *restconf_conn_new(clicon_handle h, int s, restconf_socket *socket);
+int               restconf_compress_negotiate(restconf_stream_data *sd);
 int               ssl_x509_name_oneline(SSL *ssl, char **oneline);
 
 int               restconf_close_ssl_socket(restconf_conn *rc, const char *callfn, int sslerr0);
 int               restconf_connection_sanity(clicon_handle h, restconf_conn *rc, restconf_stream_data *sd);
 restconf_native_handle *restconf_native_handle_get(clicon_handle h);
 int               restconf_connection(int s, void *arg);
+int               restconf_native_deferred_done(restconf_stream_data *sd);
 int               restconf_ssl_accept_client(clicon_handle h, int s, restconf_socket *rsock, restconf_conn  **rcp);
 int               restconf_idle_timer_unreg(restconf_conn *rc);
 int               restconf_idle_timer(restconf_conn *rc);
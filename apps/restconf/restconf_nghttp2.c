@@ -88,6 +88,7 @@
 #ifdef HAVE_LIBNGHTTP2          /* Ends at end-of-file */
 #include "restconf_nghttp2.h"   /* Restconf-openssl mode specific headers*/
 #include "clixon_http_data.h"
+#include "restconf_metrics.h"
 
 #define ARRLEN(x) (sizeof(x) / sizeof(x[0]))
 
@@ -148,25 +149,21 @@ nghttp2_print_headers(nghttp2_nv *nva,
 }
 #endif /* NOTUSED */
 
-/*! Send data to remote peer, Send at most the |length| bytes of |data|.
- * This callback is required if the application uses
- * `nghttp2_session_send()` to send data to the remote endpoint.  If
- * the application uses solely `nghttp2_session_mem_send()` instead,
- * this callback function is unnecessary.
- * It must return the number of bytes sent if it succeeds.  
- * If it cannot send any single byte without blocking,
- * it must return :enum:`NGHTTP2_ERR_WOULDBLOCK`.  
- * For other errors, it must return :enum:`NGHTTP2_ERR_CALLBACK_FAILURE`.
+/*! Send data to remote peer, send all of the |buflen| bytes of |buf|
+ *
+ * Writes the whole buffer (retrying EAGAIN), used by http2_session_send_all
+ * which gathers all pending frames into one buffer so a response goes out in
+ * a single write instead of one write per frame.
+ * Return semantics follow the nghttp2 send callback this once was:
+ * the number of bytes sent on success, :enum:`NGHTTP2_ERR_CALLBACK_FAILURE`
+ * on error (connection close gives 0 with no clicon_err).
  */
 static ssize_t
-session_send_callback(nghttp2_session *session,
-                      const uint8_t   *buf,
-                      size_t           buflen,
-                      int              flags,
-                      void            *user_data)
+http2_conn_write(restconf_conn *rc,
+                 const uint8_t *buf,
+                 size_t         buflen)
 {
     int            retval = NGHTTP2_ERR_CALLBACK_FAILURE;
-    restconf_conn *rc = (restconf_conn *)user_data;
     int            er;
     ssize_t        len;
     ssize_t        totlen = 0;
@@ -251,7 +248,51 @@ session_send_callback(nghttp2_session *session,
     return retval == 0 ? totlen : retval;
 }
 
-/*! Invoked when |session| wants to receive data from the remote peer.  
+/*! Send all pending nghttp2 frames in one gathered write
+ *
+ * Replaces nghttp2_session_send, which invokes the send callback once per
+ * frame and so cost several small write syscalls per response (SETTINGS,
+ * HEADERS, DATA, ...). All pending frames are drained from the session with
+ * nghttp2_session_mem_send into one buffer and written with a single call.
+ * @param[in]  rc  Restconf connection
+ * @retval     0   OK
+ * @retval    <0   nghttp2-style error; clicon_err is set for real errors but
+ *                 not for peer close, as nghttp2_session_send did
+ */
+static int
+http2_session_send_all(restconf_conn *rc)
+{
+    int            retval = NGHTTP2_ERR_CALLBACK_FAILURE;
+    cbuf          *cb = NULL;
+    const uint8_t *data = NULL;
+    ssize_t        n;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    while ((n = nghttp2_session_mem_send(rc->rc_ngsession, &data)) > 0){
+        if (cbuf_append_buf(cb, (void*)data, n) < 0){
+            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+    }
+    if (n < 0){
+        retval = (int)n;
+        clicon_err(OE_NGHTTP2, (int)n, "nghttp2_session_mem_send");
+        goto done;
+    }
+    if (cbuf_len(cb) > 0 &&
+        http2_conn_write(rc, (const uint8_t*)cbuf_get(cb), cbuf_len(cb)) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Invoked when |session| wants to receive data from the remote peer.
  */
 static ssize_t
 recv_callback(nghttp2_session *session,
@@ -285,8 +326,10 @@ restconf_nghttp2_path(restconf_stream_data *sd)
     char          *oneline = NULL;
     cvec          *cvv = NULL;
     char          *cn;
-    
+    struct timeval t0;
+
     clicon_debug(1, "------------");
+    gettimeofday(&t0, NULL);
     rc = sd->sd_conn;
     if ((h = rc->rc_h) == NULL){
         clicon_err(OE_RESTCONF, EINVAL, "arg is NULL");
@@ -314,24 +357,35 @@ restconf_nghttp2_path(restconf_stream_data *sd)
         /* Matching algorithm:
          * 1. try well-known
          * 2. try /restconf
-         * 3. try /data
-         * 4. call restconf anyway (because it handles errors)
+         * 3. try /metrics
+         * 4. try /data
+         * 5. call restconf anyway (because it handles errors)
          * This is for the situation where data is / and /restconf is more specific
          */
         if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0){
             if (api_well_known(h, sd) < 0)
                 goto done;
         }
+        else if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN_LIVE) == 0){
+            if (api_well_known_live(h, sd) < 0)
+                goto done;
+        }
         else if (api_path_is_restconf(h)){
             if (api_root_restconf(h, sd, sd->sd_qvec) < 0)
-                goto done;          
+                goto done;
+        }
+        else if (api_path_is_metrics(h)){
+            if (api_metrics(h, sd) < 0)
+                goto done;
         }
         else if (api_path_is_data(h)){
             if (api_http_data(h, sd, sd->sd_qvec) < 0)
                 goto done;
         }
         else if (api_root_restconf(h, sd, sd->sd_qvec) < 0) /* error handling */
-            goto done;      
+            goto done;
+        if (restconf_metrics_req(h, &t0) < 0)
+            goto done;
     }
     /* Clear (fcgi) paramaters from this request */
     if (restconf_param_del_all(h) < 0)
@@ -362,7 +416,113 @@ restconf_sd_read(nghttp2_session     *session,
     cbuf                 *cb;
     size_t                len = 0;
     size_t                remain;
+    int                   eof = 0;
+    ssize_t               nread;
 
+    if (sd->sd_fd != -1){
+        /* File-backed body: read straight into the frame buffer, no staging cbuf.
+         * Offset-explicit pread since the fd may be dup:ed from the http-data
+         * file cache where dup:ed descriptors share one file offset.
+         */
+        remain = sd->sd_body_len - sd->sd_body_offset;
+        len = remain <= length ? remain : length;
+        if ((nread = pread(sd->sd_fd, buf, len, sd->sd_body_offset)) < 0){
+            clicon_err(OE_UNIX, errno, "pread");
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        sd->sd_body_offset += nread;
+        if ((size_t)nread < len || /* file truncated under us, cut the body short */
+            sd->sd_body_offset >= sd->sd_body_len){
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+            close(sd->sd_fd);
+            sd->sd_fd = -1;
+        }
+        clicon_debug(1, "%s file retval:%zd", __FUNCTION__, nread);
+        return nread;
+    }
+    if (sd->sd_xcursor != NULL){
+        /* Streamed reply: refill staging cbuf from the serializer cursor when drained.
+         * Called by nghttp2 as stream flow control admits, so in-flight memory is
+         * bounded by the chunk size, not the body size.
+         */
+        if (sd->sd_body == NULL &&
+            (sd->sd_body = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        cb = sd->sd_body;
+        if (sd->sd_body_offset >= cbuf_len(cb)){
+            cbuf_reset(cb);
+            sd->sd_body_offset = 0;
+#ifdef WITH_ZSTD
+            if (sd->sd_zcctx != NULL){
+                /* Zstd content-encoded: compress serializer chunks into the staging
+                 * cbuf. Loop since a plaintext chunk can compress to zero bytes;
+                 * when the cursor ends the frame is flushed to completion so the
+                 * buffered tail below can finish the stream.
+                 */
+                if (sd->sd_zplain == NULL &&
+                    (sd->sd_zplain = cbuf_new()) == NULL){
+                    clicon_err(OE_UNIX, errno, "cbuf_new");
+                    return NGHTTP2_ERR_CALLBACK_FAILURE;
+                }
+                while (cbuf_len(cb) == 0 && sd->sd_zcctx != NULL){
+                    ZSTD_inBuffer     zin = {NULL, 0, 0};
+                    ZSTD_EndDirective zmode = ZSTD_e_continue;
+                    size_t            zret;
+                    char              zbuf[BUFSIZ];
+
+                    cbuf_reset(sd->sd_zplain);
+                    eof = 0;
+                    if (clixon_xml_cursor_chunk(sd->sd_xcursor, sd->sd_zplain, length, &eof) < 0)
+                        return NGHTTP2_ERR_CALLBACK_FAILURE;
+                    if (eof){
+                        clixon_xml_cursor_free(sd->sd_xcursor);
+                        sd->sd_xcursor = NULL;
+                        zmode = ZSTD_e_end;
+                    }
+                    zin.src = cbuf_get(sd->sd_zplain);
+                    zin.size = cbuf_len(sd->sd_zplain);
+                    do {
+                        ZSTD_outBuffer zout = {zbuf, sizeof(zbuf), 0};
+                        zret = ZSTD_compressStream2(sd->sd_zcctx, &zout, &zin, zmode);
+                        if (ZSTD_isError(zret)){
+                            clicon_err(OE_RESTCONF, 0, "ZSTD_compressStream2: %s",
+                                       ZSTD_getErrorName(zret));
+                            return NGHTTP2_ERR_CALLBACK_FAILURE;
+                        }
+                        if (zout.pos &&
+                            cbuf_append_buf(cb, zbuf, zout.pos) < 0){
+                            clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                            return NGHTTP2_ERR_CALLBACK_FAILURE;
+                        }
+                    } while (zin.pos < zin.size || (zmode == ZSTD_e_end && zret != 0));
+                    if (zmode == ZSTD_e_end){ /* frame complete */
+                        ZSTD_freeCCtx(sd->sd_zcctx);
+                        sd->sd_zcctx = NULL;
+                    }
+                }
+            }
+            else
+#endif /* WITH_ZSTD */
+            {
+                if (clixon_xml_cursor_chunk(sd->sd_xcursor, cb, length, &eof) < 0)
+                    return NGHTTP2_ERR_CALLBACK_FAILURE;
+                if (eof){
+                    clixon_xml_cursor_free(sd->sd_xcursor);
+                    sd->sd_xcursor = NULL;
+                }
+            }
+        }
+        remain = cbuf_len(cb) - sd->sd_body_offset;
+        len = remain <= length ? remain : length;
+        if (remain <= length && sd->sd_xcursor == NULL)
+            *data_flags |= NGHTTP2_DATA_FLAG_EOF;
+        memcpy(buf, cbuf_get(cb) + sd->sd_body_offset, len);
+        sd->sd_body_offset += len;
+        clicon_debug(1, "%s streamed retval:%zu", __FUNCTION__, len);
+        return len;
+    }
     if ((cb = sd->sd_body) == NULL){ /* shouldnt happen */
         *data_flags |= NGHTTP2_DATA_FLAG_EOF;
         return 0;
@@ -401,6 +561,40 @@ restconf_sd_read(nghttp2_session     *session,
     return len;
 }
 
+/* Response header nv entries up to this nr are built on the stack,
+ * avoiding a per-response calloc, see restconf_submit_response */
+#define SUBMIT_NV_PREALLOC 32
+
+/*! Precomputed :status value strings for codes this server sends
+ * @param[in]  code  HTTP status code
+ * @retval     str   Static value string
+ * @retval     NULL  Uncommon code, caller formats it
+ */
+static const char *
+http2_status_value(uint16_t code)
+{
+    switch (code){
+    case 100: return "100";
+    case 200: return "200";
+    case 201: return "201";
+    case 204: return "204";
+    case 304: return "304";
+    case 400: return "400";
+    case 401: return "401";
+    case 403: return "403";
+    case 404: return "404";
+    case 405: return "405";
+    case 406: return "406";
+    case 409: return "409";
+    case 412: return "412";
+    case 415: return "415";
+    case 500: return "500";
+    case 501: return "501";
+    case 503: return "503";
+    default:  return NULL;
+    }
+}
+
 static int
 restconf_submit_response(nghttp2_session      *session,
                          restconf_conn        *rc,
@@ -411,34 +605,46 @@ restconf_submit_response(nghttp2_session      *session,
     nghttp2_data_provider data_prd;
     nghttp2_error         ngerr;
     cg_var               *cv;
-    nghttp2_nv           *hdrs = NULL;
+    nghttp2_nv            hdrs0[SUBMIT_NV_PREALLOC];
+    nghttp2_nv           *hdrs = hdrs0;
     nghttp2_nv           *hdr;
     int                   i = 0;
+    int                   nr;
+    char                 *name;
+    char                 *value;
+    const char           *status;
     char                  valstr[16];
 
     data_prd.source.ptr = sd;
     data_prd.read_callback = restconf_sd_read;
-    if ((hdrs = (nghttp2_nv*)calloc(1+cvec_len(sd->sd_outp_hdrs), sizeof(nghttp2_nv))) == NULL){
+    nr = 1 + cvec_len(sd->sd_outp_hdrs);
+    if (nr > SUBMIT_NV_PREALLOC &&
+        (hdrs = (nghttp2_nv*)calloc(nr, sizeof(nghttp2_nv))) == NULL){
         clicon_err(OE_UNIX, errno, "calloc");
         goto done;
     }
     hdr = &hdrs[i++];
     hdr->name = (uint8_t*)":status";
-    snprintf(valstr, 15, "%u", sd->sd_code);
-    clicon_debug(1, "%s status %d", __FUNCTION__, sd->sd_code);
-    hdr->value = (uint8_t*)valstr;
     hdr->namelen = strlen(":status");
-    hdr->valuelen = strlen(valstr);
+    if ((status = http2_status_value(sd->sd_code)) == NULL){
+        snprintf(valstr, 15, "%u", sd->sd_code);
+        status = valstr;
+    }
+    clicon_debug(1, "%s status %d", __FUNCTION__, sd->sd_code);
+    hdr->value = (uint8_t*)status;
+    hdr->valuelen = strlen(status);
     hdr->flags = 0;
 
     cv = NULL;
     while ((cv = cvec_each(sd->sd_outp_hdrs, cv)) != NULL){
+        name = cv_name_get(cv);
+        value = cv_string_get(cv);
         hdr = &hdrs[i++];
-        hdr->name = (uint8_t*)cv_name_get(cv);
-        clicon_debug(1, "%s hdr: %s", __FUNCTION__, hdr->name);
-        hdr->value = (uint8_t*)cv_string_get(cv);
-        hdr->namelen = strlen(cv_name_get(cv));
-        hdr->valuelen = strlen(cv_string_get(cv));
+        clicon_debug(1, "%s hdr: %s", __FUNCTION__, name);
+        hdr->name = (uint8_t*)name;
+        hdr->namelen = strlen(name);
+        hdr->value = (uint8_t*)value;
+        hdr->valuelen = strlen(value);
         hdr->flags = 0;
     }
     if ((ngerr = nghttp2_submit_response(session,
@@ -451,7 +657,7 @@ restconf_submit_response(nghttp2_session      *session,
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
-    if (hdrs)
+    if (hdrs != hdrs0)
         free(hdrs);
     return retval;
 }
@@ -475,6 +681,7 @@ http2_exec(restconf_conn        *rc,
         goto done;
     sd->sd_proto = HTTP_2; /* XXX is this necessary? */
     if (strcmp(sd->sd_path, RESTCONF_WELL_KNOWN) == 0
+        || strcmp(sd->sd_path, RESTCONF_WELL_KNOWN_LIVE) == 0
         || api_path_is_restconf(rc->rc_h)
         || api_path_is_data(rc->rc_h)){
         if (restconf_nghttp2_path(sd) < 0)
@@ -914,13 +1121,11 @@ http2_recv(restconf_conn       *rc,
         clicon_err(OE_NGHTTP2, ngerr, "nghttp2_session_mem_recv");
         goto done;
     }
-    /* sends highest prio frame from outbound queue to remote peer.  It does this as
-     * many as possible until user callback :type:`nghttp2_send_callback` returns
-     * :enum:`NGHTTP2_ERR_WOULDBLOCK` or the outbound queue becomes empty.
-     * @see session_send_callback()
+    /* Drains the outbound queue to the remote peer as one gathered write
+     * @see http2_session_send_all()
      */
     clicon_err_reset();
-    if ((ngerr = nghttp2_session_send(rc->rc_ngsession)) != 0){
+    if ((ngerr = http2_session_send_all(rc)) != 0){
         if (clicon_errno) 
             goto done;
         else
@@ -953,8 +1158,9 @@ http2_send_server_connection(restconf_conn *rc)
         clicon_err(OE_NGHTTP2, ngerr, "nghttp2_submit_settings");
         goto done;
     }
-    if ((ngerr = nghttp2_session_send(rc->rc_ngsession)) != 0){
-        clicon_err(OE_NGHTTP2, ngerr, "nghttp2_session_send");
+    if ((ngerr = http2_session_send_all(rc)) != 0){
+        if (clicon_errno == 0)
+            clicon_err(OE_NGHTTP2, ngerr, "http2_session_send_all");
         goto done;
     }
     retval = 0;
@@ -974,7 +1180,7 @@ http2_session_init(restconf_conn *rc)
     nghttp2_error              ngerr;
 
     nghttp2_session_callbacks_new(&callbacks);
-    nghttp2_session_callbacks_set_send_callback(callbacks, session_send_callback);
+    /* No send callback: all output goes through http2_session_send_all() */
     nghttp2_session_callbacks_set_recv_callback(callbacks, recv_callback);
     nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, on_frame_recv_callback);
     nghttp2_session_callbacks_set_on_invalid_frame_recv_callback(callbacks, on_invalid_frame_recv_callback);
@@ -149,6 +149,45 @@ api_well_known(clicon_handle h,
     return retval;
 }
 
+/*! Ultra-cheap liveness route for load balancers and keepalive probes
+ *
+ * Answers 200 if the backend is reachable and 503 otherwise, probing it with
+ * a header-only ping over the IPC socket so neither the probe nor the backend
+ * pays any XML parse/serialize, see clicon_rpc_ping().
+ * @param[in]  h        Clicon handle
+ * @param[in]  req      Generic Www handle (can be part of clixon handle)
+ */
+int
+api_well_known_live(clicon_handle h,
+                    void         *req)
+{
+    int   retval = -1;
+    char *request_method;
+    int   ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (req == NULL){
+        errno = EINVAL;
+        goto done;
+    }
+    request_method = restconf_param_get(h, "REQUEST_METHOD");
+    if (strcmp(request_method, "HEAD") != 0 && strcmp(request_method, "GET") != 0){
+        if (restconf_method_notallowed(h, req, "GET,HEAD", restconf_pretty_get(h), YANG_DATA_JSON) < 0)
+            goto done;
+        goto ok;
+    }
+    if ((ret = clicon_rpc_ping(h)) < 0)
+        goto done;
+    if (restconf_reply_header(req, "Cache-Control", "no-cache") < 0)
+        goto done;
+    if (restconf_reply_send(req, ret == 1 ? 200 : 503, NULL, 0) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Retrieve the Top-Level API Resource /restconf/ (exact)
  * @param[in]  h         Clicon handle
  * @param[in]  req       Generic request handle
@@ -465,12 +504,16 @@ api_root_restconf(clicon_handle        h,
     char          *username = NULL;
     int            ret;
     cxobj         *xerr = NULL;
+    struct timespec tspan;
 
     clicon_debug(1, "%s", __FUNCTION__);
     if (req == NULL){
         errno = EINVAL;
         goto done;
     }
+    /* Sampling decision for end-to-end tracing, see CLICON_TRACE_SAMPLING */
+    clixon_trace_start(h, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &tspan);
     request_method = restconf_param_get(h, "REQUEST_METHOD");
     if ((path = restconf_uripath(h)) == NULL)
         goto done;
@@ -612,6 +655,8 @@ api_root_restconf(clicon_handle        h,
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    clixon_trace_span(h, "restconf.request", &tspan);
+    clixon_trace_stop(h);
 #ifdef WITH_RESTCONF_FCGI
     if (cb)
         cbuf_free(cb);
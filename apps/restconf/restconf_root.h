@@ -49,11 +49,16 @@
 */
 #define RESTCONF_WELL_KNOWN  "/.well-known/host-meta"
 
+/* Liveness route answered without any XML processing, backed by a header-only
+   ping to the backend, see api_well_known_live() */
+#define RESTCONF_WELL_KNOWN_LIVE  "/.well-known/live"
+
 /*
  * Prototypes
  */
 int api_path_is_restconf(clicon_handle h);
 int api_well_known(clicon_handle h, void *req);
+int api_well_known_live(clicon_handle h, void *req);
 int api_root_restconf(clicon_handle h, void *req, cvec *qvec);
 
 #endif /* _RESTCONF_ROOT_H_ */
@@ -105,6 +105,12 @@
  */
 #define STREAM_FORK
 
+/* Max events coalesced into one write+flush per event-loop iteration. Events
+ * already queued on the backend socket are batched up to this bound; a lone
+ * event is still flushed immediately.
+ */
+#define STREAM_COALESCE_MAX 64
+
 /* Keep track of children - when they exit - their FCGX handle needs to be 
  * freed with  FCGX_Free(&rbk, 0);
  */
@@ -192,13 +198,37 @@ stream_child_freeall(clicon_handle h)
     return 0;
 }
 
+/*! Check if more data is queued on the backend notification socket
+ *
+ * @param[in]  s   Socket
+ * @retval     1   More data pending, a recv will not block
+ * @retval     0   No data pending
+ * @retval    -1   Error
+ */
+static int
+stream_sock_pending(int s)
+{
+    fd_set         fdset;
+    struct timeval tnull = {0, 0};
+
+    FD_ZERO(&fdset);
+    FD_SET(s, &fdset);
+    return select(s+1, &fdset, NULL, NULL, &tnull);
+}
+
 /*! Callback when stream notifications arrive from backend
+ *
+ * Events already queued on the backend socket are coalesced into a single
+ * buffered write and one flush, instead of one write+flush syscall pair per
+ * notification. Only what has already arrived is batched (bounded by
+ * STREAM_COALESCE_MAX), so no added latency: the first event in a quiet period
+ * is flushed immediately.
  * @param[in]  s    Socket
  * @param[in]  req  Generic Www handle (can be part of clixon handle)
  * @see netconf_notification_cb
  */
 static int
-restconf_stream_cb(int   s, 
+restconf_stream_cb(int   s,
                    void *arg)
 {
     int                retval = -1;
@@ -210,59 +240,64 @@ restconf_stream_cb(int   s,
     cbuf              *cb = NULL;
     int                pretty = 0; /* XXX should be via arg */
     int                ret;
-    
+    int                nev = 0;
+
     clicon_debug(1, "%s", __FUNCTION__);
-    /* get msg (this is the reason this function is called) */
-    if (clicon_msg_rcv(s, &reply, &eof) < 0){
-        clicon_debug(1, "%s msg_rcv error", __FUNCTION__);
-        goto done;
-    }
-    clicon_debug(1, "%s msg: %s", __FUNCTION__, reply?reply->op_body:"null");
-    /* handle close from remote end: this will exit the client */
-    if (eof){
-        clicon_debug(1, "%s eof", __FUNCTION__);
-        clicon_err(OE_PROTO, ESHUTDOWN, "Socket unexpected close");
-        errno = ESHUTDOWN;
-        FCGX_FPrintF(r->out, "SHUTDOWN\r\n");
-        FCGX_FPrintF(r->out, "\r\n");
-        FCGX_FFlush(r->out);
-        clixon_exit_set(1); 
-        goto done;
-    }
-    if ((ret = clicon_msg_decode(reply, NULL, NULL, &xtop, NULL)) < 0)  /* XXX pass yang_spec */
-        goto done;
-    if (ret == 0){
-        clicon_err(OE_XML, EFAULT, "Invalid notification");
-        goto done;
-    }
-    /* create event */
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_PLUGIN, errno, "cbuf_new");
         goto done;
     }
-    if ((xn = xpath_first(xtop, NULL, "notification")) == NULL)
-        goto ok;
-#ifdef notused
-    xt = xpath_first(xn, NULL, "eventTime");
-    if ((xe = xpath_first(xn, NULL, "event")) == NULL) /* event can depend on yang? */
-        goto ok;
-
-    if (xt)
-        FCGX_FPrintF(r->out, "M#id: %s\r\n", xml_body(xt));
-    else{ /* XXX */
-        gettimeofday(&tv, NULL);
-        FCGX_FPrintF(r->out, "M#id: %02d:0\r\n", tv.tv_sec);
+    while (1){
+        /* get msg (this is the reason this function is called) */
+        if (clicon_msg_rcv(s, &reply, &eof) < 0){
+            clicon_debug(1, "%s msg_rcv error", __FUNCTION__);
+            goto done;
+        }
+        clicon_debug(1, "%s msg: %s", __FUNCTION__, reply?reply->op_body:"null");
+        /* handle close from remote end: this will exit the client */
+        if (eof){
+            clicon_debug(1, "%s eof", __FUNCTION__);
+            clicon_err(OE_PROTO, ESHUTDOWN, "Socket unexpected close");
+            errno = ESHUTDOWN;
+            /* Deliver any events batched before the close */
+            if (cbuf_len(cb))
+                FCGX_PutStr(cbuf_get(cb), cbuf_len(cb), r->out);
+            FCGX_FPrintF(r->out, "SHUTDOWN\r\n");
+            FCGX_FPrintF(r->out, "\r\n");
+            FCGX_FFlush(r->out);
+            clixon_exit_set(1);
+            goto done;
+        }
+        if ((ret = clicon_msg_decode(reply, NULL, NULL, &xtop, NULL)) < 0)  /* XXX pass yang_spec */
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_XML, EFAULT, "Invalid notification");
+            goto done;
+        }
+        if ((xn = xpath_first(xtop, NULL, "notification")) != NULL){
+            cprintf(cb, "data: ");
+            if (clixon_xml2cbuf(cb, xn, 0, pretty, -1, 0) < 0)
+                goto done;
+            cprintf(cb, "\r\n\r\n");
+            nev++;
+        }
+        xml_free(xtop);
+        xtop = NULL;
+        free(reply);
+        reply = NULL;
+        if (nev >= STREAM_COALESCE_MAX)
+            break;
+        /* Batch only events already queued on the socket */
+        if (stream_sock_pending(s) <= 0)
+            break;
+    }
+    if (cbuf_len(cb)){
+        FCGX_PutStr(cbuf_get(cb), cbuf_len(cb), r->out);
+        FCGX_FFlush(r->out);
     }
-#endif
-    if (clixon_xml2cbuf(cb, xn, 0, pretty, -1, 0) < 0)
-        goto done;
-    FCGX_FPrintF(r->out, "data: %s\r\n", cbuf_get(cb));
-    FCGX_FPrintF(r->out, "\r\n");
-    FCGX_FFlush(r->out);
- ok:
     retval = 0;
  done:
-    clicon_debug(1, "%s retval: %d", __FUNCTION__, retval);
+    clicon_debug(1, "%s retval: %d nev: %d", __FUNCTION__, retval, nev);
     if (xtop != NULL)
         xml_free(xtop);
     if (reply)
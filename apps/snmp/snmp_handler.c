@@ -43,6 +43,7 @@
 #include <syslog.h>
 #include <errno.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <signal.h>
 
 /* net-snmp */
@@ -215,8 +216,10 @@ snmp_scalar_return(cxobj                      *xs,
  * @param[in]  ys         Yang node
  * @param[in]  cvk        Vector of index/Key variables, if any
  * @param[in]  defaultval Default value
+ * @param[in]  xrow       Row of table snapshot to read value from, or NULL for backend call
  * @param[in]  reqinfo    Agent transaction request structure
  * @param[in]  request   The netsnmp request info structure.
+ * @param[out] foundp     If set, report no-value as *foundp=0 instead of NOSUCHINSTANCE
  * @retval     0          OK
  * @retval     -1         Error
  */
@@ -225,8 +228,10 @@ snmp_scalar_get(clicon_handle               h,
                 yang_stmt                  *ys,
                 cvec                       *cvk,
                 char                       *defaultval,
+                cxobj                      *xrow,
                 netsnmp_agent_request_info *reqinfo,
-                netsnmp_request_info       *request)
+                netsnmp_request_info       *request,
+                int                        *foundp)
 {
     int     retval = -1;
     cvec   *nsc = NULL;
@@ -245,6 +250,8 @@ snmp_scalar_get(clicon_handle               h,
     char   *body = NULL;
 
     clicon_debug(1, "%s", __FUNCTION__);
+    if (foundp != NULL)
+        *foundp = 1;
     /* Prepare backend call by constructing namespace context */
     if (xml_nsctx_yang(ys, &nsc) < 0)
         goto done;
@@ -256,15 +263,21 @@ snmp_scalar_get(clicon_handle               h,
     /* First try cache */
     clicon_ptr_get(h, "snmp-rowstatus-tree", (void**)&xcache);
     if (xcache==NULL || (x = xpath_first(xcache, nsc, "%s", xpath)) == NULL){
-        /* If not found do the backend call */
-        if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
-            goto done;
-        /* Detect error XXX Error handling could improve */
-        if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
-            clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
-            goto done;
+        if (xrow != NULL){
+            /* Read from table snapshot row, no backend call */
+            x = xml_find_type(xrow, NULL, yang_argument_get(ys), CX_ELMNT);
+        }
+        else{
+            /* If not found do the backend call */
+            if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
+                goto done;
+            /* Detect error XXX Error handling could improve */
+            if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+                clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
+                goto done;
+            }
+            x = xpath_first(xt, nsc, "%s", xpath);
         }
-        x = xpath_first(xt, nsc, "%s", xpath);
     }
     /* 
      * The xml to snmp value conversion is done in two steps:
@@ -289,6 +302,11 @@ snmp_scalar_get(clicon_handle               h,
         }
     }
     else{
+        if (foundp != NULL){
+            /* Caller (eg getnext dispatch) handles absent values itself */
+            *foundp = 0;
+            goto ok;
+        }
         if ((ret = netsnmp_request_set_error(request, SNMP_NOSUCHINSTANCE)) != SNMPERR_SUCCESS){
             clicon_err(OE_SNMP, ret, "netsnmp_request_set_error");
             goto done;
@@ -725,7 +743,7 @@ clixon_snmp_scalar_handler1(netsnmp_mib_handler          *handler,
     switch (reqinfo->mode) {
     case MODE_GET:          /* 160 */
         if (snmp_scalar_get(sh->sh_h, sh->sh_ys, sh->sh_cvk_orig,
-                            sh->sh_default, reqinfo, request) < 0)
+                            sh->sh_default, NULL, reqinfo, request, NULL) < 0)
             goto done;
         break;
     case MODE_GETNEXT:      /* 161 */
@@ -823,13 +841,386 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
     return retval;
 }
 
-/*! Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
+/*! Binary search the scalar map of a batched subtree registration for a leaf oid
+ * @param[in]  sh       Clixon snmp handle of subtree with built scalar map
+ * @param[in]  oids     Leaf oid (without the trailing .0 instance sub-identifier)
+ * @param[in]  oidslen  Length of oids
+ * @retval     ss       Matching scalar map entry
+ * @retval     NULL     Not found
+ * @see mibyang_scalars_register where the map is built
+ */
+static struct clixon_snmp_scalar *
+snmp_subtree_scalar_find(clixon_snmp_handle *sh,
+                         oid                *oids,
+                         size_t              oidslen)
+{
+    int low = 0;
+    int high = sh->sh_nscalars;
+    int mid;
+    int cmp;
+
+    while (low < high){
+        mid = (low + high) / 2;
+        cmp = oid_eq(sh->sh_scalars[mid].ss_oid, sh->sh_scalars[mid].ss_oidlen,
+                     oids, oidslen);
+        if (cmp == 0)
+            return &sh->sh_scalars[mid];
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+
+/*! Find first entry of the scalar map whose instance oid is larger than a target
+ * @param[in]  sh       Clixon snmp handle of subtree with built scalar map
+ * @param[in]  oids     Target oid, eg of a getnext request
+ * @param[in]  oidslen  Length of oids
+ * @retval     i        Index into sh_scalars, sh_nscalars if no larger entry
+ */
+static int
+snmp_subtree_scalar_next(clixon_snmp_handle *sh,
+                         oid                *oids,
+                         size_t              oidslen)
+{
+    int    low = 0;
+    int    high = sh->sh_nscalars;
+    int    mid;
+    oid    oidi[MAX_OID_LEN] = {0,};
+    size_t oidilen;
+
+    while (low < high){
+        mid = (low + high) / 2;
+        memcpy(oidi, sh->sh_scalars[mid].ss_oid, sh->sh_scalars[mid].ss_oidlen*sizeof(oid));
+        oidilen = sh->sh_scalars[mid].ss_oidlen;
+        oidi[oidilen++] = 0;
+        if (oid_eq(oidi, oidilen, oids, oidslen) > 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+/*! Single SNMP operation handler of a batched scalar subtree registration
+ *
+ * One registration covers all scalar leafs of a MIB container, see
+ * mibyang_scalars_register. The YANG leaf of a varbind is resolved with a binary
+ * search in the compiled scalar map, getnext walks the map in oid order.
+ * @param[in]  handler   Registered MIB handler structure
+ * @param[in]  nhreg     Root registration info.
+ * @param[in]  reqinfo   Agent transaction request structure
+ * @param[in]  request   The netsnmp request info structure.
+ * @retval     0         OK
+ * @retval    -1         Error
+ * @see clixon_snmp_scalar_handler1 for one-by-one instance registrations
+ */
+static int
+clixon_snmp_subtree_handler1(netsnmp_mib_handler          *handler,
+                             netsnmp_handler_registration *nhreg,
+                             netsnmp_agent_request_info   *reqinfo,
+                             netsnmp_request_info         *request)
+{
+    int                        retval = -1;
+    clixon_snmp_handle        *sh = NULL;
+    struct clixon_snmp_scalar *ss = NULL;
+    netsnmp_variable_list     *requestvb = request->requestvb;
+    oid                        oidi[MAX_OID_LEN] = {0,};
+    size_t                     oidilen;
+    int                        asn1_type;
+    int                        found;
+    int                        i;
+    int                        ret;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (snmp_common_handler(handler, nhreg, reqinfo, request, 0, &sh) < 0)
+        goto done;
+    /* Resolve YANG leaf of varbind: the instance oid is leaf oid + .0 */
+    if (reqinfo->mode != MODE_GETNEXT &&
+        requestvb->name_length >= 2 &&
+        requestvb->name[requestvb->name_length-1] == 0)
+        ss = snmp_subtree_scalar_find(sh, requestvb->name, requestvb->name_length-1);
+    /* see net-snmp/agent/snmp_agent.h / net-snmp/library/snmp.h */
+    switch (reqinfo->mode) {
+    case MODE_GET:          /* 160 */
+        if (ss == NULL){
+            if ((ret = netsnmp_request_set_error(request, SNMP_NOSUCHOBJECT)) != SNMPERR_SUCCESS){
+                clicon_err(OE_SNMP, ret, "netsnmp_request_set_error");
+                goto done;
+            }
+            break;
+        }
+        if (snmp_scalar_get(sh->sh_h, ss->ss_ys, NULL,
+                            ss->ss_default, NULL, reqinfo, request, NULL) < 0)
+            goto done;
+        break;
+    case MODE_GETNEXT:      /* 161 */
+        /* First scalar whose instance oid is larger than the request, then skip
+         * value-less leafs so the walk does not stall inside the subtree */
+        found = 0;
+        for (i = snmp_subtree_scalar_next(sh, requestvb->name, requestvb->name_length);
+             i < sh->sh_nscalars && !found;
+             i++){
+            ss = &sh->sh_scalars[i];
+            if (snmp_scalar_get(sh->sh_h, ss->ss_ys, NULL,
+                                ss->ss_default, NULL, reqinfo, request, &found) < 0)
+                goto done;
+            if (!found)
+                continue;
+            memcpy(oidi, ss->ss_oid, ss->ss_oidlen*sizeof(oid));
+            oidilen = ss->ss_oidlen;
+            oidi[oidilen++] = 0;
+            if ((ret = snmp_set_var_objid(requestvb, oidi, oidilen)) != SNMPERR_SUCCESS){
+                clicon_err(OE_SNMP, ret, "snmp_set_var_objid");
+                goto done;
+            }
+        }
+        if (!found){
+            /* Agent continues the walk in the next registration */
+            if ((ret = netsnmp_request_set_error(request, SNMP_ENDOFMIBVIEW)) != SNMPERR_SUCCESS){
+                clicon_err(OE_SNMP, ret, "netsnmp_request_set_error");
+                goto done;
+            }
+        }
+        break;
+    case MODE_SET_RESERVE1: /* 0 */
+        if (ss == NULL){
+            netsnmp_request_set_error(request, SNMP_ERR_NOCREATION);
+            goto done;
+        }
+        if (!yang_config_ancestor(ss->ss_ys) ||
+            ss->ss_modes == HANDLER_CAN_RONLY){
+            netsnmp_request_set_error(request, SNMP_ERR_NOTWRITABLE);
+            goto done;
+        }
+        /* Translate from YANG ys leaf type to SNMP asn1.1 type ids (not value), also cvtype */
+        if (type_yang2asn1(ss->ss_ys, &asn1_type, 0) < 0)
+            goto done;
+        if (requestvb->type != asn1_type){
+            clicon_debug(1, "%s Expected type:%d, got: %d", __FUNCTION__, requestvb->type, asn1_type);
+            if ((ret = netsnmp_request_set_error(request, SNMP_ERR_WRONGTYPE)) != SNMPERR_SUCCESS){
+                clicon_err(OE_SNMP, ret, "netsnmp_request_set_error");
+                goto ok;
+            }
+        }
+        break;
+    case MODE_SET_RESERVE2: /* 1 */
+        break;
+    case MODE_SET_ACTION:   /* 2 */
+        if (ss == NULL)
+            goto ok;
+        if (snmp_scalar_set(sh->sh_h, ss->ss_ys, NULL, NULL, reqinfo, request) < 0)
+            goto done;
+        /*
+         * There does not seem to be a separate validation action and commit does not
+         * return an error.
+         * Therefore validation is done here directly as well as discard if it fails.
+         */
+        if ((ret = clicon_rpc_validate(sh->sh_h, "candidate")) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_rpc_discard_changes(sh->sh_h);
+            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+            goto done;
+        }
+        break;
+    case MODE_SET_COMMIT:   /* 3 */
+        if ((ret = clicon_rpc_commit(sh->sh_h, 0, 0, 0, NULL, NULL)) < 0)
+            goto done;
+        if (ret == 0){
+            /* Note that error given in commit is not propagated to the snmp client,
+             * therefore validation is in the ACTION instead
+             */
+            clicon_rpc_discard_changes(sh->sh_h);
+            netsnmp_request_set_error(request, SNMP_ERR_COMMITFAILED);
+            goto done;
+        }
+        break;
+    case MODE_SET_FREE:     /* 4 */
+        break;
+    case MODE_SET_UNDO:     /* 5 */
+        if (clicon_rpc_discard_changes(sh->sh_h) < 0)
+            goto done;
+        break;
+    }
+ ok:
+    retval = SNMP_ERR_NOERROR;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    return retval;
+}
+
+/*! Top level subtree request handler, loop over individual requests
+ *
+ * @param[in]  handler      Registered MIB handler structure
+ * @param[in]  nhreg        Root registration info.
+ * @param[in]  reqinfo      Agent transaction request structure
+ * @param[in]  requests     The netsnmp request info structure.
+ * @see clixon_snmp_scalar_handler
+ */
+int
+clixon_snmp_subtree_handler(netsnmp_mib_handler          *handler,
+                            netsnmp_handler_registration *nhreg,
+                            netsnmp_agent_request_info   *reqinfo,
+                            netsnmp_request_info         *requests)
+{
+    int                   retval = -1;
+    netsnmp_request_info *req;
+    int                   ret;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    for (req = requests; req; req = req->next){
+        ret = clixon_snmp_subtree_handler1(handler, nhreg, reqinfo, req);
+        if (ret != SNMP_ERR_NOERROR){
+            retval = ret;
+            goto done;
+        }
+    }
+    retval = SNMP_ERR_NOERROR;
+ done:
+    return retval;
+}
+
+/*! Check if the table snapshot of a handle exists and its TTL has not expired
+ * @param[in]  sh  Clixon snmp handle of table
+ * @retval     1   Snapshot is fresh
+ * @retval     0   No snapshot, or expired
+ */
+static int
+snmp_table_cache_fresh(clixon_snmp_handle *sh)
+{
+    struct timeval now;
+    struct timeval ttl = {CLIXON_SNMP_CACHE_TIMEOUT, 0};
+    struct timeval expire;
+
+    if (sh->sh_cache_xml == NULL)
+        return 0;
+    gettimeofday(&now, NULL);
+    timeradd(&sh->sh_cache_time, &ttl, &expire);
+    return timercmp(&now, &expire, >) ? 0 : 1;
+}
+
+/*! Build sorted row index of a table snapshot
+ *
+ * Rows are kept in a clixon_xvec sorted by their encoded index oid (oid_eq order),
+ * with the encoded index itself in a parallel key array, so that row lookup can
+ * binary search instead of scanning all rows. Rows missing index leafs are skipped.
+ * Datastore lists are normally already in key order so the sorted insert is
+ * typically an append.
+ * @param[in]  sh      Clixon snmp handle of table, sh_cache_rows/keys are built
+ * @param[in]  xtable  Table node of snapshot
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see snmp_table_row_find
+ */
+static int
+snmp_table_index_build(clixon_snmp_handle *sh,
+                       cxobj              *xtable)
+{
+    int                        retval = -1;
+    cvec                      *cvk_name;
+    cxobj                     *xrow;
+    oid                        oidk[MAX_OID_LEN] = {0,};
+    size_t                     oidklen;
+    struct clixon_snmp_rowkey *keys = NULL;
+    struct clixon_snmp_rowkey *tmp;
+    int                        nr = 0;
+    int                        low;
+    int                        high;
+    int                        mid;
+    int                        ret;
+
+    if ((cvk_name = yang_cvec_get(sh->sh_ys)) == NULL){
+        clicon_err(OE_YANG, 0, "No keys");
+        goto done;
+    }
+    if ((sh->sh_cache_rows = clixon_xvec_new()) == NULL)
+        goto done;
+    xrow = NULL;
+    while ((xrow = xml_child_each(xtable, xrow, CX_ELMNT)) != NULL) {
+        oidklen = MAX_OID_LEN;
+        if ((ret = snmp_xmlkey2val_oid(xrow, cvk_name, NULL, oidk, &oidklen)) < 0)
+            goto done;
+        if (ret == 0)
+            continue; /* skip row, not all indexes */
+        /* Find insert position: first row with larger key */
+        low = 0;
+        high = nr;
+        while (low < high){
+            mid = (low + high) / 2;
+            if (oid_eq(keys[mid].rk_oid, keys[mid].rk_len, oidk, oidklen) > 0)
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        if ((tmp = realloc(keys, (nr+1)*sizeof(*keys))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        keys = tmp;
+        memmove(&keys[low+1], &keys[low], (nr-low)*sizeof(*keys));
+        if ((keys[low].rk_oid = malloc(oidklen*sizeof(oid))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memcpy(keys[low].rk_oid, oidk, oidklen*sizeof(oid));
+        keys[low].rk_len = oidklen;
+        nr++;
+        if (clixon_xvec_insert_pos(sh->sh_cache_rows, xrow, low) < 0)
+            goto done;
+    }
+    sh->sh_cache_keys = keys;
+    keys = NULL;
+    retval = 0;
+ done:
+    if (keys){
+        for (low=0; low<nr; low++)
+            free(keys[low].rk_oid);
+        free(keys);
+    }
+    return retval;
+}
+
+/*! Binary search the row of a table snapshot matching an encoded index oid exactly
+ * @param[in]  sh       Clixon snmp handle of table with built row index
+ * @param[in]  oidk     Encoded index (key) part of row oid
+ * @param[in]  oidklen  Length of oidk
+ * @retval     xrow     Matching row of snapshot
+ * @retval     NULL     Not found
+ * @see snmp_table_index_build
+ */
+static cxobj *
+snmp_table_row_find(clixon_snmp_handle *sh,
+                    oid                *oidk,
+                    size_t              oidklen)
+{
+    int low = 0;
+    int high = clixon_xvec_len(sh->sh_cache_rows);
+    int mid;
+    int cmp;
+
+    while (low < high){
+        mid = (low + high) / 2;
+        cmp = oid_eq(sh->sh_cache_keys[mid].rk_oid, sh->sh_cache_keys[mid].rk_len,
+                     oidk, oidklen);
+        if (cmp == 0)
+            return clixon_xvec_i(sh->sh_cache_rows, mid);
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+
+/*! Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name
  *
  * Get yang of leaf from first part of OID
  * Create xpath with right keys from later part of OID
  * Query clixon if object exists, if so return value
  * @param[in]  h        Clixon handle
- * @param[in]  yt       Yang of table (of list type)
+ * @param[in]  sh       Clixon snmp handle, sh_ys is yang of table (of list type)
  * @param[in]  oidt     OID of registered top container object (above list), may be different from yt
  * @param[in]  oidtlen  OID length of list object OID
  * @param[in]  oids     OID of ultimate scalar value
@@ -842,7 +1233,7 @@ clixon_snmp_scalar_handler(netsnmp_mib_handler          *handler,
  */
 static int
 snmp_table_get(clicon_handle               h,
-               yang_stmt                  *yt,
+               clixon_snmp_handle         *sh,
                oid                        *oidt,
                size_t                      oidtlen,
                oid                        *oids,
@@ -855,6 +1246,7 @@ snmp_table_get(clicon_handle               h,
     size_t     oidleaflen = MAX_OID_LEN;
     oid       *oidi;
     size_t     oidilen;
+    yang_stmt *yt = sh->sh_ys;
     yang_stmt *ys;
     yang_stmt *yk;
     char      *xpath = NULL;
@@ -863,23 +1255,28 @@ snmp_table_get(clicon_handle               h,
     int        i;
     cg_var    *cv;
     char      *defaultval = NULL;
+    cxobj     *xrow = NULL;
     int        ret;
 
-    /* Get yang of leaf from first part of OID */
-    ys = NULL;
-    while ((ys = yn_each(yt, ys)) != NULL) {
-        if (yang_keyword_get(ys) != Y_LEAF)
-            continue;
-        /* reset oid */
-        oidleaflen = MAX_OID_LEN;
-        if ((ret = yangext_oid_get(ys, oidleaf, &oidleaflen, NULL)) < 0)
-            goto done;
-        if (ret == 0)
-            continue;
-        if (oidtlen + 1 != oidleaflen) /* Indexes may be from other OID scope, skip those */
-            continue;
-        if (oids[oidleaflen-1] == oidleaf[oidleaflen-1])
-            break;
+    /* Get yang of leaf from first part of OID, use compiled column map if built */
+    if (sh->sh_cols != NULL && oidslen > oidtlen)
+        ys = snmp_table_col_find(sh, oids[oidtlen]);
+    else{
+        ys = NULL;
+        while ((ys = yn_each(yt, ys)) != NULL) {
+            if (yang_keyword_get(ys) != Y_LEAF)
+                continue;
+            /* reset oid */
+            oidleaflen = MAX_OID_LEN;
+            if ((ret = yangext_oid_get(ys, oidleaf, &oidleaflen, NULL)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+            if (oidtlen + 1 != oidleaflen) /* Indexes may be from other OID scope, skip those */
+                continue;
+            if (oids[oidleaflen-1] == oidleaf[oidleaflen-1])
+                break;
+        }
     }
     if (ys == NULL){
         /* No leaf with matching OID */
@@ -918,11 +1315,20 @@ snmp_table_get(clicon_handle               h,
         clicon_err(OE_YANG, 0, "Expected oidlen 0 but is %zu", oidilen);
         goto fail;
     }
+    /* Serve the value from a fresh table snapshot (populated by getnext walks) if one
+     * exists: binary search the row on the encoded index part of the OID instead of a
+     * backend round trip per varbind. The snapshot is not fetched here, a sparse get
+     * should not pull the whole table.
+     */
+    if (sh->sh_cache_rows != NULL && snmp_table_cache_fresh(sh))
+        xrow = snmp_table_row_find(sh, oids+oidtlen+1, oidslen-(oidtlen+1));
     /* Get scalar value */
     if (snmp_scalar_get(h, ys, cvk_val,
                         defaultval,
+                        xrow,
                         reqinfo,
-                        request) < 0)
+                        request,
+                        NULL) < 0)
         goto done;
     // ok:
     retval = 1;
@@ -1152,8 +1558,15 @@ snmp_table_set(clicon_handle               h,
 }
 
 /*! Find "next" object from oids minus key and return that.
+ *
+ * The whole table is fetched from the backend as a snapshot kept on the snmp
+ * handle and served to successive getnext requests until a short TTL
+ * (CLIXON_SNMP_CACHE_TIMEOUT) expires. A table walk (or getbulk burst, which the
+ * agent decomposes into getnexts) therefore makes one backend round trip per TTL
+ * window instead of one per varbind, and finds the successor row by binary search
+ * in the sorted row index of the snapshot instead of scanning all rows.
  * @param[in]  h        Clixon handle
- * @param[in]  ylist    Yang of table (of list type)
+ * @param[in]  sh       Clixon snmp handle, sh_ys is yang of table (of list type)
  * @param[in]  oids     OID of ultimate scalar value
  * @param[in]  oidslen  OID length of scalar
  * @param[in]  reqinfo  Agent transaction request structure
@@ -1165,13 +1578,14 @@ snmp_table_set(clicon_handle               h,
  */
 static int
 snmp_table_getnext(clicon_handle               h,
-                   yang_stmt                  *ylist,
+                   clixon_snmp_handle         *sh,
                    oid                        *oids,
                    size_t                      oidslen,
                    netsnmp_agent_request_info *reqinfo,
                    netsnmp_request_info       *request)
 {
     int        retval = -1;
+    yang_stmt *ylist = sh->sh_ys;
     cvec      *nsc = NULL;
     char      *xpath = NULL;
     cxobj     *xt = NULL;
@@ -1189,7 +1603,7 @@ snmp_table_getnext(clicon_handle               h,
     size_t     oidklen = MAX_OID_LEN;
     oid        oidnext[MAX_OID_LEN] = {0x7fffffff,}; /* Next oid: start with high value */
     size_t     oidnextlen = MAX_OID_LEN;
-    int        found = 0; 
+    int        found = 0;
     cxobj     *xnext = NULL;
     yang_stmt *ynext = NULL;
     cbuf      *cb = NULL;
@@ -1204,13 +1618,78 @@ snmp_table_getnext(clicon_handle               h,
         goto done;
     if (snmp_yang2xpath(ys, NULL, &xpath) < 0)
         goto done;
-    if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
-        goto done;
-    if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
-        clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
-        goto done;
+    /* Refresh the table snapshot and its sorted row index if empty or TTL expired */
+    if (!snmp_table_cache_fresh(sh)){
+        snmp_table_cache_free(sh);
+        if (clicon_rpc_get(h, xpath, nsc, CONTENT_ALL, -1, NULL, &xt) < 0)
+            goto done;
+        if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+            clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
+            goto done;
+        }
+        sh->sh_cache_xml = xt;
+        xt = NULL; /* ownership passed to handle */
+        gettimeofday(&sh->sh_cache_time, NULL);
+        if ((xtable = xpath_first(sh->sh_cache_xml, nsc, "%s", xpath)) != NULL &&
+            snmp_table_index_build(sh, xtable) < 0)
+            goto done;
+    }
+    if (sh->sh_cols != NULL && sh->sh_cache_rows != NULL){
+        /* Indexed search: columns ascending (compiled column map is sorted), within a
+         * column binary search the sorted row index for the first key greater than the
+         * target suffix. The first hit is the global smallest larger oid.
+         */
+        size_t collen = sh->sh_oid2len + 1;
+        int    nrows = clixon_xvec_len(sh->sh_cache_rows);
+        int    ci;
+        int    ri;
+        int    cmp;
+
+        for (ci=0; ci<sh->sh_ncols && !found; ci++){
+            ycol = sh->sh_cols[ci].sc_ys;
+            memcpy(oidc, sh->sh_oid2, sh->sh_oid2len*sizeof(*oidc));
+            oidc[collen-1] = sh->sh_cols[ci].sc_oid;
+            oidclen = collen;
+            /* Compare target against column base oid */
+            cmp = oid_eq(oids, oidslen < collen ? oidslen : collen, oidc, collen);
+            if (cmp > 0)
+                continue; /* whole column before target */
+            if (cmp < 0)
+                ri = 0;   /* whole column after target: start at first row */
+            else{
+                /* Target within column: first row key greater than target suffix */
+                int low = 0;
+                int high = nrows;
+                int mid;
+
+                while (low < high){
+                    mid = (low + high) / 2;
+                    if (oid_eq(sh->sh_cache_keys[mid].rk_oid, sh->sh_cache_keys[mid].rk_len,
+                               oids+collen, oidslen-collen) > 0)
+                        high = mid;
+                    else
+                        low = mid + 1;
+                }
+                ri = low;
+            }
+            /* First row at/after position where the column leaf is present */
+            for (; ri<nrows; ri++){
+                xrow = clixon_xvec_i(sh->sh_cache_rows, ri);
+                if ((xcol = xml_find_type(xrow, NULL, yang_argument_get(ycol), CX_ELMNT)) == NULL)
+                    continue;
+                if (oid_append(oidc, &oidclen, sh->sh_cache_keys[ri].rk_oid,
+                               sh->sh_cache_keys[ri].rk_len) < 0)
+                    goto done;
+                memcpy(oidnext, oidc, oidclen*sizeof(*oidnext));
+                oidnextlen = oidclen;
+                xnext = xcol;
+                ynext = ycol;
+                found++;
+                break;
+            }
+        }
     }
-    if ((xtable = xpath_first(xt, nsc, "%s", xpath)) != NULL) {
+    else if ((xtable = xpath_first(sh->sh_cache_xml, nsc, "%s", xpath)) != NULL) {
         /* Make a clone of key-list, but replace names with values */
         if ((cvk_name = yang_cvec_get(ylist)) == NULL){
             clicon_err(OE_YANG, 0, "No keys");
@@ -1271,6 +1750,16 @@ snmp_table_getnext(clicon_handle               h,
     return retval;
 }
 
+/*! Drop the table snapshot cache, eg after a set has modified the table
+ * @param[in]  sh  Clixon snmp handle of table
+ * @retval     0   OK
+ */
+static int
+snmp_table_cache_invalidate(clixon_snmp_handle *sh)
+{
+    return snmp_table_cache_free(sh);
+}
+
 /*! SNMP table operation handler
  *
  * @param[in]  handler Registered MIB handler structure
@@ -1305,8 +1794,8 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
     case MODE_GET: // 160
         /* Create xpath from YANG table OID + 1 + n + cvk/key = requestvb->name 
          */
-        if ((ret = snmp_table_get(sh->sh_h, sh->sh_ys,
-                                  sh->sh_oid2, sh->sh_oid2len, 
+        if ((ret = snmp_table_get(sh->sh_h, sh,
+                                  sh->sh_oid2, sh->sh_oid2len,
                                   requestvb->name, requestvb->name_length,
                                   reqinfo, request)) < 0)
             goto done;
@@ -1320,7 +1809,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         break;
     case MODE_GETNEXT: // 161
         /* Register table sub-oid:s of existing entries in clixon */
-        if ((ret = snmp_table_getnext(sh->sh_h, sh->sh_ys,
+        if ((ret = snmp_table_getnext(sh->sh_h, sh,
                                       requestvb->name, requestvb->name_length,
                                       reqinfo, request)) < 0)
             goto done;
@@ -1343,6 +1832,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
     case MODE_SET_RESERVE2: // 1
         break;
     case MODE_SET_ACTION:   // 2
+        snmp_table_cache_invalidate(sh);
         if ((ret = snmp_table_set(sh->sh_h, sh->sh_ys,
                                   requestvb->name, requestvb->name_length,
                                   reqinfo, request, &err)) < 0)
@@ -1368,6 +1858,7 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
         }
         break;
     case MODE_SET_COMMIT:   // 3
+        snmp_table_cache_invalidate(sh);
         if ((ret = clicon_rpc_commit(sh->sh_h, 0, 0, 0, NULL, NULL)) < 0)
             goto done;
         if (ret == 0){
@@ -1379,8 +1870,9 @@ clixon_snmp_table_handler1(netsnmp_mib_handler          *handler,
     case MODE_SET_FREE:     // 4
         break;
     case MODE_SET_UNDO  :   // 5
+        snmp_table_cache_invalidate(sh);
         if (clicon_rpc_discard_changes(sh->sh_h) < 0)
-            goto done;  
+            goto done;
         break;
     }
  ok:
@@ -58,6 +58,7 @@
 #include <signal.h>
 #include <assert.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>    /* inet_addr */
 #include <arpa/inet.h>
@@ -449,10 +450,129 @@ snmp_handle_free(void *arg)
             }
             free(sh->sh_table_info);
         }
+        if (sh->sh_cols)
+            free(sh->sh_cols);
+        if (sh->sh_scalars)
+            free(sh->sh_scalars);
+        snmp_table_cache_free(sh);
         free(sh);
     }
 }
 
+/*! Free the table snapshot cache of a handle: xml tree, row vector and row index
+ * @param[in]  sh  Clixon snmp handle of table
+ * @retval     0   OK
+ */
+int
+snmp_table_cache_free(clixon_snmp_handle *sh)
+{
+    int i;
+
+    if (sh->sh_cache_keys){
+        for (i=0; i<clixon_xvec_len(sh->sh_cache_rows); i++)
+            free(sh->sh_cache_keys[i].rk_oid);
+        free(sh->sh_cache_keys);
+        sh->sh_cache_keys = NULL;
+    }
+    if (sh->sh_cache_rows){
+        clixon_xvec_free(sh->sh_cache_rows); /* vector only, rows owned by sh_cache_xml */
+        sh->sh_cache_rows = NULL;
+    }
+    if (sh->sh_cache_xml){
+        xml_free(sh->sh_cache_xml);
+        sh->sh_cache_xml = NULL;
+    }
+    timerclear(&sh->sh_cache_time);
+    return 0;
+}
+
+/*! Build compiled column map of a table: column sub-identifier to YANG leaf
+ *
+ * Iterate the table columns once at registration so that per-varbind handling can
+ * resolve the YANG leaf of an OID with a binary search instead of re-parsing the
+ * smiv2:oid extension of every leaf for every varbind.
+ * @param[in]  sh  Clixon snmp handle with sh_ys (list) and sh_oid2 (entry oid) set
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see snmp_table_col_find
+ */
+int
+snmp_table_cols_build(clixon_snmp_handle *sh)
+{
+    int                     retval = -1;
+    yang_stmt              *ys = NULL;
+    oid                     oidleaf[MAX_OID_LEN] = {0,};
+    size_t                  oidleaflen;
+    struct clixon_snmp_col *cols = NULL;
+    struct clixon_snmp_col *tmp;
+    int                     nr = 0;
+    int                     i;
+    int                     j;
+    int                     ret;
+
+    while ((ys = yn_each(sh->sh_ys, ys)) != NULL) {
+        if (yang_keyword_get(ys) != Y_LEAF)
+            continue;
+        /* reset oid */
+        oidleaflen = MAX_OID_LEN;
+        if ((ret = yangext_oid_get(ys, oidleaf, &oidleaflen, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if (sh->sh_oid2len + 1 != oidleaflen) /* Indexes may be from other OID scope, skip those */
+            continue;
+        if ((tmp = realloc(cols, (nr+1)*sizeof(*cols))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        cols = tmp;
+        /* Insert sorted on column sub-id */
+        for (i=0; i<nr; i++)
+            if (oidleaf[oidleaflen-1] < cols[i].sc_oid)
+                break;
+        for (j=nr; j>i; j--)
+            cols[j] = cols[j-1];
+        cols[i].sc_oid = oidleaf[oidleaflen-1];
+        cols[i].sc_ys = ys;
+        nr++;
+    }
+    sh->sh_cols = cols;
+    sh->sh_ncols = nr;
+    cols = NULL;
+    retval = 0;
+ done:
+    if (cols)
+        free(cols);
+    return retval;
+}
+
+/*! Find YANG leaf of a table column sub-identifier using the compiled column map
+ * @param[in]  sh     Clixon snmp handle of table
+ * @param[in]  colid  Column sub-identifier (oid element after entry oid)
+ * @retval     ys     YANG leaf of column
+ * @retval     NULL   Not found
+ * @see snmp_table_cols_build
+ */
+yang_stmt *
+snmp_table_col_find(clixon_snmp_handle *sh,
+                    oid                 colid)
+{
+    int low = 0;
+    int high = sh->sh_ncols;
+    int mid;
+
+    while (low < high){
+        mid = (low + high) / 2;
+        if (sh->sh_cols[mid].sc_oid == colid)
+            return sh->sh_cols[mid].sc_ys;
+        if (sh->sh_cols[mid].sc_oid < colid)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+
 /*! Translate from YANG to SNMP asn1.1 type ids (not value)
  *
  * @param[in]    ys         YANG leaf node
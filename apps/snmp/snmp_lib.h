@@ -57,11 +57,48 @@ extern "C" {
 #define CLIXON_ASN_EXTRAS       253 /* Special case clixon address >= this */
 #define CLIXON_ASN_PHYS_ADDR    253 /* Special case phy-address */
 #define CLIXON_ASN_FIXED_STRING 254 /* RFC2578 Sec 7.7: String-valued, fixed-length */
-#define CLIXON_ASN_ROWSTATUS    255 
+#define CLIXON_ASN_ROWSTATUS    255
+
+/* How long (in seconds) a table snapshot fetched from the backend is served to
+ * successive getnext requests before it is re-fetched, see snmp_table_getnext */
+#define CLIXON_SNMP_CACHE_TIMEOUT 2
 
 /*
  * Types 
  */
+/* One column of a table: maps the column sub-identifier to its YANG leaf
+ * Built once per table at registration so that per-varbind handling does not
+ * need to re-parse the smiv2:oid extension of every leaf
+ * @see snmp_table_cols_build
+ */
+struct clixon_snmp_col {
+    oid        sc_oid; /* Column sub-identifier: oid element after entry oid */
+    yang_stmt *sc_ys;  /* Yang leaf of column */
+};
+
+/* One scalar leaf of a batched subtree registration: maps the leaf oid to its YANG leaf
+ * All scalar leafs of a container are registered as one netsnmp subtree, with the map
+ * sorted on oid so that per-varbind dispatch can binary search
+ * @see mibyang_scalars_register where the map is built
+ */
+struct clixon_snmp_scalar {
+    oid        ss_oid[MAX_OID_LEN]; /* Leaf oid, the instance is ss_oid.0 */
+    size_t     ss_oidlen;           /* Length of ss_oid */
+    yang_stmt *ss_ys;               /* Yang leaf */
+    char      *ss_default;          /* MIB default value, points into yang */
+    int        ss_modes;            /* HANDLER_CAN_RONLY / HANDLER_CAN_RWRITE */
+};
+
+/* Encoded index oid of one row of a table snapshot
+ * Kept sorted (parallel to the snapshot row vector) so that row lookup can
+ * binary search instead of scanning all rows
+ * @see snmp_table_getnext
+ */
+struct clixon_snmp_rowkey {
+    oid   *rk_oid; /* Encoded index (key) part of row oid, malloced */
+    size_t rk_len; /* Length of rk_oid */
+};
+
 /* Userdata to pass around in netsmp callbacks
  */
 struct clixon_snmp_handle {
@@ -73,8 +110,16 @@ struct clixon_snmp_handle {
     size_t        sh_oid2len;           
     char         *sh_default;          /* MIB default value leaf only */
     cvec         *sh_cvk_orig;         /* Index/Key variable values (original) */
-    netsnmp_table_registration_info *sh_table_info; /* To mimic table-handler in libnetsnmp code 
+    netsnmp_table_registration_info *sh_table_info; /* To mimic table-handler in libnetsnmp code
                                                      * save only to free properly */
+    struct clixon_snmp_col *sh_cols;   /* Column map sorted on sub-id, tables only */
+    int           sh_ncols;            /* Length of sh_cols */
+    cxobj        *sh_cache_xml;        /* Table snapshot served to getnext, tables only */
+    struct timeval sh_cache_time;      /* When sh_cache_xml was fetched, TTL-checked */
+    clixon_xvec  *sh_cache_rows;       /* Snapshot rows sorted by encoded index oid */
+    struct clixon_snmp_rowkey *sh_cache_keys; /* Encoded index oid per row, parallel to sh_cache_rows */
+    struct clixon_snmp_scalar *sh_scalars; /* Scalar map sorted on oid, batched subtrees only */
+    int           sh_nscalars;         /* Length of sh_scalars */
 };
 typedef struct clixon_snmp_handle clixon_snmp_handle;
 
@@ -92,6 +137,9 @@ int    snmp_access_str2int(char *modes_str);
 const char *snmp_msg_int2str(int msg);
 void  *snmp_handle_clone(void *arg);
 void   snmp_handle_free(void *arg);
+int    snmp_table_cols_build(clixon_snmp_handle *sh);
+yang_stmt *snmp_table_col_find(clixon_snmp_handle *sh, oid colid);
+int    snmp_table_cache_free(clixon_snmp_handle *sh);
 int    type_yang2asn1(yang_stmt *ys, int *asn1_type, int extended);
 int    type_snmp2xml(yang_stmt                  *ys,
                      int                        *asn1type,
@@ -322,8 +322,11 @@ mibyang_table_register(clicon_handle h,
            if ((yang_keyword_get(yleaf) != Y_LEAF) || (ret = yangext_is_oid_exist(yleaf)) != 1)
             continue;
 
-        table_info->max_column++;    
+        table_info->max_column++;
     }
+    /* Build compiled column oid to yang map used by the per-varbind handlers */
+    if (snmp_table_cols_build(sh) < 0)
+        goto done;
     if ((ret = netsnmp_register_table(nhreg, table_info)) != SNMPERR_SUCCESS){
         clicon_err(OE_SNMP, ret, "netsnmp_register_table");
         goto done;
@@ -529,6 +532,150 @@ mibyang_table_poll(clicon_handle h,
     return retval;
 }
 
+/*! Register all scalar leafs of a container as one batched subtree registration
+ *
+ * Instead of one netsnmp registration per scalar leaf, the direct leaf children of
+ * the container are compiled into a scalar map sorted on oid and the container oid
+ * is registered once, with per-varbind leaf dispatch done internally by the subtree
+ * handler. Registration cost (one agentx round trip per registration when running
+ * as subagent) thereby becomes per container instead of per leaf, which dominates
+ * startup time of large MIB-mapped schemas. The oid, max-access and defval
+ * extensions of each leaf are parsed once here instead of per request.
+ * @param[in]  h   Clixon handle
+ * @param[in]  yc  Mib-Yang node (container)
+ * @retval     1   OK, scalar leafs covered by one subtree registration
+ * @retval     0   Not applicable (container has no oid), register leafs one-by-one
+ * @retval    -1   Error
+ * @see mibyang_leaf_register for the one-by-one case
+ * @see clixon_snmp_subtree_handler
+ */
+static int
+mibyang_scalars_register(clicon_handle h,
+                         yang_stmt    *yc)
+{
+    int                           retval = -1;
+    netsnmp_handler_registration *nhreg;
+    netsnmp_mib_handler          *handler;
+    clixon_snmp_handle           *sh = NULL;
+    struct clixon_snmp_scalar    *scalars = NULL;
+    struct clixon_snmp_scalar    *tmp;
+    yang_stmt                    *ys;
+    char                         *modes_str;
+    char                         *default_str;
+    char                         *name;
+    oid                           oid1[MAX_OID_LEN] = {0,};
+    size_t                        oid1len = MAX_OID_LEN;
+    oid                           oidl[MAX_OID_LEN] = {0,};
+    size_t                        oidllen;
+    int                           modes = HANDLER_CAN_RONLY;
+    int                           nr = 0;
+    int                           i;
+    int                           j;
+    int                           ret;
+
+    if ((ret = yangext_oid_get(yc, oid1, &oid1len, NULL)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail; /* No container oid, caller registers leafs one-by-one */
+    /* Check if already registered */
+    if (clixon_snmp_api_oid_find(oid1, oid1len) == 1)
+        goto ok;
+    ys = NULL;
+    while ((ys = yn_each(yc, ys)) != NULL) {
+        if (yang_keyword_get(ys) != Y_LEAF)
+            continue;
+        /* reset oid */
+        oidllen = MAX_OID_LEN;
+        if ((ret = yangext_oid_get(ys, oidl, &oidllen, NULL)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        modes_str = NULL;
+        if (yang_extension_value(ys, "max-access", IETF_YANG_SMIV2_NS, NULL, &modes_str) < 0)
+            goto done;
+        if (modes_str == NULL)
+            continue;
+        /* Only for sanity check of types initially to fail early */
+        if (type_yang2asn1(ys, NULL, 0) < 0)
+            goto done;
+        /* SMI default value, How is this different from yang defaults?
+         */
+        default_str = NULL;
+        if (yang_extension_value(ys, "defval", IETF_YANG_SMIV2_NS, NULL, &default_str) < 0)
+            goto done;
+        if ((tmp = realloc(scalars, (nr+1)*sizeof(*scalars))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        scalars = tmp;
+        /* Insert sorted on leaf oid */
+        for (i=0; i<nr; i++)
+            if (oid_eq(scalars[i].ss_oid, scalars[i].ss_oidlen, oidl, oidllen) > 0)
+                break;
+        for (j=nr; j>i; j--)
+            scalars[j] = scalars[j-1];
+        memset(&scalars[i], 0, sizeof(scalars[i]));
+        memcpy(scalars[i].ss_oid, oidl, oidllen*sizeof(oid));
+        scalars[i].ss_oidlen = oidllen;
+        scalars[i].ss_ys = ys;
+        scalars[i].ss_default = default_str;
+        scalars[i].ss_modes = snmp_access_str2int(modes_str);
+        if (scalars[i].ss_modes != HANDLER_CAN_RONLY)
+            modes = HANDLER_CAN_RWRITE;
+        nr++;
+    }
+    if (nr == 0)
+        goto ok; /* No registrable scalar leafs */
+    name = yang_argument_get(yc);
+    /* Userdata to pass around in netsmp callbacks */
+    if ((sh = malloc(sizeof(*sh))) == NULL){
+       clicon_err(OE_UNIX, errno, "malloc");
+       goto done;
+    }
+    memset(sh, 0, sizeof(*sh));
+    sh->sh_h = h;
+    sh->sh_ys = yc;
+    memcpy(sh->sh_oid, oid1, oid1len*sizeof(*oid1));
+    sh->sh_oidlen = oid1len;
+    sh->sh_scalars = scalars;
+    sh->sh_nscalars = nr;
+    scalars = NULL; /* ownership passed to handle */
+    /* Stateless function, just returns ptr */
+    if ((handler = netsnmp_create_handler(name, clixon_snmp_subtree_handler)) == NULL){
+        clicon_err(OE_XML, errno, "netsnmp_create_handler");
+        goto done;
+    }
+    if ((nhreg = netsnmp_handler_registration_create(name, handler,
+                                                     oid1, oid1len,
+                                                     modes)) == NULL){
+        clicon_err(OE_XML, errno, "netsnmp_handler_registration_create");
+        netsnmp_handler_free(handler);
+        goto done;
+    }
+    /* Register our application data and how to free it */
+    handler->myvoid = (void*)sh;
+    handler->data_clone = snmp_handle_clone;
+    handler->data_free = snmp_handle_free;
+    sh = NULL; /* ownership passed to handler */
+    if ((ret = netsnmp_register_handler(nhreg)) != SNMPERR_SUCCESS){
+        /* Note MIB_ errors, not regular SNMPERR_ */
+        clicon_err(OE_SNMP, ret-CLIXON_ERR_SNMP_MIB, "netsnmp_register_handler");
+        goto done;
+    }
+    clicon_debug(1, "%s register: %s %d scalars", __FUNCTION__, name, nr);
+ ok:
+    retval = 1;
+ done:
+    if (scalars)
+        free(scalars);
+    if (sh)
+        snmp_handle_free(sh);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Traverse mib-yang tree, identify scalars and tables, register OID and callbacks
  *
  * The tree is traversed depth-first, which at least guarantees that a parent is
@@ -557,8 +704,9 @@ mibyang_traverse(clicon_handle h,
     int        retval = -1;
     yang_stmt *ys = NULL;
     yang_stmt *yp;
+    int        batched = 0;
     int        ret;
-        
+
     clicon_debug(1, "%s %s", __FUNCTION__, yang_argument_get(yn));
     switch(yang_keyword_get(yn)){
     case Y_AUGMENT:
@@ -571,6 +719,13 @@ mibyang_traverse(clicon_handle h,
             goto done;
         break;
     case Y_CONTAINER: /* See list case */
+        /* Batch direct scalar leafs into one subtree registration. Table containers
+         * (with list child) register the same root oid via the list case, skip those */
+        if (yang_find(yn, Y_LIST, NULL) == NULL){
+            if ((ret = mibyang_scalars_register(h, yn)) < 0)
+                goto done;
+            batched = ret;
+        }
         break;
     case Y_LIST: /* If parent is container -> identify as table */
         yp = yang_parent_get(yn);
@@ -589,7 +744,10 @@ mibyang_traverse(clicon_handle h,
     ys = NULL;
     while ((ys = yn_each(yn, ys)) != NULL) {
         /* augment special case of table */
-        if (!yang_schemanode(ys) && yang_keyword_get(ys) != Y_AUGMENT) 
+        if (!yang_schemanode(ys) && yang_keyword_get(ys) != Y_AUGMENT)
+            continue;
+        /* Direct scalar leafs already covered by the batched subtree registration */
+        if (batched && yang_keyword_get(ys) == Y_LEAF)
             continue;
         if ((ret = mibyang_traverse(h, ys)) < 0)
             goto done;
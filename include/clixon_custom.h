@@ -67,6 +67,16 @@
  */
 #define XPATH_LIST_OPTIMIZE
 
+/*! Skip whole top-level datastore subtrees in xpath reads using a namespace summary
+ * Datastore reads with an xpath keep a bitmap per top-level subtree of the
+ * namespaces present beneath it in the db_elmnt cache entry, rebuilt lazily when
+ * the write serial moves. Subtrees sharing no namespace with the xpath are
+ * flagged so evaluation does not descend into them, see xmldb_nsmap_prefilter().
+ * Pays off on descendant ("//") and wildcard-free searches targeting one
+ * module's subtree out of many.
+ */
+#define XMLDB_XPATH_NSFILTER
+
 /*! Add explicit search indexes, so that binary search can be made for non-key list indexes
  * This also applies if there are multiple keys and you want to search on only the second for 
  * example.
@@ -75,6 +85,56 @@
  */
 #define XML_EXPLICIT_INDEX
 
+/*! Slab-backed node pool for cxobj allocation
+ * xml_new() takes nodes from per-size free lists backed by chunked slab
+ * allocations and xml_free() returns them there, instead of one malloc/free
+ * pair per node. Cuts allocator overhead when parsing and freeing large trees.
+ * Slabs are never returned to the system, they are reused by later trees.
+ */
+#define XML_NODE_POOL
+
+/*! TTL in seconds for cached user/group NSS lookups
+ * name2uid, uid2name and group_name2gid keep resolved entries this long before
+ * asking NSS again. With LDAP-backed NSS each resolution is a network call and
+ * the backend resolves peer credentials per session. Set to 0 to disable the
+ * cache; changed passwd/group mappings are picked up within the TTL.
+ */
+#define NSS_CACHE_TTL 60
+
+/*! Intern XML node names and prefixes in a global string table
+ * Element, attribute and prefix names are drawn from a small bounded set
+ * (YANG identifiers), yet xml_name_set() strdups every occurrence. With
+ * interning xml_name()/xml_prefix() return shared pointers into a global
+ * table built on clicon_hash, cutting tree memory considerably on large
+ * configs. Interned strings are never freed. Body values are not interned.
+ */
+#define XML_NAME_INTERN
+
+/*! Lazy hash index over list keys on list-parent XML nodes
+ * clixon_xml_find_index() consults a per-parent hash mapping
+ * <listname>|<key>=<val>.. to child position before falling back to binary
+ * search. The index is built lazily on lookup, validated against the parent
+ * child count and the hit's actual key values, and dropped on any mismatch,
+ * so stale entries can only cost a fallback to the existing search.
+ */
+#define XML_LIST_KEYHASH
+
+/*! Use 16-byte vector compares when scanning XML chardata for escape characters
+ * xml_chardata_encode()/xml_chardata_cbuf_append() scan for the next of & < >
+ * with SSE2 or NEON compares when the compiler targets such an instruction set,
+ * and move unescaped runs with memcpy-width operations instead of one character
+ * at a time. Undefine to force the portable byte loop, eg for debugging.
+ */
+#define XML_CHARDATA_SIMD
+
+/*! Use 16-byte vector compares when scanning JSON strings for escape characters
+ * json_str_escape_cdata() scans for the next of \" \\ and newline with SSE2 or
+ * NEON compares when the compiler targets such an instruction set, and appends
+ * unescaped runs with memcpy-width operations instead of one character at a
+ * time. Undefine to force the portable byte loop, eg for debugging.
+ */
+#define JSON_STRING_SIMD
+
 /*! Let state data be ordered-by system
  * RFC 7950 is cryptic about this
  * It says in 7.7.7:
@@ -93,6 +153,13 @@
  */
 #define DATASTORE_TOP_SYMBOL "config"
 
+/*! Sorted-invariant marker attribute on the datastore top symbol
+ * Written by xmldb_writefile on files serialized from the (sorted) cache so that
+ * xmldb_readfile can skip the full resort pass on load. Stripped when reading.
+ * If you hand-edit a datastore file, remove the attribute to force a resort.
+ */
+#define DATASTORE_SORTED_ATTR "sorted"
+
 /*! Name of default netns for clixon-restconf.yang socket/namespace field
  * Restconf allows opening sockets in different network namespaces. This is teh name of 
  * "host"/"default" namespace. Unsure what to really label this but seems like there is differing
@@ -165,6 +232,26 @@
  */
 #define PRETTYPRINT_INDENT 3
 
+/*! Max backlog in bytes of a backend client output queue before notifications are dropped
+ *
+ * A subscriber that does not read its socket accumulates queued output in the backend.
+ * RPC replies are always queued, but once the backlog passes this limit further event
+ * notifications to that subscriber are dropped instead of growing the queue unboundedly.
+ */
+#define BACKEND_NOTIFY_QUEUE_MAX (1024*1024)
+
+/*! Compile in static userspace tracepoints (USDT) at transaction and datastore boundaries
+ *
+ * Probe sites in the backend commit/validate path, the plugin transaction phases and
+ * datastore writes then expand to systemtap <sys/sdt.h> probes in provider "clixon",
+ * carrying db name, diff vector sizes and session id. They can be attached in
+ * production with perf, bpftrace or systemtap without log-level changes, eg to
+ * flamegraph slow commits. A disabled probe is a single nop instruction; when this
+ * option is unset probe sites compile to nothing. Requires systemtap-sdt-dev.
+ * See lib/clixon/clixon_usdt.h
+ */
+#undef CLIXON_USDT_PROBES
+
 /*! Set backward compatibility for NETCONF get/get-config <with-defaults> parameter behavior
  *
  * This option sets backward-compability that has to do with an inconsistency
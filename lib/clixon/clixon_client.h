@@ -60,9 +60,18 @@ typedef enum {
      * Fork ssh locally which in turn communicates remotely to device
      * Must have openssh installed locally and device must have ssh sub-subsystem
      */
-    CLIXON_CLIENT_SSH  
+    CLIXON_CLIENT_SSH
 } clixon_client_type;
 
+/* One notification event in a batch from clixon_client_events_poll.
+ * The raw frame is always set; the XML tree is parsed lazily on first call to
+ * clixon_client_event_xml and cached here.
+ */
+struct clixon_client_event{
+    char  *ce_frame; /* Raw notification frame, owned by the vector */
+    cxobj *ce_xml;   /* Parsed frame, NULL until clixon_client_event_xml */
+};
+
 /*
  * Prototypes
  */
@@ -77,6 +86,7 @@ int   clixon_client_lock(int sock, const int lock, const char *db);
 int   clixon_client_hello(int sock, int version);
 clixon_client_handle clixon_client_connect(clixon_handle h, clixon_client_type socktype, const char *dest);
 int   clixon_client_disconnect(clixon_client_handle ch);
+int   clixon_client_pool_drain(void);
 int   clixon_client_get_bool(clixon_client_handle ch, int *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_str(clixon_client_handle ch, char *rval, int n, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint8(clixon_client_handle ch, uint8_t *rval, const char *xnamespace, const char *xpath);
@@ -84,6 +94,11 @@ int   clixon_client_get_uint16(clixon_client_handle ch, uint16_t *rval, const ch
 int   clixon_client_get_uint32(clixon_client_handle ch, uint32_t *rval, const char *xnamespace, const char *xpath);
 int   clixon_client_get_uint64(clixon_client_handle ch, uint64_t *rval, const char *xnamespace, const char *xpath);
     
+int   clixon_client_subscribe(clixon_client_handle ch, const char *stream, const char *xnamespace, const char *xpath);
+int   clixon_client_events_poll(clixon_client_handle ch, int timeout_ms, int maxevents, struct clixon_client_event **evvec, int *evlen);
+cxobj *clixon_client_event_xml(struct clixon_client_event *ev);
+int   clixon_client_events_free(struct clixon_client_event *evvec, int evlen);
+
 /* Access functions */
 int   clixon_client_socket_get(clixon_client_handle ch);
 
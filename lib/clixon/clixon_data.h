@@ -46,7 +46,32 @@
 /*
  * Types
  */
-/* Struct per database in hash 
+/* Partial lock of a datastore per RFC 5717, kept as a linked list in db_elmnt.
+ * A lock taken with several select expressions is represented as one node per
+ * select, all sharing the same pl_lockid, see xmldb_plock()
+ */
+struct db_plock{
+    struct db_plock *pl_next;
+    uint32_t         pl_lockid; /* RFC 5717 lock-id, unique within the db */
+    uint32_t         pl_sessid; /* Client/session id holding the lock */
+    char            *pl_select; /* XPath select expression scoping the lock */
+    struct timeval   pl_tv;     /* When the lock was taken */
+};
+
+/* Per top-level subtree (module data root) node/byte counters of a cached
+ * datastore tree. Maintained lazily: xmldb_put invalidates the entries its
+ * edit touched and the next stats read recounts only those, so the stats rpc
+ * avoids a full tree walk, see xmldb_modstats_get()
+ */
+struct db_modstat{
+    struct db_modstat *ms_next;
+    char              *ms_name;  /* Name of top-level node (module data root) */
+    uint64_t           ms_nr;    /* Nr of xml nodes in the subtree */
+    uint64_t           ms_size;  /* Bytes held by the subtree */
+    int                ms_valid; /* If 0, recount on next stats read */
+};
+
+/* Struct per database in hash
  * Semantics of de_modified is to implement this from RFC 6241 Sec 7.5:
  *       The target configuration is <candidate>, it has already been
  *       modified, and these changes have not been committed or rolled back.
@@ -54,9 +79,30 @@
 typedef struct {
     uint32_t  de_id;       /* If set, locked by this client/session id */
     struct timeval de_tv;       /* Timevalue */
+    struct db_plock *de_plocks; /* Partial (subtree) locks per RFC 5717, see xmldb_plock() */
+    uint32_t  de_plockid;  /* Last assigned partial lock-id, monotonically increasing */
     cxobj    *de_xml;      /* cache */
     int       de_modified; /* Dirty since loaded/copied/committed/etc XXX:nocache? */
     int       de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
+    uint32_t  de_serial;   /* Write serial: bumped on every modification of the db,
+                              readers can compare serials to detect change, see xmldb_serial_get() */
+    uint32_t  de_base_serial; /* Private candidates: de_serial of running when this db was
+                              forked from it, checked against running at commit to detect
+                              concurrent commits. 0: not a fork, see CLICON_PRIVATE_CANDIDATE */
+    int       de_dirty;    /* Cache has edits not yet written to the datastore file, flushed
+                              by a deferred write, see CLICON_XMLDB_WRITE_COALESCE / xmldb_flush() */
+    int       de_shared;   /* de_xml may be shared with another datastore (copy-on-write copy),
+                              writers must clone first, see xmldb_cache_unshare(). Cheap test so
+                              every edit need not scan the db hash for sharers */
+    uint64_t *de_nsmap;    /* Per top-level child of de_xml: bitmap (bloom) of namespaces present
+                              in that subtree, so xpath reads can skip whole top-level subtrees,
+                              see xmldb_nsmap_prefilter(). Rebuilt lazily when de_serial moves */
+    size_t    de_nsmaplen; /* Number of entries in de_nsmap */
+    uint32_t  de_nsserial; /* de_serial at which de_nsmap was built */
+    struct db_modstat *de_mstats; /* Per top-level subtree node/byte counters,
+                              see xmldb_modstats_get() */
+    uint32_t  de_msserial; /* de_serial for which de_mstats is current: if the db
+                              changed outside xmldb_put (copy/clear), recount all */
 } db_elmnt;
 
 /*
@@ -72,6 +118,11 @@ int clicon_ptr_get(clicon_handle h, const char *name, void **ptr);
 int clicon_ptr_set(clicon_handle h, const char *name, void *ptr);
 int clicon_ptr_del(clicon_handle h, const char *name);
 
+/* By-reference storage with destructor: the handle owns the object */
+void *clicon_data_ref_get(clicon_handle h, const char *name);
+int clicon_data_ref_set(clicon_handle h, const char *name, void *ptr, clicon_hash_freefn_t *freefn);
+int clicon_data_ref_del(clicon_handle h, const char *name);
+
 cvec *clicon_data_cvec_get(clicon_handle h, const char *name);
 int   clicon_data_cvec_set(clicon_handle h, const char *name, cvec *cvv);
 int   clicon_data_cvec_del(clicon_handle h, const char *name);
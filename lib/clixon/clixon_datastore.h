@@ -44,6 +44,8 @@
  */
 /* Internal functions */
 int xmldb_db2file(clicon_handle h, const char *db, char **filename);
+int xmldb_shard_dir(clicon_handle h, const char *db, char **dir);
+int xmldb_shard_clear(clicon_handle h, const char *db);
 
 /* API */
 int xmldb_validate_db(const char *db);
@@ -53,17 +55,34 @@ int xmldb_disconnect(clicon_handle h);
 int xmldb_get(clicon_handle h, const char *db, cvec *nsc, char *xpath, cxobj **xtop);
 int xmldb_get0(clicon_handle h, const char *db, yang_bind yb,
                cvec *nsc, const char *xpath, int copy, withdefaults_type wdef,
-               cxobj **xtop, modstate_diff_t *msd, cxobj **xerr); 
+               cxobj **xtop, modstate_diff_t *msd, cxobj **xerr);
+int xmldb_get0_depth(clicon_handle h, const char *db, yang_bind yb,
+               cvec *nsc, const char *xpath, int copy, withdefaults_type wdef,
+               int32_t depth, cxobj **xtop, modstate_diff_t *msd, cxobj **xerr);
 int xmldb_get0_clear(clicon_handle h, cxobj *x);
 int xmldb_get0_free(clicon_handle h, cxobj **xp);
+int xmldb_get_ref(clicon_handle h, const char *db, cvec *nsc, const char *xpath,
+                  cxobj ***xvec, size_t *xlen, cxobj **xret, cxobj **xerr);
+int xmldb_diff(clicon_handle h, const char *db1, const char *db2,
+               cxobj **xd1p, cxobj **xd2p, cxobj **xerr);
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret); /* in clixon_datastore_write.[ch] */
+int xmldb_flush(clicon_handle h, const char *db);
+int xmldb_flush_defer(clicon_handle h, const char *db);
+int xmldb_barrier(clicon_handle h, const char *db);
 int xmldb_copy(clicon_handle h, const char *from, const char *to);
+int xmldb_copy_defer(clicon_handle h, const char *from, const char *to);
 int xmldb_lock(clicon_handle h, const char *db, uint32_t id);
 int xmldb_unlock(clicon_handle h, const char *db);
 int xmldb_unlock_all(clicon_handle h, uint32_t id);
 uint32_t xmldb_islocked(clicon_handle h, const char *db);
+int xmldb_plock(clicon_handle h, const char *db, uint32_t id, cvec *selects,
+                uint32_t *lockid, uint32_t *locker);
+int xmldb_punlock(clicon_handle h, const char *db, uint32_t id, uint32_t lockid,
+                  uint32_t *locker);
+uint32_t xmldb_plock_conflict(clicon_handle h, const char *db, uint32_t id, const char *select);
 int xmldb_lock_timestamp(clicon_handle h, const char *db, struct timeval *tv);
 int xmldb_exists(clicon_handle h, const char *db);
+int xmldb_prefetch(clicon_handle h, const char *db);
 int xmldb_clear(clicon_handle h, const char *db);
 int xmldb_delete(clicon_handle h, const char *db);
 int xmldb_create(clicon_handle h, const char *db);
@@ -71,9 +90,21 @@ int xmldb_create(clicon_handle h, const char *db);
 int xmldb_db_reset(clicon_handle h, const char *db);
 
 cxobj *xmldb_cache_get(clicon_handle h, const char *db);
+int xmldb_cache_refcnt(clicon_handle h, cxobj *x);
+int xmldb_cache_unshare(clicon_handle h, const char *db, cxobj **xp);
+int xmldb_ref_incr(clicon_handle h, cxobj *x);
+int xmldb_ref_cnt(clicon_handle h, cxobj *x);
+int xmldb_ref_orphan(clicon_handle h, cxobj *x);
+int xmldb_ref_release(clicon_handle h, cxobj *x);
 
 int xmldb_modified_get(clicon_handle h, const char *db);
 int xmldb_modified_set(clicon_handle h, const char *db, int value);
+uint32_t xmldb_serial_get(clicon_handle h, const char *db);
+uint32_t xmldb_base_serial_get(clicon_handle h, const char *db);
+int xmldb_base_serial_set(clicon_handle h, const char *db, uint32_t serial);
+int xmldb_serial_bump(clicon_handle h, const char *db);
+int xmldb_modstats_invalidate(clicon_handle h, const char *db, cvec *names);
+int xmldb_modstats_get(clicon_handle h, const char *db, cbuf *cb);
 int xmldb_empty_get(clicon_handle h, const char *db);
 int xmldb_dump(clicon_handle h, FILE *f, cxobj *xt);
 int xmldb_print(clicon_handle h, FILE *f);
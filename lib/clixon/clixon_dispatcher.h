@@ -47,15 +47,30 @@
  */
 typedef int (*handler_function)(void *handle, char *path, void *userargs, void *arg);
 
+/*! Prototype for a function to handle a batch of paths in one invocation
+ * Optional variant of handler_function used by dispatcher_call_handlers_batch:
+ * all requested paths that resolve to the same registered entry are handed
+ * over in one call, so a handler can fetch its state in one backend query.
+ * @param[in]  h        Generic handler
+ * @param[in]  paths    Requested paths resolving to this entry
+ * @param[in]  npaths   Number of paths
+ * @param[in]  userargs Per-call user arguments
+ * @param[in]  arg      Per-path user argument
+ */
+typedef int (*handler_function_batch)(void *handle, char **paths, size_t npaths, void *userargs, void *arg);
+
 /*
  * this structure is used to map a handler to a path
  */
 typedef struct {
-    char            *dd_path;
-    handler_function dd_handler;
-    void            *dd_arg;
+    char                  *dd_path;
+    handler_function       dd_handler;
+    void                  *dd_arg;
+    handler_function_batch dd_handler_batch; /* optional, see dispatcher_call_handlers_batch */
 } dispatcher_definition;
 
+struct clicon_hash; /* see clixon_hash.h */
+
 /*
  * the dispatcher_entry_t is the structure created from
  * the registered dispatcher_definitions
@@ -82,6 +97,13 @@ struct _dispatcher_entry {
      */
     dispatcher_entry_t *peer_head;
 
+    /*
+     * only on the peer_head node: hash of node_name -> entry over all
+     * peers at this level, so each path segment is matched in O(1),
+     * see find_peer()
+     */
+    struct clicon_hash **peer_hash;
+
     /*
      * points at peer_head of children list
      * if NULL, then no children
@@ -93,6 +115,12 @@ struct _dispatcher_entry {
      */
     handler_function handler;
 
+    /*
+     * optional batch variant, called instead of handler by
+     * dispatcher_call_handlers_batch
+     */
+    handler_function_batch handler_batch;
+
     /*
      * End-user argument
      */
@@ -104,6 +132,7 @@ struct _dispatcher_entry {
  */
 int dispatcher_register_handler(dispatcher_entry_t **root, dispatcher_definition *x);
 int dispatcher_call_handlers(dispatcher_entry_t *root, void *handle, char *path, void *user_args);
+int dispatcher_call_handlers_batch(dispatcher_entry_t *root, void *handle, char **paths, size_t npaths, void *user_args);
 int dispatcher_free(dispatcher_entry_t *root);
 int dispatcher_print(FILE *f, int level, dispatcher_entry_t *root);
 
@@ -90,13 +90,25 @@ enum clicon_err{
  */
 typedef int (clixon_cat_log_cb)(void *handle, int suberr, cbuf *cb);
 
+/* Thread-local storage qualifier. The error state below is per-thread so that
+ * worker threads can fail independently; a parent collects their states with
+ * clicon_err_save() and merges them with clicon_err_aggregate().
+ * Falls back to plain globals on compilers without __thread (single-threaded
+ * behavior is unchanged either way).
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CLIXON_THREAD_LOCAL __thread
+#else
+#define CLIXON_THREAD_LOCAL
+#endif
+
 /*
  * Variables
  * XXX: should not be global
  */
-extern int  clicon_errno;    /* CLICON errors (see clicon_err) */
-extern int  clicon_suberrno; /* Eg orig errno */
-extern char clicon_err_reason[ERR_STRLEN];
+extern CLIXON_THREAD_LOCAL int  clicon_errno;    /* CLICON errors (see clicon_err) */
+extern CLIXON_THREAD_LOCAL int  clicon_suberrno; /* Eg orig errno */
+extern CLIXON_THREAD_LOCAL char clicon_err_reason[ERR_STRLEN];
 
 /*
  * Macros
@@ -111,6 +123,7 @@ int   clicon_err_fn(const char *fn, const int line, int category, int err, const
 char *clicon_strerror(int err);
 void *clicon_err_save(void);
 int   clicon_err_restore(void *handle);
+int   clicon_err_aggregate(void **states, int nr);
 int   clixon_err_cat_reg(enum clicon_err category, void *handle, clixon_cat_log_cb logfn);
 int   clixon_err_exit(void);
 
@@ -56,15 +56,27 @@ int clicon_sig_ignore_set(int val);
 int clicon_sig_ignore_get(void);
 
 int clixon_event_reg_fd(int fd, int (*fn)(int, void*), void *arg, char *str);
+int clixon_event_reg_fd_write(int fd, int (*fn)(int, void*), void *arg, char *str);
 
 int clixon_event_unreg_fd(int s, int (*fn)(int, void*));
+int clixon_event_unreg_fd_write(int s, int (*fn)(int, void*));
+
+int clixon_event_wakeup(void);
+
+int clixon_event_reg_signal(int signo, void (*handler)(int));
+int clixon_event_unreg_signal(int signo);
 
 int clixon_event_reg_timeout(struct timeval t,  int (*fn)(int, void*), 
                              void *arg, char *str);
 
 int clixon_event_unreg_timeout(int (*fn)(int, void*), void *arg);
 
+int clixon_event_reg_periodic(uint32_t period_ms, int (*fn)(int, void*), void *arg, char *str);
+int clixon_event_unreg_periodic(int (*fn)(int, void*), void *arg);
+int clixon_event_periodic_stats(cbuf *cb);
+
 int clixon_event_poll(int fd);
+int clixon_event_stats(int *nfd, int *ntimeout);
 
 int clixon_event_loop(clicon_handle h);
 
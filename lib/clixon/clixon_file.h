@@ -45,5 +45,10 @@ int clicon_file_dirent(const char *dir, struct dirent **ent,
 int clicon_files_recursive(const char *dir, const char *regexp, cvec *cvv);
 int clicon_file_copy(char *src, char *target);
 int clicon_file_cbuf(const char *filename, cbuf *cb);
+int clixon_file_zstd_magic(FILE *fp);
+#ifdef WITH_ZSTD
+FILE *clixon_file_zstd_read(FILE *fp);
+FILE *clixon_file_zstd_write(FILE *fp);
+#endif
 
 #endif /* _CLIXON_FILE_H_ */
@@ -81,6 +81,9 @@ int clicon_handle_check(clicon_handle h);
 /* Return clicon options (hash-array) given a handle.*/
 clicon_hash_t *clicon_options(clicon_handle h);
 
+/* Typed snapshot of hot config options, see clixon_options.h */
+struct clicon_option_cache *clicon_optcache(clicon_handle h);
+
 /* Return internal clicon data (hash-array) given a handle.*/
 clicon_hash_t *clicon_data(clicon_handle h);
 
@@ -38,11 +38,22 @@
 #ifndef _CLIXON_HASH_H_
 #define _CLIXON_HASH_H_
 
+/* Destructor of a by-reference hash value, see clicon_hash_add_ref */
+typedef int (clicon_hash_freefn_t)(void *val);
+
+/* One hash entry (a slot in an open-addressing table, see clixon_hash.c).
+ * Note a clicon_hash_t returned by clicon_hash_lookup is only valid until the
+ * next add/del on the same table: entries move on resize and deletion.
+ * The h_key and h_val allocations themselves are stable across resize.
+ */
 struct clicon_hash {
-    qelem_t     h_qelem;
     char       *h_key;
     size_t      h_vlen;
     void       *h_val;
+    clicon_hash_freefn_t *h_free; /* If set, entry is by-reference: h_val is the
+                                     caller's object, freed with this destructor */
+    uint32_t    h_hash32;  /* cached hash of h_key: resize and fast compare */
+    uint32_t    h_dist;    /* probe distance + 1, 0 means empty slot */
 };
 typedef struct clicon_hash *clicon_hash_t;
 
@@ -51,6 +62,7 @@ int            clicon_hash_free (clicon_hash_t *);
 clicon_hash_t  clicon_hash_lookup (clicon_hash_t *head, const char *key);
 void          *clicon_hash_value (clicon_hash_t *head, const char *key, size_t *vlen);
 clicon_hash_t  clicon_hash_add (clicon_hash_t *head, const char *key, void *val, size_t vlen);
+clicon_hash_t  clicon_hash_add_ref (clicon_hash_t *head, const char *key, void *val, clicon_hash_freefn_t *freefn);
 int            clicon_hash_del (clicon_hash_t *head, const char *key);
 int            clicon_hash_dump(clicon_hash_t *head, FILE *f);
 int            clicon_hash_keys(clicon_hash_t *hash, char ***vector, size_t *nkeys);
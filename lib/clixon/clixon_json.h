@@ -40,10 +40,17 @@
 #ifndef _CLIXON_JSON_H
 #define _CLIXON_JSON_H
 
+/*
+ * Types
+ */
+/* Streaming JSON parse handle for chunked bodies, see clixon_json_stream_new */
+typedef struct clixon_json_stream clixon_json_stream;
+
 /*
  * Prototypes
  */
 int json2xml_decode(cxobj *x, cxobj **xerr);
+int json_xmlns_translate(yang_stmt *yspec, cxobj *x, cxobj **xerr);
 int clixon_json2cbuf(cbuf *cb, cxobj *x, int pretty, int skiptop, int autocliext);
 int xml2json_cbuf_vec(cbuf *cb, cxobj **vec, size_t veclen, int pretty, int skiptop);
 int clixon_json2file(FILE *f, cxobj *x, int pretty, clicon_output_cb *fn, int skiptop, int autocliext);
@@ -51,5 +58,9 @@ int json_print(FILE *f, cxobj *x);
 int xml2json_vec(FILE *f, cxobj **vec, size_t veclen, int pretty, int skiptop);
 int clixon_json_parse_string(char *str, int rfc7951, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xret);
 int clixon_json_parse_file(FILE *fp, int rfc7951, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xret);
+clixon_json_stream *clixon_json_stream_new(int rfc7951, yang_bind yb, yang_stmt *yspec, cxobj *xt);
+int clixon_json_stream_input(clixon_json_stream *js, const char *data, size_t len, cxobj **xerr);
+int clixon_json_stream_final(clixon_json_stream *js, cxobj **xerr);
+int clixon_json_stream_free(clixon_json_stream *js);
 
 #endif /* _CLIXON_JSON_H */
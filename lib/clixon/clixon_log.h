@@ -64,8 +64,13 @@ int clicon_log_opt(char c);
 int clicon_log_file(char *filename);
 int clicon_log_string_limit_set(size_t sz);
 size_t clicon_log_string_limit_get(void);
+int clixon_log_slow_set(uint32_t ms);
+uint32_t clixon_log_slow_get(void);
+uint64_t clixon_log_slow_ns(void);
 int clicon_get_logflags(void);
 int clicon_log_str(int level, char *msg);
+int clicon_log_async_init(size_t size);
+int clicon_log_async_flush(void);
 int clicon_log(int level, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
 int clicon_debug(int dbglevel, const char *format, ...) __attribute__ ((format (printf, 2, 3)));
 int clicon_debug_init(int dbglevel, FILE *f);
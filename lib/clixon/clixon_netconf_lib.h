@@ -76,6 +76,11 @@
  */
 #define NETCONF_MONITORING_NAMESPACE "urn:ietf:params:xml:ns:yang:ietf-netconf-monitoring"
 
+/* RFC 5717 Partial Lock Remote Procedure Call
+ */
+#define NETCONF_PARTIAL_LOCK_NAMESPACE "urn:ietf:params:xml:ns:netconf:partial-lock:1.0"
+#define NETCONF_PARTIAL_LOCK_CAPABILITY "urn:ietf:params:netconf:capability:partial-lock:1.0"
+
 /* Default STREAM namespace (see rfc5277 3.1)
  * From RFC8040: 
  *  The structure of the event data is based on the <notification>
@@ -212,5 +217,6 @@ int netconf_framing_postamble(netconf_framing_type framing, cbuf *cb);
 int netconf_output(int s, cbuf *xf, char *msg);
 int netconf_output_encap(netconf_framing_type framing, cbuf *cb);
 int netconf_input_chunked_framing(char ch, int *state, size_t *size);
+int netconf_input_chunked_framing_buf(char *buf, size_t len, int *state, size_t *size, cbuf *cb, size_t *nr);
 
 #endif /* _CLIXON_NETCONF_LIB_H */
@@ -42,5 +42,6 @@
  * Prototypes
  */
 int netconf_monitoring_state_get(clicon_handle h, yang_stmt *yspec, char *xpath, cvec *nsc, cxobj **xret, cxobj **xerr);
+int netconf_schema_content(clicon_handle h, yang_stmt *ymod, cbuf *cb);
 
 #endif  /* _CLIXON_NETCONF_MONITORING_H_ */
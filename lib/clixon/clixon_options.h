@@ -90,7 +90,8 @@ enum nacm_credentials_t{
 enum datastore_cache{
     DATASTORE_NOCACHE,
     DATASTORE_CACHE,
-    DATASTORE_CACHE_ZEROCOPY
+    DATASTORE_CACHE_ZEROCOPY,
+    DATASTORE_CACHE_COW      /* As cache, but share tree on copy, clone on first write */
 };
 
 /*! yang clixon regexp engine
@@ -101,6 +102,24 @@ enum regexp_mode{
     REGEXP_LIBXML2
 };
 
+/*! Typed snapshot of config options read in per-operation code paths
+ *
+ * Embedded in the handle and populated from the options hash by
+ * clicon_optcache_update(), which runs at the end of clicon_options_main and
+ * after every option write. Reads are plain field accesses instead of a hash
+ * lookup of the option name per call, which showed up in profiles of get and
+ * netconf framing paths.
+ * @see clicon_optcache  for the accessor
+ */
+struct clicon_option_cache{
+    enum datastore_cache    oc_datastore_cache;     /* CLICON_DATASTORE_CACHE */
+    enum regexp_mode        oc_yang_regexp;         /* CLICON_YANG_REGEXP */
+    enum nacm_credentials_t oc_nacm_credentials;    /* CLICON_NACM_CREDENTIALS */
+    int                     oc_autocommit;          /* CLICON_AUTOCOMMIT */
+    int                     oc_netconf_base_capability; /* CLICON_NETCONF_BASE_CAPABILITY */
+};
+typedef struct clicon_option_cache clicon_option_cache;
+
 /*
  * Prototypes
  */
@@ -114,6 +133,9 @@ int clicon_option_add(clicon_handle h, const char *name, char *value);
 /* Initialize options: set defaults, read config-file, etc */
 int clicon_options_main(clicon_handle h);
 
+/* Repopulate the typed option snapshot from the options hash */
+int clicon_optcache_update(clicon_handle h);
+
 /*! Check if a clicon option has a value */
 int clicon_option_exists(clicon_handle h, const char *name);
 
@@ -53,11 +53,33 @@ enum format_enum{
 
 /* Protocol message header */
 struct clicon_msg {
-    uint32_t    op_len;     /* length of whole message: body+header, network byte order. */
+    uint32_t    op_len;     /* length of whole message: body+header, network byte order.
+                               The top bit is the chunked framing flag, see CLICON_MSG_FLAG_MORE */
     uint32_t    op_id;      /* session-id. network byte order. 1..max(u32), can be zero in client hello */
     char        op_body[0]; /* rest of message, actual data */
 };
 
+/* Chunked framing: a message may be sent as a sequence of segments, each with
+ * its own header; op_len has CLICON_MSG_FLAG_MORE set on all but the last
+ * segment and clicon_msg_rcv reassembles them into one message. Used for large
+ * replies so no full contiguous frame is needed on the sending side,
+ * see clicon_msg_send_chunked.
+ */
+#define CLICON_MSG_FLAG_MORE  0x80000000
+#define CLICON_MSG_LEN_MASK   0x7fffffff
+/* Segment body size of chunked messages, see clicon_msg_send_chunked */
+#define CLICON_MSG_CHUNK_SIZE (1024*1024)
+
+/* Liveness probe: a message whose body is exactly CLICON_MSG_PING_BODY
+ * (including terminating NUL) is answered with CLICON_MSG_PONG_BODY directly
+ * in the backend receive path, before any XML parsing, so health-check pollers
+ * do not cost a NETCONF parse/serialize per probe.
+ * @see from_client  backend side
+ * @see clicon_rpc_ping  client side
+ */
+#define CLICON_MSG_PING_BODY "ping"
+#define CLICON_MSG_PONG_BODY "pong"
+
 /*
  * Prototypes
  */ 
@@ -80,10 +102,20 @@ int clicon_rpc_connect_inet(clicon_handle         h,
                             int                  *sock0);
 
 int clicon_rpc(int sock, struct clicon_msg *msg, char **xret, int *eof);
+int clicon_rpc_cbuf(int sock, uint32_t id, cbuf *cb, char **ret, int *eof);
+
+/* Completion callback of clicon_rpc_async: ret is the malloced reply (free
+ * with free), or NULL with eof 1 on peer close, or NULL with eof 0 on timeout
+ */
+typedef int (clicon_rpc_async_cb)(int sock, char *ret, int eof, void *arg);
+int clicon_rpc_async(int sock, struct clicon_msg *msg, int timeout,
+                     clicon_rpc_async_cb *cb, void *arg);
 
 int clicon_rpc1(int sock, cbuf *msgin, cbuf *msgret, int *eof);
 
 int clicon_msg_send(int s, struct clicon_msg *msg);
+int clicon_msg_send_cbuf(int s, uint32_t id, cbuf *cb);
+int clicon_msg_send_chunked(int s, uint32_t id, char *data, uint32_t datalen);
 
 int clicon_msg_send1(int s, cbuf *cb);
 
@@ -42,18 +42,39 @@
 #ifndef _CLIXON_PROTO_CLIENT_H_
 #define _CLIXON_PROTO_CLIENT_H_
 
+/*
+ * Types
+ */
+/* In-process rpc dispatch function, see clicon_rpc_dispatch_register
+ * @param[in]  h        Clixon handle
+ * @param[in]  msg      Encoded request message
+ * @param[in]  arg      Argument given at registration
+ * @param[out] retdata  Reply data as malloc:ed string, free by caller
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+typedef int (*clicon_rpc_dispatch_cb)(clicon_handle h, struct clicon_msg *msg, void *arg, char **retdata);
+
+int clicon_rpc_dispatch_register(clicon_handle h, clicon_rpc_dispatch_cb fn, void *arg);
 int clicon_rpc_connect(clicon_handle h, int *sock0);
+int clicon_rpc_ping(clicon_handle h);
 int clicon_rpc_msg(clicon_handle h, struct clicon_msg *msg, cxobj **xret0);
+int clicon_rpc_msg_cbuf(clicon_handle h, uint32_t session_id, cbuf *cb, cxobj **xret0);
+cbuf *clicon_msg_cbuf_get(clicon_handle h);
+int clicon_msg_cbuf_release(clicon_handle h, cbuf *cb);
 int clicon_rpc_msg_persistent(clicon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
 int clicon_rpc_netconf(clicon_handle h, char *xmlst, cxobj **xret, int *sp);
 int clicon_rpc_netconf_xml(clicon_handle h, cxobj *xml, cxobj **xret, int *sp);
 int clicon_rpc_get_config(clicon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, cxobj **xret);
+int clicon_rpc_get_config_cb(clicon_handle h, char *username, char *db, char *xpath, cvec *nsc, char *defaults, int (*cb)(cxobj *x, void *arg), void *arg, cxobj **xret);
 int clicon_rpc_edit_config(clicon_handle h, char *db, enum operation_type op, 
                            char *xml);
 int clicon_rpc_copy_config(clicon_handle h, char *db1, char *db2);
 int clicon_rpc_delete_config(clicon_handle h, char *db);
 int clicon_rpc_lock(clicon_handle h, char *db);
 int clicon_rpc_unlock(clicon_handle h, char *db);
+int clicon_rpc_get_body(clicon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, cbuf *cb);
+int clicon_rpc_get_reply(clicon_handle h, cxobj *xret, cxobj **xt);
 int clicon_rpc_get(clicon_handle h, char *xpath, cvec *nsc, netconf_content content, int32_t depth, char *defaults, cxobj **xret);
 int clicon_rpc_get_pageable_list(clicon_handle h, char *datastore, char *xpath, 
                                  cvec *nsc, netconf_content content, int32_t depth, char *defaults,
@@ -65,6 +86,10 @@ int clicon_rpc_kill_session(clicon_handle h, uint32_t session_id);
 int clicon_rpc_validate(clicon_handle h, char *db);
 int clicon_rpc_commit(clicon_handle h, int confirmed, int cancel, uint32_t timeout, char *persist, char *persist_id);
 int clicon_rpc_discard_changes(clicon_handle h);
+int clicon_rpc_datastore_serial(clicon_handle h, char *db, uint32_t *serial);
+int clicon_rpc_datastore_diff(clicon_handle h, char *db1, char *db2, cxobj **xd1, cxobj **xd2);
+int clicon_rpc_get_batch(clicon_handle h, char **labels, char **xpaths, size_t nfilter,
+                         cvec *nsc, netconf_content content, char *defaults, cxobj **xt);
 int clicon_rpc_create_subscription(clicon_handle h, char *stream, char *filter, int *s);
 int clicon_rpc_debug(clicon_handle h, int level);
 int clicon_rpc_restconf_debug(clicon_handle h, int level);
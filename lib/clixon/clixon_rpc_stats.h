@@ -0,0 +1,73 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Per-RPC latency breakdown, see CLICON_RPC_STATS
+ */
+#ifndef _CLIXON_RPC_STATS_H
+#define _CLIXON_RPC_STATS_H
+
+/*
+ * Types
+ */
+/* Stages of RPC handling that are timed separately. Stages may nest, eg xmldb
+ * reads made from a plugin callback count in both the plugin and xmldb stage */
+enum rpc_stats_stage{
+    RPC_STATS_PARSE = 0,  /* Decode and yang-bind of incoming message */
+    RPC_STATS_NACM,       /* NACM access control enforcement */
+    RPC_STATS_XMLDB,      /* Datastore reads and writes */
+    RPC_STATS_VALIDATE,   /* Candidate validation */
+    RPC_STATS_PLUGIN,     /* RPC callbacks, including plugins */
+    RPC_STATS_SERIALIZE,  /* Sending the reply */
+    RPC_STATS_STAGE_NR
+};
+
+/*
+ * Prototypes
+ */
+int clixon_rpc_stats_init(clicon_handle h);
+int clixon_rpc_stats_exit(clicon_handle h);
+int clixon_rpc_stats_start(clicon_handle h, char *name);
+int clixon_rpc_stats_name(clicon_handle h, char *name);
+int clixon_rpc_stats_stage_begin(clicon_handle h, enum rpc_stats_stage stage);
+int clixon_rpc_stats_stage_end(clicon_handle h, enum rpc_stats_stage stage);
+int clixon_rpc_stats_done(clicon_handle h);
+int clixon_rpc_stats_get(clicon_handle h, cbuf *cb);
+int clixon_trace_init(clicon_handle h);
+int clixon_trace_start(clicon_handle h, char *ctx);
+int clixon_trace_stop(clicon_handle h);
+int clixon_trace_context(clicon_handle h, char *buf, size_t len);
+int clixon_trace_span(clicon_handle h, const char *name, struct timespec *t0);
+
+#endif /* _CLIXON_RPC_STATS_H */
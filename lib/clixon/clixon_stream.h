@@ -64,11 +64,23 @@ struct stream_subscription{
     void                       *ss_arg;    /* Callback argument */
 };
 
-/* Replay time-series */
+/* One replay time-series sample */
+struct stream_replay_entry{
+    struct timeval re_tv;  /* time index */
+    cxobj         *re_xml; /* event in xml form */
+    size_t         re_sz;  /* approx memory footprint of re_xml, see xml_stats() */
+};
+
+/* Replay time-series: circular buffer of samples in timestamp order.
+ * Subscription setup binary-searches <startTime> instead of scanning a list,
+ * retention and byte-cap trimming pop from the oldest end, see stream_replay_notify
+ */
 struct stream_replay{
-    qelem_t        r_q;   /* queue header */
-    struct timeval r_tv;  /* time index */
-    cxobj         *r_xml; /* event in xml form */
+    struct stream_replay_entry *r_vec;   /* circular entry vector */
+    int                         r_size;  /* allocated entries in r_vec */
+    int                         r_start; /* index in r_vec of oldest entry */
+    int                         r_len;   /* nr of used entries */
+    size_t                      r_bytes; /* sum of entry re_sz */
 };
 
 /* See RFC8040 9.3, stream list, no replay support for now
@@ -80,7 +92,8 @@ struct event_stream{
     struct stream_subscription *es_subscription;
     int                  es_replay_enabled; /* set if replay is enables */
     struct timeval       es_retention; /* replay retention - how much to save */
-    struct stream_replay *es_replay;
+    size_t               es_replay_maxbytes; /* replay buffer byte cap, 0: no cap */
+    struct stream_replay es_replay;
 
 };
 typedef struct event_stream event_stream_t;
@@ -93,6 +106,8 @@ int stream_add(clicon_handle h, const char *name, const char *description, int r
 int stream_delete_all(clicon_handle h, int force);
 int stream_get_xml(clicon_handle h, int access, cbuf *cb);
 int stream_timer_setup(int fd, void *arg);
+int stream_push_periodic(clicon_handle h, char *stream, const char *db);
+int stream_push_timer(int fd, void *arg);
 /* Subscriptions */
 struct stream_subscription *stream_ss_add(clicon_handle h, char *stream,
                   char *xpath, struct timeval *start, struct timeval *stop,
@@ -105,6 +120,7 @@ int stream_ss_delete(clicon_handle h, char *name, stream_fn_t fn, void *arg);
 
 int stream_notify_xml(clicon_handle h, char *stream, cxobj *xml);
 int stream_notify(clicon_handle h, char *stream, const char *event, ...)  __attribute__ ((format (printf, 3, 4)));
+char *stream_notify_cache_get(clicon_handle h, cxobj *xevent);
 
 /* Replay */
 int stream_replay_add(event_stream_t *es, struct timeval *tv, cxobj *xv);
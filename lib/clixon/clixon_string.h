@@ -93,6 +93,7 @@ char  *clixon_string_del_join(char *str1, char *del, char *str2);
 int    clixon_strsplit(char *nodeid, const int delim, char **prefix, char **id);
 int    uri_str2cvec(char *string, char delim1, char delim2, int decode, cvec **cvp);
 int    uri_percent_encode(char **encp, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+size_t xml_chardata_runlen(const char *str, size_t len);
 int    xml_chardata_encode(char **escp, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
 int    xml_chardata_cbuf_append(cbuf *cb, char *str);
 int    xml_chardata_decode(char **escp, const char *fmt,...);
@@ -106,6 +107,8 @@ int    nodeid_split(char *nodeid, char **prefix, char **id);
 char  *clixon_trim(char *str);
 char  *clixon_trim2(char *str, char *trims);
 int    clicon_strcmp(char *s1, char *s2);
+int    clixon_cbuf_append_indent(cbuf *cb, int n);
+int    clixon_cbuf_append_int(cbuf *cb, int64_t i);
 
 
 #ifndef HAVE_STRNDUP
@@ -0,0 +1,67 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Static userspace tracepoints (USDT), see CLIXON_USDT_PROBES in clixon_custom.h
+ *
+ * When enabled, probe sites expand to systemtap sdt.h probes in provider
+ * "clixon" which can be listed and attached with perf, bpftrace or systemtap
+ * on a production binary without log-level changes, eg:
+ *   perf probe -x /usr/local/sbin/clixon_backend sdt_clixon:*
+ *   bpftrace -e 'usdt:/usr/local/sbin/clixon_backend:clixon:xmldb_put { ... }'
+ * When disabled (the default) probe sites compile to nothing.
+ */
+#ifndef _CLIXON_USDT_H
+#define _CLIXON_USDT_H
+
+#ifdef CLIXON_USDT_PROBES
+#include <sys/sdt.h>
+
+#define CLIXON_PROBE(name)                   DTRACE_PROBE(clixon, name)
+#define CLIXON_PROBE1(name, a1)              DTRACE_PROBE1(clixon, name, a1)
+#define CLIXON_PROBE2(name, a1, a2)          DTRACE_PROBE2(clixon, name, a1, a2)
+#define CLIXON_PROBE3(name, a1, a2, a3)      DTRACE_PROBE3(clixon, name, a1, a2, a3)
+#define CLIXON_PROBE4(name, a1, a2, a3, a4)  DTRACE_PROBE4(clixon, name, a1, a2, a3, a4)
+
+#else /* CLIXON_USDT_PROBES */
+
+#define CLIXON_PROBE(name)
+#define CLIXON_PROBE1(name, a1)
+#define CLIXON_PROBE2(name, a1, a2)
+#define CLIXON_PROBE3(name, a1, a2, a3)
+#define CLIXON_PROBE4(name, a1, a2, a3, a4)
+
+#endif /* CLIXON_USDT_PROBES */
+
+#endif /* _CLIXON_USDT_H */
@@ -190,6 +190,14 @@ typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c
 #define XML_FLAG_DEFAULT   0x40 /* Added when a value is set as default @see xml_default */
 #define XML_FLAG_TOP       0x80 /* Top datastore symbol */
 #define XML_FLAG_BODYKEY  0x100 /* Text parsing key to be translated from body to key */
+#define XML_FLAG_SKIP     0x200 /* Subtree pruned from xpath evaluation, see xmldb_nsmap_prefilter */
+#define XML_FLAG_STEAL    0x400 /* Set on a tree top by callers that discard the tree after the
+                                   call: edit paths may move leaf values out of it instead of
+                                   copying, see xml_value_move */
+#define XML_FLAG_VALINTERN 0x800 /* Value is a shared interned string, not a private buffer.
+                                    Maintained by clixon_xml.c, see xml_value_intern */
+#define XML_FLAG_VALINLINE 0x1000 /* Short value stored inline in the node, no buffer.
+                                     Maintained by clixon_xml.c, see xml_value_set */
 
 /*
  * Prototypes
@@ -207,6 +215,7 @@ cvec     *nscache_get_all(cxobj *x);
 int       nscache_set(cxobj *x, char *prefix, char *ns);
 int       nscache_clear(cxobj *x);
 int       nscache_replace(cxobj *x, cvec *ns);
+int       nscache_share(cxobj *x, cxobj *xs);
 cxobj    *xml_parent(cxobj *xn);
 int       xml_parent_set(cxobj *xn, cxobj *parent);
 #ifdef XML_PARENT_CANDIDATE
@@ -220,7 +229,10 @@ int       xml_flag_reset(cxobj *xn, uint16_t flag);
 
 char     *xml_value(cxobj *xn);
 int       xml_value_set(cxobj *xn, char *val);
+int       xml_value_intern(cxobj *xn, char *val);
 int       xml_value_append(cxobj *xn, char *val);
+int       xml_value_cb_steal(cxobj *xn, cbuf **cbp);
+int       xml_value_move(cxobj *xto, cxobj *xfrom);
 enum cxobj_type xml_type(cxobj *xn);
 
 int       xml_child_nr(cxobj *xn);
@@ -231,6 +243,7 @@ cxobj    *xml_child_i_type(cxobj *xn, int i, enum cxobj_type type);
 cxobj    *xml_child_i_set(cxobj *xt, int i, cxobj *xc);
 int       xml_child_order(cxobj *xn, cxobj *xc);
 cxobj    *xml_child_each(cxobj *xparent, cxobj *xprev,  enum cxobj_type type);
+int       xml_child_span(cxobj *xt, cxobj **xp);
 int       xml_child_insert_pos(cxobj *x, cxobj *xc, int i);
 int       xml_childvec_set(cxobj *x, int len);
 cxobj   **xml_childvec_get(cxobj *x);
@@ -247,6 +260,7 @@ cxobj    *xml_wrap_all(cxobj *xp, char *tag);
 cxobj    *xml_wrap(cxobj *xc, char *tag);
 int       xml_purge(cxobj *xc);
 int       xml_child_rm(cxobj *xp, int i);
+int       xml_child_rm_vec(cxobj *xp, cxobj **xvec, int xlen);
 int       xml_rm(cxobj *xc);
 int       xml_rm_children(cxobj *x, enum cxobj_type type);
 int       xml_rootchild(cxobj  *xp, int i, cxobj **xcp);
@@ -286,6 +300,11 @@ int       xml_add_attr(cxobj *xn, char *name, char *value, char *prefix, char *n
 int       clicon_log_xml(int level, cxobj *x, const char *format, ...)  __attribute__ ((format (printf, 3, 4)));
 int       clicon_debug_xml(int dbglevel, cxobj *x, const char *format, ...)  __attribute__ ((format (printf, 3, 4)));
 
+#ifdef XML_LIST_KEYHASH
+int       xml_keyhash_get(cxobj *x, clicon_hash_t **khp, int *nrp);
+int       xml_keyhash_set(cxobj *x, clicon_hash_t *kh, int nr);
+#endif
+
 #ifdef XML_EXPLICIT_INDEX
 int       xml_search_index_p(cxobj *x);
 
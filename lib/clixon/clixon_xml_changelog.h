@@ -42,6 +42,7 @@
  * Prototypes
  */
 int xml_changelog_upgrade(clicon_handle h, cxobj *xn, char *ns, uint16_t op, uint32_t from, uint32_t to, void *arg, cbuf *cbret);
+int xml_changelog_plan_free(clicon_handle h);
 int clixon_xml_changelog_init(clicon_handle h);
 int xml_namespace_vec(clicon_handle h, cxobj *xt, char *ns, cxobj ***vec, size_t *veclen);
 
@@ -40,15 +40,36 @@
 #ifndef _CLIXON_XML_IO_H_
 #define _CLIXON_XML_IO_H_
 
+/*
+ * Types
+ */
+/*! Callback for completed subtrees in streaming parse, see clixon_xml_parse_file_cb
+ * @param[in]  x    Completely parsed XML subtree
+ * @param[in]  arg  Argument passed at registration
+ * @retval     0    OK
+ * @retval    -1    Error: abort parse, clicon_err called
+ */
+typedef int (clixon_xml_parse_cb)(cxobj *x, void *arg);
+
+/*! Incremental XML serializer cursor, see clixon_xml_cursor_new */
+typedef struct xml_serialize_cursor clixon_xml_cursor;
+
 /*
  * Prototypes
  */
 int   clixon_xml2file(FILE *f, cxobj *xn, int level, int pretty, clicon_output_cb *fn, int skiptop, int autocliext);
+int   clixon_xml2file_canonical(FILE *f, cxobj *xn, int level, int pretty, clicon_output_cb *fn,
+                                cvec *nsc, int hoist);
 int   xml_print(FILE *f, cxobj *xn);
 int   xml_dump(FILE  *f, cxobj *x);
 int   clixon_xml2cbuf(cbuf *cb, cxobj *x, int level, int prettyprint, int32_t depth, int skiptop);
 int   xmltree2cbuf(cbuf *cb, cxobj *x, int level);
+clixon_xml_cursor *clixon_xml_cursor_new(cxobj *xn, int level, int pretty, int skiptop);
+int   clixon_xml_cursor_chunk(clixon_xml_cursor *xsc, cbuf *cb, size_t chunksz, int *eofp);
+int   clixon_xml_cursor_free(clixon_xml_cursor *xsc);
 int   clixon_xml_parse_file(FILE *f, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
+int   clixon_xml_parse_file_cb(FILE *f, yang_bind yb, yang_stmt *yspec, cxobj **xt,
+                               clixon_xml_parse_cb *cb, int depth, void *arg, cxobj **xerr);
 int   clixon_xml_parse_string(const char *str, yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr);
 int   clixon_xml_parse_va(yang_bind yb, yang_stmt *yspec, cxobj **xt, cxobj **xerr, 
                         const char *format, ...)  __attribute__ ((format (printf, 5, 6)));
@@ -59,10 +59,12 @@ int     xml_nsctx_add(cvec *nsc, char *prefix, char *ns);
 int     xml_nsctx_node(cxobj *x, cvec **ncp);
 int     xml_nsctx_yang(yang_stmt *yn, cvec **ncp);
 int     xml_nsctx_yangspec(yang_stmt *yspec, cvec **ncp);
+cvec   *xml_nsctx_yangspec_canonical(yang_stmt *yspec);
 int     xml_nsctx_cbuf(cbuf *cb, cvec *nsc);
 
 int     xml2ns(cxobj *x, char *localname, char **ns);
 int     xml2ns_recurse(cxobj *x);
+int     xml_nsctx_populate(cxobj *xt);
 int     xmlns_set(cxobj *x, char *prefix, char *ns);
 int     xmlns_set_all(cxobj *x, cvec  *nsc);
 int     xml2prefix(cxobj *xn, char *ns, char **prefixp);
@@ -47,12 +47,14 @@ typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c
  * Prototypes
  */
 clixon_xvec *clixon_xvec_new(void);
+clixon_xvec *clixon_xvec_new_reserve(int len);
 clixon_xvec *clixon_xvec_dup(clixon_xvec *xv0);
 int          clixon_xvec_free(clixon_xvec *xv);
 int          clixon_xvec_len(clixon_xvec *xv);
 cxobj       *clixon_xvec_i(clixon_xvec *xv, int i);
 int          clixon_xvec_extract(clixon_xvec *xv, cxobj ***xvcec, int *xlen, int *xmax);
 int          clixon_xvec_append(clixon_xvec *xv, cxobj *x);
+int          clixon_xvec_append_vec(clixon_xvec *xv, cxobj **vec, int veclen);
 int          clixon_xvec_prepend(clixon_xvec *xv, cxobj *x);
 int          clixon_xvec_merge(clixon_xvec *xv0, clixon_xvec *xv1);
 int          clixon_xvec_insert_pos(clixon_xvec *xv, cxobj *x, int i);
@@ -215,6 +215,9 @@ int        yang_cv_set(yang_stmt *ys, cg_var *cv);
 cvec      *yang_cvec_get(yang_stmt *ys);
 int        yang_cvec_set(yang_stmt *ys, cvec *cvv);
 cg_var    *yang_cvec_add(yang_stmt *ys, enum cv_type type, char *name);
+int        yang_valcache_lookup(yang_stmt *ys, char *val);
+yang_stmt *yang_valcache_memo_get(yang_stmt *ys, char *val);
+int        yang_valcache_memo_add(yang_stmt *ys, char *val, yang_stmt *ymatch);
 uint16_t   yang_flag_get(yang_stmt *ys, uint16_t flag);
 int        yang_flag_set(yang_stmt *ys, uint16_t flag);
 int        yang_flag_reset(yang_stmt *ys, uint16_t flag);
@@ -222,6 +225,11 @@ char      *yang_when_xpath_get(yang_stmt *ys);
 int        yang_when_xpath_set(yang_stmt *ys, char *xpath);
 cvec      *yang_when_nsc_get(yang_stmt *ys);
 int        yang_when_nsc_set(yang_stmt *ys, cvec *nsc);
+struct xpath_tree; /* Compiled xpath, see clixon_xpath.h */
+struct xpath_tree *yang_xpath_cache_get(yang_stmt *ys);
+int        yang_xpath_cache_set(yang_stmt *ys, struct xpath_tree *xpt);
+cvec      *yang_nscache_get(yang_stmt *ys);
+int        yang_nscache_set(yang_stmt *ys, cvec *nsc);
 const char *yang_filename_get(yang_stmt *ys);
 int        yang_filename_set(yang_stmt *ys, const char *filename);
 int        yang_linenum_get(yang_stmt *ys);
@@ -248,6 +256,7 @@ int        yang_str2key(char *str);
 int        ys_module_by_xml(yang_stmt *ysp, struct xml *xt, yang_stmt **ymodp);
 yang_stmt *ys_module(yang_stmt *ys);
 int        ys_real_module(yang_stmt *ys, yang_stmt **ymod);
+char      *yang_json_modname(yang_stmt *ys);
 yang_stmt *ys_spec(yang_stmt *ys);
 yang_stmt *yang_find(yang_stmt *yn, int keyword, const char *argument);
 int        yang_match(yang_stmt *yn, int keyword, char *argument);
@@ -56,11 +56,14 @@ typedef struct yang_type_cache yang_type_cache;
  * Prototypes
  */
 int        ys_resolve_type(yang_stmt *ys, void *arg);
+int        ys_precompile_regexps(yang_stmt *ys, void *arg);
 int        yang2cv_type(char *ytype, enum cv_type *cv_type);
 char      *cv2yang_type(enum cv_type cv_type);
 yang_stmt *yang_find_identity(yang_stmt *ys, char *identity);
 yang_stmt *yang_find_identity_nsc(yang_stmt *yspec, char *identity, cvec *nsc);
 int        ys_cv_validate(clicon_handle h, cg_var *cv, yang_stmt *ys, yang_stmt **ysub, char **reason);
+int        ys_cv_validate_batch(clicon_handle h, cg_var **cvs, size_t ncv, yang_stmt *ys,
+                                int *failidx, char **reason);
 int        clicon_type2cv(char *type, char *rtype, yang_stmt *ys, enum cv_type *cvtype);
 int        yang_type_get(yang_stmt *ys, char **otype, yang_stmt **restype, 
                          int *options, cvec **cvv,
@@ -0,0 +1,969 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * CBOR support functions.
+ * RFC 8949 Concise Binary Object Representation (CBOR)
+ * RFC 9254 Encoding of Data Modeled with YANG in CBOR
+ * Uses the RFC 9254 "names" member encoding: keys are text strings
+ * module:name / name following the same module qualification rules as
+ * RFC 7951 JSON, so no SID file registry is needed. Numeric and boolean
+ * leafs are encoded as native CBOR types from the yang type.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <syslog.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_queue.h"
+#include "clixon_string.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_yang_type.h"
+#include "clixon_yang_module.h"
+#include "clixon_xml_sort.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_map.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_json.h"
+#include "clixon_cbor.h"
+
+/* CBOR major types, RFC 8949 Sec 3.1 */
+#define CBOR_UINT   0
+#define CBOR_NEGINT 1
+#define CBOR_BYTES  2
+#define CBOR_TEXT   3
+#define CBOR_ARRAY  4
+#define CBOR_MAP    5
+#define CBOR_TAG    6
+#define CBOR_SIMPLE 7
+
+/* Simple values of major type 7, RFC 8949 Sec 3.3 */
+#define CBOR_FALSE  20
+#define CBOR_TRUE   21
+#define CBOR_NULL   22
+
+/* Decimal fraction tag, RFC 8949 Sec 3.4.4, used for yang decimal64 */
+#define CBOR_TAG_DECFRAC 4
+
+/*! Append a CBOR head: major type and argument with shortest-form length
+ * @param[out] cb    Output buffer
+ * @param[in]  major CBOR major type 0-7
+ * @param[in]  val   Argument (length, value or simple value)
+ * @retval     0     OK
+ */
+static int
+cbor_head(cbuf    *cb,
+          uint8_t  major,
+          uint64_t val)
+{
+    uint8_t b[9];
+    size_t  n;
+    int     i;
+
+    if (val < 24){
+        b[0] = (major<<5) | val;
+        n = 1;
+    }
+    else if (val <= 0xff){
+        b[0] = (major<<5) | 24;
+        b[1] = val;
+        n = 2;
+    }
+    else if (val <= 0xffff){
+        b[0] = (major<<5) | 25;
+        for (i=0; i<2; i++)
+            b[1+i] = (val >> (8*(1-i))) & 0xff;
+        n = 3;
+    }
+    else if (val <= 0xffffffff){
+        b[0] = (major<<5) | 26;
+        for (i=0; i<4; i++)
+            b[1+i] = (val >> (8*(3-i))) & 0xff;
+        n = 5;
+    }
+    else{
+        b[0] = (major<<5) | 27;
+        for (i=0; i<8; i++)
+            b[1+i] = (val >> (8*(7-i))) & 0xff;
+        n = 9;
+    }
+    cbuf_append_buf(cb, b, n);
+    return 0;
+}
+
+/*! Append a CBOR text string
+ * @param[out] cb   Output buffer
+ * @param[in]  str  NUL-terminated UTF-8 string
+ * @retval     0    OK
+ */
+static int
+cbor_text(cbuf       *cb,
+          const char *str)
+{
+    size_t len = strlen(str);
+
+    cbor_head(cb, CBOR_TEXT, len);
+    cbuf_append_buf(cb, (void*)str, len);
+    return 0;
+}
+
+/*! Append a CBOR signed integer (major type 0 or 1)
+ */
+static int
+cbor_int(cbuf   *cb,
+         int64_t v)
+{
+    if (v < 0)
+        return cbor_head(cb, CBOR_NEGINT, (uint64_t)(-1-v));
+    return cbor_head(cb, CBOR_UINT, (uint64_t)v);
+}
+
+/*! Encode a leaf body as a typed CBOR value
+ * Integer, boolean and empty yang types become native CBOR values,
+ * decimal64 becomes a decimal fraction (tag 4), everything else a text
+ * string. Any value that does not parse as its yang type falls back to a
+ * text string rather than failing.
+ * @param[out] cb   Output buffer
+ * @param[in]  body Leaf body string or NULL
+ * @param[in]  y    Yang spec of leaf, or NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml2json_encode_leafs for the JSON counterpart
+ */
+static int
+cbor_encode_leaf(cbuf      *cb,
+                 char      *body,
+                 yang_stmt *y)
+{
+    int           retval = -1;
+    yang_stmt    *ytype = NULL;
+    char         *origtype = NULL;
+    enum cv_type  cvtype;
+    char         *ep = NULL;
+    long long     ll;
+    unsigned long long ull;
+    int64_t       mant;
+    int64_t       exp;
+    char         *dot;
+
+    if (y == NULL || body == NULL){
+        if (body)
+            cbor_text(cb, body);
+        else
+            cbor_head(cb, CBOR_SIMPLE, CBOR_NULL);
+        goto ok;
+    }
+    if (yang_type_get(y, &origtype, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+        goto done;
+    cvtype = yang_type2cv(y);
+    switch (cvtype){
+    case CGV_INT8:
+    case CGV_INT16:
+    case CGV_INT32:
+    case CGV_INT64:
+        errno = 0;
+        ll = strtoll(body, &ep, 10);
+        if (errno || ep == body || *ep != '\0'){
+            cbor_text(cb, body);
+            break;
+        }
+        cbor_int(cb, ll);
+        break;
+    case CGV_UINT8:
+    case CGV_UINT16:
+    case CGV_UINT32:
+    case CGV_UINT64:
+        errno = 0;
+        ull = strtoull(body, &ep, 10);
+        if (errno || ep == body || *ep != '\0'){
+            cbor_text(cb, body);
+            break;
+        }
+        cbor_head(cb, CBOR_UINT, ull);
+        break;
+    case CGV_DEC64:
+        /* decimal64 as decimal fraction: tag 4, [exponent, mantissa] */
+        if ((dot = strchr(body, '.')) != NULL)
+            exp = -(int64_t)strlen(dot+1);
+        else
+            exp = 0;
+        errno = 0;
+        if (dot){
+            char mbuf[32];
+            size_t ilen = dot - body;
+
+            if (ilen + strlen(dot+1) + 1 > sizeof(mbuf)){
+                cbor_text(cb, body);
+                break;
+            }
+            memcpy(mbuf, body, ilen);
+            strcpy(mbuf+ilen, dot+1);
+            mant = strtoll(mbuf, &ep, 10);
+            if (errno || ep == mbuf || *ep != '\0'){
+                cbor_text(cb, body);
+                break;
+            }
+        }
+        else{
+            mant = strtoll(body, &ep, 10);
+            if (errno || ep == body || *ep != '\0'){
+                cbor_text(cb, body);
+                break;
+            }
+        }
+        cbor_head(cb, CBOR_TAG, CBOR_TAG_DECFRAC);
+        cbor_head(cb, CBOR_ARRAY, 2);
+        cbor_int(cb, exp);
+        cbor_int(cb, mant);
+        break;
+    case CGV_BOOL:
+        cbor_head(cb, CBOR_SIMPLE, strcmp(body, "true")==0 ? CBOR_TRUE : CBOR_FALSE);
+        break;
+    case CGV_VOID: /* yang empty type */
+        cbor_head(cb, CBOR_SIMPLE, CBOR_NULL);
+        break;
+    default:
+        cbor_text(cb, body);
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (origtype)
+        free(origtype);
+    return retval;
+}
+
+/*! Compute CBOR member key module name of x given ancestor module name
+ * Same qualification rule as RFC 7951: prefix with module name when the
+ * module differs from the ancestor context.
+ * @param[in]  x        XML node
+ * @param[in]  modname0 Module name of ancestor context or NULL
+ * @retval     modname  Module name to prefix key with, or NULL if same
+ * @see xml2json1_cbuf for the same rule in the JSON encoder
+ */
+static char *
+cbor_key_modname(cxobj *x,
+                 char  *modname0)
+{
+    yang_stmt *ys;
+    yang_stmt *ymod = NULL;
+    char      *modname;
+
+    if ((ys = xml_spec(x)) == NULL)
+        return xml_prefix(x); /* No yang: keep XML prefix as-is */
+    if (ys_real_module(ys, &ymod) < 0 || ymod == NULL)
+        return NULL;
+    modname = yang_argument_get(ymod);
+    /* Special case for ietf-netconf -> ietf-restconf translation,
+     * see also json_xmlns_translate() */
+    if (strcmp(modname, "ietf-netconf") == 0)
+        modname = "ietf-restconf";
+    if (modname0 && strcmp(modname, modname0) == 0)
+        return NULL;
+    return modname;
+}
+
+/*! Do two XML siblings belong to the same CBOR member group?
+ */
+static int
+cbor_same_group(cxobj *a,
+                cxobj *b)
+{
+    char *pa = xml_prefix(a);
+    char *pb = xml_prefix(b);
+
+    if (strcmp(xml_name(a), xml_name(b)) != 0)
+        return 0;
+    if (pa == NULL && pb == NULL)
+        return 1;
+    if (pa == NULL || pb == NULL)
+        return 0;
+    return strcmp(pa, pb) == 0;
+}
+
+static int cbor_encode_obj(cbuf *cb, cxobj *x, char *modname0);
+
+/*! Encode a group of same-named siblings as one CBOR map member
+ * @param[out] cb       Output buffer
+ * @param[in]  grp      Vector of same-named sibling elements
+ * @param[in]  n        Length of grp
+ * @param[in]  modname0 Module name of ancestor context or NULL
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+cbor_encode_group(cbuf   *cb,
+                  cxobj **grp,
+                  size_t  n,
+                  char   *modname0)
+{
+    int        retval = -1;
+    char      *modname;
+    yang_stmt *ys;
+    int        isarray;
+    size_t     i;
+
+    modname = cbor_key_modname(grp[0], modname0);
+    if (modname){
+        cbor_head(cb, CBOR_TEXT, strlen(modname) + 1 + strlen(xml_name(grp[0])));
+        cbuf_append_buf(cb, modname, strlen(modname));
+        cbuf_append(cb, ':');
+        cbuf_append_buf(cb, xml_name(grp[0]), strlen(xml_name(grp[0])));
+        modname0 = modname;
+    }
+    else{
+        cbor_text(cb, xml_name(grp[0]));
+        if ((ys = xml_spec(grp[0])) != NULL){
+            yang_stmt *ymod = NULL;
+
+            if (ys_real_module(ys, &ymod) == 0 && ymod)
+                modname0 = yang_argument_get(ymod);
+        }
+    }
+    /* Lists and leaf-lists are always arrays, as is any duplicated member */
+    ys = xml_spec(grp[0]);
+    isarray = n > 1 ||
+        (ys && (yang_keyword_get(ys) == Y_LIST || yang_keyword_get(ys) == Y_LEAF_LIST));
+    if (isarray)
+        cbor_head(cb, CBOR_ARRAY, n);
+    for (i=0; i<n; i++)
+        if (cbor_encode_obj(cb, grp[i], modname0) < 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Encode a vector of sibling elements as a CBOR map
+ * Consecutive same-named siblings are grouped into one member (an array).
+ * @param[out] cb       Output buffer
+ * @param[in]  vec      Vector of sibling elements
+ * @param[in]  veclen   Length of vec
+ * @param[in]  modname0 Module name of ancestor context or NULL
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+cbor_encode_siblings(cbuf   *cb,
+                     cxobj **vec,
+                     size_t  veclen,
+                     char   *modname0)
+{
+    int    retval = -1;
+    size_t ngroups = 0;
+    size_t i;
+    size_t j;
+
+    for (i=0; i<veclen; i=j){
+        for (j=i+1; j<veclen && cbor_same_group(vec[i], vec[j]); j++)
+            ;
+        ngroups++;
+    }
+    cbor_head(cb, CBOR_MAP, ngroups);
+    for (i=0; i<veclen; i=j){
+        for (j=i+1; j<veclen && cbor_same_group(vec[i], vec[j]); j++)
+            ;
+        if (cbor_encode_group(cb, &vec[i], j-i, modname0) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Encode the value of one XML element as a CBOR data item
+ * @param[out] cb       Output buffer
+ * @param[in]  x        XML element
+ * @param[in]  modname0 Module name of x:s context
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+cbor_encode_obj(cbuf  *cb,
+                cxobj *x,
+                char  *modname0)
+{
+    int        retval = -1;
+    yang_stmt *ys;
+    cxobj    **vec = NULL;
+    size_t     veclen;
+    size_t     i;
+    cxobj     *xc;
+
+    veclen = xml_child_nr_type(x, CX_ELMNT);
+    if (veclen == 0){
+        ys = xml_spec(x);
+        if (xml_body_get(x) != NULL || (ys && (yang_keyword_get(ys) == Y_LEAF ||
+                                               yang_keyword_get(ys) == Y_LEAF_LIST))){
+            if (cbor_encode_leaf(cb, xml_body(x), ys) < 0)
+                goto done;
+        }
+        else if (ys == NULL || yang_keyword_get(ys) == Y_CONTAINER ||
+                 yang_keyword_get(ys) == Y_ANYXML || yang_keyword_get(ys) == Y_ANYDATA)
+            cbor_head(cb, CBOR_MAP, 0); /* empty container */
+        else
+            cbor_head(cb, CBOR_SIMPLE, CBOR_NULL);
+        goto ok;
+    }
+    if ((vec = malloc(veclen * sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    i = 0;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        vec[i++] = xc;
+    if (cbor_encode_siblings(cb, vec, veclen, modname0) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Translate an XML tree to CBOR in a CLIgen buffer
+ *
+ * @param[out] cb      Cligen buffer holding the binary CBOR result
+ * @param[in]  x       XML tree
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @code
+ *   cbuf *cb = cbuf_new();
+ *   if (clixon_cbor2cbuf(cb, x, 0) < 0)
+ *     goto err;
+ *   write(f, cbuf_get(cb), cbuf_len(cb));
+ *   cbuf_free(cb);
+ * @endcode
+ * @see clixon_json2cbuf for the JSON counterpart
+ */
+int
+clixon_cbor2cbuf(cbuf  *cb,
+                 cxobj *x,
+                 int    skiptop)
+{
+    int    retval = -1;
+    cxobj *vec1[1];
+
+    if (skiptop){
+        if (cbor_encode_obj(cb, x, NULL) < 0)
+            goto done;
+    }
+    else{
+        vec1[0] = x;
+        if (cbor_encode_siblings(cb, vec1, 1, NULL) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Translate a vector of XML trees to CBOR in a CLIgen buffer
+ * @param[out] cb     Cligen buffer holding the binary CBOR result
+ * @param[in]  vec    Vector of XML trees
+ * @param[in]  veclen Length of vec
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml2json_cbuf_vec for the JSON counterpart
+ */
+int
+xml2cbor_cbuf_vec(cbuf   *cb,
+                  cxobj **vec,
+                  size_t  veclen)
+{
+    return cbor_encode_siblings(cb, vec, veclen, NULL);
+}
+
+/*
+ * Decoding
+ */
+/* Decode cursor over a CBOR byte buffer */
+struct cbor_cursor{
+    const unsigned char *cr_buf;
+    size_t               cr_len;
+    size_t               cr_pos;
+};
+
+/*! Read one CBOR head: major type, additional info and argument
+ * @param[in]  cr    Decode cursor
+ * @param[out] major CBOR major type 0-7
+ * @param[out] ai    Additional info 0-27 (to distinguish simple from float)
+ * @param[out] val   Argument value
+ * @retval     0     OK
+ * @retval    -1     Error: truncated, malformed or indefinite length
+ */
+static int
+cbor_decode_head(struct cbor_cursor *cr,
+                 uint8_t            *major,
+                 uint8_t            *ai,
+                 uint64_t           *val)
+{
+    uint8_t b;
+    int     n;
+    int     i;
+
+    if (cr->cr_pos >= cr->cr_len){
+        clicon_err(OE_XML, 0, "CBOR truncated at byte %zu", cr->cr_pos);
+        return -1;
+    }
+    b = cr->cr_buf[cr->cr_pos++];
+    *major = b >> 5;
+    *ai = b & 0x1f;
+    if (*ai < 24){
+        *val = *ai;
+        return 0;
+    }
+    switch (*ai){
+    case 24: n = 1; break;
+    case 25: n = 2; break;
+    case 26: n = 4; break;
+    case 27: n = 8; break;
+    case 31:
+        clicon_err(OE_XML, 0, "CBOR indefinite lengths not supported");
+        return -1;
+    default:
+        clicon_err(OE_XML, 0, "CBOR malformed additional info %u", *ai);
+        return -1;
+    }
+    if (cr->cr_pos + n > cr->cr_len){
+        clicon_err(OE_XML, 0, "CBOR truncated at byte %zu", cr->cr_pos);
+        return -1;
+    }
+    *val = 0;
+    for (i=0; i<n; i++)
+        *val = (*val << 8) | cr->cr_buf[cr->cr_pos++];
+    return 0;
+}
+
+/*! Append a string body to an XML element
+ */
+static int
+cbor_body_set(cxobj      *x,
+              const char *str)
+{
+    cxobj *xb;
+
+    if ((xb = xml_new("body", x, CX_BODY)) == NULL)
+        return -1;
+    if (xml_value_append(xb, (char*)str) < 0)
+        return -1;
+    return 0;
+}
+
+static int cbor_decode_value(struct cbor_cursor *cr, cxobj *parent, char *name, char *prefix);
+
+/*! Decode one CBOR data item into XML element x
+ * @param[in]     cr  Decode cursor
+ * @param[in,out] x   XML element to populate with body or children
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+static int
+cbor_decode_item(struct cbor_cursor *cr,
+                 cxobj              *x)
+{
+    int      retval = -1;
+    uint8_t  major;
+    uint8_t  ai;
+    uint64_t val;
+    uint64_t i;
+    char     numbuf[64];
+    char    *str = NULL;
+    char    *key = NULL;
+    char    *prefix = NULL;
+    char    *id = NULL;
+
+    if (cbor_decode_head(cr, &major, &ai, &val) < 0)
+        goto done;
+    switch (major){
+    case CBOR_UINT:
+        snprintf(numbuf, sizeof(numbuf), "%llu", (unsigned long long)val);
+        if (cbor_body_set(x, numbuf) < 0)
+            goto done;
+        break;
+    case CBOR_NEGINT:
+        if (val == UINT64_MAX){
+            clicon_err(OE_XML, 0, "CBOR negative integer out of range");
+            goto done;
+        }
+        snprintf(numbuf, sizeof(numbuf), "-%llu", (unsigned long long)(val+1));
+        if (cbor_body_set(x, numbuf) < 0)
+            goto done;
+        break;
+    case CBOR_TEXT:
+        if (cr->cr_pos + val > cr->cr_len){
+            clicon_err(OE_XML, 0, "CBOR truncated at byte %zu", cr->cr_pos);
+            goto done;
+        }
+        if ((str = malloc(val+1)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memcpy(str, &cr->cr_buf[cr->cr_pos], val);
+        str[val] = '\0';
+        cr->cr_pos += val;
+        if (val && cbor_body_set(x, str) < 0)
+            goto done;
+        break;
+    case CBOR_MAP:
+        for (i=0; i<val; i++){
+            uint8_t  kmajor;
+            uint8_t  kai;
+            uint64_t klen;
+
+            if (cbor_decode_head(cr, &kmajor, &kai, &klen) < 0)
+                goto done;
+            if (kmajor != CBOR_TEXT){
+                clicon_err(OE_XML, 0, "CBOR map key is not a text string (SID keys not supported)");
+                goto done;
+            }
+            if (cr->cr_pos + klen > cr->cr_len){
+                clicon_err(OE_XML, 0, "CBOR truncated at byte %zu", cr->cr_pos);
+                goto done;
+            }
+            if ((key = malloc(klen+1)) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memcpy(key, &cr->cr_buf[cr->cr_pos], klen);
+            key[klen] = '\0';
+            cr->cr_pos += klen;
+            if (nodeid_split(key, &prefix, &id) < 0)
+                goto done;
+            if (cbor_decode_value(cr, x, id, prefix) < 0)
+                goto done;
+            free(key);    key = NULL;
+            if (prefix){
+                free(prefix);
+                prefix = NULL;
+            }
+            free(id);     id = NULL;
+        }
+        break;
+    case CBOR_TAG:
+        if (val == CBOR_TAG_DECFRAC){
+            uint8_t  m2, a2;
+            uint64_t v2;
+            int64_t  exp;
+            int64_t  mant;
+            int      k;
+
+            if (cbor_decode_head(cr, &m2, &a2, &v2) < 0)
+                goto done;
+            if (m2 != CBOR_ARRAY || v2 != 2){
+                clicon_err(OE_XML, 0, "CBOR decimal fraction is not a 2-element array");
+                goto done;
+            }
+            if (cbor_decode_head(cr, &m2, &a2, &v2) < 0)
+                goto done;
+            if (m2 == CBOR_UINT)
+                exp = v2;
+            else if (m2 == CBOR_NEGINT)
+                exp = -1-(int64_t)v2;
+            else{
+                clicon_err(OE_XML, 0, "CBOR decimal fraction exponent is not an integer");
+                goto done;
+            }
+            if (cbor_decode_head(cr, &m2, &a2, &v2) < 0)
+                goto done;
+            if (m2 == CBOR_UINT)
+                mant = v2;
+            else if (m2 == CBOR_NEGINT)
+                mant = -1-(int64_t)v2;
+            else{
+                clicon_err(OE_XML, 0, "CBOR decimal fraction mantissa is not an integer");
+                goto done;
+            }
+            if (exp >= 0){
+                k = snprintf(numbuf, sizeof(numbuf), "%lld", (long long)mant);
+                for (; exp > 0 && k < (int)sizeof(numbuf)-1; exp--)
+                    numbuf[k++] = '0';
+                numbuf[k] = '\0';
+            }
+            else{
+                char   digits[32];
+                int    dlen;
+                int    neg = mant < 0;
+                int    fd = -exp;
+                int    j;
+
+                dlen = snprintf(digits, sizeof(digits), "%lld",
+                                neg ? (long long)-mant : (long long)mant);
+                k = 0;
+                if (neg)
+                    numbuf[k++] = '-';
+                if (dlen <= fd){
+                    numbuf[k++] = '0';
+                    numbuf[k++] = '.';
+                    for (j=0; j<fd-dlen; j++)
+                        numbuf[k++] = '0';
+                    for (j=0; j<dlen; j++)
+                        numbuf[k++] = digits[j];
+                }
+                else{
+                    for (j=0; j<dlen-fd; j++)
+                        numbuf[k++] = digits[j];
+                    numbuf[k++] = '.';
+                    for (; j<dlen; j++)
+                        numbuf[k++] = digits[j];
+                }
+                numbuf[k] = '\0';
+            }
+            if (cbor_body_set(x, numbuf) < 0)
+                goto done;
+        }
+        else{ /* Unknown tag: decode tagged content transparently */
+            if (cbor_decode_item(cr, x) < 0)
+                goto done;
+        }
+        break;
+    case CBOR_SIMPLE:
+        if (ai < 24 || ai == 24){
+            switch (val){
+            case CBOR_FALSE:
+                if (cbor_body_set(x, "false") < 0)
+                    goto done;
+                break;
+            case CBOR_TRUE:
+                if (cbor_body_set(x, "true") < 0)
+                    goto done;
+                break;
+            case CBOR_NULL:
+            case 23: /* undefined */
+                break; /* empty leaf */
+            default:
+                clicon_err(OE_XML, 0, "CBOR unsupported simple value %llu",
+                           (unsigned long long)val);
+                goto done;
+            }
+        }
+        else{
+            clicon_err(OE_XML, 0, "CBOR floating point not supported by yang");
+            goto done;
+        }
+        break;
+    case CBOR_ARRAY: /* array only valid as a member value, see cbor_decode_value */
+    case CBOR_BYTES:
+    default:
+        clicon_err(OE_XML, 0, "CBOR unsupported item, major type %u", major);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (str)
+        free(str);
+    if (key)
+        free(key);
+    if (prefix)
+        free(prefix);
+    if (id)
+        free(id);
+    return retval;
+}
+
+/*! Decode the value of a CBOR map member into child elements of parent
+ * An array value becomes several same-named siblings (yang list/leaf-list),
+ * any other value a single element.
+ * @param[in]     cr     Decode cursor
+ * @param[in,out] parent Parent XML element
+ * @param[in]     name   Member name
+ * @param[in]     prefix Member module prefix or NULL
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+cbor_decode_value(struct cbor_cursor *cr,
+                  cxobj              *parent,
+                  char               *name,
+                  char               *prefix)
+{
+    int      retval = -1;
+    cxobj   *x;
+    uint64_t i;
+
+    if (cr->cr_pos < cr->cr_len &&
+        (cr->cr_buf[cr->cr_pos] >> 5) == CBOR_ARRAY){
+        uint8_t  major;
+        uint8_t  ai;
+        uint64_t val;
+
+        if (cbor_decode_head(cr, &major, &ai, &val) < 0)
+            goto done;
+        for (i=0; i<val; i++){
+            if ((x = xml_new(name, parent, CX_ELMNT)) == NULL)
+                goto done;
+            if (prefix && xml_prefix_set(x, prefix) < 0)
+                goto done;
+            if (cbor_decode_item(cr, x) < 0)
+                goto done;
+        }
+    }
+    else{
+        if ((x = xml_new(name, parent, CX_ELMNT)) == NULL)
+            goto done;
+        if (prefix && xml_prefix_set(x, prefix) < 0)
+            goto done;
+        if (cbor_decode_item(cr, x) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Parse a CBOR buffer and return an XML tree
+ *
+ * Expects the RFC 9254 "names" member encoding: map keys are text strings
+ * module:name / name. After decode, namespaces are translated and yang
+ * bound the same way as for RFC 7951 JSON.
+ * @param[in]     buf   Buffer containing binary CBOR
+ * @param[in]     len   Length of buf
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification, mandatory for module->xmlns translation
+ * @param[in,out] xt    Top object, if not exists, on success it is created with name 'top'
+ * @param[out]    xerr  Reason for invalid returned as netconf err msg
+ * @retval        1     OK and valid
+ * @retval        0     Invalid (only if yang spec) w xerr set
+ * @retval       -1     Error with clicon_err called
+ * @see clixon_json_parse_string for the JSON counterpart
+ * @see RFC 9254
+ */
+int
+clixon_cbor_parse_buf(const unsigned char *buf,
+                      size_t               len,
+                      yang_bind            yb,
+                      yang_stmt           *yspec,
+                      cxobj              **xt,
+                      cxobj              **xerr)
+{
+    int                retval = -1;
+    struct cbor_cursor cr = {0,};
+    int                n0;
+    int                i;
+    cxobj             *x;
+    int                ret;
+    int                failed = 0;
+
+    if (xt == NULL){
+        clicon_err(OE_XML, EINVAL, "xt is NULL");
+        return -1;
+    }
+    if (*xt == NULL){
+        if ((*xt = xml_new("top", NULL, CX_ELMNT)) == NULL)
+            return -1;
+    }
+    cr.cr_buf = buf;
+    cr.cr_len = len;
+    n0 = xml_child_nr(*xt);
+    if (cbor_decode_item(&cr, *xt) < 0)
+        goto done;
+    if (cr.cr_pos != cr.cr_len){
+        clicon_err(OE_XML, 0, "CBOR trailing bytes after top-level item");
+        goto done;
+    }
+    /* Traverse new objects, as in _json_parse */
+    for (i = n0; i < xml_child_nr(*xt); i++){
+        if ((x = xml_child_i(*xt, i)) == NULL || xml_type(x) != CX_ELMNT)
+            continue;
+        if ((ret = json_xmlns_translate(yspec, x, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        switch (yb){
+        case YB_PARENT:
+            if ((ret = xml_bind_yang0(NULL, x, yb, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        case YB_MODULE_NEXT:
+            if ((ret = xml_bind_yang(NULL, x, YB_MODULE, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        case YB_MODULE:
+            if ((ret = xml_bind_yang0(NULL, x, yb, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        case YB_NONE:
+            break;
+        case YB_RPC:
+            if ((ret = xml_bind_yang_rpc(NULL, x, yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                failed++;
+            break;
+        }
+        if ((ret = json2xml_decode(x, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (failed)
+        goto fail;
+    if (yb != YB_NONE)
+        if (xml_sort_recurse(*xt) < 0)
+            goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
@@ -44,6 +44,7 @@
 #include <assert.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -80,7 +81,10 @@
 
 #define chandle(ch) (assert(clixon_client_handle_check(ch)==0),(struct clixon_client_handle *)(ch))
 
-/*! Internal structure of clixon client handle. 
+/* Max number of idle kept-alive connections in the client connection pool */
+#define CLIXON_CLIENT_POOL_MAX 8
+
+/*! Internal structure of clixon client handle.
  */
 struct clixon_client_handle{
     uint32_t           cch_magic;  /* magic number */
@@ -88,8 +92,20 @@ struct clixon_client_handle{
     int                cch_socket; /* Input/output socket */
     int                cch_pid;    /* Sub-process-id Only applies for NETCONF/SSH */
     int                cch_locked; /* State variable: 1 means locked */
+    char              *cch_dest;   /* Destination (pool key), or NULL */
+    struct clixon_client_handle *cch_next; /* Next idle connection in pool */
 };
 
+/* Pool of idle connections kept alive across connect/disconnect cycles.
+ * clixon_client_connect checks out a matching warm connection instead of
+ * paying connect (and for netconf/ssh types: sub-process fork) per operation;
+ * clixon_client_disconnect returns the connection here. Concurrent operations
+ * each check out their own connection: the underlying protocol is synchronous
+ * request/reply per socket.
+ */
+static struct clixon_client_handle *_client_pool = NULL;
+static int                          _client_pool_len = 0;
+
 /*! Check struct magic number for sanity checks
  * @param[in]  h   Clicon client handle
  * @retval     0   Sanity check OK
@@ -104,6 +120,107 @@ clixon_client_handle_check(clixon_client_handle ch)
     return cch->cch_magic == CLIXON_CLIENT_MAGIC ? 0 : -1;
 }
 
+/*! Actually close a client connection and free the handle
+ * @param[in]  cch  Clixon client handle (struct)
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+clixon_client_close1(struct clixon_client_handle *cch)
+{
+    int retval = -1;
+
+    switch(cch->cch_type){
+    case CLIXON_CLIENT_IPC:
+        close(cch->cch_socket);
+        break;
+    case CLIXON_CLIENT_SSH:
+    case CLIXON_CLIENT_NETCONF:
+        if (clixon_proc_socket_close(cch->cch_pid,
+                                     cch->cch_socket) < 0)
+            goto done;
+        break;
+    }
+    if (cch->cch_dest)
+        free(cch->cch_dest);
+    free(cch);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check out an idle pooled connection matching socket type and destination
+ *
+ * Stale connections (peer closed while idle) are detected with a non-blocking
+ * peek and closed, so a checked-out connection is believed live.
+ * @param[in]  socktype Type of socket, internal/external/netconf/ssh
+ * @param[in]  dest     Destination for some types, or NULL
+ * @retval     cch      Warm connection, unlinked from pool
+ * @retval     NULL     No matching idle connection
+ */
+static struct clixon_client_handle *
+clixon_client_pool_get(clixon_client_type socktype,
+                       const char        *dest)
+{
+    struct clixon_client_handle **prev = &_client_pool;
+    struct clixon_client_handle  *cch;
+    char                          buf;
+    ssize_t                       n;
+
+    while ((cch = *prev) != NULL){
+        if (cch->cch_type != socktype ||
+            (dest == NULL) != (cch->cch_dest == NULL) ||
+            (dest && strcmp(dest, cch->cch_dest) != 0)){
+            prev = &cch->cch_next;
+            continue;
+        }
+        *prev = cch->cch_next;
+        cch->cch_next = NULL;
+        _client_pool_len--;
+        n = recv(cch->cch_socket, &buf, 1, MSG_PEEK|MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)){
+            /* Peer closed while idle: discard and keep looking */
+            clixon_client_close1(cch);
+            continue;
+        }
+        return cch;
+    }
+    return NULL;
+}
+
+/*! Return a connection to the pool for later reuse
+ * @param[in]  cch  Clixon client handle (struct)
+ * @retval     1    Pooled, caller must not close or free
+ * @retval     0    Not pooled (pool full), caller closes as usual
+ */
+static int
+clixon_client_pool_put(struct clixon_client_handle *cch)
+{
+    if (_client_pool_len >= CLIXON_CLIENT_POOL_MAX)
+        return 0;
+    cch->cch_next = _client_pool;
+    _client_pool = cch;
+    _client_pool_len++;
+    return 1;
+}
+
+/*! Close all idle pooled client connections
+ * @retval     0    OK
+ * @see clixon_client_terminate  which calls this
+ */
+int
+clixon_client_pool_drain(void)
+{
+    struct clixon_client_handle *cch;
+
+    while ((cch = _client_pool) != NULL){
+        _client_pool = cch->cch_next;
+        clixon_client_close1(cch);
+    }
+    _client_pool_len = 0;
+    return 0;
+}
+
 /*! Initialize Clixon client API
  * @param[in]  config_file Clixon configuration file, or NULL for default
  * @retval     h        Clixon handler
@@ -136,6 +253,7 @@ int
 clixon_client_terminate(clicon_handle h)
 {
     clicon_debug(1, "%s", __FUNCTION__);
+    clixon_client_pool_drain();
     clicon_handle_exit(h);
     return 0;
 }
@@ -345,8 +463,11 @@ clixon_client_connect(clicon_handle      h,
 {
     struct clixon_client_handle *cch = NULL;
     size_t                       sz = sizeof(struct clixon_client_handle);
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
+    /* Reuse a warm pooled connection if one matches, skipping connect/fork */
+    if ((cch = clixon_client_pool_get(socktype, dest)) != NULL)
+        goto done;
     if ((cch = malloc(sz)) == NULL){
         clicon_err(OE_NETCONF, errno, "malloc");
         goto done;
@@ -354,6 +475,10 @@ clixon_client_connect(clicon_handle      h,
     memset(cch, 0, sz);
     cch->cch_magic   = CLIXON_CLIENT_MAGIC;
     cch->cch_type = socktype;
+    if (dest && (cch->cch_dest = strdup(dest)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto err;
+    }
     switch (socktype){
     case CLIXON_CLIENT_IPC:
         if (clicon_rpc_connect(h, &cch->cch_socket) < 0)
@@ -383,17 +508,17 @@ clixon_client_connect(clicon_handle      h,
     goto done;
 }
 
-/*! Connect client to clixon backend according to config and return a socket
+/*! Disconnect client, the connection is kept warm in the pool when possible
  * @param[in]    ch        Clixon client session handle
  * @see clixon_client_connect where the handle is created
- * The handle is deallocated
+ * The handle is deallocated (or pooled for reuse by a later connect)
  */
 int
 clixon_client_disconnect(clixon_client_handle ch)
 {
     int   retval = -1;
     struct clixon_client_handle *cch = chandle(ch);
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
     if (cch == NULL){
         clicon_err(OE_XML, EINVAL, "Expected cch handle");
@@ -403,18 +528,16 @@ clixon_client_disconnect(clixon_client_handle ch)
     if (cch->cch_locked)
         ;//     (void)clixon_client_lock(cch->cch_socket, 0, "running");
 
-    switch(cch->cch_type){
-    case CLIXON_CLIENT_IPC:
-        close(cch->cch_socket);
-        break;
-    case CLIXON_CLIENT_SSH:
-    case CLIXON_CLIENT_NETCONF:
-        if (clixon_proc_socket_close(cch->cch_pid,
-                                     cch->cch_socket) < 0)
-            goto done;
-        break;
+    /* Keep-alive: return the connection to the pool instead of closing.
+     * Locked sessions are not pooled since locks are per session.
+     */
+    if (!cch->cch_locked &&
+        clixon_client_pool_put(cch) == 1){
+        retval = 0;
+        goto done;
     }
-    free(cch);
+    if (clixon_client_close1(cch) < 0)
+        goto done;
     retval = 0;
  done:
     return retval;
@@ -823,6 +946,232 @@ clixon_client_get_uint64(clixon_client_handle  ch,
     return retval;
 }
 
+/*! Subscribe to an event stream, optionally pre-filtered backend-side
+ *
+ * Sends an RFC 5277 create-subscription on the session socket. If xpath is
+ * given it is passed as an xpath filter evaluated by the backend, so events
+ * not matching are never sent and the client pays no parse cost for them.
+ * Received events are collected with clixon_client_events_poll.
+ * @param[in]  ch        Clixon client handle
+ * @param[in]  stream    Stream name, eg "NETCONF"
+ * @param[in]  namespace Default namespace for non-prefixed entries in xpath, or NULL
+ * @param[in]  xpath     XPath filter evaluated backend-side, or NULL for all events
+ * @retval     0         OK
+ * @retval     -1        Error
+ * @see clixon_client_events_poll  Batched event delivery
+ */
+int
+clixon_client_subscribe(clixon_client_handle ch,
+                        const char          *stream,
+                        const char          *namespace,
+                        const char          *xpath)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    cxobj                       *xret = NULL;
+    cxobj                       *xd;
+    cbuf                        *msg = NULL;
+    cbuf                        *msgret = NULL;
+    int                          eof = 0;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (stream == NULL){
+        clicon_err(OE_XML, EINVAL, "Expected stream");
+        goto done;
+    }
+    if ((msg = cbuf_new()) == NULL){
+        clicon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    if ((msgret = cbuf_new()) == NULL){
+        clicon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(msg, "<rpc xmlns=\"%s\" %s>"
+            "<create-subscription xmlns=\"%s\"><stream>%s</stream>",
+            NETCONF_BASE_NAMESPACE, NETCONF_MESSAGE_ID_ATTR,
+            EVENT_RFC5277_NAMESPACE, stream);
+    if (xpath && strlen(xpath)){
+        cprintf(msg, "<filter type=\"xpath\" select=\"%s\"", xpath);
+        if (namespace)
+            cprintf(msg, " xmlns=\"%s\"", namespace);
+        cprintf(msg, "/>");
+    }
+    cprintf(msg, "</create-subscription></rpc>");
+    if (netconf_output_encap(0, msg) < 0) // XXX configurable session
+        goto done;
+    if (clicon_msg_send1(cch->cch_socket, msg) < 0)
+        goto done;
+    if (clicon_msg_rcv1(cch->cch_socket, msgret, &eof) < 0)
+        goto done;
+    if (eof){
+        close(cch->cch_socket);
+        clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        goto done;
+    }
+    if (clixon_xml_parse_string(cbuf_get(msgret), YB_NONE, NULL, &xret, NULL) < 0)
+        goto done;
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL){
+        xd = xml_parent(xd); /* point to rpc-reply */
+        clixon_netconf_error(xd, "Create subscription", NULL);
+        goto done; /* Not fatal */
+    }
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (xret)
+        xml_free(xret);
+    if (msg)
+        cbuf_free(msg);
+    if (msgret)
+        cbuf_free(msgret);
+    return retval;
+}
+
+/*! Collect a batch of notification events from a subscribed session
+ *
+ * Blocks up to timeout_ms for the first event, then drains whatever is
+ * already queued on the socket without further waiting, up to maxevents.
+ * Frames are returned raw; parse cost is deferred until the caller asks for
+ * the XML of an individual event with clixon_client_event_xml.
+ * @param[in]  ch         Clixon client handle, subscribed with clixon_client_subscribe
+ * @param[in]  timeout_ms Max wait for the first event in ms, -1 blocks, 0 polls
+ * @param[in]  maxevents  Max events per batch, 0 means no bound
+ * @param[out] evvec      Malloced vector of events. Free with clixon_client_events_free
+ * @param[out] evlen      Number of events in evvec, 0 on timeout
+ * @retval     0          OK, evlen may be 0 on timeout
+ * @retval     -1         Error (including peer close)
+ * @see clixon_client_event_xml  Lazy per-event parse
+ */
+int
+clixon_client_events_poll(clixon_client_handle        ch,
+                          int                         timeout_ms,
+                          int                         maxevents,
+                          struct clixon_client_event **evvec,
+                          int                        *evlen)
+{
+    int                          retval = -1;
+    struct clixon_client_handle *cch = chandle(ch);
+    struct clixon_client_event  *ev = NULL;
+    struct clixon_client_event  *evnew;
+    int                          len = 0;
+    cbuf                        *frame = NULL;
+    fd_set                       fdset;
+    struct timeval               t;
+    struct timeval              *tp;
+    int                          eof = 0;
+    int                          n;
+
+    clicon_debug(1, "%s", __FUNCTION__);
+    if (evvec == NULL || evlen == NULL){
+        clicon_err(OE_XML, EINVAL, "Expected evvec and evlen");
+        goto done;
+    }
+    *evvec = NULL;
+    *evlen = 0;
+    if ((frame = cbuf_new()) == NULL){
+        clicon_err(OE_PLUGIN, errno, "cbuf_new");
+        goto done;
+    }
+    while (maxevents == 0 || len < maxevents){
+        FD_ZERO(&fdset);
+        FD_SET(cch->cch_socket, &fdset);
+        if (len == 0 && timeout_ms < 0)
+            tp = NULL; /* block for first event */
+        else{
+            /* Wait for first event, but only drain already-queued ones */
+            t.tv_sec  = len == 0 ? timeout_ms/1000 : 0;
+            t.tv_usec = len == 0 ? (timeout_ms%1000)*1000 : 0;
+            tp = &t;
+        }
+        if ((n = select(cch->cch_socket+1, &fdset, NULL, NULL, tp)) < 0){
+            if (errno == EINTR)
+                continue;
+            clicon_err(OE_UNIX, errno, "select");
+            goto done;
+        }
+        if (n == 0)
+            break; /* timeout, or batch drained */
+        cbuf_reset(frame);
+        if (clicon_msg_rcv1(cch->cch_socket, frame, &eof) < 0)
+            goto done;
+        if (eof){
+            close(cch->cch_socket);
+            clicon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+            goto done;
+        }
+        if ((evnew = realloc(ev, (len+1)*sizeof(struct clixon_client_event))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            goto done;
+        }
+        ev = evnew;
+        memset(&ev[len], 0, sizeof(struct clixon_client_event));
+        if ((ev[len].ce_frame = strdup(cbuf_get(frame))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        len++;
+    }
+    *evvec = ev;
+    *evlen = len;
+    ev = NULL;
+    retval = 0;
+ done:
+    clicon_debug(1, "%s retval:%d evlen:%d", __FUNCTION__, retval, len);
+    if (ev)
+        clixon_client_events_free(ev, len);
+    if (frame)
+        cbuf_free(frame);
+    return retval;
+}
+
+/*! Parse a single batched event on demand and return its XML tree
+ *
+ * The parse is done on first access and cached in the event, so callers that
+ * discard an event after looking at the raw frame never pay for a tree parse.
+ * @param[in]  ev    Event from clixon_client_events_poll
+ * @retval     xml   Parsed notification tree, owned by the event
+ * @retval     NULL  Error, or no notification in frame
+ */
+cxobj *
+clixon_client_event_xml(struct clixon_client_event *ev)
+{
+    cxobj *xtop = NULL;
+
+    if (ev == NULL || ev->ce_frame == NULL){
+        clicon_err(OE_XML, EINVAL, "Expected event with frame");
+        return NULL;
+    }
+    if (ev->ce_xml == NULL){
+        if (clixon_xml_parse_string(ev->ce_frame, YB_NONE, NULL, &xtop, NULL) < 0)
+            return NULL;
+        ev->ce_xml = xtop;
+    }
+    return xpath_first(ev->ce_xml, NULL, "notification");
+}
+
+/*! Free an event vector from clixon_client_events_poll
+ * @param[in]  evvec  Event vector
+ * @param[in]  evlen  Number of events in evvec
+ * @retval     0      OK
+ */
+int
+clixon_client_events_free(struct clixon_client_event *evvec,
+                          int                         evlen)
+{
+    int i;
+
+    for (i=0; i<evlen; i++){
+        if (evvec[i].ce_frame)
+            free(evvec[i].ce_frame);
+        if (evvec[i].ce_xml)
+            xml_free(evvec[i].ce_xml);
+    }
+    if (evvec)
+        free(evvec);
+    return 0;
+}
+
 /* Access functions */
 /*! Client-api get uint64
  * @param[in]  ch     Clixon client handle
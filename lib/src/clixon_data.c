@@ -193,61 +193,124 @@ clicon_ptr_del(clicon_handle h,
     return clicon_hash_del(cdat, (char*)name);
 }
 
+/*! Get generic clixon data stored by reference, see clicon_data_ref_set
+ * @param[in]  h     Clicon handle
+ * @param[in]  name  Data name
+ * @retval     ptr   Stored object, still owned by the handle
+ * @retval     NULL  Not found
+ */
+void *
+clicon_data_ref_get(clicon_handle h,
+                    const char   *name)
+{
+    clicon_hash_t *cdat = clicon_data(h);
+
+    return clicon_hash_value(cdat, (char*)name, NULL);
+}
+
+/*! Set generic clixon data by reference with a destructor
+ *
+ * Unlike clicon_data_set/clicon_ptr_set the object is neither copied nor left
+ * for the caller to free: the handle takes ownership and calls the destructor
+ * when the entry is replaced or deleted, or on handle exit. Use for large
+ * objects (trees, buffers) shuttled through the handle, where clicon_ptr_set
+ * plus hand-rolled cleanup is the usual workaround.
+ * @param[in]  h       Clicon handle
+ * @param[in]  name    Data name
+ * @param[in]  ptr     Object stored by reference. On error the caller still owns it
+ * @param[in]  freefn  Destructor called on ptr when the entry is removed
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clicon_data_cvec_set  for the cvec special case
+ */
+int
+clicon_data_ref_set(clicon_handle         h,
+                    const char           *name,
+                    void                 *ptr,
+                    clicon_hash_freefn_t *freefn)
+{
+    clicon_hash_t *cdat = clicon_data(h);
+
+    return clicon_hash_add_ref(cdat, (char*)name, ptr, freefn)==NULL?-1:0;
+}
+
+/*! Delete generic clixon data stored by reference, the object is freed
+ * @param[in]  h     Clicon handle
+ * @param[in]  name  Data name
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+clicon_data_ref_del(clicon_handle h,
+                    const char   *name)
+{
+    clicon_hash_t *cdat = clicon_data(h);
+
+    return clicon_hash_del(cdat, (char*)name);
+}
+
+/*! Destructor of a cvec stored by reference, of type clicon_hash_freefn_t
+ */
+static int
+data_cvec_freefn(void *val)
+{
+    return cvec_free((cvec *)val);
+}
+
 /*! Get generic cligen variable vector (cvv) on the form <name>=<val> where <val> is cvv
  *
  * @param[in]  h     Clicon handle
  * @param[in]  name  Data name
- * @retval     cvv   Data value as cvv
+ * @retval     cvv   Data value as cvv, still owned by the handle
  * @retval     NULL  Not found (or error)
  * @code
  *   cvec *cvv = NULL;
  *   if (clicon_data_cvec_get(h, "mycvv", &cvv) < 0)
  *     err;
- * @endcode                                     
+ * @endcode
  */
 cvec *
 clicon_data_cvec_get(clicon_handle h,
                      const char   *name)
 {
-    cvec *cvv = NULL;
-    
-    if (clicon_ptr_get(h, name, (void**)&cvv) < 0)
-        return NULL;
-    return cvv;
+    clicon_hash_t *cdat = clicon_data(h);
+
+    return (cvec *)clicon_hash_value(cdat, (char*)name, NULL);
 }
 
 /*! Set generic cligen variable vector (cvv) on the form <name>=<val> where <val> is cvv
+ *
+ * Stored by reference with cvec_free as destructor: the handle takes ownership
+ * and a replaced or deleted cvv (also on handle exit) is freed automatically.
  * @param[in]  h     Clicon handle
  * @param[in]  name  Name
  * @param[in]  cvv   CLIgen variable vector (cvv) (malloced)
+ * @retval     0     OK
+ * @retval    -1     Error
  */
 int
 clicon_data_cvec_set(clicon_handle h,
                      const char   *name,
                      cvec         *cvv)
 {
-    cvec *cvv0 = NULL;
+    clicon_hash_t *cdat = clicon_data(h);
 
-    clicon_ptr_get(h, name, (void**)&cvv0);
-    if (cvv0)
-        cvec_free(cvv0);
-    return clicon_ptr_set(h, name, cvv);
+    return clicon_hash_add_ref(cdat, (char*)name, cvv, data_cvec_freefn)==NULL?-1:0;
 }
 
-/*! Delete generic cligen variable vector (cvv)
+/*! Delete generic cligen variable vector (cvv), the stored cvv is freed
  * @param[in]  h     Clicon handle
  * @param[in]  name  Name
+ * @retval     0     OK
+ * @retval    -1     Error
  */
 int
 clicon_data_cvec_del(clicon_handle h,
                      const char   *name)
 {
-    cvec *cvv = NULL;
+    clicon_hash_t *cdat = clicon_data(h);
 
-    clicon_ptr_get(h, name, (void**)&cvv);
-    if (cvv)
-        cvec_free(cvv);
-    return clicon_ptr_del(h, name);
+    return clicon_hash_del(cdat, (char*)name);
 }
 
 /*! Get data yangspec, yspec 
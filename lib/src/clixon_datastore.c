@@ -47,6 +47,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <syslog.h>
+#include <inttypes.h>
 #include <dlfcn.h>
 #include <fcntl.h>
 #include <time.h>
@@ -79,6 +80,7 @@
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_usdt.h"
 
 
 /*! Translate from symbolic database name to actual filename in file-system
@@ -121,6 +123,158 @@ xmldb_db2file(clicon_handle  h,
     return retval;
 }
 
+/*! Translate from symbolic database name to its shard directory
+ *
+ * In sharded layout (see CLICON_XMLDB_SHARDED) each top-level config subtree
+ * is kept in its own file "<name>_db" under this directory, next to the base
+ * "<db>_db" file which holds only module-state. The directory may not exist.
+ * @param[in]   h    Clicon handle
+ * @param[in]   db   Symbolic database name, eg "candidate", "running"
+ * @param[out]  dir  Directory name. Unallocate after use with free()
+ * @retval      0    OK
+ * @retval     -1    Error
+ */
+int
+xmldb_shard_dir(clicon_handle  h,
+                const char    *db,
+                char         **dir)
+{
+    int   retval = -1;
+    cbuf *cb = NULL;
+    char *xmldbdir;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((xmldbdir = clicon_xmldb_dir(h)) == NULL){
+        clicon_err(OE_XML, errno, "dbdir not set");
+        goto done;
+    }
+    cprintf(cb, "%s/%s_db_d", xmldbdir, db);
+    if ((*dir = strdup4(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Remove all shard files of a db, if any
+ *
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_shard_dir
+ */
+int
+xmldb_shard_clear(clicon_handle h,
+                  const char   *db)
+{
+    int            retval = -1;
+    char          *dir = NULL;
+    struct dirent *dp = NULL;
+    int            ndp;
+    int            i;
+    cbuf          *cb = NULL;
+
+    if (xmldb_shard_dir(h, db, &dir) < 0)
+        goto done;
+    if ((ndp = clicon_file_dirent(dir, &dp, "_db$", S_IFREG)) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cb);
+        cprintf(cb, "%s/%s", dir, dp[i].d_name);
+        if (unlink(cbuf_get(cb)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cb));
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dp)
+        free(dp);
+    if (dir)
+        free(dir);
+    return retval;
+}
+
+/*! Replicate the shard directory of "from" to "to"
+ *
+ * Stale shards of "to" are removed first. No-op if "from" has no shards.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database name
+ * @param[in]  to    Destination database name
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_copy  which copies the base files
+ */
+static int
+xmldb_shard_copy(clicon_handle h,
+                 const char   *from,
+                 const char   *to)
+{
+    int            retval = -1;
+    char          *fromdir = NULL;
+    char          *todir = NULL;
+    struct dirent *dp = NULL;
+    int            ndp;
+    int            i;
+    cbuf          *cbf = NULL;
+    cbuf          *cbt = NULL;
+
+    if (xmldb_shard_clear(h, to) < 0)
+        goto done;
+    if (xmldb_shard_dir(h, from, &fromdir) < 0)
+        goto done;
+    if ((ndp = clicon_file_dirent(fromdir, &dp, "_db$", S_IFREG)) < 0)
+        goto done;
+    if (ndp == 0)
+        goto ok;
+    if (xmldb_shard_dir(h, to, &todir) < 0)
+        goto done;
+    if (mkdir(todir, S_IRWXU) < 0 && errno != EEXIST){
+        clicon_err(OE_UNIX, errno, "mkdir(%s)", todir);
+        goto done;
+    }
+    if ((cbf = cbuf_new()) == NULL || (cbt = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    for (i = 0; i < ndp; i++){
+        cbuf_reset(cbf);
+        cbuf_reset(cbt);
+        cprintf(cbf, "%s/%s", fromdir, dp[i].d_name);
+        cprintf(cbt, "%s/%s", todir, dp[i].d_name);
+        if (clicon_file_copy(cbuf_get(cbf), cbuf_get(cbt)) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cbf)
+        cbuf_free(cbf);
+    if (cbt)
+        cbuf_free(cbt);
+    if (dp)
+        free(dp);
+    if (todir)
+        free(todir);
+    if (fromdir)
+        free(fromdir);
+    return retval;
+}
+
 /*! Ensure database name is correct
  * @param[in]   db    Name of database 
  * @retval  0   OK
@@ -165,11 +319,34 @@ xmldb_disconnect(clicon_handle h)
     
     if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
         goto done;
-    for(i = 0; i < klen; i++) 
+    for(i = 0; i < klen; i++)
         if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL){
+            /* Write out deferred edits before dropping the cache tree */
+            if (de->de_dirty && xmldb_flush(h, keys[i]) < 0)
+                goto done;
             if (de->de_xml){
-                xml_free(de->de_xml);
+                cxobj *xt = de->de_xml;
                 de->de_xml = NULL;
+                /* Tree may be shared between datastores in COW cache mode */
+                if (xmldb_cache_refcnt(h, xt) == 0)
+                    xmldb_ref_orphan(h, xt);
+            }
+            if (de->de_nsmap){
+                free(de->de_nsmap);
+                de->de_nsmap = NULL;
+                de->de_nsmaplen = 0;
+            }
+            while (de->de_mstats){
+                struct db_modstat *ms = de->de_mstats;
+                de->de_mstats = ms->ms_next;
+                free(ms->ms_name);
+                free(ms);
+            }
+            while (de->de_plocks){
+                struct db_plock *pl = de->de_plocks;
+                de->de_plocks = pl->pl_next;
+                free(pl->pl_select);
+                free(pl);
             }
         }
     retval = 0;
@@ -179,17 +356,271 @@ xmldb_disconnect(clicon_handle h)
     return retval;
 }
 
+/*! Count how many datastore cache entries reference an XML tree
+ * With copy-on-write cache mode (see DATASTORE_CACHE_COW) several datastores
+ * (eg running and candidate) may share the same cached tree. Before freeing
+ * or modifying a cached tree, check whether it is shared.
+ * @param[in]  h   Clicon handle
+ * @param[in]  x   XML tree (candidate de_xml pointer)
+ * @retval     n   Number of datastores whose cache is x
+ * @retval    -1   Error
+ */
+int
+xmldb_cache_refcnt(clicon_handle h,
+                   cxobj        *x)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    int       i;
+    int       nr = 0;
+    db_elmnt *de;
+
+    if (x == NULL)
+        return 0;
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for (i = 0; i < klen; i++)
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL &&
+            de->de_xml == x)
+            nr++;
+    retval = nr;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Break copy-on-write sharing of a datastore cache by cloning the tree
+ * If the cache tree of db is shared with another datastore, or referenced by
+ * readers (see xmldb_get_ref), replace it with a private deep copy so that it
+ * can be modified. No-op if not shared.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name, eg "candidate", "running"
+ * @param[out] xp  If set, the (possibly new) private cache tree
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_cache_unshare(clicon_handle h,
+                    const char   *db,
+                    cxobj       **xp)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    cxobj    *x0;
+    cxobj    *x1 = NULL;
+    int       nr;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || (x0 = de->de_xml) == NULL)
+        goto ok;
+    /* Cheap test first: the db hash is only scanned for sharers when a COW copy
+     * actually flagged the tree as shared, not on every edit */
+    if (de->de_shared == 0 && xmldb_ref_cnt(h, x0) == 0)
+        goto ok;
+    if ((nr = xmldb_cache_refcnt(h, x0)) < 0)
+        goto done;
+    if (nr > 1 || xmldb_ref_cnt(h, x0) > 0){
+        if ((x1 = xml_new(xml_name(x0), NULL, CX_ELMNT)) == NULL)
+            goto done;
+        xml_flag_set(x1, XML_FLAG_TOP);
+        if (xml_copy(x0, x1) < 0)
+            goto done;
+        de->de_xml = x1;
+        de->de_shared = 0; /* clone is private */
+        clicon_db_elmnt_set(h, db, de);
+        x1 = NULL;
+        /* If no other datastore shares the old tree, only readers own it now:
+         * freed when the last reference is released */
+        if (nr <= 1 &&
+            xmldb_ref_orphan(h, x0) < 0)
+            goto done;
+    }
+    else
+        de->de_shared = 0; /* flag was stale: no sharer left */
+ ok:
+    if (xp)
+        *xp = de ? de->de_xml : NULL;
+    retval = 0;
+ done:
+    if (x1)
+        xml_free(x1);
+    return retval;
+}
+
+/* Outstanding reader references to a cached XML tree, see xmldb_get_ref
+ * One entry per referenced tree, kept in a list on the handle (clicon_ptr) since
+ * a tree may outlive its datastore cache slot: a writer orphans it and installs
+ * a fresh copy, and the orphan is freed when the last reference is released.
+ */
+struct xmldb_ref {
+    struct xmldb_ref *xr_next;
+    cxobj            *xr_xml;    /* Referenced cache tree */
+    uint32_t          xr_cnt;    /* Nr of outstanding references */
+    int               xr_orphan; /* Tree detached from cache: free at last release */
+};
+#define XMLDB_REF_PTR "xmldb-reader-refs"
+
+/*! Find reader reference entry of an XML tree, if any
+ * @param[in]  h   Clicon handle
+ * @param[in]  x   XML tree
+ * @retval     xr  Reference entry, or NULL
+ */
+static struct xmldb_ref *
+xmldb_ref_find(clicon_handle h,
+               cxobj        *x)
+{
+    struct xmldb_ref *xr = NULL;
+
+    clicon_ptr_get(h, XMLDB_REF_PTR, (void**)&xr);
+    for (; xr; xr = xr->xr_next)
+        if (xr->xr_xml == x)
+            return xr;
+    return NULL;
+}
+
+/*! Remove and free a reader reference entry from the list on the handle
+ * @param[in]  h    Clicon handle
+ * @param[in]  xr0  Reference entry
+ */
+static int
+xmldb_ref_del(clicon_handle     h,
+              struct xmldb_ref *xr0)
+{
+    struct xmldb_ref *xr = NULL;
+
+    clicon_ptr_get(h, XMLDB_REF_PTR, (void**)&xr);
+    if (xr == xr0)
+        clicon_ptr_set(h, XMLDB_REF_PTR, xr0->xr_next);
+    else {
+        for (; xr && xr->xr_next != xr0; xr = xr->xr_next)
+            ;
+        if (xr)
+            xr->xr_next = xr0->xr_next;
+    }
+    free(xr0);
+    return 0;
+}
+
+/*! Take a reader reference on a cached XML tree
+ * @param[in]  h   Clicon handle
+ * @param[in]  x   XML (cache) tree
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see xmldb_get_ref which is the intended caller
+ */
+int
+xmldb_ref_incr(clicon_handle h,
+               cxobj        *x)
+{
+    int               retval = -1;
+    struct xmldb_ref *xr;
+    struct xmldb_ref *xrs = NULL;
+
+    if ((xr = xmldb_ref_find(h, x)) == NULL){
+        if ((xr = malloc(sizeof *xr)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(xr, 0, sizeof *xr);
+        xr->xr_xml = x;
+        clicon_ptr_get(h, XMLDB_REF_PTR, (void**)&xrs);
+        xr->xr_next = xrs;
+        clicon_ptr_set(h, XMLDB_REF_PTR, xr);
+    }
+    xr->xr_cnt++;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Count outstanding reader references on an XML tree
+ * @param[in]  h   Clicon handle
+ * @param[in]  x   XML tree
+ * @retval     n   Nr of outstanding references (0 if none)
+ */
+int
+xmldb_ref_cnt(clicon_handle h,
+              cxobj        *x)
+{
+    struct xmldb_ref *xr;
+
+    if (x == NULL || (xr = xmldb_ref_find(h, x)) == NULL)
+        return 0;
+    return xr->xr_cnt;
+}
+
+/*! Drop cache ownership of an XML tree: free now, or at last reference release
+ * Called where the datastore cache previously did xml_free directly. If readers
+ * hold references, the tree is kept alive (orphaned) and freed when the last
+ * reference is released, otherwise it is freed here.
+ * @param[in]  h   Clicon handle
+ * @param[in]  x   XML tree (may be NULL)
+ * @retval     0   OK
+ */
+int
+xmldb_ref_orphan(clicon_handle h,
+                 cxobj        *x)
+{
+    struct xmldb_ref *xr;
+
+    if (x == NULL)
+        return 0;
+    if ((xr = xmldb_ref_find(h, x)) == NULL || xr->xr_cnt == 0){
+        if (xr)
+            xmldb_ref_del(h, xr);
+        xml_free(x);
+    }
+    else
+        xr->xr_orphan = 1;
+    return 0;
+}
+
+/*! Release a reader reference obtained with xmldb_get_ref
+ * @param[in]  h   Clicon handle
+ * @param[in]  x   XML tree (may be NULL)
+ * @retval     0   OK
+ * @retval    -1   Error: no reference held on x
+ * @see xmldb_get_ref
+ */
+int
+xmldb_ref_release(clicon_handle h,
+                  cxobj        *x)
+{
+    struct xmldb_ref *xr;
+    int               orphan;
+
+    if (x == NULL)
+        return 0;
+    if ((xr = xmldb_ref_find(h, x)) == NULL || xr->xr_cnt == 0){
+        clicon_err(OE_DB, ENOENT, "No reference held on tree");
+        return -1;
+    }
+    if (--xr->xr_cnt == 0){
+        orphan = xr->xr_orphan;
+        xmldb_ref_del(h, xr);
+        if (orphan)
+            xml_free(x);
+    }
+    return 0;
+}
+
 /*! Copy database from db1 to db2
+ *
+ * The "to" cache root is published as a pointer swap: readers holding references
+ * on the old tree (xmldb_get_ref, or xmldb_get0 in zerocopy mode) keep their
+ * snapshot, which is orphaned and freed when the last reference is released.
  * @param[in]  h     Clicon handle
  * @param[in]  from  Source database
  * @param[in]  to    Destination database
  * @retval -1  Error
  * @retval  0  OK
   */
-int 
-xmldb_copy(clicon_handle h, 
-           const char   *from, 
-           const char   *to)
+static int
+xmldb_copy1(clicon_handle h,
+            const char   *from,
+            const char   *to,
+            int           defer)
 {
     int                 retval = -1;
     char               *fromfile = NULL;
@@ -199,8 +630,20 @@ xmldb_copy(clicon_handle h,
     db_elmnt            de0 = {0,};
     cxobj              *x1 = NULL;  /* from */
     cxobj              *x2 = NULL;  /* to */
+    int                 shared = 0; /* to shares from:s tree after the copy */
+    uint64_t            slow_t0 = 0;
+    uint64_t            slow_dt;
 
     clicon_debug(1, "%s %s %s", __FUNCTION__, from, to);
+    CLIXON_PROBE2(xmldb_copy, from, to);
+    if (clixon_log_slow_get() != 0)
+        slow_t0 = clixon_log_slow_ns();
+    /* Deferring the file write needs a cache tree to serialize later; journal
+     * mode folds outstanding edits into the files at copy time and cannot */
+    if (defer &&
+        (clicon_datastore_cache(h) == DATASTORE_NOCACHE ||
+         clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")))
+        defer = 0;
     /* XXX lock */
     if (clicon_datastore_cache(h) != DATASTORE_NOCACHE){
         /* Copy in-memory cache */
@@ -212,23 +655,33 @@ xmldb_copy(clicon_handle h,
         if (x1 == NULL && x2 == NULL){
             /* do nothing */
         }
-        else if (x1 == NULL){  /* free x2 and set to NULL */
-            xml_free(x2);
+        else if (x1 == NULL){  /* free x2 (if not shared) and set to NULL */
+            if (xmldb_cache_refcnt(h, x2) <= 1)
+                xmldb_ref_orphan(h, x2);
             x2 = NULL;
         }
+        else if (clicon_datastore_cache(h) == DATASTORE_CACHE_COW){
+            /* Share the tree instead of deep-copying, clone deferred to first
+             * write, see xmldb_cache_unshare */
+            if (x2 != x1 && xmldb_cache_refcnt(h, x2) <= 1)
+                xmldb_ref_orphan(h, x2);
+            x2 = x1;
+            de1->de_shared = 1;
+            shared = 1;
+        }
         else  if (x2 == NULL){ /* create x2 and copy from x1 */
             if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
                 goto done;
             xml_flag_set(x2, XML_FLAG_TOP);
-            if (xml_copy(x1, x2) < 0) 
+            if (xml_copy(x1, x2) < 0)
                 goto done;
         }
         else{ /* copy x1 to x2 */
-            xml_free(x2);
+            xmldb_ref_orphan(h, x2);
             if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
                 goto done;
             xml_flag_set(x2, XML_FLAG_TOP);
-            if (xml_copy(x1, x2) < 0) 
+            if (xml_copy(x1, x2) < 0)
                 goto done;
         }
         /* always set cache although not strictly necessary in case 1
@@ -237,9 +690,30 @@ xmldb_copy(clicon_handle h,
         if (de2)
             de0 = *de2;
         de0.de_xml = x2; /* The new tree */
+        de0.de_shared = shared;
     }
+    if (defer && x2 == NULL)
+        defer = 0; /* No cache tree of "from": nothing to serialize later */
+    de0.de_serial = xmldb_serial_get(h, to) + 1;
+    de0.de_dirty = 0; /* "to" file is made current below (or by deferred flush) */
     clicon_db_elmnt_set(h, to, &de0);
-
+    if (defer){
+        /* Leave the file write to the coalesced write-back, the cache tree is
+         * current. Callers needing durability use xmldb_barrier */
+        if (xmldb_flush_defer(h, to) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
+    /* In journal mode, fold outstanding journaled edits of "from" into its
+     * base file before copying, see CLICON_XMLDB_JOURNAL */
+    if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL") &&
+        xmldb_journal_compact(h, from) < 0)
+        goto done;
+    /* Deferred writes: make the "from" file current before copying it,
+     * see CLICON_XMLDB_WRITE_COALESCE */
+    if (xmldb_flush(h, from) < 0)
+        goto done;
     /* Copy the files themselves (above only in-memory cache) */
     if (xmldb_db2file(h, from, &fromfile) < 0)
         goto done;
@@ -247,15 +721,77 @@ xmldb_copy(clicon_handle h,
         goto done;
     if (clicon_file_copy(fromfile, tofile) < 0)
         goto done;
+    /* Replicate per-subtree shard files, see CLICON_XMLDB_SHARDED */
+    if (xmldb_shard_copy(h, from, to) < 0)
+        goto done;
+    if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL")){
+        char       *jfrom = NULL;
+        char       *jto = NULL;
+        struct stat jst;
+        int         jret = -1;
+
+        if (xmldb_journal_truncate(h, to) < 0)
+            goto done;
+        /* If "from" could not be compacted (cold cache) copy its journal too */
+        if (xmldb_journal_file(h, from, &jfrom) == 0 &&
+            xmldb_journal_file(h, to, &jto) == 0){
+            if (stat(jfrom, &jst) == 0 && jst.st_size > 0)
+                jret = clicon_file_copy(jfrom, jto);
+            else
+                jret = 0;
+        }
+        if (jfrom)
+            free(jfrom);
+        if (jto)
+            free(jto);
+        if (jret < 0)
+            goto done;
+    }
     retval = 0;
  done:
     if (fromfile)
         free(fromfile);
     if (tofile)
         free(tofile);
+    /* Slow-op log, see CLICON_LOG_SLOW_MS */
+    if (slow_t0 != 0 &&
+        (slow_dt = clixon_log_slow_ns() - slow_t0) >= (uint64_t)clixon_log_slow_get()*1000000ull)
+        clicon_log(LOG_WARNING, "slow xmldb_copy: %" PRIu64 "ms from:%s to:%s retval:%d",
+                   slow_dt/1000000, from, to, retval);
     return retval;
 }
 
+int
+xmldb_copy(clicon_handle h,
+           const char   *from,
+           const char   *to)
+{
+    return xmldb_copy1(h, from, to, 0);
+}
+
+/*! Copy database with the destination file write deferred
+ *
+ * As xmldb_copy, but the "to" file serialization is left to the coalesced
+ * write-back instead of being done synchronously in the caller, so copies in
+ * RPC paths (eg the rollback snapshot of a confirmed-commit) do not pay for
+ * it. The in-memory cache is copied (or COW-shared) as usual and is current
+ * immediately. Falls back to a synchronous copy without a cache tree or in
+ * journal mode.
+ * @param[in]  h     Clicon handle
+ * @param[in]  from  Source database
+ * @param[in]  to    Destination database
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_barrier  for callers that need the file on stable storage
+ */
+int
+xmldb_copy_defer(clicon_handle h,
+                 const char   *from,
+                 const char   *to)
+{
+    return xmldb_copy1(h, from, to, 1);
+}
+
 /*! Lock database
  * @param[in]  h    Clicon handle
  * @param[in]  db   Database
@@ -322,12 +858,31 @@ xmldb_unlock_all(clicon_handle h,
         goto done;
     /* Identify the ones locked by client id */
     for (i = 0; i < klen; i++) {
-        if ((de = clicon_db_elmnt_get(h, keys[i])) != NULL &&
-            de->de_id == id){
+        struct db_plock **prev;
+        struct db_plock  *pl;
+        int               changed = 0;
+
+        if ((de = clicon_db_elmnt_get(h, keys[i])) == NULL)
+            continue;
+        if (de->de_id == id){
             de->de_id = 0;
             memset(&de->de_tv, 0, sizeof(struct timeval));
-            clicon_db_elmnt_set(h, keys[i], de);
+            changed++;
+        }
+        /* Also release partial locks held by the session, see xmldb_plock() */
+        prev = &de->de_plocks;
+        while ((pl = *prev) != NULL){
+            if (pl->pl_sessid == id){
+                *prev = pl->pl_next;
+                free(pl->pl_select);
+                free(pl);
+                changed++;
+            }
+            else
+                prev = &pl->pl_next;
         }
+        if (changed)
+            clicon_db_elmnt_set(h, keys[i], de);
     }
     retval = 0;
  done:
@@ -336,6 +891,236 @@ xmldb_unlock_all(clicon_handle h,
     return retval;
 }
 
+/*! Check if two XPath select expressions may refer to overlapping subtrees
+ * Conservative component-wise comparison where module prefixes and predicates
+ * are ignored and a path that is a component-level prefix of another overlaps
+ * with it, eg /interfaces vs /interfaces/interface[name='e0'] overlap while
+ * /interfaces vs /bgp are disjoint. Used for partial lock conflict detection.
+ * @param[in]  s0  XPath select expression
+ * @param[in]  s1  XPath select expression
+ * @retval     1   The expressions may overlap
+ * @retval     0   The expressions are disjoint
+ * @see xmldb_plock
+ */
+static int
+xmldb_select_overlap(const char *s0,
+                     const char *s1)
+{
+    const char *p0 = s0;
+    const char *p1 = s1;
+    const char *q0;
+    const char *q1;
+    const char *e0;
+    const char *e1;
+    const char *c;
+    int         depth;
+
+    while (*p0 == '/')
+        p0++;
+    while (*p1 == '/')
+        p1++;
+    while (*p0 && *p1){
+        /* Find end of component: next '/' outside predicate brackets */
+        depth = 0;
+        for (q0 = p0; *q0 && (depth || *q0 != '/'); q0++)
+            depth += (*q0 == '[') - (*q0 == ']');
+        depth = 0;
+        for (q1 = p1; *q1 && (depth || *q1 != '/'); q1++)
+            depth += (*q1 == '[') - (*q1 == ']');
+        /* Node test ends at predicate start (if any) */
+        for (e0 = p0; e0 < q0 && *e0 != '['; e0++)
+            ;
+        for (e1 = p1; e1 < q1 && *e1 != '['; e1++)
+            ;
+        /* Strip module/namespace prefix */
+        for (c = p0; c < e0; c++)
+            if (*c == ':')
+                p0 = c + 1;
+        for (c = p1; c < e1; c++)
+            if (*c == ':')
+                p1 = c + 1;
+        /* Wildcard matches any node */
+        if (!(e0 - p0 == 1 && *p0 == '*') &&
+            !(e1 - p1 == 1 && *p1 == '*') &&
+            (e0 - p0 != e1 - p1 || strncmp(p0, p1, e0 - p0) != 0))
+            return 0;
+        p0 = q0;
+        p1 = q1;
+        while (*p0 == '/')
+            p0++;
+        while (*p1 == '/')
+            p1++;
+    }
+    /* One is a prefix of the other (or both exhausted): overlap */
+    return 1;
+}
+
+/*! Take a partial (subtree) lock on a database, RFC 5717
+ * The scope of the lock is the union of the given select expressions. The lock
+ * is granted only if no select overlaps a partial lock held by another session
+ * and the database is not whole-locked by another session, see xmldb_lock().
+ * @param[in]  h       Clicon handle
+ * @param[in]  db      Database
+ * @param[in]  id      Session id requesting the lock
+ * @param[in]  selects Vector of XPath select expressions scoping the lock
+ * @param[out] lockid  Assigned lock-id on success
+ * @param[out] locker  Session id holding a conflicting lock if denied, 0 otherwise
+ * @retval -1  Error
+ * @retval  0  Denied, conflicting lock held by another session, locker set
+ * @retval  1  OK, lockid set
+ */
+int
+xmldb_plock(clicon_handle h,
+            const char   *db,
+            uint32_t      id,
+            cvec         *selects,
+            uint32_t     *lockid,
+            uint32_t     *locker)
+{
+    int              retval = -1;
+    db_elmnt        *de = NULL;
+    db_elmnt         de0 = {0,};
+    struct db_plock *pl;
+    struct db_plock *plhead0 = NULL;
+    cg_var          *cv;
+
+    if (locker)
+        *locker = 0;
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+        de0 = *de;
+    /* RFC 5717 Sec 2.4.1: deny if the whole db is locked by another session */
+    if (de0.de_id != 0 && de0.de_id != id){
+        if (locker)
+            *locker = de0.de_id;
+        goto fail;
+    }
+    cv = NULL;
+    while ((cv = cvec_each(selects, cv)) != NULL)
+        for (pl = de0.de_plocks; pl; pl = pl->pl_next)
+            if (pl->pl_sessid != id &&
+                xmldb_select_overlap(pl->pl_select, cv_string_get(cv))){
+                if (locker)
+                    *locker = pl->pl_sessid;
+                goto fail;
+            }
+    /* One list node per select, all sharing the new lock-id */
+    de0.de_plockid++;
+    plhead0 = de0.de_plocks;
+    cv = NULL;
+    while ((cv = cvec_each(selects, cv)) != NULL){
+        if ((pl = calloc(1, sizeof(*pl))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((pl->pl_select = strdup(cv_string_get(cv))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            free(pl);
+            goto done;
+        }
+        pl->pl_lockid = de0.de_plockid;
+        pl->pl_sessid = id;
+        gettimeofday(&pl->pl_tv, NULL);
+        pl->pl_next = de0.de_plocks;
+        de0.de_plocks = pl;
+    }
+    clicon_db_elmnt_set(h, db, &de0);
+    if (lockid)
+        *lockid = de0.de_plockid;
+    clicon_debug(1, "%s: partial lock %u by %u", db, de0.de_plockid, id);
+    retval = 1;
+ done:
+    if (retval < 0)
+        /* Unwind nodes created before the error, the list was not published */
+        while (de0.de_plocks != plhead0){
+            pl = de0.de_plocks;
+            de0.de_plocks = pl->pl_next;
+            free(pl->pl_select);
+            free(pl);
+        }
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Release a partial lock previously taken with xmldb_plock()
+ * @param[in]  h       Clicon handle
+ * @param[in]  db      Database
+ * @param[in]  id      Session id releasing the lock
+ * @param[in]  lockid  Lock-id as returned by xmldb_plock()
+ * @param[out] locker  Session holding the lock if not owned by id, 0 otherwise
+ * @retval -1  Error
+ * @retval  0  No such lock-id, or lock held by another session (locker set)
+ * @retval  1  OK
+ */
+int
+xmldb_punlock(clicon_handle h,
+              const char   *db,
+              uint32_t      id,
+              uint32_t      lockid,
+              uint32_t     *locker)
+{
+    db_elmnt         *de;
+    struct db_plock  *pl;
+    struct db_plock **prev;
+
+    if (locker)
+        *locker = 0;
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    for (pl = de->de_plocks; pl; pl = pl->pl_next)
+        if (pl->pl_lockid == lockid)
+            break;
+    if (pl == NULL)
+        return 0;
+    if (pl->pl_sessid != id){
+        if (locker)
+            *locker = pl->pl_sessid;
+        return 0;
+    }
+    /* Remove all nodes of the lock, one per select expression */
+    prev = &de->de_plocks;
+    while ((pl = *prev) != NULL){
+        if (pl->pl_lockid == lockid){
+            *prev = pl->pl_next;
+            free(pl->pl_select);
+            free(pl);
+        }
+        else
+            prev = &pl->pl_next;
+    }
+    clicon_db_elmnt_set(h, db, de);
+    clicon_debug(1, "%s: partial lock %u released by %u", db, lockid, id);
+    return 1;
+}
+
+/*! Check for a partial lock held by another session overlapping a subtree
+ * @param[in] h      Clicon handle
+ * @param[in] db     Database
+ * @param[in] id     Own session id, its locks do not conflict
+ * @param[in] select XPath select expression, use "/" for the whole datastore
+ * @retval    0      No conflicting partial lock
+ * @retval    >0     Session id of a conflicting lock holder
+ * @see xmldb_islocked  for the whole-db lock
+ */
+uint32_t
+xmldb_plock_conflict(clicon_handle h,
+                     const char   *db,
+                     uint32_t      id,
+                     const char   *select)
+{
+    db_elmnt        *de;
+    struct db_plock *pl;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    for (pl = de->de_plocks; pl; pl = pl->pl_next)
+        if (pl->pl_sessid != id &&
+            xmldb_select_overlap(pl->pl_select, select))
+            return pl->pl_sessid;
+    return 0;
+}
+
 /*! Check if database is locked
  * @param[in] h   Clicon handle
  * @param[in] db  Database
@@ -408,6 +1193,42 @@ xmldb_exists(clicon_handle h,
     return retval;
 }
 
+/*! Hint the kernel to read a datastore file into the page cache
+ * Initiates asynchronous readahead of the db file, so that file I/O overlaps
+ * CPU-bound work until the file is actually parsed. Used at backend startup:
+ * the startup/running files stream into the page cache while YANG modules are
+ * parsed and plugins loaded. Best effort: a missing file is not an error.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name, eg "startup", "running"
+ * @retval     0   OK (including file does not exist)
+ * @retval    -1   Error
+ */
+int
+xmldb_prefetch(clicon_handle h,
+               const char   *db)
+{
+    int   retval = -1;
+    char *filename = NULL;
+    int   fd = -1;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, db);
+    if (xmldb_db2file(h, db, &filename) < 0)
+        goto done;
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        goto ok; /* Best effort, eg file does not exist yet */
+#ifdef POSIX_FADV_WILLNEED
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+ ok:
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
 /*! Clear database cache if any for mem/size optimization only, not file itself
  * @param[in]  h   Clicon handle
  * @param[in]  db  Database
@@ -423,14 +1244,16 @@ xmldb_clear(clicon_handle h,
     
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
         if ((xt = de->de_xml) != NULL){
-            xml_free(xt);
             de->de_xml = NULL;
+            if (xmldb_cache_refcnt(h, xt) == 0)
+                xmldb_ref_orphan(h, xt);
         }
+        de->de_serial++;
     }
     return 0;
 }
 
-/*! Delete database, clear cache if any. Remove file 
+/*! Delete database, clear cache if any. Remove file
  * @param[in]  h   Clicon handle
  * @param[in]  db  Database
  * @retval -1  Error
@@ -446,8 +1269,12 @@ xmldb_delete(clicon_handle h,
     struct stat         sb;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, db);
+    CLIXON_PROBE1(xmldb_delete, db);
     if (xmldb_clear(h, db) < 0)
         goto done;
+    if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL") &&
+        xmldb_journal_truncate(h, db) < 0)
+        goto done;
     if (xmldb_db2file(h, db, &filename) < 0)
         goto done;
     if (lstat(filename, &sb) == 0)
@@ -455,6 +1282,8 @@ xmldb_delete(clicon_handle h,
             clicon_err(OE_DB, errno, "truncate %s", filename);
             goto done;
         }
+    if (xmldb_shard_clear(h, db) < 0)
+        goto done;
     retval = 0;
  done:
     if (filename)
@@ -481,9 +1310,11 @@ xmldb_create(clicon_handle h,
     clicon_debug(CLIXON_DBG_DETAIL, "%s %s", __FUNCTION__, db);
     if ((de = clicon_db_elmnt_get(h, db)) != NULL){
         if ((xt = de->de_xml) != NULL){
-            xml_free(xt);
             de->de_xml = NULL;
+            if (xmldb_cache_refcnt(h, xt) == 0)
+                xmldb_ref_orphan(h, xt);
         }
+        de->de_serial++;
     }
     if (xmldb_db2file(h, db, &filename) < 0)
         goto done;
@@ -534,6 +1365,155 @@ xmldb_cache_get(clicon_handle h,
     return de->de_xml;
 }
 
+/*! Invalidate per-module datastore counters after an edit
+ *
+ * Called from xmldb_put with the names of the top-level subtrees the edit
+ * touched, so only those are recounted on the next stats read.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Database name
+ * @param[in]  names  Names of edited top-level subtrees, NULL means all
+ * @retval     0      OK
+ * @see xmldb_modstats_get  where invalidated entries are recounted
+ */
+int
+xmldb_modstats_invalidate(clicon_handle h,
+                          const char   *db,
+                          cvec         *names)
+{
+    db_elmnt          *de;
+    struct db_modstat *ms;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    for (ms = de->de_mstats; ms; ms = ms->ms_next)
+        if (names == NULL || cvec_find(names, ms->ms_name) != NULL)
+            ms->ms_valid = 0;
+    de->de_msserial = de->de_serial;
+    return 0;
+}
+
+/*! Print per-datastore stats with per top-level module breakdown as XML
+ *
+ * Emits a <datastore> element with total node/byte counts and one <top> entry
+ * per top-level subtree (module data root). Counts come from counters cached
+ * in the db meta-info: only subtrees invalidated since the last read are
+ * re-walked, so repeated stats reads on a large but stable datastore cost a
+ * hash lookup per module instead of a full tree walk.
+ * @param[in]     h   Clicon handle
+ * @param[in]     db  Database name
+ * @param[in,out] cb  Output cbuf
+ * @retval        0   OK
+ * @retval       -1   Error
+ * @see xmldb_modstats_invalidate
+ */
+int
+xmldb_modstats_get(clicon_handle h,
+                   const char   *db,
+                   cbuf         *cb)
+{
+    int                 retval = -1;
+    db_elmnt           *de;
+    struct db_modstat  *ms;
+    struct db_modstat **msp;
+    cxobj              *xt;
+    cxobj              *xc;
+    cxobj              *xn = NULL;
+    cbuf               *cbtop = NULL;
+    uint64_t            totnr = 0;
+    uint64_t            totsz = 0;
+    uint64_t            nr;
+    size_t              sz;
+
+    if ((xt = xmldb_cache_get(h, db)) == NULL){
+        /* Trigger cache if no exist */
+        if (xmldb_get(h, db, NULL, "/", &xn) < 0)
+            goto done;
+        xt = xmldb_cache_get(h, db);
+    }
+    if (xt == NULL){
+        cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name><nr>0</nr><size>0</size></datastore>",
+                CLIXON_LIB_NS, db);
+        goto ok;
+    }
+    de = clicon_db_elmnt_get(h, db);
+    if (de && de->de_msserial != de->de_serial){
+        /* The db changed outside xmldb_put (copy/clear/restore): recount all */
+        for (ms = de->de_mstats; ms; ms = ms->ms_next)
+            ms->ms_valid = 0;
+        de->de_msserial = de->de_serial;
+    }
+    if ((cbtop = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
+        for (ms = de?de->de_mstats:NULL; ms; ms = ms->ms_next)
+            if (strcmp(ms->ms_name, xml_name(xc)) == 0)
+                break;
+        if (ms == NULL && de != NULL){
+            if ((ms = malloc(sizeof(*ms))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(ms, 0, sizeof(*ms));
+            if ((ms->ms_name = strdup(xml_name(xc))) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                free(ms);
+                goto done;
+            }
+            ms->ms_next = de->de_mstats;
+            de->de_mstats = ms;
+        }
+        if (ms == NULL){ /* No meta-info entry (NOCACHE): count directly */
+            nr = 0; sz = 0;
+            if (xml_stats(xc, &nr, &sz) < 0)
+                goto done;
+            totnr += nr;
+            totsz += sz;
+            cprintf(cbtop, "<top><name>%s</name><nr>%" PRIu64 "</nr><size>%zu</size></top>",
+                    xml_name(xc), nr, sz);
+            continue;
+        }
+        if (!ms->ms_valid){
+            nr = 0; sz = 0;
+            if (xml_stats(xc, &nr, &sz) < 0)
+                goto done;
+            ms->ms_nr = nr;
+            ms->ms_size = sz;
+            ms->ms_valid = 1;
+        }
+        totnr += ms->ms_nr;
+        totsz += ms->ms_size;
+        cprintf(cbtop, "<top><name>%s</name><nr>%" PRIu64 "</nr><size>%" PRIu64 "</size></top>",
+                ms->ms_name, ms->ms_nr, ms->ms_size);
+    }
+    /* Prune entries of subtrees no longer present */
+    if (de){
+        msp = &de->de_mstats;
+        while ((ms = *msp) != NULL){
+            if (xml_find(xt, ms->ms_name) == NULL){
+                *msp = ms->ms_next;
+                free(ms->ms_name);
+                free(ms);
+            }
+            else
+                msp = &ms->ms_next;
+        }
+    }
+    /* +1 for the top-level config node itself, as the old full walk counted it */
+    cprintf(cb, "<datastore xmlns=\"%s\"><name>%s</name><nr>%" PRIu64 "</nr><size>%" PRIu64 "</size>%s</datastore>",
+            CLIXON_LIB_NS, db, totnr + 1, totsz, cbuf_get(cbtop));
+ ok:
+    retval = 0;
+ done:
+    if (cbtop)
+        cbuf_free(cbtop);
+    if (xn)
+        xml_free(xn);
+    return retval;
+}
+
 /*! Get modified flag from datastore
  * @param[in]  h     Clicon handle
  * @param[in]  db    Database name
@@ -600,6 +1580,86 @@ xmldb_modified_set(clicon_handle h,
     return 0;
 }
 
+/*! Get write serial of datastore
+ * The serial is bumped on every modification of the db (put/copy/clear/create), so a
+ * reader can detect whether a db changed between two reads by comparing serials.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name
+ * @retval     serial Current write serial, 0 if datastore does not exist
+ */
+uint32_t
+xmldb_serial_get(clicon_handle h,
+                 const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    return de->de_serial;
+}
+
+/*! Bump write serial of datastore, create meta-info entry if it does not exist
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name
+ * @retval     0     OK
+ */
+int
+xmldb_serial_bump(clicon_handle h,
+                  const char   *db)
+{
+    db_elmnt *de;
+    db_elmnt  de0 = {0,};
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+        de->de_serial++;
+    else{
+        de0.de_serial = 1;
+        clicon_db_elmnt_set(h, db, &de0);
+    }
+    return 0;
+}
+
+/*! Get base serial of a private candidate datastore
+ * The base serial is the write serial of running at the time the db was forked
+ * from it, used for the optimistic conflict check at commit.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Database name
+ * @retval     serial Base serial, 0 if not a fork or datastore does not exist
+ * @see xmldb_serial_get  for the write serial itself
+ */
+uint32_t
+xmldb_base_serial_get(clicon_handle h,
+                      const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    return de->de_base_serial;
+}
+
+/*! Set base serial of a private candidate datastore
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Database name
+ * @param[in]  serial Write serial of running at fork time, 0 to clear
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xmldb_base_serial_set(clicon_handle h,
+                      const char   *db,
+                      uint32_t      serial)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+        clicon_err(OE_CFG, EFAULT, "datastore %s does not exist", db);
+        return -1;
+    }
+    de->de_base_serial = serial;
+    return 0;
+}
+
 /* Print the datastore meta-info to file
  */
 int
@@ -647,7 +1707,10 @@ xmldb_rename(clicon_handle h,
     int    retval = -1;
     char  *old;
     char  *fname = NULL;
+    char  *olddir = NULL;
     cbuf  *cb = NULL;
+    cbuf  *cb2 = NULL;
+    struct stat st;
 
     if ((xmldb_db2file(h, db, &old)) < 0)
         goto done;
@@ -665,8 +1728,26 @@ xmldb_rename(clicon_handle h,
         clicon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
         goto done;
     };
+    /* Move the shard directory along, if any, see CLICON_XMLDB_SHARDED */
+    if (xmldb_shard_dir(h, db, &olddir) < 0)
+        goto done;
+    if (lstat(olddir, &st) == 0){
+        if ((cb2 = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cb2, "%s_d", fname);
+        if (rename(olddir, cbuf_get(cb2)) < 0){
+            clicon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
+            goto done;
+        }
+    }
     retval = 0;
  done:
+    if (olddir)
+        free(olddir);
+    if (cb2)
+        cbuf_free(cb2);
     if (cb)
         cbuf_free(cb);
     if (old)
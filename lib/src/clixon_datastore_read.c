@@ -44,6 +44,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -80,9 +81,12 @@
 #include "clixon_xml_map.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
 #include "clixon_xml_nsctx.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_write.h"
+#include "clixon_rpc_stats.h"
 
 #define handle(xh) (assert(text_handle_check(xh)==0),(struct text_handle *)(xh))
 
@@ -205,26 +209,111 @@ xml_copy_bottom_recurse(cxobj  *x0t,
     return retval;
 }
 
+/*! Copy an XML tree depth-limited, nodes deeper than depth are never copied
+ *
+ * Same depth semantics as the serializer, see clixon_xml2cbuf: a node is kept
+ * iff depth != 0, attributes belong to their element and are always kept with it.
+ * @param[in]  x0     Source XML tree
+ * @param[in]  x1     Destination XML tree (must be created)
+ * @param[in]  depth  Levels to copy: -1 is all, 1 is the node itself
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xml_copy_depth(cxobj  *x0,
+               cxobj  *x1,
+               int32_t depth)
+{
+    int        retval = -1;
+    cxobj     *x;
+    cxobj     *xcopy;
+    cxobj     *x0k;
+    cxobj     *x1k;
+    yang_stmt *y;
+    cvec      *cvk = NULL; /* vector of index keys */
+    cg_var    *cvi;
+    char      *keyname;
+
+    if (xml_copy_one(x0, x1) < 0)
+        goto done;
+    x = NULL;
+    while ((x = xml_child_each(x0, x, -1)) != NULL){
+        if (xml_type(x) != CX_ATTR && depth == 1)
+            continue; /* Non-attribute children are one level below the cut */
+        if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
+            goto done;
+        if (xml_copy_depth(x, xcopy,
+                           (xml_type(x) == CX_ATTR || depth < 0) ? -1 : depth-1) < 0)
+            goto done;
+    }
+    /* Keys (and leaf-list values) of a node at the cut are kept even though they are
+     * below it: they are not rendered (the serializer applies the same cut) but an
+     * xpath with key predicates re-evaluated on the pruned copy must still match,
+     * see filter_xpath_again. Same idea as in xml_copy_bottom_recurse
+     */
+    if (depth == 1 && (y = xml_spec(x0)) != NULL){
+        if (yang_keyword_get(y) == Y_LIST){
+            cvk = yang_cvec_get(y); /* Use Y_LIST cache, see ys_populate_list() */
+            cvi = NULL;
+            while ((cvi = cvec_each(cvk, cvi)) != NULL){
+                keyname = cv_string_get(cvi);
+                if ((x0k = xml_find_type(x0, NULL, keyname, CX_ELMNT)) != NULL){
+                    if ((x1k = xml_new(keyname, x1, CX_ELMNT)) == NULL)
+                        goto done;
+                    if (xml_copy(x0k, x1k) < 0)
+                        goto done;
+                }
+            }
+        }
+        else if (yang_keyword_get(y) == Y_LEAF_LIST || yang_keyword_get(y) == Y_LEAF){
+            x = NULL;
+            while ((x = xml_child_each(x0, x, CX_BODY)) != NULL){
+                if ((xcopy = xml_new(xml_name(x), x1, CX_BODY)) == NULL)
+                    goto done;
+                if (xml_copy_one(x, xcopy) < 0)
+                    goto done;
+            }
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Copy an XML tree bottom-up
+ * @param[in]  depth Limit copy to this nr of levels below x1t: -1 is all, 0 is none
  * @retval     -1    General error, check specific clicon_errno, clicon_suberrno
  * @retval     0     OK
+ * @note depth is a pruning hint: ancestors materialized on the way down may exceed
+ *       it, the serializer applies the definite limit, see clixon_xml2cbuf
  */
 static int
-xml_copy_from_bottom(cxobj  *x0t, 
+xml_copy_from_bottom(cxobj  *x0t,
                      cxobj  *x0,
-                     cxobj  *x1t)
+                     cxobj  *x1t,
+                     int32_t depth)
 {
     int        retval = -1;
     cxobj     *x1p    = NULL;
     cxobj     *x0p    = NULL;
     cxobj     *x1     = NULL;
+    cxobj     *xp;
     yang_stmt *y      = NULL;
-    
+    int32_t    level  = 0;
+
     if (x0 == x0t)
         goto ok;
+    if (depth >= 0){
+        /* Level of x0 below x0t: children of x0t are at level 1 */
+        for (xp=x0; xp && xp != x0t; xp=xml_parent(xp))
+            level++;
+    }
     x0p = xml_parent(x0);
+    /* Materialize the ancestor chain: ancestors within depth are rendered as shells */
     if (xml_copy_bottom_recurse(x0t, x0p, x1t, &x1p) < 0)
         goto done;
+    if (depth >= 0 && level > depth)
+        goto ok; /* Node is below the cut, nothing of it can be rendered */
     if ((y = xml_spec(x0)) != NULL){
         /* Look if it exists */
         if (match_base_child(x1p, x0, y, &x1) < 0)
@@ -233,7 +322,11 @@ xml_copy_from_bottom(cxobj  *x0t,
     if (x1 == NULL){ /* If not, create it and copy complete tree */
         if ((x1 = xml_new(xml_name(x0), x1p, CX_ELMNT)) == NULL)
             goto done;
-        if (xml_copy(x0, x1) < 0)
+        if (depth >= 0){
+            if (xml_copy_depth(x0, x1, depth - level + 1) < 0)
+                goto done;
+        }
+        else if (xml_copy(x0, x1) < 0)
             goto done;
     }
  ok:
@@ -438,6 +531,120 @@ disable_nacm_on_empty(cxobj     *xt,
     return retval;
 }
 
+/*! Context for binding datastore subtrees as they complete during streaming parse
+ * @see xmldb_readfile_bind_cb
+ */
+struct readfile_bind_arg {
+    clicon_handle rb_h;      /* Clixon handle */
+    yang_stmt    *rb_yspec;  /* Top-level yang spec to bind against */
+    cxobj       **rb_xerr;   /* Error tree of the caller */
+    int           rb_failed; /* Set if a subtree failed yang binding, rb_xerr set */
+};
+
+/*! Bind a completed config subtree to yang during streaming parse of a datastore file
+ *
+ * Called for each child of <config> as soon as it is completely parsed, so
+ * that binding runs while the subtree is still cache-hot and a binding error
+ * aborts the load early instead of after the whole file has been read.
+ * Module-state meta-data is skipped here: it is not covered by the data yang
+ * spec and is analyzed and stripped separately, see text_read_modstate.
+ * @param[in]  x    Completely parsed subtree
+ * @param[in]  arg  struct readfile_bind_arg
+ * @retval     0    OK
+ * @retval    -1    Abort parse: error, or yang binding failed and rb_failed set
+ */
+static int
+xmldb_readfile_bind_cb(cxobj *x,
+                       void  *arg)
+{
+    struct readfile_bind_arg *rb = (struct readfile_bind_arg *)arg;
+    int                       ret;
+
+    if (strcmp(xml_name(x), "modules-state") == 0 ||
+        strcmp(xml_name(x), "yang-library") == 0)
+        return 0;
+    if (xml2ns_recurse(x) < 0)
+        return -1;
+    if ((ret = xml_bind_yang0(rb->rb_h, x, YB_MODULE, rb->rb_yspec, rb->rb_xerr)) < 0)
+        return -1;
+    if (ret == 0){
+        rb->rb_failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+/*! Parse one shard file and move its top-level subtrees into the spine tree
+ *
+ * See CLICON_XMLDB_SHARDED: a shard has the same <config> shape as a base
+ * datastore file but holds only the subtrees of one top-level name.
+ * @param[in]     h      Clicon handle
+ * @param[in]     dir    Shard directory, see xmldb_shard_dir
+ * @param[in]     fname  Shard file name within dir
+ * @param[in]     yspec  Top-level yang spec
+ * @param[in,out] x0     Spine tree, shard subtrees are appended as children
+ * @param[out]    xerr   XML error on parse failure
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+xmldb_readfile_shard(clicon_handle h,
+                     const char   *dir,
+                     const char   *fname,
+                     yang_stmt    *yspec,
+                     cxobj        *x0,
+                     cxobj       **xerr)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    FILE  *fp = NULL;
+    FILE  *fz = NULL;
+    cxobj *xs = NULL;
+    cxobj *xc;
+    int    ret;
+
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/%s", dir, fname);
+    if ((fp = fopen(cbuf_get(cb), "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "open(%s)", cbuf_get(cb));
+        goto done;
+    }
+    if ((ret = clixon_file_zstd_magic(fp)) < 0)
+        goto done;
+    if (ret == 1){
+#ifdef WITH_ZSTD
+        if ((fz = clixon_file_zstd_read(fp)) == NULL)
+            goto done;
+#else
+        clicon_err(OE_DB, 0, "%s is zstd-compressed but clixon is built without --enable-zstd",
+                   cbuf_get(cb));
+        goto done;
+#endif
+    }
+    if (clixon_xml_parse_file(fz ? fz : fp, YB_NONE, yspec, &xs, xerr) < 0)
+        goto done;
+    if (xml_child_nr(xs) > 0 &&
+        singleconfigroot(xs, &xs) < 0)
+        goto done;
+    while ((xc = xml_child_i_type(xs, 0, CX_ELMNT)) != NULL)
+        if (xml_addsub(x0, xc) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (xs)
+        xml_free(xs);
+    if (fz)
+        fclose(fz);
+    if (fp)
+        fclose(fp);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Common read function that reads an XML tree from file
  * @param[in]  th     Datastore text handle
  * @param[in]  db     Symbolic database name, eg "candidate", "running"
@@ -468,6 +675,8 @@ xmldb_readfile(clicon_handle    h,
     cxobj           *x0 = NULL;
     char            *dbfile = NULL;
     FILE            *fp = NULL;
+    FILE            *fz = NULL;  /* zstd decompression stream wrapping fp */
+    FILE            *fp1;        /* fz or fp: what the parser reads from */
     char            *format;
     int              ret;
     modstate_diff_t *msdiff = NULL;
@@ -480,6 +689,14 @@ xmldb_readfile(clicon_handle    h,
     cxobj           *xmodfile = NULL;
     cxobj           *x;
     yang_stmt       *yspec1 = NULL;
+    struct readfile_bind_arg rb = {0,};
+    int              bound = 0;      /* Set if subtrees yang-bound during parse */
+    int              sorted = 0;     /* Set if file carries the sorted-invariant marker */
+    cxobj           *xa;
+    char            *sharddir = NULL; /* Shard directory, see CLICON_XMLDB_SHARDED */
+    struct dirent   *shdp = NULL;    /* Shard dir entries */
+    int              nshards = 0;
+    int              i;
 
     if (yb != YB_MODULE && yb != YB_NONE){
         clicon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
@@ -495,23 +712,71 @@ xmldb_readfile(clicon_handle    h,
         clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
         goto done;
     }
+    /* Sharded layout: detect shard files on disk rather than by option, so a
+     * layout change is picked up transparently, see CLICON_XMLDB_SHARDED */
+    if (xmldb_shard_dir(h, db, &sharddir) < 0)
+        goto done;
+    if ((nshards = clicon_file_dirent(sharddir, &shdp, "_db$", S_IFREG)) < 0)
+        goto done;
     /* Parse file into internal XML tree from different formats */
     if ((fp = fopen(dbfile, "r")) == NULL) {
         clicon_err(OE_UNIX, errno, "open(%s)", dbfile);
         goto done;
-    }    
+    }
+    /* Transparently decompress zstd files, detected by magic so that plain
+     * and compressed files can be mixed, see CLICON_XMLDB_COMPRESS */
+    if ((ret = clixon_file_zstd_magic(fp)) < 0)
+        goto done;
+    if (ret == 1){
+#ifdef WITH_ZSTD
+        if (strcmp(format, "binary") == 0){
+            clicon_err(OE_DB, 0, "%s: binary datastore format cannot be compressed", dbfile);
+            goto done;
+        }
+        if ((fz = clixon_file_zstd_read(fp)) == NULL)
+            goto done;
+#else
+        clicon_err(OE_DB, 0, "%s is zstd-compressed but clixon is built without --enable-zstd", dbfile);
+        goto done;
+#endif
+    }
+    fp1 = fz ? fz : fp;
     /* Read whole datastore file on the form:
      * <config>
      *   modstate*  # this is analyzed, stripped and returned as msdiff in text_read_modstate
      *   config*
      * </config>
      * ret == 0 should not happen with YB_NONE. Binding is done later */
-    if (strcmp(format, "json")==0){
-        if (clixon_json_parse_file(fp, 1, YB_NONE, yspec, &x0, xerr) < 0) 
+    if (strcmp(format, "binary")==0){
+        /* mmap:ed image, materialized without running the XML parser */
+        if (clixon_bin2xml_fd(fileno(fp), &x0) < 0)
+            goto done;
+    }
+    else if (strcmp(format, "json")==0){
+        if (clixon_json_parse_file(fp1, 1, YB_NONE, yspec, &x0, xerr) < 0)
             goto done;
     }
     else {
-        if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0){
+        /* When the yang binding is known up front (no per-file module-state to
+         * analyze first) bind each config subtree as soon as it completes in
+         * the streaming parse, see xmldb_readfile_bind_cb. Depth 2 is the
+         * children of <config> under the parse top symbol. */
+        /* With shards, children are merged after the parse, so defer binding
+         * to the common xml_bind_yang path below */
+        if (yb == YB_MODULE && nshards == 0 &&
+            !clicon_option_bool(h, "CLICON_XMLDB_MODSTATE")){
+            rb.rb_h = h;
+            rb.rb_yspec = yspec;
+            rb.rb_xerr = xerr;
+            if (clixon_xml_parse_file_cb(fp1, YB_NONE, yspec, &x0,
+                                         xmldb_readfile_bind_cb, 2, &rb, xerr) < 0){
+                if (rb.rb_failed)
+                    goto fail;
+                goto done;
+            }
+            bound = 1;
+        }
+        else if (clixon_xml_parse_file(fp1, YB_NONE, yspec, &x0, xerr) < 0){
             goto done;
         }
     }
@@ -524,11 +789,23 @@ xmldb_readfile(clicon_handle    h,
             goto done;     
     }
     /* 2. File is not empty <top><config>...</config></top> -> replace root */
-    else{ 
+    else{
         /* There should only be one element and called config */
         if (singleconfigroot(x0, &x0) < 0)
             goto done;
     }
+    /* Sorted-invariant marker written by xmldb_writefile: remember it so the resort
+     * below can be skipped, and strip it since it is a file artifact */
+    if ((xa = xml_find_type(x0, NULL, DATASTORE_SORTED_ATTR, CX_ATTR)) != NULL){
+        if (xml_value(xa) && strcmp(xml_value(xa), "true") == 0)
+            sorted = 1;
+        if (xml_purge(xa) < 0)
+            goto done;
+    }
+    /* Sharded layout: merge each shard file as top-level children of x0 */
+    for (i = 0; i < nshards; i++)
+        if (xmldb_readfile_shard(h, sharddir, shdp[i].d_name, yspec, x0, xerr) < 0)
+            goto done;
     /* Purge all top-level body objects */
     x = NULL;
     while ((x = xml_find_type(x0, NULL, "body", CX_BODY)) != NULL)
@@ -617,13 +894,31 @@ xmldb_readfile(clicon_handle    h,
                 }
             }
         } /* if msdiff */
-        /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT 
-         */
-        if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec1?yspec1:yspec, xerr)) < 0)
+        /* Eagerly populate namespace caches in a single downward pass so that
+         * the bind and sort below do not re-walk ancestors per node */
+        if (xml_nsctx_populate(x0) < 0)
             goto done;
-        if (ret == 0)
-            goto fail;
-        if (xml_sort_recurse(x0) < 0)
+        /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT
+         */
+        if (!bound){
+            if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec1?yspec1:yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        /* Skip the resort when the file was serialized from an already sorted cache
+         * (sorted marker). Not trusted when shard files were merged (top-level order
+         * is per shard) or when the module-state differs from the running yang (the
+         * sort order may have changed with the schema) */
+        if (!sorted || nshards > 0 ||
+            (msdiff && msdiff->md_diff && xml_child_nr(msdiff->md_diff) > 0)){
+            if (xml_sort_recurse(x0) < 0)
+                goto done;
+        }
+        /* Replay edits journaled since the file was last compacted,
+         * see CLICON_XMLDB_JOURNAL */
+        if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL") &&
+            xmldb_journal_replay(h, db, yspec1?yspec1:yspec, x0) < 0)
             goto done;
     }
     if (xp){
@@ -643,10 +938,16 @@ xmldb_readfile(clicon_handle    h,
         xml_free(xmodfile);
     if (msdiff)
         modstate_diff_free(msdiff);
+    if (fz)
+        fclose(fz);
     if (fp)
         fclose(fp);
     if (dbfile)
         free(dbfile);
+    if (shdp)
+        free(shdp);
+    if (sharddir)
+        free(sharddir);
     if (x0)
         xml_free(x0);
     return retval;
@@ -817,6 +1118,215 @@ xmldb_get_nocache(clicon_handle    h,
     goto done;
 }
 
+#ifdef XMLDB_XPATH_NSFILTER
+/*! Hash a namespace URI to a single bit for the subtree namespace bitmaps
+ * FNV-1a folded to one of 64 bits. Collisions are safe: they can only prevent
+ * a skip, never cause one.
+ */
+static uint64_t
+nsmap_bit(const char *ns)
+{
+    uint32_t h = 0x811c9dc5;
+
+    for (; *ns; ns++){
+        h ^= (uint8_t)*ns;
+        h *= 0x01000193;
+    }
+    return 1ULL << (h & 0x3f);
+}
+
+/*! Collect bits of the namespaces declared by xmlns attributes on one node
+ */
+static int
+nsmap_decls(cxobj    *x,
+            uint64_t *bm)
+{
+    cxobj *xa = NULL;
+
+    while ((xa = xml_child_each(x, xa, CX_ATTR)) != NULL) {
+        if ((xml_prefix(xa) != NULL && strcmp(xml_prefix(xa), "xmlns") == 0) ||
+            (xml_prefix(xa) == NULL && strcmp(xml_name(xa), "xmlns") == 0))
+            if (xml_value(xa))
+                *bm |= nsmap_bit(xml_value(xa));
+    }
+    return 0;
+}
+
+/*! Collect bits of all namespaces declared in a subtree
+ * Every namespace used below x is declared by an xmlns attribute at or above it
+ * (XML namespace scoping), so the declarations in the subtree plus the bits
+ * inherited from above x cover everything present beneath x.
+ */
+static int
+nsmap_subtree(cxobj    *x,
+              uint64_t *bm)
+{
+    cxobj *xc = NULL;
+
+    nsmap_decls(x, bm);
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+        if (nsmap_subtree(xc, bm) < 0)
+            return -1;
+    return 0;
+}
+
+/*! (Re)build the per top-level subtree namespace bitmaps of a datastore cache entry
+ * @param[in,out] de   Datastore cache entry, de_nsmap/de_nsserial written
+ * @param[in]     x0t  Top of the cached tree
+ * @retval        0    OK
+ * @retval       -1    Error
+ */
+static int
+nsmap_build(db_elmnt *de,
+            cxobj    *x0t)
+{
+    int       retval = -1;
+    uint64_t  topbm = 0;
+    uint64_t *bm = NULL;
+    size_t    n;
+    cxobj    *xc;
+    int       i;
+
+    if (de->de_nsmap){
+        free(de->de_nsmap);
+        de->de_nsmap = NULL;
+    }
+    de->de_nsmaplen = 0;
+    if ((n = xml_child_nr_type(x0t, CX_ELMNT)) == 0)
+        goto ok; /* Empty db: nothing to skip */
+    /* Declarations on the root are inherited by all subtrees */
+    nsmap_decls(x0t, &topbm);
+    if ((bm = calloc(n, sizeof(uint64_t))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i = 0;
+    xc = NULL;
+    while ((xc = xml_child_each(x0t, xc, CX_ELMNT)) != NULL && i < n){
+        bm[i] = topbm;
+        if (nsmap_subtree(xc, &bm[i]) < 0)
+            goto done;
+        i++;
+    }
+    de->de_nsmap = bm;
+    bm = NULL;
+    de->de_nsmaplen = n;
+ ok:
+    de->de_nsserial = de->de_serial;
+    retval = 0;
+ done:
+    if (bm)
+        free(bm);
+    return retval;
+}
+
+/*! Collect the namespaces a parsed xpath can touch, as bits
+ * @param[in]     xs   Parsed xpath (sub)tree
+ * @param[in]     nsc  Namespace context of the xpath
+ * @param[in,out] qbm  Bits of all node test namespaces accumulated
+ * @retval        1    All node tests resolved, qbm complete
+ * @retval        0    Cannot pre-filter (wildcard, node()/text(), unresolved prefix)
+ */
+static int
+nsmap_xpath_bits(xpath_tree *xs,
+                 cvec       *nsc,
+                 uint64_t   *qbm)
+{
+    char *ns;
+
+    if (xs == NULL)
+        return 1;
+    switch (xs->xs_type){
+    case XP_STEP:
+        if (xs->xs_c0 == NULL)
+            return 0; /* No nodetest: matches any node */
+        break;
+    case XP_NODE:
+        if (xs->xs_s1 == NULL || strcmp(xs->xs_s1, "*") == 0)
+            return 0; /* Wildcard matches any namespace */
+        if ((ns = xml_nsctx_get(nsc, xs->xs_s0)) == NULL)
+            return 0; /* Prefix (or default namespace) not in context */
+        *qbm |= nsmap_bit(ns);
+        break;
+    case XP_NODE_FN:
+        return 0; /* node()/text() match any name */
+    default:
+        break;
+    }
+    if (nsmap_xpath_bits(xs->xs_c0, nsc, qbm) == 0)
+        return 0;
+    return nsmap_xpath_bits(xs->xs_c1, nsc, qbm);
+}
+
+/*! Flag top-level subtrees that cannot contain any match of xpath
+ *
+ * Pre-filter for xpath evaluation over a cached datastore tree: the namespace
+ * bitmap summary in the db_elmnt entry (rebuilt lazily when the write serial
+ * moves) is matched against the set of namespaces the xpath can touch. A
+ * subtree sharing no namespace with the query cannot produce a match wherever
+ * evaluation looks in it, so it is flagged XML_FLAG_SKIP and the xpath engine
+ * does not descend into it, see nodetest_recursive()/xp_eval_step().
+ * Conservative: wildcards, node tests without a resolvable namespace and hash
+ * collisions all fall back to filtering nothing.
+ * @param[in]  de     Datastore cache entry holding the summary, or NULL
+ * @param[in]  x0t    Top of the cached tree
+ * @param[in]  nsc    Namespace context of the xpath, or NULL
+ * @param[in]  xpath  XPath about to be evaluated over x0t, or NULL
+ * @retval     1      Pre-filter applied, clear flags with xmldb_nsmap_prefilter_clear
+ * @retval     0      Pre-filter not applicable, no flags set
+ * @retval    -1      Error
+ */
+static int
+xmldb_nsmap_prefilter(db_elmnt   *de,
+                      cxobj      *x0t,
+                      cvec       *nsc,
+                      const char *xpath)
+{
+    int         retval = -1;
+    xpath_tree *xpt = NULL;
+    uint64_t    qbm = 0;
+    cxobj      *xc;
+    int         i;
+
+    if (de == NULL || nsc == NULL || xpath == NULL)
+        goto skip;
+    if (de->de_nsmap == NULL || de->de_nsserial != de->de_serial)
+        if (nsmap_build(de, x0t) < 0)
+            goto done;
+    if (de->de_nsmaplen != xml_child_nr_type(x0t, CX_ELMNT))
+        goto skip; /* Stale summary (should not happen): do not filter */
+    if (xpath_parse(xpath, &xpt) < 0)
+        goto done;
+    if (nsmap_xpath_bits(xpt, nsc, &qbm) == 0 || qbm == 0)
+        goto skip;
+    i = 0;
+    xc = NULL;
+    while ((xc = xml_child_each(x0t, xc, CX_ELMNT)) != NULL)
+        if ((de->de_nsmap[i++] & qbm) == 0)
+            xml_flag_set(xc, XML_FLAG_SKIP);
+    retval = 1;
+ done:
+    if (xpt)
+        xpath_tree_free(xpt);
+    return retval;
+ skip:
+    retval = 0;
+    goto done;
+}
+
+/*! Clear skip flags set by xmldb_nsmap_prefilter
+ */
+static int
+xmldb_nsmap_prefilter_clear(cxobj *x0t)
+{
+    cxobj *xc = NULL;
+
+    while ((xc = xml_child_each(x0t, xc, CX_ELMNT)) != NULL)
+        xml_flag_reset(xc, XML_FLAG_SKIP);
+    return 0;
+}
+#endif /* XMLDB_XPATH_NSFILTER */
+
 /*! Get content of database using xpath. return a set of matching sub-trees
  * The function returns a minimal tree that includes all sub-trees that match
  * xpath.
@@ -827,6 +1337,8 @@ xmldb_get_nocache(clicon_handle    h,
  * @param[in]  nsc    External XML namespace context, or NULL
  * @param[in]  xpath  String with XPATH syntax. or NULL for all
  * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[in]  depth  Pruning hint: levels below top to copy, -1 is all. Nodes deeper
+ *                    than depth are never copied, defaulted or NACM-checked
  * @param[out] xtop   Single return XML tree. Free with xml_free()
  * @param[out] msdiff If set, return modules-state differences
  * @param[out] xerr   XML error if retval is 0
@@ -838,11 +1350,12 @@ xmldb_get_nocache(clicon_handle    h,
  */
 static int
 xmldb_get_cache(clicon_handle     h,
-                const char       *db, 
+                const char       *db,
                 yang_bind         yb,
                 cvec             *nsc,
                 const char       *xpath,
                 withdefaults_type wdef,
+                int32_t           depth,
                 cxobj           **xtop,
                 modstate_diff_t  *msdiff,
                 cxobj           **xerr)
@@ -859,6 +1372,10 @@ xmldb_get_cache(clicon_handle     h,
     cxobj     *x1t = NULL;
     db_elmnt   de0 = {0,};
     int        ret;
+    int        defaults_in_cache = 0;
+#ifdef XMLDB_XPATH_NSFILTER
+    int        prefiltered = 0;
+#endif
 
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clicon_err(OE_YANG, ENOENT, "No yang spec");
@@ -888,14 +1405,6 @@ xmldb_get_cache(clicon_handle     h,
             goto done;
         if (ret == 0)
             ; /* XXX */
-        else {
-            /* Add default global values (to make xpath below include defaults) */
-            if (xml_global_defaults(h, x0t, nsc, xpath, yspec, 0) < 0)
-                goto done;
-            /* Add default recursive values */
-            if (xml_default_recurse(x0t, 0) < 0)
-                goto done;
-        }
     }
     /* Here x0t looks like: <config>...</config> */
     /* Given the xpath, return a vector of matches in xvec 
@@ -906,6 +1415,22 @@ xmldb_get_cache(clicon_handle     h,
      *   a) for every node that is found, copy to new tree
      *   b) if config dont dont state data
      */
+#ifdef XMLDB_XPATH_NSFILTER
+    if ((prefiltered = xmldb_nsmap_prefilter(clicon_db_elmnt_get(h, db), x0t, nsc, xpath)) < 0)
+        goto done;
+#endif
+    /* A real filter is evaluated against materialized defaults so predicates can
+     * select on default-valued leaves, as when defaults lived in the cache; they
+     * are stripped again in the exit path. Unfiltered gets keep the cache
+     * untouched and get defaults in the reply copy only
+     */
+    if (xpath != NULL && strcmp(xpath, "/") != 0){
+        if (xml_global_defaults(h, x0t, nsc, xpath, yspec, 0) < 0)
+            goto done;
+        if (xml_default_recurse(x0t, 0) < 0)
+            goto done;
+        defaults_in_cache = 1;
+    }
     if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
 
@@ -915,14 +1440,15 @@ xmldb_get_cache(clicon_handle     h,
     xml_flag_set(x1t, XML_FLAG_TOP);    
     xml_spec_set(x1t, xml_spec(x0t));
     
-    if (xlen < 1000){
+    if (xlen < 1000 || depth >= 0){
         /* This is optimized for the case when the tree is large and xlen is small
          * If the tree is large and xlen too, then the other is better.
          * This only works if yang bind
+         * A depth limit always goes here: the per-match copy prunes below depth
          */
         for (i=0; i<xlen; i++){
             x0 = xvec[i];
-            if (xml_copy_from_bottom(x0t, x0, x1t) < 0) /* config */
+            if (xml_copy_from_bottom(x0t, x0, x1t, depth) < 0) /* config */
                 goto done;
         }
     }
@@ -938,16 +1464,27 @@ xmldb_get_cache(clicon_handle     h,
         }
         if (xml_copy_marked(x0t, x1t) < 0) /* config */
             goto done;
-        if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
-            goto done;
+        /* Clear the flags in the original tree. Only the matches and their ancestors were
+         * flagged above, so clear via the match vector instead of a full-tree pass, which
+         * matters when the match set (eg a pagination window) is much smaller than the tree
+         */
+        for (i=0; i<xlen; i++){
+            x0 = xvec[i];
+            xml_flag_reset(x0, XML_FLAG_MARK);
+            xml_apply_ancestor(x0, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_CHANGE);
+        }
         if (xml_apply(x1t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE)) < 0)
             goto done;
     }
-    /* Original tree: Remove global defaults and empty non-presence containers */
-    if (xml_defaults_nopresence(x0t, 2) < 0)
-        goto done;
+    /* Defaults are materialized in the private reply copy below, the shared cache tree
+     * is kept default-free so it is never mutated and re-stripped per read
+     */
     switch (wdef){
     case WITHDEFAULTS_REPORT_ALL:
+        if (xml_global_defaults(h, x1t, nsc, xpath, yspec, 0) < 0)
+            goto done;
+        if (xml_default_recurse(x1t, 0) < 0)
+            goto done;
         break;
     case WITHDEFAULTS_TRIM:
         /* Mark and remove nodes having schema default values */
@@ -955,7 +1492,7 @@ xmldb_get_cache(clicon_handle     h,
             goto done;
         if (xml_tree_prune_flags(x1t, XML_FLAG_MARK, XML_FLAG_MARK)
             < 0)
-            goto done;        
+            goto done;
         if (xml_defaults_nopresence(x1t, 1) < 0)
             goto done;
         break;
@@ -966,6 +1503,10 @@ xmldb_get_cache(clicon_handle     h,
     case WITHDEFAULTS_REPORT_ALL_TAGGED:{
         cxobj *x;
         char  *ns;
+        if (xml_global_defaults(h, x1t, nsc, xpath, yspec, 0) < 0)
+            goto done;
+        if (xml_default_recurse(x1t, 0) < 0)
+            goto done;
         x = NULL;
         while ((x = xml_child_each(x1t, x, CX_ELMNT)) != NULL){
             ns = NULL;
@@ -1000,6 +1541,14 @@ xmldb_get_cache(clicon_handle     h,
     retval = 1;
  done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+#ifdef XMLDB_XPATH_NSFILTER
+    if (prefiltered == 1)
+        xmldb_nsmap_prefilter_clear(x0t);
+#endif
+    /* Remove selection-time defaults and empty non-presence containers again */
+    if (defaults_in_cache &&
+        xml_defaults_nopresence(x0t, 2) < 0)
+        retval = -1;
     if (xvec)
         free(xvec);
     return retval;
@@ -1072,8 +1621,20 @@ xmldb_get_zerocopy(clicon_handle    h,
         x0t = de->de_xml;
 
     /* Here xt looks like: <config>...</config> */
+#ifdef XMLDB_XPATH_NSFILTER
+    if ((ret = xmldb_nsmap_prefilter(clicon_db_elmnt_get(h, db), x0t, nsc, xpath)) < 0)
+        goto done;
+    if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0){
+        if (ret == 1)
+            xmldb_nsmap_prefilter_clear(x0t);
+        goto done;
+    }
+    if (ret == 1)
+        xmldb_nsmap_prefilter_clear(x0t);
+#else
     if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
+#endif
     /* Iterate through the match vector
      * For every node found in x0, mark the tree up to t1
      */
@@ -1147,6 +1708,12 @@ xmldb_get_zerocopy(clicon_handle    h,
     if (clicon_debug_get() > 1)
         if (clixon_xml2file(stderr, x0t, 0, 1, fprintf, 0, 0) < 0)
             goto done;
+    /* Snapshot semantics: the caller holds a reader reference on the cache tree
+     * until xmldb_get0_free. A writer meanwhile clones the cache before modifying
+     * (see xmldb_cache_unshare) or orphans it when replacing (see xmldb_ref_orphan),
+     * so the returned tree stays valid and is reclaimed at last release */
+    if (xmldb_ref_incr(h, x0t) < 0)
+        goto done;
     *xtop = x0t;
     retval = 1;
  done:
@@ -1237,9 +1804,9 @@ xmldb_get(clicon_handle    h,
  *   (the existing tree is discarded), the default (empty) xml tree is:
  *      <c><x>0</x></c>
  */
-int 
+int
 xmldb_get0(clicon_handle    h,
-           const char      *db, 
+           const char      *db,
            yang_bind        yb,
            cvec            *nsc,
            const char      *xpath,
@@ -1248,40 +1815,96 @@ xmldb_get0(clicon_handle    h,
            cxobj          **xret,
            modstate_diff_t *msdiff,
            cxobj          **xerr)
+{
+    return xmldb_get0_depth(h, db, yb, nsc, xpath, copy, wdef, -1, xret, msdiff, xerr);
+}
+
+/*! Depth-limited variant of get content of database
+ *
+ * As xmldb_get0, but with a retrieval-time depth limit: in the cached copy case,
+ * nodes deeper than depth levels below the top are never copied, so they are also
+ * never defaulted or NACM-checked downstream. Intended for RESTCONF/NETCONF depth
+ * query parameter pushdown, where the reply is cut at depth anyway.
+ * The limit is a pruning hint, not a guarantee: the no-cache file read returns the
+ * full match, and the caller is expected to serialize with the same depth, see
+ * clixon_xml2cbuf which applies the definite limit.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  yb     How to bind yang to XML top-level when parsing (if YB_NONE, no defaults)
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax. or NULL for all
+ * @param[in]  copy   Force copy. Overrides cache_zerocopy -> cache
+ * @param[in]  wdef   With-defaults parameter, see RFC 6243
+ * @param[in]  depth  Levels below top to retrieve: -1 is all, 0 is none. If >= 0,
+ *                    zerocopy is overridden to copy (the shared cache cannot be pruned)
+ * @param[out] xret   Single return XML tree. Free with xml_free()
+ * @param[out] msdiff If set, return modules-state differences (upgrade code)
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     -1     General error, check specific clicon_errno, clicon_suberrno
+ * @retval     0      Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval     1      OK
+ * @note Use of 1 for OK
+ * @see xmldb_get0  for the unlimited variant and usage example
+ */
+int
+xmldb_get0_depth(clicon_handle    h,
+                 const char      *db,
+                 yang_bind        yb,
+                 cvec            *nsc,
+                 const char      *xpath,
+                 int              copy,
+                 withdefaults_type wdef,
+                 int32_t          depth,
+                 cxobj          **xret,
+                 modstate_diff_t *msdiff,
+                 cxobj          **xerr)
 {
     int               retval = -1;
+    uint64_t          slow_t0 = 0;
+    uint64_t          slow_dt;
 
+    clixon_rpc_stats_stage_begin(h, RPC_STATS_XMLDB);
+    if (clixon_log_slow_get() != 0)
+        slow_t0 = clixon_log_slow_ns();
     if (xret == NULL){
         clicon_err(OE_DB, EINVAL, "xret is NULL");
         goto done;
     }
     switch (clicon_datastore_cache(h)){
     case DATASTORE_NOCACHE:
-        /* Read from file into created/copy tree, prune non-matching xpath 
+        /* Read from file into created/copy tree, prune non-matching xpath
          * Add default values in copy
          * Copy deleted by xmldb_free
          */
         retval = xmldb_get_nocache(h, db, yb, nsc, xpath, wdef, xret, msdiff, xerr);
         break;
     case DATASTORE_CACHE_ZEROCOPY:
-        /* Get cache (file if empty) mark xpath match in original tree 
+        /* Get cache (file if empty) mark xpath match in original tree
          * add default values in original tree and return that.
          * Default values and markings removed in xmldb_clear
+         * A depth limit forces a copy: the shared cache cannot be pruned
          */
-        if (!copy){
+        if (!copy && depth < 0){
             retval = xmldb_get_zerocopy(h, db, yb, nsc, xpath, wdef, xret, msdiff, xerr);
             break;
         }
         /* fall through */
     case DATASTORE_CACHE:
-        /* Get cache (file if empty) mark xpath match and copy marked into copy 
+    case DATASTORE_CACHE_COW:
+        /* Get cache (file if empty) mark xpath match and copy marked into copy
          * Add default values in copy, return copy
          * Copy deleted by xmldb_free
          */
-        retval = xmldb_get_cache(h, db, yb, nsc, xpath, wdef, xret, msdiff, xerr);
+        retval = xmldb_get_cache(h, db, yb, nsc, xpath, wdef, depth, xret, msdiff, xerr);
         break;
     }
  done:
+    clixon_rpc_stats_stage_end(h, RPC_STATS_XMLDB);
+    /* Slow-op log, see CLICON_LOG_SLOW_MS */
+    if (slow_t0 != 0 &&
+        (slow_dt = clixon_log_slow_ns() - slow_t0) >= (uint64_t)clixon_log_slow_get()*1000000ull)
+        clicon_log(LOG_WARNING, "slow xmldb_get: %" PRIu64 "ms db:%s xpath:%s retval:%d",
+                   slow_dt/1000000, db, xpath?xpath:"/", retval);
     return retval;
 }
 
@@ -1318,13 +1941,18 @@ xmldb_get0_clear(clicon_handle    h,
 }
 
 /*! Free xml tree obtained with xmldb_get0
+ *
+ * In zerocopy mode the tree is the cache itself and the reader reference taken
+ * by xmldb_get_zerocopy is released here: if a writer replaced the cache while
+ * the reader held it, the last release frees the old tree, see xmldb_ref_orphan.
  * @param[in]     h   Clixon handle
- * @param[in,out] xp  Pointer to XML cache. 
- * @retval     0      Always.
+ * @param[in,out] xp  Pointer to XML cache.
+ * @retval     0      OK
+ * @retval    -1      Error: reference release failed
  * @see xmldb_get0
  */
-int 
-xmldb_get0_free(clicon_handle    h, 
+int
+xmldb_get0_free(clicon_handle    h,
                cxobj          **xp)
 {
     if (*xp == NULL)
@@ -1333,7 +1961,241 @@ xmldb_get0_free(clicon_handle    h,
      * xml_free can fail (if **xp not obtained using xmldb_get0) */
     if (clicon_datastore_cache(h) != DATASTORE_CACHE_ZEROCOPY)
         xml_free(*xp);
+    /* Refcnt guard: trees obtained with copy=1 in zerocopy mode hold no reference */
+    else if (xmldb_ref_cnt(h, *xp) > 0 &&
+             xmldb_ref_release(h, *xp) < 0)
+        return -1;
     *xp = NULL;
     return 0;
 }
 
+/*! Get a refcounted read-only reference to the datastore cache tree
+ *
+ * Shared-read alternative to xmldb_get0: the caller gets the cache tree itself
+ * without any copying, holding a reference, and must treat the tree as immutable.
+ * If a writer modifies the datastore while references are outstanding, the cache
+ * is cloned first (see xmldb_cache_unshare), so the referenced tree stays valid
+ * and unchanged until released: the copy is deferred to the writer, and read-only
+ * consumers of large configs avoid cloning multi-MB trees per get.
+ * @param[in]  h      Clicon handle
+ * @param[in]  db     Name of datastore, eg "running"
+ * @param[in]  nsc    External XML namespace context, or NULL
+ * @param[in]  xpath  String with XPATH syntax, or NULL for all
+ * @param[out] xvec   If set, malloced vector of xpath matches in the tree. Free after use
+ * @param[out] xlen   Length of xvec
+ * @param[out] xret   Referenced XML cache tree. Release with xmldb_ref_release()
+ * @param[out] xerr   XML error if retval is 0
+ * @retval     1      OK
+ * @retval     0      Parse OK but yang assigment not made and xerr set
+ * @retval    -1      Error
+ * @code
+ *   cxobj  *xt = NULL;
+ *   cxobj **xvec = NULL;
+ *   size_t  xlen = 0;
+ *   if (xmldb_get_ref(h, "running", nsc, "/interfaces", &xvec, &xlen, &xt, NULL) < 0)
+ *      err;
+ *   ... read-only use of xvec[0..xlen] ...
+ *   free(xvec);
+ *   xmldb_ref_release(h, xt);
+ * @endcode
+ * @note The tree is the raw default-free cache: no default nodes are materialized
+ *       and no with-defaults variant applies, use xmldb_get0 for that
+ * @note Requires a datastore cache, ie CLICON_DATASTORE_CACHE != nocache
+ * @see xmldb_get0  for the copying (or zerocopy-mutating) API
+ */
+int
+xmldb_get_ref(clicon_handle h,
+              const char   *db,
+              cvec         *nsc,
+              const char   *xpath,
+              cxobj      ***xvec,
+              size_t       *xlen,
+              cxobj       **xret,
+              cxobj       **xerr)
+{
+    int        retval = -1;
+    yang_stmt *yspec;
+    cxobj     *x0t = NULL;
+    db_elmnt  *de = NULL;
+    db_elmnt   de0 = {0,};
+    int        ret;
+
+    if (xret == NULL){
+        clicon_err(OE_DB, EINVAL, "xret is NULL");
+        goto done;
+    }
+    if (clicon_datastore_cache(h) == DATASTORE_NOCACHE){
+        clicon_err(OE_DB, EINVAL, "Datastore cache required, see CLICON_DATASTORE_CACHE");
+        goto done;
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    de = clicon_db_elmnt_get(h, db);
+    if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &x0t, &de0, NULL, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        de0.de_xml = x0t;
+        if (de)
+            de0.de_id = de->de_id;
+        clicon_db_elmnt_set(h, db, &de0); /* Content is copied */
+    }
+    else
+        x0t = de->de_xml;
+    if (xvec != NULL){
+#ifdef XMLDB_XPATH_NSFILTER
+        if ((ret = xmldb_nsmap_prefilter(clicon_db_elmnt_get(h, db), x0t, nsc, xpath)) < 0)
+            goto done;
+        if (xpath_vec(x0t, nsc, "%s", xvec, xlen, xpath?xpath:"/") < 0){
+            if (ret == 1)
+                xmldb_nsmap_prefilter_clear(x0t);
+            goto done;
+        }
+        if (ret == 1)
+            xmldb_nsmap_prefilter_clear(x0t);
+#else
+        if (xpath_vec(x0t, nsc, "%s", xvec, xlen, xpath?xpath:"/") < 0)
+            goto done;
+#endif
+    }
+    if (xmldb_ref_incr(h, x0t) < 0)
+        goto done;
+    *xret = x0t;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+
+/*! Compute the difference between two datastores as two pruned trees
+ *
+ * Both datastores are read through the datastore cache and diffed in memory;
+ * the returned trees hold only the differing subtrees plus their ancestor
+ * context including list keys, so their size is proportional to the change
+ * and not to the datastore size, see the datastore-diff rpc.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db1   Name of source datastore, eg "running"
+ * @param[in]  db2   Name of target datastore, eg "candidate"
+ * @param[out] xd1p  Subtrees only in db1 and changed original values. Free with xml_free
+ * @param[out] xd2p  Subtrees only in db2 and changed wanted values. Free with xml_free
+ * @param[out] xerr  XML error if retval is 0
+ * @retval     1     OK
+ * @retval     0     Failed, xerr set
+ * @retval    -1     Error
+ * @see xml_diff  for the diff semantics
+ */
+int
+xmldb_diff(clicon_handle h,
+           const char   *db1,
+           const char   *db2,
+           cxobj       **xd1p,
+           cxobj       **xd2p,
+           cxobj       **xerr)
+{
+    int         retval = -1;
+    yang_stmt  *yspec;
+    int         usecache = 0;
+    cxobj      *x1t = NULL;
+    cxobj      *x2t = NULL;
+    cxobj      *xd1 = NULL;
+    cxobj      *xd2 = NULL;
+    cxobj     **dvec = NULL;  /* removed: only in db1 */
+    int         dlen = 0;
+    cxobj     **avec = NULL;  /* added: only in db2 */
+    int         alen = 0;
+    cxobj     **scvec = NULL; /* changed: original values */
+    cxobj     **tcvec = NULL; /* changed: wanted values */
+    int         clen = 0;
+    int         i;
+    int         ret;
+
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    usecache = (clicon_datastore_cache(h) != DATASTORE_NOCACHE);
+    if (usecache){
+        /* Read-only references to the cache trees, no copying */
+        if ((ret = xmldb_get_ref(h, db1, NULL, "/", NULL, NULL, &x1t, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if ((ret = xmldb_get_ref(h, db2, NULL, "/", NULL, NULL, &x2t, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    else{
+        if ((ret = xmldb_get0(h, db1, YB_MODULE, NULL, "/", 1, 0, &x1t, NULL, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if ((ret = xmldb_get0(h, db2, YB_MODULE, NULL, "/", 1, 0, &x2t, NULL, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (xml_diff(yspec, x1t, x2t,
+                 &dvec, &dlen,
+                 &avec, &alen,
+                 &scvec, &tcvec, &clen) < 0)
+        goto done;
+    if ((xd1 = xml_new(xml_name(x1t), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_spec_set(xd1, xml_spec(x1t));
+    if ((xd2 = xml_new(xml_name(x2t), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_spec_set(xd2, xml_spec(x2t));
+    for (i=0; i<dlen; i++)
+        if (xml_copy_from_bottom(x1t, dvec[i], xd1, -1) < 0)
+            goto done;
+    for (i=0; i<alen; i++)
+        if (xml_copy_from_bottom(x2t, avec[i], xd2, -1) < 0)
+            goto done;
+    for (i=0; i<clen; i++){
+        if (xml_copy_from_bottom(x1t, scvec[i], xd1, -1) < 0)
+            goto done;
+        if (xml_copy_from_bottom(x2t, tcvec[i], xd2, -1) < 0)
+            goto done;
+    }
+    *xd1p = xd1;
+    xd1 = NULL;
+    *xd2p = xd2;
+    xd2 = NULL;
+    retval = 1;
+ done:
+    if (x1t){
+        if (usecache)
+            xmldb_ref_release(h, x1t);
+        else
+            xml_free(x1t);
+    }
+    if (x2t){
+        if (usecache)
+            xmldb_ref_release(h, x2t);
+        else
+            xml_free(x2t);
+    }
+    if (dvec)
+        free(dvec);
+    if (avec)
+        free(avec);
+    if (scvec)
+        free(scvec);
+    if (tcvec)
+        free(tcvec);
+    if (xd1)
+        xml_free(xd1);
+    if (xd2)
+        xml_free(xd2);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
@@ -45,6 +45,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -62,6 +63,7 @@
 #include "clixon_hash.h"
 #include "clixon_handle.h"
 #include "clixon_log.h"
+#include "clixon_event.h"
 #include "clixon_file.h"
 #include "clixon_yang.h"
 #include "clixon_xml.h"
@@ -78,11 +80,15 @@
 #include "clixon_yang_schema_mount.h"
 #include "clixon_xml_nsctx.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_bin.h"
+#include "clixon_xml_bind.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_map.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_rpc_stats.h"
+#include "clixon_usdt.h"
 
 /*! Given an attribute name and its expected namespace, find its value
  * 
@@ -428,6 +434,365 @@ choice_delete_other(cxobj     *x0,
     return retval;
 }
 
+/*! Check if a new subtree can be spliced from the edit payload as-is
+ *
+ * A payload subtree with no corresponding base node can be moved directly
+ * into the base tree (see text_modify_steal) instead of being rebuilt
+ * node-by-node, but only if nothing in it needs the per-node processing of
+ * text_modify. Fall back to the copying path if the subtree contains:
+ * - attributes other than xmlns declarations (embedded operation, insert,
+ *   objectcreate, etc)
+ * - nodes whose yang is tagged with a when-condition (checked per node)
+ * - leaf bodies that are rewritten on copy (identityref namespace checks,
+ *   enumeration/bits trimming, empty-string normalization)
+ * - children without (or with foreign) yang binding
+ * @param[in]  x1  Payload subtree
+ * @param[in]  y0  Yang spec of x1
+ * @retval     1   OK to splice
+ * @retval     0   Needs the per-node copying path
+ * @retval    -1   Error
+ */
+static int
+text_modify_steal_ok(cxobj     *x1,
+                     yang_stmt *y0)
+{
+    int        retval = -1;
+    cxobj     *xc;
+    cxobj     *xa;
+    char      *prefix;
+    yang_stmt *yc;
+    yang_stmt *yrestype = NULL;
+    char      *restype;
+    int        ret;
+
+    if (yang_when_xpath_get(y0) != NULL)
+        goto fallback;
+    xa = NULL;
+    while ((xa = xml_child_each(x1, xa, CX_ATTR)) != NULL) {
+        prefix = xml_prefix(xa);
+        if ((prefix == NULL && strcmp(xml_name(xa), "xmlns") == 0) ||
+            (prefix != NULL && strcmp(prefix, "xmlns") == 0))
+            continue; /* namespace declarations travel with the subtree */
+        goto fallback;
+    }
+    switch (yang_keyword_get(y0)){
+    case Y_LEAF:
+    case Y_LEAF_LIST:
+        if (xml_child_nr_type(x1, CX_ELMNT)) /* malformed, let copy path report */
+            goto fallback;
+        if (yang_type_get(y0, NULL, &yrestype, NULL, NULL, NULL, NULL, NULL) < 0)
+            goto done;
+        if (yrestype == NULL)
+            goto fallback;
+        restype = yang_argument_get(yrestype);
+        if (strcmp(restype, "identityref") == 0 ||
+            strcmp(restype, "enumeration") == 0 ||
+            strcmp(restype, "bits") == 0)
+            goto fallback;
+        /* empty string leaf gets an explicit empty body on copy */
+        if (xml_body(x1) == NULL && strcmp(restype, "string") == 0)
+            goto fallback;
+        break;
+    case Y_CONTAINER:
+    case Y_LIST:
+        xc = NULL;
+        while ((xc = xml_child_each(x1, xc, CX_ELMNT)) != NULL) {
+            if ((yc = yang_find_datanode(y0, xml_name(xc))) == NULL ||
+                yc != xml_spec(xc))
+                goto fallback;
+            if ((ret = text_modify_steal_ok(xc, yc)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fallback;
+        }
+        break;
+    default: /* anyxml/anydata etc */
+        goto fallback;
+    }
+    retval = 1;
+ done:
+    return retval;
+ fallback:
+    retval = 0;
+    goto done;
+}
+
+/*! Post-splice fixup of a stolen subtree: namespaces and sort order
+ *
+ * Namespace declarations that x1 inherited from payload ancestors are
+ * re-declared on x1 so no binding is lost, cf the x0==NULL case of
+ * xml_merge1, and the subtree is sorted to base-tree order.
+ * @param[in]  x1   Subtree, already inserted in the base tree
+ * @param[in]  nsc  Namespace context of x1 captured before the splice
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+text_modify_steal_post(cxobj *x1,
+                       cvec  *nsc)
+{
+    int     retval = -1;
+    cg_var *cv;
+    char   *px;
+    char   *pxe;
+    char   *ns;
+    int     ret;
+
+    cv = NULL;
+    while ((cv = cvec_each(nsc, cv)) != NULL){
+        px = cv_name_get(cv);
+        ns = cv_string_get(cv);
+        /* Check if namespace exists */
+        if ((ret = xml2prefix(x1, ns, &pxe)) < 0)
+            goto done;
+        if (ret == 0 ||  /* Not exist */
+            clicon_strcmp(px, pxe) != 0){ /* Exists and not equal (can be NULL) */
+            if (xmlns_set(x1, px, ns) < 0)
+                goto done;
+            xml_sort(x1);
+        }
+    }
+    /* Payload children are in request order, base tree is kept sorted */
+    if (xml_sort_recurse(x1) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Splice a new payload subtree directly into the base tree
+ *
+ * Move semantics: x1 is removed from the payload tree and re-parented under
+ * x0p, avoiding a full node-by-node rebuild of large pushes. Inherited
+ * namespace declarations are preserved, see text_modify_steal_post.
+ * @param[in]  x0p  Parent in base tree under which x1 is inserted
+ * @param[in]  x1   Payload subtree, checked with text_modify_steal_ok
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see text_modify_steal_ok
+ */
+static int
+text_modify_steal(cxobj *x0p,
+                  cxobj *x1)
+{
+    int     retval = -1;
+    cvec   *nsc = NULL;
+
+    if (xml_nsctx_node(x1, &nsc) < 0)
+        goto done;
+    if (xml_rm(x1) < 0)
+        goto done;
+    if (xml_insert(x0p, x1, INS_LAST, NULL, NULL) < 0)
+        goto done;
+    if (text_modify_steal_post(x1, nsc) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
+/*! Bulk variant of text_modify_steal for children of one payload node
+ *
+ * Splices all children of x1 that have no base node and pass
+ * text_modify_steal_ok into x0 with a single sorted merge, see
+ * xml_insert_bulk. Spliced entries are NULLed in x1vec so that the caller's
+ * per-child pass skips them. Must only be called when per-node NACM checks
+ * are not needed and the payload may be consumed.
+ * @param[in]     x0      Base tree node (parent of the spliced children)
+ * @param[in,out] x1vec   Payload children, spliced entries set to NULL
+ * @param[in]     x0vec   Matching base children (NULL where x1vec[i] is new)
+ * @param[in]     x1veclen Length of x1vec/x0vec
+ * @retval        0       OK
+ * @retval       -1       Error
+ * @see text_modify_steal
+ */
+static int
+text_modify_steal_bulk(cxobj  *x0,
+                       cxobj **x1vec,
+                       cxobj **x0vec,
+                       int     x1veclen)
+{
+    int        retval = -1;
+    cxobj    **xbulk = NULL;
+    cvec     **nscvec = NULL;
+    cxobj     *x1c;
+    yang_stmt *yc;
+    int        nr = 0;
+    int        i;
+    int        ret;
+
+    if ((xbulk = calloc(x1veclen, sizeof(cxobj *))) == NULL ||
+        (nscvec = calloc(x1veclen, sizeof(cvec *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<x1veclen; i++){
+        if (x0vec[i] != NULL) /* existing base node: per-child merge */
+            continue;
+        x1c = x1vec[i];
+        if ((yc = xml_spec(x1c)) == NULL)
+            continue;
+        /* Relative order is significant for ordered-by user (and state) nodes */
+#ifndef STATE_ORDERED_BY_SYSTEM
+        if (yang_config_ancestor(yc) == 0)
+            continue;
+#endif
+        if ((yang_keyword_get(yc) == Y_LIST || yang_keyword_get(yc) == Y_LEAF_LIST) &&
+            yang_find(yc, Y_ORDERED_BY, "user") != NULL)
+            continue;
+        if ((ret = text_modify_steal_ok(x1c, yc)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if (xml_nsctx_node(x1c, &nscvec[nr]) < 0)
+            goto done;
+        xbulk[nr++] = x1c;
+        x1vec[i] = NULL;
+    }
+    for (i=0; i<nr; i++)
+        if (xml_rm(xbulk[i]) < 0)
+            goto done;
+    if (xml_insert_bulk(x0, xbulk, nr) < 0)
+        goto done;
+    for (i=0; i<nr; i++)
+        if (text_modify_steal_post(xbulk[i], nscvec[i]) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (nscvec){
+        for (i=0; i<x1veclen; i++)
+            if (nscvec[i])
+                cvec_free(nscvec[i]);
+        free(nscvec);
+    }
+    if (xbulk)
+        free(xbulk);
+    return retval;
+}
+
+/*! Bulk variant of the delete/remove handling for children of one payload node
+ *
+ * Collects the children of the payload whose operation attribute resolves to
+ * delete or remove and that have a matching base node, runs the per-node when
+ * and NACM checks, and removes them from x0 with a single child-vector
+ * compaction (xml_child_rm_vec) instead of one xml_purge per entry, which is
+ * O(n^2) when deleting a large part of a list. Handled entries are NULLed in
+ * x1vec so that the caller's per-child pass skips them; anything that needs
+ * the full per-node handling (ordered-by user, leaf-list body mismatch, etc)
+ * is left untouched and takes the generic path.
+ * @param[in]     h        Clicon handle
+ * @param[in]     x0       Base tree node (parent of the deleted children)
+ * @param[in]     x0t      Top level of base tree, eg needed for NACM rules
+ * @param[in,out] x1vec    Payload children, deleted entries set to NULL
+ * @param[in]     x0vec    Matching base children (NULL where x1vec[i] is new)
+ * @param[in]     x1veclen Length of x1vec/x0vec
+ * @param[in]     username User name of requestor for nacm
+ * @param[in]     xnacm    NACM XML tree (only if !permit)
+ * @param[in]     permit   If set, no NACM tests using xnacm required
+ * @param[out]    cbret    Initialized cligen buffer. Contains return XML if retval is 0
+ * @retval        1        OK
+ * @retval        0        Failed (cbret set)
+ * @retval       -1        Error
+ * @see text_modify_steal_bulk
+ */
+static int
+text_modify_delete_bulk(clicon_handle h,
+                        cxobj        *x0,
+                        cxobj        *x0t,
+                        cxobj       **x1vec,
+                        cxobj       **x0vec,
+                        int           x1veclen,
+                        char         *username,
+                        cxobj        *xnacm,
+                        int           permit,
+                        cbuf         *cbret)
+{
+    int                 retval = -1;
+    cxobj             **xbulk = NULL;
+    cxobj              *x1c;
+    cxobj              *x0c;
+    yang_stmt          *yc;
+    char               *opstr = NULL;
+    char               *x0bstr;
+    char               *x1bstr;
+    enum operation_type op;
+    enum rfc_6020       kw;
+    int                 nr = 0;
+    int                 i;
+    int                 ret;
+
+    if ((xbulk = calloc(x1veclen, sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<x1veclen; i++){
+        if ((x1c = x1vec[i]) == NULL || (x0c = x0vec[i]) == NULL)
+            continue;
+        if ((yc = xml_spec(x1c)) == NULL)
+            continue;
+        kw = yang_keyword_get(yc);
+        if (kw != Y_LIST && kw != Y_LEAF_LIST)
+            continue;
+        /* Ordered-by user entries take insert/key attributes, generic path */
+        if (yang_find(yc, Y_ORDERED_BY, "user") != NULL)
+            continue;
+        if ((ret = attr_ns_value(x1c, "operation", NETCONF_BASE_NAMESPACE,
+                                 cbret, &opstr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (opstr == NULL)
+            continue;
+        if (xml_operation(opstr, &op) < 0)
+            goto done;
+        free(opstr);
+        opstr = NULL;
+        if (op != OP_DELETE && op != OP_REMOVE)
+            continue;
+        if (kw == Y_LEAF_LIST){
+            if (xml_child_nr_type(x1c, CX_ELMNT)) /* sub-element check, generic path */
+                continue;
+            /* Same purge condition as the per-node delete handling: value is
+             * NULL (match-all) or both values are equal */
+            x1bstr = xml_body(x1c);
+            x0bstr = xml_body(x0c);
+            if (x1bstr != NULL &&
+                (x0bstr == NULL || strcmp(x0bstr, x1bstr) != 0))
+                continue;
+        }
+        if ((ret = check_when_condition(x0, x1c, yc, cbret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        if (!permit && xnacm){
+            if ((ret = nacm_datanode_write(h, x0c, x0t, NACM_DELETE, username, xnacm, cbret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
+        xbulk[nr++] = x0c;
+        x1vec[i] = NULL;
+    }
+    if (nr > 0){
+        if (xml_child_rm_vec(x0, xbulk, nr) < 0)
+            goto done;
+        for (i=0; i<nr; i++)
+            xml_free(xbulk[i]);
+    }
+    retval = 1;
+ done:
+    if (opstr)
+        free(opstr);
+    if (xbulk)
+        free(xbulk);
+    return retval;
+ fail: /* cbret set */
+    retval = 0;
+    goto done;
+}
+
 /*! Modify a base tree x0 with x1 with yang spec y according to operation op
  * @param[in]  h        Clicon handle
  * @param[in]  x0       Base xml tree (can be NULL in add scenarios)
@@ -471,11 +836,14 @@ text_modify(clicon_handle       h,
     char      *x1cname; /* child name */
     cxobj     *x0c;     /* base child */
     cxobj     *x0b;     /* base body */
+    cxobj     *x1b;     /* mod body */
     cxobj     *x1c;     /* mod child */
     char      *x0bstr;  /* mod body string */
     char      *x1bstr;  /* mod body string */
     yang_stmt *yc;      /* yang child */
     cxobj    **x0vec = NULL;
+    cxobj    **x1vec = NULL;
+    int        x1veclen = 0;
     int        i;
     int        ret;
     char      *instr = NULL;
@@ -677,7 +1045,14 @@ text_modify(clicon_handle       h,
                         if (ret == 0)
                             goto fail;
                     }
-                    if (xml_value_set(x0b, x1bstr) < 0)
+                    /* Move the value buffer instead of copying when the caller has
+                     * marked the request tree expendable, see XML_FLAG_STEAL */
+                    ret = 0;
+                    if (xml_flag(x1t, XML_FLAG_STEAL) &&
+                        (x1b = xml_body_get(x1)) != NULL &&
+                        x1bstr == xml_value(x1b))
+                        ret = xml_value_move(x0b, x1b);
+                    if (ret == 0 && xml_value_set(x0b, x1bstr) < 0)
                         goto done;
                     /* If a default value ies replaced, then reset default flag */
                     if (xml_flag(x0, XML_FLAG_DEFAULT))
@@ -823,8 +1198,25 @@ text_modify(clicon_handle       h,
                         goto fail;
                     permit = 1;
                 }
+                /* The whole subtree is new: splice it from the payload instead
+                 * of rebuilding it node-by-node, if it is plain enough.
+                 * Only for throwaway payloads: if the request root is a
+                 * datastore top (eg db_merge, startup commit) the source tree
+                 * must not be consumed
+                 */
+                if (op != OP_NONE && instr == NULL &&
+                    xml_flag(x1t, XML_FLAG_TOP) == 0){
+                    if ((ret = text_modify_steal_ok(x1, y0)) < 0)
+                        goto done;
+                    if (ret == 1){
+                        if (text_modify_steal(x0p, x1) < 0)
+                            goto done;
+                        retval = 1;
+                        goto done;
+                    }
+                }
                 /* Add new xml node but without parent - insert when node fully
-                 * copied (see changed conditional below) 
+                 * copied (see changed conditional below)
                  * Note x0 may dangle cases if exit before changed conditional
                  */
                 if ((x0 = xml_new(x1name, NULL, CX_ELMNT)) == NULL)
@@ -843,13 +1235,17 @@ text_modify(clicon_handle       h,
                 if (op==OP_NONE)
                     xml_flag_set(x0, XML_FLAG_NONE); /* Mark for potential deletion */
             }
-            /* First pass: Loop through children of the x1 modification tree 
+            /* First pass: Loop through children of the x1 modification tree
              * collect matching nodes from x0 in x0vec (no changes to x0 children)
              */
             if ((x0vec = calloc(xml_child_nr_type(x1, CX_ELMNT), sizeof(x1))) == NULL){
                 clicon_err(OE_UNIX, errno, "calloc");
                 goto done;
             }
+            if ((x1vec = calloc(xml_child_nr_type(x1, CX_ELMNT), sizeof(x1))) == NULL){
+                clicon_err(OE_UNIX, errno, "calloc");
+                goto done;
+            }
             x1c = NULL; 
             i = 0;
             while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) { 
@@ -892,16 +1288,43 @@ text_modify(clicon_handle       h,
                 x0c = NULL;
                 if (match_base_child(x0, x1c, yc, &x0c) < 0)
                     goto done;
+                x1vec[i] = x1c;
                 x0vec[i++] = x0c; /* != NULL if x0c is matching x1c */
             }
-            /* Second pass: Loop through children of the x1 modification tree again
-             * Now potentially modify x0:s children 
+            x1veclen = i;
+            /* Bulk-steal: splice all new plain subtrees into x0 with a single
+             * sorted merge instead of one insert per child, see xml_insert_bulk.
+             * Only for throwaway payloads without pending per-node NACM checks
+             */
+            if (x1veclen > 0 &&
+                op != OP_NONE && instr == NULL &&
+                (permit || xnacm == NULL) &&
+                xml_flag(x1t, XML_FLAG_TOP) == 0){
+                if (text_modify_steal_bulk(x0, x1vec, x0vec, x1veclen) < 0)
+                    goto done;
+            }
+            /* Bulk-delete: remove all children with a delete/remove operation
+             * attribute with one child-vector compaction instead of one
+             * xml_purge per entry, see xml_child_rm_vec
+             */
+            if (x1veclen > 1){
+                if ((ret = text_modify_delete_bulk(h, x0, x0t, x1vec, x0vec, x1veclen,
+                                                   username, xnacm, permit, cbret)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+            }
+            /* Second pass: Loop through the collected children of the x1
+             * modification tree again. Now potentially modify x0:s children.
              * Here x0vec contains one-to-one matching nodes of x1:s children.
+             * Use the saved vector, not the child iterator: the recursion may
+             * splice x1c out of x1, see text_modify_steal; bulk-spliced
+             * entries are NULL.
              */
-            x1c = NULL;
-            i = 0;
-            while ((x1c = xml_child_each(x1, x1c, CX_ELMNT)) != NULL) {
-                x0c = x0vec[i++];
+            for (i=0; i<x1veclen; i++){
+                if ((x1c = x1vec[i]) == NULL)
+                    continue;
+                x0c = x0vec[i];
                 x1cname = xml_name(x1c);
                 if ((yc = yang_find_datanode(y0, x1cname)) == NULL){
 #ifdef YANG_SCHEMA_MOUNT
@@ -965,6 +1388,8 @@ text_modify(clicon_handle       h,
         xml_purge(x0);
     if (x0vec)
         free(x0vec);
+    if (x1vec)
+        free(x1vec);
     return retval;
  fail: /* cbret set */
     retval = 0;
@@ -1006,7 +1431,10 @@ text_modify_top(clicon_handle       h,
     char      *opstr = NULL;
     int        ret;
     char      *createstr = NULL;
-    
+    cxobj    **x1vec = NULL;
+    int        x1veclen = 0;
+    int        i;
+
     /* Check for operations embedded in tree according to netconf */
     if ((ret = attr_ns_value(x1t,
                              "operation", NETCONF_BASE_NAMESPACE,
@@ -1079,9 +1507,19 @@ text_modify_top(clicon_handle       h,
             if (xml_purge(x0c) < 0)
                 goto done;
     }
-    /* Loop through children of the modification tree */
+    /* Collect children first: text_modify may splice children out of x1t,
+     * which would break the child iterator, see text_modify_steal
+     */
+    if ((x1vec = calloc(xml_child_nr_type(x1t, CX_ELMNT)+1, sizeof(cxobj*))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
     x1c = NULL;
-    while ((x1c = xml_child_each(x1t, x1c, CX_ELMNT)) != NULL) {
+    while ((x1c = xml_child_each(x1t, x1c, CX_ELMNT)) != NULL)
+        x1vec[x1veclen++] = x1c;
+    /* Loop through children of the modification tree */
+    for (i=0; i<x1veclen; i++){
+        x1c = x1vec[i];
         x1cname = xml_name(x1c);
         /* Get yang spec of the child */
         yc = NULL;
@@ -1130,107 +1568,990 @@ text_modify_top(clicon_handle       h,
         free(opstr);
     if (createstr)
         free(createstr);
+    if (x1vec)
+        free(x1vec);
     return retval;
  fail: /* cbret set */
     retval = 0;
     goto done;
 } /* text_modify_top */
 
-/*! Modify database given an xml tree and an operation
- *
- * @param[in]  h      CLICON handle
- * @param[in]  db     running or candidate
- * @param[in]  op     Top-level operation, can be superceded by other op in tree
- * @param[in]  x1     xml-tree. Top-level symbol is dummy
- * @param[in]  username User name for nacm
- * @param[out] cbret  Initialized cligen buffer. On exit contains XML if retval == 0
- * @retval     1      OK
- * @retval     0      Failed, cbret contains error xml message
- * @retval     -1     Error
- * The xml may contain the "operation" attribute which defines the operation.
- * @code
- *   cxobj     *xt;
- *   cxobj     *xret = NULL;
- *   if (clixon_xml_parse_string("<a>17</a>", YB_NONE, NULL, &xt, NULL) < 0)
- *     err;
- *   if ((ret = xmldb_put(h, "running", OP_MERGE, xt, username, cbret)) < 0)
- *     err;
- *   if (ret==0)
- *     cbret contains netconf error message
- * @endcode
- * @note if xret is non-null, it may contain error message
+/* Compact the edit journal when it grows beyond this size (bytes),
+ * see CLICON_XMLDB_JOURNAL */
+#define XMLDB_JOURNAL_MAXSIZE (4*1024*1024)
+
+/*! Return edit journal filename of db: <dbfile>.jrnl
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Symbolic database name, eg "candidate", "running"
+ * @param[out] filename Journal filename. Unallocate after use with free()
+ * @retval     0        OK
+ * @retval    -1        Error
  */
 int
-xmldb_put(clicon_handle       h,
-          const char         *db, 
-          enum operation_type op,
-          cxobj              *x1,
-          char               *username,
-          cbuf               *cbret)
+xmldb_journal_file(clicon_handle h,
+                   const char   *db,
+                   char        **filename)
 {
-    int         retval = -1;
-    char       *dbfile = NULL;
-    FILE       *f = NULL;
-    cbuf       *cb = NULL;
-    yang_stmt  *yspec;
-    cxobj      *x0 = NULL;
-    db_elmnt   *de = NULL;
-    int         ret;
-    cxobj      *xnacm = NULL;
-    cxobj      *xmodst = NULL;
-    cxobj      *x;
-    int         permit = 0; /* nacm permit all */
-    char       *format;
-    cvec       *nsc = NULL; /* nacm namespace context */
-    int         firsttime = 0;
-    int         pretty;
-    cxobj      *xerr = NULL;
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
 
-    if (cbret == NULL){
-        clicon_err(OE_XML, EINVAL, "cbret is NULL");
+    if (xmldb_db2file(h, db, &dbfile) < 0)
         goto done;
-    }
-    if ((yspec = clicon_dbspec_yang(h)) == NULL){
-        clicon_err(OE_YANG, ENOENT, "No yang spec");
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
-    if (x1 && strcmp(xml_name(x1), NETCONF_INPUT_CONFIG) != 0){
-        clicon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"%s\"",
-                   xml_name(x1), NETCONF_INPUT_CONFIG);
+    cprintf(cb, "%s.jrnl", dbfile);
+    if ((*filename = strdup(cbuf_get(cb))) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
         goto done;
     }
-    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
-        if (clicon_datastore_cache(h) != DATASTORE_NOCACHE)
-            x0 = de->de_xml; /* XXX flag is not XML_FLAG_TOP */
-    }
-    /* If there is no xml x0 tree (in cache), then read it from file */
-    if (x0 == NULL){
-        firsttime++; /* to avoid leakage on error, see fail from text_modify */
-        /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
-        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &x0, de, NULL, &xerr)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
-    if (strcmp(xml_name(x0), DATASTORE_TOP_SYMBOL) !=0 ||
-        xml_flag(x0, XML_FLAG_TOP) == 0){
-        clicon_err(OE_XML, 0, "Top-level symbol is %s, expected \"%s\"",
-                   xml_name(x0), DATASTORE_TOP_SYMBOL);
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Truncate (empty) the edit journal of db, eg after compaction
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_journal_truncate(clicon_handle h,
+                       const char   *db)
+{
+    int   retval = -1;
+    char *filename = NULL;
+
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if (truncate(filename, 0) < 0 && errno != ENOENT){
+        clicon_err(OE_DB, errno, "truncate %s", filename);
         goto done;
     }
-    /* Here x0 looks like: <config>...</config> */
-
-#if 0 /* debug */
-    if (xml_apply0(x1, -1, xml_sort_verify, NULL) < 0)
-        clicon_log(LOG_NOTICE, "%s: verify failed #1", __FUNCTION__);
-#endif
+    retval = 0;
+ done:
+    if (filename)
+        free(filename);
+    return retval;
+}
 
-    xnacm = clicon_nacm_cache(h);
-    permit = (xnacm==NULL);
+/*! Append one edit operation to the edit journal of db
+ * The record is the same op/payload that text_modify_top consumes:
+ *   <edit operation="<op>" [username="<user>"]><config>...</config></edit>
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Symbolic database name
+ * @param[in]  op       Default top-level operation
+ * @param[in]  x1str    Serialized modification tree, top-level symbol "config".
+ *                      Must be rendered before the edit is applied: the edit
+ *                      may splice subtrees out of the payload, see text_modify_steal
+ * @param[in]  username User name of requestor, or NULL
+ * @param[out] szp      If set, journal file size after append
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see xmldb_journal_replay
+ */
+static int
+xmldb_journal_append(clicon_handle       h,
+                     const char         *db,
+                     enum operation_type op,
+                     char               *x1str,
+                     char               *username,
+                     off_t              *szp)
+{
+    int         retval = -1;
+    char       *filename = NULL;
+    FILE       *f = NULL;
+    struct stat st;
+
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if ((f = fopen(filename, "a")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    if (username)
+        fprintf(f, "<edit operation=\"%s\" username=\"%s\">",
+                xml_operation2str(op), username);
+    else
+        fprintf(f, "<edit operation=\"%s\">", xml_operation2str(op));
+    fputs(x1str, f);
+    fprintf(f, "</edit>\n");
+    if (szp){
+        if (fflush(f) != 0 || fstat(fileno(f), &st) < 0){
+            clicon_err(OE_UNIX, errno, "fstat");
+            goto done;
+        }
+        *szp = st.st_size;
+    }
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Replay the edit journal of db on top of a freshly read datastore tree
+ * Called from xmldb_readfile after yang binding: the base file reflects the
+ * last compaction point and the journal holds the edits made since.
+ * @param[in]     h     Clicon handle
+ * @param[in]     db    Symbolic database name
+ * @param[in]     yspec Top-level yang spec
+ * @param[in,out] x0t   Datastore tree, top-level symbol "config", yang bound
+ * @retval        0     OK (including no or empty journal)
+ * @retval       -1     Error, eg corrupt or inconsistent journal
+ * @see xmldb_journal_append
+ */
+int
+xmldb_journal_replay(clicon_handle h,
+                     const char   *db,
+                     yang_stmt    *yspec,
+                     cxobj        *x0t)
+{
+    int                 retval = -1;
+    char               *filename = NULL;
+    FILE               *f = NULL;
+    cxobj              *xj = NULL;
+    cxobj              *xe;
+    cxobj              *x1;
+    char               *opstr;
+    char               *username;
+    enum operation_type op;
+    cbuf               *cbret = NULL;
+    struct stat         st;
+    int                 ret;
+
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if (stat(filename, &st) < 0 || st.st_size == 0)
+        goto ok; /* no journal */
+    if ((f = fopen(filename, "r")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", filename);
+        goto done;
+    }
+    if (clixon_xml_parse_file(f, YB_NONE, NULL, &xj, NULL) < 0)
+        goto done;
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    xe = NULL;
+    while ((xe = xml_child_each(xj, xe, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xe), "edit"))
+            continue;
+        if ((opstr = xml_find_value(xe, "operation")) == NULL ||
+            xml_operation(opstr, &op) < 0){
+            clicon_err(OE_DB, EFAULT, "Corrupt journal %s: bad operation", filename);
+            goto done;
+        }
+        username = xml_find_value(xe, "username");
+        if ((x1 = xml_find_type(xe, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL){
+            clicon_err(OE_DB, EFAULT, "Corrupt journal %s: no config payload", filename);
+            goto done;
+        }
+        if ((ret = xml_bind_yang(h, x1, YB_MODULE, yspec, NULL)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_DB, EFAULT, "Corrupt journal %s: yang binding failed", filename);
+            goto done;
+        }
+        cbuf_reset(cbret);
+        /* NACM was enforced when the edit was journaled, replay with permit */
+        if ((ret = text_modify_top(h, x0t, x1, yspec, op, username, NULL, 1, cbret)) < 0)
+            goto done;
+        if (ret == 0){
+            clicon_err(OE_DB, EFAULT, "Inconsistent journal %s: %s", filename, cbuf_get(cbret));
+            goto done;
+        }
+    }
+    if (xml_tree_prune_flagged_sub(x0t, XML_FLAG_NONE, 0, NULL) <0)
+        goto done;
+    if (xml_apply(x0t, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                  (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
+        goto done;
+    if (xml_defaults_nopresence(x0t, 2) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (cbret)
+        cbuf_free(cbret);
+    if (xj)
+        xml_free(xj);
+    if (f)
+        fclose(f);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Compact db: write the full tree to the datastore file and empty the journal
+ * Only compacts if the tree is in the datastore cache, otherwise the on-disk
+ * base+journal pair is left as is (still consistent).
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_journal_compact(clicon_handle h,
+                      const char   *db)
+{
+    int         retval = -1;
+    char       *filename = NULL;
+    char       *dbfile = NULL;
+    cxobj      *x0;
+    cxobj      *x;
+    cxobj      *xmodst = NULL;
+    FILE       *f = NULL;
+    struct stat st;
+
+    if (!clicon_option_bool(h, "CLICON_XMLDB_JOURNAL"))
+        goto ok;
+    if (xmldb_journal_file(h, db, &filename) < 0)
+        goto done;
+    if (stat(filename, &st) < 0 || st.st_size == 0)
+        goto ok; /* empty journal, base file is current */
+    if ((x0 = xmldb_cache_get(h, db)) == NULL)
+        goto ok; /* cache cold: cannot compact without replaying */
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
+        if ((xmodst = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(x0, xmodst) < 0)
+            goto done;
+    }
+    if ((f = fopen(dbfile, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+        goto done;
+    }
+    if (xmldb_dump(h, f, x0) < 0)
+        goto done;
+    fclose(f);
+    f = NULL;
+    if (xmodst){
+        if (xml_purge(xmodst) < 0)
+            goto done;
+        xmodst = NULL;
+    }
+    if (xmldb_journal_truncate(h, db) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (dbfile)
+        free(dbfile);
+    if (filename)
+        free(filename);
+    return retval;
+}
+
+/*! Write one shard file: all top-level children of x0 with the given name
+ *
+ * The shard file is "<dir>/<name>_db" and holds a <config> top with the
+ * matching subtrees, same shape as a base datastore file. If no child matches
+ * the shard file is removed. See CLICON_XMLDB_SHARDED
+ * @param[in]  h     Clicon handle
+ * @param[in]  dir   Shard directory, see xmldb_shard_dir
+ * @param[in]  x0    Top-level xml tree of db
+ * @param[in]  name  Top-level child name keying the shard
+ * @param[in]  sync  If set, fsync the shard file (durability barrier)
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_write_shard(clicon_handle h,
+                  const char   *dir,
+                  cxobj        *x0,
+                  const char   *name,
+                  int           sync)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    FILE  *f = NULL;
+    FILE  *fz = NULL; /* zstd compression stream wrapping f */
+    FILE  *f1;        /* fz or f: what the serializer writes to */
+    cxobj *xc;
+    int    pretty;
+    int    found = 0;
+    cvec  *nsc = NULL; /* borrowed, see xml_nsctx_yangspec_canonical */
+    cg_var *cv;
+
+    xc = NULL;
+    while ((xc = xml_child_each(x0, xc, CX_ELMNT)) != NULL)
+        if (strcmp(xml_name(xc), name) == 0){
+            found++;
+            break;
+        }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s/%s_db", dir, name);
+    if (!found){ /* subtree gone: remove its shard */
+        if (unlink(cbuf_get(cb)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cb));
+            goto done;
+        }
+        goto ok;
+    }
+    if ((f = fopen(cbuf_get(cb), "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", cbuf_get(cb));
+        goto done;
+    }
+#ifdef WITH_ZSTD
+    if (clicon_option_bool(h, "CLICON_XMLDB_COMPRESS")){
+        if ((fz = clixon_file_zstd_write(f)) == NULL)
+            goto done;
+    }
+#endif
+    f1 = fz ? fz : f;
+    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
+    if (clicon_option_bool(h, "CLICON_XMLDB_CANONICAL") &&
+        (nsc = xml_nsctx_yangspec_canonical(clicon_dbspec_yang(h))) == NULL)
+        goto done;
+    fprintf(f1, "<%s", DATASTORE_TOP_SYMBOL);
+    if (nsc){
+        /* Hoisted canonical declaration block, see clixon_xml2file_canonical */
+        cv = NULL;
+        while ((cv = cvec_each(nsc, cv)) != NULL){
+            if (cv_name_get(cv) == NULL || strlen(cv_name_get(cv)) == 0)
+                continue;
+            fprintf(f1, " xmlns:%s=\"%s\"", cv_name_get(cv), cv_string_get(cv));
+        }
+    }
+    fprintf(f1, ">%s", pretty?"\n":"");
+    xc = NULL;
+    while ((xc = xml_child_each(x0, xc, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xc), name) != 0)
+            continue;
+        if (nsc){
+            if (clixon_xml2file_canonical(f1, xc, pretty?1:0, pretty, fprintf, nsc, 0) < 0)
+                goto done;
+        }
+        else if (clixon_xml2file(f1, xc, pretty?1:0, pretty, fprintf, 0, 0) < 0)
+            goto done;
+    }
+    fprintf(f1, "</%s>%s", DATASTORE_TOP_SYMBOL, pretty?"\n":"");
+    if (fz){ /* close ends the zstd frame, must precede fsync of f */
+        int ret = fclose(fz);
+        fz = NULL;
+        if (ret != 0){
+            clicon_err(OE_UNIX, errno, "fclose(%s)", cbuf_get(cb));
+            goto done;
+        }
+    }
+    if (sync &&
+        (fflush(f) != 0 || fsync(fileno(f)) < 0)){
+        clicon_err(OE_UNIX, errno, "fsync(%s)", cbuf_get(cb));
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (fz != NULL)
+        fclose(fz);
+    if (f != NULL)
+        fclose(f);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Write a datastore tree as sharded layout: one file per top-level subtree
+ *
+ * The base "<db>_db" file becomes a spine holding only module-state (if
+ * CLICON_XMLDB_MODSTATE); each distinct top-level child name gets its own
+ * shard under "<db>_db_d/". Stale shards are removed, so a full write always
+ * leaves base file and shard directory consistent.
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Symbolic database name
+ * @param[in]  x0    Top-level xml tree of db
+ * @param[in]  sync  If set, fsync spine and shards (durability barrier)
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xmldb_writefile  Monolithic variant
+ */
+static int
+xmldb_writefile_sharded(clicon_handle h,
+                        const char   *db,
+                        cxobj        *x0,
+                        int           sync)
+{
+    int            retval = -1;
+    char          *dir = NULL;
+    char          *dbfile = NULL;
+    FILE          *f = NULL;
+    FILE          *fz = NULL;
+    FILE          *f1;
+    cxobj         *x;
+    cxobj         *xc;
+    char          *format;
+    int            pretty;
+    cvec          *names = NULL;
+    cg_var        *cv;
+    struct dirent *dp = NULL;
+    int            ndp;
+    int            i;
+    cbuf          *cb = NULL;
+
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        goto done;
+    }
+    if (strcmp(format, "xml") != 0){
+        clicon_err(OE_CFG, 0, "CLICON_XMLDB_SHARDED requires CLICON_XMLDB_FORMAT xml");
+        goto done;
+    }
+    if (xmldb_shard_dir(h, db, &dir) < 0)
+        goto done;
+    if (mkdir(dir, S_IRWXU) < 0 && errno != EEXIST){
+        clicon_err(OE_UNIX, errno, "mkdir(%s)", dir);
+        goto done;
+    }
+    /* Spine: base file holds only module-state */
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((f = fopen(dbfile, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+        goto done;
+    }
+#ifdef WITH_ZSTD
+    if (clicon_option_bool(h, "CLICON_XMLDB_COMPRESS")){
+        if ((fz = clixon_file_zstd_write(f)) == NULL)
+            goto done;
+    }
+#endif
+    f1 = fz ? fz : f;
+    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
+    fprintf(f1, "<%s>%s", DATASTORE_TOP_SYMBOL, pretty?"\n":"");
+    if ((x = clicon_modst_cache_get(h, 1)) != NULL &&
+        clixon_xml2file(f1, x, pretty?1:0, pretty, fprintf, 0, 0) < 0)
+        goto done;
+    fprintf(f1, "</%s>%s", DATASTORE_TOP_SYMBOL, pretty?"\n":"");
+    if (fz){
+        int ret = fclose(fz);
+        fz = NULL;
+        if (ret != 0){
+            clicon_err(OE_UNIX, errno, "fclose(%s)", dbfile);
+            goto done;
+        }
+    }
+    if (sync &&
+        (fflush(f) != 0 || fsync(fileno(f)) < 0)){
+        clicon_err(OE_UNIX, errno, "fsync(%s)", dbfile);
+        goto done;
+    }
+    fclose(f);
+    f = NULL;
+    /* Write one shard per distinct top-level child name */
+    if ((names = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(x0, xc, CX_ELMNT)) != NULL)
+        if (cvec_find(names, xml_name(xc)) == NULL &&
+            cvec_add_string(names, xml_name(xc), NULL) < 0){
+            clicon_err(OE_UNIX, errno, "cvec_add_string");
+            goto done;
+        }
+    cv = NULL;
+    while ((cv = cvec_each(names, cv)) != NULL)
+        if (xmldb_write_shard(h, dir, x0, cv_name_get(cv), sync) < 0)
+            goto done;
+    /* Remove stale shards whose subtree is gone */
+    if ((ndp = clicon_file_dirent(dir, &dp, "_db$", S_IFREG)) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    for (i = 0; i < ndp; i++){
+        char *name = dp[i].d_name;
+        size_t len = strlen(name);
+
+        if (len <= 3) /* strip trailing "_db" to get the subtree name */
+            continue;
+        name[len-3] = '\0';
+        if (cvec_find(names, name) != NULL)
+            continue;
+        cbuf_reset(cb);
+        cprintf(cb, "%s/%s_db", dir, name);
+        if (unlink(cbuf_get(cb)) < 0 && errno != ENOENT){
+            clicon_err(OE_UNIX, errno, "unlink(%s)", cbuf_get(cb));
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dp)
+        free(dp);
+    if (names)
+        cvec_free(names);
+    if (fz != NULL)
+        fclose(fz);
+    if (f != NULL)
+        fclose(f);
+    if (dbfile)
+        free(dbfile);
+    if (dir)
+        free(dir);
+    return retval;
+}
+
+/*! Serialize a datastore tree to its file in the configured format
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  db    Symbolic database name
+ * @param[in]  x0    Top-level xml tree of db
+ * @param[in]  sync  If set, fsync the file before closing (durability barrier)
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xmldb_writefile(clicon_handle h,
+                const char   *db,
+                cxobj        *x0,
+                int           sync)
+{
+    int    retval = -1;
+    char  *dbfile = NULL;
+    FILE  *f = NULL;
+    FILE  *fz = NULL; /* zstd compression stream wrapping f */
+    FILE  *f1;        /* fz or f: what the serializer writes to */
+    cxobj *x;
+    cxobj *xmodst = NULL;
+    cxobj *xsorted = NULL; /* sorted-invariant marker attribute */
+    char  *format;
+    int    pretty;
+    cvec  *nsc = NULL; /* borrowed, see xml_nsctx_yangspec_canonical */
+
+    if (clicon_option_bool(h, "CLICON_XMLDB_SHARDED"))
+        return xmldb_writefile_sharded(h, db, x0, sync);
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if (dbfile==NULL){
+        clicon_err(OE_XML, 0, "dbfile NULL");
+        goto done;
+    }
+    /* Add module revision info before writing to file)
+     * Only if CLICON_XMLDB_MODSTATE is set
+     */
+    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
+        if ((xmodst = xml_dup(x)) == NULL)
+            goto done;
+        if (xml_addsub(x0, xmodst) < 0)
+            goto done;
+    }
+    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
+        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        goto done;
+    }
+    /* Sorted-invariant marker: the tree is serialized from an already sorted cache,
+     * record that on the top element so the loader can skip the resort pass, see
+     * xmldb_readfile. Only for the xml text format which is reparsed on read */
+    if (strcmp(format, "xml") == 0){
+        if ((xsorted = xml_new(DATASTORE_SORTED_ATTR, x0, CX_ATTR)) == NULL)
+            goto done;
+        if (xml_value_set(xsorted, "true") < 0)
+            goto done;
+    }
+    if ((f = fopen(dbfile, "w")) == NULL){
+        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+        goto done;
+    }
+#ifdef WITH_ZSTD
+    /* Stream-compress the serialization, see CLICON_XMLDB_COMPRESS.
+     * The binary format is mmap:ed on read and cannot be compressed */
+    if (clicon_option_bool(h, "CLICON_XMLDB_COMPRESS") &&
+        strcmp(format, "binary") != 0){
+        if ((fz = clixon_file_zstd_write(f)) == NULL)
+            goto done;
+    }
+#endif
+    f1 = fz ? fz : f;
+    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
+    if (strcmp(format,"binary")==0){
+        if (clixon_xml2bin(f1, x0) < 0)
+            goto done;
+    }
+    else if (strcmp(format,"json")==0){
+        if (clixon_json2file(f1, x0, pretty, fprintf, 0, 0) < 0)
+            goto done;
+    }
+    else if (clicon_option_bool(h, "CLICON_XMLDB_CANONICAL")){
+        if ((nsc = xml_nsctx_yangspec_canonical(clicon_dbspec_yang(h))) == NULL)
+            goto done;
+        if (clixon_xml2file_canonical(f1, x0, 0, pretty, fprintf, nsc, 1) < 0)
+            goto done;
+    }
+    else if (clixon_xml2file(f1, x0, 0, pretty, fprintf, 0, 0) < 0)
+        goto done;
+    if (fz){ /* close ends the zstd frame, must precede fsync of f */
+        int ret = fclose(fz);
+        fz = NULL;
+        if (ret != 0){
+            clicon_err(OE_UNIX, errno, "fclose(%s)", dbfile);
+            goto done;
+        }
+    }
+    if (sync &&
+        (fflush(f) != 0 || fsync(fileno(f)) < 0)){
+        clicon_err(OE_UNIX, errno, "fsync(%s)", dbfile);
+        goto done;
+    }
+    /* Remove modules state after writing to file
+     */
+    if (xmodst && xml_purge(xmodst) < 0)
+        goto done;
+    retval = 0;
+ done:
+    /* Remove the sorted marker again: it is a file artifact, not part of the tree */
+    if (xsorted)
+        xml_purge(xsorted);
+    if (fz != NULL)
+        fclose(fz);
+    if (f != NULL)
+        fclose(f);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Partial write: rewrite only the shards whose top-level subtree was edited
+ *
+ * Falls back to a full (sharded) write when the touched set is unknown or the
+ * sharded layout does not exist on disk yet.
+ * @param[in]  h        Clicon handle
+ * @param[in]  db       Symbolic database name
+ * @param[in]  x0       Top-level xml tree of db
+ * @param[in]  shnames  Names of edited top-level subtrees, or NULL if unknown
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see CLICON_XMLDB_SHARDED
+ */
+static int
+xmldb_put_shards(clicon_handle h,
+                 const char   *db,
+                 cxobj        *x0,
+                 cvec         *shnames)
+{
+    int         retval = -1;
+    char       *dir = NULL;
+    cg_var     *cv;
+    struct stat st;
+
+    if (xmldb_shard_dir(h, db, &dir) < 0)
+        goto done;
+    if (shnames == NULL ||
+        stat(dir, &st) < 0 || !S_ISDIR(st.st_mode)){
+        retval = xmldb_writefile(h, db, x0, 0);
+        goto done;
+    }
+    cv = NULL;
+    while ((cv = cvec_each(shnames, cv)) != NULL)
+        if (xmldb_write_shard(h, dir, x0, cv_name_get(cv), 0) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (dir)
+        free(dir);
+    return retval;
+}
+
+/*! Write deferred datastore edits to file, if any
+ *
+ * In write-coalesce mode edits only update the cache and mark it dirty; this
+ * writes the cached tree back to the datastore file, see xmldb_flush_defer
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name
+ * @retval     0   OK (including not dirty: file already current)
+ * @retval    -1   Error
+ * @see xmldb_barrier  Flush plus fsync, for durability
+ */
+int
+xmldb_flush(clicon_handle h,
+            const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || !de->de_dirty)
+        return 0;
+    if (de->de_xml != NULL &&
+        xmldb_writefile(h, db, de->de_xml, 0) < 0)
+        return -1;
+    de->de_dirty = 0;
+    return 0;
+}
+
+/*! Durability barrier: write deferred edits and fsync the datastore file
+ *
+ * Deferred writes (see CLICON_XMLDB_WRITE_COALESCE) trade durability within
+ * the coalescing window for amortized serialization; RPCs that promise
+ * persistence (eg commit) call this to force the db to stable storage.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+int
+xmldb_barrier(clicon_handle h,
+              const char   *db)
+{
+    int       retval = -1;
+    db_elmnt *de;
+    char     *dbfile = NULL;
+    int       fd = -1;
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL && de->de_dirty){
+        if (de->de_xml != NULL &&
+            xmldb_writefile(h, db, de->de_xml, 1) < 0)
+            goto done;
+        de->de_dirty = 0;
+        goto ok; /* writefile synced */
+    }
+    /* Not dirty: fsync the (current) file contents */
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((fd = open(dbfile, O_RDONLY)) < 0)
+        goto ok; /* no file yet, nothing to sync */
+    if (fsync(fd) < 0){
+        clicon_err(OE_UNIX, errno, "fsync(%s)", dbfile);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/* Set if the coalesced-write timeout below is armed */
+static int _xmldb_flush_armed = 0;
+
+/*! Event-loop callback: flush all dirty datastores, see xmldb_flush_defer
+ *
+ * @param[in]  fd   Ignored (timeout callback)
+ * @param[in]  arg  Clicon handle
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_flush_timeout(int   fd,
+                    void *arg)
+{
+    int            retval = -1;
+    clicon_handle  h = (clicon_handle)arg;
+    char         **keys = NULL;
+    size_t         nkeys = 0;
+    size_t         i;
+    db_elmnt      *de;
+
+    _xmldb_flush_armed = 0;
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &nkeys) < 0)
+        goto done;
+    for (i = 0; i < nkeys; i++){
+        if ((de = clicon_db_elmnt_get(h, keys[i])) != NULL &&
+            de->de_dirty &&
+            xmldb_flush(h, keys[i]) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Mark db dirty and arm the coalesced write-back timer
+ *
+ * Group commit: instead of re-serializing the datastore file on every edit,
+ * mark the cache dirty and write it back once after the coalescing window,
+ * amortizing the cost over bursts of small edits.
+ * @param[in]  h   Clicon handle
+ * @param[in]  db  Symbolic database name
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see CLICON_XMLDB_WRITE_COALESCE  Window in ms, 0 disables deferring
+ */
+int
+xmldb_flush_defer(clicon_handle h,
+                  const char   *db)
+{
+    db_elmnt      *de;
+    int            ms;
+    struct timeval t;
+    struct timeval t1 = {0, 0};
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+        clicon_err(OE_DB, 0, "db %s not found", db);
+        return -1;
+    }
+    de->de_dirty = 1;
+    if (_xmldb_flush_armed)
+        return 0;
+    ms = clicon_option_int(h, "CLICON_XMLDB_WRITE_COALESCE");
+    t1.tv_sec = ms/1000;
+    t1.tv_usec = (ms%1000)*1000;
+    gettimeofday(&t, NULL);
+    timeradd(&t, &t1, &t);
+    if (clixon_event_reg_timeout(t, xmldb_flush_timeout, h, "datastore write coalesce") < 0)
+        return -1;
+    _xmldb_flush_armed = 1;
+    return 0;
+}
+
+/*! Modify database given an xml tree and an operation
+ *
+ * @param[in]  h      CLICON handle
+ * @param[in]  db     running or candidate
+ * @param[in]  op     Top-level operation, can be superceded by other op in tree
+ * @param[in]  x1     xml-tree. Top-level symbol is dummy
+ * @param[in]  username User name for nacm
+ * @param[out] cbret  Initialized cligen buffer. On exit contains XML if retval == 0
+ * @retval     1      OK
+ * @retval     0      Failed, cbret contains error xml message
+ * @retval     -1     Error
+ * The xml may contain the "operation" attribute which defines the operation.
+ * @code
+ *   cxobj     *xt;
+ *   cxobj     *xret = NULL;
+ *   if (clixon_xml_parse_string("<a>17</a>", YB_NONE, NULL, &xt, NULL) < 0)
+ *     err;
+ *   if ((ret = xmldb_put(h, "running", OP_MERGE, xt, username, cbret)) < 0)
+ *     err;
+ *   if (ret==0)
+ *     cbret contains netconf error message
+ * @endcode
+ * @note if xret is non-null, it may contain error message
+ */
+int
+xmldb_put(clicon_handle       h,
+          const char         *db, 
+          enum operation_type op,
+          cxobj              *x1,
+          char               *username,
+          cbuf               *cbret)
+{
+    int         retval = -1;
+    cbuf       *cb = NULL;
+    yang_stmt  *yspec;
+    cxobj      *x0 = NULL;
+    db_elmnt   *de = NULL;
+    int         ret;
+    cxobj      *xnacm = NULL;
+    int         permit = 0; /* nacm permit all */
+    cvec       *nsc = NULL; /* nacm namespace context */
+    int         firsttime = 0;
+    cxobj      *xerr = NULL;
+    cvec       *shnames = NULL; /* edited top-level subtree names, see CLICON_XMLDB_SHARDED */
+    uint64_t    slow_t0 = 0;
+    uint64_t    slow_dt;
+
+    clixon_rpc_stats_stage_begin(h, RPC_STATS_XMLDB);
+    if (clixon_log_slow_get() != 0)
+        slow_t0 = clixon_log_slow_ns();
+    CLIXON_PROBE3(xmldb_put, db, op, x1?xml_child_nr(x1):0);
+    if (cbret == NULL){
+        clicon_err(OE_XML, EINVAL, "cbret is NULL");
+        goto done;
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if (x1 && strcmp(xml_name(x1), NETCONF_INPUT_CONFIG) != 0){
+        clicon_err(OE_XML, 0, "Top-level symbol of modification tree is %s, expected \"%s\"",
+                   xml_name(x1), NETCONF_INPUT_CONFIG);
+        goto done;
+    }
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
+        if (clicon_datastore_cache(h) != DATASTORE_NOCACHE)
+            x0 = de->de_xml; /* XXX flag is not XML_FLAG_TOP */
+    }
+    /* In COW cache mode the tree may be shared with another datastore, and
+     * readers may hold references on it (see xmldb_get_ref): clone it before
+     * modifying. de_shared makes the common unshared case a flag test so
+     * bursts of sequential edits skip the db hash scan */
+    if (x0 && (de->de_shared || xmldb_ref_cnt(h, x0) > 0))
+        if (xmldb_cache_unshare(h, db, &x0) < 0)
+            goto done;
+    /* If there is no xml x0 tree (in cache), then read it from file */
+    if (x0 == NULL){
+        firsttime++; /* to avoid leakage on error, see fail from text_modify */
+        /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
+        if ((ret = xmldb_readfile(h, db, YB_MODULE, yspec, &x0, de, NULL, &xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    if (strcmp(xml_name(x0), DATASTORE_TOP_SYMBOL) !=0 ||
+        xml_flag(x0, XML_FLAG_TOP) == 0){
+        clicon_err(OE_XML, 0, "Top-level symbol is %s, expected \"%s\"",
+                   xml_name(x0), DATASTORE_TOP_SYMBOL);
+        goto done;
+    }
+    /* Here x0 looks like: <config>...</config> */
+
+#if 0 /* debug */
+    if (xml_apply0(x1, -1, xml_sort_verify, NULL) < 0)
+        clicon_log(LOG_NOTICE, "%s: verify failed #1", __FUNCTION__);
+#endif
+
+    xnacm = clicon_nacm_cache(h);
+    permit = (xnacm==NULL);
 
     /* Here assume if xnacm is set and !permit do NACM */
     clicon_data_del(h, "objectexisted");
-    /* 
+    /* Journal mode: render the edit payload before it is applied, since
+     * text_modify may splice subtrees out of it, see text_modify_steal
+     */
+    if (clicon_option_bool(h, "CLICON_XMLDB_JOURNAL") &&
+        clicon_datastore_cache(h) != DATASTORE_NOCACHE){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (clixon_xml2cbuf(cb, x1, 0, 0, -1, 0) < 0)
+            goto done;
+    }
+    /* Note which top-level subtrees the edit can touch before text_modify may
+     * splice them out of the payload (see XML_FLAG_STEAL). Used to scope the
+     * per-edit cleanup walks below and the sharded file writes.
+     * Only merge-type ops are bounded by the payload: a top-level replace or
+     * delete affects subtrees not mentioned, leave shnames NULL (full walks) */
+    if ((op == OP_MERGE || op == OP_NONE) && x1 != NULL){
+        cxobj *xc1 = NULL;
+
+        if ((shnames = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        while ((xc1 = xml_child_each(x1, xc1, CX_ELMNT)) != NULL)
+            if (cvec_find(shnames, xml_name(xc1)) == NULL &&
+                cvec_add_string(shnames, xml_name(xc1), NULL) < 0){
+                clicon_err(OE_UNIX, errno, "cvec_add_string");
+                goto done;
+            }
+    }
+    /*
      * Modify base tree x with modification x1. This is where the
      * new tree is made.
      */
@@ -1249,12 +2570,40 @@ xmldb_put(clicon_handle       h,
     /* Remove NONE nodes if all subs recursively are also NONE */
     if (xml_tree_prune_flagged_sub(x0, XML_FLAG_NONE, 0, NULL) <0)
         goto done;
-    if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, 
-                  (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
-        goto done;
-    /* Remove global defaults and empty non-presence containers */
-    if (xml_defaults_nopresence(x0, 2) < 0)
-        goto done;
+    if (shnames != NULL){
+        /* Merge-type edit: flags and scaffolding are confined to the edited
+         * top-level subtrees, so restrict the flag-reset and defaults cleanup
+         * to them instead of walking the whole tree on every edit */
+        cxobj *xs = NULL;
+        cxobj *xsprev = NULL;
+
+        while ((xs = xml_child_each(x0, xs, CX_ELMNT)) != NULL){
+            if (cvec_find(shnames, xml_name(xs)) == NULL){
+                xsprev = xs;
+                continue;
+            }
+            xml_flag_reset(xs, XML_FLAG_NONE|XML_FLAG_MARK);
+            if (xml_apply(xs, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                          (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
+                goto done;
+            if ((ret = xml_defaults_nopresence(xs, 2)) < 0)
+                goto done;
+            if (ret == 1){ /* xs itself reduced to empty non-presence/default */
+                if (xml_purge(xs) < 0)
+                    goto done;
+                xs = xsprev;
+            }
+            xsprev = xs;
+        }
+    }
+    else{
+        if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                      (void*)(XML_FLAG_NONE|XML_FLAG_MARK)) < 0)
+            goto done;
+        /* Remove global defaults and empty non-presence containers */
+        if (xml_defaults_nopresence(x0, 2) < 0)
+            goto done;
+    }
 #if 0 /* debug */
     if (xml_apply0(x0, -1, xml_sort_verify, NULL) < 0)
         clicon_log(LOG_NOTICE, "%s: verify failed #3", __FUNCTION__);
@@ -1268,52 +2617,59 @@ xmldb_put(clicon_handle       h,
         if (de0.de_xml == NULL)
             de0.de_xml = x0;
         de0.de_empty = (xml_child_nr(de0.de_xml) == 0);
+        de0.de_serial++;
         clicon_db_elmnt_set(h, db, &de0);
     }
-    if (xmldb_db2file(h, db, &dbfile) < 0)
+    else /* NOCACHE: no meta-info write-back above, bump serial explicitly */
+        xmldb_serial_bump(h, db);
+    /* Per-module datastore counters: recount only what this edit touched */
+    if (xmldb_modstats_invalidate(h, db, shnames) < 0)
         goto done;
-    if (dbfile==NULL){
-        clicon_err(OE_XML, 0, "dbfile NULL");
-        goto done;
-    }
-    /* Add module revision info before writing to file)
-     * Only if CLICON_XMLDB_MODSTATE is set
-     */
-    if ((x = clicon_modst_cache_get(h, 1)) != NULL){
-        if ((xmodst = xml_dup(x)) == NULL)
+    /* Journal mode: append the edit to the write-ahead log instead of
+     * re-serializing the whole tree, see CLICON_XMLDB_JOURNAL */
+    if (cb != NULL){
+        off_t jsz = 0;
+        if (xmldb_journal_append(h, db, op, cbuf_get(cb), username, &jsz) < 0)
             goto done;
-        if (xml_addsub(x0, xmodst) < 0)
+        if (jsz > XMLDB_JOURNAL_MAXSIZE &&
+            xmldb_journal_compact(h, db) < 0)
             goto done;
-    }
-    if ((format = clicon_option_str(h, "CLICON_XMLDB_FORMAT")) == NULL){
-        clicon_err(OE_CFG, ENOENT, "No CLICON_XMLDB_FORMAT");
+        retval = 1;
         goto done;
     }
-    if ((f = fopen(dbfile, "w")) == NULL){
-        clicon_err(OE_CFG, errno, "Creating file %s", dbfile);
+    /* Group commit: defer the file write to a coalesced write-back, see
+     * CLICON_XMLDB_WRITE_COALESCE */
+    if (clicon_option_int(h, "CLICON_XMLDB_WRITE_COALESCE") > 0 &&
+        clicon_datastore_cache(h) != DATASTORE_NOCACHE){
+        if (xmldb_flush_defer(h, db) < 0)
+            goto done;
+        retval = 1;
         goto done;
-    } 
-    pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    if (strcmp(format,"json")==0){
-        if (clixon_json2file(f, x0, pretty, fprintf, 0, 0) < 0)
+    }
+    /* Sharded layout: rewrite only the shards the edit touched */
+    if (clicon_option_bool(h, "CLICON_XMLDB_SHARDED")){
+        if (xmldb_put_shards(h, db, x0, shnames) < 0)
             goto done;
     }
-    else if (clixon_xml2file(f, x0, 0, pretty, fprintf, 0, 0) < 0)
-        goto done;
-    /* Remove modules state after writing to file
-     */
-    if (xmodst && xml_purge(xmodst) < 0)
+    else if (xmldb_writefile(h, db, x0, 0) < 0)
         goto done;
     retval = 1;
  done:
-    if (f != NULL)
-        fclose(f);
+    CLIXON_PROBE2(xmldb_put_done, db, retval);
+    clixon_rpc_stats_stage_end(h, RPC_STATS_XMLDB);
+    /* Slow-op log, see CLICON_LOG_SLOW_MS */
+    if (slow_t0 != 0 &&
+        (slow_dt = clixon_log_slow_ns() - slow_t0) >= (uint64_t)clixon_log_slow_get()*1000000ull)
+        clicon_log(LOG_WARNING, "slow xmldb_put: %" PRIu64 "ms db:%s op:%s retval:%d",
+                   slow_dt/1000000, db, xml_operation2str(op), retval);
+    /* Edit done: batched NACM write state points into the request tree */
+    nacm_datanode_write_batch_free(h);
+    if (shnames)
+        cvec_free(shnames);
     if (xerr)
         xml_free(xerr);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (dbfile)
-        free(dbfile);
     if (cb)
         cbuf_free(cb);
     if (x0 && clicon_datastore_cache(h) == DATASTORE_NOCACHE)
@@ -1336,7 +2692,8 @@ xmldb_dump(clicon_handle   h,
     cxobj *xmodst = NULL;
     char  *format;
     int    pretty;
-    
+    cvec  *nsc = NULL; /* borrowed, see xml_nsctx_yangspec_canonical */
+
     /* clear XML tree of defaults */
     if (xml_tree_prune_flagged(xt, XML_FLAG_DEFAULT, 1) < 0)
         goto done;
@@ -1352,10 +2709,20 @@ xmldb_dump(clicon_handle   h,
         goto done;
     }
     pretty = clicon_option_bool(h, "CLICON_XMLDB_PRETTY");
-    if (strcmp(format,"json")==0){
+    if (strcmp(format,"binary")==0){
+        if (clixon_xml2bin(f, xt) < 0)
+            goto done;
+    }
+    else if (strcmp(format,"json")==0){
         if (clixon_json2file(f, xt, pretty, fprintf, 0, 0) < 0)
             goto done;
     }
+    else if (clicon_option_bool(h, "CLICON_XMLDB_CANONICAL")){
+        if ((nsc = xml_nsctx_yangspec_canonical(clicon_dbspec_yang(h))) == NULL)
+            goto done;
+        if (clixon_xml2file_canonical(f, xt, 0, pretty, fprintf, nsc, 1) < 0)
+            goto done;
+    }
     else if (clixon_xml2file(f, xt, 0, pretty, fprintf, 0, 0) < 0)
         goto done;
     retval = 0;
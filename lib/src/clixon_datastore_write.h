@@ -46,5 +46,10 @@
  * Prototypes
  */
 int xmldb_put(clicon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret);
+/* Edit journal (write-ahead log) functions, see CLICON_XMLDB_JOURNAL */
+int xmldb_journal_file(clicon_handle h, const char *db, char **filename);
+int xmldb_journal_truncate(clicon_handle h, const char *db);
+int xmldb_journal_replay(clicon_handle h, const char *db, yang_stmt *yspec, cxobj *x0t);
+int xmldb_journal_compact(clicon_handle h, const char *db);
 
 #endif /* _CLIXON_DATASTORE_WRITE_H */
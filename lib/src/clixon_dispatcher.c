@@ -68,10 +68,9 @@
  *          [b=]
  *          [b]
  *
- * NOTE 2: there is no attempt to optimize list searching here, sorry. I
- * do not think that the known use cases will get big enough to make the
- * tree get too large. I do not recommend that you encode every possible
- * path, just top level key handlers.
+ * NOTE 2: each peer level keeps a hash of node_name -> entry on its
+ * peer_head node so a path segment is matched in O(1) regardless of how
+ * many handlers are registered at that level, see find_peer().
  *
  * there are 2 functions to the API:
  * clixon_register_handler(): build the dispatcher table
@@ -89,9 +88,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <errno.h>
 
+#include "clixon_hash.h"
 #include "clixon_dispatcher.h"
 
 /* ===== utility routines ==== */
@@ -192,12 +193,21 @@ static dispatcher_entry_t *
 find_peer(dispatcher_entry_t *node, char *node_name)
 {
     dispatcher_entry_t *i;
-    
+    dispatcher_entry_t **ep;
+
     if ((node == NULL) || (node_name == NULL)) {
         /*  protect against idiot users */
         return NULL;
     }
 
+    if (node->peer_head != NULL && node->peer_head->peer_hash != NULL) {
+        /* hashed level: one lookup instead of a peer list walk */
+        if ((ep = (dispatcher_entry_t **)clicon_hash_value(node->peer_head->peer_hash,
+                                                           node_name, NULL)) == NULL)
+            return NULL;
+        return *ep;
+    }
+
     i = node->peer_head;
 
     while (i != NULL) {
@@ -235,6 +245,15 @@ add_peer_node(dispatcher_entry_t *node,
         new_node->peer = NULL;
         new_node->children = NULL;
         new_node->peer_head = new_node;
+        if ((new_node->peer_hash = clicon_hash_init()) == NULL ||
+            clicon_hash_add(new_node->peer_hash, name,
+                            &new_node, sizeof(new_node)) == NULL) {
+            if (new_node->peer_hash)
+                clicon_hash_free(new_node->peer_hash);
+            free(new_node->node_name);
+            free(new_node);
+            return NULL;
+        }
 
         return new_node;
     } else {
@@ -259,6 +278,13 @@ add_peer_node(dispatcher_entry_t *node,
         new_node->children = NULL;
         new_node->peer_head = node->peer_head;
 
+        if (node->peer_head->peer_hash != NULL &&
+            clicon_hash_add(node->peer_head->peer_hash, name,
+                            &new_node, sizeof(new_node)) == NULL) {
+            free(new_node->node_name);
+            free(new_node);
+            return NULL;
+        }
         eptr->peer = new_node;
 
         return new_node;
@@ -418,6 +444,7 @@ dispatcher_register_handler(dispatcher_entry_t   **root,
 
     /* when we get here, ptr points at last entry added */
     ptr->handler = x->dd_handler;
+    ptr->handler_batch = x->dd_handler_batch;
     ptr->arg = x->dd_arg;
 
     /* clean up */
@@ -462,6 +489,86 @@ dispatcher_call_handlers(dispatcher_entry_t *root,
     return ret;
 }
 
+/*! Call the handlers of a set of paths, one invocation per handler
+ *
+ * As dispatcher_call_handlers but for several paths at once: all paths that
+ * resolve to the same registered entry are grouped and, if the entry has a
+ * batch handler, handed over in a single call so the handler can fetch its
+ * state in one backend query. Entries without a batch handler get their plain
+ * handler called once per path as before. Descendant handlers are called per
+ * path, as in single-path dispatch.
+ *
+ * @param[in]  root      Dispatch tree
+ * @param[in]  handle    Generic handler
+ * @param[in]  paths     Paths on the form: /a/b (no keys)
+ * @param[in]  npaths    Number of paths
+ * @param[in]  user_args Per-call user arguments
+ * @retval     1         OK
+ * @retval    -1         Error
+ * @see dispatcher_call_handlers  single path
+ */
+int
+dispatcher_call_handlers_batch(dispatcher_entry_t *root,
+                               void               *handle,
+                               char              **paths,
+                               size_t              npaths,
+                               void               *user_args)
+{
+    int                  retval = -1;
+    dispatcher_entry_t **best = NULL;
+    dispatcher_entry_t  *e;
+    char               **group = NULL;
+    size_t               i;
+    size_t               j;
+    size_t               n;
+
+    if (npaths == 0)
+        return 1;
+    if ((best = malloc(npaths * sizeof(*best))) == NULL)
+        goto done;
+    if ((group = malloc(npaths * sizeof(*group))) == NULL)
+        goto done;
+    for (i = 0; i < npaths; i++) {
+        if ((best[i] = get_entry(root, paths[i])) == NULL) {
+            errno = ENOENT;
+            goto done;
+        }
+    }
+    for (i = 0; i < npaths; i++) {
+        if ((e = best[i]) == NULL)
+            continue; /* handled in an earlier group */
+        n = 0;
+        group[n++] = paths[i];
+        for (j = i + 1; j < npaths; j++) {
+            if (best[j] == e) {
+                group[n++] = paths[j];
+                best[j] = NULL;
+            }
+        }
+        for (j = 0; j < n; j++) {
+            if (e->children != NULL)
+                call_handler_helper(e->children, handle, group[j], user_args);
+        }
+        if (e->handler_batch != NULL) {
+            if ((e->handler_batch)(handle, group, n, user_args, e->arg) < 0)
+                goto done;
+        }
+        else if (e->handler != NULL) {
+            for (j = 0; j < n; j++) {
+                if ((e->handler)(handle, group[j], user_args, e->arg) < 0)
+                    goto done;
+            }
+        }
+    }
+    retval = 1;
+ done:
+    if (best)
+        free(best);
+    if (group)
+        free(group);
+    return retval;
+}
+
 /*! Free a dispatcher tree
  */
 int
@@ -475,6 +582,8 @@ dispatcher_free(dispatcher_entry_t *root)
         dispatcher_free(root->peer);
     if (root->node_name)
         free(root->node_name);
+    if (root->peer_hash)
+        clicon_hash_free(root->peer_hash);
     free(root);
     return 0;
 }
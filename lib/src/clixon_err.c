@@ -91,15 +91,20 @@ struct clixon_err_cats {
 };
 typedef struct clixon_err_cats clixon_err_cats;
 
-/* Internal global list of category callbacks */
+/* Internal global list of category callbacks
+ * Shared between threads: register (clixon_err_cat_reg) before spawning
+ * workers, the list is only read after that
+ */
 static clixon_err_cats *_err_cat_list = NULL;
 
 /*
  * Variables
+ * Thread-local (see CLIXON_THREAD_LOCAL) so worker threads keep separate error
+ * state; merge with clicon_err_aggregate
  */
-int  clicon_errno         = 0; /* See enum clicon_err XXX: hide this and change to err_category */
-int  clicon_suberrno      = 0; /* Corresponds to errno.h XXX: change to errno */
-char clicon_err_reason[ERR_STRLEN] = {0, };
+CLIXON_THREAD_LOCAL int  clicon_errno         = 0; /* See enum clicon_err XXX: hide this and change to err_category */
+CLIXON_THREAD_LOCAL int  clicon_suberrno      = 0; /* Corresponds to errno.h XXX: change to errno */
+CLIXON_THREAD_LOCAL char clicon_err_reason[ERR_STRLEN] = {0, };
 
 /*
  * Error descriptions. Must stop with NULL element.
@@ -337,6 +342,41 @@ clicon_err_restore(void* handle)
     return 0;
 }
 
+/*! Merge error states from worker threads into the calling thread's state
+ *
+ * Each worker calls clicon_err_save() in its own thread when it finishes; the
+ * parent passes the collected handles here. The first (lowest index) state
+ * with an error set becomes the calling thread's error state, so the reported
+ * error is deterministic regardless of thread completion order. All handles
+ * are freed and their slots set to NULL.
+ * @param[in,out]  states  Array of handles from clicon_err_save(), may hold NULLs
+ * @param[in]      nr      Length of states array
+ * @retval         0       OK, error state merged (or no error found)
+ * @see clicon_err_save  clicon_err_restore
+ */
+int
+clicon_err_aggregate(void **states,
+                     int    nr)
+{
+    struct err_state *es;
+    int               found = 0;
+    int               i;
+
+    for (i = 0; i < nr; i++){
+        if ((es = (struct err_state *)states[i]) == NULL)
+            continue;
+        if (!found && es->es_errno != 0){
+            clicon_errno = es->es_errno;
+            clicon_suberrno = es->es_suberrno;
+            strncpy(clicon_err_reason, es->es_reason, ERR_STRLEN);
+            found++;
+        }
+        free(es);
+        states[i] = NULL;
+    }
+    return 0;
+}
+
 /*! Register error categories for application-based error handling
  *
  * @param[in]  category  Applies for this category (first arg to clicon_err())
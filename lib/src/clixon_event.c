@@ -44,15 +44,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
 #include <signal.h>
 #include <syslog.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/time.h>
 
+/* epoll backend if present and not disabled by --disable-epoll, select otherwise */
+#if defined(HAVE_SYS_EPOLL_H) && !defined(CLIXON_EVENT_SELECT)
+#define EVENT_USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+/* eventfd for the cross-thread/signal wakeup descriptor (Linux), self-pipe otherwise */
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+/* signalfd to dispatch signals as regular fd events (Linux), see clixon_event_reg_signal,
+ * sigaction + EINTR otherwise */
+#ifdef HAVE_SYS_SIGNALFD_H
+#define EVENT_USE_SIGNALFD
+#include <sys/signalfd.h>
+#endif
+
 #include <cligen/cligen.h>
 
 #include "clixon_queue.h"
@@ -69,6 +90,15 @@
  */
 #define EVENT_STRLEN 32
 
+#ifdef EVENT_USE_EPOLL
+/* Max file-descriptor events handled per epoll_wait wakeup */
+#define EVENT_EPOLL_MAX 64
+/* Name of the wait primitive, for logs */
+#define EVENT_WAIT_NAME "epoll_wait"
+#else
+#define EVENT_WAIT_NAME "select"
+#endif
+
 /*
  * Types
  */
@@ -77,7 +107,9 @@ struct event_data{
     int (*e_fn)(int, void*);            /* function */
     enum {EVENT_FD, EVENT_TIME} e_type;        /* type of event */
     int e_fd;                      /* File descriptor */
+    int e_wr;                      /* 0: input event, 1: output (writable) event */
     struct timeval e_time;         /* Timeout */
+    uint64_t e_seq;                /* Registration sequence, tie-break for equal timeouts */
     void *e_arg;                   /* function argument */
     char e_string[EVENT_STRLEN];             /* string for debugging */
 };
@@ -87,11 +119,53 @@ struct event_data{
  * XXX consider use handle variables instead of global
  */
 static struct event_data *ee = NULL;
-static struct event_data *ee_timers = NULL;
+
+/* Timeouts as a binary min-heap ordered by (e_time, e_seq), replacing a list sorted by
+ * insertion which was O(n) per registration, see clixon_event_reg_timeout */
+static struct event_data **_ee_theap = NULL;
+static int                 _ee_theap_len = 0;  /* Number of armed timeouts */
+static int                 _ee_theap_size = 0; /* Allocated entries in _ee_theap */
+static uint64_t            _ee_tseq = 0;       /* Registration sequence counter */
 
 /* Set if element in ee is deleted (clixon_event_unreg_fd). Check in ee loops */
 static int _ee_unreg = 0;
 
+/* Periodic subscribers sharing aligned ticks, see clixon_event_reg_periodic */
+struct periodic_sub{
+    struct periodic_sub *p_next;   /* next in list */
+    int    (*p_fn)(int, void*);    /* callback, same signature as timeouts */
+    void    *p_arg;                /* callback argument */
+    uint32_t p_period;             /* period in ms */
+    uint64_t p_due;                /* next tick, ms since epoch, multiple of p_period */
+    char     p_string[EVENT_STRLEN]; /* subscriber name for stats and logs */
+    uint64_t p_calls;              /* completed invocations */
+    uint64_t p_time;               /* cumulative callback runtime in us */
+    uint32_t p_maxtime;            /* longest invocation in us */
+    uint32_t p_overruns;           /* invocations that ran longer than the period */
+};
+static struct periodic_sub *_pe_subs = NULL;
+
+/* Set if a subscriber is deleted (clixon_event_unreg_periodic). Check in tick loop */
+static int _pe_unreg = 0;
+
+#ifdef EVENT_USE_EPOLL
+/* epoll instance mirroring the EVENT_FD entries of ee, created on first use */
+static int _ee_epfd = -1;
+#endif
+
+/* Wakeup descriptor watched by the event loop, created on loop entry. Read end and
+ * write end: with eventfd both are the same descriptor, the self-pipe fallback uses
+ * a pipe pair. Written by clixon_event_wakeup() from threads or signal handlers */
+static int _ee_wakeupfd = -1;
+static int _ee_wakeupfd_w = -1;
+
+#ifdef EVENT_USE_SIGNALFD
+/* signalfd receiving the signals registered with clixon_event_reg_signal, the
+ * registered handlers indexed by signal number (1..31 as in clixon_signal_save) */
+static int    _ee_sigfd = -1;
+static void (*_ee_sighandler[32])(int) = {NULL, };
+#endif
+
 /* If set (eg by signal handler) exit select loop on next run and return 0 */
 static int _clicon_exit = 0;
 
@@ -161,6 +235,65 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
+#ifdef EVENT_USE_EPOLL
+/*! Get the epoll instance, creating it on first use
+ * @retval  fd   Epoll file descriptor
+ * @retval  -1   Error
+ */
+static int
+event_epoll_fd(void)
+{
+    if (_ee_epfd == -1 &&
+        (_ee_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+        clicon_err(OE_EVENTS, errno, "epoll_create1");
+    return _ee_epfd;
+}
+
+/*! Sync the epoll interest set for one fd with the registration list
+ * The interest mask is the union of all registrations on the fd: several
+ * callbacks may be registered on the same fd, it is watched once. The fd may
+ * already have been closed by the caller when the last registration is removed
+ * (closing removes it from the set), tolerate that.
+ * @param[in]  fd   File descriptor
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+event_epoll_update(int fd)
+{
+    struct epoll_event ev = {0,};
+    struct event_data *e;
+
+    if (event_epoll_fd() < 0)
+        return -1;
+    for (e=ee; e; e=e->e_next)
+        if (e->e_type == EVENT_FD && e->e_fd == fd)
+            ev.events |= e->e_wr ? EPOLLOUT : EPOLLIN;
+    ev.data.fd = fd;
+    if (ev.events == 0){
+        if (epoll_ctl(_ee_epfd, EPOLL_CTL_DEL, fd, NULL) < 0 &&
+            errno != EBADF && errno != ENOENT){
+            clicon_err(OE_EVENTS, errno, "epoll_ctl");
+            return -1;
+        }
+    }
+    else if (epoll_ctl(_ee_epfd, EPOLL_CTL_MOD, fd, &ev) < 0){
+        if (errno == ENOENT){
+            if (epoll_ctl(_ee_epfd, EPOLL_CTL_ADD, fd, &ev) < 0 &&
+                errno != EBADF){
+                clicon_err(OE_EVENTS, errno, "epoll_ctl");
+                return -1;
+            }
+        }
+        else if (errno != EBADF){
+            clicon_err(OE_EVENTS, errno, "epoll_ctl");
+            return -1;
+        }
+    }
+    return 0;
+}
+#endif /* EVENT_USE_EPOLL */
+
 /*! Register a callback function to be called on input on a file descriptor.
  *
  * @param[in]  fd  File descriptor
@@ -174,11 +307,12 @@ clicon_sig_ignore_get(void)
  * @endcode 
  * @see clixon_event_unreg_fd
  */
-int
-clixon_event_reg_fd(int   fd, 
-                    int (*fn)(int, void*), 
-                    void *arg, 
-                    char *str)
+static int
+event_reg_fd1(int   fd,
+              int (*fn)(int, void*),
+              void *arg,
+              char *str,
+              int   wr)
 {
     struct event_data *e;
 
@@ -192,12 +326,47 @@ clixon_event_reg_fd(int   fd,
     e->e_fn = fn;
     e->e_arg = arg;
     e->e_type = EVENT_FD;
+    e->e_wr = wr;
     e->e_next = ee;
     ee = e;
+#ifdef EVENT_USE_EPOLL
+    if (event_epoll_update(fd) < 0)
+        return -1;
+#endif
     clicon_debug(CLIXON_DBG_DETAIL, "%s, registering %s", __FUNCTION__, e->e_string);
     return 0;
 }
 
+int
+clixon_event_reg_fd(int   fd, 
+                    int (*fn)(int, void*), 
+                    void *arg, 
+                    char *str)
+{
+    return event_reg_fd1(fd, fn, arg, str, 0);
+}
+
+/*! Register a callback function to be called when a file descriptor is writable
+ *
+ * Used for draining queued output without blocking the event loop. Unlike input
+ * registrations this is typically transient: unregister when the queue is empty,
+ * otherwise the callback is invoked on every loop turn.
+ * @param[in]  fd  File descriptor
+ * @param[in]  fn  Function to call when fd is writable
+ * @param[in]  arg Argument to function fn
+ * @param[in]  str Describing string for logging
+ * @see clixon_event_reg_fd
+ * @see clixon_event_unreg_fd_write
+ */
+int
+clixon_event_reg_fd_write(int   fd,
+                          int (*fn)(int, void*),
+                          void *arg,
+                          char *str)
+{
+    return event_reg_fd1(fd, fn, arg, str, 1);
+}
+
 /*! Deregister a file descriptor callback
  * @param[in]  s   File descriptor
  * @param[in]  fn  Function to call when input available on fd
@@ -205,16 +374,17 @@ clixon_event_reg_fd(int   fd,
  * @see clixon_event_reg_fd
  * @see clixon_event_unreg_timeout
  */
-int
-clixon_event_unreg_fd(int   s, 
-                      int (*fn)(int, void*))
+static int
+event_unreg_fd1(int   s,
+                int (*fn)(int, void*),
+                int   wr)
 {
     struct event_data *e, **e_prev;
     int found = 0;
 
     e_prev = &ee;
     for (e = ee; e; e = e->e_next){
-        if (fn == e->e_fn && s == e->e_fd) {
+        if (fn == e->e_fn && s == e->e_fd && wr == e->e_wr) {
             found++;
             *e_prev = e->e_next;
             _ee_unreg++;
@@ -223,9 +393,297 @@ clixon_event_unreg_fd(int   s,
         }
         e_prev = &e->e_next;
     }
+#ifdef EVENT_USE_EPOLL
+    if (found && event_epoll_update(s) < 0)
+        return -1;
+#endif
     return found?0:-1;
 }
 
+int
+clixon_event_unreg_fd(int   s, 
+                      int (*fn)(int, void*))
+{
+    return event_unreg_fd1(s, fn, 0);
+}
+
+/*! Deregister a writable-fd callback
+ * @param[in]  s   File descriptor
+ * @param[in]  fn  Function registered with clixon_event_reg_fd_write
+ * @see clixon_event_reg_fd_write
+ */
+int
+clixon_event_unreg_fd_write(int   s,
+                            int (*fn)(int, void*))
+{
+    return event_unreg_fd1(s, fn, 1);
+}
+
+/*! Drain the wakeup descriptor, called by the event loop when it is readable
+ * The wakeup itself is the event: waking the loop makes it re-check the signal
+ * flags (clicon_sig_child etc) and any state a posting thread has queued.
+ */
+static int
+event_wakeup_cb(int   fd,
+                void *arg)
+{
+    uint64_t buf[16];
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    return 0;
+}
+
+/*! Create the wakeup descriptor and register it with the event loop
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+event_wakeup_init(void)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+    if ((_ee_wakeupfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0){
+        clicon_err(OE_EVENTS, errno, "eventfd");
+        return -1;
+    }
+    _ee_wakeupfd_w = _ee_wakeupfd;
+#else
+    int pfd[2];
+    int i;
+
+    if (pipe(pfd) < 0){
+        clicon_err(OE_EVENTS, errno, "pipe");
+        return -1;
+    }
+    for (i=0; i<2; i++){
+        if (fcntl(pfd[i], F_SETFL, O_NONBLOCK) < 0 ||
+            fcntl(pfd[i], F_SETFD, FD_CLOEXEC) < 0){
+            clicon_err(OE_EVENTS, errno, "fcntl");
+            return -1;
+        }
+    }
+    _ee_wakeupfd = pfd[0];
+    _ee_wakeupfd_w = pfd[1];
+#endif
+    return clixon_event_reg_fd(_ee_wakeupfd, event_wakeup_cb, NULL, "event wakeup");
+}
+
+/*! Wake the event loop from a thread or signal handler
+ *
+ * Async-signal-safe and thread-safe: writes the wakeup descriptor watched by
+ * clixon_event_loop. Use after posting state the loop should act on, eg a
+ * worker thread queueing a result, or a signal handler that has set one of the
+ * clicon_sig_* flags; the loop re-checks them when woken. Wakeups coalesce: many
+ * posts before the loop runs give a single readable event. A no-op (OK) before
+ * the first event loop call, since the loop checks all state when entered.
+ * @retval  0  OK
+ * @retval -1  Error (not logged: may run in signal context)
+ */
+int
+clixon_event_wakeup(void)
+{
+    uint64_t one = 1;
+
+    if (_ee_wakeupfd_w == -1)
+        return 0;
+    if (write(_ee_wakeupfd_w, &one, sizeof(one)) < 0 &&
+        errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        return -1;
+    return 0;
+}
+
+#ifdef EVENT_USE_SIGNALFD
+/*! Read queued signals off the signalfd and run the registered handlers
+ * Unlike sigaction delivery the handlers run synchronously in the event loop,
+ * so they are not restricted to async-signal-safe calls. A signal storm (eg
+ * SIGCHLD from many exiting children) is coalesced into one readable event.
+ */
+static int
+event_signal_cb(int   fd,
+                void *arg)
+{
+    struct signalfd_siginfo si;
+
+    while (read(fd, &si, sizeof(si)) == sizeof(si)){
+        if (si.ssi_signo < 32 && _ee_sighandler[si.ssi_signo] != NULL)
+            (*_ee_sighandler[si.ssi_signo])(si.ssi_signo);
+    }
+    return 0;
+}
+
+/*! Rebuild the signalfd mask from the handler table and sync the process mask
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+event_signal_update(void)
+{
+    sigset_t mask;
+    int      signo;
+    int      sigfd0 = _ee_sigfd;
+
+    sigemptyset(&mask);
+    for (signo=1; signo<32; signo++)
+        if (_ee_sighandler[signo] != NULL)
+            sigaddset(&mask, signo);
+    /* Block the registered signals so they reach the signalfd and not a handler */
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0){
+        clicon_err(OE_EVENTS, errno, "sigprocmask");
+        return -1;
+    }
+    if ((_ee_sigfd = signalfd(_ee_sigfd, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) < 0){
+        clicon_err(OE_EVENTS, errno, "signalfd");
+        return -1;
+    }
+    if (sigfd0 == -1 &&
+        clixon_event_reg_fd(_ee_sigfd, event_signal_cb, NULL, "event signalfd") < 0)
+        return -1;
+    return 0;
+}
+#endif /* EVENT_USE_SIGNALFD */
+
+/*! Register a signal handler dispatched by the event loop
+ *
+ * Where signalfd is available the signal is blocked and read off a signalfd
+ * watched by the event loop: handling it is an O(1) fd event like any other
+ * instead of an EINTR + restart of the wait, storms coalesce into one wakeup,
+ * and the handler runs synchronously so it need not be async-signal-safe.
+ * Elsewhere this is plain set_signal and the EINTR path applies.
+ * Children must unblock inherited signals after fork, as clixon_proc does.
+ * Only for processes driven by clixon_event_loop; others use set_signal.
+ * @param[in]  signo    Signal number
+ * @param[in]  handler  Function to call when signal occurs
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see set_signal     for the sigaction variant
+ */
+int
+clixon_event_reg_signal(int    signo,
+                        void (*handler)(int))
+{
+#ifdef EVENT_USE_SIGNALFD
+    if (signo <= 0 || signo >= 32){
+        clicon_err(OE_EVENTS, EINVAL, "signo %d out of range", signo);
+        return -1;
+    }
+    _ee_sighandler[signo] = handler;
+    return event_signal_update();
+#else
+    return set_signal(signo, handler, NULL);
+#endif
+}
+
+/*! Deregister a signal handler registered with clixon_event_reg_signal
+ * The signal is unblocked and reverts to its default disposition.
+ * @param[in]  signo  Signal number
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_event_unreg_signal(int signo)
+{
+#ifdef EVENT_USE_SIGNALFD
+    if (signo <= 0 || signo >= 32){
+        clicon_err(OE_EVENTS, EINVAL, "signo %d out of range", signo);
+        return -1;
+    }
+    _ee_sighandler[signo] = NULL;
+    if (event_signal_update() < 0)
+        return -1;
+    clicon_signal_unblock(signo);
+    return 0;
+#else
+    return set_signal(signo, SIG_DFL, NULL);
+#endif
+}
+
+/*! Order two armed timeouts: earlier time first, registration order on ties
+ */
+static int
+timer_less(struct event_data *e1,
+           struct event_data *e2)
+{
+    if (timercmp(&e1->e_time, &e2->e_time, !=))
+        return timercmp(&e1->e_time, &e2->e_time, <);
+    return e1->e_seq < e2->e_seq;
+}
+
+/*! Move heap entry i towards the root until the heap property holds
+ */
+static void
+timer_heap_siftup(int i)
+{
+    struct event_data *e = _ee_theap[i];
+
+    while (i > 0 && timer_less(e, _ee_theap[(i-1)/2])){
+        _ee_theap[i] = _ee_theap[(i-1)/2];
+        i = (i-1)/2;
+    }
+    _ee_theap[i] = e;
+}
+
+/*! Move heap entry i towards the leaves until the heap property holds
+ */
+static void
+timer_heap_siftdown(int i)
+{
+    struct event_data *e = _ee_theap[i];
+    int                c;
+
+    while ((c = 2*i+1) < _ee_theap_len){
+        if (c+1 < _ee_theap_len && timer_less(_ee_theap[c+1], _ee_theap[c]))
+            c++;
+        if (!timer_less(_ee_theap[c], e))
+            break;
+        _ee_theap[i] = _ee_theap[c];
+        i = c;
+    }
+    _ee_theap[i] = e;
+}
+
+/*! Insert a timeout into the heap, growing the array as needed
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+timer_heap_push(struct event_data *e)
+{
+    struct event_data **theap;
+    int                 size;
+
+    if (_ee_theap_len == _ee_theap_size){
+        size = _ee_theap_size ? 2*_ee_theap_size : 64;
+        if ((theap = realloc(_ee_theap, size*sizeof(*theap))) == NULL){
+            clicon_err(OE_EVENTS, errno, "realloc");
+            return -1;
+        }
+        _ee_theap = theap;
+        _ee_theap_size = size;
+    }
+    _ee_theap[_ee_theap_len] = e;
+    timer_heap_siftup(_ee_theap_len++);
+    return 0;
+}
+
+/*! Remove heap entry i, restoring the heap property
+ * @retval  e  The removed entry, owned by caller
+ */
+static struct event_data *
+timer_heap_del(int i)
+{
+    struct event_data *e = _ee_theap[i];
+
+    if (--_ee_theap_len > i){
+        _ee_theap[i] = _ee_theap[_ee_theap_len];
+        /* The replacement can violate the property in either direction */
+        if (i > 0 && timer_less(_ee_theap[i], _ee_theap[(i-1)/2]))
+            timer_heap_siftup(i);
+        else
+            timer_heap_siftdown(i);
+    }
+    return e;
+}
+
 /*! Call a callback function at an absolute time
  * @param[in]  t   Absolute (not relative!) timestamp when callback is called
  * @param[in]  fn  Function to call at time t
@@ -255,7 +713,7 @@ clixon_event_reg_timeout(struct timeval t,
                          void          *arg, 
                          char          *str)
 {
-    struct event_data *e, *e1, **e_prev;
+    struct event_data *e;
 
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clicon_err(OE_EVENTS, errno, "malloc");
@@ -267,16 +725,12 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &ee_timers;
-    for (e1=ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
+    e->e_seq = _ee_tseq++;
+    if (timer_heap_push(e) < 0){
+        free(e);
+        return -1;
     }
-    e->e_next = e1;
-    *e_prev = e;
-    clicon_debug(CLIXON_DBG_DETAIL, "%s: %s", __FUNCTION__, str); 
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: %s", __FUNCTION__, str);
     return 0;
 }
 
@@ -295,42 +749,241 @@ int
 clixon_event_unreg_timeout(int (*fn)(int, void*), 
                            void *arg)
 {
-    struct event_data *e, **e_prev;
     int found = 0;
+    int i;
 
-    e_prev = &ee_timers;
-    for (e = ee_timers; e; e = e->e_next){
-        if (fn == e->e_fn && arg == e->e_arg) {
+    for (i = 0; i < _ee_theap_len; i++){
+        if (fn == _ee_theap[i]->e_fn && arg == _ee_theap[i]->e_arg){
             found++;
-            *e_prev = e->e_next;
-            free(e);
+            free(timer_heap_del(i));
             break;
         }
-        e_prev = &e->e_next;
     }
     return found?0:-1;
 }
 
+/*! Milliseconds since the epoch, the time base of the periodic scheduler
+ */
+static uint64_t
+periodic_now_ms(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return (uint64_t)t.tv_sec*1000 + t.tv_usec/1000;
+}
+
+/* Forward, periodic_arm and event_periodic_tick reference each other */
+static int event_periodic_tick(int fd, void *arg);
+
+/*! (Re)register the single shared timeout for the earliest due periodic tick
+ * Unregisters any previously armed tick; a no-op when no subscribers remain.
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+periodic_arm(void)
+{
+    struct periodic_sub *ps;
+    uint64_t             due = 0;
+    struct timeval       t;
+
+    for (ps=_pe_subs; ps; ps=ps->p_next)
+        if (due == 0 || ps->p_due < due)
+            due = ps->p_due;
+    clixon_event_unreg_timeout(event_periodic_tick, NULL); /* may not be armed */
+    if (due == 0)
+        return 0;
+    t.tv_sec = due/1000;
+    t.tv_usec = (due%1000)*1000;
+    return clixon_event_reg_timeout(t, event_periodic_tick, NULL, "periodic tick");
+}
+
+/*! Shared tick: run every due subscriber in one batch, record runtimes, re-arm
+ * @retval  0  OK
+ * @retval -1  Error from a subscriber callback, propagates out of the event loop
+ */
+static int
+event_periodic_tick(int   fd,
+                    void *arg)
+{
+    struct periodic_sub *ps;
+    uint64_t             now;
+    struct timeval       t0;
+    struct timeval       t1;
+    uint32_t             us;
+
+ again:
+    now = periodic_now_ms();
+    _pe_unreg = 0;
+    for (ps=_pe_subs; ps; ps=ps->p_next){
+        if (ps->p_due > now)
+            continue;
+        /* Next aligned tick strictly after now: a callback that overruns its own
+         * period slips ticks instead of bursting to catch up */
+        ps->p_due = (now/ps->p_period + 1)*(uint64_t)ps->p_period;
+        gettimeofday(&t0, NULL);
+        if ((*ps->p_fn)(0, ps->p_arg) < 0){
+            clicon_debug(1, "%s Error in: %s", __FUNCTION__, ps->p_string);
+            return -1;
+        }
+        gettimeofday(&t1, NULL);
+        timersub(&t1, &t0, &t0);
+        us = t0.tv_sec*1000000 + t0.tv_usec;
+        ps->p_calls++;
+        ps->p_time += us;
+        if (us > ps->p_maxtime)
+            ps->p_maxtime = us;
+        if (us/1000 > ps->p_period){
+            ps->p_overruns++;
+            clicon_log(LOG_WARNING, "periodic %s: callback ran %u ms, period %u ms (%u overruns)",
+                       ps->p_string, us/1000, ps->p_period, ps->p_overruns);
+        }
+        if (_pe_unreg) /* Callback changed the list: restart, due times already advanced */
+            goto again;
+    }
+    return periodic_arm();
+}
+
+/*! Register a periodic callback on the shared coalescing tick scheduler
+ *
+ * For recurring polling work (counters, state probes): instead of every caller
+ * arming its own clixon_event_reg_timeout at unaligned times, ticks are aligned
+ * to multiples of the period since the epoch, so subscribers with the same
+ * period share one wakeup and harmonic periods (eg 1s and 5s) coincide every
+ * common multiple. All subscribers due at a tick run in one batch. Per
+ * subscriber the scheduler records invocations, cumulative and max runtime and
+ * overruns (an invocation exceeding its own period, which delays other
+ * subscribers: logged as warning), see clixon_event_periodic_stats.
+ * The first tick is the next aligned boundary, not period_ms from now.
+ * @param[in]  period_ms  Period in milliseconds, must be > 0
+ * @param[in]  fn         Function to call every period. First argument is a
+ *                        dummy as for timeout callbacks. On < 0 the event loop
+ *                        exits with error
+ * @param[in]  arg        Argument to function fn
+ * @param[in]  str        Describing string for logging and stats
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see clixon_event_reg_timeout  for one-shot timeouts
+ * @see clixon_event_unreg_periodic
+ */
+int
+clixon_event_reg_periodic(uint32_t period_ms,
+                          int    (*fn)(int, void*),
+                          void    *arg,
+                          char    *str)
+{
+    struct periodic_sub *ps;
+
+    if (period_ms == 0){
+        clicon_err(OE_EVENTS, EINVAL, "period_ms is 0");
+        return -1;
+    }
+    if ((ps = (struct periodic_sub *)malloc(sizeof(*ps))) == NULL){
+        clicon_err(OE_EVENTS, errno, "malloc");
+        return -1;
+    }
+    memset(ps, 0, sizeof(*ps));
+    strncpy(ps->p_string, str, EVENT_STRLEN-1);
+    ps->p_fn = fn;
+    ps->p_arg = arg;
+    ps->p_period = period_ms;
+    ps->p_due = (periodic_now_ms()/period_ms + 1)*(uint64_t)period_ms;
+    ps->p_next = _pe_subs;
+    _pe_subs = ps;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: %s period %ums", __FUNCTION__, str, period_ms);
+    return periodic_arm();
+}
+
+/*! Deregister a periodic callback registered with clixon_event_reg_periodic
+ * Deregisters when exactly function and argument match, as clixon_event_unreg_timeout.
+ * @param[in]  fn   Function registered
+ * @param[in]  arg  Argument to function fn
+ * @retval     0    OK, subscriber unregistered
+ * @retval    -1    Subscriber not found
+ */
+int
+clixon_event_unreg_periodic(int (*fn)(int, void*),
+                            void *arg)
+{
+    struct periodic_sub *ps, **ps_prev;
+    int                  found = 0;
+
+    ps_prev = &_pe_subs;
+    for (ps = _pe_subs; ps; ps = ps->p_next){
+        if (fn == ps->p_fn && arg == ps->p_arg){
+            found++;
+            *ps_prev = ps->p_next;
+            _pe_unreg++;
+            free(ps);
+            break;
+        }
+        ps_prev = &ps->p_next;
+    }
+    if (found && periodic_arm() < 0)
+        return -1;
+    return found?0:-1;
+}
+
+/*! Print per-subscriber periodic scheduler statistics, one line per subscriber
+ * Shows which subscriber is loading the event loop: invocation count, cumulative
+ * and max runtime, and overruns (invocations exceeding their own period).
+ * @param[in]  cb  Print stats to this cligen buffer
+ * @retval     0   OK
+ */
+int
+clixon_event_periodic_stats(cbuf *cb)
+{
+    struct periodic_sub *ps;
+
+    for (ps=_pe_subs; ps; ps=ps->p_next)
+        cprintf(cb, "%s: period %u ms calls %" PRIu64 " total %" PRIu64 " ms max %u ms overruns %u\n",
+                ps->p_string, ps->p_period, ps->p_calls, ps->p_time/1000,
+                ps->p_maxtime/1000, ps->p_overruns);
+    return 0;
+}
+
 /*! Poll to see if there is any data available on this file descriptor.
  * @param[in]  fd   File descriptor
  * @retval    -1    Error
  * @retval     0    Nothing to read/empty fd
  * @retval     1    Something to read on fd
  */
-int 
+int
 clixon_event_poll(int fd)
 {
-    int            retval = -1;
-    fd_set         fdset;
-    struct timeval tnull = {0,};
+    int           retval = -1;
+    struct pollfd pfd = {0,};
 
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-    if ((retval = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull)) < 0)
-        clicon_err(OE_EVENTS, errno, "select");
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if ((retval = poll(&pfd, 1, 0)) < 0)
+        clicon_err(OE_EVENTS, errno, "poll");
     return retval;
 }
 
+/*! Get number of registered event handlers, eg for monitoring of the event queue depth
+ * @param[out] nfd      Number of registered file descriptor handlers
+ * @param[out] ntimeout Number of armed timeouts
+ * @retval     0        OK
+ */
+int
+clixon_event_stats(int *nfd,
+                   int *ntimeout)
+{
+    struct event_data *e;
+    int                n = 0;
+
+    for (e = ee; e; e = e->e_next)
+        if (e->e_type == EVENT_FD)
+            n++;
+    if (nfd)
+        *nfd = n;
+    if (ntimeout)
+        *ntimeout = _ee_theap_len;
+    return 0;
+}
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
  *
  * @param[in] h  Clixon handle
@@ -348,31 +1001,59 @@ clixon_event_loop(clicon_handle h)
     int                n;
     struct timeval     t;
     struct timeval     t0;
+#ifdef EVENT_USE_EPOLL
+    struct epoll_event evs[EVENT_EPOLL_MAX];
+    int                tms;
+    int                i;
+#else
     struct timeval     tnull = {0,};
     fd_set             fdset;
+    fd_set             wset;
+#endif
     int                retval = -1;
 
+    if (_ee_wakeupfd == -1 && event_wakeup_init() < 0)
+        return retval;
     while (clixon_exit_get() != 1){
-        FD_ZERO(&fdset);
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
                 goto err;
             clicon_sig_child_set(0);
         }
+#ifdef EVENT_USE_EPOLL
+        if (event_epoll_fd() < 0) /* Interest set is kept in sync by reg/unreg */
+            goto err;
+        if (_ee_theap_len > 0){
+            gettimeofday(&t0, NULL);
+            timersub(&_ee_theap[0]->e_time, &t0, &t);
+            if (t.tv_sec < 0)
+                tms = 0;
+            else if (t.tv_sec >= INT_MAX/1000)
+                tms = INT_MAX; /* Far-future timeout: wake early and recompute */
+            else
+                tms = (int)(t.tv_sec*1000 + t.tv_usec/1000);
+        }
+        else
+            tms = -1;
+        n = epoll_wait(_ee_epfd, evs, EVENT_EPOLL_MAX, tms);
+#else
+        FD_ZERO(&fdset);
+        FD_ZERO(&wset);
         for (e=ee; e; e=e->e_next)
             if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
-        if (ee_timers != NULL){
+                FD_SET(e->e_fd, e->e_wr ? &wset : &fdset);
+        if (_ee_theap_len > 0){
             gettimeofday(&t0, NULL);
-            timersub(&ee_timers->e_time, &t0, &t); 
+            timersub(&_ee_theap[0]->e_time, &t0, &t);
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull); 
+                n = select(FD_SETSIZE, &fdset, &wset, NULL, &tnull);
             else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t); 
+                n = select(FD_SETSIZE, &fdset, &wset, NULL, &t);
         }
         else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+            n = select(FD_SETSIZE, &fdset, &wset, NULL, NULL);
+#endif /* EVENT_USE_EPOLL */
         if (clixon_exit_get() == 1){
             break;
         }
@@ -388,9 +1069,9 @@ clixon_event_loop(clicon_handle h)
                  *     New select loop is called
                  * (3) Other signals result in an error and return -1.
                  */
-                clicon_debug(1, "%s select: %s", __FUNCTION__, strerror(errno));
+                clicon_debug(1, "%s %s: %s", __FUNCTION__, EVENT_WAIT_NAME, strerror(errno));
                 if (clixon_exit_get() == 1){
-                    clicon_err(OE_EVENTS, errno, "select");
+                    clicon_err(OE_EVENTS, errno, "%s", EVENT_WAIT_NAME);
                     retval = 0;
                 }
                 else if (clicon_sig_child_get()){
@@ -405,15 +1086,14 @@ clixon_event_loop(clicon_handle h)
                     continue;
                 }
                 else
-                    clicon_err(OE_EVENTS, errno, "select");
+                    clicon_err(OE_EVENTS, errno, "%s", EVENT_WAIT_NAME);
             }
             else
-                clicon_err(OE_EVENTS, errno, "select");
+                clicon_err(OE_EVENTS, errno, "%s", EVENT_WAIT_NAME);
             goto err;
         }
-        if (n==0){ /* Timeout */
-            e = ee_timers;
-            ee_timers = ee_timers->e_next;
+        if (n==0 && _ee_theap_len > 0){ /* Timeout */
+            e = timer_heap_del(0);
             clicon_debug(CLIXON_DBG_DETAIL, "%s timeout: %s", __FUNCTION__, e->e_string);
             if ((*e->e_fn)(0, e->e_arg) < 0){
                 free(e);
@@ -422,12 +1102,38 @@ clixon_event_loop(clicon_handle h)
             free(e);
         }
         _ee_unreg = 0;
+#ifdef EVENT_USE_EPOLL
+        for (i=0; i<n && _ee_unreg == 0; i++){
+            if (clixon_exit_get() == 1){
+                break;
+            }
+            /* Find the callbacks registered on this fd, there are typically few ready
+             * fds per wakeup so the scan does not revisit the whole registration list
+             * once per registered fd as the select variant does
+             */
+            for (e=ee; e; e=e_next){
+                e_next = e->e_next;
+                if (e->e_type == EVENT_FD && e->e_fd == evs[i].data.fd &&
+                    (evs[i].events & (e->e_wr ? (EPOLLOUT|EPOLLERR|EPOLLHUP)
+                                              : (EPOLLIN|EPOLLERR|EPOLLHUP)))){
+                    clicon_debug(CLIXON_DBG_DETAIL, "%s: epoll ready: %s", __FUNCTION__, e->e_string);
+                    if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
+                        clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
+                        goto err;
+                    }
+                    if (_ee_unreg)
+                        break;
+                }
+            }
+        }
+        _ee_unreg = 0;
+#else
         for (e=ee; e; e=e_next){
             if (clixon_exit_get() == 1){
                 break;
             }
             e_next = e->e_next;
-            if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset)){
+            if(e->e_type == EVENT_FD && FD_ISSET(e->e_fd, e->e_wr ? &wset : &fdset)){
                 clicon_debug(CLIXON_DBG_DETAIL, "%s: FD_ISSET: %s", __FUNCTION__, e->e_string);
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                     clicon_debug(1, "%s Error in: %s", __FUNCTION__, e->e_string);
@@ -439,6 +1145,7 @@ clixon_event_loop(clicon_handle h)
                 }
             }
         }
+#endif /* EVENT_USE_EPOLL */
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
         continue;
       err:
@@ -454,19 +1161,52 @@ clixon_event_loop(clicon_handle h)
 int
 clixon_event_exit(void)
 {
-    struct event_data *e, *e_next;
-    
+    struct event_data   *e, *e_next;
+    struct periodic_sub *ps, *ps_next;
+    int                  i;
+
     e_next = ee;
     while ((e = e_next) != NULL){
         e_next = e->e_next;
         free(e);
     }
     ee = NULL;
-    e_next = ee_timers;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
+    ps_next = _pe_subs;
+    while ((ps = ps_next) != NULL){
+        ps_next = ps->p_next;
+        free(ps);
+    }
+    _pe_subs = NULL;
+    for (i = 0; i < _ee_theap_len; i++)
+        free(_ee_theap[i]);
+    if (_ee_theap){
+        free(_ee_theap);
+        _ee_theap = NULL;
+    }
+    _ee_theap_len = 0;
+    _ee_theap_size = 0;
+#ifdef EVENT_USE_EPOLL
+    if (_ee_epfd != -1){
+        close(_ee_epfd);
+        _ee_epfd = -1;
+    }
+#endif
+    if (_ee_wakeupfd != -1){
+        if (_ee_wakeupfd_w != _ee_wakeupfd)
+            close(_ee_wakeupfd_w);
+        close(_ee_wakeupfd);
+        _ee_wakeupfd = _ee_wakeupfd_w = -1;
+    }
+#ifdef EVENT_USE_SIGNALFD
+    if (_ee_sigfd != -1){
+        close(_ee_sigfd);
+        _ee_sigfd = -1;
+        for (i=1; i<32; i++){
+            if (_ee_sighandler[i] != NULL)
+                clicon_signal_unblock(i);
+            _ee_sighandler[i] = NULL;
+        }
     }
-    ee_timers = NULL;
+#endif
     return 0;
 }
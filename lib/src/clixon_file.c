@@ -34,6 +34,8 @@
 
  *
  */
+#define _GNU_SOURCE /* fopencookie */
+
 #ifdef HAVE_CONFIG_H
 #include "clixon_config.h"
 #endif
@@ -49,6 +51,10 @@
 #include <sys/stat.h>
 #include <sys/param.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h> /* FICLONE reflink copy */
+#endif
 #include <netinet/in.h>
 #include <stddef.h>
 
@@ -263,13 +269,16 @@ quit:
 
 /*! Make a copy of file src. Overwrite existing
  *
+ * Tries a filesystem reflink (constant-time, shares blocks) and then
+ * copy_file_range (in-kernel copy) where available before falling back to a
+ * read/write loop. The fallbacks resume at the file offsets already copied.
  * @param[in]  src     Source filename
  * @param[out] target  Destination filename
  * @retval     0       OK
  * @retval     -1      Error
  */
 int
-clicon_file_copy(char *src, 
+clicon_file_copy(char *src,
                  char *target)
 {
     int         retval = -1;
@@ -278,6 +287,10 @@ clicon_file_copy(char *src,
     char        line[512];
     int         bytes;
     struct stat st;
+#ifdef HAVE_COPY_FILE_RANGE
+    off_t       left;
+    ssize_t     n;
+#endif
 
     if (stat(src, &st) != 0){
         clicon_err(OE_UNIX, errno, "stat");
@@ -292,6 +305,23 @@ clicon_file_copy(char *src,
         err = errno;
         goto error;
     }
+#ifdef FICLONE
+    if (ioctl(ouF, FICLONE, inF) == 0){ /* Not supported on all filesystems */
+        retval = 0;
+        goto error;
+    }
+#endif
+#ifdef HAVE_COPY_FILE_RANGE
+    left = st.st_size;
+    while (left > 0 && (n = copy_file_range(inF, NULL, ouF, NULL, left, 0)) > 0)
+        left -= n;
+    if (left == 0){
+        retval = 0;
+        goto error;
+    }
+    /* Not supported (eg cross-filesystem): fall through to the read/write
+     * loop which continues at the offsets already copied */
+#endif
     while((bytes = read(inF, line, sizeof(line))) > 0)
         if (write(ouF, line, bytes) < 0){
             clicon_err(OE_UNIX, errno, "write(%s)", src);
@@ -347,3 +377,225 @@ clicon_file_cbuf(const char *filename,
         errno = err;
     return retval;
 }
+
+/*! Check if a file starts with the zstd frame magic number
+ *
+ * Used to auto-detect compressed datastore files, see clixon_file_zstd_read.
+ * Works also when built without zstd, so an informative error can be given.
+ * @param[in]  fp  Open file, position is restored to the start
+ * @retval     1   File is zstd-compressed
+ * @retval     0   Not zstd (including files shorter than the magic)
+ * @retval    -1   Error
+ */
+int
+clixon_file_zstd_magic(FILE *fp)
+{
+    unsigned char magic[4];
+    size_t        n;
+
+    n = fread(magic, 1, sizeof(magic), fp);
+    if (n < sizeof(magic) && ferror(fp)){
+        clicon_err(OE_UNIX, errno, "fread");
+        return -1;
+    }
+    rewind(fp);
+    return (n == sizeof(magic) &&
+            magic[0] == 0x28 && magic[1] == 0xb5 &&
+            magic[2] == 0x2f && magic[3] == 0xfd);
+}
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+
+/* Staging buffer size for the zstd stream wrappers below */
+#define ZSTD_COOKIE_BUFLEN 16384
+
+/* State of a zstd stream wrapped as a stdio FILE via fopencookie(3) */
+struct zstd_cookie {
+    FILE         *zc_fp;     /* Underlying file, owned by the caller */
+    ZSTD_DStream *zc_d;      /* Decompression context (read direction) */
+    ZSTD_CStream *zc_c;      /* Compression context (write direction) */
+    ZSTD_inBuffer zc_in;     /* Pending compressed input (read direction) */
+    char         *zc_buf;    /* Staging buffer between zstd and zc_fp */
+    size_t        zc_buflen;
+};
+
+/*! fopencookie read: decompress from the underlying file into buf
+ */
+static ssize_t
+zstd_cookie_read(void  *cookie,
+                 char  *buf,
+                 size_t size)
+{
+    struct zstd_cookie *zc = (struct zstd_cookie *)cookie;
+    ZSTD_outBuffer      out = {buf, size, 0};
+    size_t              ret;
+
+    while (out.pos < out.size){
+        if (zc->zc_in.pos == zc->zc_in.size){
+            if ((ret = fread(zc->zc_buf, 1, zc->zc_buflen, zc->zc_fp)) == 0){
+                if (ferror(zc->zc_fp))
+                    return -1;
+                break; /* eof */
+            }
+            zc->zc_in.src = zc->zc_buf;
+            zc->zc_in.size = ret;
+            zc->zc_in.pos = 0;
+        }
+        ret = ZSTD_decompressStream(zc->zc_d, &out, &zc->zc_in);
+        if (ZSTD_isError(ret)){
+            errno = EIO;
+            return -1;
+        }
+    }
+    return out.pos;
+}
+
+/*! fopencookie write: compress buf onto the underlying file
+ */
+static ssize_t
+zstd_cookie_write(void       *cookie,
+                  const char *buf,
+                  size_t      size)
+{
+    struct zstd_cookie *zc = (struct zstd_cookie *)cookie;
+    ZSTD_inBuffer       in = {buf, size, 0};
+    size_t              ret;
+
+    while (in.pos < in.size){
+        ZSTD_outBuffer out = {zc->zc_buf, zc->zc_buflen, 0};
+        ret = ZSTD_compressStream2(zc->zc_c, &out, &in, ZSTD_e_continue);
+        if (ZSTD_isError(ret)){
+            errno = EIO;
+            return -1;
+        }
+        if (out.pos &&
+            fwrite(zc->zc_buf, 1, out.pos, zc->zc_fp) != out.pos)
+            return -1;
+    }
+    return size;
+}
+
+/*! fopencookie close: end the zstd frame (write direction) and free state
+ *
+ * The underlying file is left open, it is owned and closed by the caller.
+ */
+static int
+zstd_cookie_close(void *cookie)
+{
+    struct zstd_cookie *zc = (struct zstd_cookie *)cookie;
+    int                 retval = 0;
+    size_t              ret;
+
+    if (zc->zc_c){
+        ZSTD_inBuffer in = {NULL, 0, 0};
+        do {
+            ZSTD_outBuffer out = {zc->zc_buf, zc->zc_buflen, 0};
+            ret = ZSTD_compressStream2(zc->zc_c, &out, &in, ZSTD_e_end);
+            if (ZSTD_isError(ret)){
+                retval = -1;
+                break;
+            }
+            if (out.pos &&
+                fwrite(zc->zc_buf, 1, out.pos, zc->zc_fp) != out.pos){
+                retval = -1;
+                break;
+            }
+        } while (ret != 0);
+        ZSTD_freeCStream(zc->zc_c);
+    }
+    if (zc->zc_d)
+        ZSTD_freeDStream(zc->zc_d);
+    if (zc->zc_buf)
+        free(zc->zc_buf);
+    free(zc);
+    return retval;
+}
+
+/*! Common allocation for the zstd stream wrappers
+ */
+static struct zstd_cookie *
+zstd_cookie_new(FILE *fp)
+{
+    struct zstd_cookie *zc;
+
+    if ((zc = calloc(1, sizeof(*zc))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return NULL;
+    }
+    zc->zc_fp = fp;
+    zc->zc_buflen = ZSTD_COOKIE_BUFLEN;
+    if ((zc->zc_buf = malloc(zc->zc_buflen)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        free(zc);
+        return NULL;
+    }
+    return zc;
+}
+
+/*! Wrap an open file in a stream that decompresses zstd on read
+ *
+ * Reads from the returned FILE yield the decompressed byte stream, so it can
+ * feed a streaming parser without inflating the file into a buffer first.
+ * @param[in]  fp  Open file positioned at a zstd frame. Caller keeps ownership
+ *                 and closes it after closing the returned stream
+ * @retval     f   Read-only FILE, close with fclose(3)
+ * @retval     NULL Error
+ * @see clixon_file_zstd_magic  Detect whether wrapping is needed
+ */
+FILE *
+clixon_file_zstd_read(FILE *fp)
+{
+    struct zstd_cookie   *zc;
+    cookie_io_functions_t io = {0,};
+    FILE                 *f;
+
+    if ((zc = zstd_cookie_new(fp)) == NULL)
+        return NULL;
+    if ((zc->zc_d = ZSTD_createDStream()) == NULL){
+        clicon_err(OE_UNIX, errno, "ZSTD_createDStream");
+        zstd_cookie_close(zc);
+        return NULL;
+    }
+    io.read = zstd_cookie_read;
+    io.close = zstd_cookie_close;
+    if ((f = fopencookie(zc, "r", io)) == NULL){
+        clicon_err(OE_UNIX, errno, "fopencookie");
+        zstd_cookie_close(zc);
+        return NULL;
+    }
+    return f;
+}
+
+/*! Wrap an open file in a stream that compresses with zstd on write
+ *
+ * @param[in]  fp  Open file to receive the compressed frame. Caller keeps
+ *                 ownership and closes it after closing the returned stream
+ * @retval     f   Write-only FILE. fclose(3) ends the zstd frame, so close
+ *                 (and check the return value) before fsync of fp
+ * @retval     NULL Error
+ */
+FILE *
+clixon_file_zstd_write(FILE *fp)
+{
+    struct zstd_cookie   *zc;
+    cookie_io_functions_t io = {0,};
+    FILE                 *f;
+
+    if ((zc = zstd_cookie_new(fp)) == NULL)
+        return NULL;
+    if ((zc->zc_c = ZSTD_createCStream()) == NULL){
+        clicon_err(OE_UNIX, errno, "ZSTD_createCStream");
+        zstd_cookie_close(zc);
+        return NULL;
+    }
+    io.write = zstd_cookie_write;
+    io.close = zstd_cookie_close;
+    if ((f = fopencookie(zc, "w", io)) == NULL){
+        clicon_err(OE_UNIX, errno, "fopencookie");
+        zstd_cookie_close(zc);
+        return NULL;
+    }
+    return f;
+}
+#endif /* WITH_ZSTD */
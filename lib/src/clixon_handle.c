@@ -91,6 +91,7 @@ struct clicon_handle {
     clicon_hash_t    *ch_data;     /* internal clicon data (HDR) */
     clicon_hash_t    *ch_db_elmnt; /* xml datastore element cache data */
     event_stream_t   *ch_stream;   /* notification streams, see clixon_stream.[ch] */
+    struct clicon_option_cache ch_optcache; /* typed snapshot of hot options (HDR), see clicon_optcache_update */
 };
 
 /*! Internal call to allocate a CLICON handle. 
@@ -193,6 +194,18 @@ clicon_options(clicon_handle h)
     return ch->ch_copt;
 }
 
+/*! Return the typed option snapshot embedded in a handle
+ * @param[in]  h        Clicon handle
+ * @see clicon_optcache_update which populates it from the options hash
+ */
+clicon_option_cache *
+clicon_optcache(clicon_handle h)
+{
+    struct clicon_handle *ch = handle(h);
+
+    return &ch->ch_optcache;
+}
+
 /*! Return clicon data (hash-array) given a handle.
  * @param[in]  h        Clicon handle
  */
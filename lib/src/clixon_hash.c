@@ -98,19 +98,106 @@
 #include "clixon_err.h"
 #include "clixon_hash.h"
 
-#define HASH_SIZE       1031    /* Number of hash buckets. Should be a prime */ 
-#define align4(s) (((s)/4)*4 + 4)
+#define HASH_INIT_SIZE  8       /* Initial nr of slots. Must be a power of two */
+#define HASH_MAX_LOAD_PERCENT 75 /* Resize when used/size exceeds this */
+
+/* Open-addressing (robin hood) hash table.
+ * Slots are struct clicon_hash (see clixon_hash.h): h_dist is the probe
+ * distance from the home slot plus one, 0 marks an empty slot. On insert an
+ * entry displaces a resident with a smaller distance ("steals from the
+ * rich"), which keeps probe sequences short and lets lookups stop as soon as
+ * the distance exceeds that of the slot being probed. Deletion backward-shifts
+ * the following cluster so no tombstones are needed.
+ * The table doubles when more than HASH_MAX_LOAD_PERCENT of the slots are
+ * used; key and value allocations are stable across such resizes, slot
+ * addresses are not.
+ */
+struct hash_table {
+    size_t             ht_size;  /* Nr of allocated slots, power of two */
+    size_t             ht_used;  /* Nr of occupied slots */
+    struct clicon_hash *ht_slots; /* Slot vector */
+};
+
+/*! Free the value of an entry: destructor for by-reference values, free otherwise
+ */
+static void
+hash_val_free(struct clicon_hash *h)
+{
+    if (h->h_val == NULL)
+        return;
+    if (h->h_free)
+        (*h->h_free)(h->h_val);
+    else
+        free(h->h_val);
+}
 
-/*! A very simplistic algorithm to calculate a hash bucket index
+/*! FNV-1a string hash
  */
 static uint32_t
-hash_bucket(const char *str)
+hash_str(const char *str)
 {
-    uint32_t n = 0;
+    uint32_t h = 0x811c9dc5;
 
-    while(*str)
-        n += (uint32_t)*str++;
-    return n % HASH_SIZE;
+    while (*str){
+        h ^= (uint32_t)(unsigned char)*str++;
+        h *= 0x01000193;
+    }
+    return h;
+}
+
+/*! Insert an entry into the slot vector using robin hood displacement
+ * Takes over the (already allocated) key/value pointers in e.
+ */
+static void
+hash_insert_slot(struct hash_table  *ht,
+                 struct clicon_hash  e)
+{
+    size_t             mask = ht->ht_size - 1;
+    size_t             i = e.h_hash32 & mask;
+    struct clicon_hash tmp;
+
+    e.h_dist = 1;
+    for (;;){
+        if (ht->ht_slots[i].h_dist == 0){ /* empty: place here */
+            ht->ht_slots[i] = e;
+            ht->ht_used++;
+            return;
+        }
+        if (ht->ht_slots[i].h_dist < e.h_dist){ /* displace richer resident */
+            tmp = ht->ht_slots[i];
+            ht->ht_slots[i] = e;
+            e = tmp;
+        }
+        i = (i + 1) & mask;
+        e.h_dist++;
+    }
+}
+
+/*! Grow the slot vector to newsize and rehash all entries
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+hash_resize(struct hash_table *ht,
+            size_t             newsize)
+{
+    struct clicon_hash *old = ht->ht_slots;
+    size_t              oldsize = ht->ht_size;
+    size_t              i;
+
+    if ((ht->ht_slots = calloc(newsize, sizeof(struct clicon_hash))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        ht->ht_slots = old;
+        return -1;
+    }
+    ht->ht_size = newsize;
+    ht->ht_used = 0;
+    for (i = 0; i < oldsize; i++)
+        if (old[i].h_dist != 0)
+            hash_insert_slot(ht, old[i]);
+    if (old)
+        free(old);
+    return 0;
 }
 
 /*! Initialize hash table.
@@ -122,14 +209,20 @@ hash_bucket(const char *str)
 clicon_hash_t *
 clicon_hash_init(void)
 {
-  clicon_hash_t *hash;
-
-  if ((hash = (clicon_hash_t *)malloc(sizeof(clicon_hash_t) * HASH_SIZE)) == NULL){
-      clicon_err(OE_UNIX, errno, "malloc");
-      return NULL;
-  }
-  memset(hash, 0, sizeof(clicon_hash_t)*HASH_SIZE);
-  return hash;
+    struct hash_table *ht;
+
+    if ((ht = malloc(sizeof(*ht))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ht, 0, sizeof(*ht));
+    if ((ht->ht_slots = calloc(HASH_INIT_SIZE, sizeof(struct clicon_hash))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        free(ht);
+        return NULL;
+    }
+    ht->ht_size = HASH_INIT_SIZE;
+    return (clicon_hash_t *)ht;
 }
 
 /*! Free hash table.
@@ -141,18 +234,17 @@ clicon_hash_init(void)
 int
 clicon_hash_free(clicon_hash_t *hash)
 {
-    int i;
-    clicon_hash_t tmp;
-    for (i = 0; i < HASH_SIZE; i++) {
-        while (hash[i]) {
-            tmp = hash[i];
-            DELQ(tmp, hash[i], clicon_hash_t);
-            free(tmp->h_key);
-            free(tmp->h_val);
-            free(tmp);
-        }
+    struct hash_table *ht = (struct hash_table *)hash;
+    size_t             i;
+
+    for (i = 0; i < ht->ht_size; i++){
+        if (ht->ht_slots[i].h_dist == 0)
+            continue;
+        free(ht->ht_slots[i].h_key);
+        hash_val_free(&ht->ht_slots[i]);
     }
-    free(hash);
+    free(ht->ht_slots);
+    free(ht);
     return 0;
 }
 
@@ -162,24 +254,28 @@ clicon_hash_free(clicon_hash_t *hash)
  * @param[in] key      Variable name
  * @retval    variable Hash variable structure on success
  * @retval    NULL     Not found
+ * @note The returned entry is only valid until the next add/del on the table
  */
 clicon_hash_t
-clicon_hash_lookup(clicon_hash_t *hash, 
+clicon_hash_lookup(clicon_hash_t *hash,
                    const char    *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
-
-    bkt = hash_bucket(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (!strcmp(h->h_key, key))
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+    struct hash_table *ht = (struct hash_table *)hash;
+    uint32_t           hv = hash_str(key);
+    size_t             mask = ht->ht_size - 1;
+    size_t             i = hv & mask;
+    uint32_t           dist = 1;
+    struct clicon_hash *slot;
+
+    for (;;){
+        slot = &ht->ht_slots[i];
+        if (slot->h_dist < dist) /* empty or richer: key cannot be further on */
+            return NULL;
+        if (slot->h_hash32 == hv && strcmp(slot->h_key, key) == 0)
+            return slot;
+        i = (i + 1) & mask;
+        dist++;
     }
-    return NULL;
 }
 
 /*! Get value of hash
@@ -225,10 +321,11 @@ clicon_hash_add(clicon_hash_t *hash,
                 void          *val, 
                 size_t         vlen)
 {
-    void         *newval = NULL;
-    clicon_hash_t h;
-    clicon_hash_t new = NULL;
-    
+    struct hash_table *ht = (struct hash_table *)hash;
+    void              *newval = NULL;
+    clicon_hash_t      h;
+    struct clicon_hash new = {0, };
+
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return NULL;
@@ -239,54 +336,95 @@ clicon_hash_add(clicon_hash_t *hash,
         clicon_err(OE_UNIX, EINVAL, "Mismatch in value and length, only one is zero");
         goto catch;
     }
-    /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL) {
-        if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
-            clicon_err(OE_UNIX, errno, "malloc");
-            goto catch;
-        }
-        memset(new, 0, sizeof(*new));
-        
-        new->h_key = strdup(key);
-        if (new->h_key == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
-            goto catch;
-        }
-        
-        h = new;
-    }
-    
     if (vlen){
-        /* Make copy of value. aligned */
-        newval = malloc(align4(vlen+3)); 
-        if (newval == NULL){
+        /* Make copy of value */
+        if ((newval = malloc(vlen)) == NULL){
             clicon_err(OE_UNIX, errno, "malloc");
             goto catch;
         }
         memcpy(newval, val, vlen);
     }
-    
-    /* Free old value if existing variable */
-    if (h->h_val)
-        free(h->h_val);
-    h->h_val = newval;
-    h->h_vlen =  vlen;
+    /* If variable exist, don't allocate a new. just replace value */
+    if ((h = clicon_hash_lookup(hash, key)) != NULL){
+        hash_val_free(h); /* may be a by-reference value, see clicon_hash_add_ref */
+        h->h_val = newval;
+        h->h_vlen = vlen;
+        h->h_free = NULL;
+        return h;
+    }
+    /* New variable: grow if needed, then robin-hood insert */
+    if ((ht->ht_used + 1) * 100 > ht->ht_size * HASH_MAX_LOAD_PERCENT &&
+        hash_resize(ht, ht->ht_size * 2) < 0)
+        goto catch;
+    if ((new.h_key = strdup(key)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto catch;
+    }
+    new.h_val = newval;
+    new.h_vlen = vlen;
+    new.h_hash32 = hash_str(key);
+    hash_insert_slot(ht, new);
+    return clicon_hash_lookup(hash, key);
 
-    /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_bucket(key)]);
+catch:
+    if (newval)
+        free(newval);
+    return NULL;
+}
 
-    return h;
+/*! Add hash entry by reference: store the pointer itself, no copy
+ *
+ * The table takes ownership of val: the destructor is called when the entry is
+ * replaced (by either add variant), deleted or the table is freed. Use for
+ * large objects (trees, buffers) where the copy-in/copy-out of clicon_hash_add
+ * is the cost, and to get the lifetime handled by the table instead of by the
+ * caller. clicon_hash_value returns the stored pointer with length 0.
+ * @param[in] hash    Hash table
+ * @param[in] key     Variable name
+ * @param[in] val     Object stored by reference. Ownership is taken: on error
+ *                    the caller still owns it
+ * @param[in] freefn  Destructor called on val when the entry is removed,
+ *                    NULL means the value is not freed (caller-owned)
+ * @retval    hash    Hash entry on success
+ * @retval    NULL    Error
+ * @see clicon_hash_add  which copies the value into the table
+ */
+clicon_hash_t
+clicon_hash_add_ref(clicon_hash_t        *hash,
+                    const char           *key,
+                    void                 *val,
+                    clicon_hash_freefn_t *freefn)
+{
+    struct hash_table *ht = (struct hash_table *)hash;
+    clicon_hash_t      h;
+    struct clicon_hash new = {0, };
 
-catch:
-    if (new) {
-        if (new->h_key)
-            free(new->h_key);
-        free(new);
+    if (hash == NULL){
+        clicon_err(OE_UNIX, EINVAL, "hash is NULL");
+        return NULL;
     }
-
-    return NULL;
+    /* If variable exist, don't allocate a new. just replace value */
+    if ((h = clicon_hash_lookup(hash, key)) != NULL){
+        if (h->h_val != val)
+            hash_val_free(h);
+        h->h_val = val;
+        h->h_vlen = 0;
+        h->h_free = freefn;
+        return h;
+    }
+    /* New variable: grow if needed, then robin-hood insert */
+    if ((ht->ht_used + 1) * 100 > ht->ht_size * HASH_MAX_LOAD_PERCENT &&
+        hash_resize(ht, ht->ht_size * 2) < 0)
+        return NULL;
+    if ((new.h_key = strdup(key)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return NULL;
+    }
+    new.h_val = val;
+    new.h_free = freefn;
+    new.h_hash32 = hash_str(key);
+    hash_insert_slot(ht, new);
+    return clicon_hash_lookup(hash, key);
 }
 
 /*! Delete hash entry.
@@ -301,22 +439,33 @@ int
 clicon_hash_del(clicon_hash_t *hash, 
                 const char    *key)
 {
-    clicon_hash_t h;
+    struct hash_table *ht = (struct hash_table *)hash;
+    clicon_hash_t      h;
+    size_t             mask;
+    size_t             i;
+    size_t             next;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
-    h = clicon_hash_lookup(hash, key);
-    if (h == NULL)
+    if ((h = clicon_hash_lookup(hash, key)) == NULL)
         return -1;
-    
-    DELQ(h, hash[hash_bucket(key)], clicon_hash_t);
-  
     free(h->h_key);
-    free(h->h_val);
-    free(h);
-
+    hash_val_free(h);
+    /* Backward-shift the rest of the probe cluster into the hole */
+    mask = ht->ht_size - 1;
+    i = h - ht->ht_slots;
+    for (;;){
+        next = (i + 1) & mask;
+        if (ht->ht_slots[next].h_dist <= 1) /* empty or in home slot */
+            break;
+        ht->ht_slots[i] = ht->ht_slots[next];
+        ht->ht_slots[i].h_dist--;
+        i = next;
+    }
+    memset(&ht->ht_slots[i], 0, sizeof(struct clicon_hash));
+    ht->ht_used--;
     return 0;
 }
 
@@ -334,32 +483,27 @@ clicon_hash_keys(clicon_hash_t *hash,
                  char        ***vector,
                  size_t        *nkeys)
 {
-    int           retval = -1;
-    int           bkt;
-    clicon_hash_t h;
-    char        **tmp;
-    char        **keys = NULL;
+    int                retval = -1;
+    struct hash_table *ht = (struct hash_table *)hash;
+    size_t             i;
+    char             **keys = NULL;
 
     if (hash == NULL){
         clicon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
     *nkeys = 0;
-    for (bkt = 0; bkt < HASH_SIZE; bkt++) {
-        h = hash[bkt];
-        do {
-            if (h == NULL)
-                break;
-            tmp = realloc(keys, ((*nkeys)+1) * sizeof(char *));
-            if (tmp == NULL){
-                clicon_err(OE_UNIX, errno, "realloc");
-                goto catch;
-            }
-            keys = tmp;
-            keys[*nkeys] = h->h_key;
+    if (ht->ht_used){
+        if ((keys = malloc(ht->ht_used * sizeof(char *))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto catch;
+        }
+        for (i = 0; i < ht->ht_size; i++){
+            if (ht->ht_slots[i].h_dist == 0)
+                continue;
+            keys[*nkeys] = ht->ht_slots[i].h_key;
             (*nkeys)++;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+        }
     }
     if (vector){
         *vector = keys;
@@ -77,6 +77,19 @@
 #include "clixon_json.h"
 #include "clixon_json_parse.h"
 
+/* Vector compares for the JSON string escape scan, see json_str_runlen.
+ * Selected at compile-time from the target instruction set: SSE2 is baseline
+ * on x86_64, NEON on aarch64 */
+#ifdef JSON_STRING_SIMD
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SIMD_SSE2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define JSON_SIMD_NEON
+#endif
+#endif /* JSON_STRING_SIMD */
+
 /* Let xml2json_cbuf_vec() return json array: [a,b].
    ALternative is to create a pseudo-object and return that: {top:{a,b}}
 */
@@ -240,7 +253,63 @@ array_eval(cxobj *xprev,
     return arraytype;
 }
 
+/*! Return the length of the prefix of str that needs no JSON string escaping
+ *
+ * Scans for the first occurrence of one of \" \\ and newline using 16-byte
+ * vector compares where the target instruction set has them (SSE2/NEON),
+ * falling back to a plain byte loop. Callers move the returned run with a
+ * single memcpy-width operation instead of inspecting one character at a time.
+ * @param[in]  str  Input string, need not be NUL-terminated
+ * @param[in]  len  Length of str
+ * @retval     n    Number of leading bytes of str needing no escape
+ * @see xml_chardata_runlen for the XML counterpart
+ */
+static size_t
+json_str_runlen(const char *str,
+                size_t      len)
+{
+    size_t i = 0;
+
+#if defined(JSON_SIMD_SSE2)
+    __m128i qu = _mm_set1_epi8('\"');
+    __m128i bs = _mm_set1_epi8('\\');
+    __m128i nl = _mm_set1_epi8('\n');
+
+    while (i + 16 <= len){
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, qu),
+                                              _mm_cmpeq_epi8(v, bs)),
+                                 _mm_cmpeq_epi8(v, nl));
+        int mask = _mm_movemask_epi8(m);
+
+        if (mask)
+            return i + __builtin_ctz(mask);
+        i += 16;
+    }
+#elif defined(JSON_SIMD_NEON)
+    uint8x16_t qu = vdupq_n_u8('\"');
+    uint8x16_t bs = vdupq_n_u8('\\');
+    uint8x16_t nl = vdupq_n_u8('\n');
+
+    while (i + 16 <= len){
+        uint8x16_t v = vld1q_u8((const uint8_t *)(str + i));
+        uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, qu),
+                                         vceqq_u8(v, bs)),
+                                vceqq_u8(v, nl));
+
+        if (vmaxvq_u8(m) != 0)
+            break; /* the byte loop below locates the exact position */
+        i += 16;
+    }
+#endif
+    for (; i < len; i++)
+        if (str[i] == '\"' || str[i] == '\\' || str[i] == '\n')
+            break;
+    return i;
+}
+
 /*! Escape a json string as well as decode xml cdata
+ * Unescaped runs are located with json_str_runlen and appended as one block
  * @param[out] cb   cbuf   (encoded)
  * @param[in]  str  string (unencoded)
  */
@@ -249,25 +318,34 @@ json_str_escape_cdata(cbuf *cb,
                       char *str)
 {
     int   retval = -1;
-    int   i;
+    size_t i;
     size_t len;
-    
+
     len = strlen(str);
-    for (i=0; i<len; i++)
+    for (i=0; i<len; i++){
+        size_t run = json_str_runlen(&str[i], len - i);
+
+        if (run){ /* Append run that needs no escaping as one block */
+            cbuf_append_buf(cb, &str[i], run);
+            i += run;
+            if (i >= len)
+                break;
+        }
         switch (str[i]){
         case '\n':
-            cprintf(cb, "\\n");
+            cbuf_append_str(cb, "\\n");
             break;
         case '\"':
-            cprintf(cb, "\\\"");
+            cbuf_append_str(cb, "\\\"");
             break;
         case '\\':
-            cprintf(cb, "\\\\");
+            cbuf_append_str(cb, "\\\\");
             break;
-        default: /* fall thru */
-            cprintf(cb, "%c", str[i]);
+        default: /* never reached: runlen stops only at the above */
+            cbuf_append(cb, str[i]);
             break;
         }
+    }
     retval = 0;
     // done:
     return retval;
@@ -347,7 +425,7 @@ json2xml_decode_identityref(cxobj     *x,
             else
                 cprintf(cbv, "%s", id);
 
-            if (xml_value_set(xb, cbuf_get(cbv)) < 0)
+            if (xml_value_cb_steal(xb, &cbv) < 0)
                 goto done;
         }
         else{
@@ -524,7 +602,7 @@ xml2json_encode_leafs(cxobj     *xb,
     }
     body = xb?xml_value(xb):NULL;
     if (yp == NULL){
-        cprintf(cb, "%s", body?body:"null"); 
+        cbuf_append_str(cb, body?body:"null");
         goto ok; /* unknown */
     }
     keyword = yang_keyword_get(yp);
@@ -546,11 +624,11 @@ xml2json_encode_leafs(cxobj     *xb,
                         goto done;
                 }
                 else{
-                    cprintf(cb, "%s", body);
+                    cbuf_append_str(cb, body);
                 }
             }
             else
-                cprintf(cb, "%s", body);
+                cbuf_append_str(cb, body);
             break;
         case CGV_INT64:
         case CGV_UINT64:
@@ -561,7 +639,7 @@ xml2json_encode_leafs(cxobj     *xb,
                         cprintf(cb, "[%s]", body);
                 }
                 else {
-                        cprintf(cb, "%s", body);
+                        cbuf_append_str(cb, body?body:"null");
                 }
                 quote = 1;
                 break;
@@ -572,7 +650,8 @@ xml2json_encode_leafs(cxobj     *xb,
         case CGV_UINT16:
         case CGV_UINT32:
         case CGV_BOOL:
-            cprintf(cb, "%s", body);
+            /* numeric/bool bodies are already canonical strings: append as-is */
+            cbuf_append_str(cb, body?body:"null");
             quote = 0;
             break;
         case CGV_VOID:
@@ -580,22 +659,22 @@ xml2json_encode_leafs(cxobj     *xb,
             if (body == NULL && strcmp(restype, "empty")==0){
                 quote = 0;
                 if (keyword == Y_LEAF)
-                    cprintf(cb, "[null]");
+                    cbuf_append_str(cb, "[null]");
                 else if (keyword == Y_LEAF_LIST && strcmp(restype, "empty") == 0)
-                    cprintf(cb, "[null]");
+                    cbuf_append_str(cb, "[null]");
                 else
-                    cprintf(cb, "null");
+                    cbuf_append_str(cb, "null");
             }
             break;
         default:
             if (body)
-                cprintf(cb, "%s", body);
+                cbuf_append_str(cb, body);
             else
-                cprintf(cb, "{}"); /* dont know */
+                cbuf_append_str(cb, "{}"); /* dont know */
         }
         break;
     default:
-        cprintf(cb, "%s", body);
+        cbuf_append_str(cb, body?body:"null");
         break;
     }
  ok:
@@ -603,13 +682,13 @@ xml2json_encode_leafs(cxobj     *xb,
      * includign quoting and encoding 
      */
     if (quote){
-        cprintf(cb0, "\"");
+        cbuf_append_str(cb0, "\"");
         json_str_escape_cdata(cb0, cbuf_get(cb));
     }
     else
-        cprintf(cb0, "%s", cbuf_get(cb));
+        cbuf_append_str(cb0, cbuf_get(cb));
     if (quote)
-        cprintf(cb0, "\"");
+        cbuf_append_str(cb0, "\"");
     retval = 0;
  done:
     if (cb)
@@ -635,14 +714,14 @@ nullchild(cbuf      *cb,
         /* This is very problematic.
          * RFC 7951 explicitly forbids "null" to be used unless for empty types in [null]
          */
-        cprintf(cb, "{}");
+        cbuf_append_str(cb, "{}");
     }
     else{
         switch (yang_keyword_get(y)){
         case Y_ANYXML:
         case Y_ANYDATA:
         case Y_CONTAINER:
-            cprintf(cb, "{}");
+            cbuf_append_str(cb, "{}");
             break;
         case Y_LEAF:
         case Y_LEAF_LIST:
@@ -653,7 +732,7 @@ nullchild(cbuf      *cb,
             /* This is very problematic.
              * RFC 7951 explicitly forbids "null" to be used unless for empty types in [null]
              */
-            cprintf(cb, "{}");
+            cbuf_append_str(cb, "{}");
             break;
         }
     }
@@ -827,22 +906,18 @@ xml2json1_cbuf(cbuf                   *cb,
     enum childtype   childt;
     enum array_element_type xc_arraytype;
     yang_stmt       *ys;
-    yang_stmt       *ymod = NULL; /* yang module */
     int              commas;
     char            *modname = NULL;
     cbuf            *metacbc = NULL;
 
     if ((ys = xml_spec(x)) != NULL){
-        if (ys_real_module(ys, &ymod) < 0)
-            goto done;
-        modname = yang_argument_get(ymod);
-        /* Special case for ietf-netconf -> ietf-restconf translation 
-         * A special case is for return data on the form {"data":...}
-         * See also json_xmlns_translate()
+        /* Module name (with the ietf-netconf -> ietf-restconf special case) is
+         * precomputed and cached on the yang node, same-module nodes share the
+         * pointer so the ancestor comparison is usually a pointer compare
          */
-        if (strcmp(modname, "ietf-netconf") == 0)
-            modname = "ietf-restconf";
-        if (modname0 && strcmp(modname, modname0) == 0)
+        if ((modname = yang_json_modname(ys)) == NULL)
+            goto done;
+        if (modname0 && (modname == modname0 || strcmp(modname, modname0) == 0))
             modname=NULL;
         else
             modname0 = modname; /* modname0 is ancestor ns passed to child */
@@ -860,10 +935,15 @@ xml2json1_cbuf(cbuf                   *cb,
         break;
     case NO_ARRAY:
         if (!flat){
-            cprintf(cb, "%*s\"", pretty?(level*PRETTYPRINT_INDENT):0, "");
-            if (modname) 
-                cprintf(cb, "%s:", modname);
-            cprintf(cb, "%s\":%s", xml_name(x), pretty?" ":"");
+            if (pretty)
+                clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+            cbuf_append_str(cb, "\"");
+            if (modname){
+                cbuf_append_str(cb, modname);
+                cbuf_append_str(cb, ":");
+            }
+            cbuf_append_str(cb, xml_name(x));
+            cbuf_append_str(cb, pretty?"\": ":"\":");
         }
         switch (childt){
         case NULL_CHILD:
@@ -873,7 +953,7 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "{%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?"{\n":"{");
             break;
         default:
             break;
@@ -881,14 +961,21 @@ xml2json1_cbuf(cbuf                   *cb,
         break;
     case FIRST_ARRAY:
     case SINGLE_ARRAY:
-        cprintf(cb, "%*s\"", pretty?(level*PRETTYPRINT_INDENT):0, "");
-        if (modname)
-            cprintf(cb, "%s:", modname);
-        cprintf(cb, "%s\":%s", xml_name(x), pretty?" ":"");
+        if (pretty)
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        cbuf_append_str(cb, "\"");
+        if (modname){
+            cbuf_append_str(cb, modname);
+            cbuf_append_str(cb, ":");
+        }
+        cbuf_append_str(cb, xml_name(x));
+        cbuf_append_str(cb, pretty?"\": ":"\":");
         level++;
-        cprintf(cb, "[%s%*s", 
-                pretty?"\n":"",
-                pretty?(level*PRETTYPRINT_INDENT):0, "");
+        cbuf_append_str(cb, "[");
+        if (pretty){
+            cbuf_append_str(cb, "\n");
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        }
         switch (childt){
         case NULL_CHILD:
             if (nullchild(cb, x, ys) < 0)
@@ -897,7 +984,7 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "{%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?"{\n":"{");
             break;
         default:
             break;
@@ -906,8 +993,8 @@ xml2json1_cbuf(cbuf                   *cb,
     case MIDDLE_ARRAY:
     case LAST_ARRAY:
         level++;
-        cprintf(cb, "%*s", 
-                pretty?(level*PRETTYPRINT_INDENT):0, "");
+        if (pretty)
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
         switch (childt){
         case NULL_CHILD:
             if (nullchild(cb, x, ys) < 0)
@@ -916,7 +1003,7 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "{%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?"{\n":"{");
             break;
         default:
             break;
@@ -952,12 +1039,12 @@ xml2json1_cbuf(cbuf                   *cb,
                            metacbc) < 0)
             goto done;
         if (commas > 0) {
-            cprintf(cb, ",%s", pretty?"\n":"");
+            cbuf_append_str(cb, pretty?",\n":",");
             --commas;
         }
     }
     if (cbuf_len(metacbc)){
-        cprintf(cb, "%s", cbuf_get(metacbc));
+        cbuf_append_buf(cb, cbuf_get(metacbc), cbuf_len(metacbc));
     }
 
     switch (arraytype){
@@ -969,9 +1056,11 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "%s%*s}", 
-                    pretty?"\n":"",
-                    pretty?(level*PRETTYPRINT_INDENT):0, "");
+            if (pretty){
+                cbuf_append_str(cb, "\n");
+                clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+            }
+            cbuf_append_str(cb, "}");
             break;
         default:
             break;
@@ -985,9 +1074,11 @@ xml2json1_cbuf(cbuf                   *cb,
         case BODY_CHILD:
             break;
         case ANY_CHILD:
-            cprintf(cb, "%s%*s}", 
-                    pretty?"\n":"",
-                    pretty?(level*PRETTYPRINT_INDENT):0, "");
+            if (pretty){
+                cbuf_append_str(cb, "\n");
+                clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+            }
+            cbuf_append_str(cb, "}");
             level--;
             break;
         default:
@@ -999,20 +1090,25 @@ xml2json1_cbuf(cbuf                   *cb,
         switch (childt){
         case NULL_CHILD:
         case BODY_CHILD:
-            cprintf(cb, "%s",pretty?"\n":"");
+            if (pretty)
+                cbuf_append_str(cb, "\n");
             break;
         case ANY_CHILD:
-            cprintf(cb, "%s%*s}", 
-                    pretty?"\n":"",
-                    pretty?(level*PRETTYPRINT_INDENT):0, "");
-            cprintf(cb, "%s",pretty?"\n":"");
+            if (pretty){
+                cbuf_append_str(cb, "\n");
+                clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+            }
+            cbuf_append_str(cb, "}");
+            if (pretty)
+                cbuf_append_str(cb, "\n");
             level--;
             break;
         default:
             break;
         }
-        cprintf(cb, "%*s]",
-                pretty?(level*PRETTYPRINT_INDENT):0,"");
+        if (pretty)
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        cbuf_append_str(cb, "]");
         break;
     default:
         break;
@@ -1058,10 +1154,10 @@ xml2json_cbuf1(cbuf   *cb,
         if (exist)
             goto ok;
     }
-    cprintf(cb, "%*s{%s", 
-            pretty?level*PRETTYPRINT_INDENT:0,"", 
-            pretty?"\n":"");
-    
+    if (pretty)
+        clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+    cbuf_append_str(cb, pretty?"{\n":"{");
+
     if (y != NULL){
         switch (yang_keyword_get(y)){
         case Y_LEAF_LIST:
@@ -1082,10 +1178,13 @@ xml2json_cbuf1(cbuf   *cb,
                        NULL, /* ancestor modname / namespace */
                        NULL) < 0)
         goto done;
-    cprintf(cb, "%s%*s}%s", 
-            pretty?"\n":"",
-            pretty?level*PRETTYPRINT_INDENT:0,"",
-            pretty?"\n":"");
+    if (pretty){
+        cbuf_append_str(cb, "\n");
+        clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        cbuf_append_str(cb, "}\n");
+    }
+    else
+        cbuf_append_str(cb, "}");
  ok:
     retval = 0;
  done:
@@ -1127,7 +1226,7 @@ clixon_json2cbuf(cbuf  *cb,
         xc = NULL;
         while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL){
             if (i++)
-                cprintf(cb, ",");
+                cbuf_append_str(cb, ",");
             if (xml2json_cbuf1(cb, xc, pretty, autocliext) < 0)
                 goto done;
         }
@@ -1330,8 +1429,9 @@ xml2json_vec(FILE      *f,
  * @note the opposite - xml2ns is made inline in xml2json1_cbuf
  * Example: <top><module:input> --> <top><input xmlns="">
  * @see RFC7951 Sec 4
+ * @note also used by the CBOR decoder, RFC 9254 uses the same name encoding
  */
-static int
+int
 json_xmlns_translate(yang_stmt *yspec,
                      cxobj     *x,
                      cxobj    **xerr)
@@ -1517,6 +1617,334 @@ _json_parse(char      *str,
     goto done;
 }
 
+/*! Streaming JSON parse handle, fed with chunks as they arrive
+ * The scanner tracks object/array nesting outside strings. When a top-level
+ * member of the outer JSON object completes, it is parsed and yang-bound via
+ * _json_parse into the target tree, so parse and bind overlap with receive
+ * instead of waiting for the complete body. A body whose top-level value is
+ * not an object is accumulated and parsed at final.
+ * @see clixon_json_stream_new
+ */
+struct clixon_json_stream{
+    int        js_rfc7951; /* Sanity checks according to RFC 7951 */
+    yang_bind  js_yb;      /* How to bind yang to XML */
+    yang_stmt *js_yspec;   /* Yang specification */
+    cxobj     *js_xt;      /* Target XML tree, owned by caller */
+    char      *js_buf;     /* Unconsumed input bytes */
+    size_t     js_buflen;  /* Allocated size of js_buf */
+    size_t     js_len;     /* Used bytes of js_buf */
+    size_t     js_pos;     /* Scan position in js_buf */
+    size_t     js_mstart;  /* Offset of current top-level member in js_buf */
+    int        js_depth;   /* Object/array nesting depth outside strings */
+    int        js_instr;   /* Inside a JSON string */
+    int        js_esc;     /* Previous in-string character was backslash */
+    int        js_outer;   /* Outer object { seen */
+    int        js_closed;  /* Outer object } seen */
+    int        js_bypass;  /* Top-level value not an object: parse at final */
+};
+
+/*! Grow the stream buffer to hold at least sz bytes
+ * @param[in]  js   JSON stream parse handle
+ * @param[in]  sz   Needed size in bytes
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+json_stream_ensure(clixon_json_stream *js,
+                   size_t              sz)
+{
+    size_t newlen;
+    char  *newbuf;
+
+    if (sz <= js->js_buflen)
+        return 0;
+    newlen = js->js_buflen ? js->js_buflen : BUFLEN;
+    while (newlen < sz)
+        newlen *= 2;
+    if ((newbuf = realloc(js->js_buf, newlen)) == NULL){
+        clicon_err(OE_JSON, errno, "realloc");
+        return -1;
+    }
+    js->js_buf = newbuf;
+    js->js_buflen = newlen;
+    return 0;
+}
+
+/*! Parse one completed top-level member of the streamed outer object
+ * The member text is wrapped in braces and run through _json_parse so the
+ * per-member RFC 7951 checks, yang binding and identityref decoding are the
+ * same as for a whole-body parse.
+ * @param[in]  js    JSON stream parse handle
+ * @param[in]  start Offset of member in js_buf
+ * @param[in]  end   Offset one past member in js_buf
+ * @param[out] xerr  Reason for invalid returned as netconf err msg
+ * @retval     1     OK and valid
+ * @retval     0     Invalid (only if yang spec) w xerr set
+ * @retval    -1     Error
+ */
+static int
+json_stream_member(clixon_json_stream *js,
+                   size_t              start,
+                   size_t              end,
+                   cxobj             **xerr)
+{
+    int    retval = -1;
+    int    ret;
+    size_t i;
+    cbuf  *cb = NULL;
+
+    for (i = start; i < end; i++)
+        if (!isspace(js->js_buf[i]))
+            break;
+    if (i == end) /* whitespace only, eg empty object */
+        goto ok;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_JSON, errno, "cbuf_new");
+        goto done;
+    }
+    cbuf_append_str(cb, "{");
+    cbuf_append_buf(cb, &js->js_buf[start], end - start);
+    cbuf_append_str(cb, "}");
+    if ((ret = _json_parse(cbuf_get(cb), js->js_rfc7951, js->js_yb, js->js_yspec,
+                           js->js_xt, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Create a streaming JSON parse handle
+ * Intended for chunked body receive, eg a restconf connection, where parse
+ * and yang bind of completed top-level members overlap with network receive.
+ * @param[in]  rfc7951 Do sanity checks according to RFC 7951
+ * @param[in]  yb      How to bind yang to XML top-level when parsing
+ * @param[in]  yspec   Yang specification, mandatory for module->xmlns translation
+ * @param[in]  xt      Top of target XML tree, created and freed by caller
+ * @retval     js      JSON stream parse handle
+ * @retval     NULL    Error
+ * @code
+ *  clixon_json_stream *js;
+ *  if ((js = clixon_json_stream_new(1, YB_MODULE, yspec, xt)) == NULL)
+ *    err;
+ *  while (<data arrives>)
+ *    if (clixon_json_stream_input(js, data, len, &xerr) < 0)
+ *      err;
+ *  if (clixon_json_stream_final(js, &xerr) < 0)
+ *    err;
+ *  clixon_json_stream_free(js);
+ * @endcode
+ * @see clixon_json_parse_string  for a one-shot parse
+ */
+clixon_json_stream *
+clixon_json_stream_new(int        rfc7951,
+                       yang_bind  yb,
+                       yang_stmt *yspec,
+                       cxobj     *xt)
+{
+    clixon_json_stream *js = NULL;
+
+    if (xt == NULL){
+        clicon_err(OE_JSON, EINVAL, "xt is NULL");
+        return NULL;
+    }
+    if ((js = malloc(sizeof(*js))) == NULL){
+        clicon_err(OE_JSON, errno, "malloc");
+        return NULL;
+    }
+    memset(js, 0, sizeof(*js));
+    js->js_rfc7951 = rfc7951;
+    js->js_yb = yb;
+    js->js_yspec = yspec;
+    js->js_xt = xt;
+    return js;
+}
+
+/*! Feed a chunk of JSON text to a streaming parse handle
+ * Completed top-level members are parsed and bound immediately; their bytes
+ * are dropped from the buffer so memory tracks the largest member, not the
+ * whole body.
+ * @param[in]  js    JSON stream parse handle
+ * @param[in]  data  Chunk of JSON text, need not align with any JSON token
+ * @param[in]  len   Length of data
+ * @param[out] xerr  Reason for invalid returned as netconf err msg
+ * @retval     1     OK and valid (so far)
+ * @retval     0     Invalid (only if yang spec) w xerr set
+ * @retval    -1     Error
+ */
+int
+clixon_json_stream_input(clixon_json_stream *js,
+                         const char         *data,
+                         size_t              len,
+                         cxobj             **xerr)
+{
+    int  retval = -1;
+    int  ret;
+    char c;
+
+    if (json_stream_ensure(js, js->js_len + len) < 0)
+        goto done;
+    memcpy(&js->js_buf[js->js_len], data, len);
+    js->js_len += len;
+    for (; js->js_pos < js->js_len; js->js_pos++){
+        c = js->js_buf[js->js_pos];
+        if (js->js_bypass || js->js_closed)
+            continue; /* accumulate only: handled at final */
+        if (js->js_instr){
+            if (js->js_esc)
+                js->js_esc = 0;
+            else if (c == '\\')
+                js->js_esc = 1;
+            else if (c == '\"')
+                js->js_instr = 0;
+            continue;
+        }
+        if (!js->js_outer){
+            if (isspace(c))
+                continue;
+            if (c == '{'){
+                js->js_outer = 1;
+                js->js_depth = 1;
+                js->js_mstart = js->js_pos + 1;
+            }
+            else
+                js->js_bypass = 1;
+            continue;
+        }
+        switch (c){
+        case '\"':
+            js->js_instr = 1;
+            break;
+        case '{':
+        case '[':
+            js->js_depth++;
+            break;
+        case ']':
+            js->js_depth--;
+            break;
+        case '}':
+            if (--js->js_depth == 0){
+                if ((ret = json_stream_member(js, js->js_mstart, js->js_pos, xerr)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+                js->js_closed = 1;
+                js->js_mstart = js->js_pos + 1;
+            }
+            break;
+        case ',':
+            if (js->js_depth == 1){
+                if ((ret = json_stream_member(js, js->js_mstart, js->js_pos, xerr)) < 0)
+                    goto done;
+                if (ret == 0)
+                    goto fail;
+                js->js_mstart = js->js_pos + 1;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    /* Drop consumed bytes */
+    if (js->js_mstart > 0){
+        memmove(js->js_buf, &js->js_buf[js->js_mstart], js->js_len - js->js_mstart);
+        js->js_len -= js->js_mstart;
+        js->js_pos -= js->js_mstart;
+        js->js_mstart = 0;
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! End of input to a streaming JSON parse handle
+ * Parses any remaining input: the whole body if the top-level value was not
+ * an object, otherwise the remainder is checked (a truncated object is
+ * reparsed so the regular parser reports the error).
+ * @param[in]  js    JSON stream parse handle
+ * @param[out] xerr  Reason for invalid returned as netconf err msg
+ * @retval     1     OK and valid
+ * @retval     0     Invalid (only if yang spec) w xerr set
+ * @retval    -1     Error
+ */
+int
+clixon_json_stream_final(clixon_json_stream *js,
+                         cxobj             **xerr)
+{
+    int    retval = -1;
+    int    ret;
+    size_t i;
+    cbuf  *cb = NULL;
+
+    if (js->js_bypass){
+        if (json_stream_ensure(js, js->js_len + 1) < 0)
+            goto done;
+        js->js_buf[js->js_len] = '\0';
+        if ((ret = _json_parse(js->js_buf, js->js_rfc7951, js->js_yb, js->js_yspec,
+                               js->js_xt, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    else if (!js->js_outer)
+        ; /* empty or all-whitespace body */
+    else if (!js->js_closed){
+        /* Truncated outer object: reparse remainder for a regular parse error */
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_JSON, errno, "cbuf_new");
+            goto done;
+        }
+        cbuf_append_str(cb, "{");
+        cbuf_append_buf(cb, js->js_buf, js->js_len);
+        if ((ret = _json_parse(cbuf_get(cb), js->js_rfc7951, js->js_yb, js->js_yspec,
+                               js->js_xt, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    else{
+        for (i = 0; i < js->js_len; i++)
+            if (!isspace(js->js_buf[i])){
+                clicon_err(OE_JSON, 0, "Trailing characters after top-level JSON object");
+                goto done;
+            }
+    }
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Free a streaming JSON parse handle
+ * The target XML tree given to clixon_json_stream_new is not freed.
+ * @param[in]  js    JSON stream parse handle
+ * @retval     0     OK
+ */
+int
+clixon_json_stream_free(clixon_json_stream *js)
+{
+    if (js == NULL)
+        return 0;
+    if (js->js_buf)
+        free(js->js_buf);
+    free(js);
+    return 0;
+}
+
 /*! Parse string containing JSON and return an XML tree
  *
  * @param[in]     str   String containing JSON
@@ -1593,6 +2021,7 @@ clixon_json_parse_string(char      *str,
  * @retval       -1     Error with clicon_err called
  *
  * @see clixon_json_parse_string
+ * @see clixon_json_stream_new  for the underlying chunked parse
  * @see RFC7951
  */
 int
@@ -1603,64 +2032,44 @@ clixon_json_parse_file(FILE      *fp,
                        cxobj    **xt,
                        cxobj    **xerr)
 {
-    int       retval = -1;
-    int       ret;
-    char     *jsonbuf = NULL;
-    int       jsonbuflen = BUFLEN; /* start size */
-    int       oldjsonbuflen;
-    char     *ptr;
-    char      ch;
-    int       len = 0;
+    int                 retval = -1;
+    int                 ret;
+    clixon_json_stream *js = NULL;
+    char                buf[BUFLEN];
+    size_t              len;
 
     if (xt==NULL){
         clicon_err(OE_JSON, EINVAL, "xt is NULL");
         return -1;
     }
-    if ((jsonbuf = malloc(jsonbuflen)) == NULL){
-        clicon_err(OE_JSON, errno, "malloc");
+    if (*xt == NULL)
+        if ((*xt = xml_new(JSON_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    if ((js = clixon_json_stream_new(rfc7951, yb, yspec, *xt)) == NULL)
         goto done;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0){
+        if ((ret = clixon_json_stream_input(js, buf, len, xerr)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
     }
-    memset(jsonbuf, 0, jsonbuflen);
-    ptr = jsonbuf;
-    while (1){
-        if ((ret = fread(&ch, 1, 1, fp)) < 0){
-            clicon_err(OE_JSON, errno, "read");
-            break;
-        }
-        if (ret != 0)
-            jsonbuf[len++] = ch;
-        if (ret == 0){
-            if (*xt == NULL)
-                if ((*xt = xml_new(JSON_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-                    goto done;
-            if (len){
-                if ((ret = _json_parse(ptr, rfc7951, yb, yspec, *xt, xerr)) < 0)
-                    goto done;
-                if (ret == 0)
-                    goto fail;
-            }
-            break;
-        }
-        if (len >= jsonbuflen-1){ /* Space: one for the null character */
-            oldjsonbuflen = jsonbuflen;
-            jsonbuflen *= 2;
-            if ((jsonbuf = realloc(jsonbuf, jsonbuflen)) == NULL){
-                clicon_err(OE_JSON, errno, "realloc");
-                goto done;
-            }
-            memset(jsonbuf+oldjsonbuflen, 0, jsonbuflen-oldjsonbuflen);
-            ptr = jsonbuf;
-        }
+    if (ferror(fp)){
+        clicon_err(OE_JSON, errno, "read");
+        goto done;
     }
+    if ((ret = clixon_json_stream_final(js, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
     retval = 1;
  done:
+    if (js)
+        clixon_json_stream_free(js);
     if (retval < 0 && *xt){
-        free(*xt);
+        xml_free(*xt);
         *xt = NULL;
     }
-    if (jsonbuf)
-        free(jsonbuf);
-    return retval;    
+    return retval;
  fail:
     retval = 0;
     goto done;
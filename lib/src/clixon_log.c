@@ -44,6 +44,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <inttypes.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <syslog.h>
@@ -58,6 +59,10 @@
 
 /* clicon */
 #include "clixon_err.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_event.h"
 #include "clixon_log.h"
 
 /* The global debug level. 0 means no debug 
@@ -76,6 +81,28 @@ static FILE *_logfile = NULL;
 /* Truncate debug strings to this length. 0 means unlimited */
 static int _clixon_log_trunc = 0;
 
+/* Slow-operation log threshold in ms, 0: disabled, see clixon_log_slow_set() */
+static uint32_t _clixon_log_slow_ms = 0;
+
+/* Asynchronous log ring, see clicon_log_async_init()
+ * When enabled, formatted records are queued here and written to the actual
+ * destinations (syslog/stderr/file) by a periodic event-loop flush, instead of
+ * synchronously in the caller. Single producer, single consumer in the same
+ * thread, so plain indices suffice.
+ */
+struct log_rec {
+    int   lr_level;  /* syslog level */
+    char *lr_msg;    /* malloced formatted message */
+};
+static struct log_rec *_log_ring = NULL;       /* NULL means sync logging */
+static unsigned int    _log_ring_size = 0;     /* nr of slots */
+static unsigned int    _log_ring_head = 0;     /* next slot to write */
+static unsigned int    _log_ring_len = 0;      /* nr of queued records */
+static uint64_t        _log_ring_drops = 0;    /* records dropped since last flush */
+
+/* How often the event-loop callback drains the async log ring (ms) */
+#define LOG_ASYNC_FLUSH_MS 100
+
 /*! Initialize system logger.
  *
  * Make syslog(3) calls with specified ident and gates calls of level upto specified level (upto).
@@ -109,6 +136,7 @@ clicon_log_init(char         *ident,
 int
 clicon_log_exit(void)
 {
+    clicon_log_async_init(0); /* flush and free the async ring, if any */
     if (_logfile)
         fclose(_logfile);
     closelog(); /* optional */
@@ -188,6 +216,42 @@ clicon_log_string_limit_get(void)
     return _clixon_log_trunc;
 }
 
+/*! Set slow-operation log threshold
+ *
+ * Operations (RPCs, xpath evaluations, datastore accesses) taking longer than
+ * the threshold log a diagnostic line at LOG_WARNING. A global, not a handle
+ * option, since xpath evaluation has no handle, same pattern as
+ * xpath_list_optimize_set(). Set from option CLICON_LOG_SLOW_MS at init.
+ * @param[in] ms  Threshold in milliseconds, 0 disables
+ * @retval    0   OK
+ */
+int
+clixon_log_slow_set(uint32_t ms)
+{
+    _clixon_log_slow_ms = ms;
+    return 0;
+}
+
+/*! Get slow-operation log threshold in milliseconds, 0 means disabled
+ * Callers time an operation only when non-zero, see clixon_log_slow_ns()
+ */
+uint32_t
+clixon_log_slow_get(void)
+{
+    return _clixon_log_slow_ms;
+}
+
+/*! Monotonic timestamp in nanoseconds, for slow-operation timing
+ */
+uint64_t
+clixon_log_slow_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
 /*! Mimic syslog and print a time on file f
  */
 static int
@@ -230,7 +294,7 @@ slogtime(void)
 }
 #endif
 
-/*! Make a logging call to syslog (or stderr).
+/*! Write a log message to the actual destinations: syslog/stderr/stdout/file
  *
  * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. Thisis OR:d with facility == LOG_USER
  * @param[in]   msg   Message to print as argv.
@@ -238,9 +302,9 @@ slogtime(void)
  * @note syslog makes its own filtering, but if log to stderr we do it here
  * @see  clicon_debug
  */
-int
-clicon_log_str(int           level, 
-               char         *msg)
+static int
+clicon_log_str1(int           level,
+                char         *msg)
 {
     if (_logflags & CLICON_LOG_SYSLOG)
         syslog(LOG_MAKEPRI(LOG_USER, level), "%s", msg);
@@ -262,13 +326,136 @@ clicon_log_str(int           level,
         fprintf(_logfile, "%s\n", msg);
         fflush(_logfile);
     }
-    /* Enable this if you want syslog in a stream. But there are problems with 
+    /* Enable this if you want syslog in a stream. But there are problems with
      * recursion
      */
  done:
     return 0;
 }
 
+/*! Make a logging call to syslog (or stderr), possibly deferred via async ring
+ *
+ * If async logging is enabled (see clicon_log_async_init) the formatted record
+ * is queued and written later by the event loop, otherwise it is written
+ * synchronously. When the ring is full the record is dropped and counted, so
+ * logging under overload never blocks or grows unboundedly.
+ * @param[in]   level log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. This is OR:d with facility == LOG_USER
+ * @param[in]   msg   Formatted message
+ * @retval      0     OK
+ * @see  clicon_log_str1  The actual write
+ */
+int
+clicon_log_str(int           level,
+               char         *msg)
+{
+    struct log_rec *lr;
+
+    if (_log_ring == NULL)
+        return clicon_log_str1(level, msg);
+    if (_log_ring_len == _log_ring_size){
+        _log_ring_drops++;
+        return 0;
+    }
+    lr = &_log_ring[_log_ring_head];
+    if ((lr->lr_msg = strdup(msg)) == NULL){
+        _log_ring_drops++;
+        return 0;
+    }
+    lr->lr_level = level;
+    _log_ring_head = (_log_ring_head + 1) % _log_ring_size;
+    _log_ring_len++;
+    return 0;
+}
+
+/*! Drain the async log ring, writing all queued records to their destinations
+ *
+ * If records were dropped since the last flush, a summary line is appended.
+ * @retval      0     OK
+ * @see clicon_log_async_init
+ */
+int
+clicon_log_async_flush(void)
+{
+    struct log_rec *lr;
+    unsigned int    tail;
+    char            dropmsg[64];
+
+    if (_log_ring == NULL)
+        return 0;
+    while (_log_ring_len > 0){
+        tail = (_log_ring_head + _log_ring_size - _log_ring_len) % _log_ring_size;
+        lr = &_log_ring[tail];
+        _log_ring_len--;
+        clicon_log_str1(lr->lr_level, lr->lr_msg);
+        free(lr->lr_msg);
+        lr->lr_msg = NULL;
+    }
+    if (_log_ring_drops > 0){
+        snprintf(dropmsg, sizeof(dropmsg), "async log overload: %" PRIu64 " messages dropped",
+                 _log_ring_drops);
+        _log_ring_drops = 0;
+        clicon_log_str1(LOG_WARNING, dropmsg);
+    }
+    return 0;
+}
+
+/*! Event-loop callback: flush the async log ring and re-arm
+ *
+ * @param[in]  fd   Ignored (timeout callback)
+ * @param[in]  arg  Ignored
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+log_async_timeout(int   fd,
+                  void *arg)
+{
+    struct timeval t;
+    struct timeval t1 = {0, LOG_ASYNC_FLUSH_MS*1000};
+
+    clicon_log_async_flush();
+    if (_log_ring == NULL) /* disabled in the meantime */
+        return 0;
+    gettimeofday(&t, NULL);
+    timeradd(&t, &t1, &t);
+    return clixon_event_reg_timeout(t, log_async_timeout, NULL, "async log flush");
+}
+
+/*! Enable or disable asynchronous logging
+ *
+ * When enabled, clicon_log()/clicon_debug() callers only format and queue the
+ * message; the actual syslog/stderr/file writes are made by a periodic
+ * event-loop callback. This keeps detailed debug logging out of the RPC
+ * latency path. Requires a running event loop (see clixon_event_loop), records
+ * queued before the loop starts are flushed on the first tick.
+ * @param[in]  size  Nr of records the ring holds. Further records are dropped
+ *                   (and counted) until the next flush. 0 disables async mode
+ *                   and flushes any queued records.
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see CLICON_LOG_BUFFER config option
+ */
+int
+clicon_log_async_init(size_t size)
+{
+    clicon_log_async_flush();
+    if (_log_ring != NULL){
+        clixon_event_unreg_timeout(log_async_timeout, NULL);
+        free(_log_ring);
+        _log_ring = NULL;
+        _log_ring_size = 0;
+        _log_ring_head = 0;
+    }
+    if (size == 0)
+        return 0;
+    if ((_log_ring = calloc(size, sizeof(struct log_rec))) == NULL){
+        fprintf(stderr, "calloc: %s\n", strerror(errno)); /* dont use clicon_err here due to recursion */
+        return -1;
+    }
+    _log_ring_size = size;
+    return log_async_timeout(0, NULL); /* flush + arm the periodic flush */
+}
+
 /*! Make a logging call to syslog using variable arg syntax.
  *
  * @param[in]   level    log level, eg LOG_DEBUG,LOG_INFO,...,LOG_EMERG. This 
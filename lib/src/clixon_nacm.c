@@ -311,11 +311,18 @@ nacm_rpc(char         *rpc,
     goto done;
 }
 
-/* Local struct for keeping preparation/compiled data in NACM data path code */
+/* Local struct for keeping preparation/compiled data in NACM data path code
+ * Rule leafs consulted per requested node are compiled into direct fields so the
+ * per-node check does not re-parse the rule XML, see nacm_data_node_match
+ */
 struct prepvec{
     qelem_t       pv_q;
     cxobj        *pv_xrule;
     clixon_xvec  *pv_xpathvec;
+    int           pv_nr;      /* Rule order number, first matching rule wins */
+    char         *pv_module;  /* Rule module-name leaf, "*" is wildcard (not malloced) */
+    char         *pv_action;  /* Rule action leaf: "deny"/"permit" (not malloced) */
+    int           pv_haspath; /* Rule has a path, matches only nodes under pv_xpathvec */
 };
 typedef struct prepvec prepvec;
 
@@ -346,13 +353,115 @@ prepvec_add(prepvec  **pv_listp,
         return NULL;
     }
     memset(pv, 0, sizeof(*pv));
+    if (*pv_listp != NULL)
+        pv->pv_nr = PREVQ(prepvec *, *pv_listp)->pv_nr + 1;
     ADDQ(pv, *pv_listp);
     pv->pv_xrule = xrule;
+    pv->pv_module = xml_find_body(xrule, "module-name");
+    pv->pv_action = xml_find_body(xrule, "action");
+    pv->pv_haspath = (xml_find_type(xrule, NULL, "path", CX_ELMNT) != NULL);
     if ((pv->pv_xpathvec = clixon_xvec_new()) == NULL)
         return NULL;
     return pv;
 }
 
+/*! Find first prepared rule matching a requested node, with per-module decision table
+ *
+ * Path rules are instance-specific and checked against their precomputed instance-id
+ * hits in rule order. The module-name criterion however depends only on the YANG
+ * module of the node, so for the common case that no path rule covers the node the
+ * first matching module-only rule is memoized in dtab keyed by the module, turning
+ * the per-node rule scan into a hash lookup.
+ * @param[in]  xn      XML node (requested node)
+ * @param[in]  pv_list Prepared rules, see nacm_datanode_prepare
+ * @param[in]  yspec   YANG spec
+ * @param[in]  dtab    Decision table keyed by module, same lifetime as pv_list
+ * @param[out] pvp     First matching rule, NULL if no rule matches
+ * @retval  0  OK
+ * @retval -1  Error
+ */
+static int
+nacm_data_node_match(cxobj         *xn,
+                     prepvec       *pv_list,
+                     yang_stmt     *yspec,
+                     clicon_hash_t *dtab,
+                     prepvec      **pvp)
+{
+    int        retval = -1;
+    prepvec   *pv;
+    prepvec   *pvpath = NULL; /* first matching path rule */
+    prepvec   *pvmod = NULL;  /* first matching module-only rule */
+    yang_stmt *ys;
+    yang_stmt *ymod = NULL;
+    char      *modname = NULL;
+    char       key[32] = {0,};
+    prepvec  **pvcache;
+    cxobj     *xp;
+    int        i;
+
+    *pvp = NULL;
+    if (pv_list == NULL)
+        goto ok;
+    if ((ys = xml_spec(xn)) != NULL)
+        ymod = ys_module(ys);
+    else if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+        goto done;
+    if (ymod){
+        modname = yang_argument_get(ymod);
+        snprintf(key, sizeof(key), "%p", ymod);
+    }
+    /* Path rules must be checked per node, find the first one covering xn */
+    pv = pv_list;
+    do {
+        if (pv->pv_haspath &&
+            pv->pv_module != NULL &&
+            (strcmp(pv->pv_module, "*") == 0 ||
+             modname == NULL || /* eg top-of-tree, treat as any module */
+             strcmp(pv->pv_module, modname) == 0)){
+            for (i=0; i<clixon_xvec_len(pv->pv_xpathvec); i++){
+                xp = clixon_xvec_i(pv->pv_xpathvec, i);
+                if (xn == xp || xml_isancestor(xn, xp))
+                    break;
+            }
+            if (i < clixon_xvec_len(pv->pv_xpathvec)){
+                pvpath = pv;
+                break;
+            }
+        }
+        pv = NEXTQ(prepvec *, pv);
+    } while (pv && pv != pv_list);
+    /* Module-only rules depend only on the module: consult the decision table */
+    if (key[0] &&
+        (pvcache = (prepvec**)clicon_hash_value(dtab, key, NULL)) != NULL)
+        pvmod = *pvcache;
+    else{
+        pv = pv_list;
+        do {
+            if (!pv->pv_haspath &&
+                pv->pv_module != NULL &&
+                (strcmp(pv->pv_module, "*") == 0 ||
+                 modname == NULL ||
+                 strcmp(pv->pv_module, modname) == 0)){
+                pvmod = pv;
+                break;
+            }
+            pv = NEXTQ(prepvec *, pv);
+        } while (pv && pv != pv_list);
+        if (key[0] &&
+            clicon_hash_add(dtab, key, &pvmod, sizeof(pvmod)) == NULL)
+            goto done;
+    }
+    /* First rule in configuration order wins */
+    if (pvpath && (pvmod == NULL || pvpath->pv_nr < pvmod->pv_nr))
+        *pvp = pvpath;
+    else
+        *pvp = pvmod;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Prepare datastructures before running through XML tree
  * Save rules in a "cache"
  * These rules match:
@@ -516,135 +625,268 @@ nacm_datanode_prepare(clicon_handle     h,
  * Datanode write
  */
 
-/*! Match specific rule to specific requested node
- * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  xp       Xpath match
- * @param[in]  yspec    YANG spec
- * @retval -1  Error
- * @retval  0  OK and rule does not match
- * @retval  1  OK and rule matches deny
- * @retval  2  OK and rule matches permit
+/* Write-authorization batch, see nacm_datanode_write
+ * The per-call preparation (user group lookup, rule-list scan, rule compilation)
+ * depends only on (request tree, NACM config, user, operation), all of which are
+ * constant across the per-node authorization calls of one datastore edit. One
+ * batch per access operation is kept on the handle and reused until any of those
+ * change; xmldb_put frees them when the edit is done since the compiled rules
+ * point into the NACM and request trees.
+ * Batches with path rules are not reused: path rule hits are instance pointers
+ * into the request tree, which the edit mutates between calls.
  */
+#define NACM_WBATCH_PTR "nacm-write-batch"
+
+/* Verdicts, also memoized per schema node in nb_vtab */
+#define NACM_VERDICT_DENY    0  /* Deny by matching rule */
+#define NACM_VERDICT_PERMIT  1  /* Permit by rule or default */
+#define NACM_VERDICT_DEFDENY 2  /* Deny by write-default, no rule matched */
+
+/* Prepared write-authorization state for one access operation */
+struct nacm_wbatch{
+    cxobj         *nb_xt;       /* Request root tree prepared against */
+    cxobj         *nb_xnacm;    /* NACM tree prepared against */
+    char          *nb_username; /* User (malloced) */
+    prepvec       *nb_pv_list;  /* Compiled rules for this access operation */
+    clicon_hash_t *nb_dtab;     /* Per-module rule decision table */
+    clicon_hash_t *nb_vtab;     /* Per-schema-node verdict table, see nb_cached */
+    int            nb_defpermit;/* write-default is permit */
+    int            nb_step9;    /* No group matched: write-default decides directly */
+    int            nb_cached;   /* No path rules: batch and verdicts are reusable */
+};
+
+/* Per-handle batch slots, indexed by enum nacm_access (write ops only) */
+struct nacm_wbatches{
+    struct nacm_wbatch *nw_batch[NACM_EXEC];
+};
+
 static int
-nacm_data_write_xrule_xml(cxobj       *xn,
-                          cxobj       *xrule,
-                          clixon_xvec *xpathvec,
-                          yang_stmt   *yspec)
+nacm_wbatch_free1(struct nacm_wbatch *nb)
 {
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    char      *action;
-    cxobj     *xp;
-    int        i;
+    if (nb->nb_username)
+        free(nb->nb_username);
+    if (nb->nb_pv_list)
+        prepvec_free(nb->nb_pv_list);
+    if (nb->nb_dtab)
+        clicon_hash_free(nb->nb_dtab);
+    if (nb->nb_vtab)
+        clicon_hash_free(nb->nb_vtab);
+    free(nb);
+    return 0;
+}
 
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+/*! Free all write-authorization batches kept on the handle
+ *
+ * Must be called when a datastore edit is done: the compiled rules point into
+ * the request and NACM trees and must not outlive them.
+ * @param[in]  h   Clicon handle
+ * @retval     0   OK
+ * @see xmldb_put
+ */
+int
+nacm_datanode_write_batch_free(clicon_handle h)
+{
+    struct nacm_wbatches *nws = NULL;
+    int                   i;
+
+    clicon_ptr_get(h, NACM_WBATCH_PTR, (void**)&nws);
+    if (nws == NULL)
+        return 0;
+    for (i=0; i<NACM_EXEC; i++)
+        if (nws->nw_batch[i])
+            nacm_wbatch_free1(nws->nw_batch[i]);
+    free(nws);
+    clicon_ptr_del(h, NACM_WBATCH_PTR);
+    return 0;
+}
+
+/*! Get prepared write-authorization batch for an access operation, build if stale
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  xt       XML request root tree
+ * @param[in]  access   NACM access operation
+ * @param[in]  username User making access
+ * @param[in]  xnacm    NACM xml tree
+ * @param[out] nbp      Prepared batch. Caller frees iff nb_cached is 0
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_wbatch_get(clicon_handle       h,
+                cxobj              *xt,
+                enum nacm_access    access,
+                char               *username,
+                cxobj              *xnacm,
+                struct nacm_wbatch **nbp)
+{
+    int                   retval = -1;
+    struct nacm_wbatches *nws = NULL;
+    struct nacm_wbatch   *nb = NULL;
+    char                 *write_default;
+    cxobj               **gvec = NULL;     /* groups */
+    size_t                glen;
+    cxobj               **rlistvec = NULL; /* rule-list */
+    size_t                rlistlen;
+    cvec                 *nsc = NULL;
+    prepvec              *pv;
+
+    clicon_ptr_get(h, NACM_WBATCH_PTR, (void**)&nws);
+    if (nws == NULL){
+        if ((nws = malloc(sizeof(*nws))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
             goto done;
-        /* ymod is NULL (xn is "config") Can this breach the NACM rule? */
-        if (ymod && strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
+        }
+        memset(nws, 0, sizeof(*nws));
+        if (clicon_ptr_set(h, NACM_WBATCH_PTR, nws) < 0){
+            free(nws);
+            goto done;
+        }
     }
-    action = xml_find_body(xrule, "action"); /* mandatory */
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        Requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (strcmp(action, "deny")==0)
-            goto deny;
-        goto permit;
+    if ((nb = nws->nw_batch[access]) != NULL){
+        if (nb->nb_xt == xt &&
+            nb->nb_xnacm == xnacm &&
+            clicon_strcmp(nb->nb_username, username) == 0){
+            *nbp = nb;
+            goto ok;
+        }
+        nacm_wbatch_free1(nb);
+        nws->nw_batch[access] = NULL;
     }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (strcmp(action, "deny")==0)
-                goto deny;
-            goto permit;
+    if ((nb = malloc(sizeof(*nb))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(nb, 0, sizeof(*nb));
+    nb->nb_xt = xt;
+    nb->nb_xnacm = xnacm;
+    if (username && (nb->nb_username = strdup(username)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* Create namespace context for with nacm namespace as default */
+    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
+        goto done;
+    /* write-default (create, update, or delete) has default deny so should never be NULL */
+    if ((write_default = xml_find_body(xnacm, "write-default")) == NULL){
+        clicon_err(OE_XML, EINVAL, "No nacm write-default rule");
+        goto done;
+    }
+    nb->nb_defpermit = (strcmp(write_default, "deny") != 0);
+    /* 3.   Check all the "group" entries to see if any of them contain a
+       "user-name" entry that equals the username for the session
+       making the request.
+       4. If no groups are found, continue with step 9. */
+    nb->nb_step9 = 1;
+    if (username != NULL){
+        if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+            goto done;
+        if (glen > 0){
+            nb->nb_step9 = 0;
+            /* 5. Process all rule-list entries, in the order they appear in the
+               configuration. */
+            if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+                goto done;
+            if (nacm_datanode_prepare(h, xt, access, gvec, glen,
+                                      rlistvec, rlistlen, nsc, &nb->nb_pv_list) < 0)
+                goto done;
+            if ((nb->nb_dtab = clicon_hash_init()) == NULL)
+                goto done;
         }
     }
-    goto nomatch;
- permit:
-    retval = 2;       /* rule match and permit */
+    /* Without path rules all criteria are per schema node: cache the batch
+     * across calls and memoize verdicts per schema node */
+    nb->nb_cached = 1;
+    if ((pv = nb->nb_pv_list) != NULL){
+        do {
+            if (pv->pv_haspath){
+                nb->nb_cached = 0;
+                break;
+            }
+            pv = NEXTQ(prepvec *, pv);
+        } while (pv && pv != nb->nb_pv_list);
+    }
+    if (nb->nb_cached){
+        if ((nb->nb_vtab = clicon_hash_init()) == NULL)
+            goto done;
+        nws->nw_batch[access] = nb;
+    }
+    *nbp = nb;
+    nb = NULL;
+ ok:
+    retval = 0;
  done:
+    if (retval < 0 && nb)
+        nacm_wbatch_free1(nb);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (gvec)
+        free(gvec);
+    if (rlistvec)
+        free(rlistvec);
     return retval;
- nomatch :  /* rule does not match */
-    retval = 0;
-    goto done;
- deny:      /* rule match and deny */
-    retval = 1;
-    goto done;
 }
 
 /*! Recursive check for NACM write rules among all XML nodes
  * @param[in]  h         Clicon handle
  * @param[in]  xn        XML node (requested node)
- * @param[in]  rulevec   Precomputed rules that apply to this user group
- * @param[in]  xpathvec  Precomputed xpath results that apply to this XML tree
- * @param[in]  defpermit 0 if default deny, 1 is default permit
+ * @param[in]  nb        Prepared write-authorization batch, see nacm_wbatch_get
  * @param[in]  yspec     YANG spec
  * @param[out] cbret     Error message if retval = 0
  * @retval     1         OK and accept
  * @retval     0         Deny and cbret set
  * @retval     -1        Error
- * XXX differentiate between nomatch: default. or match deny, match accept 
- * nomatch: check write-default rules, next v
- * accept:  Hunky dory
- * deny:    Send error message
+ * The verdict for a node with a schema spec depends only on the schema node
+ * when no path rules apply (see nb_vtab): distinct (schema node, operation)
+ * pairs are then authorized once and repeated instances, eg thousands of
+ * entries of the same list, resolve to a single hash lookup.
  */
 static int
-nacm_datanode_write_recurse(clicon_handle h,
-                            cxobj        *xn,
-                            prepvec      *pv_list,
-                            int           defpermit,
-                            yang_stmt    *yspec,
-                            cbuf         *cbret)
+nacm_datanode_write_recurse(clicon_handle       h,
+                            cxobj              *xn,
+                            struct nacm_wbatch *nb,
+                            yang_stmt          *yspec,
+                            cbuf               *cbret)
 {
-    int       retval = -1;
-    cxobj   *x;
-    int      ret = 0;
-    prepvec *pv;
-    
-    pv = pv_list;
-    if (pv){
-        do {
-            /* return values: -1:Error /0:no match /1: deny /2: permit
-             */
-            if ((ret = nacm_data_write_xrule_xml(xn, pv->pv_xrule, pv->pv_xpathvec, yspec)) < 0) 
-                goto done;
-            switch(ret){
-            case 0: /* No match, continue with next rule */
-                break;
-            case 1: /* Match and deny: break all traversal and send error back to client */
-                if (netconf_access_denied(cbret, "application", "access denied") < 0)
-                    goto done;
-                goto deny;
-                break;
-            case 2: /* Match and permit: break rule processing but continue recursion */
-                break;
-            }
-            if (ret == 2)
-                break;
-            pv = NEXTQ(prepvec *, pv);
-        } while (pv && pv != pv_list);
+    int        retval = -1;
+    cxobj     *x;
+    int        ret;
+    prepvec   *pv = NULL;
+    yang_stmt *ys;
+    char       key[32] = {0,};
+    int       *vcache;
+    int        verdict = -1;
+
+    if (nb->nb_vtab && (ys = xml_spec(xn)) != NULL){
+        snprintf(key, sizeof(key), "%p", ys);
+        if ((vcache = (int*)clicon_hash_value(nb->nb_vtab, key, NULL)) != NULL)
+            verdict = *vcache;
     }
-    /* If no rule match, check default rule: if deny then break traversal and send error */
-    if (ret == 0 && !defpermit){
-        if (netconf_access_denied(cbret, "application", "default deny") < 0)
+    if (verdict < 0){
+        if (nacm_data_node_match(xn, nb->nb_pv_list, yspec, nb->nb_dtab, &pv) < 0)
+            goto done;
+        if (pv != NULL)
+            /* Match and deny: break all traversal and send error back to client,
+             * match and permit: break rule processing but continue recursion */
+            verdict = (pv->pv_action && strcmp(pv->pv_action, "deny") == 0) ?
+                NACM_VERDICT_DENY : NACM_VERDICT_PERMIT;
+        else
+            /* If no rule match, check default rule */
+            verdict = nb->nb_defpermit ? NACM_VERDICT_PERMIT : NACM_VERDICT_DEFDENY;
+        if (key[0] &&
+            clicon_hash_add(nb->nb_vtab, key, &verdict, sizeof(verdict)) == NULL)
+            goto done;
+    }
+    if (verdict != NACM_VERDICT_PERMIT){
+        if (netconf_access_denied(cbret, "application",
+                                  verdict == NACM_VERDICT_DEFDENY ?
+                                  "default deny" : "access denied") < 0)
             goto done;
         goto deny;
     }
     /* If node should be purged, dont recurse and defer removal to caller */
     x = NULL;   /* Recursively check XML */
     while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-        if ((ret = nacm_datanode_write_recurse(h, x, pv_list,
-                                               defpermit, yspec, cbret)) < 0)
+        if ((ret = nacm_datanode_write_recurse(h, x, nb, yspec, cbret)) < 0)
             goto done;
         if (ret == 0)
             goto deny;
@@ -683,93 +925,49 @@ nacm_datanode_write(clicon_handle    h,
                     cxobj           *xnacm,
                     cbuf            *cbret)
 {
-    int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
-    cxobj         **rlistvec = NULL; /* rule-list */
-    size_t          rlistlen;
-    cxobj         **rvec = NULL; /* rules */
-    char           *write_default = NULL;
-    cvec           *nsc = NULL;
-    int             ret;
-    prepvec        *pv_list = NULL;
+    int                 retval = -1;
+    int                 ret;
+    struct nacm_wbatch *nb = NULL;
 
-    /* Create namespace context for with nacm namespace as default */
-    if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
-        goto done;
     if (xnacm == NULL)
         goto permit;
-    /* write-default (create, update, or delete) has default deny so should never be NULL */
-    if ((write_default = xml_find_body(xnacm, "write-default")) == NULL){
-        clicon_err(OE_XML, EINVAL, "No nacm write-default rule");
+    /* Preparation (steps 3-5 and rule compilation) is batched across the
+     * per-node calls of one datastore edit, see nacm_wbatch_get */
+    if (nacm_wbatch_get(h, xt, access, username, xnacm, &nb) < 0)
         goto done;
+    if (nb->nb_step9){
+        /*  8.   At this point, no matching rule was found in any rule-list
+            entry. */
+        /* 10.  For a "write" access operation, if the requested data node is
+            defined in a YANG module advertised in the server capabilities
+            and the data definition statement contains a
+            "nacm:default-deny-write" or a "nacm:default-deny-all"
+            statement, then the access request is denied for the data node
+            and all its descendants.
+            XXX
+        */
+        /*12.  For a "write" access operation, if the "write-default" leaf is
+            set to "permit", then permit the data node access request;
+            otherwise, deny the request.*/
+        if (!nb->nb_defpermit){
+            if (netconf_access_denied(cbret, "application", "default deny") < 0)
+                goto done;
+            goto deny;
+        }
+        goto permit;
     }
-    /* 3.   Check all the "group" entries to see if any of them contain a
-       "user-name" entry that equals the username for the session
-       making the request.  (If the "enable-external-groups" leaf is
-       "true", add to these groups the set of groups provided by the
-       transport layer.)               */
-    if (username == NULL)
-        goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
-        goto done;
-    /* 4. If no groups are found, continue with step 9. */
-    if (glen == 0)
-        goto step9;
-    /* 5. Process all rule-list entries, in the order they appear in the
-        configuration.  If a rule-list's "group" leaf-list does not
-        match any of the user's groups, proceed to the next rule-list
-        entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
-    /* First run through rules and cache rules as well as lookup objects in xt. 
-     */
-    if (nacm_datanode_prepare(h, xt, access, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
-        goto done;
     /* Then recursivelyy traverse all requested nodes */
-    if ((ret = nacm_datanode_write_recurse(h, xreq, pv_list,
-                                           strcmp(write_default, "deny"),
-                                           clicon_dbspec_yang(h),
-                                           cbret)) < 0)
+    if ((ret = nacm_datanode_write_recurse(h, xreq, nb,
+                                           clicon_dbspec_yang(h), cbret)) < 0)
         goto done;
     if (ret == 0) /* deny */
         goto deny;
-    goto permit;
-    /*  8.   At this point, no matching rule was found in any rule-list
-        entry. */
- step9:   
-    /* 10.  For a "write" access operation, if the requested data node is
-        defined in a YANG module advertised in the server capabilities
-        and the data definition statement contains a
-        "nacm:default-deny-write" or a "nacm:default-deny-all"
-        statement, then the access request is denied for the data node
-        and all its descendants.
-        XXX
-    */
-    /*12.  For a "write" access operation, if the "write-default" leaf is
-        set to "permit", then permit the data node access request;
-        otherwise, deny the request.*/
-    /* write-default has default permit so should never be NULL */
-    if (strcmp(write_default, "deny") == 0){
-        if (netconf_access_denied(cbret, "application", "default deny") < 0)
-            goto done;
-        goto deny;
-    }
  permit:
     retval = 1;
  done:
     clicon_debug(1, "%s retval:%d (0:deny 1:permit)", __FUNCTION__, retval);
-    if (pv_list)
-        prepvec_free(pv_list);
-    if (nsc)
-        xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
+    if (nb && !nb->nb_cached)
+        nacm_wbatch_free1(nb);
     return retval;
  deny: /* Here, cbret must contain a netconf error msg */
     assert(cbuf_len(cbret));
@@ -805,105 +1003,34 @@ nacm_data_read_action(cxobj *xrule,
     return retval;
 }
 
-/*! Match specific rule to specific requested node
- * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  yspec    YANG spec
- * @retval -1  Error
- * @retval  0  OK and rule does not match
- * @retval  1  OK and rule matches
- * Two distinct cases:
- * (1) read_default is permit
- *     mark all deny rules and remove them
- * (2) read_default is deny:
- *     mark all permit rules and ancestors, remove everything else
- */
-static int
-nacm_data_read_xrule_xml(cxobj        *xn,
-                         cxobj        *xrule,
-                         clixon_xvec  *xpathvec,
-                         yang_stmt    *yspec)
-{
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    cxobj     *xp;
-    int        i;
-    
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        if (strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
-    }
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (nacm_data_read_action(xrule, xn) < 0)
-            goto done;
-        goto match;
-    }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (nacm_data_read_action(xrule, xn) < 0)
-                goto done;
-            goto match;
-        }
-    }
- nomatch:
-    retval = 0;
- done:
-    return retval;
- match:
-    retval = 1; /* match */
-    goto done;
-}
-
 /*! Recursive check for NACM read rules among all XML nodes
  * @param[in]  h        Clicon handle
  * @param[in]  xn       XML node (requested node)
- * @param[in]  rulevec  Precomputed rules that apply to this user group
- * @param[in]  xpathvec Precomputed xpath results that apply to this XML tree
+ * @param[in]  pv_list  Precomputed rules that apply to this user group
+ * @param[in]  dtab     Per-module rule decision table, see nacm_data_node_match
  * @param[in]  yspec    YANG spec
  * @retval  0  OK
  * @retval -1  Error
  */
 static int
-nacm_datanode_read_recurse(clicon_handle h,
-                           cxobj        *xn,
-                           prepvec      *pv_list,
-                           yang_stmt    *yspec)
+nacm_datanode_read_recurse(clicon_handle  h,
+                           cxobj         *xn,
+                           prepvec       *pv_list,
+                           clicon_hash_t *dtab,
+                           yang_stmt     *yspec)
 {
     int      retval = -1;
     cxobj   *x;
     cxobj   *xprev;
-    int      ret;
-    prepvec *pv;
-    
-    if (xml_spec(xn)){ /* Check this node */
-        pv = pv_list;
-        if (pv){
-            do {
-                if ((ret = nacm_data_read_xrule_xml(xn,
-                                                    pv->pv_xrule,
-                                                    pv->pv_xpathvec,
-                                                    yspec)) < 0) 
-                    goto done;      
-                if (ret == 1)
-                    break; /* stop at first match */                
-                pv = NEXTQ(prepvec *, pv);
-            } while (pv && pv != pv_list);
-        }
+    prepvec *pv = NULL;
 
-#if 0 /* 6(A) in algorithm 
+    if (xml_spec(xn)){ /* Check this node */
+        if (nacm_data_node_match(xn, pv_list, yspec, dtab, &pv) < 0)
+            goto done;
+        if (pv != NULL &&
+            nacm_data_read_action(pv->pv_xrule, xn) < 0)
+            goto done;
+#if 0 /* 6(A) in algorithm
        * If N did not match any rule R, and default rule is deny, remove that subtree */
         if (strcmp(read_default, "deny") == 0)
             if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
@@ -916,7 +1043,7 @@ nacm_datanode_read_recurse(clicon_handle h,
         x = NULL;       /* Recursively check XML */
         xprev = NULL;
         while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-            if (nacm_datanode_read_recurse(h, x, pv_list, yspec) < 0)
+            if (nacm_datanode_read_recurse(h, x, pv_list, dtab, yspec) < 0)
                 goto done;
             /* check for delayed remove */
             if (xml_flag(x, XML_FLAG_DEL)){
@@ -996,7 +1123,8 @@ nacm_datanode_read(clicon_handle h,
     char           *read_default = NULL;
     cvec           *nsc = NULL;
     prepvec        *pv_list = NULL;
-    
+    clicon_hash_t  *dtab = NULL;
+
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
         goto done;
@@ -1028,8 +1156,10 @@ nacm_datanode_read(clicon_handle h,
      */
     if (nacm_datanode_prepare(h, xt, NACM_READ, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
         goto done;
+    if ((dtab = clicon_hash_init()) == NULL)
+        goto done;
     /* Then recursivelyy traverse all nodes */
-    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h)) < 0)
+    if (nacm_datanode_read_recurse(h, xt, pv_list, dtab, clicon_dbspec_yang(h)) < 0)
         goto done;
 #if 1
     /* Step 8(B) above:
@@ -1060,6 +1190,8 @@ nacm_datanode_read(clicon_handle h,
     retval = 0;
  done:
     clicon_debug(1, "%s retval:%d", __FUNCTION__, retval);
+    if (dtab)
+        clicon_hash_free(dtab);
     if (pv_list)
         prepvec_free(pv_list);
     if (nsc)
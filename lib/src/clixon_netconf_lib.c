@@ -106,27 +106,43 @@ withdefaults_str2int(char *str)
     return clicon_str2int(wdmap, str);
 }
 
-/*! Create Netconf in-use error XML tree according to RFC 6241 Appendix A
+/*! Write a Netconf rpc-error reply directly to a cbuf from a fixed template
  *
- * The request requires a resource that already is in use.
- * @param[out] cb       CLIgen buf. Error XML is written in this buffer
- * @param[in]  type     Error type: "application" or "protocol"
- * @param[in]  message  Error message (will be XML encoded)
+ * The rpc-reply/rpc-error envelope and the error-type/tag/severity fields are
+ * constant per error shape: print them straight into the buffer with slot
+ * substitution instead of building an XML tree and serializing it per error.
+ * Only the error message (chardata) needs encoding; element/namespace slots are
+ * inserted verbatim as in the tree-building variants.
+ * @param[out] cb      CLIgen buf. Error XML is written in this buffer
+ * @param[in]  type    Error type: "transport", "rpc", "application" or "protocol"
+ * @param[in]  tag     Error tag, eg "invalid-value"
+ * @param[in]  infotag Error info element name, eg "bad-element", or NULL for none
+ * @param[in]  element Error info element value, used only if infotag is set
+ * @param[in]  message Error message (will be XML encoded) or NULL
+ * @see netconf_common_xml  Same but returns XML tree
  */
-int
-netconf_in_use(cbuf *cb,
-               char *type,
-               char *message)
+static int
+netconf_common_cbuf(cbuf *cb,
+                    char *type,
+                    char *tag,
+                    char *infotag,
+                    char *element,
+                    char *message)
 {
     int   retval = -1;
     char *encstr = NULL;
-    
+
     if (cprintf(cb, "<rpc-reply xmlns=\"%s\"><rpc-error>"
                 "<error-type>%s</error-type>"
-                "<error-tag>in-use</error-tag>"
-                "<error-severity>error</error-severity>",
-                NETCONF_BASE_NAMESPACE,
-                type) <0)
+                "<error-tag>%s</error-tag>",
+                NETCONF_BASE_NAMESPACE, type, tag) < 0)
+        goto err;
+    if (infotag){
+        if (cprintf(cb, "<error-info><%s>%s</%s></error-info>",
+                    infotag, element, infotag) < 0)
+            goto err;
+    }
+    if (cprintf(cb, "<error-severity>error</error-severity>") < 0)
         goto err;
     if (message){
         if (xml_chardata_encode(&encstr, "%s", message) < 0)
@@ -134,7 +150,7 @@ netconf_in_use(cbuf *cb,
         if (cprintf(cb, "<error-message>%s</error-message>", encstr) < 0)
             goto err;
     }
-    if (cprintf(cb, "</rpc-error></rpc-reply>") <0)
+    if (cprintf(cb, "</rpc-error></rpc-reply>") < 0)
         goto err;
     retval = 0;
  done:
@@ -146,6 +162,21 @@ netconf_in_use(cbuf *cb,
     goto done;
 }
 
+/*! Create Netconf in-use error XML tree according to RFC 6241 Appendix A
+ *
+ * The request requires a resource that already is in use.
+ * @param[out] cb       CLIgen buf. Error XML is written in this buffer
+ * @param[in]  type     Error type: "application" or "protocol"
+ * @param[in]  message  Error message (will be XML encoded)
+ */
+int
+netconf_in_use(cbuf *cb,
+               char *type,
+               char *message)
+{
+    return netconf_common_cbuf(cb, type, "in-use", NULL, NULL, message);
+}
+
 /*! Create Netconf invalid-value error XML tree according to RFC 6241 Appendix A
  *
  * The request specifies an unacceptable value for one or more parameters.
@@ -207,18 +238,7 @@ netconf_invalid_value(cbuf *cb,
                       char *type,
                       char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_invalid_value_xml(&xret, type, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "invalid-value", NULL, NULL, message);
 }
 
 /*! Create Netconf too-big error XML tree according to RFC 6241 Appendix A
@@ -234,32 +254,7 @@ netconf_too_big(cbuf *cb,
                 char *type,
                 char *message)
 {
-    int     retval = -1;
-    char *encstr = NULL;
-
-    if (cprintf(cb, "<rpc-reply xmlns=\"%s\"><rpc-error>"
-                "<error-type>%s</error-type>"
-                "<error-tag>too-big</error-tag>"
-                "<error-severity>error</error-severity>",
-                NETCONF_BASE_NAMESPACE,
-                type) <0)
-        goto err;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (cprintf(cb, "<error-message>%s</error-message>", encstr) < 0)
-            goto err;
-    }
-    if (cprintf(cb, "</rpc-error></rpc-reply>") <0)
-        goto err;
-    retval = 0;
- done:
-    if (encstr)
-        free(encstr);
-    return retval;
- err:
-    clicon_err(OE_XML, errno, "cprintf");
-    goto done;
+    return netconf_common_cbuf(cb, type, "too-big", NULL, NULL, message);
 }
 
 /*! Create Netconf missing-attribute error XML tree according to RFC 6241 App A
@@ -327,18 +322,8 @@ netconf_missing_attribute(cbuf *cb,
                           char *attr,
                           char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_missing_attribute_xml(&xret, type, attr, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "missing-attribute",
+                               "bad-attribute", attr, message);
 }
 
 /*! Create Netconf bad-attribute error XML tree according to RFC 6241 App A
@@ -356,18 +341,8 @@ netconf_bad_attribute(cbuf *cb,
                       char *info,
                       char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_bad_attribute_xml(&xret, type, info, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "bad-attribute",
+                               "bad-attribute", info, message);
 }
 
 /*! Create Netconf bad-attribute error XML tree according to RFC 6241 App A
@@ -527,24 +502,13 @@ netconf_common_xml(cxobj **xret,
  * @param[in]  message Error message
  */
 int
-netconf_missing_element(cbuf      *cb, 
+netconf_missing_element(cbuf      *cb,
                         char      *type,
                         char      *element,
                         char      *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_common_xml(&xret, type, "missing-element",
-                           "bad-element", element, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "missing-element",
+                               "bad-element", element, message);
 }
 
 /*! Create Netconf missing-element error XML tree according to RFC 6241 App A
@@ -578,19 +542,8 @@ netconf_bad_element(cbuf *cb,
                     char *element,
                     char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_common_xml(&xret, type, "bad-element",
-                           "bad-element",element, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "bad-element",
+                               "bad-element", element, message);
 }
 
 int
@@ -616,19 +569,8 @@ netconf_unknown_element(cbuf *cb,
                         char *element,
                         char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_common_xml(&xret, type, "unknown-element",
-                           "bad-element", element, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "unknown-element",
+                               "bad-element", element, message);
 }
 
 /*! Create Netconf unknown-element error XML tree according to RFC 6241 App A
@@ -663,19 +605,8 @@ netconf_unknown_namespace(cbuf *cb,
                           char *ns,
                           char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_common_xml(&xret, type, "unknown-namespace",
-                           "bad-namespace", ns, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "unknown-namespace",
+                               "bad-namespace", ns, message);
 }
 
 int
@@ -702,18 +633,7 @@ netconf_access_denied(cbuf *cb,
                       char *type,
                       char *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_access_denied_xml(&xret, type, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "access-denied", NULL, NULL, message);
 }
 
 /*! Create Netconf access-denied error XML tree according to RFC 6241 App A
@@ -901,34 +821,10 @@ netconf_rollback_failed(cbuf *cb,
  * @param[in]  message Error message
  */
 int
-netconf_data_exists(cbuf      *cb, 
+netconf_data_exists(cbuf      *cb,
                     char      *message)
 {
-    int   retval = -1;
-    char *encstr = NULL;
-
-    if (cprintf(cb, "<rpc-reply xmlns=\"%s\"><rpc-error>"
-                "<error-type>application</error-type>"
-                "<error-tag>data-exists</error-tag>"
-                "<error-severity>error</error-severity>",
-                NETCONF_BASE_NAMESPACE) <0)
-        goto err;
-    if (message){
-        if (xml_chardata_encode(&encstr, "%s", message) < 0)
-            goto done;
-        if (cprintf(cb, "<error-message>%s</error-message>", encstr) < 0)
-            goto err;
-    }
-    if (cprintf(cb, "</rpc-error></rpc-reply>") <0)
-        goto err;
-    retval = 0;
- done:
-    if (encstr)
-        free(encstr);
-    return retval;
- err:
-    clicon_err(OE_XML, errno, "cprintf");
-    goto done;
+    return netconf_common_cbuf(cb, "application", "data-exists", NULL, NULL, message);
 }
 
 /*! Create Netconf data-missing error XML tree according to RFC 6241 App A
@@ -943,18 +839,7 @@ int
 netconf_data_missing(cbuf *cb,
                      char *message)
 {
-    int   retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_data_missing_xml(&xret, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, "application", "data-missing", NULL, NULL, message);
 }
 
 /*! Create Netconf data-missing error XML tree according to RFC 6241 App A / RFC 7950 15.6(choice)
@@ -1148,18 +1033,7 @@ netconf_operation_not_supported(cbuf *cb,
                                 char *type,
                                 char *message)
 {
-    int   retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_operation_not_supported_xml(&xret, type, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "operation-not-supported", NULL, NULL, message);
 }
 
 /*! Create Netconf operation-failed error XML tree according to RFC 6241 App A
@@ -1176,18 +1050,7 @@ netconf_operation_failed(cbuf  *cb,
                          char  *type,
                          char  *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_operation_failed_xml(&xret, type, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, type, "operation-failed", NULL, NULL, message);
 }
 
 /*! Create Netconf operation-failed error XML tree according to RFC 6241 App A
@@ -1261,18 +1124,7 @@ int
 netconf_malformed_message(cbuf  *cb,
                           char  *message)
 {
-    int    retval = -1;
-    cxobj *xret = NULL;
-
-    if (netconf_malformed_message_xml(&xret, message) < 0)
-        goto done;
-    if (clixon_xml2cbuf(cb, xret, 0, 0, -1, 0) < 0)
-        goto done;
-    retval = 0;
- done:
-    if (xret)
-        xml_free(xret);
-    return retval;
+    return netconf_common_cbuf(cb, "rpc", "malformed-message", NULL, NULL, message);
 }
 
 /*! Create Netconf malformed-message error XML tree according to RFC 6241 App A
@@ -1624,6 +1476,9 @@ netconf_module_load(clicon_handle h)
     /* RFC6243 With-defaults Capability for NETCONF */
     if (yang_spec_parse_module(h, "ietf-netconf-with-defaults", NULL, yspec)< 0)
         goto done;
+    /* RFC5717 Partial Lock Remote Procedure Call */
+    if (yang_spec_parse_module(h, "ietf-netconf-partial-lock", NULL, yspec)< 0)
+        goto done;
     /* RFC6022 YANG Module for NETCONF Monitoring */
     if (yang_spec_parse_module(h, "ietf-netconf-monitoring", NULL, yspec)< 0)
         goto done;
@@ -1633,7 +1488,7 @@ netconf_module_load(clicon_handle h)
      */
     clicon_option_int_set(h, "netconf-framing", NETCONF_SSH_EOM);
     if (clicon_option_bool(h, "CLICON_NETCONF_HELLO_OPTIONAL")){
-        if (clicon_option_int(h, "CLICON_NETCONF_BASE_CAPABILITY") > 0) /* RFC 6241 */
+        if (clicon_optcache(h)->oc_netconf_base_capability > 0) /* RFC 6241 */
             clicon_option_int_set(h, "netconf-framing", NETCONF_SSH_CHUNKED);
     }
     retval = 0;
@@ -1773,7 +1628,7 @@ netconf_capabilites(clicon_handle h,
 
     module_set_id = clicon_option_str(h, "CLICON_MODULE_SET_ID");
     cprintf(cb, "<capabilities>");
-    if (clicon_option_int(h, "CLICON_NETCONF_BASE_CAPABILITY") > 0){
+    if (clicon_optcache(h)->oc_netconf_base_capability > 0){
         /* Each peer MUST send at least the base NETCONF capability, "urn:ietf:params:netconf:base:1.1" 
          * RFC 6241 Sec 8.1
          */
@@ -1808,6 +1663,8 @@ netconf_capabilites(clicon_handle h,
     cprintf(cb, "<capability>");
     xml_chardata_cbuf_append(cb, "urn:ietf:params:netconf:capability:with-defaults:1.0?basic-mode=explicit&also-supported=report-all,trim,report-all-tagged");
     cprintf(cb, "</capability>");
+    /* RFC5717 Partial Lock Capability */
+    cprintf(cb, "<capability>%s</capability>", NETCONF_PARTIAL_LOCK_CAPABILITY);
     /* RFC5277 Notification Capability */
     cprintf(cb, "<capability>%s</capability>", NETCONF_NOTIFICATION_CAPABILITY);
     /* RFC6022 YANG Module for NETCONF Monitoring 
@@ -2322,3 +2179,65 @@ netconf_input_chunked_framing(char    ch,
     goto done;
 }
 
+/*! Block-oriented variant of netconf_input_chunked_framing
+ *
+ * Consume as much of an input buffer as possible in one call instead of one
+ * character at a time: chunk-data is copied to the message buffer in whole blocks
+ * using the explicit chunk-size of RFC6242, only the short framing control
+ * sequences go through the per-character state machine. NUL characters in the
+ * framing are skipped as in the byte-by-byte loop (eg from terminals).
+ * @param[in]     buf    Input buffer
+ * @param[in]     len    Length of buf
+ * @param[in,out] state  State machine state, see netconf_input_chunked_framing
+ * @param[in,out] size   Remaining expected chunk bytes
+ * @param[in,out] cb     Message buffer where chunk-data is appended
+ * @param[out]    nr     Number of bytes of buf consumed
+ * @retval        2      End-of-frame, message in cb complete (buf may hold more, call again)
+ * @retval        0      All of buf consumed, message not complete
+ * @retval       -1      Error
+ * @see netconf_input_chunked_framing  per-character state machine
+ */
+int
+netconf_input_chunked_framing_buf(char   *buf,
+                                  size_t  len,
+                                  int    *state,
+                                  size_t *size,
+                                  cbuf   *cb,
+                                  size_t *nr)
+{
+    int    retval = -1;
+    size_t i = 0;
+    size_t n;
+    int    ret;
+
+    while (i < len){
+        if (*state == 4 && *size > 0){
+            /* Bulk copy chunk-data: whole chunk or rest of buffer */
+            n = len - i < *size ? len - i : *size;
+            if (cbuf_append_buf(cb, buf+i, n) < 0){
+                clicon_err(OE_UNIX, errno, "cbuf_append_buf");
+                goto done;
+            }
+            *size -= n;
+            i += n;
+            continue;
+        }
+        if (buf[i] == 0){ /* Skip NUL chars (eg from terminals) */
+            i++;
+            continue;
+        }
+        /* Framing control char. Cannot return 1 (chunk-data): that is handled in bulk above */
+        if ((ret = netconf_input_chunked_framing(buf[i], state, size)) < 0)
+            goto done;
+        i++;
+        if (ret == 2){ /* end-of-frame */
+            retval = 2;
+            goto done;
+        }
+    }
+    retval = 0;
+ done:
+    *nr = i;
+    return retval;
+}
+
@@ -45,6 +45,7 @@
 #include <limits.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <dirent.h>
 #include <sys/time.h>
 
 /* cligen */
@@ -52,6 +53,8 @@
 
 /* clicon */
 #include "clixon_log.h"
+#include "clixon_string.h"
+#include "clixon_file.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -135,6 +138,12 @@ netconf_monitoring_datastores(clicon_handle h,
  * @retval        0       OK
  * @see RFC 6022 Section 2.1.3
  */
+/* Serialized <schemas> list cache: the module set only changes on schema
+ * reload, while the list is rebuilt for every netconf-state get and grows
+ * with the number of loaded modules. Keyed on the yang spec identity */
+static cbuf      *_schemas_cache = NULL;
+static yang_stmt *_schemas_cache_yspec = NULL;
+
 static int
 netconf_monitoring_schemas(clicon_handle h,
                            yang_stmt    *yspec,
@@ -146,7 +155,20 @@ netconf_monitoring_schemas(clicon_handle h,
     char      *identifier;
     char      *revision;
     char      *dir;
+    cbuf      *cb0 = cb;
 
+    if (_schemas_cache != NULL && _schemas_cache_yspec == yspec){
+        cbuf_append_str(cb0, cbuf_get(_schemas_cache));
+        return 0;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (_schemas_cache)
+        cbuf_free(_schemas_cache);
+    _schemas_cache = cb; /* Build into the cache, appended to the caller below */
+    _schemas_cache_yspec = yspec;
     cprintf(cb, "<schemas>");
     while ((ym = yn_each(yspec, ym)) != NULL) {
         cprintf(cb, "<schema>");
@@ -172,8 +194,9 @@ netconf_monitoring_schemas(clicon_handle h,
         cprintf(cb, "</schema>");
     }
     cprintf(cb, "</schemas>");
+    cbuf_append_str(cb0, cbuf_get(cb));
     retval = 0;
-    //done:
+ done:
     return retval;
 }
 
@@ -199,6 +222,79 @@ netconf_monitoring_statistics(clicon_handle h,
     return retval;
 }
 
+/* Escaped schema content cache, see netconf_schema_content()
+ * A schema file only changes on reload while a controller typically refetches
+ * every schema on every reconnect; keep the XML-escaped file content keyed on
+ * the filename so a full schema sync is served from memory */
+struct schema_cache{
+    struct schema_cache *sc_next;
+    char *sc_filename; /* Key: yang source file path */
+    char *sc_content;  /* XML-escaped file content */
+};
+static struct schema_cache *_schema_cache = NULL;
+
+/*! Append the XML-escaped source of a yang module, cached per file
+ *
+ * Serves the get-schema RPC: the read-and-escape of the yang file is done once
+ * per module@revision (distinct filename) and reused for later requests.
+ * @param[in]     h      Clicon handle
+ * @param[in]     ymod   Yang module (or submodule)
+ * @param[in,out] cb     CLIgen buffer to append the escaped content to
+ * @retval        0      OK, nothing appended if the module has no source file
+ * @retval       -1      Error
+ * @see RFC 6022 Section 3.1
+ */
+int
+netconf_schema_content(clicon_handle h,
+                       yang_stmt    *ymod,
+                       cbuf         *cb)
+{
+    int                  retval = -1;
+    struct schema_cache *sc;
+    const char          *filename;
+    cbuf                *cbfile = NULL;
+    cbuf                *cbesc = NULL;
+
+    if ((filename = yang_filename_get(ymod)) == NULL)
+        goto ok;
+    for (sc = _schema_cache; sc; sc = sc->sc_next)
+        if (strcmp(sc->sc_filename, filename) == 0)
+            break;
+    if (sc == NULL){
+        if ((cbfile = cbuf_new()) == NULL || (cbesc = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (clicon_file_cbuf(filename, cbfile) < 0)
+            goto done;
+        if (xml_chardata_cbuf_append(cbesc, cbuf_get(cbfile)) < 0)
+            goto done;
+        if ((sc = calloc(1, sizeof(*sc))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+        if ((sc->sc_filename = strdup(filename)) == NULL ||
+            (sc->sc_content = strdup(cbuf_get(cbesc))) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            if (sc->sc_filename)
+                free(sc->sc_filename);
+            free(sc);
+            goto done;
+        }
+        sc->sc_next = _schema_cache;
+        _schema_cache = sc;
+    }
+    cbuf_append_str(cb, sc->sc_content);
+ ok:
+    retval = 0;
+ done:
+    if (cbfile)
+        cbuf_free(cbfile);
+    if (cbesc)
+        cbuf_free(cbesc);
+    return retval;
+}
+
 /*! Get netconf monitoring state
  *
  * Netconf monitoring state is:
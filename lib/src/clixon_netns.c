@@ -113,14 +113,16 @@ get_sock(int  usock,
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags Or:ed in with the socket(2) type parameter
+ * @param[in]  reuseport Set SO_REUSEPORT before bind, for multi-process accept load-balancing
  * @param[in]  addrstr  Address string for debug
  * @param[out] sock     Server socket (bound for accept)
  */
 static int
 create_socket(struct sockaddr *sa,
-              size_t           sin_len,             
+              size_t           sin_len,
               int              backlog,
               int              flags,
+              int              reuseport,
               const char      *addrstr,
               int             *sock)
 {
@@ -162,6 +164,18 @@ create_socket(struct sockaddr *sa,
         clicon_err(OE_UNIX, errno, "setsockopt SO_REUSEADDR");
         goto done;
     }
+    /* Several processes bind the same address/port, kernel load-balances accepts */
+    if (reuseport){
+#ifdef SO_REUSEPORT
+        if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (void *)&on, sizeof(on)) == -1) {
+            clicon_err(OE_UNIX, errno, "setsockopt SO_REUSEPORT");
+            goto done;
+        }
+#else
+        clicon_err(OE_UNIX, EOPNOTSUPP, "SO_REUSEPORT not supported on platform");
+        goto done;
+#endif
+    }
 
     /* only bind ipv6, otherwise it may bind to ipv4 as well which is strange but seems default */
     if (sa->sa_family == AF_INET6 &&
@@ -189,6 +203,134 @@ create_socket(struct sockaddr *sa,
 }
 
 #ifdef HAVE_SETNS
+/* Cached namespace file descriptors, opened on first use. A restconf listening in
+ * many VRF namespaces rebinds them all on config change: one open per namespace
+ * lifetime instead of one per socket */
+struct netns_cache_ent {
+    char  *nc_name;  /* Namespace name, malloced */
+    int    nc_fd;    /* Open fd to /var/run/netns/<name> */
+    dev_t  nc_dev;   /* dev/ino of the namespace file when opened, to detect */
+    ino_t  nc_ino;   /*   that the namespace was deleted and recreated */
+};
+static struct netns_cache_ent *_netns_cache = NULL;
+static int                     _netns_cache_len = 0;
+
+/*! Get a cached file descriptor for a named network namespace
+ *
+ * Opened on first use and kept for the process lifetime. If the namespace file
+ * was replaced since (namespace deleted and recreated), the cached fd pins the
+ * dead namespace: detect by comparing dev/ino of the path and reopen.
+ * @param[in]  netns  Network namespace name
+ * @retval     fd     Namespace file descriptor, owned by the cache
+ * @retval     -1     Error
+ */
+static int
+netns_fd_get(const char *netns)
+{
+    char                    nspath[MAXPATHLEN];
+    struct stat             st;
+    struct netns_cache_ent *nc = NULL;
+    struct netns_cache_ent *tmp;
+    int                     fd;
+    int                     i;
+
+    sprintf(nspath, "/var/run/netns/%s", netns);
+    if (stat(nspath, &st) < 0){
+        clicon_err(OE_UNIX, errno, ": stat(%s)", nspath);
+        return -1;
+    }
+    for (i=0; i<_netns_cache_len; i++)
+        if (strcmp(_netns_cache[i].nc_name, netns) == 0){
+            nc = &_netns_cache[i];
+            break;
+        }
+    if (nc != NULL && nc->nc_dev == st.st_dev && nc->nc_ino == st.st_ino)
+        return nc->nc_fd;
+    if ((fd = open(nspath, O_RDONLY | O_CLOEXEC)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", nspath);
+        return -1;
+    }
+    if (nc == NULL){
+        if ((tmp = realloc(_netns_cache, (_netns_cache_len+1)*sizeof(*tmp))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            close(fd);
+            return -1;
+        }
+        _netns_cache = tmp;
+        nc = &_netns_cache[_netns_cache_len];
+        if ((nc->nc_name = strdup(netns)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            close(fd);
+            return -1;
+        }
+        _netns_cache_len++;
+    }
+    else
+        close(nc->nc_fd); /* Namespace recreated: drop the stale fd */
+    nc->nc_fd = fd;
+    nc->nc_dev = st.st_dev;
+    nc->nc_ino = st.st_ino;
+    return fd;
+}
+
+/*! Create and bind a socket in a network namespace by setns round-trip, no fork
+ *
+ * setns(CLONE_NEWNET) moves only the calling thread, and a socket keeps the
+ * namespace it was created in: enter the target namespace, create the socket,
+ * return to the original. Microseconds against the fork+sendmsg dance, which
+ * also pays a page-table copy proportional to daemon RSS.
+ * @param[in]  netns    Network namespace
+ * @param[in]  sa       Socketaddress
+ * @param[in]  sa_len   Length of sa
+ * @param[in]  backlog  Listen backlog, queue of pending connections
+ * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport Set SO_REUSEPORT before bind
+ * @param[in]  addrstr  Address string for debug
+ * @param[out] sock     Server socket (bound for accept)
+ * @retval     1        OK
+ * @retval     0        Could not enter the namespace, caller falls back to fork
+ * @retval     -1       Error
+ */
+static int
+setns_netns_socket(const char      *netns,
+                   struct sockaddr *sa,
+                   size_t           sin_len,
+                   int              backlog,
+                   int              flags,
+                   int              reuseport,
+                   const char      *addrstr,
+                   int             *sock)
+{
+    int retval = -1;
+    int nsfd;
+    int selffd = -1;
+    int entered = 0;
+
+    clicon_debug(1, "%s %s", __FUNCTION__, netns);
+    if ((nsfd = netns_fd_get(netns)) < 0)
+        goto done;
+    if ((selffd = open("/proc/self/ns/net", O_RDONLY | O_CLOEXEC)) < 0 ||
+        setns(nsfd, CLONE_NEWNET) < 0){
+        clicon_debug(1, "%s fall back to fork: %s", __FUNCTION__, strerror(errno));
+        retval = 0;
+        goto done;
+    }
+    entered = 1;
+    if (create_socket(sa, sin_len, backlog, flags, reuseport, addrstr, sock) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (entered && setns(selffd, CLONE_NEWNET) < 0){
+        /* Stuck in the wrong namespace, everything after this would misbind */
+        clicon_err(OE_FATAL, errno, "setns(/proc/self/ns/net) restore");
+        retval = -1;
+    }
+    if (selffd != -1)
+        close(selffd);
+    clicon_debug(1, "%s %d", __FUNCTION__, retval);
+    return retval;
+}
+
 /*! Fork a child, create and bind a socket in a separate network namespace and send back to parent
  *
  * @param[in]  netns    Network namespace
@@ -196,15 +338,17 @@ create_socket(struct sockaddr *sa,
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
  * @param[in]  backlog  Listen backlog, queue of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport Set SO_REUSEPORT before bind, for multi-process accept load-balancing
  * @param[in]  addrstr  Address string for debug
  * @param[out] sock     Server socket (bound for accept)
  */
 static int
 fork_netns_socket(const char      *netns,
                   struct sockaddr *sa,
-                  size_t           sin_len,                 
+                  size_t           sin_len,
                   int              backlog,
                   int              flags,
+                  int              reuseport,
                   const char      *addrstr,
                   int             *sock)
 {
@@ -269,7 +413,7 @@ fork_netns_socket(const char      *netns,
 #endif
         close(fd);
         /* Create socket in this namespace */
-        if (create_socket(sa, sin_len, backlog, flags, addrstr, &s) < 0){
+        if (create_socket(sa, sin_len, backlog, flags, reuseport, addrstr, &s) < 0){
             send_sock(sp[1], sp[1]); /* Dummy to wake parent */
             exit(1); /* Dont do return here, need to exit child */
         }
@@ -306,29 +450,38 @@ fork_netns_socket(const char      *netns,
  * @param[in]  sa_len   Length of sa. Tecynicaliyu to be independent of sockaddr sa_len
  * @param[in]  backlog  Listen backlog, queie of pending connections
  * @param[in]  flags    Socket flags OR:ed in with the socket(2) type parameter
+ * @param[in]  reuseport Set SO_REUSEPORT before bind, for multi-process accept load-balancing
  * @param[in]  addrstr  Address string for debug
  * @param[out] sock     Server socket (bound for accept)
  */
 int
 clixon_netns_socket(const char      *netns,
                     struct sockaddr *sa,
-                    size_t           sin_len,               
+                    size_t           sin_len,
                     int              backlog,
                     int              flags,
+                    int              reuseport,
                     const char      *addrstr,
                     int             *sock)
 {
     int    retval = -1;
-    
+
     clicon_debug(1, "%s", __FUNCTION__);
     if (netns == NULL){
-        if (create_socket(sa, sin_len, backlog, flags, addrstr, sock) < 0)
+        if (create_socket(sa, sin_len, backlog, flags, reuseport, addrstr, sock) < 0)
             goto done;
         goto ok;
     }
     else {
 #ifdef HAVE_SETNS
-        if (fork_netns_socket(netns, sa, sin_len, backlog, flags, addrstr, sock) < 0)
+        int ret;
+
+        /* Cached namespace fd + setns round-trip; fork only if the namespace
+         * cannot be entered in-process (eg no procfs) */
+        if ((ret = setns_netns_socket(netns, sa, sin_len, backlog, flags, reuseport, addrstr, sock)) < 0)
+            goto done;
+        if (ret == 0 &&
+            fork_netns_socket(netns, sa, sin_len, backlog, flags, reuseport, addrstr, sock) < 0)
             goto done;
 #else
         clicon_err(OE_UNIX, errno, "No namespace support on platform: %s", netns);
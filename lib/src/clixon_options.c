@@ -117,6 +117,7 @@ static const map_str2int datastore_cache_map[] = {
     {"nocache",               DATASTORE_NOCACHE},
     {"cache",                 DATASTORE_CACHE},
     {"cache-zerocopy",        DATASTORE_CACHE_ZEROCOPY},
+    {"cache-cow",             DATASTORE_CACHE_COW},
     {NULL,                    -1}
 };
 
@@ -443,11 +444,13 @@ clicon_option_add(clicon_handle h,
                                 name, value, name) < 0)
             goto done;
     }
-    if (clicon_hash_add(copt, 
+    if (clicon_hash_add(copt,
                  name,
                  value,
                  strlen(value)+1) == NULL)
         goto done;
+    if (clicon_optcache_update(h) < 0)
+        goto done;
     retval = 0;
  done:
     return retval;
@@ -556,6 +559,12 @@ clicon_options_main(clicon_handle h)
     /* Set clixon_conf pointer to handle */
     if (clicon_conf_xml_set(h, xconfig) < 0)
         goto done;
+    /* Config file loading writes the hash directly: sync the typed snapshot */
+    if (clicon_optcache_update(h) < 0)
+        goto done;
+    /* Slow-operation log threshold is a global, set it here for all daemons */
+    if (clicon_option_exists(h, "CLICON_LOG_SLOW_MS"))
+        clixon_log_slow_set(clicon_option_int(h, "CLICON_LOG_SLOW_MS"));
 
     retval = 0;
  done:
@@ -610,13 +619,15 @@ clicon_option_str(clicon_handle h,
  * @retval   -1       Error
  */
 int
-clicon_option_str_set(clicon_handle h, 
-                      const char   *name, 
+clicon_option_str_set(clicon_handle h,
+                      const char   *name,
                       char         *val)
 {
     clicon_hash_t *copt = clicon_options(h);
 
-    return clicon_hash_add(copt, (char*)name, val, strlen(val)+1)==NULL?-1:0;
+    if (clicon_hash_add(copt, (char*)name, val, strlen(val)+1) == NULL)
+        return -1;
+    return clicon_optcache_update(h);
 }
 
 /*! Get options as integer but stored as string
@@ -727,7 +738,45 @@ clicon_option_del(clicon_handle h,
 {
     clicon_hash_t *copt = clicon_options(h);
 
-    return clicon_hash_del(copt, (char*)name);
+    if (clicon_hash_del(copt, (char*)name) < 0)
+        return -1;
+    return clicon_optcache_update(h);
+}
+
+/*! Repopulate the typed option snapshot from the options hash
+ *
+ * Runs at the end of clicon_options_main (the config file is loaded with
+ * direct hash writes) and after every option write, so the snapshot in the
+ * handle tracks the hash and per-operation readers get plain field accesses
+ * via clicon_optcache(). Missing options yield the same defaults as the
+ * corresponding access functions.
+ * @param[in] h  Clicon handle
+ * @retval    0  OK
+ */
+int
+clicon_optcache_update(clicon_handle h)
+{
+    clicon_option_cache *oc = clicon_optcache(h);
+    char                *s;
+
+    if ((s = clicon_option_str(h, "CLICON_DATASTORE_CACHE")) == NULL)
+        oc->oc_datastore_cache = DATASTORE_CACHE;
+    else
+        oc->oc_datastore_cache = clicon_str2int(datastore_cache_map, s);
+    if ((s = clicon_option_str(h, "CLICON_YANG_REGEXP")) == NULL)
+        oc->oc_yang_regexp = REGEXP_POSIX;
+    else
+        oc->oc_yang_regexp = clicon_str2int(yang_regexp_map, s);
+    if ((s = clicon_option_str(h, "CLICON_NACM_CREDENTIALS")) == NULL)
+        oc->oc_nacm_credentials = -1;
+    else
+        oc->oc_nacm_credentials = clicon_str2int(nacm_credentials_map, s);
+    if (clicon_option_exists(h, "CLICON_AUTOCOMMIT"))
+        oc->oc_autocommit = clicon_option_int(h, "CLICON_AUTOCOMMIT");
+    else
+        oc->oc_autocommit = 0;
+    oc->oc_netconf_base_capability = clicon_option_int(h, "CLICON_NETCONF_BASE_CAPABILITY");
+    return 0;
 }
 
 /*-----------------------------------------------------------------
@@ -801,12 +850,7 @@ clicon_sock_port(clicon_handle h)
 int
 clicon_autocommit(clicon_handle h)
 {
-    char const *opt = "CLICON_AUTOCOMMIT";
-
-    if (clicon_option_exists(h, opt))
-        return clicon_option_int(h, opt);
-    else
-        return 0;
+    return clicon_optcache(h)->oc_autocommit;
 }
 
 /*! Which method to boot/start clicon backend
@@ -858,11 +902,7 @@ clicon_restconf_privileges_mode(clicon_handle h)
 enum nacm_credentials_t
 clicon_nacm_credentials(clicon_handle h)
 {
-    char *mode;
-
-    if ((mode = clicon_option_str(h, "CLICON_NACM_CREDENTIALS")) == NULL)
-        return -1;
-    return clicon_str2int(nacm_credentials_map, mode);
+    return clicon_optcache(h)->oc_nacm_credentials;
 }
 
 /*! Which datastore cache method to use
@@ -873,12 +913,7 @@ clicon_nacm_credentials(clicon_handle h)
 enum datastore_cache
 clicon_datastore_cache(clicon_handle h)
 {
-    char *str;
-
-    if ((str = clicon_option_str(h, "CLICON_DATASTORE_CACHE")) == NULL)
-        return DATASTORE_CACHE;
-    else
-        return clicon_str2int(datastore_cache_map, str);
+    return clicon_optcache(h)->oc_datastore_cache;
 }
 
 /*! Which Yang regexp/pattern engine to use
@@ -889,12 +924,7 @@ clicon_datastore_cache(clicon_handle h)
 enum regexp_mode
 clicon_yang_regexp(clicon_handle h)
 {
-    char *str;
-
-    if ((str = clicon_option_str(h, "CLICON_YANG_REGEXP")) == NULL)
-        return REGEXP_POSIX;
-    else
-        return clicon_str2int(yang_regexp_map, str);
+    return clicon_optcache(h)->oc_yang_regexp;
 }
 
 /*---------------------------------------------------------------------
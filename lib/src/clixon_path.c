@@ -200,7 +200,7 @@ int
 clixon_path_free(clixon_path *cplist)
 {
     clixon_path *cp;
-    
+
     while ((cp = cplist) != NULL){
         DELQ(cp, cplist, clixon_path *);
         if (cp->cp_prefix)
@@ -214,6 +214,52 @@ clixon_path_free(clixon_path *cplist)
     return 0;
 }
 
+/*! Duplicate a clixon-path list
+ * Resolved yang pointers (cp_yang) are copied as-is.
+ * @param[in]  cplist  Clixon-path list
+ * @retval     new     Malloced copy, free with clixon_path_free
+ * @retval     NULL    Error
+ */
+static clixon_path *
+clixon_path_dup(clixon_path *cplist)
+{
+    clixon_path *new = NULL;
+    clixon_path *cp;
+    clixon_path *cpn;
+
+    if ((cp = cplist) != NULL){
+        do {
+            if ((cpn = calloc(1, sizeof(*cpn))) == NULL){
+                clicon_err(OE_UNIX, errno, "calloc");
+                goto err;
+            }
+            ADDQ(cpn, new);
+            if (cp->cp_prefix &&
+                (cpn->cp_prefix = strdup(cp->cp_prefix)) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto err;
+            }
+            if (cp->cp_id &&
+                (cpn->cp_id = strdup(cp->cp_id)) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto err;
+            }
+            if (cp->cp_cvk &&
+                (cpn->cp_cvk = cvec_dup(cp->cp_cvk)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_dup");
+                goto err;
+            }
+            cpn->cp_yang = cp->cp_yang;
+            cp = NEXTQ(clixon_path *, cp);
+        } while (cp && cp != cplist);
+    }
+    return new;
+ err:
+    if (new)
+        clixon_path_free(new);
+    return NULL;
+}
+
 /*! Print path on instance-id/xpath form
  */
 static int
@@ -822,6 +868,150 @@ api_path2xpath_cvv(cvec       *api_path,
     goto done;
 }
 
+/*
+ * Memoized api-path to xpath translation, see api_path2xpath()
+ * RESTCONF controllers tend to present the same few hundred URI templates over
+ * and over; cache the parsed and yang-resolved result keyed on the raw
+ * api-path string and the yang spec, with move-to-front order and eviction
+ * from the tail. The yang spec pointer is only an identity key and never
+ * dereferenced; entries of a freed spec are flushed from ys_free1().
+ */
+#define API_PATH_CACHE_MAX 128
+
+struct api_path_cache{
+    struct api_path_cache *ac_next;
+    char      *ac_api_path; /* Key: raw (URI-encoded) api-path string */
+    yang_stmt *ac_yspec;    /* Key: yang spec identity, never dereferenced */
+    char      *ac_xpath;    /* Cached xpath translation */
+    cvec      *ac_nsc;      /* Cached namespace context */
+};
+
+static struct api_path_cache *_api_path_cache = NULL; /* Most recently used first */
+static int                    _api_path_cache_len = 0;
+
+/*! Free a single api-path cache entry
+ */
+static int
+api_path_cache_entry_free(struct api_path_cache *ac)
+{
+    if (ac->ac_api_path)
+        free(ac->ac_api_path);
+    if (ac->ac_xpath)
+        free(ac->ac_xpath);
+    if (ac->ac_nsc)
+        xml_nsctx_free(ac->ac_nsc);
+    free(ac);
+    return 0;
+}
+
+/*! Flush api-path cache entries bound to a yang spec
+ * @param[in] yspec  Flush entries keyed on this spec, NULL for all
+ * @retval    0      OK
+ * @see ys_free1  which calls this when a spec is freed
+ */
+int
+api_path_cache_flush(yang_stmt *yspec)
+{
+    struct api_path_cache **prev = &_api_path_cache;
+    struct api_path_cache  *ac;
+
+    while ((ac = *prev) != NULL){
+        if (yspec == NULL || ac->ac_yspec == yspec){
+            *prev = ac->ac_next;
+            api_path_cache_entry_free(ac);
+            _api_path_cache_len--;
+        }
+        else
+            prev = &ac->ac_next;
+    }
+    return 0;
+}
+
+/*! Look up a cached api-path translation, copying out xpath and nsc on hit
+ * @param[in]  api_path  Raw api-path string
+ * @param[in]  yspec     Yang spec
+ * @param[out] xpathp    Cached xpath, malloced (on hit)
+ * @param[out] nsc       Cached namespace context, copied (on hit)
+ * @retval     1         Hit, xpathp and nsc set
+ * @retval     0         Miss
+ * @retval    -1         Error
+ */
+static int
+api_path_cache_lookup(char       *api_path,
+                      yang_stmt  *yspec,
+                      char      **xpathp,
+                      cvec      **nsc)
+{
+    struct api_path_cache **prev = &_api_path_cache;
+    struct api_path_cache  *ac;
+
+    while ((ac = *prev) != NULL){
+        if (ac->ac_yspec == yspec &&
+            strcmp(ac->ac_api_path, api_path) == 0)
+            break;
+        prev = &ac->ac_next;
+    }
+    if (ac == NULL)
+        return 0;
+    /* Move to front */
+    *prev = ac->ac_next;
+    ac->ac_next = _api_path_cache;
+    _api_path_cache = ac;
+    if ((*xpathp = strdup(ac->ac_xpath)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        return -1;
+    }
+    if ((*nsc = cvec_dup(ac->ac_nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_dup");
+        return -1;
+    }
+    return 1;
+}
+
+/*! Insert an api-path translation into the cache, evicting the oldest entry
+ * @param[in] api_path  Raw api-path string
+ * @param[in] yspec     Yang spec
+ * @param[in] xpath     Translated xpath (copied)
+ * @param[in] nsc       Namespace context of xpath (copied)
+ * @retval    0         OK
+ * @retval   -1         Error
+ */
+static int
+api_path_cache_insert(char      *api_path,
+                      yang_stmt *yspec,
+                      char      *xpath,
+                      cvec      *nsc)
+{
+    struct api_path_cache **prev;
+    struct api_path_cache  *ac;
+
+    if (_api_path_cache_len >= API_PATH_CACHE_MAX){
+        /* Evict least recently used: tail of list */
+        prev = &_api_path_cache;
+        while ((*prev)->ac_next != NULL)
+            prev = &(*prev)->ac_next;
+        api_path_cache_entry_free(*prev);
+        *prev = NULL;
+        _api_path_cache_len--;
+    }
+    if ((ac = calloc(1, sizeof(*ac))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    ac->ac_yspec = yspec;
+    if ((ac->ac_api_path = strdup(api_path)) == NULL ||
+        (ac->ac_xpath = strdup(xpath)) == NULL ||
+        (ac->ac_nsc = cvec_dup(nsc)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        api_path_cache_entry_free(ac);
+        return -1;
+    }
+    ac->ac_next = _api_path_cache;
+    _api_path_cache = ac;
+    _api_path_cache_len++;
+    return 0;
+}
+
 /*! Translate from restconf api-path to xml xpath and namespace
  * @param[in]  api_path  URI-encoded path expression" (RFC8040 3.5.3)
  * @param[in]  yspec     Yang spec
@@ -868,7 +1058,17 @@ api_path2xpath(char       *api_path,
             goto done;
         goto fail;
     }
-    /* Split api-path into cligen variable vector, 
+    /* Fast path: previously translated api-path. Only when the caller wants
+     * both outputs, so a cached entry always carries a complete result */
+    if (xpathp && nsc){
+        if ((ret = api_path_cache_lookup(api_path, yspec, xpathp, nsc)) < 0)
+            goto done;
+        if (ret == 1){
+            retval = 1;
+            goto done;
+        }
+    }
+    /* Split api-path into cligen variable vector,
      * dont decode since api_path2xpath_cvv takes uri encode as input */
     if (uri_str2cvec(api_path, '/', '=', 0, &cvv) < 0)
         goto done;
@@ -884,6 +1084,9 @@ api_path2xpath(char       *api_path,
             clicon_err(OE_UNIX, errno, "strdup");
             goto done;
         }
+    if (xpathp && nsc && *nsc &&
+        api_path_cache_insert(api_path, yspec, *xpathp, *nsc) < 0)
+        goto done;
     retval = 1;
  done:
     if (cvv)
@@ -1506,7 +1709,149 @@ instance_id_resolve(clixon_path *cplist,
     goto done;
 }
 
-/*! Search XML tree using (internal) Clixon path struct 
+/*
+ * Memoized instance-id parse and yang resolve, see instance_id_parse_cached()
+ * NACM data-node rule paths are fixed strings re-evaluated on every
+ * authorization decision; cache the parsed and yang-resolved clixon_path list
+ * keyed on the raw path string and the yang context, with move-to-front order
+ * and eviction from the tail, same scheme as the api-path cache above.
+ * The yang pointers are identity keys and never dereferenced; entries of a
+ * freed spec are flushed from ys_free1().
+ */
+#define INSTANCE_ID_CACHE_MAX 128
+
+struct instance_id_cache{
+    struct instance_id_cache *ic_next;
+    char        *ic_path;   /* Key: raw instance-id string */
+    yang_stmt   *ic_yt;     /* Key: yang context identity, never dereferenced */
+    yang_stmt   *ic_yspec;  /* Spec owning ic_yt, for flushing */
+    clixon_path *ic_cplist; /* Cached parsed and resolved path list */
+};
+
+static struct instance_id_cache *_instance_id_cache = NULL; /* Most recently used first */
+static int                       _instance_id_cache_len = 0;
+
+/*! Free a single instance-id cache entry
+ */
+static int
+instance_id_cache_entry_free(struct instance_id_cache *ic)
+{
+    if (ic->ic_path)
+        free(ic->ic_path);
+    if (ic->ic_cplist)
+        clixon_path_free(ic->ic_cplist);
+    free(ic);
+    return 0;
+}
+
+/*! Flush instance-id cache entries bound to a yang spec
+ * @param[in] yspec  Flush entries keyed on this spec, NULL for all
+ * @retval    0      OK
+ * @see ys_free1  which calls this when a spec is freed
+ */
+int
+instance_id_cache_flush(yang_stmt *yspec)
+{
+    struct instance_id_cache **prev = &_instance_id_cache;
+    struct instance_id_cache  *ic;
+
+    while ((ic = *prev) != NULL){
+        if (yspec == NULL || ic->ic_yspec == yspec){
+            *prev = ic->ic_next;
+            instance_id_cache_entry_free(ic);
+            _instance_id_cache_len--;
+        }
+        else
+            prev = &ic->ic_next;
+    }
+    return 0;
+}
+
+/*! Parse and yang-resolve an instance-id, via the cache
+ *
+ * Only successful resolutions are cached; the caller gets a private copy and
+ * may modify or free it independent of the cache.
+ * @param[in]  path     Instance-id string
+ * @param[in]  yt       Yang statement of top symbol (can be yang-spec if top-level)
+ * @param[out] cplistp  Parsed and resolved path list, free with clixon_path_free
+ * @retval     1        OK
+ * @retval     0        Resolve failed, clicon_err called
+ * @retval    -1        Error
+ */
+static int
+instance_id_parse_cached(char         *path,
+                         yang_stmt    *yt,
+                         clixon_path **cplistp)
+{
+    int                        retval = -1;
+    struct instance_id_cache **prev = &_instance_id_cache;
+    struct instance_id_cache  *ic;
+    clixon_path               *cplist = NULL;
+    int                        ret;
+
+    while ((ic = *prev) != NULL){
+        if (ic->ic_yt == yt &&
+            strcmp(ic->ic_path, path) == 0)
+            break;
+        prev = &ic->ic_next;
+    }
+    if (ic != NULL){
+        /* Move to front */
+        *prev = ic->ic_next;
+        ic->ic_next = _instance_id_cache;
+        _instance_id_cache = ic;
+        if ((*cplistp = clixon_path_dup(ic->ic_cplist)) == NULL)
+            goto done;
+        retval = 1;
+        goto done;
+    }
+    if (instance_id_parse(path, &cplist) < 0)
+        goto done;
+    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
+    if ((ret = instance_id_resolve(cplist, yt)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (_instance_id_cache_len >= INSTANCE_ID_CACHE_MAX){
+        /* Evict least recently used: tail of list */
+        prev = &_instance_id_cache;
+        while ((*prev)->ic_next != NULL)
+            prev = &(*prev)->ic_next;
+        instance_id_cache_entry_free(*prev);
+        *prev = NULL;
+        _instance_id_cache_len--;
+    }
+    if ((ic = calloc(1, sizeof(*ic))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    ic->ic_yt = yt;
+    ic->ic_yspec = ys_spec(yt);
+    if ((ic->ic_path = strdup(path)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        instance_id_cache_entry_free(ic);
+        goto done;
+    }
+    if ((ic->ic_cplist = clixon_path_dup(cplist)) == NULL){
+        instance_id_cache_entry_free(ic);
+        goto done;
+    }
+    ic->ic_next = _instance_id_cache;
+    _instance_id_cache = ic;
+    _instance_id_cache_len++;
+    *cplistp = cplist;
+    cplist = NULL;
+    retval = 1;
+ done:
+    if (cplist)
+        clixon_path_free(cplist);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Search XML tree using (internal) Clixon path struct
  *
  * @param[in]  xt       Top xml-tree where to search
  * @param[in]  yt       Yang statement of top symbol (can be yang-spec if top-level)
@@ -1735,15 +2080,12 @@ clixon_xml_find_instance_id(cxobj     *xt,
         goto done;
     }
     va_end(ap);
-    if (instance_id_parse(path, &cplist) < 0)
-        goto done;
-    if (clicon_debug_get())
-        clixon_path_print(stderr, cplist);
-    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
-    if ((ret = instance_id_resolve(cplist, yt)) < 0)
+    if ((ret = instance_id_parse_cached(path, yt, &cplist)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
+    if (clicon_debug_get())
+        clixon_path_print(stderr, cplist);
     if ((ret = clixon_path_search(xt, yt, cplist, &xv)) < 0)
         goto done;
     if (ret == 0)
@@ -1823,15 +2165,12 @@ clixon_instance_id_bind(yang_stmt  *yt,
         goto done;
     }
     va_end(ap);
-    if (instance_id_parse(path, &cplist) < 0)
-        goto done;
-    if (clicon_debug_get())
-        clixon_path_print(stderr, cplist);
-    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
-    if ((ret = instance_id_resolve(cplist, yt)) < 0)
+    if ((ret = instance_id_parse_cached(path, yt, &cplist)) < 0)
         goto done;
     if (ret == 0)
         goto fail;
+    if (clicon_debug_get())
+        clixon_path_print(stderr, cplist);
     /* Loop through prefixes used */
     if ((cp = cplist) != NULL){
         do {
@@ -1899,18 +2238,15 @@ clixon_instance_id_parse(yang_stmt    *yt,
         goto done;
     }
     va_end(ap);
-    if (instance_id_parse(path, &cplist) < 0)
-        goto done;
-    if (clicon_debug_get())
-        clixon_path_print(stderr, cplist);
-    /* Resolve module:name to pointer to yang-stmt, fail if not successful */
-    if ((ret = instance_id_resolve(cplist, yt)) < 0)
+    if ((ret = instance_id_parse_cached(path, yt, &cplist)) < 0)
         goto done;
     if (ret == 0){
         if (xerr && netconf_invalid_value_xml(xerr, "application", clicon_err_reason) < 0)
             goto done;
         goto fail;
     }
+    if (clicon_debug_get())
+        clixon_path_print(stderr, cplist);
     if (cplistp){
         *cplistp = cplist;
         cplist = NULL;
@@ -98,6 +98,13 @@
 #ifdef HAVE_SETNS /* linux network namespaces */
 #include <sched.h> /* setns / unshare */
 #endif
+/* posix_spawn process launch where available: no RSS-proportional page-table copy
+ * as with fork, which stalls large daemons for milliseconds per launch */
+#if defined(HAVE_SPAWN_H) && defined(HAVE_POSIX_SPAWN)
+#define PROC_USE_SPAWN
+#include <spawn.h>
+extern char **environ;
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -197,6 +204,33 @@ clixon_proc_socket(char **argv,
     sigprocmask(0, NULL, &oset);
     set_signal(SIGINT, clixon_proc_sigint, &oldhandler);
     sig++;
+#ifdef PROC_USE_SPAWN
+    {
+        posix_spawn_file_actions_t fa;
+        posix_spawnattr_t          attr;
+        sigset_t                   emptyset;
+        int                        err;
+
+        /* Pre-built file actions replace the child-side close/dup2 dance */
+        posix_spawn_file_actions_init(&fa);
+        posix_spawn_file_actions_addclose(&fa, sp[0]);
+        posix_spawn_file_actions_adddup2(&fa, sp[1], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&fa, sp[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&fa, sp[1]);
+        posix_spawnattr_init(&attr);
+        /* Unblock all signals in the child as the fork path did */
+        sigemptyset(&emptyset);
+        posix_spawnattr_setsigmask(&attr, &emptyset);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+        err = posix_spawnp(&child, argv[0], &fa, &attr, argv, environ);
+        posix_spawn_file_actions_destroy(&fa);
+        posix_spawnattr_destroy(&attr);
+        if (err != 0){
+            clicon_err(OE_UNIX, err, "posix_spawnp(%s)", argv[0]);
+            goto done;
+        }
+    }
+#else /* fork+exec fallback */
     if ((child = fork()) < 0) {
         clicon_err(OE_UNIX, errno, "fork");
         goto done;
@@ -217,14 +251,15 @@ clixon_proc_socket(char **argv,
             perror("dup2");
             return -1;
         }
-        close(sp[1]); 
-        
+        close(sp[1]);
+
         if (execvp(argv[0], argv) < 0){
             perror("execvp");
             return -1;
         }
         exit(-1);        /* Shouldnt reach here */
     }
+#endif /* PROC_USE_SPAWN */
     /* Parent */
     close(sp[1]);
     *pid = child;
@@ -299,6 +334,34 @@ clixon_proc_background(char       **argv,
     sigprocmask(0, NULL, &oset);
     set_signal(SIGINT, clixon_proc_sigint, &oldhandler);
     /* Now call done on error */
+#if defined(PROC_USE_SPAWN) && defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCHDIR_NP) && defined(HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP)
+    /* Joining a network namespace needs setns between fork and exec, so only the
+     * common netns-less launch goes through posix_spawn */
+    if (netns == NULL){
+        posix_spawn_file_actions_t fa;
+        posix_spawnattr_t          attr;
+        sigset_t                   emptyset;
+        int                        err;
+
+        /* Pre-built file actions replace the child-side chdir and close-all loop */
+        posix_spawn_file_actions_init(&fa);
+        posix_spawn_file_actions_addchdir_np(&fa, "/");
+        posix_spawn_file_actions_addclosefrom_np(&fa, 0);
+        posix_spawnattr_init(&attr);
+        /* Unblock all signals in the child as the fork path did */
+        sigemptyset(&emptyset);
+        posix_spawnattr_setsigmask(&attr, &emptyset);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+        err = posix_spawnp(&child, argv[0], &fa, &attr, argv, environ);
+        posix_spawn_file_actions_destroy(&fa);
+        posix_spawnattr_destroy(&attr);
+        if (err != 0){
+            child = -1;
+            clicon_err(OE_UNIX, err, "posix_spawnp(%s)", argv[0]);
+        }
+        goto done;
+    }
+#endif
     if ((child = fork()) < 0) {
         clicon_err(OE_UNIX, errno, "fork");
         goto done;
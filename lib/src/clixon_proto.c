@@ -58,6 +58,7 @@
 #include <sys/stat.h>
 #include <netinet/in.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <assert.h>
 
@@ -293,6 +294,60 @@ atomicio(ssize_t (*fn) (int, void *, size_t),
     return (pos);
 }
 
+/*! Write a full iovec scatter/gather array to a socket, loop until done
+ * As atomicio but for writev: header and body need not be contiguous.
+ * @param[in]  fd      File descriptor, eg socket
+ * @param[in]  iov     Scatter/gather vector, modified on partial writes
+ * @param[in]  iovcnt  Number of iov entries
+ * @retval     n       Total number of bytes written
+ * @retval     0       Peer closed
+ * @retval    -1       Error
+ * @see atomicio
+ */
+static ssize_t
+atomiciov(int           fd,
+          struct iovec *iov,
+          int           iovcnt)
+{
+    ssize_t res;
+    ssize_t pos = 0;
+    int     i = 0;
+
+    while (i < iovcnt) {
+        _atomicio_sig = 0;
+        res = writev(fd, &iov[i], iovcnt - i);
+        switch (res) {
+        case -1:
+            if (errno == EINTR){
+                if (!_atomicio_sig)
+                    continue;
+            }
+            else if (errno == EAGAIN)
+                continue;
+            else if (errno == ECONNRESET) /* Connection reset by peer */
+                res = 0;
+            else if (errno == EPIPE)     /* Client shutdown */
+                res = 0;
+            else if (errno == EBADF)     /* client shutdown - freebsd */
+                res = 0;
+        case 0: /* fall thru */
+            return (res);
+        default:
+            pos += res;
+            /* Advance iov past fully written entries, adjust a partial one */
+            while (i < iovcnt && res >= (ssize_t)iov[i].iov_len){
+                res -= iov[i].iov_len;
+                i++;
+            }
+            if (i < iovcnt && res > 0){
+                iov[i].iov_base = (char*)iov[i].iov_base + res;
+                iov[i].iov_len -= res;
+            }
+        }
+    }
+    return (pos);
+}
+
 #if 0 // Extra debug
 /*! Print message on debug. Log if syslog, stderr if not
  * @param[in]  msg    CLICON msg
@@ -365,6 +420,104 @@ clicon_msg_send(int                s,
     return retval;
 }
 
+/*! Send a CLICON netconf message from a cbuf body, without building a frame
+ *
+ * The fixed header is assembled on the stack and sent together with the cbuf
+ * body (and its NUL terminator) in one writev, so no contiguous message
+ * allocation and copy is needed, see clicon_msg_encode.
+ * @param[in]   s      socket (unix or inet) to communicate with backend
+ * @param[in]   id     Session id of client
+ * @param[in]   cb     Message body
+ * @retval      0      OK
+ * @retval     -1      Error
+ * @see clicon_msg_send  For a pre-encoded contiguous message
+ */
+int
+clicon_msg_send_cbuf(int      s,
+                     uint32_t id,
+                     cbuf    *cb)
+{
+    int               retval = -1;
+    struct clicon_msg hdr = {0,};
+    struct iovec      iov[2];
+    int               e;
+
+    hdr.op_len = htonl(sizeof(hdr) + cbuf_len(cb) + 1);
+    hdr.op_id = htonl(id);
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: send msg len=%d",
+                 __FUNCTION__, (int)(sizeof(hdr) + cbuf_len(cb) + 1));
+    clicon_debug(CLIXON_DBG_MSG, "Send: %s", cbuf_get(cb));
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = cbuf_get(cb);
+    iov[1].iov_len = cbuf_len(cb) + 1; /* Body is NUL-terminated on the wire */
+    if (atomiciov(s, iov, 2) < 0){
+        e = errno;
+        clicon_err(OE_CFG, e, "atomiciov");
+        clicon_log(LOG_WARNING, "%s: writev: %s len:%u", __FUNCTION__,
+                   strerror(e), (unsigned)(sizeof(hdr) + cbuf_len(cb) + 1));
+        goto done;
+    }
+    retval = 0;
+  done:
+    return retval;
+}
+
+/*! Send a message body as a sequence of fixed-size chunked segments
+ *
+ * Each segment gets its own header assembled on the stack and is written
+ * together with its body slice in one writev, so no contiguous frame of the
+ * full message is ever built; bodies up to CLICON_MSG_CHUNK_SIZE go out as a
+ * single plain message. All but the last segment have CLICON_MSG_FLAG_MORE
+ * set and the receiver reassembles them, see clicon_msg_rcv.
+ * @param[in]   s       socket (unix or inet) to communicate with peer
+ * @param[in]   id      Session id
+ * @param[in]   data    Message body (including NUL terminator)
+ * @param[in]   datalen Length of body
+ * @retval      0       OK
+ * @retval     -1       Error
+ * @see clicon_msg_send_cbuf  single writev for one-segment messages
+ */
+int
+clicon_msg_send_chunked(int      s,
+                        uint32_t id,
+                        char    *data,
+                        uint32_t datalen)
+{
+    int               retval = -1;
+    struct clicon_msg hdr = {0,};
+    struct iovec      iov[2];
+    uint32_t          off = 0;
+    uint32_t          seg;
+    int               e;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: send msg len=%u",
+                 __FUNCTION__, (unsigned)(sizeof(hdr) + datalen));
+    hdr.op_id = htonl(id);
+    do {
+        seg = datalen - off;
+        if (seg > CLICON_MSG_CHUNK_SIZE)
+            seg = CLICON_MSG_CHUNK_SIZE;
+        hdr.op_len = htonl((uint32_t)(sizeof(hdr) + seg) |
+                           (off + seg < datalen ? CLICON_MSG_FLAG_MORE : 0));
+        iov[0].iov_base = &hdr;
+        iov[0].iov_len = sizeof(hdr);
+        iov[1].iov_base = data + off;
+        iov[1].iov_len = seg;
+        if (atomiciov(s, iov, 2) < 0){
+            e = errno;
+            clicon_err(OE_CFG, e, "atomiciov");
+            clicon_log(LOG_WARNING, "%s: writev: %s len:%u", __FUNCTION__,
+                       strerror(e), (unsigned)(sizeof(hdr) + seg));
+            goto done;
+        }
+        off += seg;
+    } while (off < datalen);
+    retval = 0;
+  done:
+    return retval;
+}
+
 /*! Receive a CLICON message using IPC message struct
  *
  * XXX: timeout? and signals?
@@ -392,6 +545,7 @@ clicon_msg_rcv(int                s,
     ssize_t   len2;
     sigfn_t   oldhandler;
     uint32_t  mlen;
+    int       more;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     *eof = 0;
@@ -411,15 +565,20 @@ clicon_msg_rcv(int                s,
         clicon_err(OE_CFG, errno, "header too short (%d)", hlen);
         goto done;
     }
-    mlen = ntohl(hdr.op_len);
-    clicon_debug(CLIXON_DBG_DETAIL, "%s: rcv msg len=%d",  
+    more = (ntohl(hdr.op_len) & CLICON_MSG_FLAG_MORE) != 0;
+    mlen = ntohl(hdr.op_len) & CLICON_MSG_LEN_MASK;
+    clicon_debug(CLIXON_DBG_DETAIL, "%s: rcv msg len=%d",
                  __FUNCTION__, mlen);
+    if (mlen < sizeof(hdr)){
+        clicon_err(OE_CFG, EINVAL, "message length too short (%u)", mlen);
+        goto done;
+    }
     if ((*msg = (struct clicon_msg *)malloc(mlen)) == NULL){
         clicon_err(OE_CFG, errno, "malloc");
         goto done;
     }
     memcpy(*msg, &hdr, hlen);
-    if ((len2 = atomicio(read, s, (*msg)->op_body, mlen - sizeof(hdr))) < 0){ 
+    if ((len2 = atomicio(read, s, (*msg)->op_body, mlen - sizeof(hdr))) < 0){
         clicon_err(OE_CFG, errno, "read");
         goto done;
     }
@@ -427,6 +586,45 @@ clicon_msg_rcv(int                s,
         clicon_err(OE_CFG, errno, "body too short");
         goto done;
     }
+    /* Chunked framing: append follow-up segment bodies until a segment
+     * without the more-flag, see clicon_msg_send_chunked
+     */
+    while (more){
+        struct clicon_msg  shdr;
+        struct clicon_msg *tmp;
+        uint32_t           slen;
+
+        if ((hlen = atomicio(read, s, &shdr, sizeof(shdr))) < 0){
+            clicon_err(OE_CFG, errno, "atomicio");
+            goto done;
+        }
+        if (hlen != sizeof(shdr)){
+            clicon_err(OE_CFG, EINVAL, "truncated chunked message");
+            goto done;
+        }
+        more = (ntohl(shdr.op_len) & CLICON_MSG_FLAG_MORE) != 0;
+        slen = ntohl(shdr.op_len) & CLICON_MSG_LEN_MASK;
+        if (slen < sizeof(shdr)){
+            clicon_err(OE_CFG, EINVAL, "segment length too short (%u)", slen);
+            goto done;
+        }
+        slen -= sizeof(shdr);
+        if ((tmp = realloc(*msg, mlen + slen)) == NULL){
+            clicon_err(OE_CFG, errno, "realloc");
+            goto done;
+        }
+        *msg = tmp;
+        if ((len2 = atomicio(read, s, (char*)*msg + mlen, slen)) < 0){
+            clicon_err(OE_CFG, errno, "read");
+            goto done;
+        }
+        if (len2 != slen){
+            clicon_err(OE_CFG, errno, "body too short");
+            goto done;
+        }
+        mlen += slen;
+        (*msg)->op_len = htonl(mlen);
+    }
 #if 0 // Extra debug
     msg_dump(CLIXON_DBG_EXTRA, *msg);
 #endif
@@ -652,11 +850,18 @@ clicon_rpc(int                sock,
     if (*eof)
         goto ok;
     data = reply->op_body; /* assume string */
-    if (ret && data)
-        if ((*ret = strdup(data)) == NULL){
-            clicon_err(OE_UNIX, errno, "strdup");
-            goto done;
-        }
+    if (ret && data){
+        /* Hand the reply allocation itself to the caller instead of strdup:ing
+         * the body, which for a large get-config reply would mean a second
+         * multi-MB allocation and copy. The body is moved over the fixed
+         * header so the returned pointer can be free:d as usual.
+         */
+        uint32_t blen = ntohl(reply->op_len) - sizeof(*reply);
+
+        memmove(reply, data, blen);
+        *ret = (char*)reply;
+        reply = NULL;
+    }
  ok:
     retval = 0;
   done:
@@ -666,9 +871,242 @@ clicon_rpc(int                sock,
     return retval;
 }
 
+/*! Send a clicon_msg message from a cbuf body and wait for result.
+ *
+ * As clicon_rpc but the request is sent directly from the cbuf with writev,
+ * no contiguous message is encoded, see clicon_msg_send_cbuf.
+ * @param[in]  sock    Socket / file descriptor
+ * @param[in]  id      Session id of client
+ * @param[in]  cb      Message body
+ * @param[out] ret     Returned data as netconf xml string, free with free
+ * @param[out] eof     Set if eof encountered
+ * @retval     0       OK (check eof)
+ * @retval    -1       Error
+ * @see clicon_rpc  For a pre-encoded contiguous message
+ */
+int
+clicon_rpc_cbuf(int       sock,
+              uint32_t  id,
+              cbuf     *cb,
+              char    **ret,
+              int      *eof)
+{
+    int                retval = -1;
+    struct clicon_msg *reply = NULL;
+    char              *data = NULL;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (clicon_msg_send_cbuf(sock, id, cb) < 0)
+        goto done;
+    if (clicon_msg_rcv(sock, &reply, eof) < 0)
+        goto done;
+    if (*eof)
+        goto ok;
+    data = reply->op_body; /* assume string */
+    if (ret && data){
+        /* Hand the reply allocation itself to the caller, see clicon_rpc */
+        uint32_t blen = ntohl(reply->op_len) - sizeof(*reply);
+
+        memmove(reply, data, blen);
+        *ret = (char*)reply;
+        reply = NULL;
+    }
+ ok:
+    retval = 0;
+  done:
+    clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+/* Pending asynchronous rpc, see clicon_rpc_async.
+ * Kept in a single FIFO across sockets: the internal protocol sends replies
+ * in request order per socket, so the first pending request of a socket
+ * matches the next reply on it.
+ */
+struct rpc_async_req{
+    struct rpc_async_req *ar_next;
+    int                   ar_sock;   /* Socket the request was sent on */
+    clicon_rpc_async_cb  *ar_cb;     /* Completion callback */
+    void                 *ar_arg;    /* Callback argument */
+    int                   ar_timeout;/* Timeout in seconds, 0: none */
+};
+static struct rpc_async_req *_rpc_async_reqs = NULL;
+
+static int clicon_rpc_async_timeout(int fd, void *arg);
+
+/*! Unlink a pending async request from the FIFO
+ * @param[in]  req   Request to unlink
+ * @retval     nr    Number of remaining pending requests on the same socket
+ */
+static int
+rpc_async_unlink(struct rpc_async_req *req)
+{
+    struct rpc_async_req **prev = &_rpc_async_reqs;
+    struct rpc_async_req  *ar;
+    int                    nr = 0;
+
+    while ((ar = *prev) != NULL){
+        if (ar == req)
+            *prev = ar->ar_next;
+        else{
+            if (ar->ar_sock == req->ar_sock)
+                nr++;
+            prev = &ar->ar_next;
+        }
+    }
+    return nr;
+}
+
+/*! Event callback: a reply to an asynchronous rpc is readable on s
+ */
+static int
+clicon_rpc_async_input(int   s,
+                       void *arg)
+{
+    int                   retval = -1;
+    struct rpc_async_req *req = NULL;
+    struct rpc_async_req *ar;
+    struct clicon_msg    *reply = NULL;
+    char                 *ret = NULL;
+    int                   eof = 0;
+
+    /* First pending request on this socket matches the reply (FIFO) */
+    for (ar = _rpc_async_reqs; ar; ar = ar->ar_next)
+        if (ar->ar_sock == s){
+            req = ar;
+            break;
+        }
+    if (req == NULL){
+        /* Spurious input with no pending request: unregister */
+        clixon_event_unreg_fd(s, clicon_rpc_async_input);
+        goto ok;
+    }
+    if (req->ar_timeout)
+        clixon_event_unreg_timeout(clicon_rpc_async_timeout, req);
+    if (rpc_async_unlink(req) == 0)
+        clixon_event_unreg_fd(s, clicon_rpc_async_input);
+    if (clicon_msg_rcv(s, &reply, &eof) < 0){
+        (*req->ar_cb)(s, NULL, 1, req->ar_arg);
+        goto done;
+    }
+    if (!eof && reply){
+        /* Hand the reply allocation itself to the callback, see clicon_rpc */
+        uint32_t blen = ntohl(reply->op_len) - sizeof(*reply);
+
+        memmove(reply, reply->op_body, blen);
+        ret = (char*)reply;
+        reply = NULL;
+    }
+    if ((*req->ar_cb)(s, ret, eof, req->ar_arg) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (req)
+        free(req);
+    if (reply)
+        free(reply);
+    return retval;
+}
+
+/*! Event callback: an asynchronous rpc has not been answered in time
+ *
+ * The callback is invoked with ret NULL and eof 0 to indicate timeout. The
+ * socket is left to the caller: a late reply would be mismatched to a later
+ * request, so the caller should close it.
+ */
+static int
+clicon_rpc_async_timeout(int   fd,
+                         void *arg)
+{
+    struct rpc_async_req *req = (struct rpc_async_req *)arg;
+    int                   retval;
+
+    clicon_debug(1, "%s sock:%d", __FUNCTION__, req->ar_sock);
+    if (rpc_async_unlink(req) == 0)
+        clixon_event_unreg_fd(req->ar_sock, clicon_rpc_async_input);
+    retval = (*req->ar_cb)(req->ar_sock, NULL, 0, req->ar_arg);
+    free(req);
+    return retval;
+}
+
+/*! Send a clicon_msg message, invoke callback when the reply arrives
+ *
+ * Non-blocking variant of clicon_rpc for single-threaded clients using the
+ * clixon event loop: the request is sent immediately and the socket is
+ * registered with the event system, so many rpcs can be in flight, to one
+ * backend (replies are delivered in request order per socket) and to many.
+ * The callback is invoked exactly once with:
+ * - the reply as a malloced string (free with free), eof 0: normal reply
+ * - ret NULL, eof 1: peer closed the socket (or receive error)
+ * - ret NULL, eof 0: timeout, caller should close the socket since a late
+ *   reply would mismatch later requests
+ * @param[in]  sock    Socket / file descriptor
+ * @param[in]  msg     CLICON msg data structure. It has fixed header and variable body.
+ * @param[in]  timeout Timeout in seconds, 0: no timeout
+ * @param[in]  cb      Completion callback
+ * @param[in]  arg     Callback argument
+ * @retval     0       OK, callback will be invoked from the event loop
+ * @retval    -1       Error (callback will not be invoked)
+ * @see clicon_rpc  blocking variant
+ */
+int
+clicon_rpc_async(int                  sock,
+                 struct clicon_msg   *msg,
+                 int                  timeout,
+                 clicon_rpc_async_cb *cb,
+                 void                *arg)
+{
+    int                    retval = -1;
+    struct rpc_async_req  *req = NULL;
+    struct rpc_async_req **prev;
+    int                    first = 1;
+    struct timeval         t;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (cb == NULL){
+        clicon_err(OE_PROTO, EINVAL, "cb is NULL");
+        goto done;
+    }
+    if (clicon_msg_send(sock, msg) < 0)
+        goto done;
+    if ((req = malloc(sizeof(*req))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(req, 0, sizeof(*req));
+    req->ar_sock = sock;
+    req->ar_cb = cb;
+    req->ar_arg = arg;
+    req->ar_timeout = timeout;
+    /* Append to FIFO tail, note if this socket already has pending requests */
+    prev = &_rpc_async_reqs;
+    while (*prev != NULL){
+        if ((*prev)->ar_sock == sock)
+            first = 0;
+        prev = &(*prev)->ar_next;
+    }
+    *prev = req;
+    if (first &&
+        clixon_event_reg_fd(sock, clicon_rpc_async_input, NULL, "async rpc reply") < 0)
+        goto done;
+    if (timeout){
+        gettimeofday(&t, NULL);
+        t.tv_sec += timeout;
+        if (clixon_event_reg_timeout(t, clicon_rpc_async_timeout, req, "async rpc timeout") < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    clicon_debug(CLIXON_DBG_DETAIL, "%s retval:%d", __FUNCTION__, retval);
+    return retval;
+}
+
 /*! Send a netconf message and recieve result using plain NETCONF
  *
- * This is mainly used by the client API. 
+ * This is mainly used by the client API.
  *
  * @param[in]  sock    Socket / file descriptor
  * @param[in]  msgin   CLICON msg data structure. It has fixed header and variable body.
@@ -703,35 +1141,20 @@ clicon_rpc1(int   sock,
 
 /*! Send a clicon_msg message as reply to a clicon rpc request
  *
+ * Sent directly from the caller buffer in chunked segments: no contiguous
+ * reply frame is allocated, see clicon_msg_send_chunked.
  * @param[in]  s       Socket to communicate with client
  * @param[in]  data    Returned data as byte-string.
  * @param[in]  datalen Length of returned data XXX  may be unecessary if always string?
  * @retval     0       OK
  * @retval     -1      Error
  */
-int 
-send_msg_reply(int      s, 
-               char    *data, 
+int
+send_msg_reply(int      s,
+               char    *data,
                uint32_t datalen)
 {
-    int                retval = -1;
-    struct clicon_msg *reply = NULL;
-    uint32_t           len;
-
-    len = sizeof(*reply) + datalen;
-    if ((reply = (struct clicon_msg *)malloc(len)) == NULL)
-        goto done;
-    memset(reply, 0, len);
-    reply->op_len = htonl(len);
-    if (datalen > 0)
-      memcpy(reply->op_body, data, datalen);
-    if (clicon_msg_send(s, reply) < 0)
-        goto done;
-    retval = 0;
-  done:
-    if (reply)
-        free(reply);
-    return retval;
+    return clicon_msg_send_chunked(s, 0, data, datalen);
 }
 
 /*! Send a clicon_msg NOTIFY message asynchronously to client
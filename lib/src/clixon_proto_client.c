@@ -81,12 +81,91 @@
 #include "clixon_xml_sort.h"
 #include "clixon_xml_io.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_rpc_stats.h"
 #include "clixon_proto_client.h"
 
 #define PERSIST_ID_XML_FMT "<persist-id>%s</persist-id>"
 #define PERSIST_XML_FMT "<persist>%s</persist>"
 #define TIMEOUT_XML_FMT "<confirm-timeout>%u</confirm-timeout>"
 
+/*! Append the cl:trace attribute to an rpc header if a trace is active
+ *
+ * Called right after the cl:username attribute so the xmlns:cl declaration
+ * that follows covers it. The backend picks the attribute up in
+ * from_client_msg and joins its span logs to the same trace id.
+ * @param[in]  h    Clixon handle
+ * @param[out] cb   Message body under construction
+ * @see clixon_trace_start
+ */
+static void
+trace_attr_cbuf(clicon_handle h,
+                cbuf         *cb)
+{
+    char ctx[32];
+
+    if (clixon_trace_context(h, ctx, sizeof(ctx)) > 0)
+        cprintf(cb, " %s:trace=\"%s\"", CLIXON_LIB_PREFIX, ctx);
+}
+
+/* Handle key for in-process rpc dispatcher, see clicon_rpc_dispatch_register */
+#define RPC_DISPATCH_PTR "rpc-dispatch"
+
+/* In-process rpc dispatcher registered on the handle */
+struct rpc_dispatch{
+    clicon_rpc_dispatch_cb rd_fn;   /* Dispatch function */
+    void                  *rd_arg;  /* Dispatch argument, eg server-side session state */
+};
+
+/*! Register an in-process rpc dispatch function, short-circuiting the backend socket
+ *
+ * When a dispatcher is registered on a handle, rpc:s sent with the clicon_rpc_msg
+ * family of functions are handed to fn as direct function calls instead of being
+ * sent over the CLICON_SOCK IPC socket. This is for frontends co-located in the
+ * backend process (eg backend plugins issuing rpc:s): the serialize-socket-parse
+ * round-trip is skipped, and such calls would otherwise deadlock the
+ * single-threaded backend waiting for its own reply.
+ * Notification (persistent) sockets are not dispatched, see clicon_rpc_msg_persistent.
+ * @param[in]  h    Clixon handle
+ * @param[in]  fn   Dispatch function, NULL to deregister
+ * @param[in]  arg  Argument passed to fn
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+clicon_rpc_dispatch_register(clicon_handle          h,
+                             clicon_rpc_dispatch_cb fn,
+                             void                  *arg)
+{
+    int                  retval = -1;
+    struct rpc_dispatch *rd = NULL;
+
+    clicon_ptr_get(h, RPC_DISPATCH_PTR, (void**)&rd);
+    if (fn == NULL){ /* deregister */
+        if (rd){
+            free(rd);
+            clicon_ptr_del(h, RPC_DISPATCH_PTR);
+        }
+        goto ok;
+    }
+    if (rd == NULL){
+        if ((rd = malloc(sizeof(*rd))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(rd, 0, sizeof(*rd));
+        if (clicon_ptr_set(h, RPC_DISPATCH_PTR, rd) < 0){
+            free(rd);
+            goto done;
+        }
+    }
+    rd->rd_fn = fn;
+    rd->rd_arg = arg;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Connect to internal netconf socket
  *
  * @param[in]  h     Clixon handle
@@ -136,32 +215,113 @@ clicon_rpc_connect(clicon_handle h,
  done:
     return retval;
 }
-    
+
+/*! Probe backend liveness with a header-only ping, no XML involved
+ *
+ * Sends CLICON_MSG_PING_BODY which the backend answers before any XML
+ * parsing, see from_client(), so frequent health-check probes (load balancers,
+ * keepalive pollers) do not cost a NETCONF parse/serialize per probe.
+ * Unreachability is a result, not an error, so no clicon_err on retval 0.
+ * @param[in]  h   Clixon handle
+ * @retval     1   Backend alive (pong received)
+ * @retval     0   Backend unreachable or gave unexpected answer
+ * @retval    -1   Local error
+ */
+int
+clicon_rpc_ping(clicon_handle h)
+{
+    int                  retval = -1;
+    struct clicon_msg   *msg = NULL;
+    char                *retdata = NULL;
+    struct rpc_dispatch *rd = NULL;
+    int                  s;
+    int                  eof = 0;
+
+    /* In-process dispatch: the backend runs in this process, trivially alive */
+    clicon_ptr_get(h, RPC_DISPATCH_PTR, (void**)&rd);
+    if (rd != NULL)
+        goto alive;
+    if ((s = clicon_client_socket_get(h)) < 0){
+        if (clicon_rpc_connect(h, &s) < 0)
+            goto dead;
+        clicon_client_socket_set(h, s);
+    }
+    if ((msg = clicon_msg_encode(0, "%s", CLICON_MSG_PING_BODY)) == NULL)
+        goto done;
+    if (clicon_rpc(s, msg, &retdata, &eof) < 0 || eof){
+        close(s);
+        clicon_client_socket_set(h, -1);
+        goto dead;
+    }
+    if (retdata == NULL || strcmp(retdata, CLICON_MSG_PONG_BODY) != 0)
+        goto dead;
+ alive:
+    retval = 1;
+ done:
+    if (retdata)
+        free(retdata);
+    if (msg)
+        free(msg);
+    return retval;
+ dead:
+    retval = 0;
+    goto done;
+}
+
 /*! Connect to backend or use cached socket and send RPC
  *
- * @param[in]  h     Clixon handle
- * @param[in]  msg   Encoded message
- * @param[out] xret  Returned data as netconf xml tree.
- * @param[out] eof   Set if eof encountered
- * @retval     0     OK
- * @retval    -1     Error
+ * The request is either a pre-encoded msg or a (session_id, cb) body pair
+ * sent without encoding, see clicon_rpc_cbuf. Exactly one of msg and cb is set.
+ * @param[in]  h          Clixon handle
+ * @param[in]  msg        Encoded message (or NULL if cb is set)
+ * @param[in]  session_id Session id, only if cb is set
+ * @param[in]  cb         Message body (or NULL if msg is set)
+ * @param[out] xret       Returned data as netconf xml tree.
+ * @param[out] eof        Set if eof encountered
+ * @retval     0          OK
+ * @retval    -1          Error
  */
 static int
 clicon_rpc_msg_once(clicon_handle      h,
-                    struct clicon_msg *msg, 
+                    struct clicon_msg *msg,
+                    uint32_t           session_id,
+                    cbuf              *cb,
                     char             **retdata,
                     int               *eof,
                     int               *sp)
 {
-    int retval = -1;
-    int s;
-    
+    int                  retval = -1;
+    int                  s;
+    int                  ret;
+    struct rpc_dispatch *rd = NULL;
+    struct clicon_msg   *msg1 = NULL;
+
+    /* In-process short-circuit: hand the request directly to a registered
+     * dispatcher (eg from_client_msg in the backend) instead of the IPC socket
+     */
+    clicon_ptr_get(h, RPC_DISPATCH_PTR, (void**)&rd);
+    if (rd != NULL){
+        if (msg == NULL){
+            if ((msg1 = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+                goto done;
+            msg = msg1;
+        }
+        if (rd->rd_fn(h, msg, rd->rd_arg, retdata) < 0)
+            goto done;
+        *eof = 0;
+        retval = 0;
+        goto done;
+    }
     if ((s = clicon_client_socket_get(h)) < 0){
         if (clicon_rpc_connect(h, &s) < 0)
             goto done;
         clicon_client_socket_set(h, s);
     }
-    if (clicon_rpc(s, msg, retdata, eof) < 0){
+    if (cb)
+        ret = clicon_rpc_cbuf(s, session_id, cb, retdata, eof);
+    else
+        ret = clicon_rpc(s, msg, retdata, eof);
+    if (ret < 0){
         /* 2. check socket shutdown AFTER rpc */
         close(s);
         s = -1;
@@ -172,38 +332,43 @@ clicon_rpc_msg_once(clicon_handle      h,
         *sp = s;
     retval = 0;
  done:
+    if (msg1)
+        free(msg1);
     return retval;
 }
 
-/*! Send internal netconf rpc from client to backend
+/*! Send internal netconf rpc from client to backend, return raw reply string
  *
- * @param[in]    h      CLICON handle
- * @param[in]    msg    Encoded message. Deallocate with free
- * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
- * @retval       0      OK
- * @retval      -1      Error
- * @note xret is populated with yangspec according to standard handle yangspec
+ * The request is either a pre-encoded msg or a (session_id, cb) body pair,
+ * see clicon_rpc_msg_once. Exactly one of msg and cb is set.
+ * The reply is returned unparsed, see clicon_rpc_msg_common for the common
+ * parse-to-tree case.
+ * @param[in]    h          CLICON handle
+ * @param[in]    msg        Encoded message (or NULL if cb is set)
+ * @param[in]    session_id Session id, only if cb is set
+ * @param[in]    cb         Message body (or NULL if msg is set)
+ * @param[out]   retdata    Reply data as malloc:ed string, free by caller
+ * @retval       0          OK
+ * @retval      -1          Error
  * @note side-effect, a socket created here is cached
- * @see clicon_rpc_msg_persistent
- * @see clicon_rpc_close_session
  */
-int
-clicon_rpc_msg(clicon_handle      h, 
-               struct clicon_msg *msg, 
-               cxobj            **xret0)
+static int
+clicon_rpc_msg_data(clicon_handle      h,
+                    struct clicon_msg *msg,
+                    uint32_t           session_id,
+                    cbuf              *cb,
+                    char             **retdata)
 {
     int     retval = -1;
-    char   *retdata = NULL;
-    cxobj  *xret = NULL;
     int     s = -1;
     int     eof = 0;
 
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
 #ifdef RPC_USERNAME_ASSERT
-    assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
+    assert(strstr(msg?msg->op_body:cbuf_get(cb), "username")!=NULL); /* XXX */
 #endif
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, session_id, cb, retdata, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -212,7 +377,7 @@ clicon_rpc_msg(clicon_handle      h,
         clicon_client_socket_set(h, -1);
 #ifdef PROTO_RESTART_RECONNECT
         if (!clixon_exit_get()) { /* May be part of termination */
-            if (clicon_rpc_msg_once(h, msg, &retdata, &eof, NULL) < 0)
+            if (clicon_rpc_msg_once(h, msg, session_id, cb, retdata, &eof, NULL) < 0)
                 goto done;
             if (eof){
                 close(s);
@@ -232,7 +397,41 @@ clicon_rpc_msg(clicon_handle      h,
         goto done;
 #endif
     }
+    retval = 0;
+ done:
+    clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
+    return retval;
+}
+
+/*! Send internal netconf rpc from client to backend, worker function
+ *
+ * The request is either a pre-encoded msg or a (session_id, cb) body pair,
+ * see clicon_rpc_msg_once. Exactly one of msg and cb is set.
+ * @param[in]    h          CLICON handle
+ * @param[in]    msg        Encoded message (or NULL if cb is set)
+ * @param[in]    session_id Session id, only if cb is set
+ * @param[in]    cb         Message body (or NULL if msg is set)
+ * @param[out]   xret0      Return value from backend as xml tree. Free w xml_free
+ * @retval       0          OK
+ * @retval      -1          Error
+ * @note xret is populated with yangspec according to standard handle yangspec
+ * @note side-effect, a socket created here is cached
+ * @see clicon_rpc_msg_persistent
+ * @see clicon_rpc_close_session
+ */
+static int
+clicon_rpc_msg_common(clicon_handle      h,
+                      struct clicon_msg *msg,
+                      uint32_t           session_id,
+                      cbuf              *cb,
+                      cxobj            **xret0)
+{
+    int     retval = -1;
+    char   *retdata = NULL;
+    cxobj  *xret = NULL;
 
+    if (clicon_rpc_msg_data(h, msg, session_id, cb, &retdata) < 0)
+        goto done;
     if (retdata){
         /* Cannot populate xret here because need to know RPC name (eg "lock") in order to associate yang
          * to reply.
@@ -254,6 +453,97 @@ clicon_rpc_msg(clicon_handle      h,
     return retval;
 }
 
+/*! Send internal netconf rpc from client to backend
+ *
+ * @param[in]    h      CLICON handle
+ * @param[in]    msg    Encoded message. Deallocate with free
+ * @param[out]   xret0  Return value from backend as xml tree. Free w xml_free
+ * @retval       0      OK
+ * @retval      -1      Error
+ * @note xret is populated with yangspec according to standard handle yangspec
+ * @note side-effect, a socket created here is cached
+ * @see clicon_rpc_msg_cbuf for sending a cbuf body without an encode step
+ * @see clicon_rpc_msg_persistent
+ * @see clicon_rpc_close_session
+ */
+int
+clicon_rpc_msg(clicon_handle      h,
+               struct clicon_msg *msg,
+               cxobj            **xret0)
+{
+    return clicon_rpc_msg_common(h, msg, 0, NULL, xret0);
+}
+
+/*! Send internal netconf rpc from client to backend, body as cbuf
+ *
+ * Same as clicon_rpc_msg but the message body is sent directly from cb,
+ * see clicon_msg_send_cbuf, saving a contiguous encode allocation and copy
+ * per request.
+ * @param[in]    h          CLICON handle
+ * @param[in]    session_id Session id sent in message header
+ * @param[in]    cb         Message body
+ * @param[out]   xret0      Return value from backend as xml tree. Free w xml_free
+ * @retval       0          OK
+ * @retval      -1          Error
+ * @see clicon_rpc_msg
+ */
+int
+clicon_rpc_msg_cbuf(clicon_handle h,
+                  uint32_t      session_id,
+                  cbuf         *cb,
+                  cxobj       **xret0)
+{
+    return clicon_rpc_msg_common(h, NULL, session_id, cb, xret0);
+}
+
+/*! Get a message buffer for an rpc request, recycled on the handle if possible
+ *
+ * A single buffer is cached on the handle and reused across requests so that
+ * it keeps its high-water allocation instead of being reallocated from
+ * CLIGEN_BUF_START for every rpc. Return it with clicon_msg_cbuf_release.
+ * @param[in]  h   Clixon handle
+ * @retval     cb  Empty message buffer
+ * @retval     NULL Error
+ * @see clicon_msg_cbuf_release
+ */
+cbuf *
+clicon_msg_cbuf_get(clicon_handle h)
+{
+    cbuf *cb = NULL;
+
+    clicon_ptr_get(h, "proto-msg-cbuf", (void**)&cb);
+    if (cb != NULL){
+        clicon_ptr_del(h, "proto-msg-cbuf");
+        cbuf_reset(cb);
+        return cb;
+    }
+    return cbuf_new();
+}
+
+/*! Return a message buffer allocated with clicon_msg_cbuf_get
+ *
+ * The buffer is cached on the handle for the next request, or freed if the
+ * cache slot is already occupied.
+ * @param[in]  h   Clixon handle
+ * @param[in]  cb  Message buffer, NULL is a no-op
+ * @see clicon_msg_cbuf_get
+ */
+int
+clicon_msg_cbuf_release(clicon_handle h,
+                        cbuf         *cb)
+{
+    cbuf *cb0 = NULL;
+
+    if (cb == NULL)
+        return 0;
+    clicon_ptr_get(h, "proto-msg-cbuf", (void**)&cb0);
+    if (cb0 == NULL &&
+        clicon_ptr_set(h, "proto-msg-cbuf", cb) == 0)
+        return 0;
+    cbuf_free(cb);
+    return 0;
+}
+
 /*! Send internal netconf rpc from client to backend and return a persistent socket
  *
  * @param[in]   h      CLICON handle
@@ -286,7 +576,7 @@ clicon_rpc_msg_persistent(clicon_handle      h,
 #endif
     clicon_debug(1, "%s request:%s", __FUNCTION__, msg->op_body);
     /* Create a socket and connect to it, either UNIX, IPv4 or IPv6 per config options */
-    if (clicon_rpc_msg_once(h, msg, &retdata, &eof, &s) < 0)
+    if (clicon_rpc_msg_once(h, msg, 0, NULL, &retdata, &eof, &s) < 0)
         goto done;
     if (eof){
         /* 2. check socket shutdown AFTER rpc */
@@ -474,6 +764,61 @@ clicon_rpc_netconf_xml(clicon_handle  h,
     return retval;
 }
 
+/*! Encode a get-config request message body
+ *
+ * Common to the tree-returning and streaming get-config variants.
+ * @param[in]  h        CLICON handle
+ * @param[in]  username If NULL, use default
+ * @param[in]  db       Name of database
+ * @param[in]  xpath    XPath (or "")
+ * @param[in]  nsc      Namespace context for filter
+ * @param[in]  defaults Value of the with-defaults mode, rfc6243, or NULL
+ * @param[out] cb       Message body appended here
+ * @retval     0        OK
+ * @retval    -1        Error
+ * @see clicon_rpc_get_config
+ */
+static int
+get_config_encode(clicon_handle h,
+                  char         *username,
+                  char         *db,
+                  char         *xpath,
+                  cvec         *nsc,
+                  char         *defaults,
+                  cbuf         *cb)
+{
+    int retval = -1;
+
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    if (username == NULL)
+        username = clicon_username_get(h);
+    if (username != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " xmlns:%s=\"%s\"",
+            NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, "><get-config><source><%s/></source>", db);
+    if (xpath && strlen(xpath)){
+        cprintf(cb, "<%s:filter %s:type=\"xpath\" %s:select=\"%s\"",
+                NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX,
+                xpath);
+        if (xml_nsctx_cbuf(cb, nsc) < 0)
+            goto done;
+        cprintf(cb, "/>");
+    }
+    if (defaults != NULL)
+        cprintf(cb, "<with-defaults xmlns=\"%s\">%s</with-defaults>",
+                IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
+                defaults);
+    cprintf(cb, "</get-config></rpc>");
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Get database configuration
  *
  * Same as clicon_proto_change just with a cvec instead of lvec
@@ -518,7 +863,6 @@ clicon_rpc_get_config(clicon_handle h,
                       cxobj       **xt)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cbuf              *cb = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr = NULL;    
@@ -530,37 +874,13 @@ clicon_rpc_get_config(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
-    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
-    if (username == NULL)
-        username = clicon_username_get(h);
-    if (username != NULL){
-        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
-        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
-    }
-    cprintf(cb, " xmlns:%s=\"%s\"",
-            NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
-    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
-    cprintf(cb, "><get-config><source><%s/></source>", db);
-    if (xpath && strlen(xpath)){
-        cprintf(cb, "<%s:filter %s:type=\"xpath\" %s:select=\"%s\"",
-                NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX, NETCONF_BASE_PREFIX,
-                xpath);
-        if (xml_nsctx_cbuf(cb, nsc) < 0)
-            goto done;
-        cprintf(cb, "/>");
-    }
-    if (defaults != NULL)
-        cprintf(cb, "<with-defaults xmlns=\"%s\">%s</with-defaults>",
-                IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
-                defaults);
-    cprintf(cb, "</get-config></rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
+    if (get_config_encode(h, username, db, xpath, nsc, defaults, cb) < 0)
         goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     yspec = clicon_dbspec_yang(h);
     /* Send xml error back: first check error, then ok */
@@ -604,13 +924,91 @@ clicon_rpc_get_config(clicon_handle h,
     if (nscd)
         cvec_free(nscd);
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xerr)
         xml_free(xerr);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
+    return retval;
+}
+
+/*! Get database configuration, streaming callback variant
+ *
+ * Same request as clicon_rpc_get_config but the reply data is not returned as
+ * one tree: cb is invoked for each top-level subtree under <data> as soon as
+ * that subtree is parsed from the reply, before the rest has been processed.
+ * The callback may render and prune each subtree, which caps peak tree memory
+ * to one top-level subtree and gives output with first-subtree latency on
+ * large configurations.
+ * The subtrees are not yang-bound and keep their explicit xmlns attributes
+ * from the wire; the callback binds if needed, see eg xml_bind_yang0.
+ * @param[in]  h        CLICON handle
+ * @param[in]  username If NULL, use default
+ * @param[in]  db       Name of database
+ * @param[in]  xpath    XPath (or "")
+ * @param[in]  nsc      Namespace context for filter
+ * @param[in]  defaults Value of the with-defaults mode, rfc6243, or NULL
+ * @param[in]  cb       Subtree callback, see clixon_xml_parse_file_cb
+ * @param[in]  arg      Argument to cb
+ * @param[out] xret     Residual reply tree with pruned data subtrees, check
+ *                      rpc-reply/rpc-error here. Free with xml_free
+ * @retval     0        OK
+ * @retval    -1       Error
+ * @see clicon_rpc_get_config  returning the reply as one tree
+ */
+int
+clicon_rpc_get_config_cb(clicon_handle h,
+                         char         *username,
+                         char         *db,
+                         char         *xpath,
+                         cvec         *nsc,
+                         char         *defaults,
+                         int         (*cb)(cxobj *x, void *arg),
+                         void         *arg,
+                         cxobj       **xret)
+{
+    int      retval = -1;
+    cbuf    *cbmsg = NULL;
+    char    *retdata = NULL;
+    FILE    *f = NULL;
+    cxobj   *xr = NULL;
+    uint32_t session_id;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cbmsg = clicon_msg_cbuf_get(h)) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (get_config_encode(h, username, db, xpath, nsc, defaults, cbmsg) < 0)
+        goto done;
+    if (clicon_rpc_msg_data(h, NULL, session_id, cbmsg, &retdata) < 0)
+        goto done;
+    if (retdata){
+        if ((f = fmemopen(retdata, strlen(retdata), "r")) == NULL){
+            clicon_err(OE_UNIX, errno, "fmemopen");
+            goto done;
+        }
+        /* Depth 3 is the children of rpc-reply/data under the parse top symbol.
+         * Children of rpc-reply/rpc-error are also at depth 3, the callback is
+         * expected to filter on parent, see eg cli_show_stream_cb */
+        if (clixon_xml_parse_file_cb(f, YB_NONE, NULL, &xr, cb, 3, arg, NULL) < 0)
+            goto done;
+    }
+    if (xret){
+        *xret = xr;
+        xr = NULL;
+    }
+    retval = 0;
+ done:
+    if (f)
+        fclose(f);
+    if (retdata)
+        free(retdata);
+    if (cbmsg)
+        clicon_msg_cbuf_release(h, cbmsg);
+    if (xr)
+        xml_free(xr);
     return retval;
 }
 
@@ -636,7 +1034,6 @@ clicon_rpc_edit_config(clicon_handle       h,
                        char               *xmlstr)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cbuf              *cb = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
@@ -645,7 +1042,7 @@ clicon_rpc_edit_config(clicon_handle       h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -653,6 +1050,7 @@ clicon_rpc_edit_config(clicon_handle       h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -662,9 +1060,7 @@ clicon_rpc_edit_config(clicon_handle       h,
     if (xmlstr)
         cprintf(cb, "%s", xmlstr);
     cprintf(cb, "</edit-config></rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Editing configuration", NULL);
@@ -675,9 +1071,7 @@ clicon_rpc_edit_config(clicon_handle       h,
     if (xret)
         xml_free(xret);
     if (cb)
-        cbuf_free(cb);
-    if (msg)
-        free(msg);
+        clicon_msg_cbuf_release(h, cb);
     return retval;
 }
 
@@ -701,7 +1095,6 @@ clicon_rpc_copy_config(clicon_handle h,
                        char         *db2)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -710,7 +1103,7 @@ clicon_rpc_copy_config(clicon_handle h,
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -718,15 +1111,14 @@ clicon_rpc_copy_config(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR);  /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<copy-config><source><%s/></source><target><%s/></target></copy-config></rpc>",
             db1, db2);
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Copying configuration", NULL);
@@ -735,11 +1127,9 @@ clicon_rpc_copy_config(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -759,7 +1149,6 @@ clicon_rpc_delete_config(clicon_handle h,
                          char         *db)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -768,7 +1157,7 @@ clicon_rpc_delete_config(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -776,15 +1165,14 @@ clicon_rpc_delete_config(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR);  /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb,  "<edit-config><target><%s/></target><default-operation>none</default-operation><config operation=\"delete\"/></edit-config>", db);
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Deleting configuration", NULL);
@@ -793,11 +1181,9 @@ clicon_rpc_delete_config(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -812,7 +1198,6 @@ clicon_rpc_lock(clicon_handle h,
                 char         *db)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -821,7 +1206,7 @@ clicon_rpc_lock(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -829,15 +1214,14 @@ clicon_rpc_lock(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<lock><target><%s/></target></lock>", db);
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Locking configuration", NULL);
@@ -846,11 +1230,9 @@ clicon_rpc_lock(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -865,7 +1247,6 @@ clicon_rpc_unlock(clicon_handle h,
                   char         *db)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -874,7 +1255,7 @@ clicon_rpc_unlock(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -882,15 +1263,14 @@ clicon_rpc_unlock(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<unlock><target><%s/></target></unlock>", db);
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Configuration unlock", NULL);
@@ -899,81 +1279,44 @@ clicon_rpc_unlock(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
-/*! Get database configuration and state data
+/*! Construct the message body of a <get> rpc, see clicon_rpc_get
+ *
+ * Factored out of clicon_rpc_get so that callers submitting the request
+ * asynchronously (eg the restconf backend session pool) can build the same
+ * message without going through the blocking send.
  * @param[in]  h         Clicon handle
  * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
- * @param[in]  namespace Namespace associated w xpath
  * @param[in]  nsc       Namespace context for filter
  * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
  * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
  * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
- * @param[out] xt        XML tree. Free with xml_free. 
- *                       Either <config> or <rpc-error>. 
+ * @param[out] cb        Message body appended here
  * @retval     0         OK
- * @retval    -1         Error, fatal or xml
- * @note if xpath is set but namespace is NULL, the default, netconf base 
- *       namespace will be used which is most probably wrong.
- * @code
- *  cxobj *xt = NULL;
- *  cvec *nsc = NULL;
- *
- *  if ((nsc = xml_nsctx_init(NULL, "urn:example:hello")) == NULL)
- *     err;
- *  if (clicon_rpc_get(h, "/hello/world", nsc, CONTENT_ALL, -1, &xt) < 0)
- *     err;
- *  if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
- *     clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
- *     err;
- *  }
- *  if (xt)
- *     xml_free(xt);
- *  if (nsc)
- *     xml_nsctx_free(nsc);
- * @endcode
- * @see clicon_rpc_get_config which is almost the same as with content=config, but you can also select dbname
- * @see clixon_netconf_error
- * @note the netconf return message is yang populated, as well as the return data
+ * @retval    -1         Error
  */
 int
-clicon_rpc_get(clicon_handle   h,
-               char           *xpath,
-               cvec           *nsc, /* namespace context for filter */
-               netconf_content content,
-               int32_t         depth,
-               char           *defaults,
-               cxobj         **xt)
+clicon_rpc_get_body(clicon_handle   h,
+                    char           *xpath,
+                    cvec           *nsc,
+                    netconf_content content,
+                    int32_t         depth,
+                    char           *defaults,
+                    cbuf           *cb)
 {
-    int                retval = -1;
-    struct clicon_msg *msg = NULL;
-    cbuf              *cb = NULL;
-    cxobj             *xret = NULL;
-    cxobj             *xerr = NULL;
-    cxobj             *xd = NULL;
-    char              *username;
-    uint32_t           session_id;
-    int                ret;
-    yang_stmt         *yspec;
-    cvec              *nscd = NULL;
-    
-    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    if (session_id_check(h, &session_id) < 0)
-        goto done;
-    if ((cb = cbuf_new()) == NULL){
-        clicon_err(OE_XML, errno, "cbuf_new");
-        goto done;
-    }
+    int   retval = -1;
+    char *username;
+
     cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -1005,59 +1348,148 @@ clicon_rpc_get(clicon_handle   h,
                 IETF_NETCONF_WITH_DEFAULTS_YANG_NAMESPACE,
                 defaults);
     cprintf(cb, "</get></rpc>");
-    if ((msg = clicon_msg_encode(session_id,
-                                 "%s", cbuf_get(cb))) == NULL)
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Process the reply of a <get> rpc, see clicon_rpc_get
+ *
+ * Factored out of clicon_rpc_get for callers that receive the reply
+ * asynchronously: extract <data> (or <rpc-error>), bind it to yang and sync
+ * its namespace declarations.
+ * @param[in]  h     Clicon handle
+ * @param[in]  xret  Parsed rpc-reply tree, the extracted node is removed from it
+ * @param[out] xt    XML tree. Free with xml_free.
+ *                   Either <data> or <rpc-error>.
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+clicon_rpc_get_reply(clicon_handle h,
+                     cxobj        *xret,
+                     cxobj       **xt)
+{
+    int        retval = -1;
+    cxobj     *xerr = NULL;
+    cxobj     *xd = NULL;
+    int        ret;
+    yang_stmt *yspec;
+    cvec      *nscd = NULL;
+
+    yspec = clicon_dbspec_yang(h);
+    /* Send xml error back: first check error, then ok */
+    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
+        xd = xml_parent(xd); /* point to rpc-reply */
+    else if ((xd = xpath_first(xret, NULL, "/rpc-reply/data")) == NULL){
+        if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
+            goto done;
+        if (xml_bind_special(xd, yspec, "/nc:get/output/data") < 0)
+            goto done;
+    }
+    else{
+        if (xml_bind_special(xd, yspec, "/nc:get/output/data") < 0)
+            goto done;
+        if ((ret = xml_bind_yang(h, xd, YB_MODULE, yspec, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if (clixon_netconf_internal_error(xerr,
+                                              ". Internal error, backend returned invalid XML.",
+                                              NULL) < 0)
+                goto done;
+            xd = xerr;
+            xerr = NULL;
+        }
+    }
+    if (xt && xd){
+        /* Sync namespaces, ie explicitly set all xmlns attributes to xd */
+        if (xml_nsctx_node(xd, &nscd) < 0)
+            goto done;
+        if (xml_rm(xd) < 0)
+            goto done;
+        if (xmlns_set_all(xd, nscd) < 0)
+            goto done;
+        xml_sort(xd); /* Ensure attr is first */
+        *xt = xd;
+    }
+    retval = 0;
+  done:
+    if (nscd)
+        cvec_free(nscd);
+    if (xerr)
+        xml_free(xerr);
+    return retval;
+}
+
+/*! Get database configuration and state data
+ * @param[in]  h         Clicon handle
+ * @param[in]  xpath     XPath in a filter stmt (or NULL/"" for no filter)
+ * @param[in]  namespace Namespace associated w xpath
+ * @param[in]  nsc       Namespace context for filter
+ * @param[in]  content   Clixon extension: all, config, noconfig. -1 means all
+ * @param[in]  depth     Nr of XML levels to get, -1 is all, 0 is none
+ * @param[in]  defaults  Value of the with-defaults mode, rfc6243, or NULL
+ * @param[out] xt        XML tree. Free with xml_free.
+ *                       Either <config> or <rpc-error>.
+ * @retval     0         OK
+ * @retval    -1         Error, fatal or xml
+ * @note if xpath is set but namespace is NULL, the default, netconf base
+ *       namespace will be used which is most probably wrong.
+ * @code
+ *  cxobj *xt = NULL;
+ *  cvec *nsc = NULL;
+ *
+ *  if ((nsc = xml_nsctx_init(NULL, "urn:example:hello")) == NULL)
+ *     err;
+ *  if (clicon_rpc_get(h, "/hello/world", nsc, CONTENT_ALL, -1, &xt) < 0)
+ *     err;
+ *  if ((xerr = xpath_first(xt, NULL, "/rpc-error")) != NULL){
+ *     clixon_netconf_error(xerr, "clicon_rpc_get", NULL);
+ *     err;
+ *  }
+ *  if (xt)
+ *     xml_free(xt);
+ *  if (nsc)
+ *     xml_nsctx_free(nsc);
+ * @endcode
+ * @see clicon_rpc_get_config which is almost the same as with content=config, but you can also select dbname
+ * @see clixon_netconf_error
+ * @note the netconf return message is yang populated, as well as the return data
+ */
+int
+clicon_rpc_get(clicon_handle   h,
+               char           *xpath,
+               cvec           *nsc, /* namespace context for filter */
+               netconf_content content,
+               int32_t         depth,
+               char           *defaults,
+               cxobj         **xt)
+{
+    int       retval = -1;
+    cbuf     *cb = NULL;
+    cxobj    *xret = NULL;
+    uint32_t  session_id;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (session_id_check(h, &session_id) < 0)
         goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
-    yspec = clicon_dbspec_yang(h);
-    /* Send xml error back: first check error, then ok */
-    if ((xd = xpath_first(xret, NULL, "/rpc-reply/rpc-error")) != NULL)
-        xd = xml_parent(xd); /* point to rpc-reply */
-    else if ((xd = xpath_first(xret, NULL, "/rpc-reply/data")) == NULL){
-        if ((xd = xml_new(NETCONF_OUTPUT_DATA, NULL, CX_ELMNT)) == NULL)
-            goto done;
-        if (xml_bind_special(xd, yspec, "/nc:get/output/data") < 0)
-            goto done;
-    }
-    else{
-        if (xml_bind_special(xd, yspec, "/nc:get/output/data") < 0)
-            goto done;
-        if ((ret = xml_bind_yang(h, xd, YB_MODULE, yspec, &xerr)) < 0)
-            goto done;
-        if (ret == 0){
-            if (clixon_netconf_internal_error(xerr,
-                                              ". Internal error, backend returned invalid XML.",
-                                              NULL) < 0)
-                goto done;
-            xd = xerr;
-            xerr = NULL;
-        }
-    }
-    if (xt && xd){
-        /* Sync namespaces, ie explicitly set all xmlns attributes to xd */
-        if (xml_nsctx_node(xd, &nscd) < 0)
-            goto done;
-        if (xml_rm(xd) < 0)
-            goto done;
-        if (xmlns_set_all(xd, nscd) < 0)
-            goto done;
-        xml_sort(xd); /* Ensure attr is first */
-        *xt = xd;
     }
+    if (clicon_rpc_get_body(h, xpath, nsc, content, depth, defaults, cb) < 0)
+        goto done;
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
+        goto done;
+    if (clicon_rpc_get_reply(h, xret, xt) < 0)
+        goto done;
     retval = 0;
   done:
     clicon_debug(CLIXON_DBG_DETAIL, "%s %d", __FUNCTION__, retval);
-    if (nscd)
-        cvec_free(nscd);
     if (cb)
-        cbuf_free(cb);
-    if (xerr)
-        xml_free(xerr);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -1099,7 +1531,6 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
                              cxobj         **xt)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cbuf              *cb = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr = NULL;
@@ -1116,13 +1547,14 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
     }
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
     cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " xmlns:%s=\"%s\"",
@@ -1171,9 +1603,7 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
     cprintf(cb, "</list-pagination>");
     cprintf(cb, "</get>");
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     yspec = clicon_dbspec_yang(h);
     /* Send xml error back: first check error, then ok */
@@ -1217,13 +1647,11 @@ clicon_rpc_get_pageable_list(clicon_handle   h,
     if (nscd)
         cvec_free(nscd);
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xerr)
         xml_free(xerr);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -1239,7 +1667,6 @@ int
 clicon_rpc_close_session(clicon_handle h)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1249,7 +1676,7 @@ clicon_rpc_close_session(clicon_handle h)
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1257,15 +1684,14 @@ clicon_rpc_close_session(clicon_handle h)
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<close-session/>");
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((s = clicon_client_socket_get(h)) >= 0){
         close(s);
@@ -1278,11 +1704,9 @@ clicon_rpc_close_session(clicon_handle h)
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -1298,7 +1722,6 @@ clicon_rpc_kill_session(clicon_handle h,
                         uint32_t      session_id)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1307,7 +1730,7 @@ clicon_rpc_kill_session(clicon_handle h,
     
     if (session_id_check(h, &my_session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1315,15 +1738,14 @@ clicon_rpc_kill_session(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<kill-session><session-id>%u</session-id></kill-session>", session_id);
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(my_session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, my_session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Kill session", NULL);
@@ -1332,11 +1754,9 @@ clicon_rpc_kill_session(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -1354,7 +1774,6 @@ clicon_rpc_validate(clicon_handle h,
                     char         *db)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1363,7 +1782,7 @@ clicon_rpc_validate(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1371,15 +1790,14 @@ clicon_rpc_validate(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<validate><source><%s/></source></validate>", db);
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, CLIXON_ERRSTR_VALIDATE_FAILED, NULL);
@@ -1389,9 +1807,7 @@ clicon_rpc_validate(clicon_handle h,
     retval = 1;
  done:
     if (cb)
-        cbuf_free(cb);
-    if (msg)
-        free(msg);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
     return retval;
@@ -1420,7 +1836,6 @@ clicon_rpc_commit(clicon_handle h,
                   char         *persist_id)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1458,7 +1873,7 @@ clicon_rpc_commit(clicon_handle h,
     if (session_id_check(h, &session_id) < 0)
         goto done;
 
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1466,6 +1881,7 @@ clicon_rpc_commit(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -1484,9 +1900,7 @@ clicon_rpc_commit(clicon_handle h,
                 persist ? persist_xml : "");
     }
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, CLIXON_ERRSTR_COMMIT_FAILED, NULL);
@@ -1496,11 +1910,9 @@ clicon_rpc_commit(clicon_handle h,
     retval = 1;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     if (persist_id_xml)
         free(persist_id_xml);
     if (persist_xml)
@@ -1520,7 +1932,6 @@ int
 clicon_rpc_discard_changes(clicon_handle h)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1529,7 +1940,7 @@ clicon_rpc_discard_changes(clicon_handle h)
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1537,15 +1948,14 @@ clicon_rpc_discard_changes(clicon_handle h)
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
     cprintf(cb, ">");
     cprintf(cb, "<discard-changes/>");
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Discard changes", NULL);
@@ -1554,11 +1964,276 @@ clicon_rpc_discard_changes(clicon_handle h)
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
+        clicon_msg_cbuf_release(h, cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Get write serial of a datastore from backend
+ *
+ * The serial is bumped on every modification of the datastore, so a client can
+ * detect whether it changed between two reads without retrieving its content,
+ * eg to implement ETag cache revalidation.
+ * @param[in]  h       CLICON handle
+ * @param[in]  db      Name of datastore (eg "running")
+ * @param[out] serial  Current write serial of the datastore
+ * @retval     0       OK
+ * @retval    -1       Error and logged to syslog
+ * @see from_client_datastore_serial
+ */
+int
+clicon_rpc_datastore_serial(clicon_handle h,
+                            char         *db,
+                            uint32_t     *serial)
+{
+    int                retval = -1;
+    cxobj             *xret = NULL;
+    cxobj             *xerr;
+    cxobj             *x;
+    char              *body;
+    char              *username;
+    uint32_t           session_id;
+    cbuf              *cb = NULL;
+    char              *reason = NULL;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<datastore-serial xmlns=\"%s\"><db>%s</db></datastore-serial>",
+            CLIXON_LIB_NS, db);
+    cprintf(cb, "</rpc>");
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Get datastore serial", NULL);
+        goto done;
+    }
+    if ((x = xpath_first(xret, NULL, "rpc-reply/serial")) == NULL ||
+        (body = xml_body(x)) == NULL){
+        clicon_err(OE_XML, 0, "No serial in datastore-serial reply");
+        goto done;
+    }
+    if (parse_uint32(body, serial, &reason) <= 0){
+        clicon_err(OE_XML, errno, "Invalid serial in datastore-serial reply: %s",
+                   reason?reason:body);
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    if (cb)
+        clicon_msg_cbuf_release(h, cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Get backend-computed difference between two datastores
+ *
+ * The diff is computed server-side against the cached trees and only the
+ * differing subtrees plus their ancestor context are transferred, so the
+ * reply is proportional to the change and not to the datastore size.
+ * @param[in]  h     CLICON handle
+ * @param[in]  db1   Name of source datastore (eg "running")
+ * @param[in]  db2   Name of target datastore (eg "candidate")
+ * @param[out] xd1   Subtrees only in db1 and changed original values. Free with xml_free
+ * @param[out] xd2   Subtrees only in db2 and changed wanted values. Free with xml_free
+ * @retval     0     OK
+ * @retval    -1     Error and logged to syslog
+ * @see from_client_datastore_diff
+ * @note The returned trees are yang-bound with the standard handle yangspec
+ */
+int
+clicon_rpc_datastore_diff(clicon_handle h,
+                          char         *db1,
+                          char         *db2,
+                          cxobj       **xd1,
+                          cxobj       **xd2)
+{
+    int        retval = -1;
+    cxobj     *xret = NULL;
+    cxobj     *xerr;
+    cxobj     *x;
+    char      *username;
+    uint32_t   session_id;
+    cbuf      *cb = NULL;
+    yang_stmt *yspec;
+    int        i;
+    cxobj    **xdv[2] = {NULL, NULL};
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL){
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
+        cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    }
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    cprintf(cb, "<datastore-diff xmlns=\"%s\"><source>%s</source><target>%s</target></datastore-diff>",
+            CLIXON_LIB_NS, db1, db2);
+    cprintf(cb, "</rpc>");
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Datastore diff", NULL);
+        goto done;
+    }
+    yspec = clicon_dbspec_yang(h);
+    xdv[0] = xd1;
+    xdv[1] = xd2;
+    for (i=0; i<2; i++){
+        if ((x = xpath_first(xret, NULL, i==0 ? "rpc-reply/source" : "rpc-reply/target")) == NULL){
+            clicon_err(OE_XML, 0, "No %s in datastore-diff reply", i==0 ? "source" : "target");
+            goto done;
+        }
+        /* Bind so text/cli rendering of the delta resolves yang per node */
+        if (xml_bind_yang(h, x, YB_MODULE, yspec, NULL) < 0)
+            goto done;
+        if (xdv[i]){
+            if (xml_rm(x) < 0)
+                goto done;
+            *xdv[i] = x;
+        }
+    }
+    retval = 0;
+ done:
+    if (cb)
+        clicon_msg_cbuf_release(h, cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Get several filtered subtrees in one round trip
+ *
+ * Each filter xpath is evaluated in the backend against a single retrieved tree
+ * with one shared NACM read-access pass, so a collector polling many subtrees pays
+ * one rpc, one retrieval and one access-control pass instead of one per filter.
+ * @param[in]  h        CLICON handle
+ * @param[in]  labels   Client-chosen labels, one per filter, echoed in the reply
+ * @param[in]  xpaths   XPath filter expressions, one per filter
+ * @param[in]  nfilter  Number of filters (length of labels and xpaths)
+ * @param[in]  nsc      Namespace context for the xpaths (shared by all filters)
+ * @param[in]  content  Clixon extension: all, config, nonconfig. -1 means all
+ * @param[in]  defaults Value of the with-defaults mode, rfc6243, or NULL
+ * @param[out] xt       Reply tree with one <result> per filter holding <label>
+ *                      and <data>. Free with xml_free
+ * @retval     0        OK
+ * @retval    -1        Error and logged to syslog
+ * @see clicon_rpc_get           single-filter equivalent
+ * @see from_client_get_batch
+ * @note the <data> subtrees are yang populated
+ */
+int
+clicon_rpc_get_batch(clicon_handle   h,
+                     char          **labels,
+                     char          **xpaths,
+                     size_t          nfilter,
+                     cvec           *nsc,
+                     netconf_content content,
+                     char           *defaults,
+                     cxobj         **xt)
+{
+    int        retval = -1;
+    cxobj     *xret = NULL;
+    cxobj     *xerr;
+    cxobj     *xd;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    char      *username;
+    uint32_t   session_id;
+    cbuf      *cb = NULL;
+    yang_stmt *yspec;
+    size_t     i;
+
+    if (session_id_check(h, &session_id) < 0)
+        goto done;
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<rpc xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
+    cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
+    if ((username = clicon_username_get(h)) != NULL)
+        cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
+    cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
+    cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
+    cprintf(cb, ">");
+    /* Elements are prefixed so namespace declarations from nsc (which may include a
+     * default namespace) cannot capture them
+     */
+    cprintf(cb, "<%s:get-batch", CLIXON_LIB_PREFIX);
+    if (xml_nsctx_cbuf(cb, nsc) < 0)
+        goto done;
+    cprintf(cb, ">");
+    if ((int)content != -1)
+        cprintf(cb, "<%s:content>%s</%s:content>",
+                CLIXON_LIB_PREFIX, netconf_content_int2str(content), CLIXON_LIB_PREFIX);
+    if (defaults != NULL)
+        cprintf(cb, "<%s:with-defaults>%s</%s:with-defaults>",
+                CLIXON_LIB_PREFIX, defaults, CLIXON_LIB_PREFIX);
+    for (i=0; i<nfilter; i++){
+        cprintf(cb, "<%s:filter><%s:label>", CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX);
+        if (labels[i] && xml_chardata_cbuf_append(cb, labels[i]) < 0)
+            goto done;
+        cprintf(cb, "</%s:label><%s:select>", CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX);
+        if (xpaths[i] && xml_chardata_cbuf_append(cb, xpaths[i]) < 0)
+            goto done;
+        cprintf(cb, "</%s:select></%s:filter>", CLIXON_LIB_PREFIX, CLIXON_LIB_PREFIX);
+    }
+    cprintf(cb, "</%s:get-batch></rpc>", CLIXON_LIB_PREFIX);
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
+        goto done;
+    if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
+        clixon_netconf_error(xerr, "Get batch", NULL);
+        goto done;
+    }
+    if ((xd = xpath_first(xret, NULL, "rpc-reply")) == NULL){
+        clicon_err(OE_XML, 0, "No rpc-reply in get-batch reply");
+        goto done;
+    }
+    yspec = clicon_dbspec_yang(h);
+    /* Bind the data subtrees so rendering of the results resolves yang per node */
+    if (xpath_vec(xd, NULL, "result/data", &xvec, &xlen) < 0)
+        goto done;
+    for (i=0; i<xlen; i++)
+        if (xml_bind_yang(h, xvec[i], YB_MODULE, yspec, NULL) < 0)
+            goto done;
+    if (xt){
+        if (xml_rm(xd) < 0)
+            goto done;
+        *xt = xd;
+    }
+    retval = 0;
+ done:
+    if (xvec)
+        free(xvec);
+    if (cb)
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
-    if (msg)
-        free(msg);
     return retval;
 }
 
@@ -1596,6 +2271,7 @@ clicon_rpc_create_subscription(clicon_handle    h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -1639,7 +2315,6 @@ clicon_rpc_debug(clicon_handle h,
                 int           level)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1648,7 +2323,7 @@ clicon_rpc_debug(clicon_handle h,
 
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1656,6 +2331,7 @@ clicon_rpc_debug(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -1663,9 +2339,7 @@ clicon_rpc_debug(clicon_handle h,
     cprintf(cb, "<debug xmlns=\"%s\"><level>%d</level></debug>", CLIXON_LIB_NS, level);
     cprintf(cb, "</rpc>");
 
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Debug", NULL);
@@ -1678,9 +2352,7 @@ clicon_rpc_debug(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
-    if (msg)
-        free(msg);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
     return retval;
@@ -1701,7 +2373,6 @@ clicon_rpc_restconf_debug(clicon_handle h,
                           int           level)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1710,7 +2381,7 @@ clicon_rpc_restconf_debug(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1718,6 +2389,7 @@ clicon_rpc_restconf_debug(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -1728,9 +2400,7 @@ clicon_rpc_restconf_debug(clicon_handle h,
             level);
     cprintf(cb, "</config></edit-config>");
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Debug", NULL);
@@ -1744,9 +2414,7 @@ clicon_rpc_restconf_debug(clicon_handle h,
         goto done;
  done:
     if (cb)
-        cbuf_free(cb);
-    if (msg)
-        free(msg);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
     return retval;
@@ -1774,7 +2442,6 @@ clicon_hello_req(clicon_handle h,
                  uint32_t     *id)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     cxobj             *x;
@@ -1784,13 +2451,14 @@ clicon_hello_req(clicon_handle h,
     cbuf              *cb = NULL;
     int                clixon_lib = 0;
 
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
     cprintf(cb, "<hello xmlns=\"%s\"", NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         clixon_lib++;
     }
     /* RFC 6022 session parameters transport and source-host */
@@ -1813,9 +2481,7 @@ clicon_hello_req(clicon_handle h,
             NETCONF_BASE_CAPABILITY_1_1);
     cprintf(cb, "</hello>");
 
-    if ((msg = clicon_msg_encode(0, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, 0, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Hello", NULL);
@@ -1833,9 +2499,7 @@ clicon_hello_req(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
-    if (msg)
-        free(msg);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
     return retval;
@@ -1853,7 +2517,6 @@ clicon_rpc_restart_plugin(clicon_handle h,
                           char         *plugin)
 {
     int                retval = -1;
-    struct clicon_msg *msg = NULL;
     cxobj             *xret = NULL;
     cxobj             *xerr;
     char              *username;
@@ -1862,7 +2525,7 @@ clicon_rpc_restart_plugin(clicon_handle h,
     
     if (session_id_check(h, &session_id) < 0)
         goto done;
-    if ((cb = cbuf_new()) == NULL){
+    if ((cb = clicon_msg_cbuf_get(h)) == NULL){
         clicon_err(OE_XML, errno, "cbuf_new");
         goto done;
     }
@@ -1870,6 +2533,7 @@ clicon_rpc_restart_plugin(clicon_handle h,
     cprintf(cb, " xmlns:%s=\"%s\"", NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE);
     if ((username = clicon_username_get(h)) != NULL){
         cprintf(cb, " %s:username=\"%s\"", CLIXON_LIB_PREFIX, username);
+        trace_attr_cbuf(h, cb);
         cprintf(cb, " xmlns:%s=\"%s\"", CLIXON_LIB_PREFIX, CLIXON_LIB_NS);
     }
     cprintf(cb, " %s", NETCONF_MESSAGE_ID_ATTR); /* XXX: use incrementing sequence */
@@ -1877,9 +2541,7 @@ clicon_rpc_restart_plugin(clicon_handle h,
     cprintf(cb, "<restart-plugin xmlns=\"%s\"><plugin>%s</plugin></restart-plugin>",
             CLIXON_LIB_NS, plugin);
     cprintf(cb, "</rpc>");
-    if ((msg = clicon_msg_encode(session_id, "%s", cbuf_get(cb))) == NULL)
-        goto done;
-    if (clicon_rpc_msg(h, msg, &xret) < 0)
+    if (clicon_rpc_msg_cbuf(h, session_id, cb, &xret) < 0)
         goto done;
     if ((xerr = xpath_first(xret, NULL, "//rpc-error")) != NULL){
         clixon_netconf_error(xerr, "Debug", NULL);
@@ -1892,9 +2554,7 @@ clicon_rpc_restart_plugin(clicon_handle h,
     retval = 0;
  done:
     if (cb)
-        cbuf_free(cb);
-    if (msg)
-        free(msg);
+        clicon_msg_cbuf_release(h, cb);
     if (xret)
         xml_free(xret);
     return retval;
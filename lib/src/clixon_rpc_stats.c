@@ -0,0 +1,500 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Per-RPC latency breakdown
+ * Records, per RPC type, time spent in parse, NACM, datastore access,
+ * validation, plugin callbacks and reply serialization, plus a ring buffer of
+ * the most recent samples, so a p99 latency regression can be attributed to a
+ * stage. Enabled with CLICON_RPC_STATS and read back via the clixon-lib stats
+ * RPC. All entrypoints are no-ops when disabled, at the cost of one handle
+ * data lookup.
+ *
+ * Also sampled cross-process tracing, see CLICON_TRACE_SAMPLING: a frontend
+ * (eg restconf) samples one in N transactions, assigns a trace id and
+ * propagates it to the backend as a cl:trace attribute on the internal rpc,
+ * next to cl:username. Both daemons emit span log lines tagged with the id
+ * at their stage boundaries, so end-to-end latency of one transaction can be
+ * attributed across the IPC hop by joining the logs on the trace id.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <syslog.h>
+#include <sys/time.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include "clixon_log.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_data.h"
+#include "clixon_options.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_rpc_stats.h"
+
+/* Number of recent per-RPC samples kept in the ring buffer */
+#define RPC_STATS_RING    64
+
+/* Max number of distinct RPC types aggregated, overflow lumped into "other" */
+#define RPC_STATS_TYPES   32
+
+/* Truncation length of RPC names in records */
+#define RPC_STATS_NAMELEN 32
+
+/* Handle data key of the stats record, see clicon_ptr_get */
+#define RPC_STATS_KEY "rpc-stats"
+
+/* Stage names as exposed in the stats RPC, same order as enum rpc_stats_stage */
+static const char *_stage_name[RPC_STATS_STAGE_NR] =
+    {"parse", "nacm", "xmldb", "validate", "plugin", "serialize"};
+
+/* One timed RPC invocation */
+struct rpc_sample{
+    char     sm_name[RPC_STATS_NAMELEN];
+    uint64_t sm_stage_ns[RPC_STATS_STAGE_NR];
+    uint64_t sm_total_ns;
+};
+
+/* Running aggregate over all invocations of one RPC type */
+struct rpc_aggregate{
+    char     ag_name[RPC_STATS_NAMELEN];
+    uint64_t ag_count;
+    uint64_t ag_total_ns;
+    uint64_t ag_max_ns;
+    uint64_t ag_stage_ns[RPC_STATS_STAGE_NR];
+};
+
+/* Per-handle stats record, allocated by clixon_rpc_stats_init */
+struct rpc_stats{
+    struct rpc_aggregate rs_agg[RPC_STATS_TYPES];
+    int                  rs_nagg;
+    struct rpc_sample    rs_ring[RPC_STATS_RING]; /* recent samples */
+    int                  rs_ringi;                /* next write position */
+    int                  rs_ringn;                /* nr of valid entries */
+    struct rpc_sample    rs_cur;                  /* sample being recorded */
+    int                  rs_active;               /* 1: rs_cur is live */
+    struct timespec      rs_begin;                /* start of current rpc */
+    struct timespec      rs_open[RPC_STATS_STAGE_NR]; /* stage entry times */
+    int                  rs_depth[RPC_STATS_STAGE_NR]; /* stage nest depth */
+};
+
+/* Trace sampling state: one process traces at most one transaction at a time
+ * (single-threaded event loop), so plain statics suffice
+ */
+static uint32_t _trace_sampling = 0; /* CLICON_TRACE_SAMPLING: 0 off, N: every Nth */
+static uint64_t _trace_count = 0;    /* Transactions seen, for the sampling decision */
+static uint64_t _trace_id = 0;       /* Id of the current trace */
+static int      _trace_active = 0;   /* 1: current transaction is traced */
+
+/*! Nanoseconds elapsed since t0 on the monotonic clock
+ */
+static uint64_t
+stats_elapsed_ns(struct timespec *t0)
+{
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (uint64_t)(t1.tv_sec - t0->tv_sec)*1000000000ull
+        + (uint64_t)(t1.tv_nsec - t0->tv_nsec);
+}
+
+/*! Get stats record of handle, NULL if stats are disabled
+ */
+static struct rpc_stats *
+stats_get(clicon_handle h)
+{
+    struct rpc_stats *rs = NULL;
+
+    clicon_ptr_get(h, RPC_STATS_KEY, (void**)&rs);
+    return rs;
+}
+
+/*! Enable RPC stats collection on the handle if CLICON_RPC_STATS is set
+ *
+ * Called once at backend start after options are parsed. If the option is
+ * unset all other entrypoints are no-ops.
+ * Stage recording is also enabled by a slow-operation log threshold
+ * (CLICON_LOG_SLOW_MS), so that a slow rpc can log its stage breakdown, see
+ * clixon_rpc_stats_done; the collected stats then also show in the stats RPC.
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+int
+clixon_rpc_stats_init(clicon_handle h)
+{
+    int               retval = -1;
+    struct rpc_stats *rs;
+
+    if (!clicon_option_bool(h, "CLICON_RPC_STATS") && clixon_log_slow_get() == 0)
+        goto ok;
+    if ((rs = calloc(1, sizeof(*rs))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    if (clicon_ptr_set(h, RPC_STATS_KEY, rs) < 0){
+        free(rs);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free RPC stats record of handle
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ */
+int
+clixon_rpc_stats_exit(clicon_handle h)
+{
+    struct rpc_stats *rs;
+
+    if ((rs = stats_get(h)) != NULL){
+        free(rs);
+        clicon_ptr_del(h, RPC_STATS_KEY);
+    }
+    return 0;
+}
+
+/*! Start a new RPC sample
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  name  RPC name, NULL if not yet known, see clixon_rpc_stats_name
+ * @retval     0     OK
+ */
+int
+clixon_rpc_stats_start(clicon_handle h,
+                       char         *name)
+{
+    struct rpc_stats *rs;
+
+    if ((rs = stats_get(h)) == NULL)
+        return 0;
+    memset(&rs->rs_cur, 0, sizeof(rs->rs_cur));
+    memset(rs->rs_depth, 0, sizeof(rs->rs_depth));
+    strncpy(rs->rs_cur.sm_name, name?name:"?", RPC_STATS_NAMELEN-1);
+    clock_gettime(CLOCK_MONOTONIC, &rs->rs_begin);
+    rs->rs_active = 1;
+    return 0;
+}
+
+/*! Set RPC name of the current sample, once the decoded message reveals it
+ * @param[in]  h     Clicon handle
+ * @param[in]  name  RPC name
+ * @retval     0     OK
+ */
+int
+clixon_rpc_stats_name(clicon_handle h,
+                      char         *name)
+{
+    struct rpc_stats *rs;
+
+    if ((rs = stats_get(h)) == NULL || !rs->rs_active)
+        return 0;
+    strncpy(rs->rs_cur.sm_name, name, RPC_STATS_NAMELEN-1);
+    rs->rs_cur.sm_name[RPC_STATS_NAMELEN-1] = '\0';
+    return 0;
+}
+
+/*! Enter a timed stage of RPC handling
+ *
+ * Stages may nest (eg a datastore read from within a plugin callback): time is
+ * accounted to the outermost enter/exit pair of each stage.
+ * @param[in]  h      Clicon handle
+ * @param[in]  stage  Which stage
+ * @retval     0      OK
+ */
+int
+clixon_rpc_stats_stage_begin(clicon_handle        h,
+                             enum rpc_stats_stage stage)
+{
+    struct rpc_stats *rs;
+
+    if ((rs = stats_get(h)) == NULL || !rs->rs_active)
+        return 0;
+    if (rs->rs_depth[stage]++ == 0)
+        clock_gettime(CLOCK_MONOTONIC, &rs->rs_open[stage]);
+    return 0;
+}
+
+/*! Leave a timed stage of RPC handling
+ * @param[in]  h      Clicon handle
+ * @param[in]  stage  Which stage
+ * @retval     0      OK
+ * @see clixon_rpc_stats_stage_begin
+ */
+int
+clixon_rpc_stats_stage_end(clicon_handle        h,
+                           enum rpc_stats_stage stage)
+{
+    struct rpc_stats *rs;
+
+    if ((rs = stats_get(h)) == NULL || !rs->rs_active)
+        return 0;
+    if (rs->rs_depth[stage] > 0 && --rs->rs_depth[stage] == 0)
+        rs->rs_cur.sm_stage_ns[stage] += stats_elapsed_ns(&rs->rs_open[stage]);
+    return 0;
+}
+
+/*! Commit the current sample to the per-type aggregate and the sample ring
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ */
+int
+clixon_rpc_stats_done(clicon_handle h)
+{
+    struct rpc_stats     *rs;
+    struct rpc_sample    *sm;
+    struct rpc_aggregate *ag = NULL;
+    int                   i;
+
+    if ((rs = stats_get(h)) == NULL || !rs->rs_active)
+        return 0;
+    rs->rs_active = 0;
+    sm = &rs->rs_cur;
+    sm->sm_total_ns = stats_elapsed_ns(&rs->rs_begin);
+    /* Slow-op log: a whole rpc over threshold logs its stage breakdown */
+    if (clixon_log_slow_get() != 0 &&
+        sm->sm_total_ns >= (uint64_t)clixon_log_slow_get()*1000000ull)
+        clicon_log(LOG_WARNING,
+                   "slow rpc %s: total-ms=%" PRIu64
+                   " parse-ns=%" PRIu64 " nacm-ns=%" PRIu64 " xmldb-ns=%" PRIu64
+                   " validate-ns=%" PRIu64 " plugin-ns=%" PRIu64 " serialize-ns=%" PRIu64,
+                   sm->sm_name, sm->sm_total_ns/1000000,
+                   sm->sm_stage_ns[RPC_STATS_PARSE], sm->sm_stage_ns[RPC_STATS_NACM],
+                   sm->sm_stage_ns[RPC_STATS_XMLDB], sm->sm_stage_ns[RPC_STATS_VALIDATE],
+                   sm->sm_stage_ns[RPC_STATS_PLUGIN], sm->sm_stage_ns[RPC_STATS_SERIALIZE]);
+    /* If this rpc is traced, emit its stage breakdown as one span log line */
+    if (_trace_active)
+        clicon_log(LOG_INFO,
+                   "trace id=%016" PRIx64 " span=rpc.stages rpc=%s total-ns=%" PRIu64
+                   " parse-ns=%" PRIu64 " nacm-ns=%" PRIu64 " xmldb-ns=%" PRIu64
+                   " validate-ns=%" PRIu64 " plugin-ns=%" PRIu64 " serialize-ns=%" PRIu64,
+                   _trace_id, sm->sm_name, sm->sm_total_ns,
+                   sm->sm_stage_ns[RPC_STATS_PARSE], sm->sm_stage_ns[RPC_STATS_NACM],
+                   sm->sm_stage_ns[RPC_STATS_XMLDB], sm->sm_stage_ns[RPC_STATS_VALIDATE],
+                   sm->sm_stage_ns[RPC_STATS_PLUGIN], sm->sm_stage_ns[RPC_STATS_SERIALIZE]);
+    /* Find or create the aggregate of this rpc type */
+    for (i=0; i<rs->rs_nagg; i++)
+        if (strcmp(rs->rs_agg[i].ag_name, sm->sm_name) == 0){
+            ag = &rs->rs_agg[i];
+            break;
+        }
+    if (ag == NULL){
+        if (rs->rs_nagg < RPC_STATS_TYPES){
+            ag = &rs->rs_agg[rs->rs_nagg++];
+            strncpy(ag->ag_name, sm->sm_name, RPC_STATS_NAMELEN-1);
+        }
+        else{ /* table full: lump into last entry */
+            ag = &rs->rs_agg[RPC_STATS_TYPES-1];
+            strcpy(ag->ag_name, "other");
+        }
+    }
+    ag->ag_count++;
+    ag->ag_total_ns += sm->sm_total_ns;
+    if (sm->sm_total_ns > ag->ag_max_ns)
+        ag->ag_max_ns = sm->sm_total_ns;
+    for (i=0; i<RPC_STATS_STAGE_NR; i++)
+        ag->ag_stage_ns[i] += sm->sm_stage_ns[i];
+    /* Push into ring of recent samples */
+    rs->rs_ring[rs->rs_ringi] = *sm;
+    rs->rs_ringi = (rs->rs_ringi + 1) % RPC_STATS_RING;
+    if (rs->rs_ringn < RPC_STATS_RING)
+        rs->rs_ringn++;
+    return 0;
+}
+
+/*! Print the stage leafs of one sample or aggregate
+ */
+static int
+stats_stages2cbuf(cbuf     *cb,
+                  uint64_t *stage_ns)
+{
+    int i;
+
+    for (i=0; i<RPC_STATS_STAGE_NR; i++)
+        cprintf(cb, "<%s-ns>%" PRIu64 "</%s-ns>",
+                _stage_name[i], stage_ns[i], _stage_name[i]);
+    return 0;
+}
+
+/*! Serialize RPC stats as XML, for the clixon-lib stats RPC reply
+ *
+ * Prints nothing if stats are disabled.
+ * @param[in]     h     Clicon handle
+ * @param[in,out] cb    CLIgen buffer to print to
+ * @retval        0     OK
+ * @see from_client_stats  where it is called
+ */
+int
+clixon_rpc_stats_get(clicon_handle h,
+                     cbuf         *cb)
+{
+    struct rpc_stats  *rs;
+    struct rpc_sample *sm;
+    int                i;
+    int                pos;
+
+    if ((rs = stats_get(h)) == NULL)
+        return 0;
+    for (i=0; i<rs->rs_nagg; i++){
+        cprintf(cb, "<rpc xmlns=\"%s\">", CLIXON_LIB_NS);
+        cprintf(cb, "<name>%s</name>", rs->rs_agg[i].ag_name);
+        cprintf(cb, "<count>%" PRIu64 "</count>", rs->rs_agg[i].ag_count);
+        cprintf(cb, "<total-ns>%" PRIu64 "</total-ns>", rs->rs_agg[i].ag_total_ns);
+        cprintf(cb, "<max-ns>%" PRIu64 "</max-ns>", rs->rs_agg[i].ag_max_ns);
+        stats_stages2cbuf(cb, rs->rs_agg[i].ag_stage_ns);
+        cprintf(cb, "</rpc>");
+    }
+    /* Ring oldest first: nr 0 is the oldest retained sample */
+    for (i=0; i<rs->rs_ringn; i++){
+        pos = (rs->rs_ringi - rs->rs_ringn + i + RPC_STATS_RING) % RPC_STATS_RING;
+        sm = &rs->rs_ring[pos];
+        cprintf(cb, "<sample xmlns=\"%s\">", CLIXON_LIB_NS);
+        cprintf(cb, "<nr>%d</nr>", i);
+        cprintf(cb, "<name>%s</name>", sm->sm_name);
+        cprintf(cb, "<total-ns>%" PRIu64 "</total-ns>", sm->sm_total_ns);
+        stats_stages2cbuf(cb, sm->sm_stage_ns);
+        cprintf(cb, "</sample>");
+    }
+    return 0;
+}
+
+/*! Enable trace sampling if CLICON_TRACE_SAMPLING is set
+ *
+ * Called once at daemon start after options are parsed, in both the trace
+ * initiator (eg restconf) and the backend.
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ */
+int
+clixon_trace_init(clicon_handle h)
+{
+    _trace_sampling = clicon_option_int(h, "CLICON_TRACE_SAMPLING");
+    return 0;
+}
+
+/*! Start a transaction trace: adopt a propagated context or make a sampling decision
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  ctx   Propagated trace context (hex trace id), or NULL to sample locally
+ * @retval     0     OK
+ * @see clixon_trace_context  for how ctx crosses the IPC
+ */
+int
+clixon_trace_start(clicon_handle h,
+                   char         *ctx)
+{
+    struct timespec ts;
+
+    _trace_active = 0;
+    if (ctx != NULL){
+        if ((_trace_id = strtoull(ctx, NULL, 16)) != 0)
+            _trace_active = 1;
+    }
+    else if (_trace_sampling > 0 && (++_trace_count % _trace_sampling) == 0){
+        clock_gettime(CLOCK_REALTIME, &ts);
+        _trace_id = ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec
+            ^ ((uint64_t)random() << 16);
+        _trace_active = 1;
+    }
+    return 0;
+}
+
+/*! Stop the current transaction trace, if any
+ * @param[in]  h     Clicon handle
+ * @retval     0     OK
+ */
+int
+clixon_trace_stop(clicon_handle h)
+{
+    _trace_active = 0;
+    return 0;
+}
+
+/*! Get the trace context of the current transaction for propagation to a peer
+ * @param[in]  h     Clicon handle
+ * @param[out] buf   Trace context as hex trace id
+ * @param[in]  len   Length of buf, at least 17 bytes
+ * @retval     1     Trace active, buf written
+ * @retval     0     No active trace
+ */
+int
+clixon_trace_context(clicon_handle h,
+                     char         *buf,
+                     size_t        len)
+{
+    if (!_trace_active)
+        return 0;
+    snprintf(buf, len, "%016" PRIx64, _trace_id);
+    return 1;
+}
+
+/*! Emit a span log line for the current trace, if any
+ *
+ * @param[in]  h     Clicon handle
+ * @param[in]  name  Span name, eg backend.commit.plugins
+ * @param[in]  t0    Span start on the monotonic clock
+ * @retval     0     OK
+ */
+int
+clixon_trace_span(clicon_handle    h,
+                  const char      *name,
+                  struct timespec *t0)
+{
+    if (!_trace_active)
+        return 0;
+    clicon_log(LOG_INFO, "trace id=%016" PRIx64 " span=%s dur-ns=%" PRIu64,
+               _trace_id, name, stats_elapsed_ns(t0));
+    return 0;
+}
@@ -85,11 +85,126 @@
 #include "clixon_data.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
+#include "clixon_yang_module.h"
+#include "clixon_datastore.h"
 #include "clixon_stream.h"
 
 /* Go through and timeout subscription timers [s] */
 #define STREAM_TIMER_TIMEOUT_S 5
 
+/* One-slot cache of the last formatted notification, attached to the handle with
+ * clicon_ptr. Fan-out to many subscribers then serializes the event XML once in
+ * stream_notify1 instead of once per subscriber, see stream_notify_cache_get
+ */
+#define STREAM_FMT_CACHE_NAME "stream-notify-fmt"
+
+struct stream_fmt_cache{
+    cxobj *sf_xevent; /* Event the cached string was formatted from, NULL if invalid */
+    cbuf  *sf_cb;     /* Serialized <notification>, buffer reused between events */
+};
+
+/*! Get cached serialization of a notification event, if any
+ *
+ * Valid only from within a subscriber callback during stream_notify1 fan-out;
+ * callers must fall back to serializing the event themselves on NULL (eg replay).
+ * @param[in]  h       Clicon handle
+ * @param[in]  xevent  Notification event as given to the subscriber callback
+ * @retval     str     Serialized event XML
+ * @retval     NULL    No cached serialization for this event
+ */
+char *
+stream_notify_cache_get(clicon_handle h,
+                        cxobj        *xevent)
+{
+    struct stream_fmt_cache *sf = NULL;
+
+    clicon_ptr_get(h, STREAM_FMT_CACHE_NAME, (void**)&sf);
+    if (sf == NULL || sf->sf_xevent == NULL || sf->sf_xevent != xevent)
+        return NULL;
+    return cbuf_get(sf->sf_cb);
+}
+
+/*! Serialize a notification event into the one-slot cache
+ * @param[in]  h       Clicon handle
+ * @param[in]  xevent  Notification event about to be fanned out
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+stream_notify_cache_set(clicon_handle h,
+                        cxobj        *xevent)
+{
+    struct stream_fmt_cache *sf = NULL;
+
+    clicon_ptr_get(h, STREAM_FMT_CACHE_NAME, (void**)&sf);
+    if (sf == NULL){
+        if ((sf = malloc(sizeof(*sf))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            return -1;
+        }
+        memset(sf, 0, sizeof(*sf));
+        if ((sf->sf_cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            free(sf);
+            return -1;
+        }
+        if (clicon_ptr_set(h, STREAM_FMT_CACHE_NAME, sf) < 0){
+            cbuf_free(sf->sf_cb);
+            free(sf);
+            return -1;
+        }
+    }
+    cbuf_reset(sf->sf_cb);
+    if (clixon_xml2cbuf(sf->sf_cb, xevent, 0, 0, -1, 0) < 0)
+        return -1;
+    sf->sf_xevent = xevent;
+    return 0;
+}
+
+/*! Invalidate the notification format cache
+ * Must be called when fan-out of the event is done: the event tree may be freed
+ * and its address reused by a later event.
+ * @param[in]  h  Clicon handle
+ */
+static void
+stream_notify_cache_clear(clicon_handle h)
+{
+    struct stream_fmt_cache *sf = NULL;
+
+    clicon_ptr_get(h, STREAM_FMT_CACHE_NAME, (void**)&sf);
+    if (sf != NULL)
+        sf->sf_xevent = NULL;
+}
+
+/* Initial allocation of a replay circular buffer, doubled when full */
+#define STREAM_REPLAY_VEC_INIT 64
+
+/*! Slot of the i:th oldest entry in a replay circular buffer
+ * @param[in]  rep  Replay buffer
+ * @param[in]  i    Logical index, 0 is oldest, r_len-1 is newest
+ */
+static struct stream_replay_entry *
+stream_replay_i(struct stream_replay *rep,
+                int                   i)
+{
+    return &rep->r_vec[(rep->r_start + i) % rep->r_size];
+}
+
+/*! Drop the oldest entry of a replay circular buffer
+ * @param[in]  rep  Replay buffer, must be non-empty
+ */
+static void
+stream_replay_pop(struct stream_replay *rep)
+{
+    struct stream_replay_entry *re = &rep->r_vec[rep->r_start];
+
+    if (re->re_xml)
+        xml_free(re->re_xml);
+    rep->r_bytes -= re->re_sz;
+    rep->r_start = (rep->r_start + 1) % rep->r_size;
+    rep->r_len--;
+}
+
 /*! Find an event notification stream given name
  * @param[in]  h    Clicon handle
  * @param[in]  name Name of stream
@@ -148,6 +263,8 @@ stream_add(clicon_handle   h,
     es->es_replay_enabled = replay_enabled;
     if (retention)
         es->es_retention = *retention;
+    if (clicon_option_exists(h, "CLICON_STREAM_REPLAY_BYTES"))
+        es->es_replay_maxbytes = clicon_option_int(h, "CLICON_STREAM_REPLAY_BYTES");
     clicon_stream_append(h, es);
  ok:
     retval = 0;
@@ -163,11 +280,17 @@ int
 stream_delete_all(clicon_handle h,
                   int           force)
 {
-    struct stream_replay *r;
     struct stream_subscription *ss;
     event_stream_t       *es;
     event_stream_t       *head = clicon_stream(h);
-    
+    struct stream_fmt_cache *sf = NULL;
+
+    clicon_ptr_get(h, STREAM_FMT_CACHE_NAME, (void**)&sf);
+    if (sf != NULL){
+        cbuf_free(sf->sf_cb);
+        free(sf);
+        clicon_ptr_set(h, STREAM_FMT_CACHE_NAME, NULL);
+    }
     while ((es = clicon_stream(h)) != NULL){
         DELQ(es, head, event_stream_t *);
         clicon_stream_set(h, head);
@@ -177,12 +300,10 @@ stream_delete_all(clicon_handle h,
             free(es->es_description);
         while ((ss = es->es_subscription) != NULL)
             stream_ss_rm(h, es, ss, force); /* XXX in some cases leaks memory due to DONT clause in stream_ss_rm() */
-        while ((r = es->es_replay) != NULL){
-            DELQ(r, es->es_replay, struct stream_replay *);
-            if (r->r_xml)
-                xml_free(r->r_xml);
-            free(r);
-        }
+        while (es->es_replay.r_len > 0)
+            stream_replay_pop(&es->es_replay);
+        if (es->es_replay.r_vec)
+            free(es->es_replay.r_vec);
         free(es);
     }
     return 0;
@@ -248,9 +369,7 @@ stream_timer_setup(int   fd,
     event_stream_t              *es;
     struct stream_subscription  *ss;
     struct stream_subscription  *ss1;
-    struct stream_replay        *r;
-    struct stream_replay        *r1;
-    
+
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
     /* Go thru callbacks and see if any have timed out, if so remove them 
      * Could also be done by a separate timer.
@@ -276,22 +395,14 @@ stream_timer_setup(int   fd,
                     else
                         ss = NEXTQ(struct stream_subscription *, ss);
                 } while (ss && ss != es->es_subscription);
-  /* 2) Go throughreplay buffer and remove entries with passed retention time */
+  /* 2) Go through replay buffer and remove entries with passed retention time.
+   *    Entries are in timestamp order so only the oldest end needs checking */
             if (timerisset(&es->es_retention) &&
-                (r = es->es_replay) != NULL){
+                es->es_replay.r_len > 0){
                 timersub(&now, &es->es_retention, &tret);
-                do {
-                    if (timercmp(&r->r_tv, &tret, <)){
-                        r1 = NEXTQ(struct stream_replay *, r);
-                        DELQ(r, es->es_replay, struct stream_replay *);
-                        if (r->r_xml)
-                            xml_free(r->r_xml);
-                        free(r);
-                        r = r1;
-                    }
-                    else
-                        r = NEXTQ(struct stream_replay *, r);
-                } while (r && r!=es->es_replay);
+                while (es->es_replay.r_len > 0 &&
+                       timercmp(&stream_replay_i(&es->es_replay, 0)->re_tv, &tret, <))
+                    stream_replay_pop(&es->es_replay);
             }
             es = NEXTQ(struct event_stream *, es);
         } while (es && es != clicon_stream(h));
@@ -308,8 +419,159 @@ stream_timer_setup(int   fd,
     return retval;
 }
 
+/*! Send a periodic push-update to each subscriber of a push stream
+ *
+ * RFC 8641-style periodic subscription: each subscriber of the stream gets a
+ * push-update notification containing its own view of the datastore, ie the
+ * subtrees its xpath filter selects. The datastore is read once from the
+ * cache (zero-copy) and filtered per subscriber; the xpath filter itself is
+ * compiled once and reused via the xpath parse cache.
+ * @param[in] h       Clicon handle
+ * @param[in] stream  Name of event stream, eg YANGPUSH
+ * @param[in] db      Name of datastore, eg "running"
+ * @retval    0       OK (also if stream does not exist or has no subscribers)
+ * @retval   -1       Error
+ * @see stream_push_timer  Where this is called periodically
+ * @see stream_notify      For on-change events, eg the CONFIGDIFF stream
+ */
+int
+stream_push_periodic(clicon_handle h,
+                     char         *stream,
+                     const char   *db)
+{
+    int                         retval = -1;
+    event_stream_t             *es;
+    struct stream_subscription *ss;
+    yang_stmt                  *yspec = NULL;
+    cxobj                      *xt = NULL;
+    cxobj                      *xc;
+    cxobj                      *xev = NULL;
+    cxobj                     **vec = NULL;
+    int                         veclen;
+    cbuf                       *cb = NULL;
+    char                        timestr[28];
+    struct timeval              tv;
+    uint32_t                    serial;
+    int                         i;
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if ((es = stream_find(h, stream)) == NULL)
+        goto ok;
+    if (es->es_subscription == NULL) /* Dont read the datastore if no-one listens */
+        goto ok;
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clicon_err(OE_YANG, 0, "No yang spec");
+        goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    /* Zero-copy read of the datastore cache, released in done */
+    if (xmldb_get0(h, (char*)db, YB_MODULE, NULL, "/", 0, 0, &xt, NULL, NULL) < 0)
+        goto done;
+    serial = xmldb_serial_get(h, (char*)db);
+    gettimeofday(&tv, NULL);
+    if (time2str(tv, timestr, sizeof(timestr)) < 0){
+        clicon_err(OE_UNIX, errno, "time2str");
+        goto done;
+    }
+    ss = es->es_subscription;
+    do {
+        if (timerisset(&ss->ss_stoptime) && timercmp(&ss->ss_stoptime, &tv, <)){
+            /* Stoptime has passed, removal is done in stream_timer_setup */
+            ss = NEXTQ(struct stream_subscription *, ss);
+            continue;
+        }
+        cbuf_reset(cb);
+        /* From RFC5277 */
+        cprintf(cb, "<notification xmlns=\"%s\"><eventTime>%s</eventTime>",
+                NETCONF_NOTIFICATION_NAMESPACE, timestr);
+        cprintf(cb, "<push-update xmlns=\"%s\"><serial>%u</serial><datastore-contents>",
+                CLIXON_LIB_NS, serial);
+        if (ss->ss_xpath != NULL && strlen(ss->ss_xpath)){
+            if (xpath_vec(xt, NULL, "%s", &vec, &veclen, ss->ss_xpath) < 0)
+                goto done;
+            for (i=0; i<veclen; i++)
+                if (clixon_xml2cbuf(cb, vec[i], 0, 0, -1, 0) < 0)
+                    goto done;
+            free(vec);
+            vec = NULL;
+        }
+        else{ /* No filter: the whole datastore */
+            xc = NULL;
+            while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL)
+                if (clixon_xml2cbuf(cb, xc, 0, 0, -1, 0) < 0)
+                    goto done;
+        }
+        cprintf(cb, "</datastore-contents></push-update></notification>");
+        if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xev, NULL) < 0)
+            goto done;
+        if (xml_rootchild(xev, 0, &xev) < 0)
+            goto done;
+        if ((*ss->ss_fn)(h, 0, xev, ss->ss_arg) < 0)
+            goto done;
+        xml_free(xev);
+        xev = NULL;
+        ss = NEXTQ(struct stream_subscription *, ss);
+    } while (ss && ss != es->es_subscription);
+ ok:
+    retval = 0;
+ done:
+    if (xev)
+        xml_free(xev);
+    if (vec)
+        free(vec);
+    if (xt)
+        xmldb_get0_free(h, &xt);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Periodic push timer: send push-updates to subscribers and register new timer
+ *
+ * Armed at backend start. The period is given by CLICON_STREAM_PUSH_PERIOD,
+ * if 0 the timer is not re-armed and periodic push is disabled.
+ * @param[in] fd   No-op
+ * @param[in] arg  Clicon handle
+ * @retval    0    OK
+ * @retval   -1    Error
+ * @note format is given by clixon_event_reg_timeout callback function (fd not needed)
+ * @see stream_timer_setup
+ */
+int
+stream_push_timer(int   fd,
+                  void *arg)
+{
+    int            retval = -1;
+    clicon_handle  h = (clicon_handle)arg;
+    int            period;
+    struct timeval now;
+    struct timeval t;
+    struct timeval t1 = {0, 0};
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if ((period = clicon_option_int(h, "CLICON_STREAM_PUSH_PERIOD")) <= 0)
+        return 0; /* Disabled: do not re-arm */
+    if (stream_push_periodic(h, "YANGPUSH", "running") < 0)
+        goto done;
+    /* Initiate new timer */
+    gettimeofday(&now, NULL);
+    t1.tv_sec = period;
+    timeradd(&now, &t1, &t);
+    if (clixon_event_reg_timeout(t,
+                          stream_push_timer, /* this function */
+                          h,                 /* clicon handle */
+                          "stream push timer") < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
 #ifdef NYI
-/*! Delete single notification event stream 
+/*! Delete single notification event stream
  * XXX notused
  */
 int
@@ -503,6 +765,9 @@ stream_notify1(clicon_handle   h,
     struct stream_subscription *ss;
     
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    /* Format event once for all subscribers, see stream_notify_cache_get */
+    if (stream_notify_cache_set(h, xevent) < 0)
+        goto done;
     /* Go thru all subscriptions and find matches */
     if ((ss = es->es_subscription) != NULL)
         do {
@@ -526,6 +791,7 @@ stream_notify1(clicon_handle   h,
         } while (es->es_subscription && ss != es->es_subscription);
     retval = 0;
   done:
+    stream_notify_cache_clear(h); /* xevent may be freed and its address reused */
     return retval;
 }
 
@@ -710,34 +976,41 @@ stream_replay_notify(clicon_handle               h,
                      event_stream_t             *es,
                      struct stream_subscription *ss)
 {
-    int                   retval = -1;
-    struct stream_replay *r;
+    int                         retval = -1;
+    struct stream_replay       *rep = &es->es_replay;
+    struct stream_replay_entry *re;
+    int                         lo;
+    int                         hi;
+    int                         mid;
+    int                         i;
 
     /* If <startTime> is not present, this is not a replay */
     if (!timerisset(&ss->ss_starttime))
         goto ok;
     if (!es->es_replay_enabled)
         goto ok;
-    /* Get replay linked list */
-    if ((r = es->es_replay) == NULL)
-        goto ok;
-    /* First loop to skip until start */
-    do {
-        if (timercmp(&r->r_tv, &ss->ss_starttime, >=))
-            break;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
-    if (r == NULL)
+    if (rep->r_len == 0)
         goto ok; /* No samples to replay */
+    /* Entries are in timestamp order: binary search for the first entry
+     * with timestamp >= startTime */
+    lo = 0;
+    hi = rep->r_len;
+    while (lo < hi){
+        mid = (lo + hi) / 2;
+        if (timercmp(&stream_replay_i(rep, mid)->re_tv, &ss->ss_starttime, >=))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
     /* Then notify until stop */
-    do {
+    for (i = lo; i < rep->r_len; i++){
+        re = stream_replay_i(rep, i);
         if (timerisset(&ss->ss_stoptime) &&
-            timercmp(&r->r_tv, &ss->ss_stoptime, >))
+            timercmp(&re->re_tv, &ss->ss_stoptime, >))
             break;
-        if ((*ss->ss_fn)(h, 0, r->r_xml, ss->ss_arg) < 0)
+        if ((*ss->ss_fn)(h, 0, re->re_xml, ss->ss_arg) < 0)
             goto done;
-        r = NEXTQ(struct stream_replay *, r);
-    } while (r && r!=es->es_replay);
+    }
  ok:
     retval = 0;
  done:
@@ -745,26 +1018,53 @@ stream_replay_notify(clicon_handle               h,
 }
 
 /*! Add replay sample to stream with timestamp
+ * Appends to the circular buffer (samples arrive in timestamp order), growing it
+ * when full, then trims the oldest end if the byte cap is exceeded.
  * @param[in] es   Stream
  * @param[in] tv   Timestamp
- * @param[in] xv   XML
+ * @param[in] xv   XML, consumed
  */
 int
 stream_replay_add(event_stream_t *es,
                   struct timeval *tv,
                   cxobj          *xv)
 {
-    int                   retval = -1;
-    struct stream_replay *new;
+    int                         retval = -1;
+    struct stream_replay       *rep = &es->es_replay;
+    struct stream_replay_entry *re;
+    uint64_t                    nr = 0;
+    size_t                      sz = 0;
+    int                         i;
 
-    if ((new = malloc(sizeof *new)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc");
-        goto done;
+    if (rep->r_len == rep->r_size){ /* full: double the vector and linearize */
+        struct stream_replay_entry *vec;
+        int                         size;
+
+        size = rep->r_size ? 2*rep->r_size : STREAM_REPLAY_VEC_INIT;
+        if ((vec = malloc(size * sizeof(*vec))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        for (i = 0; i < rep->r_len; i++)
+            vec[i] = *stream_replay_i(rep, i);
+        if (rep->r_vec)
+            free(rep->r_vec);
+        rep->r_vec = vec;
+        rep->r_size = size;
+        rep->r_start = 0;
     }
-    memset(new, 0, (sizeof *new));
-    new->r_tv = *tv;
-    new->r_xml = xv;
-    ADDQ(new, es->es_replay);
+    re = &rep->r_vec[(rep->r_start + rep->r_len) % rep->r_size];
+    re->re_tv = *tv;
+    re->re_xml = xv;
+    re->re_sz = 0;
+    if (xml_stats(xv, &nr, &sz) == 0)
+        re->re_sz = sz;
+    rep->r_len++;
+    rep->r_bytes += re->re_sz;
+    /* Byte cap: drop oldest samples, but always keep the newest */
+    if (es->es_replay_maxbytes)
+        while (rep->r_len > 1 && rep->r_bytes > es->es_replay_maxbytes)
+            stream_replay_pop(rep);
     retval = 0;
  done:
     return retval;
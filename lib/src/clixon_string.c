@@ -52,6 +52,19 @@
 #include "clixon_string.h"
 #include "clixon_err.h"
 
+/* Vector compares for the XML chardata escape scan, see xml_chardata_runlen.
+ * Selected at compile-time from the target instruction set: SSE2 is baseline
+ * on x86_64, NEON on aarch64 */
+#ifdef XML_CHARDATA_SIMD
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CHARDATA_SIMD_SSE2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CHARDATA_SIMD_NEON
+#endif
+#endif /* XML_CHARDATA_SIMD */
+
 /*! Split string into a vector based on character delimiters. Using malloc
  *
  * The given string is split into a vector where the delimiter can be
@@ -262,6 +275,27 @@ uri_unreserved(unsigned char in)
     return 0;
 }
 
+/* All unreserved characters of RFC 3986 Sec 2.3 as a scan set for strspn,
+ * must match uri_unreserved() */
+static const char _uri_unreserved_set[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~";
+
+static const char _uri_hex_digits[] = "0123456789ABCDEF";
+
+/*! Value of a hex digit, -1 if not a hex digit
+ */
+static int
+uri_hexval(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
 /*! Percent encoding according to RFC 3986 URI Syntax
  * @param[out]  encp   Encoded malloced output string
  * @param[in]   fmt    Not-encoded input string (stdarg format string)
@@ -306,23 +340,37 @@ uri_percent_encode(char **encp,
     /* Now str is the combined fmt + ... */
 
     /* Step (2) encode and expand str --> enc */
+    /* Fast path: all characters unreserved, no expansion: hand over str as is.
+     * strspn scans whole words at a time in common libc implementations */
+    i = strspn(str, _uri_unreserved_set);
+    if (str[i] == '\0'){
+        *encp = str;
+        str = NULL; /* ownership moved to caller */
+        retval = 0;
+        goto done;
+    }
     /* This is max */
     len = strlen(str)*3+1;
     if ((enc = malloc(len)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc"); 
+        clicon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    memset(enc, 0, len);
-    len = strlen(str);
+    i = 0;
     j = 0;
-    for (i=0; i<len; i++){
-        if (uri_unreserved(str[i]))
-            enc[j++] = str[i];
-        else{
-            snprintf(&enc[j], 4, "%%%02X", str[i]&0xff);
-            j += 3;
+    while (str[i]){
+        /* Bulk-copy the unreserved run, then encode the reserved bytes */
+        len = strspn(&str[i], _uri_unreserved_set);
+        memcpy(&enc[j], &str[i], len);
+        i += len;
+        j += len;
+        while (str[i] && !uri_unreserved(str[i])){
+            enc[j++] = '%';
+            enc[j++] = _uri_hex_digits[(str[i] >> 4) & 0xf];
+            enc[j++] = _uri_hex_digits[str[i] & 0xf];
+            i++;
         }
     }
+    enc[j] = '\0';
     *encp = enc;
     retval = 0;
  done:
@@ -342,43 +390,58 @@ uri_percent_encode(char **encp,
  * @see uri_percent_encode
  */
 int
-uri_percent_decode(char  *enc, 
+uri_percent_decode(char  *enc,
                    char **strp)
 {
-    int   retval = -1;
-    char *str = NULL;
-    int   i, j;
-    char  hstr[3];
+    int    retval = -1;
+    char  *str = NULL;
+    char  *p;
+    char  *q;
+    char  *pct;
     size_t len;
-    char *ptr;
-    
+    int    hi;
+    int    lo;
+
     if (enc == NULL){
         clicon_err(OE_UNIX, EINVAL, "enc is NULL");
         goto done;
     }
+    /* Fast path: no escapes present, the common case for machine-generated
+     * URIs. strchr scans whole words at a time in common libc implementations */
+    if ((pct = strchr(enc, '%')) == NULL){
+        if ((str = strdup(enc)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        *strp = str;
+        retval = 0;
+        goto done;
+    }
     /* This is max */
-    len = strlen(enc)+1;
-    if ((str = malloc(len)) == NULL){
-        clicon_err(OE_UNIX, errno, "malloc"); 
+    if ((str = malloc(strlen(enc)+1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
-    memset(str, 0, len);
-    len = strlen(enc);
-    j = 0;
-    for (i=0; i<len; i++){
-        if (enc[i] == '%' && strlen(enc)-i > 2 && 
-            isxdigit(enc[i+1]) && isxdigit(enc[i+2])){
-            hstr[0] = enc[i+1];
-            hstr[1] = enc[i+2];
-            hstr[2] = 0;
-            str[j] = strtoul(hstr, &ptr, 16);
-            i += 2;
+    p = enc;
+    q = str;
+    while (pct != NULL){
+        /* Bulk-copy the run up to the escape, then decode it */
+        memcpy(q, p, pct - p);
+        q += pct - p;
+        p = pct;
+        if ((hi = uri_hexval(p[1])) >= 0 &&
+            (lo = uri_hexval(p[2])) >= 0){
+            *q++ = (hi << 4) | lo;
+            p += 3;
         }
-        else
-            str[j] = enc[i];
-        j++;
+        else /* Invalid escape: copy '%' literally as before */
+            *q++ = *p++;
+        pct = strchr(p, '%');
     }
-    str[j++] = '\0';
+    len = strlen(p);
+    memcpy(q, p, len);
+    q += len;
+    *q = '\0';
     *strp = str;
     retval = 0;
  done:
@@ -387,6 +450,61 @@ uri_percent_decode(char  *enc,
     return retval;
 }
 
+/*! Return the length of the prefix of str that needs no XML chardata escaping
+ *
+ * Scans for the first occurrence of one of & < > using 16-byte vector compares
+ * where the target instruction set has them (SSE2/NEON), falling back to a
+ * plain byte loop. Callers move the returned run with a single memcpy-width
+ * operation instead of inspecting one character at a time.
+ * @param[in]  str  Input string, need not be NUL-terminated
+ * @param[in]  len  Length of str
+ * @retval     n    Number of leading bytes of str containing none of & < >
+ * @see xml_chardata_encode where escaping is defined
+ */
+size_t
+xml_chardata_runlen(const char *str,
+                    size_t      len)
+{
+    size_t i = 0;
+
+#if defined(CHARDATA_SIMD_SSE2)
+    __m128i amp = _mm_set1_epi8('&');
+    __m128i lt  = _mm_set1_epi8('<');
+    __m128i gt  = _mm_set1_epi8('>');
+
+    while (i + 16 <= len){
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp),
+                                              _mm_cmpeq_epi8(v, lt)),
+                                 _mm_cmpeq_epi8(v, gt));
+        int mask = _mm_movemask_epi8(m);
+
+        if (mask)
+            return i + __builtin_ctz(mask);
+        i += 16;
+    }
+#elif defined(CHARDATA_SIMD_NEON)
+    uint8x16_t amp = vdupq_n_u8('&');
+    uint8x16_t lt  = vdupq_n_u8('<');
+    uint8x16_t gt  = vdupq_n_u8('>');
+
+    while (i + 16 <= len){
+        uint8x16_t v = vld1q_u8((const uint8_t *)(str + i));
+        uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, amp),
+                                         vceqq_u8(v, lt)),
+                                vceqq_u8(v, gt));
+
+        if (vmaxvq_u8(m) != 0)
+            break; /* the byte loop below locates the exact position */
+        i += 16;
+    }
+#endif
+    for (; i < len; i++)
+        if (str[i] == '&' || str[i] == '<' || str[i] == '>')
+            break;
+    return i;
+}
+
 /*! Encode escape characters according to XML definition
  * @param[out]  encp   Encoded malloced output string
  * @param[in]   fmt    Not-encoded input string (stdarg format string)
@@ -451,7 +569,15 @@ xml_chardata_encode(char      **escp,
                 cdata = 0;
             len++;
         }
-        else
+        else{
+            size_t run = xml_chardata_runlen(&str[i], slen - i);
+
+            if (run){ /* Skip over run that needs no escaping */
+                len += run;
+                i += run;
+                if (i >= slen)
+                    break;
+            }
             switch (str[i]){
             case '&':
                 len += strlen("&amp;");
@@ -470,6 +596,7 @@ xml_chardata_encode(char      **escp,
             default:
                 len++;
             }
+        }
     }
     len++; /* trailing \0 */
     /* We know length, allocate encoding buffer  */
@@ -491,7 +618,16 @@ xml_chardata_encode(char      **escp,
             }
             esc[j++] = str[i];
         }
-        else
+        else{
+        size_t run = xml_chardata_runlen(&str[i], slen - i);
+
+        if (run){ /* Copy run that needs no escaping as one block */
+            memcpy(&esc[j], &str[i], run);
+            j += run;
+            i += run;
+            if (i >= slen)
+                break;
+        }
         switch (str[i]){
         case '&':
             if ((l=snprintf(&esc[j], 6, "&amp;")) < 0){
@@ -522,6 +658,7 @@ xml_chardata_encode(char      **escp,
         default:
             esc[j++] = str[i];
         }
+        }
     }
     *escp = esc;
     retval = 0;
@@ -563,7 +700,15 @@ xml_chardata_cbuf_append(cbuf *cb,
             }
             cbuf_append(cb, str[i]);
         }
-        else
+        else{
+        size_t run = xml_chardata_runlen(&str[i], len - i);
+
+        if (run){ /* Append run that needs no escaping as one block */
+            cbuf_append_buf(cb, &str[i], run);
+            i += run;
+            if (i >= len)
+                break;
+        }
         switch (str[i]){
         case '&':
             cbuf_append_str(cb, "&amp;");
@@ -582,6 +727,7 @@ xml_chardata_cbuf_append(cbuf *cb,
         default:
             cbuf_append(cb, str[i]);
         }
+        }
     }
     retval = 0;
     // done:
@@ -661,6 +807,8 @@ xml_chardata_decode_ampersand(char *str,
 }
 
 /*! Decode escape characters according to XML definition
+ * Entity-free runs are located with memchr and bulk-copied; the entity decoder
+ * only runs on the (rare) spans following an ampersand.
  * @param[out]  decp   Decoded malloced output string
  * @param[in]   fmt    Encoded input string (stdarg format string)
  * @see xml_chardata_encode for encoding
@@ -672,9 +820,11 @@ xml_chardata_decode(char      **decp,
     int     retval = -1;
     char   *str = NULL;  /* Expanded encoded format string w stdarg */
     char   *dec = NULL;
+    char   *amp;
     int     fmtlen;
     va_list args;
     size_t  slen;
+    size_t  run;
     int     i;
     int     j;
     char    ch;
@@ -703,20 +853,28 @@ xml_chardata_decode(char      **decp,
     }
     j = 0;
     memset(dec, 0, slen+1);
-    for (i=0; i<slen; i++){
-        ch = str[i];
-        switch (ch){
-        case '&':
-            if ((ret = xml_chardata_decode_ampersand(&str[i+1], &ch, &i)) < 0)
-                goto done;
-            if (ret == 0)
-                dec[j++] = str[i];
-            else
-                dec[j++] = ch;
-            break;
-        default:
-            dec[j++] = str[i];
+    i = 0;
+    while (i < slen){
+        /* Bulk-copy the run up to the next entity, typically the whole string */
+        if ((amp = memchr(&str[i], '&', slen - i)) == NULL)
+            run = slen - i;
+        else
+            run = amp - &str[i];
+        if (run){
+            memcpy(&dec[j], &str[i], run);
+            j += run;
+            i += run;
+            if (i >= slen)
+                break;
         }
+        ch = str[i]; /* '&' */
+        if ((ret = xml_chardata_decode_ampersand(&str[i+1], &ch, &i)) < 0)
+            goto done;
+        if (ret == 0)
+            dec[j++] = str[i];
+        else
+            dec[j++] = ch;
+        i++;
     }
     *decp = dec;
     retval = 0;
@@ -1038,6 +1196,65 @@ clicon_strcmp(char *s1,
 }
 
 
+/*! Append indentation whitespace to a cbuf without printf formatting
+ *
+ * Raw replacement for cprintf(cb, "%*s", n, "") in serialization hot paths:
+ * appends from a constant blank buffer with the length known up front.
+ * @param[in,out] cb  CLIgen buf
+ * @param[in]     n   Number of spaces
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+int
+clixon_cbuf_append_indent(cbuf *cb,
+                          int   n)
+{
+    static const char blanks[64] = "                                                                ";
+
+    while (n > (int)sizeof(blanks)){
+        if (cbuf_append_buf(cb, (void*)blanks, sizeof(blanks)) < 0)
+            return -1;
+        n -= sizeof(blanks);
+    }
+    if (n > 0 &&
+        cbuf_append_buf(cb, (void*)blanks, n) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Append a decimal integer to a cbuf without printf formatting
+ *
+ * Raw replacement for cprintf(cb, "%" PRId64, i): digits are generated into a
+ * stack buffer and appended with the length known.
+ * @param[in,out] cb  CLIgen buf
+ * @param[in]     i   Integer value
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+int
+clixon_cbuf_append_int(cbuf    *cb,
+                       int64_t  i)
+{
+    char     buf[21]; /* -9223372036854775808 */
+    char    *p = buf + sizeof(buf);
+    uint64_t u;
+    int      neg = 0;
+
+    if (i < 0){
+        neg = 1;
+        u = -(uint64_t)i;
+    }
+    else
+        u = (uint64_t)i;
+    do {
+        *--p = '0' + u%10;
+        u /= 10;
+    } while (u);
+    if (neg)
+        *--p = '-';
+    return cbuf_append_buf(cb, p, buf + sizeof(buf) - p);
+}
+
 /*! strndup() for systems without it, such as xBSD
  */
 #ifndef HAVE_STRNDUP
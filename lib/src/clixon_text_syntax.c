@@ -68,9 +68,6 @@
 #include "clixon_text_syntax.h"
 #include "clixon_text_syntax_parse.h"
 
-/* Size of json read buffer when reading from file*/
-#define BUFLEN 1024
-
 /* Name of xml top object created by parse functions
  * See also DATASTORE_TOP_SYMBOL which is the clixon datastore top symbol. By default also config
  */
@@ -189,10 +186,13 @@ xml2txt1(cxobj            *xn,
                 goto done;
             }
             value = xml_value(xn);
-            if (index(value, ' ') != NULL)
-                cprintf(cb, "\"%s\"", value);
+            if (index(value, ' ') != NULL){
+                cbuf_append_str(cb, "\"");
+                cbuf_append_str(cb, value);
+                cbuf_append_str(cb, "\"");
+            }
             else
-                cprintf(cb, "%s", value);
+                cbuf_append_str(cb, value);
             if (*leafl)                            /* Skip keyword if leaflist */
                 (*fn)(f, "%*s%s\n", PRETTYPRINT_INDENT*level, "", cbuf_get(cb));
             else
@@ -365,23 +365,24 @@ text_populate_list(cxobj *xn)
     return retval;
 }
 
-/*! Parse a string containing text syntax and return an XML tree
+/*! Parse a string or file stream containing text syntax and return an XML tree
  *
 
- * @param[in]  str    Input string containing JSON
- * @param[in]  rfc7951 Do sanity checks according to RFC 7951 JSON Encoding of Data Modeled with YANG
+ * @param[in]  str    Input string containing JSON, or NULL if fp is given
+ * @param[in]  fp     Input file stream, lexed in chunks, or NULL if str is given
  * @param[in]  yb     How to bind yang to XML top-level when parsing (if rfc7951)
  * @param[in]  yspec  Yang specification (if rfc 7951)
  * @param[out] xt     XML top of tree typically w/o children on entry (but created)
- * @param[out] xerr   Reason for invalid returned as netconf err msg 
+ * @param[out] xerr   Reason for invalid returned as netconf err msg
  * @retval        1   OK and valid
  * @retval        0   Invalid (only if yang spec)
  * @retval       -1   Error with clicon_err called
  * @see _xml_parse for XML variant
  * @note Parsing requires YANG, which means yb must be YB_MODULE/_NEXT
  */
-static int 
-_text_syntax_parse(char      *str, 
+static int
+_text_syntax_parse(char      *str,
+                   FILE      *fp,
                    yang_bind  yb,
                    yang_stmt *yspec,
                    cxobj     *xt,
@@ -395,12 +396,13 @@ _text_syntax_parse(char      *str,
     int                     failed = 0; /* yang assignment */
     cxobj                  *xc;
     
-    clicon_debug(1, "%s %d %s", __FUNCTION__, yb, str);
+    clicon_debug(1, "%s %d %s", __FUNCTION__, yb, str?str:"(file)");
     if (yb != YB_MODULE && yb != YB_MODULE_NEXT){
         clicon_err(OE_YANG, EINVAL, "yb must be YB_MODULE or YB_MODULE_NEXT");
         return -1;
     }
     ts.ts_parse_string = str;
+    ts.ts_parse_file = fp;
     ts.ts_linenum = 1;
     ts.ts_xtop = xt;
     ts.ts_yspec = yspec;
@@ -498,7 +500,7 @@ clixon_text_syntax_parse_string(char      *str,
         if ((*xt = xml_new("top", NULL, CX_ELMNT)) == NULL)
             return -1;
     }
-    return _text_syntax_parse(str, yb, yspec, *xt, xerr);
+    return _text_syntax_parse(str, NULL, yb, yspec, *xt, xerr);
 }
 
 /*! Read a TEXT syntax definition from file and parse it into a parse-tree. 
@@ -540,62 +542,33 @@ clixon_text_syntax_parse_file(FILE      *fp,
 {
     int       retval = -1;
     int       ret;
-    char     *textbuf = NULL;
-    int       textbuflen = BUFLEN; /* start size */
-    int       oldtextbuflen;
-    char     *ptr;
-    char      ch;
-    int       len = 0;
+    int       ch;
 
     if (xt == NULL){
         clicon_err(OE_XML, EINVAL, "xt is NULL");
         return -1;
     }
-    if ((textbuf = malloc(textbuflen)) == NULL){
-        clicon_err(OE_XML, errno, "malloc");
+    if (*xt == NULL)
+        if ((*xt = xml_new(TEXT_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    /* Empty input is accepted here but not by the grammar, see _text_syntax_parse */
+    if ((ch = fgetc(fp)) == EOF){
+        retval = 1;
         goto done;
     }
-    memset(textbuf, 0, textbuflen);
-    ptr = textbuf;
-    while (1){
-        if ((ret = fread(&ch, 1, 1, fp)) < 0){
-            clicon_err(OE_XML, errno, "read");
-            break;
-        }
-        if (ret != 0)
-            textbuf[len++] = ch;
-        if (ret == 0){
-            if (*xt == NULL)
-                if ((*xt = xml_new(TEXT_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-                    goto done;
-            if (len){
-                if ((ret = _text_syntax_parse(ptr, yb, yspec, *xt, xerr)) < 0)
-                    goto done;
-                if (ret == 0)
-                    goto fail;
-            }
-            break;
-        }
-        if (len >= textbuflen-1){ /* Space: one for the null character */
-            oldtextbuflen = textbuflen;
-            textbuflen *= 2;
-            if ((textbuf = realloc(textbuf, textbuflen)) == NULL){
-                clicon_err(OE_XML, errno, "realloc");
-                goto done;
-            }
-            memset(textbuf+oldtextbuflen, 0, textbuflen-oldtextbuflen);
-            ptr = textbuf;
-        }
-    }
+    ungetc(ch, fp);
+    /* The lexer reads the stream in chunks, the file is never buffered in full */
+    if ((ret = _text_syntax_parse(NULL, fp, yb, yspec, *xt, xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
     retval = 1;
  done:
     if (retval < 0 && *xt){
-        free(*xt);
+        xml_free(*xt);
         *xt = NULL;
     }
-    if (textbuf)
-        free(textbuf);
-    return retval;    
+    return retval;
  fail:
     retval = 0;
     goto done;
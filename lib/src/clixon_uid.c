@@ -54,6 +54,7 @@
 #include <errno.h>
 #include <grp.h>
 #include <pwd.h>
+#include <sys/time.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -63,6 +64,82 @@
 #include "clixon_log.h"
 #include "clixon_uid.h"
 
+/*
+ * NSS lookup cache: resolved name<->id entries kept NSS_CACHE_TTL seconds
+ * (see clixon_custom.h), keyed by name or id. With LDAP-backed NSS each
+ * getpwnam_r/getgrnam_r is a network call, and the backend resolves peer
+ * credentials per session. Positive entries only: failed lookups are not
+ * cached so a user added mid-TTL is seen at once.
+ */
+struct nss_cache_ent {
+    struct nss_cache_ent *nc_next;
+    char                 *nc_name;  /* User or group name, malloced */
+    uid_t                 nc_id;    /* uid, or gid cast for the group list */
+    struct timeval        nc_time;  /* When resolved, for TTL expiry */
+};
+static struct nss_cache_ent *_nss_users = NULL;  /* name<->uid, both directions */
+static struct nss_cache_ent *_nss_groups = NULL; /* name->gid */
+
+/*! Find a cached NSS entry by name or id, expiring stale entries on the way
+ * @param[in,out] listp  Cache list head
+ * @param[in]     name   Name to match, or NULL
+ * @param[in]     id     Id to match, or NULL
+ * @retval        ent    Cache entry
+ * @retval        NULL   Not cached (or cache disabled)
+ */
+static struct nss_cache_ent *
+nss_cache_lookup(struct nss_cache_ent **listp,
+                 const char            *name,
+                 const uid_t           *id)
+{
+    struct nss_cache_ent  *nc;
+    struct nss_cache_ent **prev;
+    struct timeval         now;
+
+    if (NSS_CACHE_TTL == 0)
+        return NULL;
+    gettimeofday(&now, NULL);
+    prev = listp;
+    while ((nc = *prev) != NULL){
+        if (now.tv_sec - nc->nc_time.tv_sec >= NSS_CACHE_TTL){
+            *prev = nc->nc_next;
+            free(nc->nc_name);
+            free(nc);
+            continue;
+        }
+        if ((name != NULL && strcmp(nc->nc_name, name) == 0) ||
+            (id != NULL && nc->nc_id == *id))
+            return nc;
+        prev = &nc->nc_next;
+    }
+    return NULL;
+}
+
+/*! Cache a resolved NSS entry
+ * Failure to cache is not an error: the caller already has the result.
+ */
+static void
+nss_cache_add(struct nss_cache_ent **listp,
+              const char            *name,
+              uid_t                  id)
+{
+    struct nss_cache_ent *nc;
+
+    if (NSS_CACHE_TTL == 0)
+        return;
+    if ((nc = malloc(sizeof(*nc))) == NULL)
+        return;
+    memset(nc, 0, sizeof(*nc));
+    if ((nc->nc_name = strdup(name)) == NULL){
+        free(nc);
+        return;
+    }
+    nc->nc_id = id;
+    gettimeofday(&nc->nc_time, NULL);
+    nc->nc_next = *listp;
+    *listp = nc;
+}
+
 /*! Translate group name to gid. Return -1 if error or not found.
  * @param[in]   name  Name of group
  * @param[out]  gid   Group id
@@ -73,13 +150,19 @@ int
 group_name2gid(const char *name, 
                gid_t      *gid)
 {
-    int           retval = -1;
-    char          buf[1024]; 
-    struct group  g0;
-    struct group *gr = &g0;
-    struct group *gtmp;
-    
-    gr = &g0; 
+    int                   retval = -1;
+    char                  buf[1024];
+    struct group          g0;
+    struct group         *gr = &g0;
+    struct group         *gtmp;
+    struct nss_cache_ent *nc;
+
+    if ((nc = nss_cache_lookup(&_nss_groups, name, NULL)) != NULL){
+        if (gid)
+            *gid = (gid_t)nc->nc_id;
+        return 0;
+    }
+    gr = &g0;
     /* This leaks memory in ubuntu */
     if (getgrnam_r(name, gr, buf, sizeof(buf), &gtmp) < 0){
         clicon_err(OE_UNIX, errno, "getgrnam_r(%s)", name);
@@ -89,6 +172,7 @@ group_name2gid(const char *name,
         clicon_err(OE_UNIX, 0, "No such group: %s", name);
         goto done;
     }
+    nss_cache_add(&_nss_groups, name, (uid_t)gr->gr_gid);
     if (gid)
         *gid = gr->gr_gid;
     retval = 0;
@@ -106,11 +190,17 @@ int
 name2uid(const char *name,
          uid_t      *uid)
 {
-    int            retval = -1;
-    char           buf[1024]; 
-    struct passwd  pwbuf;
-    struct passwd *pwbufp = NULL;
+    int                   retval = -1;
+    char                  buf[1024];
+    struct passwd         pwbuf;
+    struct passwd        *pwbufp = NULL;
+    struct nss_cache_ent *nc;
 
+    if ((nc = nss_cache_lookup(&_nss_users, name, NULL)) != NULL){
+        if (uid)
+            *uid = nc->nc_id;
+        return 0;
+    }
     if (getpwnam_r(name, &pwbuf, buf, sizeof(buf), &pwbufp) != 0){
         clicon_err(OE_UNIX, errno, "getpwnam_r(%s)", name);
         goto done;
@@ -119,6 +209,7 @@ name2uid(const char *name,
         clicon_err(OE_UNIX, 0, "No such user: %s", name);
         goto done;
     }
+    nss_cache_add(&_nss_users, name, pwbufp->pw_uid);
     if (uid)
         *uid = pwbufp->pw_uid;
     retval = 0;
@@ -136,11 +227,19 @@ int
 uid2name(const uid_t uid,
          char      **name)
 {
-    int            retval = -1;
-    char           buf[1024]; 
-    struct passwd  pwbuf = {0,};
-    struct passwd *pwbufp = NULL;
-    
+    int                   retval = -1;
+    char                  buf[1024];
+    struct passwd         pwbuf = {0,};
+    struct passwd        *pwbufp = NULL;
+    struct nss_cache_ent *nc;
+
+    if ((nc = nss_cache_lookup(&_nss_users, NULL, &uid)) != NULL){
+        if (name && (*name = strdup(nc->nc_name)) == NULL){
+            clicon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        return 0;
+    }
     if (getpwuid_r(uid, &pwbuf, buf, sizeof(buf), &pwbufp) != 0){
         clicon_err(OE_UNIX, errno, "getpwuid_r(%u)", uid);
         goto done;
@@ -150,6 +249,7 @@ uid2name(const uid_t uid,
         goto done;
     }
 
+    nss_cache_add(&_nss_users, pwbufp->pw_name, uid);
     if (name){
         if ((*name = strdup(pwbufp->pw_name)) == NULL){
             clicon_err(OE_UNIX, errno, "strdup");
@@ -82,6 +82,174 @@
 #include "clixon_validate_minmax.h"
 #include "clixon_validate.h"
 
+/*
+ * Per-validation-pass memo of leafref target value sets
+ * Maps (leafref type, shared context node) to the set of values of the
+ * referred leafs, so that N instances of the same leafref type are validated
+ * with one xpath evaluation and N hash lookups instead of N evaluations,
+ * which is quadratic on large referencing lists. The memo is created at the
+ * start of a validation pass and dropped at its end; the tree is stable in
+ * between so no invalidation is needed.
+ * Attached to the handle with clicon_ptr, see leafref_vcache_begin
+ */
+#define LEAFREF_VCACHE_NAME "leafref-vcache"
+
+struct leafref_vcache {
+    clicon_hash_t  *lv_sets; /* Hash from (type,context) key to value-set hash */
+};
+
+/*! Create and attach a leafref value-set memo for the extent of a validation pass
+ * @param[in]  h  Clixon handle
+ * @retval     1  Created, caller owns it and must call leafref_vcache_end
+ * @retval     0  Already attached (outer caller owns it)
+ * @retval    -1  Error
+ */
+static int
+leafref_vcache_begin(clicon_handle h)
+{
+    struct leafref_vcache *vc = NULL;
+
+    clicon_ptr_get(h, LEAFREF_VCACHE_NAME, (void**)&vc);
+    if (vc != NULL)
+        return 0;
+    if ((vc = malloc(sizeof(*vc))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memset(vc, 0, sizeof(*vc));
+    if ((vc->lv_sets = clicon_hash_init()) == NULL){
+        free(vc);
+        return -1;
+    }
+    if (clicon_ptr_set(h, LEAFREF_VCACHE_NAME, vc) < 0){
+        clicon_hash_free(vc->lv_sets);
+        free(vc);
+        return -1;
+    }
+    return 1;
+}
+
+/*! Detach and free the leafref value-set memo
+ * @param[in]  h  Clixon handle
+ */
+static int
+leafref_vcache_end(clicon_handle h)
+{
+    struct leafref_vcache *vc = NULL;
+    char                 **keys = NULL;
+    size_t                 klen = 0;
+    clicon_hash_t        **setp;
+    int                    i;
+
+    clicon_ptr_get(h, LEAFREF_VCACHE_NAME, (void**)&vc);
+    if (vc == NULL)
+        return 0;
+    if (clicon_hash_keys(vc->lv_sets, &keys, &klen) == 0)
+        for (i=0; i<klen; i++)
+            if ((setp = (clicon_hash_t **)clicon_hash_value(vc->lv_sets, keys[i], NULL)) != NULL)
+                clicon_hash_free(*setp);
+    if (keys)
+        free(keys);
+    clicon_hash_free(vc->lv_sets);
+    free(vc);
+    clicon_ptr_set(h, LEAFREF_VCACHE_NAME, NULL);
+    return 0;
+}
+
+/*! Validate a leafref value against the memoized set of referred leaf values
+ *
+ * Only paths whose non-ascending part is instance-independent can share a
+ * value set between instances: no predicates (which may use current()) and
+ * ".." steps only as a prefix. The shared context is the root for absolute
+ * paths and the ancestor the "../" prefix climbs to for relative ones; the
+ * path tail is evaluated once from there and the leaf values collected in a
+ * hash set.
+ * @param[in]  h        Clixon handle
+ * @param[in]  xt       XML leaf node of type leafref
+ * @param[in]  ytype    Resolved yang type (for the memo key)
+ * @param[in]  path_arg Argument of the path statement
+ * @param[in]  nsc      Namespace context of the path
+ * @param[in]  body     Leafref value to look up
+ * @param[out] matchp   Set if a referred leaf with value body exists
+ * @retval     1        Answered, matchp is valid
+ * @retval     0        Not answerable from the memo, use direct evaluation
+ * @retval    -1        Error
+ */
+static int
+validate_leafref_vcache(clicon_handle h,
+                        cxobj        *xt,
+                        yang_stmt    *ytype,
+                        char         *path_arg,
+                        cvec         *nsc,
+                        char         *body,
+                        int          *matchp)
+{
+    int                    retval = 0; /* not answerable */
+    struct leafref_vcache *vc = NULL;
+    cxobj                 *ctx;
+    char                  *tail;
+    char                   key[64];
+    clicon_hash_t        **setp;
+    clicon_hash_t         *set = NULL;
+    cxobj                **xvec = NULL;
+    size_t                 xlen = 0;
+    char                  *leafbody;
+    int                    i;
+
+    if (h == NULL)
+        goto done;
+    clicon_ptr_get(h, LEAFREF_VCACHE_NAME, (void**)&vc);
+    if (vc == NULL) /* No validation pass in progress */
+        goto done;
+    if (strchr(path_arg, '[') != NULL) /* predicates may use current() */
+        goto done;
+    ctx = xt;
+    tail = path_arg;
+    if (*tail == '/'){ /* absolute: context shared by all instances is the root */
+        while (xml_parent(ctx))
+            ctx = xml_parent(ctx);
+    }
+    else{
+        while (strncmp(tail, "../", 3) == 0){
+            tail += 3;
+            if ((ctx = xml_parent(ctx)) == NULL)
+                goto done;
+        }
+        if (strstr(tail, "..") != NULL) /* non-prefix ascent: instance-dependent */
+            goto done;
+    }
+    snprintf(key, sizeof(key), "%p-%p", ytype, ctx);
+    if ((setp = (clicon_hash_t **)clicon_hash_value(vc->lv_sets, key, NULL)) != NULL)
+        set = *setp;
+    else{
+        /* Evaluate the path once from the shared context and collect leaf values */
+        if ((set = clicon_hash_init()) == NULL)
+            goto err;
+        if (xpath_vec(ctx, nsc, "%s", &xvec, &xlen,
+                      *path_arg=='/' ? path_arg : tail) < 0)
+            goto err;
+        for (i = 0; i < xlen; i++){
+            if ((leafbody = xml_body(xvec[i])) == NULL)
+                continue;
+            if (clicon_hash_add(set, leafbody, "", 1) == NULL)
+                goto err;
+        }
+        if (clicon_hash_add(vc->lv_sets, key, &set, sizeof(set)) == NULL)
+            goto err;
+    }
+    *matchp = (clicon_hash_lookup(set, body) != NULL);
+    retval = 1;
+ done:
+    if (xvec)
+        free(xvec);
+    return retval;
+ err:
+    if (set)
+        clicon_hash_free(set);
+    retval = -1;
+    goto done;
+}
+
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
  * @param[in]  xt    XML leaf node of type leafref
  * @param[in]  ys    Yang spec of leaf
@@ -115,10 +283,11 @@
  * 
  */
 static int
-validate_leafref(cxobj     *xt,
-                 yang_stmt *ys,
-                 yang_stmt *ytype,
-                 cxobj    **xret)
+validate_leafref(clicon_handle h,
+                 cxobj        *xt,
+                 yang_stmt    *ys,
+                 yang_stmt    *ytype,
+                 cxobj       **xret)
 {
     int          retval = -1;
     yang_stmt   *ypath;
@@ -135,6 +304,8 @@ validate_leafref(cxobj     *xt,
     yang_stmt   *ymod;
     cg_var      *cv;
     int          require_instance = 1;
+    int          ret;
+    int          match = 0;
     
     /* require instance */
     if ((yreqi = yang_find(ytype, Y_REQUIRE_INSTANCE, NULL)) != NULL){
@@ -164,16 +335,23 @@ validate_leafref(cxobj     *xt,
         goto ok;
     if (xml_nsctx_yang(ys, &nsc) < 0)
         goto done;
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0) 
+    /* First try the per-pass memo of target value sets, O(1) per instance */
+    if ((ret = validate_leafref_vcache(h, xt, ytype, path_arg, nsc,
+                                       leafrefbody, &match)) < 0)
         goto done;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if ((leafbody = xml_body(x)) == NULL)
-            continue;
-        if (strcmp(leafbody, leafrefbody) == 0)
-            break;
+    if (ret == 0){ /* Not answerable from memo: evaluate path for this instance */
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0) 
+            goto done;
+        for (i = 0; i < xlen; i++) {
+            x = xvec[i];
+            if ((leafbody = xml_body(x)) == NULL)
+                continue;
+            if (strcmp(leafbody, leafrefbody) == 0)
+                break;
+        }
+        match = (i < xlen);
     }
-    if (i==xlen){
+    if (!match){
         if ((cberr = cbuf_new()) == NULL){
             clicon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
@@ -240,9 +418,9 @@ validate_identityref(cxobj     *xt,
     char       *id = NULL;
     cbuf       *cberr = NULL;
     cbuf       *cb = NULL;
-    cvec       *idrefvec; /* Derived identityref list: (module:id)**/
     yang_stmt  *ymod;
-    
+    int         ret;
+
     if ((cb = cbuf_new()) == NULL){
         clicon_err(OE_UNIX, errno, "cbuf_new"); 
         goto done;
@@ -290,12 +468,13 @@ validate_identityref(cxobj     *xt,
         goto fail;
     }
     cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-    idref = cbuf_get(cb);       
-    /* Here check if node is in the derived node list of the base identity 
-     * The derived node list is a cvec computed XXX
+    idref = cbuf_get(cb);
+    /* Here check if node is in the derived node set of the base identity,
+     * hashed, see ys_populate_identity where the underlying cvec is computed
      */
-    idrefvec = yang_cvec_get(ybaseid);
-    if (cvec_find(idrefvec, idref) == NULL){
+    if ((ret = yang_valcache_lookup(ybaseid, idref)) < 0)
+        goto done;
+    if (ret == 0){
         cprintf(cberr, "Identityref validation failed, %s not derived from %s in %s.yang:%d", 
                 node,
                 yang_argument_get(ybaseid),
@@ -973,30 +1152,123 @@ check_mandatory(cxobj     *xt,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for added entry
- * 1. Check if mandatory leafs present as subs.
- * 2. Check leaf values, eg int ranges and string regexps.
+/*! A column of parsed leaf values sharing one yang spec
+ *
+ * Collected during the xml_yang_validate_add walk and validated in one batch
+ * afterwards, so that the type is resolved and the pattern regexps fetched
+ * once per spec instead of once per value. This covers both leaf-lists and
+ * list "columns", ie the same leaf repeated across many list entries.
+ */
+struct validate_column{
+    yang_stmt *vc_ys;     /* Yang spec shared by all values */
+    cg_var   **vc_cvs;    /* Vector of parsed values */
+    int        vc_len;    /* Number of values */
+    int        vc_max;    /* Allocated length of vc_cvs */
+};
+
+/* Set of columns for one validation run */
+struct validate_columns{
+    struct validate_column *vcs_vec;  /* Vector of columns, one per leaf spec */
+    int                     vcs_nr;   /* Number of columns */
+    int                     vcs_max;  /* Allocated length of vcs_vec */
+    struct validate_column *vcs_last; /* Column of previous value: the walk
+                                         mostly visits the same spec in runs */
+};
+
+/*! Append a parsed value to the column of its yang spec, create column if new
+ * @param[in]  vcs  Column set
+ * @param[in]  ys   Yang spec of the value
+ * @param[in]  cv   Parsed value, ownership is passed to the column
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+validate_column_add(struct validate_columns *vcs,
+                    yang_stmt               *ys,
+                    cg_var                  *cv)
+{
+    struct validate_column *vc = NULL;
+    int                     i;
+
+    if (vcs->vcs_last && vcs->vcs_last->vc_ys == ys)
+        vc = vcs->vcs_last;
+    else
+        for (i=0; i<vcs->vcs_nr; i++)
+            if (vcs->vcs_vec[i].vc_ys == ys){
+                vc = &vcs->vcs_vec[i];
+                break;
+            }
+    if (vc == NULL){
+        if (vcs->vcs_nr == vcs->vcs_max){
+            struct validate_column *vec;
+            int                     max = vcs->vcs_max ? 2*vcs->vcs_max : 32;
+
+            if ((vec = realloc(vcs->vcs_vec, max*sizeof(*vec))) == NULL){
+                clicon_err(OE_UNIX, errno, "realloc");
+                return -1;
+            }
+            memset(&vec[vcs->vcs_max], 0, (max - vcs->vcs_max)*sizeof(*vec));
+            vcs->vcs_vec = vec;
+            vcs->vcs_max = max;
+        }
+        vc = &vcs->vcs_vec[vcs->vcs_nr++];
+        vc->vc_ys = ys;
+    }
+    if (vc->vc_len == vc->vc_max){
+        cg_var **cvs;
+        int      max = vc->vc_max ? 2*vc->vc_max : 16;
+
+        if ((cvs = realloc(vc->vc_cvs, max*sizeof(cg_var *))) == NULL){
+            clicon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        vc->vc_cvs = cvs;
+        vc->vc_max = max;
+    }
+    vc->vc_cvs[vc->vc_len++] = cv;
+    vcs->vcs_last = vc;
+    return 0;
+}
+
+/*! Free all columns of a column set including the collected values
+ */
+static int
+validate_columns_free(struct validate_columns *vcs)
+{
+    int i;
+    int j;
+
+    for (i=0; i<vcs->vcs_nr; i++){
+        for (j=0; j<vcs->vcs_vec[i].vc_len; j++)
+            cv_free(vcs->vcs_vec[i].vc_cvs[j]);
+        if (vcs->vcs_vec[i].vc_cvs)
+            free(vcs->vcs_vec[i].vc_cvs);
+    }
+    if (vcs->vcs_vec)
+        free(vcs->vcs_vec);
+    memset(vcs, 0, sizeof(*vcs));
+    return 0;
+}
+
+/*! Recursive part of xml_yang_validate_add: walk tree, collect leaf values
+ *
+ * Node-local checks (choice, value parsing) are made in the walk, while type
+ * validation of the parsed values is deferred: values are collected per yang
+ * spec in vcs and validated column-wise by the caller.
+ * @param[in]  h     Clicon handle
  * @param[in]  xt    XML node to be validated
- * @param[out] xret    Error XML tree. Free with xml_free after use
- * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * @param[in]  vcs   Column set collecting parsed leaf values per spec
+ * @param[out] xret  Error XML tree. Free with xml_free after use
+ * @retval     1     Validation OK (so far, columns not yet validated)
+ * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_add(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- * @endcode
- * @see xml_yang_validate_all
- * @see xml_yang_validate_rpc
- * @note Should need a variant accepting cxobj **xret
+ * @see xml_yang_validate_add
  */
-int
-xml_yang_validate_add(clicon_handle h,
-                      cxobj        *xt, 
-                      cxobj       **xret)
+static int
+xml_yang_validate_add1(clicon_handle            h,
+                       cxobj                   *xt,
+                       struct validate_columns *vcs,
+                       cxobj                  **xret)
 {
     int          retval = -1;
     cg_var      *cv = NULL;
@@ -1007,7 +1279,7 @@ xml_yang_validate_add(clicon_handle h,
     cxobj       *x;
     cg_var      *cv0;
     enum cv_type cvtype;
-    
+
 #ifdef YANG_SCHEMA_MOUNT
     /* Do not validate beyond mountpoints */
     if ((ret = xml_yang_mount_get(xt, NULL)) < 0)
@@ -1017,7 +1289,7 @@ xml_yang_validate_add(clicon_handle h,
         goto done;
     }
 #endif
-    /* if not given by argument (overide) use default link 
+    /* if not given by argument (overide) use default link
        and !Node has a config sub-statement and it is false */
     if ((yt = xml_spec(xt)) != NULL && yang_config(yt) != 0){
         if ((ret = check_choice_child(xt, yt, xret)) < 0)
@@ -1057,13 +1329,10 @@ xml_yang_validate_add(clicon_handle h,
                     goto fail;
                 }
             }
-            if ((ret = ys_cv_validate(h, cv, yt, NULL, &reason)) < 0)
+            /* Defer type validation: collect into the column of this spec */
+            if (validate_column_add(vcs, yt, cv) < 0)
                 goto done;
-            if (ret == 0){
-                if (xret && netconf_bad_element_xml(xret, "application",  yang_argument_get(yt), reason) < 0)
-                    goto done;
-                goto fail;
-            }
+            cv = NULL; /* ownership passed to column */
             break;
         default:
             break;
@@ -1071,7 +1340,7 @@ xml_yang_validate_add(clicon_handle h,
     }
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_add(h, x, xret)) < 0)
+        if ((ret = xml_yang_validate_add1(h, x, vcs, xret)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -1088,6 +1357,69 @@ xml_yang_validate_add(clicon_handle h,
     goto done;
 }
 
+/*! Validate a single XML node with yang specification for added entry
+ * 1. Check if mandatory leafs present as subs.
+ * 2. Check leaf values, eg int ranges and string regexps.
+ * Leaf values are collected per yang spec during the walk and validated
+ * column-wise with one type resolve and one set of compiled pattern regexps
+ * per spec, see ys_cv_validate_batch. This turns validation of homogeneous
+ * columns, eg the same leaf across many list entries, into a tight loop.
+ * @param[in]  xt    XML node to be validated
+ * @param[out] xret    Error XML tree. Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_add(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ * @endcode
+ * @see xml_yang_validate_all
+ * @see xml_yang_validate_rpc
+ * @note Should need a variant accepting cxobj **xret
+ */
+int
+xml_yang_validate_add(clicon_handle h,
+                      cxobj        *xt,
+                      cxobj       **xret)
+{
+    int                     retval = -1;
+    struct validate_columns vcs = {0,};
+    struct validate_column *vc;
+    char                   *reason = NULL;
+    int                     ret;
+    int                     i;
+
+    if ((ret = xml_yang_validate_add1(h, xt, &vcs, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    /* Validate the collected columns, one batch per leaf spec */
+    for (i=0; i<vcs.vcs_nr; i++){
+        vc = &vcs.vcs_vec[i];
+        if ((ret = ys_cv_validate_batch(h, vc->vc_cvs, vc->vc_len, vc->vc_ys,
+                                        NULL, &reason)) < 0)
+            goto done;
+        if (ret == 0){
+            if (xret && netconf_bad_element_xml(xret, "application", yang_argument_get(vc->vc_ys), reason) < 0)
+                goto done;
+            goto fail;
+        }
+    }
+    retval = 1;
+ done:
+    validate_columns_free(&vcs);
+    if (reason)
+        free(reason);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Some checks done only at edit_config, eg keys in lists
  * @param[in]  xt     XML tree
  * @param[out] xret   Error XML tree. Free with xml_free after use
@@ -1152,7 +1484,7 @@ xml_yang_validate_leaf_union(clicon_handle h,
         restype = ytype?yang_argument_get(ytype):NULL;
         ret = 1; /* If not leafref/identityref it is valid on this level */
         if (strcmp(restype, "leafref") == 0){
-            if ((ret = validate_leafref(xt, yt, ytype, &xret1)) < 0) // XXX
+            if ((ret = validate_leafref(h, xt, yt, ytype, &xret1)) < 0) // XXX
                 goto done;
         }
         else if (strcmp(restype, "identityref") == 0){
@@ -1187,29 +1519,22 @@ xml_yang_validate_leaf_union(clicon_handle h,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for all (not only added) entries
- * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
+/*! Validation checks local to a single XML node, no descent into children
+ * Checks when/must conditions, mandatory/choice presence and type-specific
+ * constraints such as leafrefs of xt itself.
+ * @param[in]  xt    XML node to be validated
+ * @param[out] skipp Set if descendants of xt should not be validated (anyxml/anydata)
  * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
  * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- *   xml_free(xret);
- * @endcode
- * @see xml_yang_validate_add
- * @see xml_yang_validate_rpc
+ * @see xml_yang_validate_all  for the recursive variant
  */
-int
-xml_yang_validate_all(clicon_handle h,
-                      cxobj        *xt, 
-                      cxobj       **xret)
+static int
+xml_yang_validate_node(clicon_handle h,
+                       cxobj        *xt,
+                       int          *skipp,
+                       cxobj       **xret)
 {
     int        retval = -1;
     yang_stmt *yt;  /* yang node associated with xt */
@@ -1218,20 +1543,12 @@ xml_yang_validate_all(clicon_handle h,
     char      *xpath;
     int        nr;
     int        ret;
-    cxobj     *x;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
     cvec      *nsc = NULL;
     int        hit = 0;
 
-#ifdef YANG_SCHEMA_MOUNT
-    /* Do not validate beyond mountpoints */
-    if ((ret = xml_yang_mount_get(xt, NULL)) < 0)
-        goto done;
-    if (ret == 1)
-        goto ok;
-#endif
     /* if not given by argument (overide) use default link 
        and !Node has a config sub-statement and it is false */
     if ((yt = xml_spec(xt)) == NULL){
@@ -1239,6 +1556,7 @@ xml_yang_validate_all(clicon_handle h,
             clicon_log(LOG_WARNING,
                        "%s: %d: No YANG spec for %s, validation skipped",
                        __FUNCTION__, __LINE__, xml_name(xt));
+            *skipp = 1; /* do not descend */
             goto ok;
         }
         if ((cb = cbuf_new()) == NULL){
@@ -1281,6 +1599,7 @@ xml_yang_validate_all(clicon_handle h,
         switch (yang_keyword_get(yt)){
         case Y_ANYXML:
         case Y_ANYDATA:
+            *skipp = 1; /* do not descend */
             goto ok;
             break;
         case Y_LEAF:
@@ -1293,7 +1612,7 @@ xml_yang_validate_all(clicon_handle h,
             if (yang_type_get(yt, NULL, &yc, NULL, NULL, NULL, NULL, NULL) < 0)
                 goto done;
             if (strcmp(yang_argument_get(yc), "leafref") == 0){
-                if ((ret = validate_leafref(xt, yt, yc, xret)) < 0)
+                if ((ret = validate_leafref(h, xt, yt, yc, xret)) < 0)
                     goto done;
                 if (ret == 0)
                     goto fail;
@@ -1318,16 +1637,22 @@ xml_yang_validate_all(clicon_handle h,
          * XXX. use yang path instead? */
         yc = NULL;
         while ((yc = yn_each(yt, yc)) != NULL) {
+            struct xpath_tree *xpt; /* Pre-compiled xpath, see ys_precompile_xpath */
+
             if (yang_keyword_get(yc) != Y_MUST)
                 continue;
             xpath = yang_argument_get(yc); /* "must" has xpath argument */
             /* the context node is the node in the accessible tree for
-             * which the "must" statement is defined. 
-             * The set of namespace declarations is the set of all "import" statements' 
+             * which the "must" statement is defined.
+             * The set of namespace declarations is the set of all "import" statements'
              */
            if (xml_nsctx_yang(yc, &nsc) < 0)
                goto done;
-            if ((nr = xpath_vec_bool(xt, nsc, "%s", xpath)) < 0)
+            if ((xpt = yang_xpath_cache_get(yc)) != NULL)
+                nr = xpath_vec_bool_tree(xt, nsc, xpt);
+            else
+                nr = xpath_vec_bool(xt, nsc, "%s", xpath);
+            if (nr < 0)
                 goto done;
             if (!nr){
                 ye = yang_find(yc, Y_ERROR_MESSAGE, NULL);
@@ -1348,6 +1673,63 @@ xml_yang_validate_all(clicon_handle h,
             }
         }
     }
+ ok:
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Validate a single XML node with yang specification for all (not only added) entries
+ * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
+ * @param[in]  xt  XML node to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ *   xml_free(xret);
+ * @endcode
+ * @see xml_yang_validate_add
+ * @see xml_yang_validate_rpc
+ */
+int
+xml_yang_validate_all(clicon_handle h,
+                      cxobj        *xt, 
+                      cxobj       **xret)
+{
+    int        retval = -1;
+    yang_stmt *yt;  /* yang node associated with xt */
+    int        ret;
+    cxobj     *x;
+    int        skip = 0;
+
+#ifdef YANG_SCHEMA_MOUNT
+    /* Do not validate beyond mountpoints */
+    if ((ret = xml_yang_mount_get(xt, NULL)) < 0)
+        goto done;
+    if (ret == 1)
+        goto ok;
+#endif
+    /* Checks local to xt: when/must/mandatory/choice and type-specific */
+    if ((ret = xml_yang_validate_node(h, xt, &skip, xret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (skip) /* anyxml/anydata and unknown-anydata: do not descend */
+        goto ok;
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
@@ -1356,7 +1738,8 @@ xml_yang_validate_all(clicon_handle h,
             goto fail;
     }
     /* Check unique and min-max after choice test for example*/
-    if (yang_config(yt) != 0){
+    if ((yt = xml_spec(xt)) != NULL &&
+        yang_config(yt) != 0){
         /* Checks if next level contains any unique list constraints */
         if ((ret = xml_yang_minmax_recurse(xt, xret)) < 0)
             goto done;
@@ -1366,16 +1749,60 @@ xml_yang_validate_all(clicon_handle h,
  ok:
     retval = 1;
  done:
-    if (cb)
-        cbuf_free(cb);
-    if (nsc)
-        xml_nsctx_free(nsc);
     return retval;
  fail:
     retval = 0;
     goto done;
 }
 
+/*! Validate a changed subtree and the constraints on its ancestor axis
+ *
+ * Alternative to validating the whole tree when the changed nodes are known,
+ * eg from the transaction diff: the subtree below xt is validated in full, and
+ * on each ancestor the node-local constraints (when/must/mandatory/choice and
+ * list min/max-elements, uniqueness) are re-checked since changes below can
+ * affect them. References into the changed region from untouched parts of the
+ * tree (eg leafrefs to a deleted node) are NOT covered: callers must fall
+ * back to full validation when nodes have been deleted.
+ * @param[in]  h     Clixon handle
+ * @param[in]  xt    Changed XML subtree to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ * @see xml_yang_validate_all_top  full-tree variant
+ */
+int
+xml_yang_validate_subtree(clicon_handle h,
+                          cxobj        *xt,
+                          cxobj       **xret)
+{
+    int    ret = -1;
+    cxobj *xp;
+    int    owner;
+
+    /* Memoize leafref target value sets over this pass, see validate_leafref */
+    if ((owner = leafref_vcache_begin(h)) < 0)
+        return -1;
+    if ((ret = xml_yang_validate_all(h, xt, xret)) < 1)
+        goto done;
+    for (xp = xml_parent(xt); xp; xp = xml_parent(xp)){
+        int skip = 0;
+
+        if (xml_spec(xp) != NULL)
+            if ((ret = xml_yang_validate_node(h, xp, &skip, xret)) < 1)
+                goto done;
+        /* Also at top where spec is NULL, see xml_yang_validate_all_top */
+        if ((ret = xml_yang_minmax_recurse(xp, xret)) < 1)
+            goto done;
+    }
+    ret = 1;
+ done:
+    if (owner == 1)
+        leafref_vcache_end(h);
+    return ret;
+}
+
 /*! Validate a single XML node with yang specification
  * @param[out] xret    Error XML tree (if ret == 0). Free with xml_free after use
  * @retval     1     Validation OK
@@ -1387,17 +1814,23 @@ xml_yang_validate_all_top(clicon_handle h,
                           cxobj        *xt, 
                           cxobj       **xret)
 {
-    int    ret;
+    int    ret = -1;
     cxobj *x;
+    int    owner;
 
+    /* Memoize leafref target value sets over this pass, see validate_leafref */
+    if ((owner = leafref_vcache_begin(h)) < 0)
+        return -1;
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
-            return ret;
+            goto done;
     }
-    if ((ret = xml_yang_minmax_recurse(xt, xret)) < 1)
-        return ret;
-    return 1;
+    ret = xml_yang_minmax_recurse(xt, xret);
+ done:
+    if (owner == 1)
+        leafref_vcache_end(h);
+    return ret;
 }
 
 /*! Check validity of outgoing RPC
@@ -79,59 +79,44 @@
 #include "clixon_xml_bind.h"
 #include "clixon_validate_minmax.h"
 
-/*! New element last in list, check if already exists if sp return -1
- * @param[in]  vec   Vector of existing entries (new is last)
- * @param[in]  i1    The new entry is placed at vec[i1]
- * @param[in]  vlen  Length of entry
- * @param[in]  sorted Sorted by system, ie sorted by key, otherwise no assumption
- * @retval     0     OK, entry is unique
- * @retval    -1     Duplicate detected
- * @note This is currently quadratic complexity. It could be improved by inserting new element sorted and binary search.
- * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
- * @retval    -1     Error
+/*! Evaluate unique xpath on one entry, check results against set of seen values
+ * @param[in]     x     List entry to evaluate xpath on
+ * @param[in]     xpath Canonical xpath of the unique constraint
+ * @param[in]     nsc   Namespace context of xpath
+ * @param[in,out] uhash Set of values seen in previous entries, extended here
+ * @retval        1     Validation OK
+ * @retval        0     Validation failed (cbret set)
+ * @retval       -1     Error
  */
 static int
-unique_search_xpath(cxobj  *x,
-                    char   *xpath,
-                    cvec   *nsc,
-                    char ***svec,
-                    size_t *slen)
+unique_search_xpath(cxobj         *x,
+                    char          *xpath,
+                    cvec          *nsc,
+                    clicon_hash_t *uhash)
 {
     int     retval = -1;
     cxobj **xvec = NULL;
     size_t  xveclen;
     int     i;
-    int     s;
     cxobj  *xi;
     char   *bi;
 
     /* Collect tuples */
-    if (xpath_vec(x, nsc, "%s", &xvec, &xveclen, xpath) < 0) 
-        goto done;      
+    if (xpath_vec(x, nsc, "%s", &xvec, &xveclen, xpath) < 0)
+        goto done;
     for (i=0; i<xveclen; i++){
         xi = xvec[i];
         if ((bi = xml_body(xi)) == NULL)
             break;
-        /* Check if bi is duplicate? 
-         * XXX: sort svec?
-         */
-        for (s=0; s<(*slen); s++){
-            if (strcmp(bi, (*svec)[s]) == 0){
-                goto fail;
-            }
-        }
-        (*slen) ++;
-        if (((*svec) = realloc((*svec), (*slen)*sizeof(char*))) == NULL){
-            clicon_err(OE_UNIX, errno, "realloc");
+        if (clicon_hash_lookup(uhash, bi) != NULL)
+            goto fail;
+        if (clicon_hash_add(uhash, bi, NULL, 0) == NULL)
             goto done;
-        }
-        (*svec)[(*slen)-1] = bi;
     } /* i search results */
     retval = 1;
  done:
     if (xvec)
-        free(xvec);    
+        free(xvec);
     return retval;
  fail:
     retval = 0;
@@ -215,21 +200,25 @@ check_unique_list_direct(cxobj     *x,
                          yang_stmt *yu,
                          cxobj    **xret)
 {
-    int       retval = -1;
-    cg_var    *cvi; /* unique node name */
-    cxobj     *xi;
-    char     **vec = NULL; /* 2xmatrix */
-    int        clen;
-    int        i;
-    int        v;
-    char      *bi;
-    int        sorted;
-    char      *str;
-    cvec      *cvk;
+    int            retval = -1;
+    cg_var        *cvi; /* unique node name */
+    cxobj         *xi;
+    char         **vec = NULL;   /* two-row key matrix for the sorted case */
+    clicon_hash_t *uhash = NULL; /* set of key tuples for the unsorted case */
+    cbuf          *cb = NULL;
+    int            clen;
+    int            row;
+    int            i;
+    int            v;
+    char          *bi;
+    int            sorted;
+    char          *str;
+    cvec          *cvk;
 
-    /* If list and is sorted by system, then it is assumed elements are in key-order which is optimized
-     * Other cases are "unique" constraint or list sorted by user which is quadratic in complexity
-     * This second case COULD be optimized if binary insert is made on the vec vector.
+    /* If list and is sorted by system, then it is assumed elements are in key-order and only
+     * adjacent entries need comparing.
+     * Other cases are "unique" constraint or list sorted by user, where seen key tuples are
+     * kept in a hash set.
      */
     sorted = (yang_keyword_get(yu) == Y_LIST &&
               yang_find(y, Y_ORDERED_BY, "user") == NULL);
@@ -239,18 +228,35 @@ check_unique_list_direct(cxobj     *x,
         /* No keys: no checks necessary */
         goto ok;
     }
-    if ((vec = calloc(clen*xml_child_nr(xt), sizeof(char*))) == NULL){
-        clicon_err(OE_UNIX, errno, "calloc");
-        goto done;
+    if (sorted){
+        /* Only the immediately preceding entry is compared, so two rows of
+         * key values suffice instead of a matrix over the whole list */
+        if ((vec = calloc(2*clen, sizeof(char*))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    }
+    else{
+        /* No key order to rely on: remember all key tuples seen in a hash set */
+        if ((uhash = clicon_hash_init()) == NULL)
+            goto done;
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
     }
-    /* A vector is built with key-values, for each iteration check "backward" in the vector
+    /* Each entry's key-values are checked "backward" against previous entries
      * for duplicates
      */
     i = 0; /* x element index */
     do {
+        row = i ? 1 : 0;
+        if (sorted && i)
+            memset(&vec[clen], 0, clen*sizeof(char*));
+        if (cb)
+            cbuf_reset(cb);
         cvi = NULL;
         v = 0; /* index in each tuple */
-        /* XXX Quadratic if clen > 1 */
         while ((cvi = cvec_each(cvk, cvi)) != NULL){
             /* RFC7950: Sec 7.8.3.1: entries that do not have value for all
              * referenced leafs are not taken into account */
@@ -263,25 +269,42 @@ check_unique_list_direct(cxobj     *x,
                 break;
             if ((bi = xml_body(xi)) == NULL)
                 break;
-            vec[i*clen + v++] = bi;
+            if (sorted)
+                vec[row*clen + v++] = bi;
+            else /* length-prefix each value so the tuple encodes unambiguously */
+                cprintf(cb, "%zu:%s", strlen(bi), bi);
         }
         if (cvi==NULL){
-            /* Last element (i) is newly inserted, see if it is already there */
-            if (check_insert_duplicate(vec, i, clen, sorted) < 0){
+            /* Complete tuple: see if it is already there */
+            if (sorted){
+                if (check_insert_duplicate(vec, row, clen, sorted) < 0){
+                    if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
+                        goto done;
+                    goto fail;
+                }
+            }
+            else if (clicon_hash_lookup(uhash, cbuf_get(cb)) != NULL){
                 if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
                     goto done;
                 goto fail;
             }
+            else if (clicon_hash_add(uhash, cbuf_get(cb), NULL, 0) == NULL)
+                goto done;
         }
+        if (sorted && i)
+            memcpy(vec, &vec[clen], clen*sizeof(char*)); /* current row becomes previous */
         x = xml_child_each(xt, x, CX_ELMNT);
         i++;
     } while (x && y == xml_spec(x));  /* stop if list ends, others may follow */
  ok:
-    /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
     if (vec)
         free(vec);
+    if (uhash)
+        clicon_hash_free(uhash);
+    if (cb)
+        cbuf_free(cb);
     return retval;
  fail:
     retval = 0;
@@ -318,16 +341,15 @@ check_unique_list(cxobj     *x,
                   yang_stmt *yu,
                   cxobj    **xret)
 {
-    int       retval = -1;
-    cg_var    *cvi; /* unique node name */
-    char     **svec = NULL; /* vector of search results */
-    size_t     slen = 0; 
-    char      *xpath0 = NULL;
-    char      *xpath1 = NULL;
-    int        ret;
-    cvec      *cvk;
-    cvec      *nsc0 = NULL;
-    cvec      *nsc1 = NULL;
+    int            retval = -1;
+    cg_var        *cvi; /* unique node name */
+    clicon_hash_t *uhash = NULL; /* set of search result values */
+    char          *xpath0 = NULL;
+    char          *xpath1 = NULL;
+    int            ret;
+    cvec          *cvk;
+    cvec          *nsc0 = NULL;
+    cvec          *nsc1 = NULL;
 
     /* Check if multiple direct children */
     cvk = yang_cvec_get(yu);
@@ -353,9 +375,11 @@ check_unique_list(cxobj     *x,
         goto done;
     if (ret == 0)
         goto fail; // XXX set xret
+    if ((uhash = clicon_hash_init()) == NULL)
+        goto done;
     do {
         /* Collect search results from one */
-        if ((ret = unique_search_xpath(x, xpath1, nsc1, &svec, &slen)) < 0)
+        if ((ret = unique_search_xpath(x, xpath1, nsc1, uhash)) < 0)
             goto done;
         if (ret == 0){
             if (xret && netconf_data_not_unique_xml(xret, x, cvk) < 0)
@@ -365,7 +389,6 @@ check_unique_list(cxobj     *x,
         x = xml_child_each(xt, x, CX_ELMNT);
     } while (x && y == xml_spec(x));  /* stop if list ends, others may follow */
     // ok:
-    /* It would be possible to cache vec here as an optimization */
     retval = 1;
  done:
     if (nsc0)
@@ -374,8 +397,8 @@ check_unique_list(cxobj     *x,
         cvec_free(nsc1);
     if (xpath1)
         free(xpath1);
-    if (svec)
-        free(svec);
+    if (uhash)
+        clicon_hash_free(uhash);
     return retval;
  fail:
     retval = 0;
@@ -677,7 +700,6 @@ xml_yang_minmax_recurse(cxobj  *xt,
                 if ((ret = check_minmax(xt, yprev, nr, xret)) < 0)
                     goto done;
             }
-            nr=1;
             /* new list check */
             if (ret &&
                 keyw == Y_LIST)
@@ -685,6 +707,11 @@ xml_yang_minmax_recurse(cxobj  *xt,
                     goto done;
             if (ret == 0)
                 goto fail;
+            /* Count the entries of this list by binary search over the sorted
+             * child vector and resume iteration after its last entry, instead
+             * of visiting every entry just to count them */
+            if ((nr = xml_child_span(xt, &x)) < 0)
+                goto done;
             yprev = y;
         }
         else{
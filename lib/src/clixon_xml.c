@@ -126,7 +126,17 @@ struct search_index{
 };
 #endif
 
-/*! xml tree node, with name, type, parent, children, etc 
+/*! Refcounted namespace context cache
+ * Nodes with an identical namespace context (the common case: no xmlns
+ * declarations of their own) share a single context instead of keeping
+ * per-node copies, see nscache_share / xml_nsctx_populate.
+ */
+struct xml_nscache{
+    int   nc_refcnt;  /* Number of xml nodes pointing at this cache */
+    cvec *nc_nsc;     /* Namespace context: prefix -> namespace */
+};
+
+/*! xml tree node, with name, type, parent, children, etc
  * Note that this is a private type not visible from externally, use
  * access functions.
  * A word on ordering of x_children:
@@ -160,52 +170,74 @@ struct search_index{
  * vocabulary's local names that is effective in avoiding name clashes.
  * @see struct xmlbody    For XML body and attributes
  */
+/* Inline value capacity of body/attribute nodes, including NUL: short values are
+ * stored in the node itself (see XML_FLAG_VALINLINE) instead of a heap buffer.
+ * Sized to the value union so inlining does not grow the node */
+#define XML_VALUE_INLINE_LEN 16
+
+/* Value storage of body/attribute nodes, representation given by node flags:
+ * XML_FLAG_VALINTERN: xv_str, shared interned string (see xml_value_intern)
+ * XML_FLAG_VALINLINE: xv_inl, value stored inline in the node, no allocation
+ * neither:            xv_cb, private heap buffer, or NULL if no value */
+union xml_value{
+    cbuf             *xv_cb;        /* private heap buffer (XXX: this consumes memory) cv? */
+    char             *xv_str;       /* shared interned string, do not free */
+    char              xv_inl[XML_VALUE_INLINE_LEN]; /* short value inline */
+};
+
 struct xml{
-    enum cxobj_type   x_type;       /* type of node: element, attribute, body */
     char             *x_name;       /* name of node */
     char             *x_prefix;     /* namespace localname N, called prefix */
-    uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
     struct xml       *x_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *x_up_candidate; /* Candidate parent node for special cases (when+xpath) */
 #endif
     int              _x_vector_i;   /* internal use: xml_child_each */
-    int              _x_i;          /* internal use for stable sorting: 
+    int              _x_i;          /* internal use for stable sorting:
                                        see xml_enumerate and xml_cmp */
+    uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
+    uint8_t           x_type;       /* type of node, enum cxobj_type: element, attribute, body */
     /*----- next is body/attribute only */
-    cbuf             *x_value_cb;  /* attribute and body nodes have values (XXX: this consumes 
-                                       memory) cv? */
+    union xml_value   x_value_u;    /* attribute and body nodes have values */
     /*----- up to here is common to all next is element only */
     struct xml      **x_childvec;   /* vector of children nodes (XXX: use clixon_vec ) */
     int               x_childvec_len;/* Number of children */
     int               x_childvec_max;/* Length of allocated vector */
+    int               x_nr_attr;    /* Number of CX_ATTR children, see xml_child_nr_type */
+    int               x_nr_body;    /* Number of CX_BODY children, see xml_child_nr_type */
 
 
-    cvec             *x_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
+    struct xml_nscache *x_ns_cache; /* Refcounted cached vector of namespaces (set by
+                                       bind-yang or xml_nsctx_populate), may be shared
+                                       with other nodes, see nscache_share */
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, 
                                        by reference, dont free */
     cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp) */
 #ifdef XML_EXPLICIT_INDEX
     struct search_index *x_search_index; /* explicit search index vectors */
 #endif
+#ifdef XML_LIST_KEYHASH
+    clicon_hash_t    *x_keyhash;    /* lazy list-key index, see clixon_xml_find_index */
+    int               x_keyhash_nr; /* child count when the index was built */
+#endif
 };
 
 /* Variant of struct xml for use by non-elements to save space
  * @see struct xml  For XML elements
  */
 struct xmlbody{
-    enum cxobj_type   xb_type;       /* type of node: element, attribute, body */
     char             *xb_name;       /* name of node */
     char             *xb_prefix;     /* namespace localname N, called prefix */
-    uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
     struct xml       *xb_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *xb_up_candidate; /* Candidate parent node for special cases (when+xpath) */
 #endif
     int              _xb_vector_i;   /* internal use: xml_child_each */
-    int              _xb_i;          /* internal use for sorting: 
+    int              _xb_i;          /* internal use for sorting:
                                        see xml_enumerate and xml_cmp */
-    cbuf             *xb_value_cb;  /* attribute and body nodes have values */
+    uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
+    uint8_t           xb_type;       /* type of node, enum cxobj_type */
+    union xml_value   xb_value_u;    /* attribute and body nodes have values */
 };
 
 /*
@@ -234,6 +266,86 @@ xml_type2str(enum cxobj_type type)
 /* Stats */
 static uint64_t _stats_xml_nr = 0;
 
+#ifdef XML_NODE_POOL
+/* Nodes carved per slab chunk */
+#define XML_POOL_CHUNK 512
+
+/* Node pool: LIFO free list threaded through the first word of each free
+ * node, backed by chunked slab allocations. One pool per node size,
+ * see struct xml vs struct xmlbody. Slabs are never returned to the system.
+ */
+struct xml_pool{
+    void    *xp_free;    /* Free list head */
+    size_t   xp_size;    /* Node size */
+    uint64_t xp_nchunks; /* Number of slabs allocated */
+};
+static struct xml_pool _pool_elmnt = {NULL, sizeof(struct xml), 0};
+static struct xml_pool _pool_body  = {NULL, sizeof(struct xmlbody), 0};
+
+/*! Take a node from the pool, carving a new slab if the free list is empty
+ * @retval  mem  Node memory of xp->xp_size bytes, not zeroed
+ * @retval  NULL Error
+ */
+static void *
+xml_pool_get(struct xml_pool *xp)
+{
+    void *n;
+    char *mem;
+    int   i;
+
+    if (xp->xp_free == NULL){
+        if ((mem = malloc(XML_POOL_CHUNK * xp->xp_size)) == NULL)
+            return NULL;
+        for (i = 0; i < XML_POOL_CHUNK; i++){
+            *(void**)(mem + i*xp->xp_size) = xp->xp_free;
+            xp->xp_free = mem + i*xp->xp_size;
+        }
+        xp->xp_nchunks++;
+    }
+    n = xp->xp_free;
+    xp->xp_free = *(void**)n;
+    return n;
+}
+
+/*! Return a node to the pool free list
+ */
+static void
+xml_pool_put(struct xml_pool *xp,
+             void            *n)
+{
+    *(void**)n = xp->xp_free;
+    xp->xp_free = n;
+}
+#endif /* XML_NODE_POOL */
+
+#ifdef XML_NAME_INTERN
+/* Global intern table for node names, prefixes and shared attribute values,
+ * see XML_NAME_INTERN and xml_value_intern.
+ * Entries are never removed: names are YANG identifiers and values namespace
+ * URIs, both drawn from bounded sets.
+ */
+static clicon_hash_t *_intern_tab = NULL;
+
+/*! Return shared copy of str from the global intern table, insert if needed
+ * @param[in]  str  String to intern
+ * @retval     s    Shared pointer, valid for the process lifetime
+ * @retval     NULL Error
+ */
+static char *
+xml_strintern(char *str)
+{
+    clicon_hash_t h;
+
+    if (_intern_tab == NULL &&
+        (_intern_tab = clicon_hash_init()) == NULL)
+        return NULL;
+    if ((h = clicon_hash_lookup(_intern_tab, str)) == NULL &&
+        (h = clicon_hash_add(_intern_tab, str, NULL, 0)) == NULL)
+        return NULL;
+    return h->h_key;
+}
+#endif /* XML_NAME_INTERN */
+
 /*! Get global statistics about XML objects
  *
  * @param[out]  nr  Number of existing XML objects (created - freed)
@@ -266,8 +378,9 @@ xml_stats_one(cxobj    *x,
     case CX_ELMNT:
         sz += sizeof(struct xml);
         sz += x->x_childvec_max*sizeof(struct xml*);
-        if (x->x_ns_cache)
-            sz += cvec_size(x->x_ns_cache);
+        if (x->x_ns_cache) /* shared: amortize over all referencing nodes */
+            sz += (sizeof(struct xml_nscache) + cvec_size(x->x_ns_cache->nc_nsc))/
+                x->x_ns_cache->nc_refcnt;
         if (x->x_cv)
             sz += cv_size(x->x_cv);
 #ifdef XML_EXPLICIT_INDEX
@@ -284,8 +397,10 @@ xml_stats_one(cxobj    *x,
     case CX_BODY:
     case CX_ATTR:
         sz += sizeof(struct xmlbody);
-        if (x->x_value_cb)
-            sz += cbuf_buflen(x->x_value_cb);
+        /* Interned and inline values add no per-node heap */
+        if ((x->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)) == 0 &&
+            x->x_value_u.xv_cb != NULL)
+            sz += cbuf_buflen(x->x_value_u.xv_cb);
         break;
     default:
         break;
@@ -357,6 +472,13 @@ int
 xml_name_set(cxobj *xn, 
              char  *name)
 {
+#ifdef XML_NAME_INTERN
+    xn->x_name = NULL; /* interned, do not free */
+    if (name){
+        if ((xn->x_name = xml_strintern(name)) == NULL)
+            return -1;
+    }
+#else
     if (xn->x_name){
         free(xn->x_name);
         xn->x_name = NULL;
@@ -367,6 +489,7 @@ xml_name_set(cxobj *xn,
             return -1;
         }
     }
+#endif
     return 0;
 }
 
@@ -390,6 +513,13 @@ int
 xml_prefix_set(cxobj *xn, 
                char  *prefix)
 {
+#ifdef XML_NAME_INTERN
+    xn->x_prefix = NULL; /* interned, do not free */
+    if (prefix){
+        if ((xn->x_prefix = xml_strintern(prefix)) == NULL)
+            return -1;
+    }
+#else
     if (xn->x_prefix){
         free(xn->x_prefix);
         xn->x_prefix = NULL;
@@ -400,9 +530,39 @@ xml_prefix_set(cxobj *xn,
             return -1;
         }
     }
+#endif
     return 0;
 }
 
+/*! Wrap a namespace context in a new cache with refcount 1
+ * @param[in] nsc  Namespace context (consumed)
+ */
+static struct xml_nscache *
+nscache_new(cvec *nsc)
+{
+    struct xml_nscache *nc;
+
+    if ((nc = malloc(sizeof(*nc))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    nc->nc_refcnt = 1;
+    nc->nc_nsc = nsc;
+    return nc;
+}
+
+/*! Drop one reference to a namespace cache, free on last
+ */
+static void
+nscache_decref(struct xml_nscache *nc)
+{
+    if (--nc->nc_refcnt > 0)
+        return;
+    if (nc->nc_nsc)
+        xml_nsctx_free(nc->nc_nsc);
+    free(nc);
+}
+
 /*! Get cached namespace (given prefix)
  * @param[in] x      XML node
  * @param[in] prefix Namespace prefix, or NULL for default
@@ -417,7 +577,7 @@ nscache_get(cxobj *x,
     if (!is_element(x))
         return NULL;
     if (x->x_ns_cache != NULL)
-        return xml_nsctx_get(x->x_ns_cache, prefix);
+        return xml_nsctx_get(x->x_ns_cache->nc_nsc, prefix);
     return NULL;
 }
 
@@ -436,7 +596,7 @@ nscache_get_prefix(cxobj *x,
     if (!is_element(x))
         return 0;
     if (x->x_ns_cache != NULL)
-        return xml_nsctx_get_prefix(x->x_ns_cache, namespace, prefix);
+        return xml_nsctx_get_prefix(x->x_ns_cache->nc_nsc, namespace, prefix);
     return 0;
 }
 
@@ -451,7 +611,7 @@ nscache_get_all(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
-    return x->x_ns_cache;
+    return x->x_ns_cache ? x->x_ns_cache->nc_nsc : NULL;
 }
 
 /*! Set cached namespace for specific namespace. Replace if necessary
@@ -468,15 +628,33 @@ nscache_set(cxobj *x,
             char  *namespace)
 {
     int     retval = -1;
+    cvec   *nsc;
 
     if (!is_element(x))
         return 0;
     if (x->x_ns_cache == NULL){
-        if ((x->x_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
+        if ((nsc = xml_nsctx_init(prefix, namespace)) == NULL)
+            goto done;
+        if ((x->x_ns_cache = nscache_new(nsc)) == NULL){
+            xml_nsctx_free(nsc);
             goto done;
+        }
+    }
+    else{
+        if (x->x_ns_cache->nc_refcnt > 1){
+            /* Shared with other nodes: copy-on-write */
+            if ((nsc = cvec_dup(x->x_ns_cache->nc_nsc)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_dup");
+                goto done;
+            }
+            nscache_decref(x->x_ns_cache);
+            if ((x->x_ns_cache = nscache_new(nsc)) == NULL){
+                xml_nsctx_free(nsc);
+                goto done;
+            }
+        }
+        return xml_nsctx_add(x->x_ns_cache->nc_nsc, prefix, namespace);
     }
-    else 
-        return xml_nsctx_add(x->x_ns_cache, prefix, namespace);
     retval = 0;
  done:
     return retval;
@@ -498,15 +676,43 @@ nscache_replace(cxobj *x,
     if (!is_element(x))
         return 0;
     if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
+        nscache_decref(x->x_ns_cache);
         x->x_ns_cache = NULL;
     }
-    x->x_ns_cache = nsc;
+    if (nsc != NULL &&
+        (x->x_ns_cache = nscache_new(nsc)) == NULL){
+        xml_nsctx_free(nsc); /* consumed also on error */
+        goto done;
+    }
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
+/*! Share the (whole) namespace context cache of another node
+ * The cache is shared by reference, not copied: a later nscache_set on either
+ * node copies on write, see xml_nsctx_populate
+ * @param[in] x      XML node
+ * @param[in] xs     XML node whose cache is shared (typically the parent)
+ * @retval    0      OK (also if xs has no cache)
+ */
+int
+nscache_share(cxobj *x,
+              cxobj *xs)
+{
+    if (!is_element(x) || !is_element(xs))
+        return 0;
+    if (x->x_ns_cache != NULL){
+        nscache_decref(x->x_ns_cache);
+        x->x_ns_cache = NULL;
+    }
+    if (xs->x_ns_cache != NULL){
+        x->x_ns_cache = xs->x_ns_cache;
+        x->x_ns_cache->nc_refcnt++;
+    }
+    return 0;
+}
+
 /*! Clear cached namespace context
  * Clear the whole namespace context, not just single cache lines
  * @param[in] x         XML node
@@ -521,7 +727,7 @@ nscache_clear(cxobj *x)
     if (!is_element(x))
         return 0;
     if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
+        nscache_decref(x->x_ns_cache);
         x->x_ns_cache = NULL;
     }
     return 0;
@@ -626,7 +832,13 @@ xml_value(cxobj *xn)
 {
     if (!is_bodyattr(xn))
         return NULL;
-    return xn->x_value_cb?cbuf_get(xn->x_value_cb):NULL;
+    if (xn->x_flags & XML_FLAG_VALINLINE)
+        return xn->x_value_u.xv_inl;
+    if (xn->x_flags & XML_FLAG_VALINTERN)
+        return xn->x_value_u.xv_str;
+    if (xn->x_value_u.xv_cb == NULL)
+        return NULL;
+    return cbuf_get(xn->x_value_u.xv_cb);
 }
 
 /*! Set value of xml node, value is copied
@@ -648,21 +860,71 @@ xml_value_set(cxobj *xn,
         clicon_err(OE_XML, EINVAL, "value is NULL");
         goto done;
     }
+    if (xn->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)){
+        xn->x_value_u.xv_cb = NULL; /* shared string or inline storage, not freed */
+        xn->x_flags &= ~(XML_FLAG_VALINTERN|XML_FLAG_VALINLINE);
+    }
     sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
+    /* Short value and no buffer to reuse: store inline in the node, no allocation */
+    if (xn->x_value_u.xv_cb == NULL && sz <= XML_VALUE_INLINE_LEN){
+        memcpy(xn->x_value_u.xv_inl, val, sz);
+        xn->x_flags |= XML_FLAG_VALINLINE;
+        retval = 0;
+        goto done;
+    }
+    if (xn->x_value_u.xv_cb == NULL){
+        if ((xn->x_value_u.xv_cb = cbuf_new_alloc(sz)) == NULL){
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
         }
     }
     else
-        cbuf_reset(xn->x_value_cb);
-    cbuf_append_str(xn->x_value_cb, val);
+        cbuf_reset(xn->x_value_u.xv_cb);
+    cbuf_append_str(xn->x_value_u.xv_cb, val);
     retval = 0;
  done:
     return retval;
 }
 
+/*! Set value of attribute/body to a shared interned string, no per-node buffer
+ *
+ * For values drawn from a small set repeated over many nodes, eg xmlns
+ * declarations, the value is a pointer into the global intern table instead of
+ * a per-node buffer, see XML_FLAG_VALINTERN. A later xml_value_set or
+ * xml_value_append reverts the node to a private buffer.
+ * @param[in]  xn    xml node (body or attribute, no-op otherwise)
+ * @param[in]  val   new value, null-terminated string, interned by function
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_value_set  copying variant
+ */
+int
+xml_value_intern(cxobj *xn,
+                 char  *val)
+{
+#ifdef XML_NAME_INTERN
+    char *s;
+
+    if (!is_bodyattr(xn))
+        return 0;
+    if (val == NULL){
+        clicon_err(OE_XML, EINVAL, "value is NULL");
+        return -1;
+    }
+    if ((s = xml_strintern(val)) == NULL)
+        return -1;
+    if ((xn->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)) == 0 &&
+        xn->x_value_u.xv_cb != NULL)
+        cbuf_free(xn->x_value_u.xv_cb);
+    xn->x_value_u.xv_str = s;
+    xn->x_flags &= ~XML_FLAG_VALINLINE;
+    xn->x_flags |= XML_FLAG_VALINTERN;
+    return 0;
+#else
+    return xml_value_set(xn, val);
+#endif
+}
+
 /*! Append value of xnode, value is copied
  * @param[in]  xn    xml node
  * @param[in]  val   appended value, null-terminated string, copied by function
@@ -683,13 +945,62 @@ xml_value_append(cxobj *xn,
         goto done;
     }
     sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
+    if (xn->x_flags & XML_FLAG_VALINLINE){
+        size_t prevlen = strlen(xn->x_value_u.xv_inl);
+
+        if (prevlen + sz <= XML_VALUE_INLINE_LEN){ /* still fits inline */
+            memcpy(xn->x_value_u.xv_inl + prevlen, val, sz);
+            retval = 0;
+            goto done;
+        }
+        /* Promote to a private buffer holding the previous inline value */
+        {
+            cbuf *cb;
+
+            if ((cb = cbuf_new_alloc(prevlen+sz)) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_new");
+                goto done;
+            }
+            if (cbuf_append_str(cb, xn->x_value_u.xv_inl) < 0){
+                clicon_err(OE_XML, errno, "cprintf");
+                cbuf_free(cb);
+                goto done;
+            }
+            xn->x_value_u.xv_cb = cb;
+            xn->x_flags &= ~XML_FLAG_VALINLINE;
+        }
+    }
+    else if (xn->x_flags & XML_FLAG_VALINTERN){
+        /* Materialize a private buffer holding the previous shared value */
+        char *prev = xn->x_value_u.xv_str;
+
+        xn->x_value_u.xv_cb = NULL;
+        xn->x_flags &= ~XML_FLAG_VALINTERN;
+        if (prev){
+            if ((xn->x_value_u.xv_cb = cbuf_new_alloc(strlen(prev)+sz)) == NULL){
+                clicon_err(OE_XML, errno, "cbuf_new");
+                goto done;
+            }
+            if (cbuf_append_str(xn->x_value_u.xv_cb, prev) < 0){
+                clicon_err(OE_XML, errno, "cprintf");
+                goto done;
+            }
+        }
+    }
+    if (xn->x_value_u.xv_cb == NULL){
+        /* First value of the node: short ones go inline, no allocation */
+        if (sz <= XML_VALUE_INLINE_LEN){
+            memcpy(xn->x_value_u.xv_inl, val, sz);
+            xn->x_flags |= XML_FLAG_VALINLINE;
+            retval = 0;
+            goto done;
+        }
+        if ((xn->x_value_u.xv_cb = cbuf_new_alloc(sz)) == NULL){
             clicon_err(OE_XML, errno, "cbuf_new");
             goto done;
         }
     }
-    if (cbuf_append_str(xn->x_value_cb, val) < 0){
+    if (cbuf_append_str(xn->x_value_u.xv_cb, val) < 0){
         clicon_err(OE_XML, errno, "cprintf");
         goto done;
     }
@@ -698,6 +1009,92 @@ xml_value_append(cxobj *xn,
     return retval;
 }
 
+/*! Set value of xml node by adopting an existing buffer, no copy
+ *
+ * Ownership-transfer variant of xml_value_set for callers that have already
+ * assembled the value in a cbuf: the buffer becomes the node value as-is and
+ * the caller pointer is cleared. Any previous value buffer is freed.
+ * @param[in]     xn   xml node (body or attribute, no-op otherwise)
+ * @param[in,out] cbp  Value buffer, consumed and zeroed on adoption
+ * @retval        0    OK
+ * @retval       -1    Error
+ * @see xml_value_set  copying variant
+ */
+int
+xml_value_cb_steal(cxobj *xn,
+                   cbuf **cbp)
+{
+    int retval = -1;
+
+    if (cbp == NULL || *cbp == NULL){
+        clicon_err(OE_XML, EINVAL, "value buffer is NULL");
+        goto done;
+    }
+    if (!is_bodyattr(xn))
+        return 0;
+    if ((xn->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)) == 0 &&
+        xn->x_value_u.xv_cb != NULL)
+        cbuf_free(xn->x_value_u.xv_cb);
+    xn->x_flags &= ~(XML_FLAG_VALINTERN|XML_FLAG_VALINLINE);
+    xn->x_value_u.xv_cb = *cbp;
+    *cbp = NULL;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Move value of one xml node to another, no copy
+ *
+ * Transfers the value buffer between body/attribute nodes, for edit paths
+ * where the source tree is expendable, see XML_FLAG_STEAL. The source node is
+ * left without value.
+ * @param[in]  xto    Destination xml node
+ * @param[in]  xfrom  Source xml node, value removed on move
+ * @retval     1      Moved
+ * @retval     0      Not movable (no source value or stale buffer), copy instead
+ * @see xml_value_set  copying variant
+ */
+int
+xml_value_move(cxobj *xto,
+               cxobj *xfrom)
+{
+    cbuf *cb;
+
+    if (!is_bodyattr(xto) || !is_bodyattr(xfrom))
+        return 0;
+    if (xfrom->x_flags & XML_FLAG_VALINLINE){
+        /* Inline value: "move" is a fixed-size copy of the node storage */
+        if ((xto->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)) == 0 &&
+            xto->x_value_u.xv_cb != NULL)
+            cbuf_free(xto->x_value_u.xv_cb);
+        memcpy(xto->x_value_u.xv_inl, xfrom->x_value_u.xv_inl, XML_VALUE_INLINE_LEN);
+        xto->x_flags &= ~XML_FLAG_VALINTERN;
+        xto->x_flags |= XML_FLAG_VALINLINE;
+        xfrom->x_value_u.xv_cb = NULL;
+        xfrom->x_flags &= ~XML_FLAG_VALINLINE;
+        return 1;
+    }
+    if ((cb = xfrom->x_value_u.xv_cb) == NULL)
+        return 0;
+    /* In-place trims can shorten the string below the buffer length; such
+     * buffers are handed over by copy to keep the length bookkeeping correct */
+    if ((xfrom->x_flags & XML_FLAG_VALINTERN) == 0 &&
+        strlen(cbuf_get(cb)) != cbuf_len(cb))
+        return 0;
+    if ((xto->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)) == 0 &&
+        xto->x_value_u.xv_cb != NULL)
+        cbuf_free(xto->x_value_u.xv_cb);
+    xto->x_flags &= ~XML_FLAG_VALINLINE;
+    xto->x_value_u.xv_cb = cb;
+    if (xfrom->x_flags & XML_FLAG_VALINTERN)
+        xto->x_flags |= XML_FLAG_VALINTERN;
+    else
+        xto->x_flags &= ~XML_FLAG_VALINTERN;
+    xfrom->x_value_u.xv_cb = NULL;
+    xfrom->x_flags &= ~XML_FLAG_VALINTERN;
+    return 1;
+}
+
 /*! Get type of xnode
  * @param[in]  xn    xml node
  * @retval     type of xml node
@@ -711,18 +1108,47 @@ xml_type(cxobj *xn)
     return xn->x_type;
 }
 
+/*! Adjust per-type child counters of a parent when a child is added or removed
+ *
+ * The counters give O(1) xml_child_nr_type and fast-path empty checks in xml_body
+ * and attribute lookup instead of scanning wide child vectors.
+ * @param[in]  xp     xml parent node (element)
+ * @param[in]  type   Type of the child added/removed
+ * @param[in]  delta  +1 on add, -1 on remove
+ */
+static void
+xml_child_nr_adjust(cxobj          *xp,
+                    enum cxobj_type type,
+                    int             delta)
+{
+    switch (type){
+    case CX_ATTR:
+        xp->x_nr_attr += delta;
+        break;
+    case CX_BODY:
+        xp->x_nr_body += delta;
+        break;
+    default:
+        break;
+    }
+}
+
 /*! Set type of xnode
  * @param[in]  xn    xml node
  * @param[in]  type  new type
  * @retval     type  old type
  */
-static enum cxobj_type 
-xml_type_set(cxobj          *xn, 
+static enum cxobj_type
+xml_type_set(cxobj          *xn,
              enum cxobj_type type)
 {
     enum cxobj_type old = xn->x_type;
 
     xn->x_type = type;
+    if (old != type && xn->x_up != NULL && is_element(xn->x_up)){
+        xml_child_nr_adjust(xn->x_up, old, -1);
+        xml_child_nr_adjust(xn->x_up, type, 1);
+    }
     return old;
 }
 
@@ -750,20 +1176,13 @@ xml_child_nr(cxobj *xn)
  * @see xml_child_nr
  * @see xml_child_nr_type
  */
-int   
-xml_child_nr_notype(cxobj          *xn, 
+int
+xml_child_nr_notype(cxobj          *xn,
                     enum cxobj_type type)
 {
-    cxobj *x = NULL;
-    int    nr = 0;
-
     if (!is_element(xn))
         return 0;
-    while ((x = xml_child_each(xn, x, -1)) != NULL) {
-        if (xml_type(x) != type)
-            nr++;
-    }
-    return nr;
+    return xn->x_childvec_len - xml_child_nr_type(xn, type);
 }
 
 /*! Get number of children of specific type
@@ -773,18 +1192,23 @@ xml_child_nr_notype(cxobj          *xn,
  * @see xml_child_nr
  * @see xml_child_nr_notype
  */
-int   
-xml_child_nr_type(cxobj          *xn, 
+int
+xml_child_nr_type(cxobj          *xn,
                   enum cxobj_type type)
 {
-    cxobj *x = NULL;
-    int    len = 0;
-
     if (!is_element(xn))
         return 0;
-    while ((x = xml_child_each(xn, x, type)) != NULL) 
-        len++;
-    return len;
+    /* Counters maintained on child add/remove, no scan, see xml_child_nr_adjust */
+    switch (type){
+    case CX_ATTR:
+        return xn->x_nr_attr;
+    case CX_BODY:
+        return xn->x_nr_body;
+    case CX_ELMNT:
+        return xn->x_childvec_len - xn->x_nr_attr - xn->x_nr_body;
+    default: /* -1: all */
+        return xn->x_childvec_len;
+    }
 }
 
 /*! Get a specific child
@@ -823,9 +1247,12 @@ xml_child_i_type(cxobj          *xn,
 {
     cxobj *x = NULL;
     int    it = 0;
-    
+
     if (!is_element(xn))
         return NULL;
+    /* All children are elements: positional access needs no type scan */
+    if (type == CX_ELMNT && xn->x_nr_attr == 0 && xn->x_nr_body == 0)
+        return xml_child_i(xn, i);
     while ((x = xml_child_each(xn, x, type)) != NULL) {
         if (x->x_type == type && (i == it++))
             return x;
@@ -846,8 +1273,13 @@ xml_child_i_set(cxobj *xt,
 {
     if (!is_element(xt))
         return NULL;
-    if (i < xt->x_childvec_len)
+    if (i < xt->x_childvec_len){
+        if (xt->x_childvec[i] != NULL)
+            xml_child_nr_adjust(xt, xml_type(xt->x_childvec[i]), -1);
         xt->x_childvec[i] = xc;
+        if (xc != NULL)
+            xml_child_nr_adjust(xt, xml_type(xc), 1);
+    }
     return 0;
 }
 
@@ -936,6 +1368,63 @@ xml_child_each(cxobj           *xparent,
     return xn;
 }
 
+/*! Find last child sharing yang spec with *xp by binary search, return span length
+ *
+ * Children with the same yang spec are contiguous in a sorted child vector, so the
+ * number of entries of a (leaf-)list can be computed in O(logN) instead of visiting
+ * every entry.
+ * @param[in]     xt  XML parent node, its children must be sorted (see xml_sort)
+ * @param[in,out] xp  In: first entry of the list, as returned by xml_child_each
+ *                    Out: last entry of the list, iteration can resume after it
+ * @retval        nr  Number of entries in the list (>= 1)
+ * @retval        -1  Error, *xp is not a child of xt or has no yang spec
+ * @note assumes the child vector has no empty slots, eg from xml_child_rm
+ * @see xml_child_each  whose cached index is reused as starting point
+ */
+int
+xml_child_span(cxobj  *xt,
+               cxobj **xp)
+{
+    cxobj     *x;
+    yang_stmt *y;
+    int        start;
+    int        lo;
+    int        hi;
+    int        mid;
+
+    if (xt == NULL || !is_element(xt) || xp == NULL || (x = *xp) == NULL){
+        clicon_err(OE_XML, EINVAL, "xt or xp is NULL");
+        return -1;
+    }
+    if ((y = x->x_spec) == NULL){
+        clicon_err(OE_XML, 0, "%s has no yang spec", xml_name(x));
+        return -1;
+    }
+    start = x->_x_vector_i;
+    if (start < 0 || start >= xt->x_childvec_len || xt->x_childvec[start] != x){
+        /* Cached iterator index not valid for this parent, find it linearly */
+        if ((start = xml_child_order(xt, x)) < 0){
+            clicon_err(OE_XML, 0, "%s is not a child of %s", xml_name(x), xml_name(xt));
+            return -1;
+        }
+    }
+    /* Largest index whose child still shares spec y */
+    lo = start;
+    hi = xt->x_childvec_len - 1;
+    while (lo < hi){
+        mid = lo + (hi - lo + 1)/2;
+        x = xt->x_childvec[mid];
+        if (x != NULL && x->x_spec == y && x->x_type == CX_ELMNT)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    x = xt->x_childvec[lo];
+    x->_x_vector_i = lo; /* so that xml_child_each resumes after the list */
+    *xp = x;
+    return lo - start + 1;
+}
+
 /*! Extend child vector with one and insert xml node there
  * @note does not do anything with child, you may need to set its parent, etc
  * @see xml_child_insert_pos
@@ -968,6 +1457,7 @@ xml_child_append(cxobj *xp,
         }
     }
     xp->x_childvec[xp->x_childvec_len-1] = xc;
+    xml_child_nr_adjust(xp, xml_type(xc), 1);
     return 0;
 }
 
@@ -1000,6 +1490,7 @@ xml_child_insert_pos(cxobj *xp,
     size = (xml_child_nr(xp) - i - 1)*sizeof(cxobj *);
     memmove(&xp->x_childvec[i+1], &xp->x_childvec[i], size);
     xp->x_childvec[i] = xc;
+    xml_child_nr_adjust(xp, xml_type(xc), 1);
     return 0;
 }
 
@@ -1018,6 +1509,8 @@ xml_childvec_set(cxobj *x,
         return 0;
     x->x_childvec_len = len;
     x->x_childvec_max = len;
+    x->x_nr_attr = 0; /* Rebuilt as slots are filled, see xml_child_i_set */
+    x->x_nr_body = 0;
     if (x->x_childvec)
         free(x->x_childvec);
     if ((x->x_childvec = calloc(len, sizeof(cxobj*))) == NULL){
@@ -1027,6 +1520,35 @@ xml_childvec_set(cxobj *x,
     return 0;
 }
 
+/*! Pre-size a childvec so that nr further appends need no reallocation
+ *
+ * Unlike xml_childvec_set, existing children are kept: the vector is grown
+ * to its exact final size and filled by subsequent xml_child_append calls.
+ * @param[in]  x    XML node
+ * @param[in]  nr   Number of children about to be appended
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_child_append  which otherwise grows the vector incrementally
+ */
+static int
+xml_childvec_presize(cxobj *x,
+                     int    nr)
+{
+    int max;
+
+    if (!is_element(x) || nr <= 0)
+        return 0;
+    max = x->x_childvec_len + nr;
+    if (max <= x->x_childvec_max)
+        return 0;
+    if ((x->x_childvec = realloc(x->x_childvec, max*sizeof(cxobj*))) == NULL){
+        clicon_err(OE_XML, errno, "realloc");
+        return -1;
+    }
+    x->x_childvec_max = max;
+    return 0;
+}
+
 /*! Get the children of an XML node as an XML vector
  */
 cxobj **
@@ -1101,10 +1623,17 @@ xml_new(char           *name,
         return NULL;
         break;
     }
+#ifdef XML_NODE_POOL
+    if ((x = xml_pool_get(type==CX_ELMNT?&_pool_elmnt:&_pool_body)) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+#else
     if ((x = malloc(sz)) == NULL){
         clicon_err(OE_XML, errno, "malloc");
         return NULL;
     }
+#endif
     memset(x, 0, sz);
     xml_type_set(x, type);
     if (name && (xml_name_set(x, name)) < 0)
@@ -1421,6 +1950,7 @@ xml_child_rm(cxobj *xp,
     xml_parent_set(xc, NULL);
     xp->x_childvec[i] = NULL;
     xp->x_childvec_len--;
+    xml_child_nr_adjust(xp, xml_type(xc), -1);
     if (i<xp->x_childvec_len)
         memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
 #ifdef XML_EXPLICIT_INDEX
@@ -1435,6 +1965,57 @@ xml_child_rm(cxobj *xp,
     return retval;
 }
 
+/*! Remove a set of children from a parent with a single compaction pass
+ *
+ * Each child is unlinked as in xml_child_rm, but the child vector is compacted
+ * once instead of once per removal: O(n) instead of O(n*xlen) when deleting
+ * large parts of a list. The children are not freed and become roots.
+ * @param[in]   xp     xml parent node
+ * @param[in]   xvec   Vector of children of xp to remove
+ * @param[in]   xlen   Length of xvec
+ * @retval      0      OK
+ * @retval      -1     Error, eg an entry is not a child of xp
+ * @see xml_child_rm  Single-child variant
+ */
+int
+xml_child_rm_vec(cxobj  *xp,
+                 cxobj **xvec,
+                 int     xlen)
+{
+    int    retval = -1;
+    cxobj *xc;
+    int    i;
+    int    j;
+
+    if (!is_element(xp) || xlen == 0)
+        return 0;
+    for (i=0; i<xlen; i++){
+        xc = xvec[i];
+        if (xc == NULL || xml_parent(xc) != xp){
+            clicon_err(OE_XML, 0, "Child not found");
+            goto done;
+        }
+        /* Unlink: the NULL parent marks the slot for the compaction below */
+        xml_parent_set(xc, NULL);
+        xml_child_nr_adjust(xp, xml_type(xc), -1);
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_type(xc) == CX_ELMNT && xml_search_index_p(xc))
+            xml_search_child_rm(xp, xc);
+#endif
+    }
+    j = 0;
+    for (i=0; i<xp->x_childvec_len; i++){
+        xc = xp->x_childvec[i];
+        if (xc != NULL && xml_parent(xc) == NULL)
+            continue; /* Removed above */
+        xp->x_childvec[j++] = xc;
+    }
+    xp->x_childvec_len = j;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Remove this xml node from parent xml node. No freeing and node is new root
  * @param[in]   xc     xml child node to be removed
  * @retval      0      OK
@@ -1659,7 +2240,9 @@ xml_body(cxobj *xn)
 
     if (!is_element(xn))
         return NULL;
-    while ((xb = xml_child_each(xn, xb, CX_BODY)) != NULL) 
+    if (xn->x_nr_body == 0) /* Avoid scanning wide element-only children */
+        return NULL;
+    while ((xb = xml_child_each(xn, xb, CX_BODY)) != NULL)
         return xml_value(xb);
     return NULL;
 }
@@ -1677,7 +2260,9 @@ xml_body_get(cxobj *xt)
 
     if (!is_element(xt))
         return NULL;
-    while ((xb = xml_child_each(xt, xb, CX_BODY)) != NULL) 
+    if (xt->x_nr_body == 0) /* Avoid scanning wide element-only children */
+        return NULL;
+    while ((xb = xml_child_each(xt, xb, CX_BODY)) != NULL)
         return xb;
     return NULL;
 }
@@ -1736,9 +2321,14 @@ xml_find_type(cxobj           *xt,
     cxobj *x = NULL;
     int    pmatch;  /* prefix match */
     char  *xprefix; /* xprefix */
-    
+
     if (!is_element(xt))
         return NULL;
+    /* Counter fast paths: no children of the wanted type, no need to scan */
+    if (type == CX_ATTR && xt->x_nr_attr == 0)
+        return NULL;
+    if (type == CX_BODY && xt->x_nr_body == 0)
+        return NULL;
     while ((x = xml_child_each(xt, x, type)) != NULL) {
         if (prefix){
             xprefix = xml_prefix(x);
@@ -1841,54 +2431,104 @@ xml_find_body_obj(cxobj      *xt,
     return x;
 }
 
-/*! Free an xl sub-tree recursively, but do not remove it from parent
- * @param[in]  x  the xml tree to be freed.
- * @see xml_purge where x is also removed from parent
+/*! Free a single xml node: own fields and childvec, but not the children
+ * @param[in]  x  the xml node to be freed, children (if any) are the callers
+ * @see xml_free  which frees a whole sub-tree
  */
-int
-xml_free(cxobj *x)
+static int
+xml_free_one(cxobj *x)
 {
-    int    i;
-    cxobj *xc;
-
-    if (x == NULL){
-        return 0;
-    }
+#ifndef XML_NAME_INTERN /* names and prefixes are shared, see xml_strintern */
     if (x->x_name)
         free(x->x_name);
     if (x->x_prefix)
         free(x->x_prefix);
+#endif
     switch (xml_type(x)){
     case CX_ELMNT:
-        for (i=0; i<x->x_childvec_len; i++){
-            if ((xc = x->x_childvec[i]) != NULL){
-                xml_free(xc);
-                x->x_childvec[i] = NULL;
-            }
-        }
         if (x->x_childvec)
             free(x->x_childvec);
         if (x->x_cv)
             cv_free(x->x_cv);
         if (x->x_ns_cache)
-            xml_nsctx_free(x->x_ns_cache);
+            nscache_decref(x->x_ns_cache);
 #ifdef XML_EXPLICIT_INDEX
         xml_search_index_free(x);
+#endif
+#ifdef XML_LIST_KEYHASH
+        if (x->x_keyhash)
+            clicon_hash_free(x->x_keyhash);
 #endif
         break;
     case CX_BODY:
     case CX_ATTR:
-        if (x->x_value_cb)
-            cbuf_free(x->x_value_cb);  
+        if ((x->x_flags & (XML_FLAG_VALINTERN|XML_FLAG_VALINLINE)) == 0 &&
+            x->x_value_u.xv_cb != NULL)
+            cbuf_free(x->x_value_u.xv_cb);
         break;
     default:
         break;
     }
+#ifdef XML_NODE_POOL
+    xml_pool_put(xml_type(x)==CX_ELMNT?&_pool_elmnt:&_pool_body, x);
+#else
     free(x);
+#endif
     _stats_xml_nr--;
     return 0;
 }
 
+/*! Free an xml sub-tree, but do not remove it from parent
+ *
+ * Iterative with an explicit stack: trees from schema mounts can nest deeply
+ * and per-node recursion has overflowed the C stack.
+ * @param[in]  x  the xml tree to be freed.
+ * @retval     0  OK
+ * @retval    -1  Error, parts of the tree may be leaked
+ * @see xml_purge where x is also removed from parent
+ */
+int
+xml_free(cxobj *x)
+{
+    int     retval = -1;
+    cxobj **stack = NULL;
+    int     stacklen = 0;
+    int     stackmax;
+    int     i;
+    cxobj  *xc;
+
+    if (x == NULL)
+        return 0;
+    stackmax = 64;
+    if ((stack = malloc(stackmax*sizeof(cxobj*))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        goto done;
+    }
+    stack[stacklen++] = x;
+    while (stacklen > 0){
+        x = stack[--stacklen];
+        if (xml_type(x) == CX_ELMNT && x->x_childvec_len > 0){
+            while (stacklen + x->x_childvec_len > stackmax){
+                stackmax *= 2;
+                if ((stack = realloc(stack, stackmax*sizeof(cxobj*))) == NULL){
+                    clicon_err(OE_XML, errno, "realloc");
+                    goto done;
+                }
+            }
+            for (i=0; i<x->x_childvec_len; i++){
+                if ((xc = x->x_childvec[i]) != NULL)
+                    stack[stacklen++] = xc;
+            }
+        }
+        xml_free_one(x);
+    }
+    retval = 0;
+ done:
+    if (stack)
+        free(stack);
+    return retval;
+}
+
 /*! Copy single xml node from x0 to x1 without copying children
  * @param[in]  x0  Source XML tree
  * @param[in]  x1  Destination XML tree (must exist)
@@ -1920,9 +2560,12 @@ xml_copy_one(cxobj *x0,
     case CX_BODY:
     case CX_ATTR:
         if ((s = xml_value(x0))){ /* malloced string */
-            if (xml_value_set(x1, s) < 0)
+            if (xml_flag(x0, XML_FLAG_VALINTERN)){
+                if (xml_value_intern(x1, s) < 0)
+                    goto done;
+            }
+            else if (xml_value_set(x1, s) < 0)
                 goto done;
-
         }
         break;
     default:
@@ -1934,10 +2577,19 @@ xml_copy_one(cxobj *x0,
     return retval;
 }
 
+/* Pending source/destination pair on the xml_copy traversal stack */
+struct xml_copy_frame{
+    cxobj *xf_src;
+    cxobj *xf_dst;
+};
+
 /*! Copy xml tree x0 to other existing tree x1
  *
  * x1 should be a created placeholder. If x1 is non-empty,
  * the copied tree is appended to the existing tree.
+ * Iterative with an explicit stack (see xml_free on recursion depth), and each
+ * destination childvec is pre-sized exactly from the source so the appends
+ * below never realloc.
  * @param[in]  x0  Source XML tree
  * @param[in]  x1  Destination XML tree (must exist)
  * @retval     0   OK
@@ -1949,25 +2601,54 @@ xml_copy_one(cxobj *x0,
  * @endcode
  * @see xml_dup
  */
-int 
-xml_copy(cxobj *x0, 
+int
+xml_copy(cxobj *x0,
          cxobj *x1)
 {
-    int    retval = -1;
-    cxobj *x;
-    cxobj *xcopy;
+    int                    retval = -1;
+    struct xml_copy_frame *stack = NULL;
+    int                    stacklen = 0;
+    int                    stackmax;
+    cxobj                 *x;
+    cxobj                 *xcopy;
+    int                    nr;
 
-    if (xml_copy_one(x0, x1) <0)
+    stackmax = 64;
+    if ((stack = malloc(stackmax*sizeof(struct xml_copy_frame))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
         goto done;
-    x = NULL;
-    while ((x = xml_child_each(x0, x, -1)) != NULL) {
-        if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
+    }
+    stack[stacklen].xf_src = x0;
+    stack[stacklen++].xf_dst = x1;
+    while (stacklen > 0){
+        stacklen--;
+        x0 = stack[stacklen].xf_src;
+        x1 = stack[stacklen].xf_dst;
+        if (xml_copy_one(x0, x1) < 0)
             goto done;
-        if (xml_copy(x, xcopy) < 0) /* recursion */
+        if (xml_type(x0) != CX_ELMNT || (nr = xml_child_nr(x0)) == 0)
+            continue;
+        if (xml_childvec_presize(x1, nr) < 0)
             goto done;
+        while (stacklen + nr > stackmax){
+            stackmax *= 2;
+            if ((stack = realloc(stack, stackmax*sizeof(struct xml_copy_frame))) == NULL){
+                clicon_err(OE_XML, errno, "realloc");
+                goto done;
+            }
+        }
+        x = NULL;
+        while ((x = xml_child_each(x0, x, -1)) != NULL) {
+            if ((xcopy = xml_new(xml_name(x), x1, xml_type(x))) == NULL)
+                goto done;
+            stack[stacklen].xf_src = x;
+            stack[stacklen++].xf_dst = xcopy;
+        }
     }
     retval = 0;
   done:
+    if (stack)
+        free(stack);
     return retval;
 }
 
@@ -2069,12 +2750,34 @@ cxvec_prepend(cxobj   *x,
 #endif
 
 
+/* Hint the cache at the next sibling while fn runs on the current one;
+ * no-op where the builtin is unavailable */
+#if defined(__GNUC__) || defined(__clang__)
+#define xml_prefetch(p) __builtin_prefetch(p)
+#else
+#define xml_prefetch(p)
+#endif
+
+/* Traversal stack frame for the iterative xml_apply: node whose child vector is
+ * being walked and the next child index */
+struct xml_apply_frame {
+    cxobj *xf_xn;
+    int    xf_i;
+};
+/* Frames held on the C stack before falling back to malloc: covers typical
+ * config tree depths without allocation */
+#define XML_APPLY_STACK_INIT 64
+
 /*! Apply a function call recursively on all xml node children recursively
- * Recursively traverse all xml nodes in a parse-tree and apply fn(arg) for 
- * each object found. The function is called with the xml node and an 
+ * Traverse all xml nodes in a parse-tree and apply fn(arg) for
+ * each object found. The function is called with the xml node and an
  * argument as args.
  * The tree is traversed depth-first, which at least guarantees that a parent is
  * traversed before a child.
+ * Iterative with an explicit stack over the child vectors rather than recursing
+ * per node: this is a hot path (flag marking, NACM filtering, default handling)
+ * and the loop avoids per-node call overhead and prefetches the next sibling
+ * while the callback runs on the current one.
  * @param[in]  xn   XML node
  * @param[in]  type Matching type or -1 for any
  * @param[in]  fn   Callback
@@ -2096,19 +2799,38 @@ cxvec_prepend(cxobj   *x,
  * @see xml_apply_ancestor for marking all parents recursively
  */
 int
-xml_apply(cxobj          *xn, 
-          enum cxobj_type type, 
-          xml_applyfn_t   fn, 
+xml_apply(cxobj          *xn,
+          enum cxobj_type type,
+          xml_applyfn_t   fn,
           void           *arg)
 {
-    int        retval = -1;
-    cxobj     *x;
-    int        ret;
+    int                     retval = -1;
+    struct xml_apply_frame  sbuf[XML_APPLY_STACK_INIT];
+    struct xml_apply_frame *stack = sbuf;
+    struct xml_apply_frame *f;
+    int                     smax = XML_APPLY_STACK_INIT;
+    int                     sp = 0; /* Nr of frames in use */
+    cxobj                  *x;
+    int                     ret;
 
     if (!is_element(xn))
         return 0;
-    x = NULL;
-    while ((x = xml_child_each(xn, x, type)) != NULL) {
+    stack[sp].xf_xn = xn;
+    stack[sp].xf_i = 0;
+    sp++;
+    while (sp > 0){
+        f = &stack[sp-1];
+        if (f->xf_i >= f->xf_xn->x_childvec_len){
+            sp--; /* children done, pop */
+            continue;
+        }
+        x = f->xf_xn->x_childvec[f->xf_i++];
+        if (f->xf_i < f->xf_xn->x_childvec_len)
+            xml_prefetch(f->xf_xn->x_childvec[f->xf_i]);
+        if (x == NULL ||
+            (type != CX_ERROR && x->x_type != type))
+            continue;
+        x->_x_vector_i = f->xf_i - 1; /* as xml_child_each would set it */
         if ((ret = fn(x, arg)) < 0)
             goto done;
         if (ret == 2)
@@ -2117,16 +2839,34 @@ xml_apply(cxobj          *xn,
             retval = 1;
             goto done;
         }
-        if ((ret = xml_apply(x, type, fn, arg)) < 0)
-            goto done;
-        if (ret == 1){
-            retval = 1;
-            goto done;
+        if (!is_element(x) || x->x_childvec_len == 0)
+            continue; /* nothing to recurse into */
+        if (sp == smax){ /* grow stack, move off sbuf on first growth */
+            struct xml_apply_frame *snew;
+
+            smax *= 2;
+            if (stack == sbuf){
+                if ((snew = malloc(smax * sizeof(*stack))) == NULL){
+                    clicon_err(OE_XML, errno, "malloc");
+                    goto done;
+                }
+                memcpy(snew, stack, sp * sizeof(*stack));
+            }
+            else if ((snew = realloc(stack, smax * sizeof(*stack))) == NULL){
+                clicon_err(OE_XML, errno, "realloc");
+                goto done;
+            }
+            stack = snew;
         }
+        stack[sp].xf_xn = x;
+        stack[sp].xf_i = 0;
+        sp++;
     }
     retval = 0;
   done:
-    return retval;   
+    if (stack != sbuf)
+        free(stack);
+    return retval;
 }
 
 /*! Apply a function call on top object and all xml node children recursively 
@@ -2496,6 +3236,50 @@ clicon_debug_xml(int         dbglevel,
     return retval;
 }
 
+#ifdef XML_LIST_KEYHASH
+/*! Get lazy list-key index of this XML node
+ * @param[in]  x    XML object (element)
+ * @param[out] khp  Hash mapping list-key string to child position, or NULL
+ * @param[out] nrp  Child count of x when the index was built
+ * @retval     0    OK
+ * @see clixon_xml_find_index  builder and consumer
+ */
+int
+xml_keyhash_get(cxobj          *x,
+                clicon_hash_t **khp,
+                int            *nrp)
+{
+    if (!is_element(x)){
+        *khp = NULL;
+        return 0;
+    }
+    *khp = x->x_keyhash;
+    if (nrp)
+        *nrp = x->x_keyhash_nr;
+    return 0;
+}
+
+/*! Set (or clear) lazy list-key index of this XML node, freeing any old index
+ * @param[in]  x   XML object (element)
+ * @param[in]  kh  Hash mapping list-key string to child position, or NULL
+ * @param[in]  nr  Current child count of x
+ * @retval     0   OK
+ */
+int
+xml_keyhash_set(cxobj         *x,
+                clicon_hash_t *kh,
+                int            nr)
+{
+    if (!is_element(x))
+        return 0;
+    if (x->x_keyhash && x->x_keyhash != kh)
+        clicon_hash_free(x->x_keyhash);
+    x->x_keyhash = kh;
+    x->x_keyhash_nr = nr;
+    return 0;
+}
+#endif /* XML_LIST_KEYHASH */
+
 #ifdef XML_EXPLICIT_INDEX
 /*
  *
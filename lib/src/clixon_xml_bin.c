@@ -0,0 +1,394 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Clixon XML binary on-disk format
+ *
+ * The format is a length-prefixed, pointer-free pre-order image of a cxobj
+ * tree.  A file consists of a fixed header followed by one record per node:
+ *
+ *   header:  magic[8]="CLIXBIN1"
+ *   record:  type     uint8   (enum cxobj_type)
+ *            namelen  uint32  followed by namelen name bytes (no NUL)
+ *            preflen  uint32  UINT32_MAX means no prefix
+ *            vallen   uint32  UINT32_MAX means no value
+ *            nrchild  uint32  number of child records following recursively
+ *
+ * All integers are little-endian host order: the format is a local cache,
+ * not an interchange format, and is tagged by magic only.
+ * The reader mmap:s the file and materializes cxobj nodes directly from the
+ * image without running the XML lex/yacc parser, which is roughly an order
+ * of magnitude faster for large datastores.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_string.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_xml_bin.h"
+
+#define XML_BIN_MAGIC    "CLIXBIN1"
+#define XML_BIN_MAGICLEN 8
+#define XML_BIN_NONE     0xffffffffu
+
+/* Max nesting of node records when reading an image. Recursion depth is
+ * image-controlled, so a crafted/corrupt file could otherwise nest records
+ * deep enough to overrun the stack. Real datastore trees are far shallower.
+ */
+#define XML_BIN_MAXDEPTH 2048
+
+/*! Write a single uint32 in host order
+ */
+static int
+bin_put32(FILE     *f,
+          uint32_t  u)
+{
+    if (fwrite(&u, sizeof(u), 1, f) != 1){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Write one node record recursively in pre-order
+ * @param[in]  f   Output file
+ * @param[in]  xn  XML node
+ * @retval     0   OK
+ * @retval    -1   Error
+ */
+static int
+xml2bin_recurse(FILE  *f,
+                cxobj *xn)
+{
+    int      retval = -1;
+    uint8_t  type;
+    char    *str;
+    uint32_t len;
+    cxobj   *xc;
+
+    type = (uint8_t)xml_type(xn);
+    if (fwrite(&type, 1, 1, f) != 1){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    str = xml_name(xn);
+    len = str ? strlen(str) : 0;
+    if (bin_put32(f, len) < 0)
+        goto done;
+    if (len && fwrite(str, 1, len, f) != len){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    str = xml_prefix(xn);
+    if (str == NULL){
+        if (bin_put32(f, XML_BIN_NONE) < 0)
+            goto done;
+    }
+    else{
+        len = strlen(str);
+        if (bin_put32(f, len) < 0)
+            goto done;
+        if (len && fwrite(str, 1, len, f) != len){
+            clicon_err(OE_UNIX, errno, "fwrite");
+            goto done;
+        }
+    }
+    str = xml_value(xn);
+    if (str == NULL){
+        if (bin_put32(f, XML_BIN_NONE) < 0)
+            goto done;
+    }
+    else{
+        len = strlen(str);
+        if (bin_put32(f, len) < 0)
+            goto done;
+        if (len && fwrite(str, 1, len, f) != len){
+            clicon_err(OE_UNIX, errno, "fwrite");
+            goto done;
+        }
+    }
+    if (bin_put32(f, xml_child_nr(xn)) < 0)
+        goto done;
+    xc = NULL;
+    while ((xc = xml_child_each(xn, xc, CX_ERROR)) != NULL)
+        if (xml2bin_recurse(f, xc) < 0)
+            goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Serialize an XML tree to file in the clixon binary format
+ * @param[in]  f   Output file
+ * @param[in]  xn  Top XML node (included in the image)
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see clixon_bin2xml_fd  for the inverse
+ */
+int
+clixon_xml2bin(FILE  *f,
+               cxobj *xn)
+{
+    int retval = -1;
+
+    if (xn == NULL){
+        clicon_err(OE_XML, EINVAL, "xn is NULL");
+        goto done;
+    }
+    if (fwrite(XML_BIN_MAGIC, 1, XML_BIN_MAGICLEN, f) != XML_BIN_MAGICLEN){
+        clicon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    if (xml2bin_recurse(f, xn) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/* Cursor over the mmap:ed image, with end for bounds checking */
+struct bin_cursor {
+    const char *bc_ptr;
+    const char *bc_end;
+};
+
+/*! Read a uint32 from the image with bounds check
+ */
+static int
+bin_get32(struct bin_cursor *bc,
+          uint32_t          *up)
+{
+    if (bc->bc_end - bc->bc_ptr < (ptrdiff_t)sizeof(uint32_t)){
+        clicon_err(OE_DB, EFAULT, "Truncated binary datastore image");
+        return -1;
+    }
+    memcpy(up, bc->bc_ptr, sizeof(uint32_t));
+    bc->bc_ptr += sizeof(uint32_t);
+    return 0;
+}
+
+/*! Read a length-prefixed string from the image, return malloced NUL-terminated copy
+ * @param[out] strp  Malloced string, or NULL if the length marker is XML_BIN_NONE
+ */
+static int
+bin_getstr(struct bin_cursor *bc,
+           char             **strp)
+{
+    uint32_t len;
+    char    *str;
+
+    *strp = NULL;
+    if (bin_get32(bc, &len) < 0)
+        return -1;
+    if (len == XML_BIN_NONE)
+        return 0;
+    if (bc->bc_end - bc->bc_ptr < (ptrdiff_t)len){
+        clicon_err(OE_DB, EFAULT, "Truncated binary datastore image");
+        return -1;
+    }
+    if ((str = malloc(len + 1)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    memcpy(str, bc->bc_ptr, len);
+    str[len] = '\0';
+    bc->bc_ptr += len;
+    *strp = str;
+    return 0;
+}
+
+/*! Materialize one node record recursively
+ * @param[in]  bc    Image cursor
+ * @param[in]  xp    Parent node or NULL for top
+ * @param[out] xcp   Created node
+ * @param[in]  depth Nesting depth of this record, capped at XML_BIN_MAXDEPTH
+ */
+static int
+bin2xml_recurse(struct bin_cursor *bc,
+                cxobj             *xp,
+                cxobj            **xcp,
+                int                depth)
+{
+    int      retval = -1;
+    uint8_t  type;
+    char    *name = NULL;
+    char    *prefix = NULL;
+    char    *value = NULL;
+    uint32_t nrchild;
+    uint32_t i;
+    cxobj   *x = NULL;
+    cxobj   *xc;
+
+    if (depth > XML_BIN_MAXDEPTH){
+        clicon_err(OE_DB, EFAULT, "Corrupt binary datastore image: nested deeper than %d", XML_BIN_MAXDEPTH);
+        goto done;
+    }
+    if (bc->bc_end - bc->bc_ptr < 1){
+        clicon_err(OE_DB, EFAULT, "Truncated binary datastore image");
+        goto done;
+    }
+    type = *(const uint8_t*)bc->bc_ptr;
+    bc->bc_ptr++;
+    if (type != CX_ELMNT && type != CX_ATTR && type != CX_BODY){
+        clicon_err(OE_DB, EFAULT, "Corrupt binary datastore image: node type %u", type);
+        goto done;
+    }
+    if (bin_getstr(bc, &name) < 0)
+        goto done;
+    if (bin_getstr(bc, &prefix) < 0)
+        goto done;
+    if (bin_getstr(bc, &value) < 0)
+        goto done;
+    if ((x = xml_new(name ? name : "", xp, (enum cxobj_type)type)) == NULL)
+        goto done;
+    if (prefix && xml_prefix_set(x, prefix) < 0)
+        goto done;
+    if (value && xml_value_set(x, value) < 0)
+        goto done;
+    if (bin_get32(bc, &nrchild) < 0)
+        goto done;
+    for (i = 0; i < nrchild; i++)
+        if (bin2xml_recurse(bc, x, &xc, depth + 1) < 0)
+            goto done;
+    if (xcp)
+        *xcp = x;
+    x = NULL;
+    retval = 0;
+ done:
+    if (x){
+        xml_rm(x); /* xml_new linked x into xp: unlink before free or xp would
+                      traverse the freed node again in its own error path */
+        xml_free(x);
+    }
+    if (name)
+        free(name);
+    if (prefix)
+        free(prefix);
+    if (value)
+        free(value);
+    return retval;
+}
+
+/*! Materialize an XML tree from an open binary-format file using mmap
+ * @param[in]  fd  Open file descriptor
+ * @param[out] xp  Top XML node, free with xml_free()
+ * @retval     0   OK
+ * @retval    -1   Error, eg wrong magic or truncated image
+ * @see clixon_xml2bin  for the inverse
+ */
+int
+clixon_bin2xml_fd(int     fd,
+                  cxobj **xp)
+{
+    int               retval = -1;
+    struct stat       st;
+    char             *map = MAP_FAILED;
+    struct bin_cursor bc = {0,};
+
+    if (fstat(fd, &st) < 0){
+        clicon_err(OE_UNIX, errno, "fstat");
+        goto done;
+    }
+    if (st.st_size < XML_BIN_MAGICLEN){
+        clicon_err(OE_DB, EFAULT, "Binary datastore image too short");
+        goto done;
+    }
+    if ((map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED){
+        clicon_err(OE_UNIX, errno, "mmap");
+        goto done;
+    }
+    if (memcmp(map, XML_BIN_MAGIC, XML_BIN_MAGICLEN) != 0){
+        clicon_err(OE_DB, EFAULT, "Binary datastore image has wrong magic");
+        goto done;
+    }
+    bc.bc_ptr = map + XML_BIN_MAGICLEN;
+    bc.bc_end = map + st.st_size;
+    if (bin2xml_recurse(&bc, NULL, xp, 0) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (map != MAP_FAILED)
+        munmap(map, st.st_size);
+    return retval;
+}
+
+/*! Materialize an XML tree from a binary-format file given by name
+ * @param[in]  filename  File to read
+ * @param[out] xp        Top XML node, free with xml_free()
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+int
+clixon_bin2xml_file(const char *filename,
+                    cxobj     **xp)
+{
+    int retval = -1;
+    int fd = -1;
+
+    if ((fd = open(filename, O_RDONLY)) < 0){
+        clicon_err(OE_UNIX, errno, "open(%s)", filename);
+        goto done;
+    }
+    if (clixon_bin2xml_fd(fd, xp) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    return retval;
+}
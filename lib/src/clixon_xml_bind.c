@@ -89,6 +89,10 @@
 static int _yang_unknown_anydata = 0;
 static int _netconf_message_id_optional = 0;
 
+/* Forward */
+static int xml_bind_yang0_opt(clicon_handle h, cxobj *xt, yang_bind yb, yang_stmt *yspec,
+                              cxobj *xsibling, int sort, cxobj **xerr);
+
 /*! Kludge to equate unknown XML with anydata
  * The problem with this is that its global and should be bound to a handle
  */
@@ -375,22 +379,43 @@ populate_self_top(cxobj     *xt,
  */
 int
 xml_bind_yang(clicon_handle h,
-              cxobj     *xt, 
+              cxobj     *xt,
               yang_bind  yb,
               yang_stmt *yspec,
               cxobj    **xerr)
 {
-    int    retval = -1;
-    cxobj *xc;         /* xml child */
-    int    ret;
+    int        retval = -1;
+    cxobj     *xc;           /* xml child */
+    int        ret;
+    cxobj     *xc0 = NULL;   /* cache previous + prefix, see xml_bind_yang0_opt */
+    yang_stmt *yc0 = NULL;
+    char      *name0 = NULL;
+    char      *prefix0 = NULL;
+    char      *name;
+    char      *prefix;
 
     strip_body_objects(xt);
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
-        if ((ret = xml_bind_yang0(h, xc, yb, yspec, xerr)) < 0)
+        /* Runs of identical siblings (list entries) share schema node: reuse
+         * the previous child as role model instead of a full lookup */
+        name = xml_name(xc);
+        prefix = xml_prefix(xc);
+        if (yb == YB_PARENT &&
+            yc0 != NULL &&
+            clicon_strcmp(name0, name) == 0 &&
+            clicon_strcmp(prefix0, prefix) == 0)
+            ret = xml_bind_yang0_opt(h, xc, yb, yspec, xc0, 0, xerr);
+        else
+            ret = xml_bind_yang0(h, xc, yb, yspec, xerr);
+        if (ret < 0)
             goto done;
         if (ret == 0)
             goto fail;
+        xc0 = xc;
+        yc0 = xml_spec(xc); /* cache */
+        name0 = name;
+        prefix0 = prefix;
     }
     retval = 1;
  done:
@@ -400,6 +425,73 @@ xml_bind_yang(clicon_handle h,
     goto done;
 }
 
+/*! Find yang spec association of tree of XML nodes, sorting fused into the same pass
+ *
+ * As xml_bind_yang but each node's children are sorted (see xml_sort_node) as soon as
+ * they are bound, making a separate xml_sort_recurse pass over the tree unnecessary.
+ * Used by the parsers where parse+bind+sort would otherwise traverse every node thrice.
+ * @param[in]   h      Clixon handle (sometimes NULL)
+ * @param[in]   xt     XML tree node
+ * @param[in]   yb     How to bind yang to XML top-level when parsing
+ * @param[in]   yspec  Yang spec
+ * @param[out]  xerr   Reason for failure, or NULL
+ * @retval      1      OK yang assignment made and tree sorted
+ * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
+ * @retval     -1      Error
+ * @see xml_bind_yang   bind without sorting
+ * @note on retval 0 part of the tree may have been sorted
+ */
+int
+xml_bind_yang_sort(clicon_handle h,
+                   cxobj     *xt,
+                   yang_bind  yb,
+                   yang_stmt *yspec,
+                   cxobj    **xerr)
+{
+    int        retval = -1;
+    cxobj     *xc;           /* xml child */
+    int        ret;
+    cxobj     *xc0 = NULL;   /* cache previous + prefix, see xml_bind_yang0_opt */
+    yang_stmt *yc0 = NULL;
+    char      *name0 = NULL;
+    char      *prefix0 = NULL;
+    char      *name;
+    char      *prefix;
+
+    strip_body_objects(xt);
+    xc = NULL;     /* Apply on children */
+    while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
+        /* Runs of identical siblings (list entries) share schema node: reuse
+         * the previous child as role model instead of a full lookup */
+        name = xml_name(xc);
+        prefix = xml_prefix(xc);
+        if (yb == YB_PARENT &&
+            yc0 != NULL &&
+            clicon_strcmp(name0, name) == 0 &&
+            clicon_strcmp(prefix0, prefix) == 0)
+            ret = xml_bind_yang0_opt(h, xc, yb, yspec, xc0, 1, xerr);
+        else
+            ret = xml_bind_yang0_sort(h, xc, yb, yspec, xerr);
+        if (ret < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+        xc0 = xc;
+        yc0 = xml_spec(xc); /* cache */
+        name0 = name;
+        prefix0 = prefix;
+    }
+    /* Children subtrees are sorted, only this level remains */
+    if (xml_sort_node(xt) < 0)
+        goto done;
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*!
  *
  * @param[in]   h      Clixon handle (sometimes NULL)
@@ -407,6 +499,7 @@ xml_bind_yang(clicon_handle h,
  * @param[in]   yb     How to bind yang to XML top-level when parsing
  * @param[in]   yspec  Yang spec
  * @param[in]   xsibling
+ * @param[in]   sort   If set, sort children as soon as they are bound (fused sort pass)
  * @param[out]  xerr   Reason for failure, or NULL
  * @retval      1      OK yang assignment made
  * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
@@ -414,10 +507,11 @@ xml_bind_yang(clicon_handle h,
  */
 static int
 xml_bind_yang0_opt(clicon_handle h,
-                   cxobj     *xt, 
+                   cxobj     *xt,
                    yang_bind  yb,
                    yang_stmt *yspec,
                    cxobj     *xsibling,
+                   int        sort,
                    cxobj    **xerr)
 {
     int        retval = -1;
@@ -450,7 +544,7 @@ xml_bind_yang0_opt(clicon_handle h,
     if (ret == 0)
         goto fail;
     else if (ret == 2)     /* ret=2 for anyxml from parent^ */
-        goto ok;
+        goto unbound;
     strip_body_objects(xt);
     ybc = YB_PARENT;
 #ifdef YANG_SCHEMA_MOUNT // Maybe in populate?
@@ -463,19 +557,19 @@ xml_bind_yang0_opt(clicon_handle h,
         if (yspec1)
             ybc = YB_MODULE;
         else if (h == NULL)
-            goto ok; /* treat as anydata */
+            goto unbound; /* treat as anydata */
         else{
             if ((ret = yang_schema_yanglib_parse_mount(h, xt)) < 0)
                 goto done;
             if (ret == 0)
-                goto ok;
+                goto unbound;
             /* Try again */
             if ((ret = xml_yang_mount_get(xt, &yspec1)) < 0)
                 goto done;
             if (yspec1)
                 ybc = YB_MODULE;
             else
-                goto ok;
+                goto unbound;
         }
     }
 #else
@@ -490,15 +584,15 @@ xml_bind_yang0_opt(clicon_handle h,
         if (yc0 != NULL &&
             clicon_strcmp(name0, name) == 0 &&
             clicon_strcmp(prefix0, prefix) == 0){
-            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec1, xc0, xerr)) < 0)
+            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec1, xc0, sort, xerr)) < 0)
                 goto done;
         }
         else if (xsibling &&
                  (xs = xml_find_type(xsibling, prefix, name, CX_ELMNT)) != NULL){
-            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec1, xs, xerr)) < 0)
+            if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec1, xs, sort, xerr)) < 0)
                 goto done;
         }
-        else if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec1, NULL, xerr)) < 0)
+        else if ((ret = xml_bind_yang0_opt(h, xc, ybc, yspec1, NULL, sort, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
@@ -507,10 +601,18 @@ xml_bind_yang0_opt(clicon_handle h,
         name0 = xml_name(xc);
         prefix0 = xml_prefix(xc);
     }
+    /* Children now bound: sort them in the same pass */
+    if (sort && xml_sort_node(xt) < 0)
+        goto done;
  ok:
     retval = 1;
  done:
     return retval;
+ unbound: /* Subtree stays unbound: sort it with the generic recursion as the
+             separate sort pass would have */
+    if (sort && xml_sort_recurse(xt) < 0)
+        goto done;
+    goto ok;
  fail:
     retval = 0;
     goto done;
@@ -529,12 +631,13 @@ xml_bind_yang0_opt(clicon_handle h,
  * Populate xt as top-level node
  * @see xml_bind_yang  If only children of xt should be populated, not xt itself
  */
-int
-xml_bind_yang0(clicon_handle h,
-               cxobj     *xt, 
-               yang_bind  yb,
-               yang_stmt *yspec,
-               cxobj    **xerr)
+static int
+xml_bind_yang01(clicon_handle h,
+                cxobj     *xt,
+                yang_bind  yb,
+                yang_stmt *yspec,
+                int        sort,
+                cxobj    **xerr)
 {
     int        retval = -1;
     cxobj     *xc;           /* xml child */
@@ -542,7 +645,7 @@ xml_bind_yang0(clicon_handle h,
 
     switch (yb){
     case YB_MODULE:
-        if ((ret = populate_self_top(xt, yspec, xerr)) < 0) 
+        if ((ret = populate_self_top(xt, yspec, xerr)) < 0)
             goto done;
         break;
     case YB_PARENT:
@@ -559,16 +662,22 @@ xml_bind_yang0(clicon_handle h,
     }
     if (ret == 0)
         goto fail;
-    else if (ret == 2)     /* ret=2 for anyxml from parent^ */
+    else if (ret == 2){     /* ret=2 for anyxml from parent^ */
+        if (sort && xml_sort_recurse(xt) < 0) /* unbound subtree, generic sort */
+            goto done;
         goto ok;
+    }
     strip_body_objects(xt);
     xc = NULL;     /* Apply on children */
     while ((xc = xml_child_each(xt, xc, CX_ELMNT)) != NULL) {
-        if ((ret = xml_bind_yang0_opt(h, xc, YB_PARENT, yspec, NULL, xerr)) < 0)
+        if ((ret = xml_bind_yang0_opt(h, xc, YB_PARENT, yspec, NULL, sort, xerr)) < 0)
             goto done;
         if (ret == 0)
             goto fail;
     }
+    /* Children now bound: sort them in the same pass */
+    if (sort && xml_sort_node(xt) < 0)
+        goto done;
  ok:
     retval = 1;
  done:
@@ -578,6 +687,40 @@ xml_bind_yang0(clicon_handle h,
     goto done;
 }
 
+int
+xml_bind_yang0(clicon_handle h,
+               cxobj     *xt,
+               yang_bind  yb,
+               yang_stmt *yspec,
+               cxobj    **xerr)
+{
+    return xml_bind_yang01(h, xt, yb, yspec, 0, xerr);
+}
+
+/*! As xml_bind_yang0 but with sorting fused into the binding pass
+ *
+ * @param[in]   h      Clixon handle (sometimes NULL)
+ * @param[in]   xt     XML tree node
+ * @param[in]   yb     How to bind yang to XML top-level when parsing
+ * @param[in]   yspec  Yang spec
+ * @param[out]  xerr   Reason for failure, or NULL
+ * @retval      1      OK yang assignment made and subtree sorted
+ * @retval      0      Partial or no yang assigment made (at least one failed) and xerr set
+ * @retval     -1      Error
+ * The children of xt:s parent are NOT sorted, only xt:s subtree, see _xml_parse1 where
+ * the top level is sorted once after all top objects are bound
+ * @see xml_bind_yang_sort
+ */
+int
+xml_bind_yang0_sort(clicon_handle h,
+                    cxobj     *xt,
+                    yang_bind  yb,
+                    yang_stmt *yspec,
+                    cxobj    **xerr)
+{
+    return xml_bind_yang01(h, xt, yb, yspec, 1, xerr);
+}
+
 /*! RPC-specific
  * @param[in]   h      Clixon handle (sometimes NULL)
  */
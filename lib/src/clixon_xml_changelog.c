@@ -78,6 +78,52 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 
+/*
+ * Compiled changelog plan
+ * The changelog XML is interpreted per module upgrade: every upgrade callback
+ * re-selected the entries of its namespace with xpath, re-parsed revision
+ * dates and rebuilt a namespace context per step. The changelog is instead
+ * compiled once into an ordered plan of entries and steps with those parts
+ * pre-resolved; applying an upgrade walks the plan directly. The plan points
+ * into the stored changelog tree for all strings and is rebuilt if that tree
+ * is replaced.
+ */
+#define CHANGELOG_PLAN_NAME "xml-changelog-plan"
+
+enum changelog_op_t{
+    CL_RENAME,
+    CL_REPLACE,
+    CL_INSERT,
+    CL_DELETE,
+    CL_MOVE
+};
+
+/* One changelog step with op and arguments pre-resolved */
+struct changelog_step{
+    struct changelog_step *cs_next;
+    enum changelog_op_t    cs_op;
+    cvec                  *cs_nsc;   /* Namespace context of step (owned) */
+    char                  *cs_where; /* Target xpath */
+    char                  *cs_when;  /* Optional condition xpath */
+    char                  *cs_tag;   /* rename: new tag xpath */
+    char                  *cs_dst;   /* move: destination xpath */
+    cxobj                 *cs_new;   /* insert/replace: new XML */
+};
+
+/* One changelog entry: steps of one namespace and revision interval */
+struct changelog_entry{
+    struct changelog_entry *ce_next;
+    char                   *ce_ns;    /* Namespace */
+    uint32_t                ce_from;  /* revfrom as YYYYMMDD, or 0 */
+    uint32_t                ce_rev;   /* revision as YYYYMMDD, or 0 */
+    struct changelog_step  *ce_steps; /* Ordered steps */
+};
+
+struct changelog_plan{
+    cxobj                  *cp_xml;     /* Changelog tree plan is compiled from */
+    struct changelog_entry *cp_entries; /* Ordered entries */
+};
+
 static int
 changelog_rename(clicon_handle h,
                  cxobj        *xt,
@@ -215,55 +261,37 @@ changelog_move(clicon_handle h,
     return retval;
 }
 
-/*! Perform a changelog operation
+/*! Apply one pre-compiled changelog step
  * @param[in]  h   Clicon handle
  * @param[in]  xt  XML to upgrade
- * @param[in]  xi  Changelog item
-
+ * @param[in]  cs  Compiled changelog step
+ * @retval     1   OK
+ * @retval     0   Invalid
+ * @retval    -1   Error
  * @note XXX error handling!
  * @note XXX xn --> xt  xpath may not match
 */
 static int
-changelog_op(clicon_handle h,
-             cxobj        *xt,
-             cxobj        *xi)
-
+changelog_step_apply(clicon_handle          h,
+                     cxobj                 *xt,
+                     struct changelog_step *cs)
 {
     int     retval = -1;
-    char   *op;
-    char   *whenxpath;   /* xpath to when */
-    char   *tag;         /* xpath to extra path (move) */
-    char   *dst;         /* xpath to extra path (move) */
-    cxobj  *xnew;        /* new xml (insert, replace) */
-    char   *wxpath;      /* xpath to where (target-node) */
     cxobj **wvec = NULL; /* Vector of where(target) nodes */
     size_t  wlen;
     cxobj  *xw;
     int     ret;
     xp_ctx *xctx = NULL;
     int     i;
-    cvec   *nsc = NULL;
 
-    /* Get namespace context from changelog item */
-    if (xml_nsctx_node(xi, &nsc) < 0)
-        goto done;
-    if ((op = xml_find_body(xi, "op")) == NULL)
-        goto ok;
-    /* get common variables that may be used in the operations below */
-    tag = xml_find_body(xi, "tag");
-    dst = xml_find_body(xi, "dst");
-    xnew = xml_find(xi, "new");
-    whenxpath = xml_find_body(xi, "when");
-    if ((wxpath = xml_find_body(xi, "where")) == NULL)
-        goto ok;
     /* Get vector of target nodes meeting the where requirement */
-    if (xpath_vec(xt, nsc, "%s", &wvec, &wlen, wxpath) < 0)
+    if (xpath_vec(xt, cs->cs_nsc, "%s", &wvec, &wlen, cs->cs_where) < 0)
        goto done;
    for (i=0; i<wlen; i++){
        xw = wvec[i];
        /* If 'when' exists and is false, skip this target */
-       if (whenxpath){
-           if (xpath_vec_ctx(xw, nsc, whenxpath, 0, &xctx) < 0)
+       if (cs->cs_when){
+           if (xpath_vec_ctx(xw, cs->cs_nsc, cs->cs_when, 0, &xctx) < 0)
                goto done;
            if ((ret = ctx2boolean(xctx)) < 0)
                goto done;
@@ -275,23 +303,24 @@ changelog_op(clicon_handle h,
                continue;
        }
        /* Now switch on operation */
-       if (strcmp(op, "rename") == 0){
-           ret = changelog_rename(h, xt, xw, nsc, tag);
-       }
-       else if (strcmp(op, "replace") == 0){
-           ret = changelog_replace(h, xt, xw, xnew);
-       }
-       else if (strcmp(op, "insert") == 0){
-           ret = changelog_insert(h, xt, xw, xnew);
-       }
-       else if (strcmp(op, "delete") == 0){
+       switch (cs->cs_op){
+       case CL_RENAME:
+           ret = changelog_rename(h, xt, xw, cs->cs_nsc, cs->cs_tag);
+           break;
+       case CL_REPLACE:
+           ret = changelog_replace(h, xt, xw, cs->cs_new);
+           break;
+       case CL_INSERT:
+           ret = changelog_insert(h, xt, xw, cs->cs_new);
+           break;
+       case CL_DELETE:
            ret = changelog_delete(h, xt, xw);
-       }
-       else if (strcmp(op, "move") == 0){
-           ret = changelog_move(h, xt, xw, nsc, dst);
-       }
-       else{
-           clicon_err(OE_XML, 0, "Unknown operation: %s", op);
+           break;
+       case CL_MOVE:
+           ret = changelog_move(h, xt, xw, cs->cs_nsc, cs->cs_dst);
+           break;
+       default:
+           clicon_err(OE_XML, 0, "Unknown operation: %d", cs->cs_op);
            goto done;
        }
        if (ret < 0)
@@ -299,11 +328,8 @@ changelog_op(clicon_handle h,
        if (ret == 0)
            goto fail;
    }
- ok:
     retval = 1;
  done:
-    if (nsc)
-        xml_nsctx_free(nsc);
     if (wvec)
         free(wvec);
     if (xctx)
@@ -311,45 +337,185 @@ changelog_op(clicon_handle h,
     return retval;
  fail:
     retval = 0;
-    clicon_debug(1, "%s fail op:%s ", __FUNCTION__, op);
+    clicon_debug(1, "%s fail op:%d ", __FUNCTION__, cs->cs_op);
     goto done;
 }
-    
-/*! Iterate through one changelog item
- * @param[in]  h   Clicon handle
- * @param[in]  xt  Changelog list
- * @param[in]  xn  XML to upgrade
+
+/*! Free a compiled changelog plan structure
  */
 static int
-changelog_iterate(clicon_handle h,
-                  cxobj        *xt,
-                  cxobj        *xch)
+changelog_plan_free1(struct changelog_plan *cp)
+{
+    struct changelog_entry *ce;
+    struct changelog_step  *cs;
+
+    while ((ce = cp->cp_entries) != NULL){
+        cp->cp_entries = ce->ce_next;
+        while ((cs = ce->ce_steps) != NULL){
+            ce->ce_steps = cs->cs_next;
+            if (cs->cs_nsc)
+                xml_nsctx_free(cs->cs_nsc);
+            free(cs);
+        }
+        free(ce);
+    }
+    free(cp);
+    return 0;
+}
 
+/*! Free the compiled changelog plan of a handle, if any
+ * @param[in]  h   Clicon handle
+ */
+int
+xml_changelog_plan_free(clicon_handle h)
 {
-    int        retval = -1;
-    cxobj    **vec = NULL;
-    size_t     veclen;
-    int        ret;
-    int        i;
-    
-    if (xpath_vec(xch, NULL, "step", &vec, &veclen) < 0)
+    struct changelog_plan *cp = NULL;
+
+    if (clicon_ptr_get(h, CHANGELOG_PLAN_NAME, (void**)&cp) == 0 &&
+        cp != NULL){
+        changelog_plan_free1(cp);
+        clicon_ptr_set(h, CHANGELOG_PLAN_NAME, NULL);
+    }
+    return 0;
+}
+
+/*! Compile the changelog XML into an ordered plan of entries and steps
+ * Strings point into the changelog tree which outlives the plan.
+ * Steps without op or where can never apply and are dropped here, as are
+ * entries without namespace; unknown ops are an error at compile instead of
+ * on every upgrade.
+ * @param[in]  xchlog  Changelog XML
+ * @param[out] cpp     Malloced plan, use changelog_plan_free1() to free
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+changelog_plan_build(cxobj                  *xchlog,
+                     struct changelog_plan **cpp)
+{
+    int                     retval = -1;
+    struct changelog_plan  *cp = NULL;
+    struct changelog_entry *ce;
+    struct changelog_entry**cep;
+    struct changelog_step  *cs;
+    struct changelog_step **csp;
+    cxobj                  *xch;
+    cxobj                  *xi;
+    char                   *ns;
+    char                   *op;
+    char                   *b;
+
+    if ((cp = malloc(sizeof(*cp))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
         goto done;
-    /* Iterate through changelog items */
-    for (i=0; i<veclen; i++){
-        if ((ret = changelog_op(h, xt, vec[i])) < 0)
+    }
+    memset(cp, 0, sizeof(*cp));
+    cp->cp_xml = xchlog;
+    cep = &cp->cp_entries;
+    xch = NULL;
+    while ((xch = xml_child_each(xchlog, xch, CX_ELMNT)) != NULL){
+        if (strcmp(xml_name(xch), "changelog") != 0)
+            continue;
+        if ((ns = xml_find_body(xch, "namespace")) == NULL)
+            continue;
+        if ((ce = malloc(sizeof(*ce))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
             goto done;
-        if (ret == 0)
-            goto fail;
+        }
+        memset(ce, 0, sizeof(*ce));
+        ce->ce_ns = ns;
+        *cep = ce;
+        cep = &ce->ce_next;
+        if ((b = xml_find_body(xch, "revfrom")) != NULL)
+            if (ys_parse_date_arg(b, &ce->ce_from) < 0)
+                goto done;
+        if ((b = xml_find_body(xch, "revision")) != NULL)
+            if (ys_parse_date_arg(b, &ce->ce_rev) < 0)
+                goto done;
+        csp = &ce->ce_steps;
+        xi = NULL;
+        while ((xi = xml_child_each(xch, xi, CX_ELMNT)) != NULL){
+            if (strcmp(xml_name(xi), "step") != 0)
+                continue;
+            if ((op = xml_find_body(xi, "op")) == NULL)
+                continue;
+            if ((cs = malloc(sizeof(*cs))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(cs, 0, sizeof(*cs));
+            if (strcmp(op, "rename") == 0)
+                cs->cs_op = CL_RENAME;
+            else if (strcmp(op, "replace") == 0)
+                cs->cs_op = CL_REPLACE;
+            else if (strcmp(op, "insert") == 0)
+                cs->cs_op = CL_INSERT;
+            else if (strcmp(op, "delete") == 0)
+                cs->cs_op = CL_DELETE;
+            else if (strcmp(op, "move") == 0)
+                cs->cs_op = CL_MOVE;
+            else{
+                clicon_err(OE_XML, 0, "Unknown operation: %s", op);
+                free(cs);
+                goto done;
+            }
+            if ((cs->cs_where = xml_find_body(xi, "where")) == NULL){
+                free(cs);
+                continue;
+            }
+            /* Get namespace context from changelog item */
+            if (xml_nsctx_node(xi, &cs->cs_nsc) < 0){
+                free(cs);
+                goto done;
+            }
+            cs->cs_when = xml_find_body(xi, "when");
+            cs->cs_tag = xml_find_body(xi, "tag");
+            cs->cs_dst = xml_find_body(xi, "dst");
+            cs->cs_new = xml_find(xi, "new");
+            *csp = cs;
+            csp = &cs->cs_next;
+        }
     }
-    retval = 1;
+    *cpp = cp;
+    cp = NULL;
+    retval = 0;
  done:
-    clicon_debug(1, "%s retval: %d", __FUNCTION__, retval);
-    if (vec)
-        free(vec);
+    if (cp)
+        changelog_plan_free1(cp);
     return retval;
- fail:
-    retval = 0;
-    goto done;
+}
+
+/*! Get the compiled changelog plan, building it on first use
+ * Rebuilt if the stored changelog tree has been replaced.
+ * @param[in]  h       Clicon handle
+ * @param[in]  xchlog  Changelog XML
+ * @param[out] cpp     Compiled plan, owned by handle
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+changelog_plan_get(clicon_handle           h,
+                   cxobj                  *xchlog,
+                   struct changelog_plan **cpp)
+{
+    struct changelog_plan *cp = NULL;
+
+    if (clicon_ptr_get(h, CHANGELOG_PLAN_NAME, (void**)&cp) < 0)
+        return -1;
+    if (cp && cp->cp_xml != xchlog){ /* changelog replaced: plan is stale */
+        xml_changelog_plan_free(h);
+        cp = NULL;
+    }
+    if (cp == NULL){
+        if (changelog_plan_build(xchlog, &cp) < 0)
+            return -1;
+        if (clicon_ptr_set(h, CHANGELOG_PLAN_NAME, cp) < 0){
+            changelog_plan_free1(cp);
+            return -1;
+        }
+    }
+    *cpp = cp;
+    return 0;
 }
 
 /*! Automatic upgrade using changelog
@@ -376,16 +542,12 @@ xml_changelog_upgrade(clicon_handle h,
                       void         *arg,     
                       cbuf         *cbret)
 {
-    int        retval = -1;
-    cxobj     *xchlog; /* changelog */
-    cxobj    **vec = NULL;
-    cxobj     *xch;
-    size_t     veclen;
-    char      *b;
-    int        ret;
-    int        i;
-    uint32_t   f;
-    uint32_t   t;
+    int                     retval = -1;
+    cxobj                  *xchlog; /* changelog */
+    struct changelog_plan  *cp;
+    struct changelog_entry *ce;
+    struct changelog_step  *cs;
+    int                     ret;
 
     /* Check if changelog enabled */
     if (!clicon_option_bool(h, "CLICON_XML_CHANGELOG"))
@@ -393,36 +555,27 @@ xml_changelog_upgrade(clicon_handle h,
     /* Get changelog */
     if ((xchlog = clicon_xml_changelog_get(h)) == NULL)
         goto ok;
-
-    /* Iterate and find relevant changelog entries in the interval:
-     * - find all changelogs in the interval: [from, to]
-     * - note it t=0 then no changelog is applied
-     */
-    if (xpath_vec(xchlog, NULL, "changelog[namespace=\"%s\"]", 
-                  &vec, &veclen, ns) < 0)
+    /* Get compiled plan, built once for all modules */
+    if (changelog_plan_get(h, xchlog, &cp) < 0)
         goto done;
-    /* Get all changelogs in the interval [from,to]*/
-    for (i=0; i<veclen; i++){
-        xch = vec[i];
-        f = t = 0;
-        if ((b = xml_find_body(xch, "revfrom")) != NULL)
-            if (ys_parse_date_arg(b, &f) < 0)
-                goto done;
-        if ((b = xml_find_body(xch, "revision")) != NULL)
-            if (ys_parse_date_arg(b, &t) < 0)
-                goto done;
-        if ((f && from>f) || to<t)
+    /* Apply the entries of this namespace in the interval [from,to]
+     * - note if t=0 then no changelog is applied
+     */
+    for (ce = cp->cp_entries; ce; ce = ce->ce_next){
+        if (strcmp(ce->ce_ns, ns) != 0)
             continue;
-        if ((ret = changelog_iterate(h, xt, xch)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
+        if ((ce->ce_from && from > ce->ce_from) || to < ce->ce_rev)
+            continue;
+        for (cs = ce->ce_steps; cs; cs = cs->cs_next){
+            if ((ret = changelog_step_apply(h, xt, cs)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+        }
     }
  ok:
     retval = 1;
  done:
-    if (vec)
-        free(vec);
     return retval;
  fail:
     retval = 0;
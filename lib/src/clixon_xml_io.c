@@ -75,12 +75,6 @@
 #include "clixon_xml_parse.h"
 #include "clixon_xml_io.h"
 
-/*
- * Constants
- */
-/* Size of xml read buffer */
-#define BUFLEN 1024  
-
 /*------------------------------------------------------------------------
  * XML printing functions. Output a parse tree to file, string cligen buf
  *------------------------------------------------------------------------*/
@@ -249,6 +243,297 @@ clixon_xml2file(FILE             *f,
     return retval;
 }
 
+/* State for canonical XML printing, see clixon_xml2file_canonical */
+struct canon_state{
+    cvec          *cs_nsc;    /* Canonical prefix:namespace pairs, see xml_nsctx_yangspec */
+    clicon_hash_t *cs_shadow; /* Count per prefix of kept declarations along the current
+                                 path that rebind a canonical prefix */
+    int            cs_hoist;  /* Print all canonical declarations on the top element */
+    yang_stmt     *cs_ymod;   /* Memo: module of last resolved element */
+    char          *cs_prefix; /* Memo: canonical prefix of cs_ymod */
+};
+
+/*! Adjust shadow count of a rebound canonical prefix
+ * @param[in]  shadow  Hash of prefix -> count
+ * @param[in]  pfx     Prefix
+ * @param[in]  delta   +1 when a rebinding declaration is kept, -1 when leaving its scope
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+canon_shadow_adjust(clicon_hash_t *shadow,
+                    char          *pfx,
+                    int            delta)
+{
+    uint32_t cnt = 0;
+    size_t   len = 0;
+    void    *p;
+
+    if ((p = clicon_hash_value(shadow, pfx, &len)) != NULL && len == sizeof(cnt))
+        cnt = *(uint32_t*)p;
+    cnt += delta;
+    if (clicon_hash_add(shadow, pfx, &cnt, sizeof(cnt)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Check if an attribute is a namespace declaration made redundant by canonical scope
+ *
+ * A prefixed declaration is redundant if the canonical context binds the same
+ * prefix to the same namespace and no kept declaration on the path rebinds it.
+ * A default declaration is redundant if an ancestor declared the same default.
+ * @param[in]  xa     Attribute node
+ * @param[in]  defns  Default namespace in scope from kept ancestor declarations
+ * @param[in]  cs     Canonical print state
+ * @retval     1      Redundant, can be dropped
+ * @retval     0      Keep
+ */
+static int
+canon_attr_redundant(cxobj             *xa,
+                     char              *defns,
+                     struct canon_state *cs)
+{
+    char     *aprefix;
+    char     *aval;
+    char     *ns;
+    uint32_t *cnt;
+    size_t    len = 0;
+
+    if ((aval = xml_value(xa)) == NULL)
+        return 0;
+    if ((aprefix = xml_prefix(xa)) == NULL){
+        if (strcmp(xml_name(xa), "xmlns") == 0 &&
+            defns && strcmp(aval, defns) == 0)
+            return 1;
+    }
+    else if (strcmp(aprefix, "xmlns") == 0){
+        if ((cnt = clicon_hash_value(cs->cs_shadow, xml_name(xa), &len)) != NULL &&
+            len == sizeof(*cnt) && *cnt > 0)
+            return 0; /* canonical binding is shadowed here */
+        if ((ns = xml_nsctx_get(cs->cs_nsc, xml_name(xa))) != NULL &&
+            strcmp(ns, aval) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/*! Print XML tree in canonical form: fixed prefixes, no redundant xmlns attributes
+ *
+ * Elements are printed with the canonical prefix of their yang module, relying
+ * on the declarations hoisted to the top element, and namespace declarations
+ * that repeat a binding already in scope are dropped. Elements without a yang
+ * binding or outside the canonical context fall back to generic printing with
+ * their declarations kept.
+ * @param[in]  f       Output stream
+ * @param[in]  x       XML node
+ * @param[in]  level   Indentation level
+ * @param[in]  pretty  Insert \n and spaces to make the xml more readable
+ * @param[in]  fn      File print function
+ * @param[in]  defns   Default namespace in scope from kept ancestor declarations
+ * @param[in]  top     This is the (first) top element: print it even without a
+ *                     canonical mapping and hoist declarations if requested
+ * @param[in]  cs      Canonical print state
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see xml2file_recurse  generic variant
+ */
+static int
+xml2file_canonical_recurse(FILE              *f,
+                           cxobj             *x,
+                           int                level,
+                           int                pretty,
+                           clicon_output_cb  *fn,
+                           char              *defns,
+                           int                top,
+                           struct canon_state *cs)
+{
+    int        retval = -1;
+    char      *name;
+    char      *prefix = NULL;
+    char      *aprefix;
+    char      *val;
+    char      *encstr = NULL;
+    char      *defns1;
+    char      *ns;
+    cxobj     *xc;
+    yang_stmt *y;
+    yang_stmt *ymod;
+    int        hasbody;
+    int        haselement;
+    cg_var    *cv;
+
+    if (x == NULL)
+        goto ok;
+    name = xml_name(x);
+    switch (xml_type(x)){
+    case CX_BODY:
+        if ((val = xml_value(x)) == NULL) /* incomplete tree */
+            break;
+        if (xml_chardata_encode(&encstr, "%s", val) < 0)
+            goto done;
+        (*fn)(f, "%s", encstr);
+        break;
+    case CX_ELMNT:
+        /* Resolve the canonical prefix of the element's module, memoized */
+        if ((y = xml_spec(x)) != NULL &&
+            (ymod = ys_module(y)) != NULL){
+            if (ymod == cs->cs_ymod)
+                prefix = cs->cs_prefix;
+            else if ((ns = yang_find_mynamespace(y)) != NULL &&
+                     xml_nsctx_get_prefix(cs->cs_nsc, ns, &prefix) == 1 &&
+                     prefix != NULL && strlen(prefix)){
+                cs->cs_ymod = ymod;
+                cs->cs_prefix = prefix;
+            }
+            else
+                prefix = NULL;
+        }
+        if (prefix == NULL && !top){
+            /* No canonical mapping: print subtree generically, dropped ancestor
+             * declarations remain in scope via the hoisted top block */
+            retval = xml2file_recurse(f, x, level, pretty, fn, 0);
+            goto done;
+        }
+        if (prefix == NULL)
+            prefix = xml_prefix(x);
+        (*fn)(f, "%*s<", pretty?(level*PRETTYPRINT_INDENT):0, "");
+        if (prefix)
+            (*fn)(f, "%s:", prefix);
+        (*fn)(f, "%s", name);
+        if (top && cs->cs_hoist){
+            cv = NULL;
+            while ((cv = cvec_each(cs->cs_nsc, cv)) != NULL){
+                if (cv_name_get(cv) == NULL || strlen(cv_name_get(cv)) == 0)
+                    continue; /* the default namespace is not hoisted */
+                (*fn)(f, " xmlns:%s=\"%s\"", cv_name_get(cv), cv_string_get(cv));
+            }
+        }
+        defns1 = defns;
+        hasbody = 0;
+        haselement = 0;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+            switch (xml_type(xc)){
+            case CX_ATTR:
+                if (canon_attr_redundant(xc, defns, cs))
+                    break;
+                aprefix = xml_prefix(xc);
+                if (aprefix == NULL){
+                    if (strcmp(xml_name(xc), "xmlns") == 0)
+                        defns1 = xml_value(xc);
+                }
+                else if (strcmp(aprefix, "xmlns") == 0 &&
+                         canon_shadow_adjust(cs->cs_shadow, xml_name(xc), 1) < 0)
+                    goto done;
+                (*fn)(f, " ");
+                if (aprefix)
+                    (*fn)(f, "%s:", aprefix);
+                (*fn)(f, "%s=\"%s\"", xml_name(xc), xml_value(xc));
+                break;
+            case CX_BODY:
+                hasbody = 1;
+                break;
+            case CX_ELMNT:
+                haselement = 1;
+                break;
+            default:
+                break;
+            }
+        }
+        if (hasbody==0 && haselement==0)
+            (*fn)(f, "/>");
+        else{
+            (*fn)(f, ">");
+            if (pretty && hasbody == 0)
+                (*fn)(f, "\n");
+            xc = NULL;
+            while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+                if (xml_type(xc) != CX_ATTR)
+                    if (xml2file_canonical_recurse(f, xc, level+1, pretty, fn, defns1, 0, cs) < 0)
+                        goto done;
+            }
+            if (pretty && hasbody==0)
+                (*fn)(f, "%*s", level*PRETTYPRINT_INDENT, "");
+            (*fn)(f, "</");
+            if (prefix)
+                (*fn)(f, "%s:", prefix);
+            (*fn)(f, "%s>", name);
+        }
+        if (pretty)
+            (*fn)(f, "\n");
+        /* Leave scope of kept rebinding declarations, mirrors the push above */
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+            if (xml_type(xc) != CX_ATTR)
+                continue;
+            aprefix = xml_prefix(xc);
+            if (aprefix && strcmp(aprefix, "xmlns") == 0 &&
+                !canon_attr_redundant(xc, defns, cs) &&
+                canon_shadow_adjust(cs->cs_shadow, xml_name(xc), -1) < 0)
+                goto done;
+        }
+        break;
+    default:
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (encstr)
+        free(encstr);
+    return retval;
+}
+
+/*! Print an XML tree in canonical form for datastore files
+ *
+ * All canonical namespace declarations from nsc are hoisted to the top element
+ * with fixed prefixes, every yang-bound element is printed with its module's
+ * canonical prefix, and per-node xmlns attributes repeating an in-scope binding
+ * are stripped. Output parses back with the standard XML parser.
+ * @param[in]  f       Output file
+ * @param[in]  xn      XML tree
+ * @param[in]  level   How many spaces to insert before each line
+ * @param[in]  pretty  Insert \n and spaces to make the xml more readable
+ * @param[in]  fn      File print function (if NULL, use fprintf)
+ * @param[in]  nsc     Canonical namespace context, see xml_nsctx_yangspec
+ * @param[in]  hoist   Print the declaration block on xn:s start tag. Set to 0 if
+ *                     the caller has already printed it on an enclosing element
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_xml2file  generic variant
+ * @see CLICON_XMLDB_CANONICAL
+ */
+int
+clixon_xml2file_canonical(FILE             *f,
+                          cxobj            *xn,
+                          int               level,
+                          int               pretty,
+                          clicon_output_cb *fn,
+                          cvec             *nsc,
+                          int               hoist)
+{
+    int                retval = -1;
+    struct canon_state cs = {0};
+
+    if (xn == NULL || nsc == NULL){
+        clicon_err(OE_XML, EINVAL, "xn or nsc is NULL");
+        goto done;
+    }
+    if (fn == NULL)
+        fn = fprintf;
+    cs.cs_nsc = nsc;
+    cs.cs_hoist = hoist;
+    if ((cs.cs_shadow = clicon_hash_init()) == NULL)
+        goto done;
+    if (xml2file_canonical_recurse(f, xn, level, pretty, fn, NULL, 1, &cs) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cs.cs_shadow)
+        clicon_hash_free(cs.cs_shadow);
+    return retval;
+}
+
 /*! Print an XML tree structure to an output stream
  *
  * Utility function eg in gdb. For code, use clixon_xml2file
@@ -258,7 +543,7 @@ clixon_xml2file(FILE             *f,
  * @see clixon_xml2cbuf_cb print using a callback
  */
 int
-xml_print(FILE  *f, 
+xml_print(FILE  *f,
           cxobj *x)
 {
     return xml2file_recurse(f, x, 0, 1, fprintf, 0);
@@ -349,13 +634,15 @@ clixon_xml2cbuf1(cbuf   *cb,
             cbuf_append_str(cb, namespace);
             cbuf_append_str(cb, ":");
         }
-        cprintf(cb, "%s=\"%s\"", name, xml_value(x));
+        cbuf_append_str(cb, name);
+        cbuf_append_str(cb, "=\"");
+        cbuf_append_str(cb, xml_value(x));
+        cbuf_append_str(cb, "\"");
         break;
     case CX_ELMNT:
         if (pretty)
-            cprintf(cb, "%*s<", level*PRETTYPRINT_INDENT, "");
-        else
-            cbuf_append_str(cb, "<");
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        cbuf_append_str(cb, "<");
         if (namespace){
             cbuf_append_str(cb, namespace);
             cbuf_append_str(cb, ":");
@@ -393,7 +680,7 @@ clixon_xml2cbuf1(cbuf   *cb,
                     if (clixon_xml2cbuf1(cb, xc, level+1, pretty, depth-1) < 0)
                         goto done;
             if (pretty && hasbody == 0)
-                cprintf(cb, "%*s", level*PRETTYPRINT_INDENT, "");
+                clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
             cbuf_append_str(cb, "</");
             if (namespace){
                 cbuf_append_str(cb, namespace);
@@ -460,6 +747,272 @@ clixon_xml2cbuf(cbuf   *cb,
     return retval;
 }
 
+/*! Incremental XML serializer cursor
+ *
+ * Keeps the position of an iterative depth-first traversal so that a large tree can be
+ * serialized in bounded-size chunks instead of one monolithic cbuf, eg from a transport
+ * write callback. Output is identical to clixon_xml2cbuf with depth -1.
+ * @see clixon_xml_cursor_new
+ */
+struct xml_serialize_cursor{
+    cxobj *xsc_top;     /* Top node, not emitted if xsc_skiptop */
+    cxobj *xsc_next;    /* Next node to emit, NULL means serialization done */
+    int    xsc_enter;   /* 1: emit start tag/body of xsc_next, 0: emit its end tag */
+    int    xsc_level0;  /* Start indentation level for prettyprint */
+    int    xsc_pretty;  /* Insert \n and spaces to make the xml more readable */
+    int    xsc_skiptop; /* 0: Include top object 1: Skip top-object, only children */
+};
+
+/*! Return next non-attribute child of xp after xprev (or first if xprev is NULL)
+ * At top level with skiptop, only elements are emitted to match clixon_xml2cbuf
+ */
+static cxobj *
+xml_cursor_sibling(clixon_xml_cursor *xsc,
+                   cxobj             *xp,
+                   cxobj             *xprev)
+{
+    cxobj *xc = xprev;
+
+    if (xsc->xsc_skiptop && xp == xsc->xsc_top)
+        return xml_child_each(xp, xc, CX_ELMNT);
+    while ((xc = xml_child_each(xp, xc, -1)) != NULL)
+        if (xml_type(xc) != CX_ATTR)
+            break;
+    return xc;
+}
+
+/*! Compute prettyprint indentation level of x relative the cursor top */
+static int
+xml_cursor_level(clixon_xml_cursor *xsc,
+                 cxobj             *x)
+{
+    int    level = xsc->xsc_level0;
+    cxobj *xp;
+
+    for (xp = x; xp != xsc->xsc_top; xp = xml_parent(xp))
+        level++;
+    if (xsc->xsc_skiptop)
+        level--;
+    return level;
+}
+
+/*! Advance cursor past node x in post-order: next sibling, else close parent */
+static int
+xml_cursor_advance(clixon_xml_cursor *xsc,
+                   cxobj             *x)
+{
+    cxobj *xs;
+    cxobj *xp;
+
+    if (x == xsc->xsc_top){
+        xsc->xsc_next = NULL;
+        return 0;
+    }
+    xp = xml_parent(x);
+    if ((xs = xml_cursor_sibling(xsc, xp, x)) != NULL){
+        xsc->xsc_next = xs;
+        xsc->xsc_enter = 1;
+    }
+    else if (xp == xsc->xsc_top && xsc->xsc_skiptop)
+        xsc->xsc_next = NULL;
+    else{
+        xsc->xsc_next = xp;
+        xsc->xsc_enter = 0;
+    }
+    return 0;
+}
+
+/*! Emit one serialization event (start tag+attrs, body, or end tag) and advance cursor
+ * Mirrors the output of clixon_xml2cbuf1
+ */
+static int
+xml_cursor_step(clixon_xml_cursor *xsc,
+                cbuf              *cb)
+{
+    int    retval = -1;
+    cxobj *x = xsc->xsc_next;
+    cxobj *xc;
+    char  *name;
+    char  *namespace;
+    char  *val;
+    int    hasbody;
+    int    haselement;
+    int    level;
+
+    name = xml_name(x);
+    namespace = xml_prefix(x);
+    level = xml_cursor_level(xsc, x);
+    if (!xsc->xsc_enter){ /* end tag of element x, all children emitted */
+        hasbody = 0;
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_BODY)) != NULL)
+            hasbody = 1;
+        if (xsc->xsc_pretty && hasbody == 0)
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        cbuf_append_str(cb, "</");
+        if (namespace){
+            cbuf_append_str(cb, namespace);
+            cbuf_append_str(cb, ":");
+        }
+        cbuf_append_str(cb, name);
+        cbuf_append_str(cb, ">");
+        if (xsc->xsc_pretty)
+            cbuf_append_str(cb, "\n");
+        if (xml_cursor_advance(xsc, x) < 0)
+            goto done;
+        goto ok;
+    }
+    switch(xml_type(x)){
+    case CX_BODY:
+        if ((val = xml_value(x)) != NULL)
+            if (xml_chardata_cbuf_append(cb, val) < 0)
+                goto done;
+        if (xml_cursor_advance(xsc, x) < 0)
+            goto done;
+        break;
+    case CX_ELMNT:
+        if (xsc->xsc_pretty)
+            clixon_cbuf_append_indent(cb, level*PRETTYPRINT_INDENT);
+        cbuf_append_str(cb, "<");
+        if (namespace){
+            cbuf_append_str(cb, namespace);
+            cbuf_append_str(cb, ":");
+        }
+        cbuf_append_str(cb, name);
+        hasbody = 0;
+        haselement = 0;
+        xc = NULL;
+        /* print attributes only */
+        while ((xc = xml_child_each(x, xc, -1)) != NULL)
+            switch (xml_type(xc)){
+            case CX_ATTR:
+                cbuf_append_str(cb, " ");
+                if (xml_prefix(xc)){
+                    cbuf_append_str(cb, xml_prefix(xc));
+                    cbuf_append_str(cb, ":");
+                }
+                cbuf_append_str(cb, xml_name(xc));
+                cbuf_append_str(cb, "=\"");
+                cbuf_append_str(cb, xml_value(xc));
+                cbuf_append_str(cb, "\"");
+                break;
+            case CX_BODY:
+                hasbody=1;
+                break;
+            case CX_ELMNT:
+                haselement=1;
+                break;
+            default:
+                break;
+            }
+        /* Check for special case <a/> instead of <a></a> */
+        if (hasbody==0 && haselement==0){
+            cbuf_append_str(cb, "/>");
+            if (xsc->xsc_pretty)
+                cbuf_append_str(cb, "\n");
+            if (xml_cursor_advance(xsc, x) < 0)
+                goto done;
+        }
+        else{
+            cbuf_append_str(cb, ">");
+            if (xsc->xsc_pretty && hasbody == 0)
+                cbuf_append_str(cb, "\n");
+            /* descend: non-attr child exists since hasbody or haselement */
+            xsc->xsc_next = xml_cursor_sibling(xsc, x, NULL);
+            xsc->xsc_enter = 1;
+        }
+        break;
+    default: /* attributes are part of the element start tag */
+        if (xml_cursor_advance(xsc, x) < 0)
+            goto done;
+        break;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Create incremental XML serializer cursor over a tree
+ *
+ * @param[in]  xn      Top-level xml object
+ * @param[in]  level   Start indentation level for pretty
+ * @param[in]  pretty  Insert \n and spaces to make the xml more readable.
+ * @param[in]  skiptop 0: Include top object 1: Skip top-object, only children
+ * @retval     xsc     Cursor, free with clixon_xml_cursor_free
+ * @retval     NULL    Error
+ * The tree must not be modified or freed while the cursor is in use.
+ * @code
+ *   clixon_xml_cursor *xsc;
+ *   int                eof = 0;
+ *   if ((xsc = clixon_xml_cursor_new(xn, 0, 1, 0)) == NULL)
+ *     goto err;
+ *   while (!eof){
+ *     if (clixon_xml_cursor_chunk(xsc, cb, 8192, &eof) < 0)
+ *       goto err;
+ *     ... // consume and reset cb
+ *   }
+ *   clixon_xml_cursor_free(xsc);
+ * @endcode
+ * @see clixon_xml2cbuf  for one-shot serialization of the same format
+ */
+clixon_xml_cursor *
+clixon_xml_cursor_new(cxobj *xn,
+                      int    level,
+                      int    pretty,
+                      int    skiptop)
+{
+    clixon_xml_cursor *xsc;
+
+    if ((xsc = malloc(sizeof(*xsc))) == NULL){
+        clicon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(xsc, 0, sizeof(*xsc));
+    xsc->xsc_top = xn;
+    xsc->xsc_level0 = level;
+    xsc->xsc_pretty = pretty;
+    xsc->xsc_skiptop = skiptop;
+    if (skiptop)
+        xsc->xsc_next = xml_cursor_sibling(xsc, xn, NULL);
+    else
+        xsc->xsc_next = xn;
+    xsc->xsc_enter = 1;
+    return xsc;
+}
+
+/*! Serialize the next chunk of the tree into cb
+ *
+ * Appends serialization events to cb until it holds at least chunksz bytes or the tree
+ * is exhausted. A chunk may exceed chunksz by one event (eg a long leaf body).
+ * @param[in]     xsc     Serializer cursor
+ * @param[in,out] cb      Cligen buffer to append to
+ * @param[in]     chunksz Stop appending when cb holds at least this many bytes
+ * @param[out]    eofp    Set to 1 when the whole tree has been serialized
+ * @retval        0       OK
+ * @retval        -1      Error
+ */
+int
+clixon_xml_cursor_chunk(clixon_xml_cursor *xsc,
+                        cbuf              *cb,
+                        size_t             chunksz,
+                        int               *eofp)
+{
+    while (xsc->xsc_next != NULL && cbuf_len(cb) < chunksz)
+        if (xml_cursor_step(xsc, cb) < 0)
+            return -1;
+    *eofp = (xsc->xsc_next == NULL);
+    return 0;
+}
+
+/*! Free incremental XML serializer cursor (not the tree it serializes) */
+int
+clixon_xml_cursor_free(clixon_xml_cursor *xsc)
+{
+    free(xsc);
+    return 0;
+}
+
 /*! Print actual xml tree datastructures (not xml), mainly for debugging
  * @param[in,out] cb          Cligen buffer to write to
  * @param[in]     xn          Clicon xml tree
@@ -527,46 +1080,30 @@ xmltree2cbuf(cbuf  *cb,
  * the XML represents a full document or not.
  * @note may be called recursively, some yang-bind (eg rpc) semantic checks may trigger error message
  */
-static int 
-_xml_parse(const char *str, 
-           yang_bind   yb,
-           yang_stmt  *yspec,
-           cxobj      *xt,
-           cxobj     **xerr)
+static int
+_xml_parse1(clixon_xml_yacc *xy,
+            yang_bind        yb,
+            yang_stmt       *yspec,
+            cxobj           *xt,
+            cxobj          **xerr)
 {
     int             retval = -1;
-    clixon_xml_yacc xy = {0,};
     cxobj          *x;
     int             ret;
     int             failed = 0; /* yang assignment */
     int             i;
 
-    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    if (strlen(str) == 0){
-        return 1; /* OK */
-    }
-    if (xt == NULL){
-        clicon_err(OE_XML, errno, "Unexpected NULL XML");
-        return -1;      
-    }
-    if ((xy.xy_parse_string = strdup(str)) == NULL){
-        clicon_err(OE_XML, errno, "strdup");
-        return -1;
-    }
-    xy.xy_xtop = xt;
-    xy.xy_xparent = xt;
-    xy.xy_yspec = yspec;
-    if (clixon_xml_parsel_init(&xy) < 0)
+    if (clixon_xml_parsel_init(xy) < 0)
         goto done;    
-    if (clixon_xml_parseparse(&xy) != 0)  /* yacc returns 1 on error */
+    if (clixon_xml_parseparse(xy) != 0)  /* yacc returns 1 on error */
         goto done;
     /* Purge all top-level body objects */
     x = NULL;
     while ((x = xml_find_type(xt, NULL, "body", CX_BODY)) != NULL)
         xml_purge(x);
     /* Traverse new objects */
-    for (i = 0; i < xy.xy_xlen; i++) {
-        x = xy.xy_xvec[i];
+    for (i = 0; i < xy->xy_xlen; i++) {
+        x = xy->xy_xvec[i];
         /* Verify namespaces after parsing */
         if (xml2ns_recurse(x) < 0)
             goto done;
@@ -578,15 +1115,16 @@ _xml_parse(const char *str,
         case YB_PARENT:
             /* xt:n         Has spec
              * x:   <a> <-- populate from parent
+             * Sorting is fused into the bind traversal, see below
              */
-            if ((ret = xml_bind_yang0(NULL, x, YB_PARENT, NULL, xerr)) < 0)
+            if ((ret = xml_bind_yang0_sort(NULL, x, YB_PARENT, NULL, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
             break;
 
         case YB_MODULE_NEXT:
-            if ((ret = xml_bind_yang(NULL, x, YB_MODULE, yspec, xerr)) < 0)
+            if ((ret = xml_bind_yang_sort(NULL, x, YB_MODULE, yspec, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
@@ -595,7 +1133,7 @@ _xml_parse(const char *str,
             /* xt:<top>     nospec
              * x:   <a> <-- populate from modules
              */
-            if ((ret = xml_bind_yang0(NULL, x, YB_MODULE, yspec, xerr)) < 0)
+            if ((ret = xml_bind_yang0_sort(NULL, x, YB_MODULE, yspec, xerr)) < 0)
                 goto done;
             if (ret == 0)
                 failed++;
@@ -613,24 +1151,71 @@ _xml_parse(const char *str,
     }
     if (failed)
         goto fail;
-    /* Sort the complete tree after parsing. Sorting is not really meaningful if Yang
-       not bound */
-    if (yb != YB_NONE)
+    /* Sorting is not really meaningful if Yang not bound.
+     * For the YB_MODULE/YB_PARENT cases sorting was fused into the yang-bind traversal
+     * above: each node's children were sorted as they were bound, so only the top level
+     * remains here. RPC binding has its own structure and keeps the separate recursion */
+    if (yb == YB_RPC){
         if (xml_sort_recurse(xt) < 0)
             goto done;
+    }
+    else if (yb != YB_NONE){
+        if (xml_sort_node(xt) < 0)
+            goto done;
+    }
     retval = 1;
   done:
-    clixon_xml_parsel_exit(&xy);
-    if (xy.xy_parse_string != NULL)
-        free(xy.xy_parse_string);
-    if (xy.xy_xvec)
-        free(xy.xy_xvec);
+    clixon_xml_parsel_exit(xy);
+    if (xy->xy_xvec)
+        free(xy->xy_xvec);
     return retval; 
  fail: /* invalid */
     retval = 0;
     goto done;
 }
 
+/*! Common internal xml parsing function, in-memory string variant
+ *
+ * @param[in]     str   Pointer to string containing XML definition. 
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification (only if bind is TOP or CONFIG)
+ * @param[in,out] xt    Top of XML parse tree. Assume created. Holds new tree.
+ * @param[out]    xerr  Reason for failure (yang assignment not made)
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval       -1     Error with clicon_err called. Includes parse error
+ * @see _xml_parse1
+ */
+static int 
+_xml_parse(const char *str, 
+           yang_bind   yb,
+           yang_stmt  *yspec,
+           cxobj      *xt,
+           cxobj     **xerr)
+{
+    int             retval = -1;
+    clixon_xml_yacc xy = {0,};
+
+    clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
+    if (strlen(str) == 0){
+        return 1; /* OK */
+    }
+    if (xt == NULL){
+        clicon_err(OE_XML, errno, "Unexpected NULL XML");
+        return -1;      
+    }
+    if ((xy.xy_parse_string = strdup(str)) == NULL){
+        clicon_err(OE_XML, errno, "strdup");
+        return -1;
+    }
+    xy.xy_xtop = xt;
+    xy.xy_xparent = xt;
+    xy.xy_yspec = yspec;
+    retval = _xml_parse1(&xy, yb, yspec, xt, xerr);
+    free(xy.xy_parse_string);
+    return retval;
+}
+
 /*! Read an XML definition from file and parse it into a parse-tree, advanced API
  *
  * @param[in]     fd    A file descriptor containing the XML file (as ASCII characters)
@@ -664,15 +1249,47 @@ clixon_xml_parse_file(FILE      *fp,
                       cxobj    **xt,
                       cxobj    **xerr)
 {
-    int   retval = -1;
-    int   ret;
-    int   len = 0;
-    char  ch;
-    char *xmlbuf = NULL;
-    char *ptr;
-    int   xmlbuflen = BUFLEN; /* start size */
-    int   oldxmlbuflen;
-    int   failed = 0;
+    return clixon_xml_parse_file_cb(fp, yb, yspec, xt, NULL, 0, NULL, xerr);
+}
+
+/*! Read and parse XML from file in a streaming fashion, with optional subtree callback
+ *
+ * The lexer reads the stream in fixed-size chunks and the tree is built
+ * incrementally: unlike buffering the file as a string, the document text is
+ * never held in memory as a whole, which caps peak memory when loading large
+ * datastore files.
+ * If cb is given it is invoked for each element at depth `depth` below the top
+ * symbol (1 = top-level elements) as soon as that element is completely parsed,
+ * before the rest of the document has been read. The callback may inspect,
+ * bind or prune the subtree.
+ * @param[in]     fp    A file descriptor containing the XML file (as ASCII characters)
+ * @param[in]     yb    How to bind yang to XML top-level when parsing
+ * @param[in]     yspec Yang specification (only if bind is TOP or CONFIG)
+ * @param[in,out] xt    Pointer to XML parse tree. If empty, create.
+ * @param[in]     cb    Subtree callback, or NULL
+ * @param[in]     depth Depth of completed elements cb is called for, 1 is top-level
+ * @param[in]     arg   Argument to cb
+ * @param[out]    xerr  Pointer to XML error tree, if retval is 0
+ * @retval        1     Parse OK and all yang assignment made
+ * @retval        0     Parse OK but yang assigment not made (or only partial) and xerr set
+ * @retval       -1     Error with clicon_err called. Includes parse error
+ * @note A callback returning -1 aborts the parse with retval -1: the callback
+ *       is expected to have called clicon_err (or set xerr and flagged this in arg)
+ * @see clixon_xml_parse_file  simple API without callback
+ */
+int
+clixon_xml_parse_file_cb(FILE                *fp,
+                         yang_bind            yb,
+                         yang_stmt           *yspec,
+                         cxobj              **xt,
+                         clixon_xml_parse_cb *cb,
+                         int                  depth,
+                         void                *arg,
+                         cxobj              **xerr)
+{
+    int             retval = -1;
+    clixon_xml_yacc xy = {0,};
+    int             ch;
 
     if (xt==NULL || fp == NULL){
         clicon_err(OE_XML, EINVAL, "arg is NULL");
@@ -682,49 +1299,28 @@ clixon_xml_parse_file(FILE      *fp,
         clicon_err(OE_XML, EINVAL, "yspec is required if yb == YB_MODULE");
         return -1;
     }
-    if ((xmlbuf = malloc(xmlbuflen)) == NULL){
-        clicon_err(OE_XML, errno, "malloc");
+    if (*xt == NULL)
+        if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+            goto done;
+    /* Empty input is accepted here but not by the grammar, see _xml_parse */
+    if ((ch = fgetc(fp)) == EOF){
+        retval = 1;
         goto done;
     }
-    memset(xmlbuf, 0, xmlbuflen);
-    ptr = xmlbuf;
-    while (1){
-        if ((ret = fread(&ch, 1, 1, fp)) < 0){
-            clicon_err(OE_XML, errno, "read");
-            break;
-        }
-        if (ret != 0){
-            xmlbuf[len++] = ch;
-        }
-        if (ret == 0) {
-            if (*xt == NULL)
-                if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
-                    goto done;
-            if ((ret = _xml_parse(ptr, yb, yspec, *xt, xerr)) < 0)
-                goto done;
-            if (ret == 0)
-                failed++;
-            break;
-        }
-        if (len >= xmlbuflen-1){ /* Space: one for the null character */
-            oldxmlbuflen = xmlbuflen;
-            xmlbuflen *= 2;
-            if ((xmlbuf = realloc(xmlbuf, xmlbuflen)) == NULL){
-                clicon_err(OE_XML, errno, "realloc");
-                goto done;
-            }
-            memset(xmlbuf+oldxmlbuflen, 0, xmlbuflen-oldxmlbuflen);
-            ptr = xmlbuf;
-        }
-    } /* while */
-    retval = (failed==0) ? 1 : 0;
+    ungetc(ch, fp);
+    xy.xy_parse_file = fp;
+    xy.xy_xtop = *xt;
+    xy.xy_xparent = *xt;
+    xy.xy_yspec = yspec;
+    xy.xy_cb = cb;
+    xy.xy_cb_depth = depth;
+    xy.xy_cb_arg = arg;
+    retval = _xml_parse1(&xy, yb, yspec, *xt, xerr);
  done:
     if (retval < 0 && *xt){
-        free(*xt);
+        xml_free(*xt);
         *xt = NULL;
     }
-    if (xmlbuf)
-        free(xmlbuf);
     return retval;
 }
 
@@ -294,10 +294,15 @@ cvec2xml_1(cvec   *cvv,
  * (*) "comparing" a&b here is made by xml_cmp() which judges equality from a structural
  *     perspective, ie both have the same yang spec, if they are lists, they have the
  *     the same keys. NOT that the values are equal!
+ * The walk is made directly over the two (sorted) child vectors. Since only list and
+ * leaf-list entries can share a yang spec between siblings, a pair with the same
+ * non-list spec is structurally equal by construction and xml_cmp is skipped: on the
+ * commit path, where running and candidate are near-identical, this removes almost
+ * all comparison calls.
  * @see xml_diff  API function, this one is internal and recursive
  */
 static int
-xml_diff1(cxobj     *x0, 
+xml_diff1(cxobj     *x0,
           cxobj     *x1,
           cxobj   ***x0vec,
           int       *x0veclen,
@@ -307,58 +312,72 @@ xml_diff1(cxobj     *x0,
           cxobj   ***changed_x1,
           int       *changedlen)
 {
-    int        retval = -1;
-    cxobj     *x0c = NULL; /* x0 child */
-    cxobj     *x1c = NULL; /* x1 child */
-    yang_stmt *yc0;
-    yang_stmt *yc1;
-    char      *b1;
-    char      *b2;
-    int        eq;
-
-    /* Traverse x0 and x1 in lock-step */
-    x0c = x1c = NULL;    
-    x0c = xml_child_each(x0, x0c, CX_ELMNT);
-    x1c = xml_child_each(x1, x1c, CX_ELMNT);
+    int           retval = -1;
+    cxobj       **v0 = xml_childvec_get(x0);
+    cxobj       **v1 = xml_childvec_get(x1);
+    int           n0 = xml_child_nr(x0);
+    int           n1 = xml_child_nr(x1);
+    int           i0 = 0;
+    int           i1 = 0;
+    cxobj        *x0c; /* x0 child */
+    cxobj        *x1c; /* x1 child */
+    yang_stmt    *yc0;
+    yang_stmt    *yc1;
+    enum rfc_6020 kw;
+    char         *b1;
+    char         *b2;
+    int           eq;
+
+    /* Traverse the two sorted child vectors in lock-step */
     for (;;){
+        while (i0 < n0 && xml_type(v0[i0]) != CX_ELMNT)
+            i0++;
+        while (i1 < n1 && xml_type(v1[i1]) != CX_ELMNT)
+            i1++;
+        x0c = i0 < n0 ? v0[i0] : NULL;
+        x1c = i1 < n1 ? v1[i1] : NULL;
         if (x0c == NULL && x1c == NULL)
             goto ok;
         else if (x0c == NULL){
-            if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+            if (cxvec_append(x1c, x1vec, x1veclen) < 0)
                 goto done;
-            x1c = xml_child_each(x1, x1c, CX_ELMNT);
+            i1++;
             continue;
         }
         else if (x1c == NULL){
-            if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
+            if (cxvec_append(x0c, x0vec, x0veclen) < 0)
                 goto done;
-            x0c = xml_child_each(x0, x0c, CX_ELMNT);
+            i0++;
             continue;
         }
-        /* Both x0c and x1c exists, check if they are yang-equal. */
-        eq = xml_cmp(x0c, x1c, 0, 0, NULL);
+        /* Both x0c and x1c exists, check if they are yang-equal.
+         * xml-spec NULL could happen with anydata children for example,
+         * if so, continue compare children but without yang
+         */
+        yc0 = xml_spec(x0c);
+        yc1 = xml_spec(x1c);
+        if (yc0 != NULL && yc0 == yc1 &&
+            (kw = yang_keyword_get(yc0)) != Y_LIST && kw != Y_LEAF_LIST)
+            eq = 0; /* Same non-list spec: structurally equal, skip xml_cmp */
+        else
+            eq = xml_cmp(x0c, x1c, 0, 0, NULL);
         if (eq < 0){
-            if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
+            if (cxvec_append(x0c, x0vec, x0veclen) < 0)
                 goto done;
-            x0c = xml_child_each(x0, x0c, CX_ELMNT);
+            i0++;
             continue;
         }
         else if (eq > 0){
-            if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+            if (cxvec_append(x1c, x1vec, x1veclen) < 0)
                 goto done;
-            x1c = xml_child_each(x1, x1c, CX_ELMNT);
+            i1++;
             continue;
         }
         else{ /* equal */
-            /* xml-spec NULL could happen with anydata children for example,
-             * if so, continute compare children but without yang
-             */
-            yc0 = xml_spec(x0c);
-            yc1 = xml_spec(x1c);
             if (yc0 && yc1 && yc0 != yc1){ /* choice */
-                if (cxvec_append(x0c, x0vec, x0veclen) < 0) 
+                if (cxvec_append(x0c, x0vec, x0veclen) < 0)
                     goto done;
-                if (cxvec_append(x1c, x1vec, x1veclen) < 0) 
+                if (cxvec_append(x1c, x1vec, x1veclen) < 0)
                     goto done;
             }
             else
@@ -369,23 +388,23 @@ xml_diff1(cxobj     *x0,
                     if (b1 == NULL && b2 == NULL)
                         ;
                     else if (b1 == NULL || b2 == NULL
-                             || strcmp(b1, b2) != 0 
+                             || strcmp(b1, b2) != 0
                              ){
-                        if (cxvec_append(x0c, changed_x0, changedlen) < 0) 
+                        if (cxvec_append(x0c, changed_x0, changedlen) < 0)
                             goto done;
                         (*changedlen)--; /* append two vectors */
-                        if (cxvec_append(x1c, changed_x1, changedlen) < 0) 
+                        if (cxvec_append(x1c, changed_x1, changedlen) < 0)
                             goto done;
                     }
                 }
-                else if (xml_diff1(x0c, x1c,   
-                                   x0vec, x0veclen, 
-                                   x1vec, x1veclen, 
+                else if (xml_diff1(x0c, x1c,
+                                   x0vec, x0veclen,
+                                   x1vec, x1veclen,
                                    changed_x0, changed_x1, changedlen)< 0)
                     goto done;
         }
-        x0c = xml_child_each(x0, x0c, CX_ELMNT);
-        x1c = xml_child_each(x1, x1c, CX_ELMNT);
+        i0++;
+        i1++;
     }
  ok:
     retval = 0;
@@ -1371,6 +1390,87 @@ xml_merge(cxobj     *x0,
     goto done;
 }
 
+/*! Apply a config-diff notification to a local mirror of running
+ *
+ * Applies the edits of a clixon-lib config-diff notification (pushed on the
+ * CONFIGDIFF stream after each commit) in order: 'delete' purges the node at
+ * path, 'merge' merges the value subtree into the node at path.
+ * @param[in]  xmirror Yang-bound mirror of running (datastore top symbol)
+ * @param[in]  xdiff   The config-diff notification content node
+ * @param[in]  yspec   Yang spec
+ * @param[out] reason  If retval=0, malloced reason, client should resync with
+ *                     a full get-config. Needs to be freed by caller
+ * @retval     1       OK, mirror patched
+ * @retval     0       Mirror out of sync or malformed diff, reason is set
+ * @retval    -1       Error
+ * @see xml_merge
+ */
+int
+clixon_config_diff_apply(cxobj     *xmirror,
+                         cxobj     *xdiff,
+                         yang_stmt *yspec,
+                         char     **reason)
+{
+    int    retval = -1;
+    cxobj *xe = NULL;
+    cxobj *xt;
+    cxobj *xv;
+    char  *op;
+    char  *path;
+    int    ret;
+
+    while ((xe = xml_child_each(xdiff, xe, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xe), "edit") != 0)
+            continue;
+        if ((op = xml_find_body(xe, "op")) == NULL ||
+            (path = xml_find_body(xe, "path")) == NULL){
+            if (reason && (*reason = strdup("edit lacks op or path")) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            goto fail;
+        }
+        if (strcmp(op, "delete") == 0){
+            /* Already gone is idempotent: may have been removed with an ancestor */
+            if ((xt = xpath_first(xmirror, NULL, "%s", path)) != NULL &&
+                xml_purge(xt) < 0)
+                goto done;
+            continue;
+        }
+        /* merge */
+        if ((xv = xml_find_type(xe, NULL, "value", CX_ELMNT)) == NULL){
+            if (reason && (*reason = strdup("merge edit lacks value")) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            goto fail;
+        }
+        if (strcmp(path, "/") == 0)
+            xt = xmirror;
+        else if ((xt = xpath_first(xmirror, NULL, "%s", path)) == NULL){
+            if (reason && (*reason = strdup("edit path not found in mirror")) == NULL){
+                clicon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+            goto fail;
+        }
+        if (xt == xmirror)
+            ret = xml_merge(xt, xv, yspec, reason);
+        else
+            ret = xml_merge1(xt, xml_spec(xt), xml_parent(xt), xv, reason);
+        if (ret < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Given a YANG (enum) type node and a value, return the string containing corresponding int str
  *
  * @param[in]  ytype   YANG type noden
@@ -1602,24 +1702,27 @@ yang_check_when_xpath(cxobj        *xn,
                       int          *nrp,
                       char        **xpathp)
 {
-    int        retval = 1;
-    yang_stmt *yc;
-    char      *xpath = NULL;
-    cxobj     *x = NULL;
-    int        nr = 0;
-    cvec      *nsc = NULL;
-    int        xmalloc = 0;   /* ugly help variable to clean temporary object */
-    int        nscmalloc = 0; /* ugly help variable to remove */
+    int                retval = 1;
+    yang_stmt         *yc;
+    char              *xpath = NULL;
+    struct xpath_tree *xpt = NULL; /* Pre-compiled xpath, see ys_precompile_xpath */
+    cxobj             *x = NULL;
+    int                nr = 0;
+    cvec              *nsc = NULL;
+    int                xmalloc = 0;   /* ugly help variable to clean temporary object */
+    int                nscmalloc = 0; /* ugly help variable to remove */
 
     /* First variant */
     if ((xpath = yang_when_xpath_get(yn)) != NULL){
         x = xp;
         nsc = yang_when_nsc_get(yn);
+        xpt = yang_xpath_cache_get(yn);
         *hit = 1;
     }
     /* Second variant */
     else if ((yc = yang_find(yn, Y_WHEN, NULL)) != NULL){
         xpath = yang_argument_get(yc); /* "when" has xpath argument */
+        xpt = yang_xpath_cache_get(yc);
         /* Create dummy */
         if (xn == NULL){
             if ((x = xml_new(yang_argument_get(yn), xp, CX_ELMNT)) == NULL)
@@ -1637,7 +1740,11 @@ yang_check_when_xpath(cxobj        *xn,
     else
         *hit = 0;
     if (x && xpath){
-        if ((nr = xpath_vec_bool(x, nsc, "%s", xpath)) < 0)
+        if (xpt != NULL)
+            nr = xpath_vec_bool_tree(x, nsc, xpt);
+        else
+            nr = xpath_vec_bool(x, nsc, "%s", xpath);
+        if (nr < 0)
             goto done;
     }
     if (nrp)
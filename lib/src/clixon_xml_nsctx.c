@@ -320,18 +320,21 @@ xml_nsctx_yang(yang_stmt *yn,
 {
     int        retval = -1;
     cvec      *nc = NULL;
+    cvec      *nsi = NULL;  /* import prefix/namespace map, cached on module */
+    cvec      *nsinew = NULL;
     yang_stmt *yspec;
     yang_stmt *ymod;  /* yang main module/submodule node */
     yang_stmt *yp;    /* yang prefix node */
     yang_stmt *ym;    /* yang imported module */
     yang_stmt *yns;   /* yang namespace */
     yang_stmt *y;
+    cg_var    *cv;
     char      *name;
     char      *namespace;
     char      *prefix;
     char      *mynamespace;
     char      *myprefix;
-    
+
     if (yang_keyword_get(yn) == Y_SPEC){
         clicon_err(OE_YANG, EINVAL, "yang spec node is invalid argument");
         goto done;
@@ -348,7 +351,10 @@ xml_nsctx_yang(yang_stmt *yn,
         clicon_err(OE_YANG, ENOENT, "My yang namespace not found");
         goto done;
     }
-    /* Add my prefix and default namespace (from real module) */
+    /* Add my prefix and default namespace (from real module)
+     * Note these come from ys_mymodule (augment origin) and may differ between nodes of the
+     * same module, so they cannot be part of the per-module cached map below
+     */
     if (xml_nsctx_add(nc, NULL, mynamespace) < 0)
         goto done;
     if (xml_nsctx_add(nc, myprefix, mynamespace) < 0)
@@ -360,55 +366,67 @@ xml_nsctx_yang(yang_stmt *yn,
     }
     yspec = yang_parent_get(ymod); /* Assume yspec exists */
 
-    /* Iterate over module and register all import prefixes
+    /* Get import prefix/namespace map of the module. The import set is fixed after parsing,
+     * so it is computed once per module and cached, instead of re-resolving every import
+     * against yspec (linear module scans) on each call.
      */
-    y = NULL;
-    while ((y = yn_each(ymod, y)) != NULL) {
-        if (yang_keyword_get(y) == Y_IMPORT){
-            if ((name = yang_argument_get(y)) == NULL)
-                continue; /* Just skip - shouldnt happen) */
-            if ((yp = yang_find(y, Y_PREFIX, NULL)) == NULL)
-                continue; 
-            if ((prefix = yang_argument_get(yp)) == NULL)
-                continue;
-            if ((ym = yang_find(yspec, Y_MODULE, name)) == NULL)
-                continue;
-            if ((yns = yang_find(ym, Y_NAMESPACE, NULL)) == NULL)
-                continue;
-            if ((namespace = yang_argument_get(yns)) == NULL)
-                continue;
-            if (xml_nsctx_add(nc, prefix, namespace) < 0)
-                goto done;
+    if ((nsi = yang_nscache_get(ymod)) == NULL){
+        if ((nsinew = cvec_new(0)) == NULL){
+            clicon_err(OE_XML, errno, "cvec_new");
+            goto done;
         }
+        /* Iterate over module and register all import prefixes
+         */
+        y = NULL;
+        while ((y = yn_each(ymod, y)) != NULL) {
+            if (yang_keyword_get(y) == Y_IMPORT){
+                if ((name = yang_argument_get(y)) == NULL)
+                    continue; /* Just skip - shouldnt happen) */
+                if ((yp = yang_find(y, Y_PREFIX, NULL)) == NULL)
+                    continue;
+                if ((prefix = yang_argument_get(yp)) == NULL)
+                    continue;
+                if ((ym = yang_find(yspec, Y_MODULE, name)) == NULL)
+                    continue;
+                if ((yns = yang_find(ym, Y_NAMESPACE, NULL)) == NULL)
+                    continue;
+                if ((namespace = yang_argument_get(yns)) == NULL)
+                    continue;
+                if (xml_nsctx_add(nsinew, prefix, namespace) < 0)
+                    goto done;
+            }
+        }
+        yang_nscache_set(ymod, nsinew);
+        nsi = nsinew;
+        nsinew = NULL;
     }
+    cv = NULL;
+    while ((cv = cvec_each(nsi, cv)) != NULL)
+        if (xml_nsctx_add(nc, cv_name_get(cv), cv_string_get(cv)) < 0)
+            goto done;
     *ncp = nc;
+    nc = NULL;
     retval = 0;
  done:
+    if (nc)
+        cvec_free(nc);
+    if (nsinew)
+        cvec_free(nsinew);
     return retval;
 }
 
-/*! Create and initialize XML namespace context from Yang spec
+/*! Build canonical XML namespace context from Yang spec
  *
- * That is, create a "canonical" XML namespace mapping from all loaded yang 
- * modules which are children of the yang specification.
- * Also add netconf base namespace: nc , urn:ietf:params:xml:ns:netconf:base:1.0
- * Fully explore all prefix:namespace pairs of all yang modules
+ * Fully explore all prefix:namespace pairs of all yang modules,
+ * also add netconf base namespace: nc , urn:ietf:params:xml:ns:netconf:base:1.0
  * @param[in]  yspec  Yang spec
- * @param[out] ncp    XML namespace context
+ * @param[out] ncp    XML namespace context, malloced
  * @retval     0      OK
  * @retval    -1      Error
- * @code
- *  cvec      *nsc = NULL;
- *  yang_stmt *yspec = clicon_dbspec_yang(h);
- *  if (xml_nsctx_yangspec(yspec, &nsc) < 0)
- *      goto done;
- *  ...
- *  cvec_free(nsc);
- * @endcode
  */
-int
-xml_nsctx_yangspec(yang_stmt *yspec,
-                   cvec     **ncp)
+static int
+nsctx_yangspec_build(yang_stmt *yspec,
+                     cvec     **ncp)
 {
     int        retval = -1;
     cvec      *nc = NULL;
@@ -437,6 +455,72 @@ xml_nsctx_yangspec(yang_stmt *yspec,
     if (xml_nsctx_add(nc,  NETCONF_BASE_PREFIX, NETCONF_BASE_NAMESPACE) < 0)
         goto done;
     *ncp = nc;
+    nc = NULL;
+    retval = 0;
+ done:
+    if (nc)
+        cvec_free(nc);
+    return retval;
+}
+
+/*! Return the shared canonical namespace context of a yang spec, borrowed
+ *
+ * The canonical prefix to namespace mapping is fixed once the modules are
+ * loaded; build it once and cache it on the spec instead of re-scanning all
+ * modules on each request. The returned context is owned by the spec: do not
+ * free or modify it. It is valid until the spec's module set mutates or the
+ * spec is freed, see yang_findcache_clear() and ys_free1().
+ * @param[in]  yspec  Yang spec
+ * @retval     nsc    Canonical namespace context, borrowed
+ * @retval     NULL   Error
+ * @see xml_nsctx_yangspec  which returns a private copy the caller may modify
+ */
+cvec *
+xml_nsctx_yangspec_canonical(yang_stmt *yspec)
+{
+    cvec *nc;
+
+    if ((nc = yang_nscache_get(yspec)) != NULL)
+        return nc;
+    if (nsctx_yangspec_build(yspec, &nc) < 0)
+        return NULL;
+    yang_nscache_set(yspec, nc);
+    return nc;
+}
+
+/*! Create and initialize XML namespace context from Yang spec
+ *
+ * That is, create a "canonical" XML namespace mapping from all loaded yang
+ * modules which are children of the yang specification.
+ * Also add netconf base namespace: nc , urn:ietf:params:xml:ns:netconf:base:1.0
+ * @param[in]  yspec  Yang spec
+ * @param[out] ncp    XML namespace context
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *  cvec      *nsc = NULL;
+ *  yang_stmt *yspec = clicon_dbspec_yang(h);
+ *  if (xml_nsctx_yangspec(yspec, &nsc) < 0)
+ *      goto done;
+ *  ...
+ *  cvec_free(nsc);
+ * @endcode
+ * @see xml_nsctx_yangspec_canonical  to borrow the shared table without a copy
+ */
+int
+xml_nsctx_yangspec(yang_stmt *yspec,
+                   cvec     **ncp)
+{
+    int   retval = -1;
+    cvec *nc;
+
+    if ((nc = xml_nsctx_yangspec_canonical(yspec)) == NULL)
+        goto done;
+    /* Flat copy of the cached table, callers own and may modify it */
+    if ((*ncp = cvec_dup(nc)) == NULL){
+        clicon_err(OE_XML, errno, "cvec_dup");
+        goto done;
+    }
     retval = 0;
  done:
     return retval;
@@ -562,6 +646,108 @@ xml2ns_recurse(cxobj *xt)
     return retval;
 }
 
+/*! Populate namespace caches of one level, sharing the parent context where possible
+ * @see xml_nsctx_populate
+ */
+static int
+xml_nsctx_populate1(cxobj *xn)
+{
+    int    retval = -1;
+    cxobj *xc;
+    cxobj *xa;
+    char  *pf;  /* prefix */
+    char  *nm;  /* name */
+    cvec  *nsc0;
+    cvec  *nsc = NULL;
+    int    decl;
+
+    xc = NULL;
+    while ((xc = xml_child_each(xn, xc, CX_ELMNT)) != NULL){
+        /* Does xc declare any namespaces of its own? */
+        decl = 0;
+        xa = NULL;
+        while ((xa = xml_child_each(xc, xa, CX_ATTR)) != NULL){
+            pf = xml_prefix(xa);
+            nm = xml_name(xa);
+            if ((pf == NULL && strcmp(nm, "xmlns") == 0) ||
+                (pf != NULL && strcmp(pf, "xmlns") == 0)){
+                decl++;
+                break;
+            }
+        }
+        if (decl == 0){ /* Same context as parent: share by reference */
+            if (nscache_share(xc, xn) < 0)
+                goto done;
+        }
+        else{ /* Own declarations: inherit parent context, then overwrite */
+            if ((nsc0 = nscache_get_all(xn)) != NULL){
+                if ((nsc = cvec_dup(nsc0)) == NULL){
+                    clicon_err(OE_UNIX, errno, "cvec_dup");
+                    goto done;
+                }
+            }
+            else if ((nsc = cvec_new(0)) == NULL){
+                clicon_err(OE_XML, errno, "cvec_new");
+                goto done;
+            }
+            xa = NULL;
+            while ((xa = xml_child_each(xc, xa, CX_ATTR)) != NULL){
+                pf = xml_prefix(xa);
+                nm = xml_name(xa);
+                if (pf == NULL && strcmp(nm, "xmlns") == 0){
+                    if (xml_nsctx_add(nsc, NULL, xml_value(xa)) < 0)
+                        goto done;
+                }
+                else if (pf != NULL && strcmp(pf, "xmlns") == 0){
+                    if (xml_nsctx_add(nsc, nm, xml_value(xa)) < 0)
+                        goto done;
+                }
+            }
+            if (nscache_replace(xc, nsc) < 0)
+                goto done;
+            nsc = NULL; /* consumed */
+        }
+        if (xml_nsctx_populate1(xc) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
+/*! Eagerly populate the namespace caches of a whole XML tree in one downward pass
+ *
+ * Each node inherits its parent context by reference (refcounted, see
+ * nscache_share) and only nodes with xmlns declarations of their own get a
+ * private copy, so later xml2ns()/xml_cmp() lookups need not re-walk ancestors.
+ * Call after parse (or other bulk tree construction), before sort/merge.
+ * @param[in]  xt     XML tree
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml2ns         Lazy per-node variant
+ */
+int
+xml_nsctx_populate(cxobj *xt)
+{
+    int   retval = -1;
+    cvec *nsc = NULL;
+
+    if (xml_nsctx_node(xt, &nsc) < 0)
+        goto done;
+    if (nscache_replace(xt, nsc) < 0)
+        goto done;
+    nsc = NULL; /* consumed */
+    if (xml_nsctx_populate1(xt) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (nsc)
+        cvec_free(nsc);
+    return retval;
+}
+
 /*! Add a namespace attribute to an XML node, either default or specific prefix
  * @param[in]  x          XML tree
  * @param[in]  prefix     prefix/ns localname. If NULL then set default xmlns
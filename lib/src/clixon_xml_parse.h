@@ -46,6 +46,9 @@
 /*! XML parser yacc handler struct */
 struct clixon_xml_parse_yacc {
     char       *xy_parse_string; /* original (copy of) parse string */
+    FILE       *xy_parse_file;   /* Alternative to xy_parse_string: stream the lexer reads
+                                    fixed-size chunks from, so the document is never held
+                                    in memory as a whole (see clixon_xml_parse_file_cb) */
     int         xy_linenum;      /* Number of \n in parsed buffer */
     void       *xy_lexbuf;       /* internal parse buffer from lex */
     cxobj      *xy_xtop;         /* cxobj top element (fixed) */
@@ -55,6 +58,10 @@ struct clixon_xml_parse_yacc {
     int         xy_lex_state;    /* lex return state */
     cxobj     **xy_xvec;         /* Vector of created top-level nodes (to know which are created) */
     int         xy_xlen;         /* Length of xy_xvec */
+    int       (*xy_cb)(cxobj *x, void *arg); /* If set, called when an element at depth
+                                    xy_cb_depth (from xy_xtop) is completely parsed */
+    int         xy_cb_depth;     /* Depth of elements xy_cb is called for, 1 is top-level */
+    void       *xy_cb_arg;       /* Argument to xy_cb */
 };
 typedef struct clixon_xml_parse_yacc clixon_xml_yacc;
 
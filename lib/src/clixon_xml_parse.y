@@ -145,19 +145,18 @@ xml_parse_whitespace(clixon_xml_yacc *xy,
     cxobj *xn = xy->xy_xelement;
     cxobj *xp = xy->xy_xparent;
     int    retval = -1;
-    int    i;
 
     xy->xy_xelement = NULL; /* init */
-    /* If there is an element already, only add one whitespace child 
+    /* If there is an element already, only add one whitespace child
      * otherwise, keep all whitespace. See code in xml_parse_bslash
-     * Note that this xml element is not aware of YANG yet. 
+     * Note that this xml element is not aware of YANG yet.
      * For example, if xp is LEAF then a body child is OK, but if xp is CONTAINER
      * then the whitespace body is pretty-prints and should be stripped (later)
+     * The typed child counter makes this O(1) per whitespace token instead of
+     * a scan over all children so far (quadratic in pretty-printed input)
      */
-    for (i=0; i<xml_child_nr(xp); i++){
-        if (xml_type(xml_child_i(xp, i)) == CX_ELMNT)
-            goto ok; /* Skip if already element */
-    }
+    if (xml_child_nr_type(xp, CX_ELMNT) > 0)
+        goto ok; /* Skip if already element */
     if (xn == NULL){
         if ((xn = xml_new("body", xp, CX_BODY)) == NULL)
             goto done; 
@@ -274,6 +273,30 @@ xml_parse_endslash_post(clixon_xml_yacc *xy)
     return 0;
 }
 
+/*! Invoke user subtree callback if a completely parsed element is at the registered depth
+ *
+ * Used by the streaming file parser to let a caller process subtrees as they
+ * complete instead of waiting for the whole document.
+ * @param[in] xy  XML parser yacc handler struct
+ * @param[in] x   Completely parsed element
+ * @see clixon_xml_parse_file_cb
+ */
+static int
+xml_parse_subtree_done(clixon_xml_yacc *xy,
+                       cxobj           *x)
+{
+    int    depth = 0;
+    cxobj *xp;
+
+    if (xy->xy_cb == NULL || x == NULL)
+        return 0;
+    for (xp = x; xp && xp != xy->xy_xtop; xp = xml_parent(xp))
+        depth++;
+    if (depth != xy->xy_cb_depth)
+        return 0;
+    return xy->xy_cb(x, xy->xy_cb_arg);
+}
+
 /*! A content terminated by <name>...</name> or <prefix:name>...</prefix:name> is ready
  *
  * Any whitespace between the subelements to a non-leaf is
@@ -320,6 +343,8 @@ xml_parse_bslash(clixon_xml_yacc *xy,
         if (xml_rm_children(x, CX_BODY) < 0) /* remove all bodies */
             goto done;
     }
+    if (xml_parse_subtree_done(xy, x) < 0)
+        goto done;
     retval = 0;
   done:
     if (prefix)
@@ -350,7 +375,14 @@ xml_parse_attr(clixon_xml_yacc *xy,
             goto done;
 
     }
-    if (xml_value_set(xa, attval) < 0)
+    /* xmlns declarations repeat the same few URIs over the whole document:
+     * share them as interned strings instead of a buffer per attribute */
+    if (strcmp(name, "xmlns") == 0 ||
+        (prefix && strcmp(prefix, "xmlns") == 0)){
+        if (xml_value_intern(xa, attval) < 0)
+            goto done;
+    }
+    else if (xml_value_set(xa, attval) < 0)
         goto done;
     retval = 0;
   done:
@@ -426,7 +458,8 @@ qname       : NAME           { if (xml_parse_prefixed_name(_XY, NULL, $1) < 0) Y
                                 _PARSE_DEBUG("qname -> NAME : NAME");}
             ;
 
-element1    :  ESLASH         {_XY->xy_xelement = NULL; 
+element1    :  ESLASH         {if (xml_parse_subtree_done(_XY, _XY->xy_xelement) < 0) YYABORT;
+                               _XY->xy_xelement = NULL; 
                                _PARSE_DEBUG("element1 -> />");} 
             | '>'             { xml_parse_endslash_pre(_XY); }
               elist           { xml_parse_endslash_mid(_XY); }
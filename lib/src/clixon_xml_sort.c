@@ -422,27 +422,56 @@ xml_sort(cxobj *x)
     return 0;
 }
 
-/*! Recursively sort a tree 
- * Alt to use xml_apply
+/*! Sort children of one XML node if needed, the non-recursive step of xml_sort_recurse
+ *
+ * Verifies order first so already sorted children are not qsorted again, and clears
+ * the cv cache populated by xml_cmp during the sort.
+ * @param[in] xn    XML node, its children are sorted
+ * @retval    1     Node is not sortable (eg state data), subtree should be skipped
+ * @retval    0     OK, children sorted (or already in order)
+ * @retval   -1     Error
+ * @see xml_sort_recurse
+ * @see xml_bind_yang_sort  where this is fused into the yang-bind traversal
  */
 int
-xml_sort_recurse(cxobj *xn)
+xml_sort_node(cxobj *xn)
 {
-    int    retval = -1;
-    cxobj *x;
-    int    ret;
-    
+    int retval = -1;
+    int ret;
+
     ret = xml_sort_verify(xn, NULL);
     if (ret == 1) /* This node is not sortable */
-        goto ok;
+        goto skip;
     if (ret == -1){ /* not sorted */
         if ((ret = xml_sort(xn)) < 0)
             goto done;
         if (ret == 1) /* This node is not sortable */
-            goto ok;
+            goto skip;
     }
     if (xml_cv_cache_clear(xn) < 0)
         goto done;
+    retval = 0;
+ done:
+    return retval;
+ skip:
+    retval = 1;
+    goto done;
+}
+
+/*! Recursively sort a tree
+ * Alt to use xml_apply
+ */
+int
+xml_sort_recurse(cxobj *xn)
+{
+    int    retval = -1;
+    cxobj *x;
+    int    ret;
+
+    if ((ret = xml_sort_node(xn)) < 0)
+        goto done;
+    if (ret == 1) /* This node is not sortable */
+        goto ok;
     x = NULL;
     while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
         if (xml_sort_recurse(x) < 0)
@@ -1111,6 +1140,79 @@ xml_insert(cxobj           *xp,
     return retval;
 }
 
+/*! Insert a batch of children into xp:s sorted child list in one merge pass
+ *
+ * Equivalent to calling xml_insert(xp, xvec[i], INS_LAST, NULL, NULL) for each
+ * entry, but instead of one binary search and memmove per entry, the batch is
+ * sorted once and then merged linearly with the existing sorted child vector,
+ * turning the O(n*k) memmove traffic of large list pushes into O(n+k).
+ * @param[in] xp    Parent xml node
+ * @param[in] xvec  Batch of child nodes to insert, without parents, YANG bound
+ * @param[in] xlen  Length of xvec
+ * @retval    0     OK
+ * @retval   -1     Error
+ * @note Only for ordered-by system children: the caller must not use this for
+ *       ordered-by user (or, without STATE_ORDERED_BY_SYSTEM, state) nodes,
+ *       where relative insert order is significant
+ * @see xml_insert for the per-entry variant
+ */
+int
+xml_insert_bulk(cxobj  *xp,
+                cxobj **xvec,
+                int     xlen)
+{
+    int     retval = -1;
+    cxobj **vec;
+    cxobj **tmp = NULL;
+    int     oldn;
+    int     i;
+    int     a;
+    int     b;
+
+    if (xlen == 0){
+        retval = 0;
+        goto done;
+    }
+    oldn = xml_child_nr(xp);
+    for (i=0; i<xlen; i++){
+        if (xml_parent(xvec[i]) != NULL){
+            clicon_err(OE_XML, 0, "XML node %s should not have parent", xml_name(xvec[i]));
+            goto done;
+        }
+        if (xml_spec(xvec[i]) == NULL){
+            clicon_err(OE_XML, 0, "No spec found %s", xml_name(xvec[i]));
+            goto done;
+        }
+        /* Append at end of child vector, sorted into place below */
+        if (xml_addsub(xp, xvec[i]) < 0)
+            goto done;
+    }
+    vec = xml_childvec_get(xp);
+    xml_enumerate_children(xp); /* tie-breaker of equal elements, see xml_sort */
+    qsort(&vec[oldn], xlen, sizeof(cxobj *), xml_cmp_qsort);
+    /* Backward in-place merge of the two sorted runs vec[0..oldn-1] and
+     * vec[oldn..oldn+xlen-1], the latter copied out to make room */
+    if ((tmp = malloc(xlen * sizeof(cxobj *))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memcpy(tmp, &vec[oldn], xlen * sizeof(cxobj *));
+    a = oldn - 1;
+    b = xlen - 1;
+    i = oldn + xlen - 1;
+    while (b >= 0){
+        if (a >= 0 && xml_cmp(vec[a], tmp[b], 1, 0, NULL) > 0)
+            vec[i--] = vec[a--];
+        else
+            vec[i--] = tmp[b--];
+    }
+    retval = 0;
+ done:
+    if (tmp)
+        free(tmp);
+    return retval;
+}
+
 /*! Verify all children of XML node are sorted according to xml_sort()
  * @param[in]   x    XML node. Check its children
  * @param[in]   arg  Dummy. Ensures xml_apply can be used with this fn
@@ -1331,6 +1433,145 @@ xml_find_noyang_name(cxobj       *xp,
  * @retval     0     Revert, try again with no-yang search
  * @retval    -1     Error
  */
+#ifdef XML_LIST_KEYHASH
+/* Do not bother hashing parents with fewer children than this */
+#define XML_KEYHASH_MIN_CHILDREN 32
+
+/*! Format hash key of a list entry: <listname>|<keyval>|<keyval>..
+ * @param[in,out] cb    Reset and filled in with the key string
+ * @param[in]     name  List name
+ * @param[in]     x     List entry to take key leaf values from, or NULL
+ * @param[in]     cvk   Key values as cvec (if x is NULL)
+ * @param[in]     ycvk  Yang key names (if x is given)
+ * @retval        0     OK
+ * @retval       -1     A key leaf is missing, entry cannot be indexed
+ */
+static int
+xml_keyhash_keystr(cbuf  *cb,
+                   char  *name,
+                   cxobj *x,
+                   cvec  *cvk,
+                   cvec  *ycvk)
+{
+    cg_var *cvi = NULL;
+    char   *val;
+
+    cbuf_reset(cb);
+    cprintf(cb, "%s", name);
+    if (x){
+        while ((cvi = cvec_each(ycvk, cvi)) != NULL){
+            if ((val = xml_find_body(x, cv_string_get(cvi))) == NULL)
+                return -1;
+            cprintf(cb, "|%s", val);
+        }
+    }
+    else{
+        while ((cvi = cvec_each(cvk, cvi)) != NULL){
+            if ((val = cv_string_get(cvi)) == NULL)
+                return -1;
+            cprintf(cb, "|%s", val);
+        }
+    }
+    return 0;
+}
+
+/*! Try O(1) list child lookup via the lazy per-parent key hash
+ * The index maps <listname>|<keyvals> to child position and is (re)built
+ * when missing or when the parent child count has changed. A hit is verified
+ * against the actual node (name and key leaf values); any mismatch drops the
+ * index and falls back to the regular binary search, so staleness can only
+ * cost performance, not correctness.
+ * @param[in]  xp    Parent xml node
+ * @param[in]  yc    Yang spec of list child
+ * @param[in]  name  List name
+ * @param[in]  cvk   List of keys/values, in list-key order (verified by caller)
+ * @param[out] xvec  Result vector, appended on match
+ * @retval     1     Found, appended to xvec
+ * @retval     0     Miss or index not applicable: use regular search
+ * @retval    -1     Error
+ */
+static int
+xml_keyhash_lookup(cxobj       *xp,
+                   yang_stmt   *yc,
+                   char        *name,
+                   cvec        *cvk,
+                   clixon_xvec *xvec)
+{
+    int             retval = -1;
+    clicon_hash_t  *kh = NULL;
+    int             khnr = 0;
+    cvec           *ycvk;
+    cbuf           *cb = NULL;
+    cxobj          *x;
+    cxobj          *xi;
+    cg_var         *cvi;
+    char           *val;
+    int            *posp;
+    int             i;
+
+    if ((ycvk = yang_cvec_get(yc)) == NULL)
+        goto fallback;
+    if (xml_keyhash_get(xp, &kh, &khnr) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (kh == NULL || khnr != xml_child_nr(xp)){
+        /* (Re)build the index */
+        if (xml_child_nr(xp) < XML_KEYHASH_MIN_CHILDREN)
+            goto fallback;
+        if ((kh = clicon_hash_init()) == NULL)
+            goto done;
+        for (i = 0; i < xml_child_nr(xp); i++){
+            if ((x = xml_child_i(xp, i)) == NULL ||
+                xml_type(x) != CX_ELMNT ||
+                strcmp(xml_name(x), name) != 0)
+                continue;
+            if (xml_keyhash_keystr(cb, name, x, NULL, ycvk) < 0)
+                continue; /* key leaf missing, not indexable */
+            if (clicon_hash_add(kh, cbuf_get(cb), &i, sizeof(i)) == NULL){
+                clicon_hash_free(kh);
+                goto done;
+            }
+        }
+        if (xml_keyhash_set(xp, kh, xml_child_nr(xp)) < 0)
+            goto done;
+    }
+    if (xml_keyhash_keystr(cb, name, NULL, cvk, NULL) < 0)
+        goto fallback;
+    if ((posp = clicon_hash_value(kh, cbuf_get(cb), NULL)) == NULL)
+        goto fallback; /* miss: absent, or stale in-place key edit */
+    if ((x = xml_child_i(xp, *posp)) == NULL ||
+        xml_type(x) != CX_ELMNT ||
+        strcmp(xml_name(x), name) != 0)
+        goto stale;
+    /* Verify key leaf values of the hit */
+    cvi = NULL;
+    i = 0;
+    while ((cvi = cvec_each(cvk, cvi)) != NULL){
+        if ((xi = xml_find(x, cv_string_get(cvec_i(ycvk, i)))) == NULL ||
+            (val = xml_body(xi)) == NULL ||
+            strcmp(val, cv_string_get(cvi)) != 0)
+            goto stale;
+        i++;
+    }
+    if (clixon_xvec_append(xvec, x) < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ stale: /* drop the index, it no longer reflects the tree */
+    if (xml_keyhash_set(xp, NULL, 0) < 0)
+        goto done;
+ fallback:
+    retval = 0;
+    goto done;
+}
+#endif /* XML_LIST_KEYHASH */
+
 static int
 xml_find_index_yang(cxobj       *xp,
                     yang_stmt   *yc,
@@ -1428,6 +1669,17 @@ xml_find_index_yang(cxobj       *xp,
 #else
     if (revert)
         goto revert;
+#endif
+#ifdef XML_LIST_KEYHASH
+    if (yang_keyword_get(yc) == Y_LIST && cvk && revert == 0){
+        int ret;
+        if ((ret = xml_keyhash_lookup(xp, yc, name, cvk, xvec)) < 0)
+            goto done;
+        if (ret == 1){
+            retval = 1;
+            goto done;
+        }
+    }
 #endif
     if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xc, NULL) < 0)
         goto done;
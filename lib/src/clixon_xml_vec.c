@@ -70,40 +70,59 @@
 /* How many XML children to start with if any (and then add exponentialy) */
 #define XVEC_MAX_DEFAULT 4      /* start value */
 #define XVEC_MAX_THRESHOLD 1024 /* exponential growth to here, then linear */
+#define XVEC_INLINE 8           /* Vectors up to this size are stored inline in the
+                                   struct with no heap allocation */
 
 /*! Clixon xml vector concrete implementaion of the abstract clixon_xvec type
  * Contiguous vector (not linked list) so that binary search can be done by direct index access
+ * Small vectors live in xv_inl and spill to a heap allocation only when they outgrow it.
  */
 struct clixon_xml_vec {
-    cxobj **xv_vec;   /* Sorted vector of xml object pointers */
+    cxobj **xv_vec;   /* Sorted vector of xml object pointers, points to xv_inl if small */
     int     xv_len;   /* Length of vector */
-    int     xv_max;   /* Vector allocation */    
+    int     xv_max;   /* Vector allocation */
+    cxobj  *xv_inl[XVEC_INLINE]; /* Inline storage for small vectors, see xv_vec */
 };
 
-/*! Increment cxobj vector in an XML object vector 
+/*! Increment cxobj vector in an XML object vector
  *
- * Exponential growth to a threshold, then linear
+ * Exponential growth to a threshold, then linear. Spills inline storage to the
+ * heap on first overflow.
  * @param[in]  xv    XML tree vector
+ * @param[in]  inc   Number of new entries to make room for
  * @retval     0     OK
  * @retval    -1     Error
  */
 static int
-clixon_xvec_inc(clixon_xvec *xv)
+clixon_xvec_inc(clixon_xvec *xv,
+                int          inc)
 {
-    int retval = -1;
-    
-    xv->xv_len++;
+    int     retval = -1;
+    int     max;
+    cxobj **vec;
+
+    xv->xv_len += inc;
     if (xv->xv_len > xv->xv_max){
-        if (xv->xv_max < XVEC_MAX_DEFAULT)
-            xv->xv_max = XVEC_MAX_DEFAULT;
-        else if (xv->xv_max < XVEC_MAX_THRESHOLD)
-            xv->xv_max *= 2;                  /* Double the space - exponential */
-        else
-            xv->xv_max += XVEC_MAX_THRESHOLD; /* Add - linear growth */
-        if ((xv->xv_vec = realloc(xv->xv_vec, sizeof(cxobj *) * xv->xv_max)) == NULL){
+        max = xv->xv_max < XVEC_MAX_DEFAULT ? XVEC_MAX_DEFAULT : xv->xv_max;
+        while (max < xv->xv_len){
+            if (max < XVEC_MAX_THRESHOLD)
+                max *= 2;                  /* Double the space - exponential */
+            else
+                max += XVEC_MAX_THRESHOLD; /* Add - linear growth */
+        }
+        if (xv->xv_vec == xv->xv_inl){ /* Spill inline storage to heap */
+            if ((vec = malloc(sizeof(cxobj *) * max)) == NULL){
+                clicon_err(OE_XML, errno, "malloc");
+                goto done;
+            }
+            memcpy(vec, xv->xv_inl, sizeof(cxobj *) * (xv->xv_len - inc));
+        }
+        else if ((vec = realloc(xv->xv_vec, sizeof(cxobj *) * max)) == NULL){
             clicon_err(OE_XML, errno, "realloc");
             goto done;
         }
+        xv->xv_vec = vec;
+        xv->xv_max = max;
     }
     retval = 0;
  done:
@@ -128,12 +147,40 @@ clixon_xvec_new(void)
     }
     memset(xv, 0, sizeof(*xv));
     xv->xv_len = 0;
-    xv->xv_max = 0;
+    xv->xv_vec = xv->xv_inl; /* Inline until it outgrows, see clixon_xvec_inc */
+    xv->xv_max = XVEC_INLINE;
 
  done:
     return xv;
 }
 
+/*! Create new XML object vector with room for len entries pre-allocated
+ *
+ * Avoids incremental growth when the final size is known in advance.
+ * @param[in]  len   Number of entries to reserve room for
+ * @retval     xv    XML tree vector (empty, with capacity len)
+ * @retval     NULL  Error
+ */
+clixon_xvec *
+clixon_xvec_new_reserve(int len)
+{
+    clixon_xvec *xv = NULL;
+
+    if ((xv = clixon_xvec_new()) == NULL)
+        goto done;
+    if (len > xv->xv_max){
+        if ((xv->xv_vec = malloc(sizeof(cxobj *) * len)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            free(xv);
+            xv = NULL;
+            goto done;
+        }
+        xv->xv_max = len;
+    }
+ done:
+    return xv;
+}
+
 /*! Create and copy XML vector
  *
  * @param[in]  xv0    XML tree vector
@@ -145,18 +192,12 @@ clixon_xvec_dup(clixon_xvec *xv0)
 {
     clixon_xvec *xv1 = NULL; /* retval */
 
-    if ((xv1 = clixon_xvec_new()) == NULL)
+    if ((xv1 = clixon_xvec_new_reserve(xv0->xv_len)) == NULL)
         goto done;
-    *xv1 = *xv0;
-    xv1->xv_vec = NULL;
-    if (xv1->xv_max &&
-        (xv1->xv_vec = calloc(xv1->xv_max, sizeof(cxobj*))) == NULL){
-        clicon_err(OE_UNIX, errno, "calloc");
-        free(xv1);
+    if (clixon_xvec_append_vec(xv1, xv0->xv_vec, xv0->xv_len) < 0){
+        clixon_xvec_free(xv1);
         xv1 = NULL;
-        goto done;
     }
-    memcpy(xv1->xv_vec, xv0->xv_vec, xv0->xv_len*sizeof(cxobj*));
  done:
     return xv1;
 }
@@ -166,7 +207,7 @@ clixon_xvec_dup(clixon_xvec *xv0)
 int
 clixon_xvec_free(clixon_xvec *xv)
 {
-    if (xv->xv_vec)
+    if (xv->xv_vec && xv->xv_vec != xv->xv_inl)
         free(xv->xv_vec);
     if (xv)
         free(xv);
@@ -214,21 +255,35 @@ clixon_xvec_extract(clixon_xvec *xv,
                     int         *xlen,
                     int         *xmax)
 {
-    int retval = -1;
-    
+    int     retval = -1;
+    cxobj **vec = NULL;
+
     if (xv == NULL){
         clicon_err(OE_XML, EINVAL, "xv is NULL");
         goto done;
     }
-    *xvec = xv->xv_vec;
-    *xlen = xv->xv_len;
-    if (xmax)
-        *xmax = xv->xv_max;
-    if (xv->xv_vec != NULL){
-        xv->xv_len = 0;
-        xv->xv_max = 0;
-        xv->xv_vec = NULL;
+    if (xv->xv_vec == xv->xv_inl){ /* Inline storage cannot be handed out, copy to heap */
+        if (xv->xv_len){
+            if ((vec = malloc(sizeof(cxobj *) * xv->xv_len)) == NULL){
+                clicon_err(OE_XML, errno, "malloc");
+                goto done;
+            }
+            memcpy(vec, xv->xv_inl, sizeof(cxobj *) * xv->xv_len);
+        }
+        *xvec = vec;
+        *xlen = xv->xv_len;
+        if (xmax)
+            *xmax = xv->xv_len;
     }
+    else{
+        *xvec = xv->xv_vec;
+        *xlen = xv->xv_len;
+        if (xmax)
+            *xmax = xv->xv_max;
+    }
+    xv->xv_len = 0;
+    xv->xv_vec = xv->xv_inl;
+    xv->xv_max = XVEC_INLINE;
     retval = 0;
  done:
     return retval;
@@ -253,7 +308,7 @@ clixon_xvec_append(clixon_xvec *xv,
 {
     int retval = -1;
 
-    if (clixon_xvec_inc(xv) < 0)
+    if (clixon_xvec_inc(xv, 1) < 0)
         goto done;
     xv->xv_vec[xv->xv_len-1] = x;
     retval = 0;
@@ -261,6 +316,37 @@ clixon_xvec_append(clixon_xvec *xv,
     return retval;
 }
 
+/*! Append a vector of xml trees to an existing xml vector last in the list
+ *
+ * Bulk variant of clixon_xvec_append: makes room once and copies with a
+ * single memcpy instead of appending one pointer at a time.
+ * @param[in]  xv     XML tree vector
+ * @param[in]  vec    Vector of XML trees to append
+ * @param[in]  veclen Length of vec
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_xvec_append_vec(clixon_xvec *xv,
+                       cxobj      **vec,
+                       int          veclen)
+{
+    int retval = -1;
+
+    if (veclen < 0 || (veclen > 0 && vec == NULL)){
+        clicon_err(OE_XML, EINVAL, "vec is NULL");
+        goto done;
+    }
+    if (veclen > 0){
+        if (clixon_xvec_inc(xv, veclen) < 0)
+            goto done;
+        memcpy(&xv->xv_vec[xv->xv_len-veclen], vec, sizeof(cxobj *) * veclen);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Append a second clixon-xvec into a first
  *
  * @param[in,out] xv0   XML tree vector
@@ -268,7 +354,7 @@ clixon_xvec_append(clixon_xvec *xv,
  * @retval        0     OK, with xv0 with new entries from xv1
  * @retval       -1     Error
  * @code
- *  if (clixon_xvec_merge(xv0, xv1) < 0) 
+ *  if (clixon_xvec_merge(xv0, xv1) < 0)
  *     err;
  * @endcode
  */
@@ -276,19 +362,7 @@ int
 clixon_xvec_merge(clixon_xvec *xv0,
                   clixon_xvec *xv1)
 {
-    int    retval = -1;
-    cxobj *x;
-    int    i;
-
-    for (i=0; i<clixon_xvec_len(xv1); i++){
-        x = clixon_xvec_i(xv1, i);
-        if (clixon_xvec_inc(xv0) < 0)
-            goto done;
-        xv0->xv_vec[xv0->xv_len-1] = x;
-    }
-    retval = 0;
- done:
-    return retval;
+    return clixon_xvec_append_vec(xv0, xv1->xv_vec, xv1->xv_len);
 }
 
 /*! Prepend a new xml tree to an existing xml vector first in the list
@@ -309,7 +383,7 @@ clixon_xvec_prepend(clixon_xvec *xv,
 {
     int retval = -1;
 
-    if (clixon_xvec_inc(xv) < 0)
+    if (clixon_xvec_inc(xv, 1) < 0)
         goto done;
     memmove(&xv->xv_vec[1], &xv->xv_vec[0], sizeof(cxobj *) * (xv->xv_len-1));
     xv->xv_vec[0] = x;
@@ -334,7 +408,7 @@ clixon_xvec_insert_pos(clixon_xvec *xv,
     int    retval = -1;
     size_t size;
     
-    if (clixon_xvec_inc(xv) < 0)
+    if (clixon_xvec_inc(xv, 1) < 0)
         goto done;
     size = (xv->xv_len - i -1)*sizeof(cxobj *);
     memmove(&xv->xv_vec[i+1], &xv->xv_vec[i], size);
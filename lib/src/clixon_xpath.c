@@ -73,6 +73,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <math.h>  /* NaN */
@@ -95,6 +96,7 @@
 #include "clixon_xpath.h"
 #include "clixon_xpath_parse.h"
 #include "clixon_xpath_eval.h"
+#include "clixon_xpath_optimize.h"
 
 /*
  * Variables
@@ -573,7 +575,100 @@ xpath_parse(const char  *xpath,
     return retval;
 }
 
-/*! Given XML tree and xpath, parse xpath, eval it and return xpath context, 
+/* Compiled xpath cache: direct-mapped table keyed on the expression string.
+ * NACM rules and RESTCONF paths evaluate the same expressions over and over;
+ * caching the parsed xpath_tree avoids re-running the lex/yacc parser.
+ * Entries are pinned while in use since evaluation can recurse into xpath
+ * (eg the deref() function), in which case a colliding inner expression is
+ * parsed uncached instead of evicting the pinned entry.
+ */
+#define XPATH_CACHE_SIZE 509
+
+struct xpath_cache_ent{
+    char       *xc_xpath;  /* Expression string, malloced */
+    xpath_tree *xc_tree;   /* Compiled tree, freed on eviction */
+    int         xc_inuse;  /* Pinned by an ongoing evaluation */
+};
+static struct xpath_cache_ent _xpath_cache[XPATH_CACHE_SIZE] = {{0,},};
+
+/*! FNV-1a string hash for the xpath cache
+ */
+static uint32_t
+xpath_cache_hash(const char *str)
+{
+    uint32_t h = 0x811c9dc5u;
+
+    while (*str){
+        h ^= (uint8_t)*str++;
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+/*! Parse xpath via the compiled-expression cache
+ * @param[in]  xpath  String with XPATH 1.0 syntax
+ * @param[out] xptree Compiled tree. If *cached is set it is owned by the
+ *                    cache: unpin with xpath_parse_cache_release(), do not
+ *                    free. Otherwise free with xpath_tree_free().
+ * @param[out] cached Set if xptree is a (pinned) cache entry
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xpath_parse  for the uncached variant
+ */
+static int
+xpath_parse_cache(const char  *xpath,
+                  xpath_tree **xptree,
+                  int         *cached)
+{
+    int                     retval = -1;
+    struct xpath_cache_ent *xe;
+    xpath_tree             *xpt = NULL;
+
+    *cached = 0;
+    xe = &_xpath_cache[xpath_cache_hash(xpath) % XPATH_CACHE_SIZE];
+    if (xe->xc_xpath && strcmp(xe->xc_xpath, xpath) == 0){
+        xe->xc_inuse++;
+        *xptree = xe->xc_tree;
+        *cached = 1;
+        goto ok;
+    }
+    if (xpath_parse(xpath, &xpt) < 0)
+        goto done;
+    if (xe->xc_inuse == 0){
+        /* Evict and replace the slot; on strdup failure just hand the tree
+         * to the caller uncached */
+        char *dup;
+        if ((dup = strdup(xpath)) != NULL){
+            if (xe->xc_xpath){
+                free(xe->xc_xpath);
+                xpath_tree_free(xe->xc_tree);
+            }
+            xe->xc_xpath = dup;
+            xe->xc_tree = xpt;
+            xe->xc_inuse = 1;
+            *cached = 1;
+        }
+    }
+    *xptree = xpt;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Unpin the cache entry of xpath returned by xpath_parse_cache
+ */
+static void
+xpath_parse_cache_release(const char *xpath)
+{
+    struct xpath_cache_ent *xe;
+
+    xe = &_xpath_cache[xpath_cache_hash(xpath) % XPATH_CACHE_SIZE];
+    if (xe->xc_xpath && strcmp(xe->xc_xpath, xpath) == 0)
+        xe->xc_inuse--;
+}
+
+/*! Given XML tree and xpath, parse xpath, eval it and return xpath context,
  * This is a raw form of xpath where you can do type conversion of the return
  * value, etc, not just a nodeset.
  * @param[in]  xcur   XML-tree where to search
@@ -601,9 +696,19 @@ xpath_vec_ctx(cxobj      *xcur,
     int         retval = -1;
     xpath_tree *xptree = NULL;
     xp_ctx      xc = {0,};
-    
+    int         cached = 0;
+    uint32_t    slowms;
+    uint64_t    slow_t0 = 0;
+    uint64_t    dt;
+    int         hits = 0;
+    cbuf       *cb = NULL;
+
     clicon_debug(CLIXON_DBG_DETAIL, "%s", __FUNCTION__);
-    if (xpath_parse(xpath, &xptree) < 0)
+    if ((slowms = clixon_log_slow_get()) != 0){
+        xpath_list_optimize_stats(&hits); /* discard: reset fastpath hit baseline */
+        slow_t0 = clixon_log_slow_ns();
+    }
+    if (xpath_parse_cache(xpath, &xptree, &cached) < 0)
         goto done;
     xc.xc_type = XT_NODESET;
     xc.xc_node = xcur;
@@ -612,14 +717,27 @@ xpath_vec_ctx(cxobj      *xcur,
         goto done;
     if (xp_eval(&xc, xptree, nsc, localonly, xrp) < 0)
         goto done;
+    /* Slow-op log: expression, fastpath use, result size and the parsed plan */
+    if (slowms && (dt = clixon_log_slow_ns() - slow_t0) >= (uint64_t)slowms*1000000ull){
+        xpath_list_optimize_stats(&hits);
+        if ((cb = cbuf_new()) != NULL)
+            xpath_tree2cbuf(xptree, cb);
+        clicon_log(LOG_WARNING, "slow xpath: %" PRIu64 "ms \"%s\" fastpath:%d nodeset:%d cached:%d plan: %s",
+                   dt/1000000, xpath, hits,
+                   (*xrp != NULL && (*xrp)->xc_type == XT_NODESET)?(*xrp)->xc_size:0,
+                   cached, cb?cbuf_get(cb):"");
+    }
     retval = 0;
  done:
-    if (xc.xc_nodeset){
-        free(xc.xc_nodeset);
-        xc.xc_nodeset = NULL;
+    if (cb)
+        cbuf_free(cb);
+    ctx_nodeset_release(&xc); /* May be shared with the result, see ctx_dup */
+    if (xptree){
+        if (cached)
+            xpath_parse_cache_release(xpath);
+        else
+            xpath_tree_free(xptree);
     }
-    if (xptree)
-        xpath_tree_free(xptree);
     return retval;
 }
 
@@ -800,6 +918,8 @@ xpath_vec(cxobj      *xcur,
     if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xr) < 0)
         goto done;
     if (xr && xr->xc_type == XT_NODESET){
+        if (ctx_nodeset_own(xr) < 0) /* Caller frees the vector, see ctx_dup */
+            goto done;
         *vec    = xr->xc_nodeset;
         xr->xc_nodeset = NULL;
         *veclen = xr->xc_size;
@@ -941,6 +1061,85 @@ xpath_vec_bool(cxobj      *xcur,
     return retval;
 }
 
+/*! Given XML tree and pre-compiled xpath, returns boolean
+ *
+ * As xpath_vec_bool but evaluates an already compiled expression, skipping
+ * both the parser and the compiled-expression cache lookup.
+ * @param[in]  xcur    xml-tree where to search
+ * @param[in]  nsc     External XML namespace context, or NULL
+ * @param[in]  xptree  Compiled xpath parse-tree, see xpath_parse()
+ * @retval     1       True
+ * @retval     0       False
+ * @retval    -1       Error
+ * @see ys_precompile_xpath  for when/must trees compiled at schema load
+ */
+int
+xpath_vec_bool_tree(cxobj      *xcur,
+                    cvec       *nsc,
+                    xpath_tree *xptree)
+{
+    int     retval = -1;
+    xp_ctx  xc = {0,};
+    xp_ctx *xr = NULL;
+
+    xc.xc_type = XT_NODESET;
+    xc.xc_node = xcur;
+    xc.xc_initial = xcur;
+    if (cxvec_append(xcur, &xc.xc_nodeset, &xc.xc_size) < 0)
+        goto done;
+    if (xp_eval(&xc, xptree, nsc, 0, &xr) < 0)
+        goto done;
+    if (xr)
+        retval = ctx2boolean(xr);
+ done:
+    ctx_nodeset_release(&xc); /* May be shared with the result, see ctx_dup */
+    if (xr)
+        ctx_free(xr);
+    return retval;
+}
+
+/*! Pre-compile the when/must xpath of a yang statement, yang_apply function
+ *
+ * When/must arguments are fixed strings known at schema load; compile them
+ * once onto the yang statement so that validation evaluates pre-parsed trees,
+ * see xpath_vec_bool_tree(). Called from yang_parse_post after grouping
+ * expansion and augments since compiled trees do not follow yang tree copies
+ * (see ys_cp). Statements outside that pass (eg augmented-when on previously
+ * loaded modules) keep a NULL cache and are parsed at evaluation as before.
+ * @param[in]  ys   Yang statement
+ * @param[in]  arg  Unused
+ * @retval     0    OK, including unparseable xpath which is left to evaluation
+ * @retval    -1    Error
+ * @see ys_precompile_regexps  for the corresponding pattern pass
+ */
+int
+ys_precompile_xpath(yang_stmt *ys,
+                    void      *arg)
+{
+    char         *xpath;
+    xpath_tree   *xpt = NULL;
+    enum rfc_6020 keyw;
+
+    if (yang_xpath_cache_get(ys) != NULL)
+        return 0;
+    keyw = yang_keyword_get(ys);
+    if (keyw == Y_WHEN || keyw == Y_MUST)
+        xpath = yang_argument_get(ys);
+    else
+        xpath = yang_when_xpath_get(ys);
+    if (xpath == NULL)
+        return 0;
+    if (xpath_parse(xpath, &xpt) < 0){
+        /* Malformed expression: defer to the evaluation path for error context */
+        clicon_log(LOG_NOTICE, "%s: xpath \"%s\" did not compile, deferring to validation",
+                   __FUNCTION__, xpath);
+        clicon_err_reset();
+        return 0;
+    }
+    yang_xpath_cache_set(ys, xpt);
+    return 0;
+}
+
 /*! Translate an xpath/nsc pair to a "canonical" form using yang prefixes
  *
  * @param[in]  xs      Parsed xpath - xpath_tree
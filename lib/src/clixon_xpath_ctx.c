@@ -74,36 +74,105 @@ const map_str2int ctxmap[] = {
     {NULL,        -1}
 };
 
+/*! Release the nodeset of an xpath context
+ *
+ * Frees the node vector if this context is its only user, otherwise just drops
+ * the reference shared with other contexts, see ctx_dup.
+ * @param[in] xc  XPATH evaluation context
+ * @retval    0   OK
+ */
+int
+ctx_nodeset_release(xp_ctx *xc)
+{
+    if (xc->xc_nsref){
+        if (--(*xc->xc_nsref) == 0){
+            free(xc->xc_nsref);
+            if (xc->xc_nodeset)
+                free(xc->xc_nodeset);
+        }
+        xc->xc_nsref = NULL;
+    }
+    else if (xc->xc_nodeset)
+        free(xc->xc_nodeset);
+    xc->xc_nodeset = NULL;
+    xc->xc_size = 0;
+    return 0;
+}
+
+/*! Ensure exclusive ownership of the nodeset of an xpath context
+ *
+ * Contexts created by ctx_dup share their node vector copy-on-write. Call this
+ * before mutating xc_nodeset in place or transferring it to a caller; the
+ * vector is cloned only if another context still refers to it.
+ * @param[in] xc  XPATH evaluation context
+ * @retval    0   OK
+ * @retval   -1   Error
+ */
+int
+ctx_nodeset_own(xp_ctx *xc)
+{
+    cxobj **vec;
+
+    if (xc->xc_nsref == NULL)
+        return 0;
+    if (*xc->xc_nsref == 1 || xc->xc_size == 0){ /* Last reference or empty */
+        if (--(*xc->xc_nsref) == 0)
+            free(xc->xc_nsref);
+        else
+            xc->xc_nodeset = NULL;
+        xc->xc_nsref = NULL;
+        return 0;
+    }
+    if ((vec = calloc(xc->xc_size, sizeof(cxobj*))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    memcpy(vec, xc->xc_nodeset, xc->xc_size*sizeof(cxobj*));
+    (*xc->xc_nsref)--;
+    xc->xc_nsref = NULL;
+    xc->xc_nodeset = vec;
+    return 0;
+}
+
 /*! Free xpath context */
 int
 ctx_free(xp_ctx *xc)
 {
-    if (xc->xc_nodeset)
-        free(xc->xc_nodeset);
+    ctx_nodeset_release(xc);
     if (xc->xc_string)
         free(xc->xc_string);
     free(xc);
     return 0;
 }
 
-/*! Duplicate xpath context */
+/*! Duplicate xpath context
+ *
+ * The node vector is shared copy-on-write with xc0 instead of copied, see
+ * ctx_nodeset_own for how writers break the sharing.
+ */
 xp_ctx *
 ctx_dup(xp_ctx *xc0)
 {
     xp_ctx *xc = NULL;
-    
+
     if ((xc = malloc(sizeof(*xc))) == NULL){
         clicon_err(OE_UNIX, errno, "malloc");
         goto done;
     }
     memset(xc, 0, sizeof(*xc));
     *xc = *xc0;
-    if (xc0->xc_size){
-        if ((xc->xc_nodeset = calloc(xc0->xc_size, sizeof(cxobj*))) == NULL){
-            clicon_err(OE_UNIX, errno, "calloc");
-            goto done;
+    if (xc0->xc_nodeset){
+        if (xc0->xc_nsref == NULL){
+            if ((xc0->xc_nsref = malloc(sizeof(int))) == NULL){
+                clicon_err(OE_UNIX, errno, "malloc");
+                free(xc);
+                xc = NULL;
+                goto done;
+            }
+            *xc0->xc_nsref = 1;
         }
-        memcpy(xc->xc_nodeset, xc0->xc_nodeset, xc->xc_size*sizeof(cxobj*));
+        (*xc0->xc_nsref)++;
+        xc->xc_nsref = xc0->xc_nsref;
     }
     if (xc0->xc_string)
         if ((xc->xc_string = strdup(xc0->xc_string)) == NULL){
@@ -310,15 +379,14 @@ ctx2number(xp_ctx *xc,
     return retval;
 }
 
-/*! Replace a nodeset of a XPATH context with a new nodeset 
+/*! Replace a nodeset of a XPATH context with a new nodeset
  */
 int
 ctx_nodeset_replace(xp_ctx   *xc,
                     cxobj   **vec,
                     size_t    veclen)
 {
-    if (xc->xc_nodeset)
-        free(xc->xc_nodeset);
+    ctx_nodeset_release(xc);
     xc->xc_nodeset = vec;
     xc->xc_size = veclen;
     return 0;
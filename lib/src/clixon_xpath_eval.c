@@ -276,6 +276,8 @@ nodetest_recursive(cxobj      *xn,
 
     xsub = NULL;
     while ((xsub = xml_child_each(xn, xsub, node_type)) != NULL) {
+        if (xml_flag(xsub, XML_FLAG_SKIP))
+            continue; /* Subtree pruned by caller, eg datastore namespace pre-filter */
         if (nodetest_eval(xsub, nodetest, nsc, localonly) == 1){
             clicon_debug(CLIXON_DBG_DETAIL, "%s %x %x", __FUNCTION__, flags, xml_flag(xsub, flags));
             if (flags==0x0 || xml_flag(xsub, flags))
@@ -352,6 +354,8 @@ xp_eval_step(xp_ctx     *xc0,
                     goto done;
                 if (ret == 0){/* regular code, no optimization made */
                     while ((x = xml_child_each(xv, x, CX_ELMNT)) != NULL) {
+                        if (xml_flag(x, XML_FLAG_SKIP))
+                            continue; /* Subtree pruned by caller, eg datastore namespace pre-filter */
                         /* xs->xs_c0 is nodetest */
                         if (nodetest == NULL ||
                             nodetest_eval(x, nodetest, nsc, localonly) == 1){
@@ -370,6 +374,8 @@ xp_eval_step(xp_ctx     *xc0,
             if (nodetest_recursive(xv, xs->xs_c0, CX_ELMNT, 0x0, nsc, localonly, &vec, &veclen) < 0)
                 goto done;
         }
+        if (ctx_nodeset_own(xc) < 0) /* May be shared with xc0, see ctx_dup */
+            goto done;
         for (i=0; i<veclen; i++){
             x = vec[i];
             if (cxvec_append(x, &xc->xc_nodeset, &xc->xc_size) < 0)
@@ -395,25 +401,18 @@ xp_eval_step(xp_ctx     *xc0,
     case A_NAMESPACE: /* principal node type is namespace */
         break;
     case A_PARENT:
-        veclen = xc->xc_size;
-        vec = xc->xc_nodeset;
-        xc->xc_size = 0;
-        xc->xc_nodeset = NULL;
-        for (i=0; i<veclen; i++){
-            x = vec[i];
+        for (i=0; i<xc->xc_size; i++){
+            x = xc->xc_nodeset[i];
             if ((xp = xml_parent(x)) != NULL
 #ifdef XML_PARENT_CANDIDATE
                 /* Also check "candidate" parent for special when use-case */
                 || (xp = xml_parent_candidate(x)) != NULL
 #endif /* XML_PARENT_CANDIDATE */
                 )
-                if (cxvec_append(xp, &xc->xc_nodeset, &xc->xc_size) < 0)
+                if (cxvec_append(xp, &vec, &veclen) < 0)
                     goto done;
         }
-        if (vec){
-            free(vec);
-            vec = NULL;
-        }
+        ctx_nodeset_replace(xc, vec, veclen);
         break;
     case A_PRECEDING:
         break;
@@ -445,6 +444,86 @@ xp_eval_step(xp_ctx     *xc0,
     return retval;
 }
 
+/*! Descend pass-through expression wrapper nodes to the first operative node
+ *
+ * The grammar wraps every expression in a chain of single-operand nodes
+ * (expr/andexpr/relexpr/...), see clixon_xpath_parse.y. Skip them to get at
+ * the node that actually computes something.
+ * @param[in]  xt  XPath tree
+ * @retval     xt  First node that is not a single-operand wrapper
+ */
+static xpath_tree *
+xp_expr_unwrap(xpath_tree *xt)
+{
+    while (xt != NULL && xt->xs_c0 != NULL && xt->xs_c1 == NULL){
+        switch (xt->xs_type){
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+        case XP_PATHEXPR:
+        case XP_FILTEREXPR:
+            xt = xt->xs_c0;
+            break;
+        default:
+            return xt;
+        }
+    }
+    return xt;
+}
+
+/*! Detect a constant positional predicate: [NR] or [position()=NR]
+ *
+ * Such predicates do not depend on the context node, so the caller can index
+ * the node-set directly instead of evaluating the expression once per node,
+ * which turns predicate filtering from O(n) context setups into O(1).
+ * @param[in]  xs    Predicate expression tree (from '[' expr ']')
+ * @param[out] idxp  Index into the node-set being filtered (same base as
+ *                   xc_position), or -1 if the constant can never match
+ * @retval     1     Constant positional predicate, idxp set
+ * @retval     0     Not a constant positional predicate
+ * @note [NR] truncates the number as in the generic number-to-position rule
+ *       below, while [position()=NR] is an exact compare and a fractional NR
+ *       matches nothing. Both mirror the generic code exactly.
+ */
+static int
+xp_pred_position(xpath_tree *xs,
+                 int        *idxp)
+{
+    xpath_tree *xt;
+    xpath_tree *x0;
+    xpath_tree *x1;
+    double      nr;
+
+    if ((xt = xp_expr_unwrap(xs)) == NULL)
+        return 0;
+    if (xt->xs_type == XP_PRIME_NR){
+        nr = xt->xs_double;
+        *idxp = (nr >= 0.0 && nr < (double)INT_MAX) ? (int)nr : -1;
+        return 1;
+    }
+    if (xt->xs_type == XP_RELEX && xt->xs_int == XO_EQ &&
+        xt->xs_c0 != NULL && xt->xs_c1 != NULL){
+        x0 = xp_expr_unwrap(xt->xs_c0);
+        x1 = xp_expr_unwrap(xt->xs_c1);
+        if (x0 == NULL || x1 == NULL)
+            return 0;
+        if (x1->xs_type == XP_PRIME_FN){ /* NR = position() */
+            xt = x0; x0 = x1; x1 = xt;
+        }
+        if (x0->xs_type == XP_PRIME_FN && x0->xs_int == XPATHFN_POSITION &&
+            x0->xs_c0 == NULL && /* no args */
+            x1->xs_type == XP_PRIME_NR){
+            nr = x1->xs_double;
+            *idxp = (nr >= 0.0 && nr < (double)INT_MAX && nr == (double)(int)nr)
+                ? (int)nr : -1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /*! Evaluate xpath predicates rule
  *
  * pred -> pred expr
@@ -505,6 +584,14 @@ xp_eval_predicate(xp_ctx     *xc,
         xr1->xc_type = XT_NODESET;
         xr1->xc_node = xc->xc_node;
         xr1->xc_initial = xc->xc_initial;
+        if (xp_pred_position(xs->xs_c1, &i) == 1){
+            /* Constant positional predicate: index the node-set directly
+             * instead of evaluating the expression once per node */
+            if (i >= 0 && i < xr0->xc_size)
+                if (cxvec_append(xr0->xc_nodeset[i], &xr1->xc_nodeset, &xr1->xc_size) < 0)
+                    goto done;
+            goto result;
+        }
         for (i=0; i<xr0->xc_size; i++){
             x = xr0->xc_nodeset[i];
             /* Create new context */
@@ -543,6 +630,7 @@ xp_eval_predicate(xp_ctx     *xc,
                 ctx_free(xrc);
         }
     }
+ result:
     if (xr0 == NULL && xr1 == NULL){
         clicon_err(OE_XML, EFAULT, "Internal error: no result produced");
         goto done;
@@ -1147,8 +1235,15 @@ xp_eval(xp_ctx     *xc,
             x = xml_parent(x);
 #endif
         xc->xc_node = x;
-        xc->xc_nodeset[0] = x;
-        xc->xc_size=1;
+        if (xc->xc_nsref){ /* Shared, see ctx_dup: rebuild instead of cloning */
+            ctx_nodeset_release(xc);
+            if (cxvec_append(x, &xc->xc_nodeset, &xc->xc_size) < 0)
+                goto done;
+        }
+        else{
+            xc->xc_nodeset[0] = x;
+            xc->xc_size=1;
+        }
         /* // is short for /descendant-or-self::node()/ */
         if (xs->xs_int == A_DESCENDANT_OR_SELF)
             xc->xc_descendant = 1; /* XXX need to set to 0 in sub */
@@ -210,9 +210,26 @@ xp_function_deref(xp_ctx            *xc0,
     return retval;
 }
 
+/* Loop-invariant state of a derived-from(-or-self) evaluation
+ * The base identity string, its resolved Y_IDENTITY object and the per-leaf
+ * type resolution do not vary over the evaluated nodeset, so they are computed
+ * once per function call (and per distinct leaf spec) instead of per node, see
+ * derived_from_one. Derivation membership itself is one hash lookup in the
+ * identity closure, see yang_valcache_lookup.
+ */
+struct derived_from_state{
+    char      *dfs_baseid;   /* Base identity without prefix (malloced) */
+    yang_stmt *dfs_ybaseid;  /* Resolved base identity, valid if dfs_yspec set */
+    yang_stmt *dfs_yspec;    /* Yang spec dfs_ybaseid was resolved in */
+    yang_stmt *dfs_yleaf;    /* Last leaf spec seen, memoizes dfs_ytype */
+    yang_stmt *dfs_ytype;    /* Resolved type of dfs_yleaf */
+    cbuf      *dfs_cb;       /* Scratch buffer for <module>:<id> */
+};
+
 /*! Helper function for derived-from(-and-self) - eval one node
  * @param[in]  nsc  XML Namespace context
  * @param[in]  self If set, implements derived_from_or_self
+ * @param[in]  dfs  Loop-invariant state, see struct derived_from_state
  * @retval     1    OK and match
  * @retval     0    OK but not match
  * @retval    -1    Error
@@ -221,43 +238,50 @@ static int
 derived_from_one(char  *baseidentity,
                  cvec  *nsc,
                  cxobj *xleaf,
-                 int    self)
+                 int    self,
+                 struct derived_from_state *dfs)
 {
     int        retval = -1;
     yang_stmt *yleaf;
     yang_stmt *ytype;
     yang_stmt *ybaseid;
     yang_stmt *ymod;
-    cvec      *idrefvec; /* Derived identityref list: (module:id)**/
+    yang_stmt *yspec;
+    int        ret;
     char      *node = NULL;
     char      *prefix = NULL;
     char      *id = NULL;
-    cbuf      *cb = NULL;
-    char      *baseid = NULL;
 
-    /* Split baseidentity to get its id (w/o prefix) */
-    if (nodeid_split(baseidentity, NULL, &baseid) < 0)
-        goto done;
     if ((yleaf = xml_spec(xleaf)) == NULL)
         goto nomatch;
     if (yang_keyword_get(yleaf) != Y_LEAF && yang_keyword_get(yleaf) != Y_LEAF_LIST)
         goto nomatch;
-    /* Node is of type identityref */
-    if (yang_type_get(yleaf, NULL, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
-        goto done;
+    /* Node is of type identityref. Nodesets are typically instances of the
+     * same leaf: memoize the typedef resolution per leaf spec */
+    if (yleaf == dfs->dfs_yleaf)
+        ytype = dfs->dfs_ytype;
+    else{
+        if (yang_type_get(yleaf, NULL, &ytype, NULL, NULL, NULL, NULL, NULL) < 0)
+            goto done;
+        dfs->dfs_yleaf = yleaf;
+        dfs->dfs_ytype = ytype;
+    }
     if (ytype == NULL || strcmp(yang_argument_get(ytype), "identityref"))
         goto nomatch;
     /* Find if the derivation chain is: identity ->...-> ytype
-     * Example: 
+     * Example:
      * identity is ex:ethernet
      * xleaf <type>fast-ethernet</type>
      * yleaf type identityref{base interface-type;}
      */
-    /* Just get the object corresponding to the base identity */
-    if ((ybaseid = yang_find_identity_nsc(ys_spec(yleaf), baseidentity, nsc)) == NULL)
+    /* Just get the object corresponding to the base identity, once per spec */
+    yspec = ys_spec(yleaf);
+    if (yspec != dfs->dfs_yspec){
+        dfs->dfs_ybaseid = yang_find_identity_nsc(yspec, baseidentity, nsc);
+        dfs->dfs_yspec = yspec;
+    }
+    if ((ybaseid = dfs->dfs_ybaseid) == NULL)
         goto nomatch;
-    /* Get its list of derived identities  */
-    idrefvec = yang_cvec_get(ybaseid);
     /* Get and split the leaf id reference */
     if ((node = xml_body(xleaf)) == NULL) /* It may not be empty */
         goto nomatch;
@@ -267,32 +291,26 @@ derived_from_one(char  *baseidentity,
     if (prefix == NULL)
         ymod = ys_module(yleaf);
     else{ /* from prefix to name */
-        ymod = yang_find_module_by_prefix_yspec(ys_spec(yleaf), prefix);
+        ymod = yang_find_module_by_prefix_yspec(yspec, prefix);
     }
     if (ymod == NULL)
         goto nomatch;
     /* self special case, ie that the xleaf has a ref to itself */
     if (self &&
         ymod == ys_module(ybaseid) &&
-        strcmp(baseid, id) == 0){
+        strcmp(dfs->dfs_baseid, id) == 0){
         ; /* match */
     }
     else {
-        /* Allocate cbuf */
-        if ((cb = cbuf_new()) == NULL){
-            clicon_err(OE_UNIX, errno, "cbuf_new"); 
+        cbuf_reset(dfs->dfs_cb);
+        cprintf(dfs->dfs_cb, "%s:%s", yang_argument_get(ymod), id);
+        if ((ret = yang_valcache_lookup(ybaseid, cbuf_get(dfs->dfs_cb))) < 0)
             goto done;
-        }
-        cprintf(cb, "%s:%s", yang_argument_get(ymod), id);
-        if (cvec_find(idrefvec, cbuf_get(cb)) == NULL)
+        if (ret == 0)
             goto nomatch;
     }
     retval = 1;
  done:
-    if (baseid)
-        free(baseid);
-    if (cb)
-        cbuf_free(cb);
     if (id)
         free(id);
     if (prefix)
@@ -333,7 +351,8 @@ xp_function_derived_from(xp_ctx            *xc,
     char      *identity = NULL;
     int        i;
     int        ret = 0;
-    
+    struct derived_from_state dfs = {0,};
+
     if (xs == NULL || xs->xs_c0 == NULL || xs->xs_c1 == NULL){
         clicon_err(OE_XML, EINVAL, "derived-from expects but did not get two arguments");
         goto done;
@@ -356,9 +375,18 @@ xp_function_derived_from(xp_ctx            *xc,
     }
     memset(xr, 0, sizeof(*xr));
     xr->xc_type = XT_BOOL;
+    if (xr0->xc_size > 0){
+        /* Loop invariants: split base identity and scratch buffer */
+        if (nodeid_split(identity, NULL, &dfs.dfs_baseid) < 0)
+            goto done;
+        if ((dfs.dfs_cb = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+    }
     /* ANY node is an identityref and its value an identity that is derived ... */
     for (i=0; i<xr0->xc_size; i++){
-        if ((ret = derived_from_one(identity, nsc, xr0->xc_nodeset[i], self)) < 0)
+        if ((ret = derived_from_one(identity, nsc, xr0->xc_nodeset[i], self, &dfs)) < 0)
             goto done;
         if (ret == 1)
             break;
@@ -368,6 +396,10 @@ xp_function_derived_from(xp_ctx            *xc,
     xr = NULL;
     retval = 0;
  done:
+    if (dfs.dfs_baseid)
+        free(dfs.dfs_baseid);
+    if (dfs.dfs_cb)
+        cbuf_free(dfs.dfs_cb);
     if (xr0)
         ctx_free(xr0);
     if (xr1)
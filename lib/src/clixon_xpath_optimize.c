@@ -47,6 +47,7 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <assert.h>
 #include <syslog.h>
 #include <fcntl.h>
@@ -225,6 +226,9 @@ loop_preds(xpath_tree *xt,
  * @retval     1      Match
  *  XPath:
  *  y[k=3] # corresponds to: <name>[<keyname>=<keyval>]
+ *  Multiple key predicates are handled: y[k1='a'][k2='b'] binds a composite
+ *  key via loop_preds and binary-searches on all keys, provided they match
+ *  the list keys exactly in number and order.
  */
 static int
 xpath_list_optimize_fn(xpath_tree  *xt,
@@ -315,6 +319,64 @@ xpath_list_optimize_fn(xpath_tree  *xt,
     retval = 0;
     goto done;
 }
+
+/*! Recursively report subtrees that pattern-match the binary-search fastpath
+ *
+ * Static half of the check in xpath_list_optimize_fn: only the pattern match
+ * and key-binding extraction, no yang or XML context needed.
+ * @param[in]     xt  XPath tree
+ * @param[in,out] cb  Report appended here, one line per eligible step
+ * @param[in,out] nr  Incremented per eligible step
+ * @retval        0   OK
+ * @retval       -1   Error
+ */
+static int
+explain_eligible(xpath_tree *xt,
+                 cbuf       *cb,
+                 int        *nr)
+{
+    int          retval = -1;
+    xpath_tree  *xm = NULL;
+    xpath_tree  *xem = NULL;
+    xpath_tree **vec = NULL;
+    size_t       veclen = 0;
+    cvec        *cvk = NULL;
+    cg_var      *cvi;
+    int          ret;
+
+    if (xpath_optimize_init(&xm, &xem) < 0)
+        goto done;
+    if ((ret = xpath_tree_eq(xm, xt, &vec, &veclen)) < 0)
+        goto done;
+    if (ret == 1 && veclen == 2){
+        if ((cvk = cvec_new(0)) == NULL){
+            clicon_err(OE_XML, errno, "cvec_new");
+            goto done;
+        }
+        if ((ret = loop_preds(vec[1], xem, cvk)) < 0)
+            goto done;
+        if (ret == 1){
+            (*nr)++;
+            cprintf(cb, "step %s[", vec[0]->xs_s1);
+            cvi = NULL;
+            while ((cvi = cvec_each(cvk, cvi)) != NULL)
+                cprintf(cb, "%s%s='%s'", cvec_i(cvk, 0) == cvi ? "" : " and ",
+                        cv_name_get(cvi), cv_string_get(cvi));
+            cprintf(cb, "]: eligible for binary search, O(log n) vs O(n) key comparisons\n");
+        }
+    }
+    if (xt->xs_c0 && explain_eligible(xt->xs_c0, cb, nr) < 0)
+        goto done;
+    if (xt->xs_c1 && explain_eligible(xt->xs_c1, cb, nr) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cvk)
+        cvec_free(cvk);
+    if (vec)
+        free(vec);
+    return retval;
+}
 #endif /* XPATH_LIST_OPTIMIZE */
 
 /*! Identify XPATH special cases and if match, use binary search.
@@ -357,3 +419,66 @@ xpath_optimize_check(xpath_tree *xs,
 #endif
 }
 
+/*! Explain an xpath expression: parsed plan, fastpath-eligible steps, measured eval
+ *
+ * Prints the parsed xpath_tree and every step of the form x[k='v'] that
+ * pattern-matches the binary-search list optimization, with its key bindings.
+ * Whether such a step actually takes the fastpath at evaluation depends on the
+ * yang context (a sorted config list whose keys match, no enclosing list), so
+ * if a context node is given the expression is also evaluated and the measured
+ * fastpath hits and result node-set size are reported.
+ * @param[in]     xcur   XML context node to evaluate against, or NULL for static only
+ * @param[in]     nsc    External XML namespace context, or NULL
+ * @param[in]     xpath  Expression with XPATH 1.0 syntax
+ * @param[in,out] cb     Explanation appended here as text
+ * @retval        0      OK
+ * @retval       -1      Error
+ * @see xpath_optimize_check  the runtime decision this previews
+ */
+int
+xpath_explain(cxobj      *xcur,
+              cvec       *nsc,
+              const char *xpath,
+              cbuf       *cb)
+{
+    int         retval = -1;
+    xpath_tree *xptree = NULL;
+    xp_ctx     *xrp = NULL;
+    int         hits = 0;
+    int         nr = 0;
+    uint64_t    t0;
+
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+    cprintf(cb, "xpath: %s\nplan:\n", xpath);
+    if (xpath_tree2cbuf(xptree, cb) < 0)
+        goto done;
+#ifdef XPATH_LIST_OPTIMIZE
+    if (!_optimize_enable)
+        cprintf(cb, "fastpath: disabled, see xpath_list_optimize_set\n");
+    if (explain_eligible(xptree, cb, &nr) < 0)
+        goto done;
+    cprintf(cb, "eligible steps: %d\n", nr);
+#else
+    cprintf(cb, "fastpath: disabled at compile time, see XPATH_LIST_OPTIMIZE\n");
+#endif
+    if (xcur != NULL){
+        xpath_list_optimize_stats(&hits); /* discard: reset hit baseline */
+        t0 = clixon_log_slow_ns();
+        if (xpath_vec_ctx(xcur, nsc, xpath, 0, &xrp) < 0)
+            goto done;
+        xpath_list_optimize_stats(&hits);
+        cprintf(cb, "evaluated: %" PRIu64 " us, fastpath hits: %d\n",
+                (clixon_log_slow_ns() - t0)/1000, hits);
+        if (xrp != NULL && xrp->xc_type == XT_NODESET)
+            cprintf(cb, "result: nodeset of %d\n", xrp->xc_size);
+    }
+    retval = 0;
+ done:
+    if (xrp)
+        ctx_free(xrp);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+}
+
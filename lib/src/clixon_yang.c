@@ -75,6 +75,8 @@
 #include "clixon_hash.h"
 #include "clixon_xml.h"
 #include "clixon_xml_nsctx.h"
+#include "clixon_xpath_ctx.h"
+#include "clixon_xpath.h"
 #include "clixon_yang_module.h"
 #include "clixon_plugin.h"
 #include "clixon_data.h"
@@ -84,6 +86,7 @@
 #include "clixon_yang_parse_lib.h"
 #include "clixon_yang_cardinality.h"
 #include "clixon_yang_type.h"
+#include "clixon_path.h"
 #include "clixon_yang_schema_mount.h"
 #include "clixon_yang_internal.h" /* internal included by this file only, not API*/
 
@@ -240,11 +243,48 @@ yang_argument_get(yang_stmt *ys)
  * @param[in] arg  Argument
  * Typically only done at parsing / initiation
  */
+/*! Clear the lazily built child find caches of a yang node
+ * Called whenever the child set (or a child name) may change so that
+ * yang_find_datanode/yang_find_schemanode rebuild on next lookup.
+ * @param[in] yn  Yang node whose caches are dropped, NULL is a no-op
+ */
+static int
+yang_findcache_clear(yang_stmt *yn)
+{
+    if (yn == NULL)
+        return 0;
+    if (yn->ys_dncache){
+        clicon_hash_free(yn->ys_dncache);
+        yn->ys_dncache = NULL;
+    }
+    if (yn->ys_sncache){
+        clicon_hash_free(yn->ys_sncache);
+        yn->ys_sncache = NULL;
+    }
+    if (yn->ys_vcache){
+        clicon_hash_free(yn->ys_vcache);
+        yn->ys_vcache = NULL;
+    }
+    /* The canonical nsc of a spec maps its module set; modules keep their
+     * import map which does not depend on the child list, see xml_nsctx_yang */
+    if (yn->ys_keyword == Y_SPEC && yn->ys_nscache){
+        cvec_free(yn->ys_nscache);
+        yn->ys_nscache = NULL;
+    }
+    /* Memoized absolute schema-node-id targets may dangle if the module set mutates */
+    if (yn->ys_keyword == Y_SPEC && yn->ys_abscache){
+        clicon_hash_free(yn->ys_abscache);
+        yn->ys_abscache = NULL;
+    }
+    return 0;
+}
+
 int
 yang_argument_set(yang_stmt *ys,
                   char      *arg)
 {
     ys->ys_argument = arg; /* not strdup/copied */
+    yang_findcache_clear(ys->ys_parent); /* parent cache maps old name */
     return 0;
 }
 
@@ -296,6 +336,10 @@ yang_cvec_set(yang_stmt *ys,
     if (ys->ys_cvec)
         cvec_free(ys->ys_cvec);
     ys->ys_cvec = cvv;
+    if (ys->ys_vcache){ /* Derived identity set may key on the cvec */
+        clicon_hash_free(ys->ys_vcache);
+        ys->ys_vcache = NULL;
+    }
     return 0;
 }
 
@@ -330,9 +374,148 @@ yang_cvec_add(yang_stmt    *ys,
         clicon_err(OE_YANG, errno, "cv_name_set(%s)", name);
         return NULL;
     }
+    if (ys->ys_vcache){ /* Derived identity set may key on the cvec */
+        clicon_hash_free(ys->ys_vcache);
+        ys->ys_vcache = NULL;
+    }
     return cv;
 }
 
+/*! Check if a value string is in the valid value set of a yang node, hashed
+ *
+ * Replaces the linear scans over derived identities and enum/bit names in the
+ * validate path with one hash lookup per value; the hash is built on first
+ * lookup and shared by all leaves resolving to the same type or base identity.
+ * Two kinds of nodes carry such a set:
+ * - a base Y_IDENTITY: all derived identities as <module>:<id>, from its cvec,
+ *   see ys_populate_identity()
+ * - a resolved Y_TYPE (enumeration/bits): the enum/bit names of its children
+ * The cache is dropped on child or cvec mutation, see yang_findcache_clear()
+ * @param[in]  ys   Base identity or resolved type yang node
+ * @param[in]  val  Value string to look up
+ * @retval     1    Found, val is in the valid set
+ * @retval     0    Not found
+ * @retval    -1    Error
+ * @see validate_identityref
+ * @see cv_validate1
+ */
+int
+yang_valcache_lookup(yang_stmt *ys,
+                     char      *val)
+{
+    int            retval = -1;
+    clicon_hash_t *vc;
+    yang_stmt     *yc;
+    cg_var        *cv;
+    enum rfc_6020  kw;
+
+    if (ys == NULL || val == NULL){
+        clicon_err(OE_YANG, EINVAL, "ys or val is NULL");
+        goto done;
+    }
+    if (ys->ys_vcache == NULL){
+        if ((vc = clicon_hash_init()) == NULL)
+            goto done;
+        if (yang_keyword_get(ys) == Y_IDENTITY){
+            cv = NULL;
+            while (ys->ys_cvec && (cv = cvec_each(ys->ys_cvec, cv)) != NULL)
+                if (clicon_hash_add(vc, cv_name_get(cv), &ys, sizeof(ys)) == NULL){
+                    clicon_hash_free(vc);
+                    goto done;
+                }
+        }
+        else{
+            yc = NULL;
+            while ((yc = yn_each(ys, yc)) != NULL){
+                kw = yang_keyword_get(yc);
+                if (kw != Y_ENUM && kw != Y_BIT)
+                    continue;
+                if (clicon_hash_add(vc, yang_argument_get(yc), &yc, sizeof(yc)) == NULL){
+                    clicon_hash_free(vc);
+                    goto done;
+                }
+            }
+        }
+        ys->ys_vcache = vc;
+    }
+    retval = clicon_hash_lookup(ys->ys_vcache, val) != NULL;
+ done:
+    return retval;
+}
+
+/* Cap of the per-union validation memo, see yang_valcache_memo_add() */
+#define YANG_VALCACHE_MEMO_MAX 256
+
+/*! Get memoized matching member type of an already validated union value
+ *
+ * The memo variant of the valcache: instead of a precomputed valid set, the
+ * hash holds values that earlier passed union validation, mapped to the member
+ * type that matched, see ys_cv_validate_union(). Only positive results are
+ * memoized so failure reasons are still generated by the full pass.
+ * @param[in]  ys   Resolved union type yang node
+ * @param[in]  val  Value string
+ * @retval     yt   Member Y_TYPE statement that validated val earlier
+ * @retval     NULL Not in memo (or no memo yet)
+ */
+yang_stmt *
+yang_valcache_memo_get(yang_stmt *ys,
+                       char      *val)
+{
+    yang_stmt **yp;
+
+    if (ys == NULL || val == NULL || ys->ys_vcache == NULL)
+        return NULL;
+    if ((yp = clicon_hash_value(ys->ys_vcache, val, NULL)) == NULL)
+        return NULL;
+    return *yp;
+}
+
+/*! Memoize a successfully validated union value and its matching member type
+ *
+ * Bounded: when the memo reaches YANG_VALCACHE_MEMO_MAX entries it is flushed
+ * and restarted, keeping the per-type footprint small for high-cardinality
+ * leaves such as addresses.
+ * Dropped with the valid-set cache on mutation, see yang_findcache_clear()
+ * @param[in]  ys     Resolved union type yang node
+ * @param[in]  val    Value string that validated
+ * @param[in]  ymatch Member Y_TYPE statement that matched
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see yang_valcache_memo_get
+ */
+int
+yang_valcache_memo_add(yang_stmt *ys,
+                       char      *val,
+                       yang_stmt *ymatch)
+{
+    int     retval = -1;
+    char  **keys = NULL;
+    size_t  nkeys = 0;
+
+    if (ys == NULL || val == NULL || ymatch == NULL){
+        clicon_err(OE_YANG, EINVAL, "ys, val or ymatch is NULL");
+        goto done;
+    }
+    if (ys->ys_vcache != NULL){
+        if (clicon_hash_keys(ys->ys_vcache, &keys, &nkeys) < 0)
+            goto done;
+        if (nkeys >= YANG_VALCACHE_MEMO_MAX){
+            clicon_hash_free(ys->ys_vcache);
+            ys->ys_vcache = NULL;
+        }
+    }
+    if (ys->ys_vcache == NULL &&
+        (ys->ys_vcache = clicon_hash_init()) == NULL)
+        goto done;
+    if (clicon_hash_add(ys->ys_vcache, val, &ymatch, sizeof(ymatch)) == NULL)
+        goto done;
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
 /*! Get yang stmt flags, used for internal algorithms
  * @param[in]  ys     Yang statement
  * @param[in]  flag   Flags value(s) to get, see YANG_FLAG_*
@@ -428,6 +611,33 @@ yang_when_nsc_get(yang_stmt *ys)
     return ys->ys_when_nsc;
 }
 
+/*! Get compiled when/must xpath of a yang statement
+ * @param[in]  ys   Yang statement
+ * @retval     xpt  Compiled xpath parse-tree, owned by ys
+ * @retval     NULL Not compiled (eg yang tree copy), caller parses at evaluation
+ * @see ys_precompile_xpath  where it is compiled at schema load
+ */
+struct xpath_tree *
+yang_xpath_cache_get(yang_stmt *ys)
+{
+    return ys->ys_xpcache;
+}
+
+/*! Set compiled when/must xpath of a yang statement, consumed
+ * @param[in]  ys   Yang statement
+ * @param[in]  xpt  Compiled xpath parse-tree, consumed: freed by ys_free1
+ * @retval     0    OK
+ */
+int
+yang_xpath_cache_set(yang_stmt         *ys,
+                     struct xpath_tree *xpt)
+{
+    if (ys->ys_xpcache)
+        xpath_tree_free(ys->ys_xpcache);
+    ys->ys_xpcache = xpt;
+    return 0;
+}
+
 /*! Set yang namespace context for "when"-associated augment
  *
  * Ie, for yang structures like: augment <path> { when <xpath>; ... }
@@ -452,6 +662,37 @@ yang_when_nsc_set(yang_stmt *ys,
     return retval;
 }
 
+/*! Get cached import prefix/namespace map of a yang (sub)module
+ *
+ * @param[in]  ys     Yang (sub)module statement
+ * @retval     nsc    Cached namespace context (direct pointer)
+ * @retval     NULL   Not (yet) cached
+ * @see xml_nsctx_yang  which builds and uses the cache
+ */
+cvec *
+yang_nscache_get(yang_stmt *ys)
+{
+    return ys->ys_nscache;
+}
+
+/*! Set cached import prefix/namespace map of a yang (sub)module
+ *
+ * The import set of a module is fixed after parsing, so the map can be computed
+ * once and reused for all namespace context constructions in that module.
+ * @param[in]  ys     Yang (sub)module statement
+ * @param[in]  nsc    Namespace context, consumed: freed with ys
+ * @retval     0      OK
+ */
+int
+yang_nscache_set(yang_stmt *ys,
+                 cvec      *nsc)
+{
+    if (ys->ys_nscache)
+        cvec_free(ys->ys_nscache);
+    ys->ys_nscache = nsc;
+    return 0;
+}
+
 /*! Get yang filename for error/debug purpose
  *
  * @param[in]  ys       Yang statement
@@ -558,6 +799,8 @@ yang_stats_one(yang_stmt *y,
         sz += strlen(y->ys_when_xpath) + 1;
     if (y->ys_when_nsc)
         sz += cvec_size(y->ys_when_nsc);
+    if (y->ys_nscache)
+        sz += cvec_size(y->ys_nscache);
     if (y->ys_filename)
         sz += strlen(y->ys_filename) + 1;
     if (szp)
@@ -656,6 +899,12 @@ ys_free1(yang_stmt *ys,
     cg_var         *cv;
     rpc_callback_t *rc;
 
+    /* Cached api-path translations and compiled instance-ids key on the spec
+     * pointer, flush before it can be reused, see api_path_cache_flush() */
+    if (yang_keyword_get(ys) == Y_SPEC){
+        api_path_cache_flush(ys);
+        instance_id_cache_flush(ys);
+    }
     if ((cv = yang_cv_get(ys)) != NULL){
         yang_cv_set(ys, NULL); /* only frees on replace */
         cv_free(cv);
@@ -685,6 +934,11 @@ ys_free1(yang_stmt *ys,
         free(ys->ys_when_xpath);
     if (ys->ys_when_nsc)
         cvec_free(ys->ys_when_nsc);
+    if (ys->ys_xpcache)
+        xpath_tree_free(ys->ys_xpcache);
+    if (ys->ys_nscache)
+        cvec_free(ys->ys_nscache);
+    yang_findcache_clear(ys);
     if (ys->ys_stmt)
         free(ys->ys_stmt);
     if (ys->ys_filename)
@@ -722,6 +976,7 @@ ys_prune(yang_stmt *yp,
     
     if (i >= yp->ys_len)
         goto done;
+    yang_findcache_clear(yp);
     yc = yp->ys_stmt[i];
     if (i < yp->ys_len - 1){
         size = (yp->ys_len - i - 1)*sizeof(struct yang_stmt *);
@@ -779,6 +1034,7 @@ ys_freechildren(yang_stmt *ys)
     int i;
     yang_stmt *yc;
     
+    yang_findcache_clear(ys);
     for (i=0; i<ys->ys_len; i++){
         if ((yc = ys->ys_stmt[i]) != NULL)
             ys_free(yc);
@@ -805,9 +1061,10 @@ ys_free(yang_stmt *ys)
 }
 
 /*! Allocate larger yang statement vector adding empty field last */
-static int 
+static int
 yn_realloc(yang_stmt *yn)
 {
+    yang_findcache_clear(yn);
     yn->ys_len++;
 
     if ((yn->ys_stmt = realloc(yn->ys_stmt, (yn->ys_len)*sizeof(yang_stmt *))) == 0){
@@ -882,6 +1139,12 @@ ys_cp(yang_stmt *ynew,
             goto done;
         }
     }
+    ynew->ys_xpcache = NULL; /* Recompiled after copies are done, see ys_precompile_xpath */
+    ynew->ys_nscache = NULL; /* Lazily rebuilt on demand, dont share with yold */
+    ynew->ys_dncache = NULL; /* As nscache */
+    ynew->ys_sncache = NULL;
+    ynew->ys_vcache = NULL;
+    ynew->ys_abscache = NULL;
     for (i=0; i<ynew->ys_len; i++){
         yco = yold->ys_stmt[i];
         if ((ycn = ys_dup(yco)) == NULL)
@@ -957,6 +1220,7 @@ ys_replace(yang_stmt *yorig,
     if (ys_cp(yorig, yfrom) < 0)
         goto done;
     yorig->ys_parent = yp;
+    yang_findcache_clear(yp); /* yorig may have changed name */
     retval = 0;
  done:
     return retval;
@@ -1119,6 +1383,140 @@ yang_match(yang_stmt *yn,
 }
 
 
+/*! Add one entry to a child find cache unless the name is already taken
+ * First name wins, preserving the order of the linear search it replaces.
+ */
+static int
+yang_findcache_add(clicon_hash_t *fc,
+                   yang_stmt     *yc,
+                   const char    *name)
+{
+    if (name == NULL)
+        return 0;
+    if (clicon_hash_lookup(fc, name) != NULL)
+        return 0;
+    if (clicon_hash_add(fc, name, &yc, sizeof(yc)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Collect data-node children of yn into a find cache
+ * Flattens choice/case and input/output in the same order as the linear
+ * search in yang_find_datanode.
+ */
+static int
+yang_dncache_collect(clicon_hash_t *fc,
+                     yang_stmt     *yn)
+{
+    yang_stmt *ys = NULL;
+    yang_stmt *yc;
+
+    while ((ys = yn_each(yn, ys)) != NULL){
+        if (yang_keyword_get(ys) == Y_CHOICE){
+            yc = NULL;
+            while ((yc = yn_each(ys, yc)) != NULL){
+                if (yang_keyword_get(yc) == Y_CASE){
+                    if (yang_dncache_collect(fc, yc) < 0)
+                        return -1;
+                }
+                else if (yang_datanode(yc) &&
+                         yang_findcache_add(fc, yc, yang_argument_get(yc)) < 0)
+                    return -1;
+            }
+        }
+        else if (yang_keyword_get(ys) == Y_INPUT ||
+                 yang_keyword_get(ys) == Y_OUTPUT){
+            if (yang_dncache_collect(fc, ys) < 0)
+                return -1;
+        }
+        else if (yang_datanode(ys) &&
+                 yang_findcache_add(fc, ys, yang_argument_get(ys)) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Lazily build the data-node child find cache of yn
+ * @retval  fc   The built cache, also stored in yn
+ * @retval  NULL Error, caller falls back to linear search
+ */
+static clicon_hash_t *
+yang_dncache_build(yang_stmt *yn)
+{
+    clicon_hash_t *fc;
+
+    if ((fc = clicon_hash_init()) == NULL)
+        return NULL;
+    if (yang_dncache_collect(fc, yn) < 0){
+        clicon_hash_free(fc);
+        return NULL;
+    }
+    yn->ys_dncache = fc;
+    return fc;
+}
+
+/*! Collect schema-node children of yn into a find cache
+ * Same order and semantics as the linear search in yang_find_schemanode:
+ * choice names themselves match, as do "input"/"output".
+ */
+static int
+yang_sncache_collect(clicon_hash_t *fc,
+                     yang_stmt     *yn)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    int        i, j;
+
+    for (i=0; i<yn->ys_len; i++){
+        ys = yn->ys_stmt[i];
+        if (yang_keyword_get(ys) == Y_CHOICE){
+            if (yang_findcache_add(fc, ys, yang_argument_get(ys)) < 0)
+                return -1;
+            for (j=0; j<ys->ys_len; j++){
+                yc = ys->ys_stmt[j];
+                if (yang_keyword_get(yc) == Y_CASE){
+                    if (yang_sncache_collect(fc, yc) < 0)
+                        return -1;
+                }
+                else if (yang_schemanode(yc) &&
+                         yang_findcache_add(fc, yc, yang_argument_get(yc)) < 0)
+                    return -1;
+            }
+        }
+        else if (yang_schemanode(ys)){
+            if (yang_keyword_get(ys) == Y_INPUT){
+                if (yang_findcache_add(fc, ys, "input") < 0)
+                    return -1;
+            }
+            else if (yang_keyword_get(ys) == Y_OUTPUT){
+                if (yang_findcache_add(fc, ys, "output") < 0)
+                    return -1;
+            }
+            else if (yang_findcache_add(fc, ys, yang_argument_get(ys)) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Lazily build the schema-node child find cache of yn
+ * @see yang_dncache_build
+ */
+static clicon_hash_t *
+yang_sncache_build(yang_stmt *yn)
+{
+    clicon_hash_t *fc;
+
+    if ((fc = clicon_hash_init()) == NULL)
+        return NULL;
+    if (yang_sncache_collect(fc, yn) < 0){
+        clicon_hash_free(fc);
+        return NULL;
+    }
+    yn->ys_sncache = fc;
+    return fc;
+}
+
 /*! Find child data node with matching argument (container, leaf, list, leaf-list)
  *
  * @param[in]  yn         Yang node, current context node.
@@ -1140,6 +1538,19 @@ yang_find_datanode(yang_stmt *yn,
     yang_stmt *ysmatch = NULL;
     char      *name;
 
+    if (argument != NULL && yn != NULL){
+        if (yn->ys_dncache == NULL)
+            yang_dncache_build(yn); /* Best effort, on failure fall back to linear search */
+        if (yn->ys_dncache != NULL){
+            yang_stmt **ysp;
+
+            if ((ysp = clicon_hash_value(yn->ys_dncache, argument, NULL)) != NULL){
+                ysmatch = *ysp;
+                goto done;
+            }
+            goto includes; /* Miss: only submodules can still match */
+        }
+    }
     ys = NULL;
     while ((ys = yn_each(yn, ys)) != NULL){
         if (yang_keyword_get(ys) == Y_CHOICE){ /* Look for its children */
@@ -1173,6 +1584,7 @@ yang_find_datanode(yang_stmt *yn,
     }
     /* Special case: if not match and yang node is module or submodule, extend
      * search to include submodules */
+ includes:
     if (ysmatch == NULL &&
         (yang_keyword_get(yn) == Y_MODULE ||
          yang_keyword_get(yn) == Y_SUBMODULE)){
@@ -1209,9 +1621,22 @@ yang_find_schemanode(yang_stmt *yn,
     char      *name;
     int        i, j;
 
+    if (argument != NULL){
+        if (yn->ys_sncache == NULL)
+            yang_sncache_build(yn); /* Best effort, on failure fall back to linear search */
+        if (yn->ys_sncache != NULL){
+            yang_stmt **ysp;
+
+            if ((ysp = clicon_hash_value(yn->ys_sncache, argument, NULL)) != NULL){
+                ysmatch = *ysp;
+                goto match;
+            }
+            goto includes; /* Miss: only submodules can still match */
+        }
+    }
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
-        if (yang_keyword_get(ys) == Y_CHOICE){ 
+        if (yang_keyword_get(ys) == Y_CHOICE){
             /* First check choice itself */
             if (ys->ys_argument && strcmp(argument, ys->ys_argument) == 0){
                 ysmatch = ys;
@@ -1251,6 +1676,7 @@ yang_find_schemanode(yang_stmt *yn,
     }
     /* Special case: if not match and yang node is module or submodule, extend
      * search to include submodules */
+ includes:
     if (ysmatch == NULL &&
         (yang_keyword_get(yn) == Y_MODULE ||
          yang_keyword_get(yn) == Y_SUBMODULE)){
@@ -1808,6 +2234,40 @@ ys_real_module(yang_stmt  *ys,
     return retval;
 }
 
+/*! Get the module name used when JSON-encoding a node, cached on the yang stmt
+ *
+ * JSON encodes namespaces as "module-name:name" prefixes, see RFC 7951.
+ * The name is the real module of the node (see ys_real_module) with the
+ * ietf-netconf -> ietf-restconf special case applied, computed once per yang
+ * node and cached, so per-node JSON output does not walk the yang ancestry.
+ * Nodes of the same module share the cached pointer, so callers can compare
+ * module names by pointer before falling back to strcmp.
+ * @param[in] ys   Yang statement
+ * @retval    name Module name for JSON encoding, do not free
+ * @retval    NULL Error or no module (eg ys is a spec)
+ * @see xml2json1_cbuf
+ */
+char *
+yang_json_modname(yang_stmt *ys)
+{
+    yang_stmt *ymod = NULL;
+    char      *modname;
+
+    if (ys->ys_jsonmcache != NULL)
+        return ys->ys_jsonmcache;
+    if (ys_real_module(ys, &ymod) < 0 || ymod == NULL)
+        return NULL;
+    modname = yang_argument_get(ymod);
+    /* Special case for ietf-netconf -> ietf-restconf translation
+     * A special case is for return data on the form {"data":...}
+     * See also json_xmlns_translate()
+     */
+    if (strcmp(modname, "ietf-netconf") == 0)
+        modname = "ietf-restconf";
+    ys->ys_jsonmcache = modname;
+    return modname;
+}
+
 /*! Find top of tree, the yang specification from within the tree
  * @param[in] ys    Any yang statement in a yang tree
  * @retval    yspec The top yang specification
@@ -2038,6 +2498,7 @@ yang_deviation(yang_stmt *ys,
     yang_stmt    *ytc;
     char         *devop;
     clicon_handle h = (clicon_handle)arg;
+    yang_stmt    *yspec;
     enum rfc_6020 kw;
     int           min;
     int           max;
@@ -2068,6 +2529,12 @@ yang_deviation(yang_stmt *ys,
             continue;
         devop = yang_argument_get(yd);
         if (strcmp(devop, "not-supported") == 0){
+            /* Removes a subtree: memoized absolute schema-node-id targets may point
+             * into it, flush the whole memo, see yang_abs_schema_nodeid */
+            if ((yspec = ys_spec(ys)) != NULL && yspec->ys_abscache != NULL){
+                clicon_hash_free(yspec->ys_abscache);
+                yspec->ys_abscache = NULL;
+            }
             if (ys_prune_self(ytarget) < 0)
                 goto done;
             if (ys_free(ytarget) < 0)
@@ -2974,6 +3441,7 @@ yang_features(clicon_handle h,
                         yang_flag_set(ys, YANG_FLAG_DISABLED);
                         break;
                     }
+                    yang_findcache_clear(yt);
                     for (j=i+1; j<yt->ys_len; j++)
                         yt->ys_stmt[j-1] = yt->ys_stmt[j];
                     yt->ys_len--;
@@ -3185,11 +3653,14 @@ yang_abs_schema_nodeid(yang_stmt    *yn,
     int           retval = -1;
     cvec         *nodeid_cvv = NULL;
     cvec         *nsc = NULL;
+    cbuf         *cbkey = NULL;
     cg_var       *cv;
     char         *prefix;
     char         *ns;
     yang_stmt    *yspec;
     yang_stmt    *ymod;
+    yang_stmt    *ymod0;
+    yang_stmt   **yresp;
     char         *str;
 
     if ((yspec = ys_spec(yn)) == NULL){
@@ -3202,6 +3673,24 @@ yang_abs_schema_nodeid(yang_stmt    *yn,
         clicon_err(OE_YANG, EINVAL, "absolute schema nodeid should start with /");
         goto done;
     }
+    /* Memo: prefixes are local to the module where the nodeid is written, so the same
+     * nodeid string resolved from the same module always yields the same target. With
+     * many modules augmenting/deviating the same targets this skips the repeated
+     * parse, namespace context build and tree walk. Entries are flushed when nodes
+     * are removed, see yang_deviation and yang_findcache_clear.
+     */
+    if ((ymod0 = ys_module(yn)) != NULL){
+        if ((cbkey = cbuf_new()) == NULL){
+            clicon_err(OE_UNIX, errno, "cbuf_new");
+            goto done;
+        }
+        cprintf(cbkey, "%s %s", yang_argument_get(ymod0), schema_nodeid);
+        if (yspec->ys_abscache != NULL &&
+            (yresp = (yang_stmt**)clicon_hash_value(yspec->ys_abscache, cbuf_get(cbkey), NULL)) != NULL){
+            *yres = *yresp;
+            goto ok;
+        }
+    }
     /* Split nodeid on the form /p0:i0/p1:i1 to a cvec with [name:p0 value:i0][...]
      */
     if (uri_str2cvec(schema_nodeid, '/', ':', 1, &nodeid_cvv) < 0)
@@ -3246,9 +3735,20 @@ yang_abs_schema_nodeid(yang_stmt    *yn,
     /* Iterate through cvv to find schemanode using ymod as starting point (since it is absolute) */
     if (schema_nodeid_iterate(ymod, yspec, nodeid_cvv, nsc, yres) < 0)
         goto done;
+    /* Memoize resolved target. Misses are not cached: the target may appear later,
+     * eg added by an augment in a module not yet applied */
+    if (cbkey != NULL && *yres != NULL){
+        if (yspec->ys_abscache == NULL &&
+            (yspec->ys_abscache = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_hash_add(yspec->ys_abscache, cbuf_get(cbkey), yres, sizeof(*yres)) == NULL)
+            goto done;
+    }
  ok:
     retval = 0;
  done:
+    if (cbkey)
+        cbuf_free(cbkey);
     if (nodeid_cvv)
         cvec_free(nodeid_cvv);
     if (nsc)
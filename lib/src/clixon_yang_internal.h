@@ -101,6 +101,30 @@ struct yang_stmt{
     yang_type_cache   *ys_typecache; /* If ys_keyword==Y_TYPE, cache all typedef data except unions */
     char              *ys_when_xpath; /* Special conditional for a "when"-associated augment/uses xpath */
     cvec              *ys_when_nsc;   /* Special conditional for a "when"-associated augment/uses namespace ctx */
+    struct xpath_tree *ys_xpcache;    /* Compiled when/must xpath: the argument of Y_WHEN/Y_MUST or
+                                         ys_when_xpath. Compiled once after grouping/augment expansion
+                                         since it does not follow yang tree copies (see ys_cp),
+                                         see ys_precompile_xpath() */
+    cvec              *ys_nscache;    /* Lazily built prefix/namespace map: on (sub)modules the
+                                         import map (see xml_nsctx_yang()), on specs the canonical
+                                         table (see xml_nsctx_yangspec_canonical()) */
+    clicon_hash_t     *ys_dncache;    /* Lazily built hash: data-node child name -> yang_stmt*,
+                                         flattened through choice/case and input/output.
+                                         Cleared on any child mutation, see yang_find_datanode() */
+    clicon_hash_t     *ys_sncache;    /* As ys_dncache but for schema-node children,
+                                         see yang_find_schemanode() */
+    clicon_hash_t     *ys_vcache;     /* Lazily built hash of valid value strings:
+                                         on a base Y_IDENTITY the derived <module>:<id> set,
+                                         on a resolved Y_TYPE the enum/bit names,
+                                         see yang_valcache_lookup() */
+    clicon_hash_t     *ys_abscache;   /* Lazily built memo on specs only: resolving module +
+                                         absolute schema-node-id string -> target yang_stmt.
+                                         Flushed when a schema node is removed (deviation
+                                         not-supported) or the module set mutates,
+                                         see yang_abs_schema_nodeid() */
+    char              *ys_jsonmcache; /* Lazily cached module name for JSON encoding,
+                                         not owned: points into the real module's argument
+                                         (or a literal), see yang_json_modname() */
     char              *ys_filename;   /* For debug/errors: filename (only (sub)modules) */
     int                ys_linenum;    /* For debug/errors: line number (in ys_filename) */
     rpc_callback_t    *ys_action_cb;  /* Action callback list, only for Y_ACTION */
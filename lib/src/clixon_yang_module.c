@@ -349,17 +349,31 @@ yang_modules_state_get(clicon_handle    h,
     msid = clicon_option_str(h, "CLICON_MODULE_SET_ID"); /* In RFC 8525 changed to "content-id" */
     if ((xc = clicon_modst_cache_get(h, brief)) != NULL){
         cxobj *xw; /* tmp top wrap object */
-        /* xc is here: <modules-state>... 
+        cxobj *xmatch;
+        int    whole = 0;
+        /* xc is here: <modules-state>...
          * need to wrap it for xpath: <top><modules-state> */
         /* xc is also original tree, need to copy it */
         if ((xw = xml_wrap(xc, "top")) == NULL)
             goto done;
-        if (xpath_first(xw, nsc, "%s", xpath)){
-            if ((x = xml_dup(xc)) == NULL) /* Make copy and use below */
+        if ((xmatch = xpath_first(xw, nsc, "%s", xpath)) != NULL){
+            if (xmatch == xc)
+                whole = 1; /* Entire cached subtree selected, common NMS poll */
+            else if ((x = xml_dup(xc)) == NULL) /* Make copy and use below */
                 goto done;
         }
         if (xml_rootchild_node(xw, xc) < 0)  /* Unwrap x / free xw */
             goto done;
+        if (whole){
+            /* Fast path: merge straight from the cache, skipping the
+             * per-request dup + mark + prune pass over all module entries */
+            if ((ret = netconf_trymerge(xc, yspec, xret)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            retval = 1;
+            goto done;
+        }
     }
     else { /* No cache -> build the tree */
         if ((cb = cbuf_new()) == NULL){
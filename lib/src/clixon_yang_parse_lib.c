@@ -523,6 +523,7 @@ yang_expand_uses_node(yang_stmt *yn,
     yang_stmt *ygrouping;  /* grouping original */
     yang_stmt *ygrouping2; /* grouping copy */
     yang_stmt *yg;         /* grouping child */
+    yang_stmt *yg2;        /* grouping child copy */
     yang_stmt *yr;         /* refinement */
     yang_stmt *yp;
     int        glen;
@@ -564,21 +565,34 @@ yang_expand_uses_node(yang_stmt *yn,
         if (yang_expand_grouping(ygrouping) < 0)
             goto done;
     }
-    /* Make a copy of the grouping, then make refinements to this copy
+    /* Make a copy of the grouping, then make refinements to this copy.
+     * Only data/schemanodes and unknowns are spliced into the uses site: copy only those
+     * and skip typedefs, sub-groupings and meta statements, which would otherwise be
+     * deep-copied and immediately freed again at every use site.
      * Note this ygrouping2 object does not have a parent and does not work in many
      * functions which assume a full hierarchy, use the original ygrouping in those cases.
+     * glen is the number of copied nodes, the child vector is extended with that below.
      */
-    if ((ygrouping2 = ys_dup(ygrouping)) == NULL)
+    if ((ygrouping2 = ys_new(Y_GROUPING)) == NULL)
         goto done;
-
-    /* Only replace data/schemanodes and unknowns:
-     * Compute the number of such nodes, and extend the child vector with that below
-     */
+    ygrouping2->ys_mymodule = ygrouping->ys_mymodule;
+    if (yang_argument_get(ygrouping) &&
+        (ygrouping2->ys_argument = strdup(yang_argument_get(ygrouping))) == NULL){
+        clicon_err(OE_YANG, errno, "strdup");
+        goto done;
+    }
     glen = 0;
     yg = NULL;
-    while ((yg = yn_each(ygrouping2, yg)) != NULL) {
-        if (yang_schemanode(yg) || yang_keyword_get(yg) == Y_UNKNOWN)
-            glen++;
+    while ((yg = yn_each(ygrouping, yg)) != NULL) {
+        if (!yang_schemanode(yg) && yang_keyword_get(yg) != Y_UNKNOWN)
+            continue;
+        if ((yg2 = ys_dup(yg)) == NULL)
+            goto done;
+        if (yn_insert(ygrouping2, yg2) < 0){
+            ys_free(yg2);
+            goto done;
+        }
+        glen++;
     }
     /* 
      * yn is parent: the children of ygrouping replaces ys.
@@ -824,36 +838,39 @@ yang_parse_file(FILE       *fp,
                 yang_stmt  *yspec)
 {
     char         *buf = NULL;
-    int           i;
-    char          c;
-    int           len;
+    size_t        i;
+    size_t        len;
+    size_t        nr;
     yang_stmt    *ymod = NULL;
-    int           ret;
+    struct stat   st;
 
-    len = BUFLEN; /* any number is fine */
+    /* Size the buffer from the file length when known, with two spare bytes so a
+     * regular file is read in a single fread without triggering the grow path.
+     * Pipes and other non-regular files fall back to the doubling loop. */
+    if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        len = st.st_size + 2;
+    else
+        len = BUFLEN; /* any number is fine */
     if ((buf = malloc(len)) == NULL){
         clicon_err(OE_XML, errno, "malloc");
         goto done;
     }
-    memset(buf, 0, len);
     i = 0; /* position in buf */
-    while (1){ /* read the whole file */
-        if ((ret = fread(&c, 1, 1, fp)) < 0){
-            clicon_err(OE_XML, errno, "read");
-            break;
-        }
-        if (ret == 0)
-            break; /* eof */
+    while ((nr = fread(buf+i, 1, len-1-i, fp)) > 0){ /* read the whole file */
+        i += nr;
         if (i == len-1){
             if ((buf = realloc(buf, 2*len)) == NULL){
                 clicon_err(OE_XML, errno, "realloc");
                 goto done;
-            }       
-            memset(buf+len, 0, len);
+            }
             len *= 2;
         }
-        buf[i++] = (char)(c&0xff);
-    } /* read a line */
+    }
+    if (ferror(fp)){
+        clicon_err(OE_XML, errno, "read");
+        goto done;
+    }
+    buf[i] = '\0';
     if ((ymod = yang_parse_str(buf, name, yspec)) < 0)
         goto done;
   done:
@@ -900,113 +917,346 @@ filename2revision(const char *filename,
     return retval;
 }
 
-/*! No specific revision give. Match a yang file given module 
+/* Name of handle data entry holding the YANG search-path file index */
+#define YANG_FILE_INDEX_NAME "yang-file-index"
+
+/*! Per-directory entry of the YANG search-path file index
+ * One entry per CLICON_YANG_MAIN_DIR / CLICON_YANG_DIR element, in config
+ * order, so the directory precedence of the original per-module scans is kept.
+ */
+struct yang_file_dir{
+    struct yang_file_dir *yfd_next;
+    clicon_hash_t        *yfd_modules; /* module name -> cvec* of its files, each cv:
+                                        * name is file basename, string value is path */
+};
+
+/*! YANG search-path file index cached on the clicon handle
+ * Built lazily on first yang_file_find_match() call so that each directory is
+ * scanned once per corpus load instead of once per resolved (sub)module.
+ * Rebuilt if the clixon config tree is replaced, which happens between the
+ * bootstrap and the proper config file parse.
+ */
+struct yang_file_index{
+    cxobj                *yfi_conf; /* Config tree the index was built from */
+    struct yang_file_dir *yfi_dirs; /* Directories in config order */
+};
+
+/*! Free a YANG file index structure
+ */
+static int
+yang_file_index_free1(struct yang_file_index *yfi)
+{
+    struct yang_file_dir *yfd;
+    char                **keys;
+    size_t                nkeys;
+    size_t                i;
+    cvec                **filesp;
+
+    while ((yfd = yfi->yfi_dirs) != NULL){
+        yfi->yfi_dirs = yfd->yfd_next;
+        if (yfd->yfd_modules){
+            keys = NULL;
+            nkeys = 0;
+            if (clicon_hash_keys(yfd->yfd_modules, &keys, &nkeys) == 0){
+                for (i=0; i<nkeys; i++)
+                    if ((filesp = clicon_hash_value(yfd->yfd_modules, keys[i], NULL)) != NULL)
+                        cvec_free(*filesp);
+                if (keys)
+                    free(keys);
+            }
+            clicon_hash_free(yfd->yfd_modules);
+        }
+        free(yfd);
+    }
+    free(yfi);
+    return 0;
+}
+
+/*! Add one yang file to a per-directory module index
+ * The module (or submodule) name is the basename up to '@' or the .yang
+ * suffix; all files of a module land in one cvec so a lookup only compares the
+ * revisions of that module instead of every file in the directory.
+ * @param[in]  hash  Module name to cvec* of files
+ * @param[in]  name  File basename
+ * @param[in]  path  Full file path
+ * @retval     0     OK (files not on module[@revision].yang form are skipped)
+ * @retval    -1     Error
+ */
+static int
+yang_file_index_add(clicon_hash_t *hash,
+                    const char    *name,
+                    const char    *path)
+{
+    int         retval = -1;
+    char        module[MAXPATHLEN];
+    size_t      len;
+    const char *p;
+    cvec       *files = NULL;
+    cvec      **filesp;
+
+    if ((p = strchr(name, '@')) == NULL){
+        len = strlen(name);
+        if (len < 5 || strcmp(name + len - 5, ".yang") != 0)
+            goto ok; /* Can never match a module lookup */
+        len -= 5;
+    }
+    else
+        len = p - name;
+    if (len == 0 || len >= sizeof(module))
+        goto ok;
+    memcpy(module, name, len);
+    module[len] = '\0';
+    if ((filesp = clicon_hash_value(hash, module, NULL)) != NULL)
+        files = *filesp;
+    else{
+        if ((files = cvec_new(0)) == NULL){
+            clicon_err(OE_UNIX, errno, "cvec_new");
+            goto done;
+        }
+        if (clicon_hash_add(hash, module, &files, sizeof(files)) == NULL){
+            cvec_free(files);
+            goto done;
+        }
+    }
+    if (cvec_add_string(files, (char*)name, (char*)path) < 0){
+        clicon_err(OE_UNIX, errno, "cvec_add_string");
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Free the YANG search-path file index cached on the handle, if any
+ * @param[in]  h   CLICON handle
+ * @retval     0   OK
+ */
+int
+yang_file_index_free(clicon_handle h)
+{
+    struct yang_file_index *yfi = NULL;
+
+    if (clicon_ptr_get(h, YANG_FILE_INDEX_NAME, (void**)&yfi) == 0 &&
+        yfi != NULL){
+        yang_file_index_free1(yfi);
+        clicon_ptr_set(h, YANG_FILE_INDEX_NAME, NULL);
+    }
+    return 0;
+}
+
+/*! Scan all YANG search-path directories once and build a file index
+ * @param[in]  x     Clixon config tree (for CLICON_YANG_MAIN_DIR/CLICON_YANG_DIR)
+ * @param[out] yfip  Malloced index, use yang_file_index_free1() to free
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+yang_file_index_build(cxobj                   *x,
+                      struct yang_file_index **yfip)
+{
+    int                     retval = -1;
+    struct yang_file_index *yfi = NULL;
+    struct yang_file_dir   *yfd;
+    struct yang_file_dir  **yfdp;
+    cxobj                  *xc;
+    char                   *dir;
+    struct dirent          *dp = NULL;
+    int                     ndp;
+    int                     i;
+    char                    path[MAXPATHLEN];
+    cvec                   *tmp = NULL;
+    cg_var                 *cv;
+
+    if ((yfi = malloc(sizeof(*yfi))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(yfi, 0, sizeof(*yfi));
+    yfi->yfi_conf = x;
+    yfdp = &yfi->yfi_dirs;
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
+        if (strcmp(xml_name(xc), "CLICON_YANG_MAIN_DIR") != 0 &&
+            strcmp(xml_name(xc), "CLICON_YANG_DIR") != 0)
+            continue;
+        if ((dir = xml_body(xc)) == NULL)
+            continue;
+        if ((yfd = malloc(sizeof(*yfd))) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(yfd, 0, sizeof(*yfd));
+        if ((yfd->yfd_modules = clicon_hash_init()) == NULL){
+            free(yfd);
+            goto done;
+        }
+        *yfdp = yfd;
+        yfdp = &yfd->yfd_next;
+        if (strcmp(xml_name(xc), "CLICON_YANG_MAIN_DIR") == 0){
+            /* get all yang files in this directory */
+            if ((ndp = clicon_file_dirent(dir, &dp, "(.yang)$", S_IFREG)) < 0)
+                goto done;
+            for (i = 0; i < ndp; i++){
+                snprintf(path, MAXPATHLEN-1, "%s/%s", dir, dp[i].d_name);
+                if (yang_file_index_add(yfd->yfd_modules, dp[i].d_name, path) < 0)
+                    goto done;
+            }
+            if (dp){
+                free(dp);
+                dp = NULL;
+            }
+        }
+        else{ /* CLICON_YANG_DIR */
+            /* get all yang files in this directory recursively */
+            if ((tmp = cvec_new(0)) == NULL){
+                clicon_err(OE_UNIX, errno, "cvec_new");
+                goto done;
+            }
+            if (clicon_files_recursive(dir, "(.yang)$", tmp) < 0)
+                goto done;
+            cv = NULL;
+            while ((cv = cvec_each(tmp, cv)) != NULL)
+                if (yang_file_index_add(yfd->yfd_modules,
+                                        cv_name_get(cv), cv_string_get(cv)) < 0)
+                    goto done;
+            cvec_free(tmp);
+            tmp = NULL;
+        }
+    }
+    *yfip = yfi;
+    yfi = NULL;
+    retval = 0;
+ done:
+    if (dp)
+        free(dp);
+    if (tmp)
+        cvec_free(tmp);
+    if (yfi)
+        yang_file_index_free1(yfi);
+    return retval;
+}
+
+/*! Match one yang filename against module name and optional revision
+ * Same matching as the regexps previously applied when scanning:
+ *   ^module@revision(.yang)$                                  if revision given
+ *   ^module(@[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9])?(.yang)$  otherwise
+ * @retval     1    Match
+ * @retval     0    No match
+ */
+static int
+yang_filename_match(const char *name,
+                    const char *module,
+                    const char *revision)
+{
+    size_t      len;
+    const char *p;
+    int         i;
+
+    len = strlen(module);
+    if (strncmp(name, module, len) != 0)
+        return 0;
+    p = name + len;
+    if (revision != NULL){
+        if (*p != '@')
+            return 0;
+        p++;
+        len = strlen(revision);
+        if (strncmp(p, revision, len) != 0)
+            return 0;
+        p += len;
+        return strcmp(p, ".yang") == 0;
+    }
+    if (strcmp(p, ".yang") == 0)
+        return 1;
+    if (*p != '@')
+        return 0;
+    p++;
+    /* revision-date ::= 4DIGIT "-" 2DIGIT "-" 2DIGIT */
+    for (i = 0; i < 10; i++){
+        if (i == 4 || i == 7){
+            if (p[i] != '-')
+                return 0;
+        }
+        else if (!isdigit((unsigned char)p[i]))
+            return 0;
+    }
+    return strcmp(p+10, ".yang") == 0;
+}
+
+/*! No specific revision give. Match a yang file given module
  * @param[in]  h        CLICON handle
- * @param[in]  module   Name of main YANG module. 
+ * @param[in]  module   Name of main YANG module.
  * @param[in]  revision Revision or NULL
  * @param[out] fbuf     Buffer containing filename or NULL (if retval=1)
  * @retval     1        Match found, Most recent entry returned in fbuf
  * @retval     0        No matching entry found
- * @retval    -1        Error 
+ * @retval    -1        Error
  * @note for bootstrapping, dir may have to be set.
+ * The lookup is answered from a file index built by scanning all search-path
+ * directories once, see struct yang_file_index.
 */
 int
-yang_file_find_match(clicon_handle h, 
+yang_file_find_match(clicon_handle h,
                      const char   *module,
                      const char   *revision,
-                     cbuf         *fbuf)    
+                     cbuf         *fbuf)
 {
-    int           retval = -1;
-    cbuf         *regex = NULL;
-    cxobj        *x;
-    cxobj        *xc;
-    char         *dir;
-    cvec         *cvv = NULL;
-    cg_var       *cv = NULL;
-    cg_var       *bestcv = NULL;
+    int                     retval = -1;
+    cxobj                  *x;
+    struct yang_file_index *yfi = NULL;
+    struct yang_file_dir   *yfd;
+    cvec                  **filesp;
+    cg_var                 *cv;
+    cg_var                 *bestcv;
 
     /* get clicon config file in xml form */
     if ((x = clicon_conf_xml(h)) == NULL)
         goto ok;
-    if ((regex = cbuf_new()) == NULL){
-        clicon_err(OE_YANG, errno, "cbuf_new");
+    if (clicon_ptr_get(h, YANG_FILE_INDEX_NAME, (void**)&yfi) < 0)
         goto done;
+    if (yfi && yfi->yfi_conf != x){ /* config tree replaced: index is stale */
+        yang_file_index_free(h);
+        yfi = NULL;
     }
-    /* RFC 6020: The name of the file SHOULD be of the form:
-     * module-or-submodule-name ['@' revision-date] ( '.yang' / '.yin' )
-     * revision-date ::= 4DIGIT "-" 2DIGIT "-" 2DIGIT
+    if (yfi == NULL){
+        if (yang_file_index_build(x, &yfi) < 0)
+            goto done;
+        if (clicon_ptr_set(h, YANG_FILE_INDEX_NAME, yfi) < 0){
+            yang_file_index_free1(yfi);
+            goto done;
+        }
+    }
+    /* Directories are tried in config order, first directory with a match wins,
+     * as when the directories were scanned per lookup
      */
-    if (revision)
-        cprintf(regex, "^%s@%s(.yang)$", module, revision);
-    else
-        cprintf(regex, "^%s(@[0-9][0-9][0-9][0-9]-[0-9][0-9]-[0-9][0-9])?(.yang)$",
-                module);
-    xc = NULL;
-
-    while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL) {
-        if (strcmp(xml_name(xc), "CLICON_YANG_MAIN_DIR") == 0){
-            struct dirent *dp = NULL;
-            int ndp;
-
-            dir = xml_body(xc);
-            /* get all matching files in this directory */
-            if ((ndp = clicon_file_dirent(dir, 
-                                          &dp, 
-                                          cbuf_get(regex),
-                                          S_IFREG)) < 0)
-                goto done;
-            /* Entries are sorted, last entry should be most recent date 
-             */
-            if (ndp != 0){
-                if (fbuf)
-                    cprintf(fbuf, "%s/%s", dir, dp[ndp-1].d_name);
-                if (dp)
-                    free(dp);
-                retval = 1;
-                goto done;
-            }
-            if (dp)
-                free(dp);
+    for (yfd = yfi->yfi_dirs; yfd; yfd = yfd->yfd_next){
+        /* RFC 6020: The name of the file SHOULD be of the form:
+         * module-or-submodule-name ['@' revision-date] ( '.yang' / '.yin' )
+         * Only this module's revisions are compared: find latest name and use
+         * path as return value
+         */
+        if ((filesp = clicon_hash_value(yfd->yfd_modules, module, NULL)) == NULL)
+            continue; /* No file of this module in this directory */
+        bestcv = NULL;
+        cv = NULL;
+        while ((cv = cvec_each(*filesp, cv)) != NULL){
+            if (yang_filename_match(cv_name_get(cv), module, revision) == 0)
+                continue;
+            if (bestcv == NULL ||
+                strcoll(cv_name_get(cv), cv_name_get(bestcv)) > 0)
+                bestcv = cv;
         }
-        else if (strcmp(xml_name(xc), "CLICON_YANG_DIR") == 0 &&
-                 (dir = xml_body(xc)) != NULL){
-            /* get all matching files in this directory recursively */
-            if ((cvv = cvec_new(0)) == NULL){
-                clicon_err(OE_UNIX, errno, "cvec_new");
-                goto done;
-            }
-            if (clicon_files_recursive(dir, cbuf_get(regex), cvv) < 0)
-                goto done;
-
-            /* Entries are not sorted and come in a vector: <name,path>.
-             * Find latest name and use path as return value
-             */
-            bestcv = NULL;
-            while ((cv = cvec_each(cvv, cv)) != NULL){
-                if (bestcv == NULL)
-                    bestcv = cv;
-                else if (strcoll(cv_name_get(cv), cv_name_get(bestcv)) > 0)
-                    bestcv = cv;
-            }
-            if (bestcv){
-                if (fbuf)
-                    cprintf(fbuf, "%s", cv_string_get(bestcv));      /* file path */
-                retval = 1; /* found */
-                goto done;
-            }
-            if (cvv){
-                cvec_free(cvv);
-                cvv = NULL;
-            }
+        if (bestcv){
+            if (fbuf)
+                cprintf(fbuf, "%s", cv_string_get(bestcv));      /* file path */
+            retval = 1; /* found */
+            goto done;
         }
     }
-ok:
+ ok:
     retval = 0;
-done:
-    if (cvv)
-        cvec_free(cvv);
-    if (regex)
-        cbuf_free(regex);
+ done:
     return retval;
 }
 
@@ -1562,6 +1812,21 @@ yang_parse_post(clicon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+
+    /* 12. Pre-compile pattern regexps. Must be done after grouping/augment
+     *     since compiled regexps do not follow yang tree copies
+     *     (see yang_type_cache_cp), so that validation does not compile lazily
+     */
+    for (i=0; i<ylen; i++)
+        if (yang_apply(ylist[i], Y_TYPE, ys_precompile_regexps, 1, (void*)h) < 0)
+            goto done;
+    /* 13. Pre-compile when/must xpaths, same motivation as step 12: compiled
+     *     trees do not follow yang tree copies (see ys_cp), so that validation
+     *     evaluates pre-parsed expressions only
+     */
+    for (i=0; i<ylen; i++)
+        if (yang_apply(ylist[i], -1, ys_precompile_xpath, 1, NULL) < 0)
+            goto done;
     retval = 0;
  done:
     if (ylist)
@@ -180,6 +180,96 @@ xml_yang_mount_get(cxobj      *x,
     goto done;
 }
 
+/*
+ * Sharing of resolved yspecs across mount-points with identical yang-library
+ * content. Parsing and resolving a full schema set per mount-point multiplies
+ * schema memory by the number of mount-points even when they all mount the
+ * same modules (eg one logical-device list). Instead, the resolved yspec is
+ * registered here under its serialized yang-library content and reused, with
+ * a reference count of the mount-points using it. The shared yspec is treated
+ * as immutable; per-mount state lives in the mount cvec as before.
+ */
+struct mount_yspec_share{
+    struct mount_yspec_share *ms_next;
+    char                     *ms_key;    /* Serialized yang-library content */
+    yang_stmt                *ms_yspec;  /* Shared resolved yspec */
+    int                       ms_refcnt; /* Nr of mount-points using ms_yspec */
+};
+static struct mount_yspec_share *_mount_shares = NULL;
+
+/*! Find a shared mount yspec from its yang-library key
+ * @param[in]  key  Serialized yang-library content
+ * @retval     ms   Share entry
+ * @retval     NULL No yspec with this yang-library content registered
+ */
+static struct mount_yspec_share *
+mount_yspec_share_find(const char *key)
+{
+    struct mount_yspec_share *ms;
+
+    for (ms = _mount_shares; ms; ms = ms->ms_next)
+        if (strcmp(ms->ms_key, key) == 0)
+            return ms;
+    return NULL;
+}
+
+/*! Register a newly resolved yspec as shareable under a yang-library key
+ * @param[in]  key   Serialized yang-library content (copied)
+ * @param[in]  yspec Resolved yspec, ownership moves to the registry
+ * @retval     ms    New share entry with refcnt 0
+ * @retval     NULL  Error
+ */
+static struct mount_yspec_share *
+mount_yspec_share_new(const char *key,
+                      yang_stmt  *yspec)
+{
+    struct mount_yspec_share *ms;
+
+    if ((ms = malloc(sizeof(*ms))) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(ms, 0, sizeof(*ms));
+    if ((ms->ms_key = strdup(key)) == NULL){
+        clicon_err(OE_UNIX, errno, "strdup");
+        free(ms);
+        return NULL;
+    }
+    ms->ms_yspec = yspec;
+    ms->ms_next = _mount_shares;
+    _mount_shares = ms;
+    return ms;
+}
+
+/*! Release one mount-point's reference to a mounted yspec
+ * A shared yspec is freed when the last mount-point using it is released;
+ * yspecs not in the share registry (mounted by external code) are freed
+ * directly.
+ * @param[in]  yspec  Mounted yspec
+ * @retval     0      OK
+ */
+static int
+mount_yspec_release(yang_stmt *yspec)
+{
+    struct mount_yspec_share **msp;
+    struct mount_yspec_share  *ms;
+
+    for (msp = &_mount_shares; (ms = *msp) != NULL; msp = &ms->ms_next)
+        if (ms->ms_yspec == yspec)
+            break;
+    if (ms == NULL){
+        ys_free(yspec);
+        return 0;
+    }
+    if (--ms->ms_refcnt <= 0){
+        *msp = ms->ms_next;
+        ys_free(ms->ms_yspec);
+        free(ms->ms_key);
+        free(ms);
+    }
+    return 0;
+}
+
 /*! Set yangspec mount-point
  *
  * Stored in a separate structure (not in XML config tree)
@@ -209,7 +299,7 @@ xml_yang_mount_set(cxobj     *x,
         (cv = cvec_find(cvv, xpath)) != NULL &&
         (yspec0 = cv_void_get(cv)) != NULL){
         assert(0);
-        ys_free(yspec0);
+        mount_yspec_release(yspec0);
         cv_void_set(cv, NULL);
     }
     else if ((cv = yang_cvec_add(yu, CGV_VOID, xpath)) == NULL)
@@ -230,10 +320,10 @@ xml_yang_mount_freeall(cvec *cvv)
     cg_var    *cv = NULL;
     yang_stmt *ys;
     
-    cv = NULL;    
+    cv = NULL;
     while ((cv = cvec_each(cvv, cv)) != NULL){
         if ((ys = cv_void_get(cv)) != NULL)
-            ys_free(ys);
+            mount_yspec_release(ys); /* Shared yspec freed with last mount */
     }
     return 0;
 }
@@ -438,33 +528,54 @@ yang_schema_mount_statedata(clicon_handle h,
 }
 
 /*! Get yanglib, parse it and mount it
+ * Mount-points with identical yang-library content share one resolved yspec,
+ * see struct mount_yspec_share.
  */
 int
 yang_schema_yanglib_parse_mount(clicon_handle h,
                                 cxobj        *xt)
 {
-    int         retval = -1;
-    cxobj     *yanglib = NULL;
-    yang_stmt *yspec = NULL;
-    int        ret;
+    int                       retval = -1;
+    cxobj                    *yanglib = NULL;
+    yang_stmt                *yspec = NULL;
+    struct mount_yspec_share *ms = NULL;
+    cbuf                     *cb = NULL;
+    int                       ret;
 
     if (clixon_plugin_yang_mount_all(h, xt, &yanglib) < 0)
         goto done;
     if (yanglib == NULL)
         goto anydata;
-    /* Parse it and set mount-point */
-    if ((yspec = yspec_new()) == NULL)
+    /* Serialize yang-library content as share key */
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
-    if ((ret = yang_lib2yspec(h, yanglib, yspec)) < 0)
+    }
+    if (clixon_xml2cbuf(cb, yanglib, 0, 0, -1, 0) < 0)
         goto done;
-    if (ret == 0)
-        goto anydata;
+    if ((ms = mount_yspec_share_find(cbuf_get(cb))) != NULL)
+        yspec = ms->ms_yspec; /* Same yang-library already resolved: reuse */
+    else{
+        /* Parse it and set mount-point */
+        if ((yspec = yspec_new()) == NULL)
+            goto done;
+        if ((ret = yang_lib2yspec(h, yanglib, yspec)) < 0)
+            goto done;
+        if (ret == 0)
+            goto anydata;
+        if ((ms = mount_yspec_share_new(cbuf_get(cb), yspec)) == NULL)
+            goto done;
+    }
     if (xml_yang_mount_set(xt, yspec) < 0)
         goto done;
+    ms->ms_refcnt++;
+    yspec = NULL; /* Owned by mount-point + share registry */
     retval = 1;
  done:
-    if (yspec)
+    if (yspec && ms == NULL) /* Newly parsed but not registered */
         ys_free(yspec);
+    if (cb)
+        cbuf_free(cb);
     if (yanglib)
         xml_free(yanglib);
     return retval;
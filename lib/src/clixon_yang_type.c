@@ -270,6 +270,56 @@ ys_resolve_type(yang_stmt    *ys,
     return retval;
 }
 
+/*! Pre-compile pattern regexps of a yang type, yang_apply function on Y_TYPE
+ *
+ * Compiled regexps are otherwise made lazily at first validation (see
+ * ys_cv_validate) since compiling needs a clicon_handle to select the regexp
+ * engine and compiled patterns do not follow yang tree copies (see
+ * yang_type_cache_cp). Called from yang_parse_post after grouping expansion
+ * and augments, when no more copies are made, so that validation does not
+ * compile in the fast path.
+ * @param[in]  ys  This is a type statement
+ * @param[in]  arg Clicon handle
+ * @retval     0   OK
+ * @retval    -1   Error
+ * @see ys_resolve_type  where the type cache itself is populated
+ */
+int
+ys_precompile_regexps(yang_stmt *ys,
+                      void      *arg)
+{
+    clicon_handle h = (clicon_handle)arg;
+    int           retval = -1;
+    cvec         *patterns = NULL;
+    cvec         *regexps = NULL;
+    int           ret;
+
+    if ((patterns = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((regexps = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((ret = yang_type_cache_get(ys, NULL, NULL, NULL, patterns, NULL,
+                                   regexps, NULL)) < 0)
+        goto done;
+    if (ret == 1 && cvec_len(patterns) != 0 && cvec_len(regexps) == 0){
+        if (compile_pattern2regexp(h, patterns, regexps) < 1)
+            goto done;
+        if (yang_type_cache_regexp_set(ys, clicon_yang_regexp(h), regexps) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    if (patterns)
+        cvec_free(patterns);
+    if (regexps)
+        cvec_free(regexps);
+    return retval;
+}
+
 /*! Translate from a yang type to a cligen variable type
  *
  * Currently many built-in types from RFC6020 and some RFC6991 types.
@@ -556,7 +606,6 @@ cv_validate1(clicon_handle h,
     cg_var         *cv1;
     cg_var         *cv2;
     int             ret;
-    yang_stmt      *yi = NULL;
     char           *str = NULL;
     int             found;
     char          **vec = NULL;
@@ -668,16 +717,11 @@ cv_validate1(clicon_handle h,
         if (restype){
             if (strcmp(restype, "enumeration") == 0){
                 found = 0;
-                yi = NULL;
                 if (str != NULL) {
                     //              str = clixon_trim2(str, " \t\n"); /* May be misplaced, strip earlier? */
-                    while ((yi = yn_each(yrestype, yi)) != NULL){
-                        if (yang_keyword_get(yi) != Y_ENUM)
-                            continue;
-                        if (strcmp(yang_argument_get(yi), str) == 0){
-                            found++;
-                            break;
-                        }
+                    if ((found = yang_valcache_lookup(yrestype, str)) < 0){
+                        retval = -1;
+                        goto done;
                     }
                 }
                 if (!found){
@@ -698,15 +742,9 @@ cv_validate1(clicon_handle h,
                 for (i=0; i<nvec; i++){
                     if ((v = vec[i]) == NULL || !strlen(v))
                         continue;
-                    found = 0;
-                    yi = NULL;
-                    while ((yi = yn_each(yrestype, yi)) != NULL){
-                        if (yang_keyword_get(yi) != Y_BIT)
-                            continue;
-                        if (strcmp(yang_argument_get(yi), v) == 0){
-                            found++;
-                            break;
-                        }
+                    if ((found = yang_valcache_lookup(yrestype, v)) < 0){
+                        retval = -1;
+                        goto done;
                     }
                     if (!found){
                         if (reason)
@@ -926,6 +964,15 @@ ys_cv_validate_union(clicon_handle h,
     yang_stmt *yt = NULL;
     char      *reason1 = NULL;  /* saved reason */
 
+    /* Memo fast path: this value already validated against this union,
+     * reuse the member that matched, see yang_valcache_memo_add() below
+     */
+    if (val && (yt = yang_valcache_memo_get(yrestype, val)) != NULL){
+        if (ysubp)
+            *ysubp = yt;
+        return 1;
+    }
+    yt = NULL;
     while ((yt = yn_each(yrestype, yt)) != NULL){
         if (yang_keyword_get(yt) != Y_TYPE)
             continue;
@@ -945,6 +992,13 @@ ys_cv_validate_union(clicon_handle h,
         if (retval == 1) {
             if (ysubp)
                 *ysubp = yt;
+            /* Memoize positive result only: failures must re-run to rebuild
+             * the reason string
+             */
+            if (val && yang_valcache_memo_add(yrestype, val, yt) < 0){
+                retval = -1;
+                goto done;
+            }
             break;
         }
     }
@@ -1097,8 +1151,137 @@ ys_cv_validate(clicon_handle h,
     return retval;
 }
 
+/*! Validate a vector of cligen variables sharing a single yang leaf(-list) spec
+ *
+ * Same checks as ys_cv_validate, but the type is resolved and the compiled
+ * pattern regexps are fetched once and applied across all values, instead of
+ * once per value. This matters when validating long leaf-lists or list key
+ * columns where the per-value type resolving otherwise dominates.
+ * Union and leafref types fall back to per-value ys_cv_validate since the
+ * matching sub-type may differ between values.
+ * @param[in]  h       Clicon handle
+ * @param[in]  cvs     Vector of correctly parsed cligen variables to validate
+ * @param[in]  ncv     Length of cvs
+ * @param[in]  ys      A yang statement, must be leaf or leaf-list.
+ * @param[out] failidx If given and return value is 0, index into cvs of the
+ *                     first value that failed validation
+ * @param[out] reason  If given, and if return value is 0, contains malloced
+ *                     string describing reason why validation failed.
+ * @retval -1  Error (fatal), with errno set to indicate error
+ * @retval 0   Validation not OK, malloced reason is returned. Free reason with free()
+ * @retval 1   Validation OK for all values
+ * @see ys_cv_validate  single-value variant
+ */
+int
+ys_cv_validate_batch(clicon_handle h,
+                     cg_var      **cvs,
+                     size_t        ncv,
+                     yang_stmt    *ys,
+                     int          *failidx,
+                     char        **reason)
+{
+    int             retval = -1;
+    cg_var         *ycv;        /* cv of yang-statement */
+    int             options = 0;
+    cvec           *cvv = NULL;
+    cvec           *patterns = NULL;
+    cvec           *regexps = NULL;
+    enum cv_type    cvtype;
+    char           *origtype = NULL;  /* orig type */
+    yang_stmt      *yrestype; /* resolved type */
+    char           *restype;
+    uint8_t         fraction = 0;
+    int             ret;
+    size_t          i;
+
+    if (reason)
+        *reason = NULL;
+    if (yang_keyword_get(ys) != Y_LEAF && yang_keyword_get(ys) != Y_LEAF_LIST){
+        retval = 1;
+        goto done;
+    }
+    ycv = yang_cv_get(ys);
+    if ((regexps = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if ((patterns = cvec_new(0)) == NULL){
+        clicon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (yang_type_get(ys, &origtype, &yrestype,
+                      &options, &cvv,
+                      patterns, regexps,
+                      &fraction) < 0)
+        goto done;
+    restype = yrestype?yang_argument_get(yrestype):NULL;
+    if (clicon_type2cv(origtype, restype, ys, &cvtype) < 0)
+        goto done;
+    if (cv_type_get(ycv) != cvtype){
+        /* special case: dbkey has rest syntax-> cv but yang cant have that */
+        if (cvtype == CGV_STRING && cv_type_get(ycv) == CGV_REST)
+            ;
+        else {
+            clicon_err(OE_DB, 0, "Type mismatch data:%s != yang:%s",
+                       cv_type2str(cvtype), cv_type2str(cv_type_get(ycv)));
+            goto done;
+        }
+    }
+    if (restype &&
+        (strcmp(restype, "union") == 0 || strcmp(restype, "leafref") == 0)){
+        /* The matching union sub-type (or leafref referred node) may differ
+         * per value: fall back to single-value validation */
+        for (i=0; i<ncv; i++){
+            if ((ret = ys_cv_validate(h, cvs[i], ys, NULL, reason)) < 0)
+                goto done;
+            if (ret == 0){
+                if (failidx)
+                    *failidx = i;
+                goto fail;
+            }
+        }
+    }
+    else{
+        /* The regexp cache may be invalidated, in that case re-compile
+         * eg due to copying
+         */
+        if (cvec_len(patterns)!=0 && cvec_len(regexps)==0){
+            yang_stmt      *yt;
+            if (compile_pattern2regexp(h, patterns, regexps) < 1)
+                goto done;
+            yt = yang_find(ys, Y_TYPE, NULL);
+            if (yang_type_cache_regexp_set(yt,
+                                           clicon_yang_regexp(h),
+                                           regexps) < 0)
+                goto done;
+        }
+        for (i=0; i<ncv; i++){
+            if ((ret = cv_validate1(h, cvs[i], cvtype, options, cvv,
+                                    regexps, yrestype, restype, reason)) < 0)
+                goto done;
+            if (ret == 0){
+                if (failidx)
+                    *failidx = i;
+                goto fail;
+            }
+        }
+    }
+    retval = 1;
+  done:
+    if (origtype)
+        free(origtype);
+    if (regexps)
+        cvec_free(regexps);
+    if (patterns)
+        cvec_free(patterns);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*
- * a typedef can be under module, submodule, container, list, grouping, rpc, 
+ * a typedef can be under module, submodule, container, list, grouping, rpc,
  * input, output, notification
  */
 static inline int
@@ -0,0 +1,119 @@
+#!/usr/bin/env bash
+# Perf workload: M-edit commit storm
+# Run M edit-config + commit cycles of single list entries through one
+# long-lived netconf session, against a datastore pre-loaded with entries.
+# Run from the test directory: ./perf/perf_commit_storm.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+. ./perf/perf_lib.sh
+
+# Which format to use as datastore format internally
+: ${format:=xml}
+
+# Number of list entries pre-loaded into the datastore
+: ${perfnr:=1000}
+
+# Number of edit+commit cycles
+: ${perfedits:=100}
+
+APPNAME=example
+
+cfg=$dir/perf-commit-conf.xml
+fyang=$dir/scaling.yang
+fedits=$dir/edits.xml
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/example/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_XMLDB_FORMAT>$format</CLICON_XMLDB_FORMAT>
+  <CLICON_CLI_MODE>example</CLICON_CLI_MODE>
+  <CLICON_CLI_DIR>/usr/local/lib/example/cli</CLICON_CLI_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/example/clispec</CLICON_CLISPEC_DIR>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "pre-load $perfnr list entries and commit"
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$perfnr; i++ )); do
+    rpc+="<y><a>$i</a><b>$i</b></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+rpc="$(chunked_framing "$rpc")$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")"
+expectpart "$(echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg)" 0 "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "generate $perfedits edit+commit cycles"
+echo -n "$DEFAULTHELLO" > $fedits
+for (( i=0; i<$perfedits; i++ )); do
+    rnd=$(( RANDOM % perfnr ))
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><b>$i</b></y></x></config></edit-config></rpc>"
+    echo "$(chunked_framing "$rpc")" >> $fedits
+    echo "$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")" >> $fedits
+done
+
+perf_measure commit-storm edit-commit-cycles "$clixon_netconf -qef $cfg < $fedits"
+
+perf_backend_rss commit-storm
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+# unset conditional parameters
+unset format
+unset perfnr
+unset perfedits
+
+new "endtest"
+endtest
@@ -0,0 +1,112 @@
+#!/usr/bin/env bash
+# Helper functions for the performance regression suite, see perf/README.md
+# Sourced by the perf workload scripts after lib.sh.
+#
+# Each measurement is appended as a CSV row to $perfcsv:
+#    workload,metric,wall_s,cpu_s,rss_kb
+# Wall/cpu/max-RSS are taken from /usr/bin/time where it supports a format
+# string (GNU) or -l (BSD); otherwise bash "time -p" is used and RSS is
+# recorded as 0.
+
+# File where measurement rows are appended (the suite runner overrides this)
+: ${perfcsv:=$dir/perf.csv}
+
+# Detect which time(1) flavor is available
+if /usr/bin/time -f "%e" true 2> /dev/null; then
+    perftime=gnu
+elif /usr/bin/time -l true 2> /dev/null; then
+    perftime=bsd
+else
+    perftime=posix
+fi
+
+# Append one CSV measurement row and log it
+# Arguments:
+# 1: workload  Workload name, eg datastore-load
+# 2: metric    Step name within the workload, eg load-candidate
+# 3: wall      Elapsed wall-clock seconds
+# 4: cpu       CPU seconds (user+sys)
+# 5: rss       Maximum resident set size in kB (0 if unknown)
+function perf_record()
+{
+    echo "$1,$2,$3,$4,$5" >> $perfcsv
+    echo "perf: $1/$2 wall=${3}s cpu=${4}s rss=${5}kB"
+}
+
+# Run a workload step under time(1) and append a CSV measurement row
+# Arguments:
+# 1: workload  Workload name, eg datastore-load
+# 2: metric    Step name within the workload, eg load-candidate
+# 3: cmd       Shell command string, run with bash -c, output discarded
+function perf_measure()
+{
+    workload=$1
+    metric=$2
+    cmd=$3
+    ftime=$dir/time.out
+    new "perf $workload $metric"
+    case $perftime in
+        gnu)
+            /usr/bin/time -f "%e %U %S %M" -o $ftime bash -c "$cmd" > /dev/null 2>&1
+            if [ $? -ne 0 ]; then err1 "perf $workload $metric: command failed"; fi
+            set -- $(tail -1 $ftime)
+            perf_record $workload $metric $1 $(echo "$2 $3" | awk '{print $1+$2}') $4
+            ;;
+        bsd)
+            /usr/bin/time -l -o $ftime bash -c "$cmd" > /dev/null 2>&1
+            if [ $? -ne 0 ]; then err1 "perf $workload $metric: command failed"; fi
+            wall=$(awk '/real/ {print $1}' $ftime)
+            cpu=$(awk '/user/ {u=$1} /sys/ {s=$1} END {print u+s}' $ftime)
+            rss=$(awk '/maximum resident/ {print int($1/1024)}' $ftime)
+            perf_record $workload $metric $wall $cpu ${rss:-0}
+            ;;
+        posix)
+            { time -p bash -c "$cmd" > /dev/null 2>&1 ; } 2> $ftime
+            if [ $? -ne 0 ]; then err1 "perf $workload $metric: command failed"; fi
+            wall=$(awk '/real/ {print $2}' $ftime)
+            cpu=$(awk '/user/ {u=$2} /sys/ {s=$2} END {print u+s}' $ftime)
+            perf_record $workload $metric $wall $cpu 0
+            ;;
+    esac
+}
+
+# Record the resident set size of the running backend daemon
+# Arguments:
+# 1: workload  Workload name the snapshot belongs to
+function perf_backend_rss()
+{
+    workload=$1
+    pid=$(pgrep -o clixon_backend)
+    if [ -z "$pid" ]; then
+        err1 "perf $workload: no running clixon_backend for RSS snapshot"
+    fi
+    rss=$(ps -o rss= -p $pid | tr -d ' ')
+    perf_record $workload backend-rss 0 0 ${rss:-0}
+}
+
+# Compare a measurement CSV against a baseline CSV, print regressions
+# Metrics present in only one of the files are ignored.
+# Arguments:
+# 1: baseline  Baseline CSV file
+# 2: current   Current CSV file
+# 3: threshold Allowed increase in percent before a metric counts as regressed
+# Returns 0 if no metric regressed, 1 otherwise
+function perf_compare()
+{
+    awk -F, -v thr=$3 '
+        NR==FNR { bwall[$1","$2]=$3; brss[$1","$2]=$5; next }
+        {
+            key=$1","$2
+            if (!(key in bwall)) next
+            if (bwall[key]+0 > 0 && $3 > bwall[key]*(1+thr/100)){
+                printf "REGRESSION %s: wall %ss, baseline %ss (+%d%% allowed)\n", key, $3, bwall[key], thr
+                fail++
+            }
+            if (brss[key]+0 > 0 && $5 > brss[key]*(1+thr/100)){
+                printf "REGRESSION %s: rss %skB, baseline %skB (+%d%% allowed)\n", key, $5, brss[key], thr
+                fail++
+            }
+        }
+        END { exit fail > 0 }
+    ' $1 $2
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env bash
+# Perf workload: K-subscriber notification burst
+# Start K netconf subscribers on the example EXAMPLE stream and measure the
+# wall time until every subscriber has received its first notification.
+# Run from the test directory: ./perf/perf_notification_burst.sh
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+. ./perf/perf_lib.sh
+
+# Number of concurrent subscribers
+: ${perfsubs:=10}
+
+# Max seconds to wait for all subscribers to see a notification
+# (the example stream generates one event every 5s)
+: ${perfwait:=15}
+
+APPNAME=example
+
+cfg=$dir/perf-notif-conf.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_BACKEND_REGEXP>example_backend.so$</CLICON_BACKEND_REGEXP>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/$APPNAME/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_STREAM_DISCOVERY_RFC5277>true</CLICON_STREAM_DISCOVERY_RFC5277>
+</clixon-config>
+EOF
+
+# Same event model as test_netconf_notifications.sh, generated by example_backend -n
+cat <<EOF > $fyang
+module example {
+  namespace "urn:example:clixon";
+  prefix ex;
+  notification event {
+    description "Example notification event.";
+    leaf event-class {
+      type string;
+    }
+    container reportingEntity {
+      leaf card {
+        type string;
+      }
+    }
+    leaf severity {
+      type string;
+    }
+  }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+
+    new "start backend -s init -f $cfg -- -n (create example notification stream)"
+    start_backend -s init -f $cfg -- -n
+fi
+
+new "wait backend"
+wait_backend
+
+new "start $perfsubs netconf subscribers"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><create-subscription xmlns=\"urn:ietf:params:xml:ns:netmod:notification\"><stream>EXAMPLE</stream></create-subscription></rpc>")
+t0=$(date +%s.%N)
+for (( i=0; i<$perfsubs; i++ )); do
+    { echo "$DEFAULTHELLO$rpc"; sleep $perfwait; } | $clixon_netconf -qef $cfg > $dir/sub$i.out 2>&1 &
+done
+
+new "wait for first notification on all subscribers"
+seen=0
+for (( t=0; t<$perfwait*10; t++ )); do
+    seen=0
+    for (( i=0; i<$perfsubs; i++ )); do
+        if grep -q "<notification" $dir/sub$i.out 2> /dev/null; then
+            seen=$((seen+1))
+        fi
+    done
+    if [ $seen -eq $perfsubs ]; then
+        break
+    fi
+    sleep 0.1
+done
+t1=$(date +%s.%N)
+if [ $seen -ne $perfsubs ]; then
+    err "$perfsubs subscribers with notifications" "$seen"
+fi
+perf_record notification-burst first-event-all-subs $(echo "$t0 $t1" | awk '{printf "%.2f", $2-$1}') 0 0
+
+perf_backend_rss notification-burst
+
+new "wait for subscribers to exit"
+wait
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+# unset conditional parameters
+unset perfsubs
+unset perfwait
+
+new "endtest"
+endtest
@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+# Run the performance regression suite: all perf_*.sh workloads in this
+# directory, collecting measurements into a timestamped CSV under $resdir
+# (the history), and compare against a stored per-arch baseline, failing if
+# any metric regressed by more than $threshold percent.
+#
+# This script requires the user to be in the sudo group (as all.sh).
+#
+# Examples:
+#    ./perf/perf_suite.sh                  # Run, compare against baseline
+#    baseline=true ./perf/perf_suite.sh    # Run and (re)record the baseline
+#    threshold=50 ./perf/perf_suite.sh     # Allow up to 50% regression
+#    resdir=/tmp/perf ./perf/perf_suite.sh # Keep CSV history in /tmp/perf
+
+# Allowed regression in percent before a metric fails
+: ${threshold:=20}
+
+# If true, store this run as the new baseline instead of comparing
+: ${baseline:=false}
+
+# Where measurement CSV history is kept
+: ${resdir:=/var/tmp/clixon-perf}
+
+# Which workload scripts to run
+: ${workloads:="perf_datastore_load.sh perf_commit_storm.sh perf_notification_burst.sh"}
+
+# Workloads are run from the test directory so they find lib.sh/config.sh
+testdir=$(cd "$(dirname $0)/.." && pwd)
+cd $testdir || exit -1
+
+# Per-arch baseline, measurements are not comparable across machines
+basefile=./perf/baseline-$(arch).csv
+
+mkdir -p $resdir || exit -1
+perfcsv=$resdir/perf-$(date +%Y%m%dT%H%M%S).csv
+export perfcsv
+
+allerr=0
+testnr=0
+for test in $workloads; do
+    if [ $testnr != 0 ]; then echo; fi
+    testfile=$test
+    . ./perf/$test
+    errcode=$?
+    endsuite
+    if [ $errcode -ne 0 ]; then
+        allerr=1
+        echo -e "\e[31mError in $test errcode=$errcode"
+        echo -ne "\e[0m"
+        exit $errcode
+    fi
+done
+
+echo "Measurements in $perfcsv"
+if $baseline; then
+    cp $perfcsv $basefile
+    echo "Baseline stored in $basefile"
+elif [ -f $basefile ]; then
+    # perf_compare is defined in perf_lib.sh, sourced via the workloads above
+    if ! perf_compare $basefile $perfcsv $threshold; then
+        echo -e "\e[31mPerformance regression against $basefile"
+        echo -ne "\e[0m"
+        exit -1
+    fi
+    echo "No regression against $basefile (threshold ${threshold}%)"
+else
+    echo "No baseline $basefile, skipping comparison (run with baseline=true to create one)"
+fi
+echo OK
@@ -0,0 +1,122 @@
+#!/usr/bin/env bash
+# Zstd-compressed datastore tests, see CLICON_XMLDB_COMPRESS
+# Requires compile-time support: configure --enable-zstd
+# - committed datastore files are zstd frames (magic 28 b5 2f fd)
+# - config survives backend restart (magic autodetect + streaming decompress)
+# - uncompressed files are still read when compression is enabled
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+if [ "${WITH_ZSTD}" != "yes" ]; then
+    echo "Skipping test, clixon compiled without --enable-zstd"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_COMPRESS>true</CLICON_XMLDB_COMPRESS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit and commit config"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>foo</value></parameter></table></config></edit-config></rpc>]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running_db is a zstd frame"
+magic=$(sudo od -An -tx1 -N4 $dir/running_db | tr -d ' ')
+if [ "$magic" != "28b52ffd" ]; then
+    err "28b52ffd" "$magic"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "restart backend from compressed running_db"
+    stop_backend -f $cfg
+    start_backend -s running -f $cfg
+
+    new "wait backend"
+    wait_backend
+fi
+
+new "config survived restart"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>foo</value></parameter></table></data></rpc-reply>"
+
+# Compressed and uncompressed files can be mixed: replace running_db with a
+# plain-text image and restart, the reader autodetects by magic
+if [ $BE -ne 0 ]; then
+    new "replace running_db with uncompressed xml"
+    sudo sh -c "cat > $dir/running_db" <<EOF
+<${DATASTORE_TOP}><table xmlns="urn:example:clixon"><parameter><name>b</name><value>bar</value></parameter></table></${DATASTORE_TOP}>
+EOF
+
+    new "restart backend from uncompressed running_db"
+    stop_backend -f $cfg
+    start_backend -s running -f $cfg
+
+    new "wait backend"
+    wait_backend
+
+    new "uncompressed file was read"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>bar</value></parameter></table></data></rpc-reply>"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,129 @@
+#!/usr/bin/env bash
+# Partial lock (RFC 5717) tests
+# - partial-lock/partial-unlock rpc:s, lock-id and locked-node in reply
+# - conflict with partial lock held by another session (lock-denied)
+# - disjoint subtrees can be locked concurrently
+# - whole-db lock vs partial lock interaction
+# - edit-config enforcement on a partially locked subtree (in-use)
+# - locks are released when the holding session closes
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+# RFC 5717 namespace
+PLNS="urn:ietf:params:xml:ns:netconf:partial-lock:1.0"
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+    container other{
+        leaf x{
+            type string;
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "partial-lock and unlock in same session"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select>/ex:table</select></partial-lock></rpc>]]>]]><rpc $DEFAULTNS><partial-unlock xmlns=\"$PLNS\"><lock-id>1</lock-id></partial-unlock></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "partial-lock union of two selects"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select>/ex:table</select><select>/ex:other</select></partial-lock></rpc>" "" "<rpc-reply $DEFAULTNS><lock-id xmlns=\"$PLNS\">2</lock-id><locked-node xmlns=\"$PLNS\">/ex:table</locked-node><locked-node xmlns=\"$PLNS\">/ex:other</locked-node></rpc-reply>"
+
+new "partial-lock empty select should fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select></select></partial-lock></rpc>" "<error-tag>invalid-value</error-tag>" ""
+
+new "partial-lock without select should fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"/></rpc>" "<error-tag>missing-element</error-tag>" ""
+
+# Hold a partial lock on /ex:table from a background session (EOM framing),
+# lock is released when the session is killed below
+new "background session takes partial lock on /ex:table"
+sleep 60 |  cat <(echo "$HELLONO11<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select>/ex:table</select></partial-lock></rpc>]]>]]>") -| $clixon_netconf -qf $cfg >> /dev/null &
+PIDS=($(jobs -l % | cut -c 6- | awk '{print $1}'))
+sleep 1
+
+new "partial-lock overlapping subtree should be denied"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select>/ex:table</select></partial-lock></rpc>" "<error-tag>lock-denied</error-tag>" ""
+
+new "partial-lock disjoint subtree is granted"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select>/ex:other</select></partial-lock></rpc>" "<lock-id xmlns=\"$PLNS\">" ""
+
+new "whole-db lock on running denied while partial lock held"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><lock><target><running/></target></lock></rpc>" "<error-message>Operation failed, a partial lock is held by another session</error-message>" ""
+
+new "edit-config on partially locked subtree should fail with in-use"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><running/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></config></edit-config></rpc>" "<error-tag>in-use</error-tag>" ""
+
+new "edit-config on disjoint subtree is allowed"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><running/></target><config><other xmlns=\"urn:example:clixon\"><x>foo</x></other></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "partial-unlock with unknown lock-id should fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-unlock xmlns=\"$PLNS\"><lock-id>99</lock-id></partial-unlock></rpc>" "<error-message>Unlock failed, no such lock-id</error-message>" ""
+
+new "kill lock-holding session ${PIDS[0]}"
+kill ${PIDS[0]}
+sleep 1
+
+new "partial-lock released on session close, relock granted"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><partial-lock xmlns=\"$PLNS\"><select>/ex:table</select></partial-lock></rpc>" "<lock-id xmlns=\"$PLNS\">" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,122 @@
+#!/usr/bin/env bash
+# Private per-session candidate tests, see CLICON_PRIVATE_CANDIDATE
+# - edit/get-config/commit work against the session's own candidate
+# - uncommitted private changes are dropped on session close
+# - optimistic concurrency: commit fails with in-use if running moved since
+#   the private candidate was forked, discard-changes + re-apply recovers
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_PRIVATE_CANDIDATE>true</CLICON_PRIVATE_CANDIDATE>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Edit-config adding parameter $1 to the candidate
+function editrpc()
+{
+    echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>$1</name></parameter></table></config></edit-config></rpc>"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit, read back and commit private candidate in one session"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(editrpc a)]]>]]><rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+new "committed config is in running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+new "uncommitted private candidate change, session closes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$(editrpc dropped)" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "change was dropped with the session, new candidate forked from running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><candidate/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+# Optimistic concurrency: session B forks its private candidate, another
+# session commits to running, then B commits.
+# B is kept open in the background with a fifo feeding its later rpc:s
+tmppipe=$(mktemp -u)
+mkfifo -m 600 "$tmppipe"
+outfile=$dir/sessionb.out
+
+new "session B edits its private candidate in the background"
+cat <(echo "$HELLONO11$(editrpc b)]]>]]>") "$tmppipe" | $clixon_netconf -qf $cfg > $outfile &
+sleep 1
+
+new "session C commits parameter c to running"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(editrpc c)]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "session B commit fails with in-use, stale base"
+echo "<rpc $DEFAULTNS><commit/></rpc>]]>]]>" > "$tmppipe"
+wait %% 2> /dev/null
+if ! grep -q "<error-tag>in-use</error-tag>" $outfile; then
+    err "<error-tag>in-use</error-tag>" "$(cat $outfile)"
+fi
+if ! grep -q "running was modified by another session" $outfile; then
+    err "running was modified by another session" "$(cat $outfile)"
+fi
+rm -f "$tmppipe"
+
+new "discard-changes + re-apply + commit recovers"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(editrpc b)]]>]]><rpc $DEFAULTNS><discard-changes/></rpc>]]>]]>$(editrpc b)]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running has all committed parameters"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter><parameter><name>b</name></parameter><parameter><name>c</name></parameter></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+# Restconf CBOR (RFC 9254) media type negotiation
+# - GET with Accept: application/yang-data+cbor returns a CBOR body
+#   (names encoding: member keys are module:name text strings)
+# - errors on a CBOR GET are reported with the negotiated media type
+# - CBOR request bodies are not supported: 415 unsupported media type
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf.xml
+fyang=$dir/clixon-example.yang
+
+CBOR="application/yang-data+cbor"
+
+# Define default restconfig config: RESTCONFIG
+RESTCONFIG=$(restconf_config none false)
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>clixon-restconf:allow-auth-none</CLICON_FEATURE> <!-- Use auth-type=none -->
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/$APPNAME/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/restconf.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  $RESTCONFIG
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $RC -ne 0 ]; then
+    new "kill old restconf daemon"
+    stop_restconf_pre
+
+    new "start restconf daemon"
+    start_restconf -f $cfg
+fi
+
+new "wait restconf"
+wait_restconf
+
+new "restconf PUT table (json)"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: application/yang-data+json" $RCPROTO://localhost/restconf/data/clixon-example:table -d '{"clixon-example:table":{"parameter":[{"name":"x","value":"foo"}]}}')" 0 "HTTP/$HVER 201"
+
+new "restconf GET table with Accept cbor"
+# CBOR is binary but the names encoding keeps keys and string values as
+# greppable text (expectpart only checks greps exit status)
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: $CBOR" $RCPROTO://localhost/restconf/data/clixon-example:table)" 0 "HTTP/$HVER 200" "Content-Type: $CBOR" "clixon-example:table" "parameter" "name" "value" "foo"
+
+new "restconf GET table with Accept xml unchanged"
+expectpart "$(curl $CURLOPTS -X GET -H 'Accept: application/yang-data+xml' $RCPROTO://localhost/restconf/data/clixon-example:table)" 0 "HTTP/$HVER 200" "Content-Type: application/yang-data+xml" '<table xmlns="urn:example:clixon"><parameter><name>x</name><value>foo</value></parameter></table>'
+
+new "restconf GET nonexistent with Accept cbor gives 404"
+expectpart "$(curl $CURLOPTS -X GET -H "Accept: $CBOR" $RCPROTO://localhost/restconf/data/clixon-example:table/parameter=notfound)" 0 "HTTP/$HVER 404" "Content-Type: $CBOR"
+
+new "restconf PUT with cbor request body gives 415"
+expectpart "$(curl $CURLOPTS -X PUT -H "Content-Type: $CBOR" $RCPROTO://localhost/restconf/data/clixon-example:table -d 'notcbor')" 0 "HTTP/$HVER 415"
+
+new "Kill restconf daemon"
+stop_restconf
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
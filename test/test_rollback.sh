@@ -0,0 +1,106 @@
+#!/usr/bin/env bash
+# Rollback rpc tests, see CLICON_ROLLBACK_HISTORY and rpc rollback in clixon-lib.yang
+# - commit two generations, roll back one and check running
+# - nr beyond the archived history, nr 0 and missing nr give rpc-errors
+# - the rollback commit is itself archived: roll forward again with nr 1
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/clixon-example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_CLI_MODE>$APPNAME</CLICON_CLI_MODE>
+  <CLICON_SOCK>$dir/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$dir/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_DATASTORE_CACHE>cache-cow</CLICON_DATASTORE_CACHE>
+  <CLICON_ROLLBACK_HISTORY>10</CLICON_ROLLBACK_HISTORY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module clixon-example{
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Edit-config adding parameter $1 to the candidate
+function editrpc()
+{
+    echo "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>$1</name></parameter></table></config></edit-config></rpc>"
+}
+
+new "test params: -f $cfg"
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "commit generation 1: parameter a"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(editrpc a)]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit generation 2: parameter b"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11$(editrpc b)]]>]]><rpc $DEFAULTNS><commit/></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running has both parameters"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter><parameter><name>b</name></parameter></table></data></rpc-reply>"
+
+new "rollback nr 1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><nr>1</nr></rollback></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running is back at generation 1"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter></table></data></rpc-reply>"
+
+new "the rollback itself was archived: rollback nr 1 rolls forward"
+expecteof "$clixon_netconf -qf $cfg" 0 "$HELLONO11<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><nr>1</nr></rollback></rpc>]]>]]><rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>]]>]]>" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name></parameter><parameter><name>b</name></parameter></table></data></rpc-reply>"
+
+new "rollback beyond history should fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><nr>99</nr></rollback></rpc>" "<error-message>No archived configuration that many commits back, see CLICON_ROLLBACK_HISTORY</error-message>" ""
+
+new "rollback nr 0 should fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"><nr>0</nr></rollback></rpc>" "<error-tag>operation-failed</error-tag>" ""
+
+new "rollback without nr should fail"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><rollback xmlns=\"http://clicon.org/lib\"/></rpc>" "<error-tag>missing-element</error-tag>" ""
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    # kill backend
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,409 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2016 Olof Hagsand and Benny Holmgren
+  Copyright (C) 2017-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Microbenchmarks of core data-path primitives, see "make bench"
+ * Generates a synthetic list corpus of -n nodes and measures parse, sort,
+ * compare, xpath, diff, json serialization and datastore read, reporting
+ * ns/op per primitive and max rss at exit. Intended for tracking regressions
+ * release-to-release, not as a pass/fail test.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <syslog.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clicon */
+#include <clixon/clixon.h>
+
+/* Command line options to be passed to getopt(3) */
+#define BENCH_OPTS "hDn:b:"
+
+/* Elements (list entry + leafs) generated per corpus list entry */
+#define BENCH_NODES_PER_ENTRY 4
+
+/* Self-contained yang module of the corpus, parsed from memory */
+static char *bench_yang =
+    "module clixon-bench {\n"
+    "  yang-version 1.1;\n"
+    "  namespace \"urn:example:bench\";\n"
+    "  prefix cb;\n"
+    "  container table {\n"
+    "    list entry {\n"
+    "      key name;\n"
+    "      leaf name { type string; }\n"
+    "      leaf value { type uint32; }\n"
+    "      leaf status { type string; }\n"
+    "    }\n"
+    "  }\n"
+    "}\n";
+
+/*! usage
+ */
+static void
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s <options>*\n"
+            "where options are\n"
+            "\t-h\t\tHelp\n"
+            "\t-D\t\tDebug\n"
+            "\t-n <nr>\t\tCorpus size in XML nodes, eg 10000/100000/1000000. Default: 10000\n"
+            "\t-b <dir>\tDatastore directory for the xmldb benchmark. Default: mkdtemp under /tmp\n"
+            ,
+            argv0
+            );
+    exit(0);
+}
+
+/*! Monotonic timestamp in seconds
+ */
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/*! Print one result line: name, iterations, ns per operation
+ */
+static void
+bench_report(const char *name,
+             int         iters,
+             double      t)
+{
+    fprintf(stdout, "%-28s %8d iters %14.1f ns/op %10.3f s total\n",
+            name, iters, t/iters*1e9, t);
+}
+
+/*! Generate corpus XML of roughly nodes elements in pseudo-random entry order
+ *
+ * Entry names are a bijective scramble of the index so that parsing yields an
+ * unsorted tree and sort/insert benchmarks do real work.
+ */
+static int
+bench_corpus(cbuf *cb,
+             int   nentries)
+{
+    int      i;
+    uint32_t scramble;
+
+    cprintf(cb, "<table xmlns=\"urn:example:bench\">");
+    for (i=0; i<nentries; i++){
+        scramble = (uint32_t)i * 2654435761u; /* odd constant: bijective mod 2^32 */
+        cprintf(cb, "<entry><name>e%08x</name><value>%u</value><status>up</status></entry>",
+                scramble, (uint32_t)i);
+    }
+    cprintf(cb, "</table>");
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    int            retval = -1;
+    int            c;
+    clicon_handle  h = NULL;
+    char          *argv0;
+    yang_stmt     *yspec = NULL;
+    int            nodes = 10000;
+    int            nentries;
+    char          *dbdir = NULL;
+    char           dbdirbuf[] = "/tmp/clixon_bench_XXXXXX";
+    int            dbg = 0;
+    cbuf          *cb = NULL;
+    cbuf          *cbret = NULL;
+    cxobj         *xt = NULL;   /* corpus in parse (unsorted) order */
+    cxobj         *xs = NULL;   /* sorted corpus */
+    cxobj         *xmod = NULL; /* modified copy for diff */
+    cxobj         *xtmp = NULL;
+    cxobj         *xe;
+    cxobj        **vec = NULL;
+    size_t         veclen;
+    cxobj        **dvec1 = NULL; /* diff vectors */
+    cxobj        **dvec2 = NULL;
+    cxobj        **cvec1 = NULL;
+    cxobj        **cvec2 = NULL;
+    int            dlen1;
+    int            dlen2;
+    int            clen;
+    double         t0;
+    double         t;
+    int            iters;
+    int            i;
+    int            acc = 0;
+    int            ret;
+    struct rusage  ru;
+
+    clicon_log_init(__FILE__, LOG_INFO, CLICON_LOG_STDERR);
+    argv0 = argv[0];
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
+    while ((c = getopt(argc, argv, BENCH_OPTS)) != -1)
+        switch (c) {
+        case '?' :
+        case 'h' : /* help */
+            usage(argv0);
+            break;
+        case 'D' : /* debug */
+            dbg = 1;
+            break;
+        case 'n': /* corpus size in nodes */
+            if (!optarg || (nodes = atoi(optarg)) <= 0)
+                usage(argv0);
+            break;
+        case 'b': /* db directory */
+            if (!optarg)
+                usage(argv0);
+            dbdir = optarg;
+            break;
+        }
+    clicon_log_init(__FILE__, dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+
+    nentries = nodes/BENCH_NODES_PER_ENTRY;
+    if (nentries < 2)
+        nentries = 2;
+    fprintf(stdout, "clixon bench: %d entries, ~%d nodes\n",
+            nentries, nentries*BENCH_NODES_PER_ENTRY);
+    /* Parse corpus yang from memory */
+    if ((yspec = yspec_new()) == NULL)
+        goto done;
+    if (yang_parse_str(bench_yang, "clixon-bench", yspec) == NULL)
+        goto done;
+    if (yang_parse_post(h, yspec, 0) < 0)
+        goto done;
+    clicon_dbspec_yang_set(h, yspec);
+    /* Generate corpus */
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (bench_corpus(cb, nentries) < 0)
+        goto done;
+
+    /* 1. clixon_xml_parse_string */
+    iters = 20000000/nodes + 1;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xt, NULL) < 1)
+        goto done; /* warmup + keep as corpus tree */
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        xtmp = NULL;
+        t0 = bench_now();
+        if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xtmp, NULL) < 1)
+            goto done;
+        t += bench_now() - t0;
+        xml_free(xtmp);
+        xtmp = NULL;
+    }
+    bench_report("clixon_xml_parse_string", iters, t);
+
+    /* 2. xml_sort (recursive, on freshly parsed unsorted tree) */
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        if ((xtmp = xml_dup(xt)) == NULL)
+            goto done;
+        t0 = bench_now();
+        if (xml_sort_recurse(xtmp) < 0)
+            goto done;
+        t += bench_now() - t0;
+        if (i == 0){ /* keep one sorted corpus */
+            xs = xtmp;
+            xtmp = NULL;
+            continue;
+        }
+        xml_free(xtmp);
+        xtmp = NULL;
+    }
+    bench_report("xml_sort_recurse", iters, t);
+
+    /* 3. xml_cmp of two list entries */
+    iters = 1000000;
+    xe = xml_child_i_type(xml_find(xs, "table"), 0, CX_ELMNT);
+    t0 = bench_now();
+    for (i=0; i<iters; i++)
+        acc += xml_cmp(xe, xml_child_i_type(xml_find(xs, "table"), 1, CX_ELMNT),
+                       0, 0, NULL);
+    t = bench_now() - t0;
+    bench_report("xml_cmp", iters, t);
+
+    /* 4. xpath_vec: key lookup and full list scan */
+    iters = nentries < 2000 ? nentries : 2000;
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        t0 = bench_now();
+        if (xpath_vec(xs, NULL, "table/entry[name='e%08x']", &vec, &veclen,
+                      (uint32_t)i * 2654435761u) < 0)
+            goto done;
+        t += bench_now() - t0;
+        acc += veclen;
+        free(vec);
+        vec = NULL;
+    }
+    bench_report("xpath_vec key lookup", iters, t);
+    iters = 10000000/nodes + 1;
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        t0 = bench_now();
+        if (xpath_vec(xs, NULL, "table/entry", &vec, &veclen) < 0)
+            goto done;
+        t += bench_now() - t0;
+        acc += veclen;
+        free(vec);
+        vec = NULL;
+    }
+    bench_report("xpath_vec list scan", iters, t);
+
+    /* 5. xml_diff: one changed, one removed entry */
+    if ((xmod = xml_dup(xs)) == NULL)
+        goto done;
+    if ((xe = xpath_first(xmod, NULL, "table/entry[name='e%08x']/value",
+                          (uint32_t)1 * 2654435761u)) != NULL)
+        xml_value_set(xml_body_get(xe), "4711");
+    if ((xe = xpath_first(xmod, NULL, "table/entry[name='e%08x']",
+                          (uint32_t)2 * 2654435761u)) != NULL)
+        xml_purge(xe);
+    iters = 20000000/nodes + 1;
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        t0 = bench_now();
+        if (xml_diff(yspec, xs, xmod,
+                     &dvec1, &dlen1, &dvec2, &dlen2, &cvec1, &cvec2, &clen) < 0)
+            goto done;
+        t += bench_now() - t0;
+        if (dvec1){ free(dvec1); dvec1 = NULL; }
+        if (dvec2){ free(dvec2); dvec2 = NULL; }
+        if (cvec1){ free(cvec1); cvec1 = NULL; }
+        if (cvec2){ free(cvec2); cvec2 = NULL; }
+    }
+    bench_report("xml_diff", iters, t);
+
+    /* 6. clixon_json2cbuf */
+    iters = 20000000/nodes + 1;
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        cbuf_reset(cb); /* reuse corpus buffer, corpus itself no longer needed */
+        t0 = bench_now();
+        if (clixon_json2cbuf(cb, xs, 0, 0, 0) < 0)
+            goto done;
+        t += bench_now() - t0;
+    }
+    bench_report("clixon_json2cbuf", iters, t);
+
+    /* 7. xmldb_get0, uncached so that each read parses the file */
+    if (dbdir == NULL){
+        if (mkdtemp(dbdirbuf) == NULL){
+            clicon_err(OE_UNIX, errno, "mkdtemp");
+            goto done;
+        }
+        dbdir = dbdirbuf;
+    }
+    clicon_option_str_set(h, "CLICON_XMLDB_DIR", dbdir);
+    clicon_option_str_set(h, "CLICON_XMLDB_FORMAT", "xml");
+    clicon_option_str_set(h, "CLICON_DATASTORE_CACHE", "nocache");
+    if (xmldb_connect(h) < 0)
+        goto done;
+    if (xmldb_create(h, "running") < 0)
+        goto done;
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if (xml_name_set(xs, NETCONF_INPUT_CONFIG) < 0)
+        goto done;
+    if ((ret = xmldb_put(h, "running", OP_REPLACE, xs, NULL, cbret)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_DB, 0, "xmldb_put: %s", cbuf_get(cbret));
+        goto done;
+    }
+    iters = 20000000/nodes + 1;
+    t = 0.0;
+    for (i=0; i<iters; i++){
+        xtmp = NULL;
+        t0 = bench_now();
+        if (xmldb_get0(h, "running", YB_MODULE, NULL, "/", 1, 0, &xtmp, NULL, NULL) < 1)
+            goto done;
+        t += bench_now() - t0;
+        xmldb_get0_free(h, &xtmp);
+    }
+    bench_report("xmldb_get0 nocache", iters, t);
+    xmldb_disconnect(h);
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        fprintf(stdout, "max rss: %ld kB\n", (long)ru.ru_maxrss);
+    if (acc == 42) /* defeat optimizing out the cmp/xpath loops */
+        fprintf(stdout, "\n");
+    retval = 0;
+  done:
+    if (vec)
+        free(vec);
+    if (xtmp)
+        xml_free(xtmp);
+    if (xmod)
+        xml_free(xmod);
+    if (xs)
+        xml_free(xs);
+    if (xt)
+        xml_free(xt);
+    if (cbret)
+        cbuf_free(cbret);
+    if (cb)
+        cbuf_free(cb);
+    if (h)
+        clicon_handle_exit(h);
+    if (yspec)
+        ys_free(yspec);
+    return retval;
+}
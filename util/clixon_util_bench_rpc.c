@@ -0,0 +1,506 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2009-2019 Olof Hagsand
+  Copyright (C) 2020-2022 Olof Hagsand and Rubicon Communications, LLC(Netgate)
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+  * Load generator for the backend IPC socket: opens N concurrent sessions
+  * (one forked worker each), replays a get/edit/commit mix against a running
+  * clixon_backend and reports latency percentiles per operation type.
+  * Precondition:
+  * The backend must have been started using socket path given as -s.
+  * Edits need a template file (-e) with config XML valid under the yang
+  * loaded by that backend; a %d in the template is replaced by a unique
+  * sequence number so replicated list entries do not collide.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <syslog.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon/clixon.h"
+
+/* Command line options to be passed to getopt(3) */
+#define BENCH_RPC_OPTS "hD:a:s:c:n:m:e:z:i:"
+
+/* Operation types in the replayed mix */
+enum bench_op{
+    BENCH_GET = 0,
+    BENCH_EDIT,
+    BENCH_COMMIT,
+    BENCH_NOP
+};
+static const char *bench_op_name[] = {"get", "edit", "commit"};
+
+static int
+usage(char *argv0)
+{
+    fprintf(stderr, "usage:%s [options]\n"
+            "where options are\n"
+            "\t-h \t\tHelp\n"
+            "\t-D <level> \tDebug\n"
+            "\t-a <family>\tSocket address family (default UNIX)\n"
+            "\t-s <sockpath> \tPath to unix domain socket (or IP addr)\n"
+            "\t-c <n> \t\tConcurrent sessions, one worker process each (default 1)\n"
+            "\t-n <n> \t\tTotal number of requests over all sessions (default 100)\n"
+            "\t-m <g,e,c> \tMix ratio get,edit,commit (default 1,0,0)\n"
+            "\t-e <file> \tEdit-config payload template, %%d replaced by sequence nr\n"
+            "\t-z <n> \t\tCopies of the template per edit, scales payload size (default 1)\n"
+            "\t-i <usec> \tPacing: sleep between requests in each session (default 0)\n",
+            argv0);
+    exit(0);
+}
+
+/*! Build the netconf rpc for one operation in the mix
+ *
+ * @param[in]  op     Operation type
+ * @param[in]  tmpl   Edit payload template (op=edit), %d expanded with seq
+ * @param[in]  copies Nr of template copies per edit
+ * @param[in]  seq    First sequence number for this edit
+ * @param[out] cb     Rpc body appended here
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+bench_rpc_build(enum bench_op op,
+                char         *tmpl,
+                int           copies,
+                int           seq,
+                cbuf         *cb)
+{
+    int   retval = -1;
+    char *buf = NULL;
+    int   len;
+    int   j;
+
+    cprintf(cb, "<rpc xmlns=\"%s\">", NETCONF_BASE_NAMESPACE);
+    switch (op){
+    case BENCH_GET:
+        cprintf(cb, "<get-config><source><running/></source></get-config>");
+        break;
+    case BENCH_EDIT:
+        cprintf(cb, "<edit-config><target><candidate/></target><config>");
+        len = strlen(tmpl) + 32;
+        if ((buf = malloc(len)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        for (j=0; j<copies; j++){
+            snprintf(buf, len, tmpl, seq+j);
+            cprintf(cb, "%s", buf);
+        }
+        cprintf(cb, "</config></edit-config>");
+        break;
+    case BENCH_COMMIT:
+        cprintf(cb, "<commit/>");
+        break;
+    default:
+        break;
+    }
+    cprintf(cb, "</rpc>");
+    retval = 0;
+ done:
+    if (buf)
+        free(buf);
+    return retval;
+}
+
+/*! Worker: one session replaying its share of the mix, latencies to resfile
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  family  Socket address family, UNIX or inet
+ * @param[in]  sockpath Unix socket path or IP address
+ * @param[in]  nreq    Nr of requests this worker makes
+ * @param[in]  pace    Sleep in us between requests, 0 for none
+ * @param[in]  sched   Operation schedule, cycled through
+ * @param[in]  schedlen Length of sched
+ * @param[in]  tmpl    Edit payload template or NULL
+ * @param[in]  copies  Template copies per edit
+ * @param[in]  seq0    First sequence number for this worker's edits
+ * @param[in]  resfile File to write "<op> <usec> <err>" lines to
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+bench_worker(clicon_handle h,
+             char         *family,
+             char         *sockpath,
+             int           nreq,
+             int           pace,
+             char         *sched,
+             int           schedlen,
+             char         *tmpl,
+             int           copies,
+             int           seq0,
+             char         *resfile)
+{
+    int                retval = -1;
+    int                s = -1;
+    FILE              *fres = NULL;
+    cbuf              *cb = NULL;
+    struct clicon_msg *msg = NULL;
+    char              *retdata = NULL;
+    struct timespec    t0;
+    struct timespec    t1;
+    uint64_t           usec;
+    enum bench_op      op;
+    int                seq = seq0;
+    int                eof = 0;
+    int                err;
+    int                i;
+
+    if ((fres = fopen(resfile, "w")) == NULL){
+        clicon_err(OE_UNIX, errno, "fopen(%s)", resfile);
+        goto done;
+    }
+    if (strcmp(family, "UNIX") == 0){
+        if (clicon_rpc_connect_unix(h, sockpath, &s) < 0)
+            goto done;
+    }
+    else
+        if (clicon_rpc_connect_inet(h, sockpath, 4535, &s) < 0)
+            goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i=0; i<nreq; i++){
+        op = sched[i % schedlen];
+        cbuf_reset(cb);
+        if (bench_rpc_build(op, tmpl, copies, seq, cb) < 0)
+            goto done;
+        if (op == BENCH_EDIT)
+            seq += copies;
+        if ((msg = clicon_msg_encode(getpid(), "%s", cbuf_get(cb))) == NULL)
+            goto done;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (clicon_rpc(s, msg, &retdata, &eof) < 0)
+            goto done;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (eof){
+            clicon_err(OE_PROTO, ESHUTDOWN, "backend closed the socket");
+            goto done;
+        }
+        usec = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000 + (t1.tv_nsec - t0.tv_nsec)/1000;
+        err = retdata && strstr(retdata, "<rpc-error>") != NULL;
+        fprintf(fres, "%d %" PRIu64 " %d\n", op, usec, err);
+        if (retdata){
+            free(retdata);
+            retdata = NULL;
+        }
+        free(msg);
+        msg = NULL;
+        if (pace)
+            usleep(pace);
+    }
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    if (retdata)
+        free(retdata);
+    if (cb)
+        cbuf_free(cb);
+    if (s != -1)
+        close(s);
+    if (fres)
+        fclose(fres);
+    return retval;
+}
+
+/*! qsort comparator for uint64 latencies
+ */
+static int
+latcmp(const void *a,
+       const void *b)
+{
+    uint64_t la = *(const uint64_t*)a;
+    uint64_t lb = *(const uint64_t*)b;
+
+    return la < lb ? -1 : la > lb;
+}
+
+/*! Print count, errors and latency percentiles for one operation type
+ *
+ * @param[in]  name Operation name
+ * @param[in]  lat  Latencies in us, sorted in-place
+ * @param[in]  n    Nr of latencies
+ * @param[in]  errs Nr of rpc-error replies
+ */
+static void
+bench_report(const char *name,
+             uint64_t   *lat,
+             int         n,
+             int         errs)
+{
+    if (n == 0)
+        return;
+    qsort(lat, n, sizeof(*lat), latcmp);
+    fprintf(stdout, "%-7s %7d ops %5d errs  min %" PRIu64 "  p50 %" PRIu64
+            "  p90 %" PRIu64 "  p99 %" PRIu64 "  max %" PRIu64 " us\n",
+            name, n, errs,
+            lat[0], lat[n/2], lat[(n*9)/10], lat[(n*99)/100], lat[n-1]);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    int             retval = -1;
+    char           *argv0 = argv[0];
+    clicon_handle   h = NULL;
+    char           *sockpath = NULL;
+    char           *family = "UNIX";
+    char           *edit_file = NULL;
+    char           *tmpl = NULL;
+    int             concurrent = 1;
+    int             ntotal = 100;
+    int             copies = 1;
+    int             pace = 0;
+    int             mix[3] = {1, 0, 0};
+    char           *sched = NULL;
+    int             schedlen;
+    char            resfile[128];
+    uint64_t       *lat[3] = {NULL, NULL, NULL};
+    int             nlat[3] = {0, 0, 0};
+    int             nerr[3] = {0, 0, 0};
+    struct timespec t0;
+    struct timespec t1;
+    uint64_t        wallus;
+    FILE           *fp = NULL;
+    struct stat     st;
+    pid_t          *pids = NULL;
+    int             status;
+    int             failed = 0;
+    int             nreq;
+    int             dbg = 0;
+    int             op;
+    int             c;
+    int             i;
+    int             w;
+
+    clicon_log_init("bench_rpc", LOG_DEBUG, CLICON_LOG_STDERR);
+    if ((h = clicon_handle_init()) == NULL)
+        goto done;
+    optind = 1;
+    opterr = 0;
+    while ((c = getopt(argc, argv, BENCH_RPC_OPTS)) != -1)
+        switch (c) {
+        case 'h':
+            usage(argv0);
+            break;
+        case 'D':
+            if (sscanf(optarg, "%d", &dbg) != 1)
+                usage(argv0);
+            break;
+        case 'a':
+            family = optarg;
+            break;
+        case 's':
+            sockpath = optarg;
+            break;
+        case 'c':
+            if (sscanf(optarg, "%d", &concurrent) != 1 || concurrent < 1)
+                usage(argv0);
+            break;
+        case 'n':
+            if (sscanf(optarg, "%d", &ntotal) != 1 || ntotal < 1)
+                usage(argv0);
+            break;
+        case 'm':
+            if (sscanf(optarg, "%d,%d,%d", &mix[0], &mix[1], &mix[2]) != 3 ||
+                mix[0] < 0 || mix[1] < 0 || mix[2] < 0 ||
+                mix[0]+mix[1]+mix[2] == 0)
+                usage(argv0);
+            break;
+        case 'e':
+            edit_file = optarg;
+            break;
+        case 'z':
+            if (sscanf(optarg, "%d", &copies) != 1 || copies < 1)
+                usage(argv0);
+            break;
+        case 'i':
+            if (sscanf(optarg, "%d", &pace) != 1 || pace < 0)
+                usage(argv0);
+            break;
+        default:
+            usage(argv0);
+            break;
+        }
+    clicon_log_init("bench_rpc", dbg?LOG_DEBUG:LOG_INFO, CLICON_LOG_STDERR);
+    clicon_debug_init(dbg, NULL);
+    if (sockpath == NULL){
+        fprintf(stderr, "Mandatory option missing: -s <sockpath>\n");
+        usage(argv0);
+    }
+    if (mix[BENCH_EDIT] > 0 && edit_file == NULL){
+        fprintf(stderr, "Edit ratio > 0 needs a payload template: -e <file>\n");
+        usage(argv0);
+    }
+    if (edit_file){
+        if (stat(edit_file, &st) < 0){
+            clicon_err(OE_UNIX, errno, "stat(%s)", edit_file);
+            goto done;
+        }
+        if ((tmpl = malloc(st.st_size + 1)) == NULL){
+            clicon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        if ((fp = fopen(edit_file, "r")) == NULL){
+            clicon_err(OE_UNIX, errno, "fopen(%s)", edit_file);
+            goto done;
+        }
+        if (fread(tmpl, 1, st.st_size, fp) != (size_t)st.st_size){
+            clicon_err(OE_UNIX, errno, "fread(%s)", edit_file);
+            goto done;
+        }
+        tmpl[st.st_size] = '\0';
+        fclose(fp);
+        fp = NULL;
+    }
+    /* Cyclic schedule realizing the mix ratio deterministically */
+    schedlen = mix[0] + mix[1] + mix[2];
+    if ((sched = malloc(schedlen)) == NULL){
+        clicon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    i = 0;
+    for (op=0; op<3; op++)
+        for (c=0; c<mix[op]; c++)
+            sched[i++] = op;
+    if ((pids = calloc(concurrent, sizeof(*pids))) == NULL){
+        clicon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (w=0; w<concurrent; w++){
+        /* Spread the total over the workers, first gets the remainder */
+        nreq = ntotal/concurrent + (w == 0 ? ntotal%concurrent : 0);
+        if (nreq == 0)
+            continue;
+        snprintf(resfile, sizeof(resfile), "/tmp/clixon_bench_rpc_%u_%d",
+                 (unsigned)getpid(), w);
+        if ((pids[w] = fork()) < 0){
+            clicon_err(OE_UNIX, errno, "fork");
+            goto done;
+        }
+        if (pids[w] == 0){ /* child */
+            if (bench_worker(h, family, sockpath, nreq, pace,
+                             sched, schedlen, tmpl, copies,
+                             w*ntotal*copies, resfile) < 0)
+                _exit(1);
+            _exit(0);
+        }
+    }
+    for (w=0; w<concurrent; w++){
+        if (pids[w] == 0)
+            continue;
+        if (waitpid(pids[w], &status, 0) < 0){
+            clicon_err(OE_UNIX, errno, "waitpid");
+            goto done;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    wallus = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000 + (t1.tv_nsec - t0.tv_nsec)/1000;
+    /* Aggregate the per-worker result files */
+    for (op=0; op<3; op++)
+        if ((lat[op] = calloc(ntotal, sizeof(uint64_t))) == NULL){
+            clicon_err(OE_UNIX, errno, "calloc");
+            goto done;
+        }
+    for (w=0; w<concurrent; w++){
+        uint64_t usec;
+        int      err;
+
+        snprintf(resfile, sizeof(resfile), "/tmp/clixon_bench_rpc_%u_%d",
+                 (unsigned)getpid(), w);
+        if ((fp = fopen(resfile, "r")) == NULL)
+            continue; /* worker failed before writing */
+        while (fscanf(fp, "%d %" SCNu64 " %d", &op, &usec, &err) == 3){
+            if (op < 0 || op > 2 || nlat[op] >= ntotal)
+                break;
+            lat[op][nlat[op]++] = usec;
+            nerr[op] += err;
+        }
+        fclose(fp);
+        fp = NULL;
+        unlink(resfile);
+    }
+    if (failed){
+        fprintf(stderr, "%d worker(s) failed: %s\n", failed, clicon_err_reason);
+        goto done;
+    }
+    for (op=0; op<3; op++)
+        bench_report(bench_op_name[op], lat[op], nlat[op], nerr[op]);
+    i = nlat[0] + nlat[1] + nlat[2];
+    fprintf(stdout, "total   %7d ops in %" PRIu64 ".%06" PRIu64 "s, %" PRIu64 " req/s, %d sessions\n",
+            i, wallus/1000000, wallus%1000000,
+            wallus ? (uint64_t)i*1000000/wallus : 0, concurrent);
+    retval = 0;
+ done:
+    for (op=0; op<3; op++)
+        if (lat[op])
+            free(lat[op]);
+    if (pids)
+        free(pids);
+    if (sched)
+        free(sched);
+    if (tmpl)
+        free(tmpl);
+    if (fp)
+        fclose(fp);
+    if (h)
+        clicon_handle_exit(h);
+    return retval;
+}
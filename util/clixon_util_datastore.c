@@ -95,12 +95,256 @@ usage(char *argv0)
             "\texists\n"
             "\tdelete\n"
             "\tinit\n"
+            "\tgenyang [<depth> [<fanout> [<keytype>]]]\n"
+            "\tgenxml <nr> [<depth> [<fanout> [<keytype>]]]\n"
+            "\tbench <nr> [<depth> [<fanout> [<keytype>]]]\n"
             ,
             argv0
             );
     exit(0);
 }
 
+/*! Monotonic timestamp in seconds, for the bench command
+ */
+static double
+scale_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/*! Generate a parameterized scaling yang module on cb
+ *
+ * Module clixon-scale: depth nested lists e0..e<depth-1>, each keyed by leaf k of
+ * keytype and carrying fanout string leafs l0..l<fanout-1> per entry.
+ * @param[out] cb      Module text appended here
+ * @param[in]  depth   Nr of nested list levels, >= 1
+ * @param[in]  fanout  Nr of string leafs per list entry
+ * @param[in]  keytype Yang type of the list keys, eg string or uint32
+ * @retval     0       OK
+ */
+static int
+scale_yang_gen(cbuf *cb,
+               int   depth,
+               int   fanout,
+               char *keytype)
+{
+    int d;
+    int f;
+
+    cprintf(cb, "module clixon-scale {\n");
+    cprintf(cb, "  yang-version 1.1;\n");
+    cprintf(cb, "  namespace \"urn:example:scale\";\n");
+    cprintf(cb, "  prefix cs;\n");
+    for (d=0; d<depth; d++){
+        cprintf(cb, "%*slist e%d {\n", 2*(d+1), "", d);
+        cprintf(cb, "%*s  key k;\n", 2*(d+1), "");
+        cprintf(cb, "%*s  leaf k { type %s; }\n", 2*(d+1), "", keytype);
+        for (f=0; f<fanout; f++)
+            cprintf(cb, "%*s  leaf l%d { type string; }\n", 2*(d+1), "", f);
+    }
+    for (d=depth; d>0; d--)
+        cprintf(cb, "%*s}\n", 2*d, "");
+    cprintf(cb, "}\n");
+    return 0;
+}
+
+/*! Generate one corpus list entry at level d, recursing down to depth
+ */
+static int
+scale_xml_entry(cbuf    *cb,
+                int      d,
+                int      depth,
+                int      fanout,
+                int      numeric,
+                uint32_t key)
+{
+    int f;
+
+    if (d == 0)
+        cprintf(cb, "<e0 xmlns=\"urn:example:scale\">");
+    else
+        cprintf(cb, "<e%d>", d);
+    if (numeric)
+        cprintf(cb, "<k>%u</k>", key);
+    else
+        cprintf(cb, "<k>k%08x</k>", key);
+    for (f=0; f<fanout; f++)
+        cprintf(cb, "<l%d>v%u</l%d>", f, key, f);
+    if (d+1 < depth)
+        if (scale_xml_entry(cb, d+1, depth, fanout, numeric, key) < 0)
+            return -1;
+    cprintf(cb, "</e%d>", d);
+    return 0;
+}
+
+/*! Generate conforming corpus config on cb: nr top-level entries in scrambled key order
+ *
+ * Each entry carries fanout leafs and a single chain of nested entries down to depth,
+ * so total size scales linearly in nr*depth*fanout. Scrambled keys make the input
+ * unsorted so that put/sort does real work.
+ */
+static int
+scale_xml_gen(cbuf *cb,
+              int   nr,
+              int   depth,
+              int   fanout,
+              char *keytype)
+{
+    int      i;
+    uint32_t scramble;
+    int      numeric;
+
+    numeric = strcmp(keytype, "string") != 0;
+    for (i=0; i<nr; i++){
+        /* Odd multiplier: bijective mod 2^31, top bit masked so values fit signed key types */
+        scramble = ((uint32_t)i * 2654435761u) & 0x7fffffff;
+        if (scale_xml_entry(cb, 0, depth, fanout, numeric, scramble) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Synthetic scaling corpus: generate yang/xml, or drive a timed put/get/copy cycle
+ *
+ * Reproduces datastore scaling behavior on parameterized corpora instead of
+ * production configs: nr list entries, depth nested levels, fanout leafs per entry,
+ * keys of a chosen yang type.
+ * @param[in] h      Clixon handle
+ * @param[in] argv0  Program name, for usage
+ * @param[in] argc   Nr of command args, including the command itself
+ * @param[in] argv   Command args: (genyang|genxml|bench) ...
+ * @param[in] db     Datastore name, used by bench
+ * @param[in] dbdir  Datastore directory, required by bench
+ * @retval    0      OK
+ * @retval    -1     Error
+ */
+static int
+scale_cmd(clicon_handle h,
+          char         *argv0,
+          int           argc,
+          char        **argv,
+          char         *db,
+          char         *dbdir)
+{
+    int        retval = -1;
+    char      *cmd = argv[0];
+    int        nr = 0;
+    int        depth = 1;
+    int        fanout = 3;
+    char      *keytype = "string";
+    int        argi = 1;
+    cbuf      *cb = NULL;
+    cbuf      *cbret = NULL;
+    yang_stmt *yspec = NULL;
+    cxobj     *xt = NULL;
+    cxobj     *xg = NULL;
+    int        ret;
+    double     t0;
+
+    if (strcmp(cmd, "genyang") != 0){
+        if (argc < 2)
+            usage(argv0);
+        if ((nr = atoi(argv[argi++])) <= 0)
+            usage(argv0);
+    }
+    if (argi < argc)
+        depth = atoi(argv[argi++]);
+    if (argi < argc)
+        fanout = atoi(argv[argi++]);
+    if (argi < argc)
+        keytype = argv[argi++];
+    if (depth < 1 || fanout < 0 || argi < argc)
+        usage(argv0);
+    if ((cb = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    if (strcmp(cmd, "genyang") == 0){
+        if (scale_yang_gen(cb, depth, fanout, keytype) < 0)
+            goto done;
+        fprintf(stdout, "%s", cbuf_get(cb));
+        retval = 0;
+        goto done;
+    }
+    if (strcmp(cmd, "genxml") == 0){
+        if (scale_xml_gen(cb, nr, depth, fanout, keytype) < 0)
+            goto done;
+        fprintf(stdout, "%s\n", cbuf_get(cb));
+        retval = 0;
+        goto done;
+    }
+    /* bench: generated model + corpus, timed xmldb put/get/copy cycle */
+    if (dbdir == NULL){
+        clicon_err(OE_DB, 0, "Missing dbdir -b option");
+        goto done;
+    }
+    if (scale_yang_gen(cb, depth, fanout, keytype) < 0)
+        goto done;
+    if ((yspec = yspec_new()) == NULL)
+        goto done;
+    if (yang_parse_str(cbuf_get(cb), "clixon-scale", yspec) == NULL)
+        goto done;
+    if (yang_parse_post(h, yspec, 0) < 0)
+        goto done;
+    clicon_option_str_set(h, "CLICON_XMLDB_DIR", dbdir);
+    clicon_dbspec_yang_set(h, yspec);
+    if (xmldb_connect(h) < 0)
+        goto done;
+    cbuf_reset(cb);
+    if (scale_xml_gen(cb, nr, depth, fanout, keytype) < 0)
+        goto done;
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_MODULE, yspec, &xt, NULL) < 1)
+        goto done;
+    if (xml_name_set(xt, NETCONF_INPUT_CONFIG) < 0)
+        goto done;
+    if ((cbret = cbuf_new()) == NULL){
+        clicon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    fprintf(stdout, "bench: %d entries, depth %d, fanout %d, key %s\n",
+            nr, depth, fanout, keytype);
+    t0 = scale_now();
+    if ((ret = xmldb_put(h, db, OP_REPLACE, xt, NULL, cbret)) < 0)
+        goto done;
+    if (ret == 0){
+        clicon_err(OE_DB, 0, "xmldb_put: %s", cbuf_get(cbret));
+        goto done;
+    }
+    fprintf(stdout, "xmldb_put replace: %10.3f s\n", scale_now()-t0);
+    t0 = scale_now();
+    if (xmldb_get(h, db, NULL, "/", &xg) < 0)
+        goto done;
+    fprintf(stdout, "xmldb_get /:       %10.3f s\n", scale_now()-t0);
+    if (xg){
+        xml_free(xg);
+        xg = NULL;
+    }
+    t0 = scale_now();
+    if (xmldb_copy(h, db, "scale_copy") < 0)
+        goto done;
+    fprintf(stdout, "xmldb_copy:        %10.3f s\n", scale_now()-t0);
+    if (xmldb_delete(h, "scale_copy") < 0)
+        goto done;
+    if (xmldb_disconnect(h) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (xg)
+        xml_free(xg);
+    if (xt)
+        xml_free(xt);
+    if (cbret)
+        cbuf_free(cbret);
+    if (cb)
+        cbuf_free(cb);
+    if (yspec)
+        ys_free(yspec);
+    return retval;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -188,6 +432,14 @@ main(int argc, char **argv)
     if (argc < 1)
         usage(argv0);
     cmd = argv[0];
+    /* Scaling corpus commands generate their own yang model, no -y needed */
+    if (strcmp(cmd, "genyang") == 0 || strcmp(cmd, "genxml") == 0 ||
+        strcmp(cmd, "bench") == 0){
+        if (scale_cmd(h, argv0, argc, argv, db, dbdir) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     if (dbdir == NULL){
         clicon_err(OE_DB, 0, "Missing dbdir -b option");
         goto done;
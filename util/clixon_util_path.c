@@ -47,11 +47,20 @@
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/stat.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define BENCH_MALLINFO /* mallinfo2(3) available for allocation stats */
+#endif
+#endif
+
 /* cligen */
 #include <cligen/cligen.h>
 
@@ -59,7 +68,7 @@
 #include "clixon/clixon.h"
 
 /* Command line options to be passed to getopt(3) */
-#define UTIL_PATH_OPTS "hD:f:ap:y:Y:n:"
+#define UTIL_PATH_OPTS "hD:f:ap:y:Y:n:b:w:"
 
 static int
 usage(char *argv0)
@@ -74,6 +83,8 @@ usage(char *argv0)
             "\t-y <filename> \tYang filename or dir (load all files)\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
             "\t-n <n>   \tRepeat the call n times(for profiling)\n"
+            "\t-b <n>   \tBenchmark: time <n> iterations of parse and eval, print ns/op\n"
+            "\t-w <n>   \tBenchmark warmup iterations before timing (use with -b)\n"
             "and the following extra rules:\n"
             "\tif -f is not given, XML input is expected on stdin\n"
             "\tif -p is not given, <path> is expected as the first line on stdin\n"
@@ -83,6 +94,142 @@ usage(char *argv0)
     exit(0);
 }
 
+/*! Net bytes currently allocated from the heap, 0 where unsupported
+ */
+static int64_t
+bench_memuse(void)
+{
+#ifdef BENCH_MALLINFO
+    struct mallinfo2 mi;
+
+    mi = mallinfo2();
+    return (int64_t)mi.uordblks + (int64_t)mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/*! Benchmark path parse and eval phases over a loaded corpus
+ *
+ * The parse phase is instance-id parsing (or api-path to xpath translation
+ * with -a), the eval phase is the full find call as the main program does it.
+ * Each phase runs nr timed iterations after untimed warmup rounds; ns/op and
+ * heap bytes held by one result are printed (bytes are 0 without mallinfo2).
+ * @param[in]  x          XML tree to search
+ * @param[in]  yspec      Yang spec
+ * @param[in]  path       Api-path or instance-id
+ * @param[in]  api_path_p 0: instance-id, 1: api-path
+ * @param[in]  nr         Number of timed iterations
+ * @param[in]  warmup     Untimed iterations run first
+ * @retval     0          OK
+ * @retval    -1          Error
+ */
+static int
+bench_path(cxobj     *x,
+           yang_stmt *yspec,
+           char      *path,
+           int        api_path_p,
+           int        nr,
+           int        warmup)
+{
+    int             retval = -1;
+    struct timespec t0 = {0, 0};
+    struct timespec t1 = {0, 0};
+    uint64_t        ns;
+    int64_t         mem0 = 0;
+    clixon_path    *cplist = NULL;
+    char           *xpath = NULL;
+    cvec           *nsc = NULL;
+    cxobj         **xvec = NULL;
+    int             xlen = 0;
+    int             ret;
+    int             i;
+
+    for (i=0; i<warmup+nr+1; i++){
+        if (i == warmup) /* timed iterations start here */
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (i == warmup+nr){ /* one extra op for the allocation snapshot */
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            mem0 = bench_memuse();
+        }
+        if (api_path_p){
+            if (api_path2xpath(path, yspec, &xpath, &nsc, NULL) < 0)
+                goto done;
+        }
+        else{
+            if (clixon_instance_id_parse(yspec, &cplist, NULL, "%s", path) < 0)
+                goto done;
+        }
+        if (i < warmup+nr){
+            if (xpath){
+                free(xpath);
+                xpath = NULL;
+            }
+            if (nsc){
+                xml_nsctx_free(nsc);
+                nsc = NULL;
+            }
+            if (cplist){
+                clixon_path_free(cplist);
+                cplist = NULL;
+            }
+        }
+    }
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000000 + (t1.tv_nsec - t0.tv_nsec);
+    fprintf(stdout, "parse: %d ops %" PRIu64 " ns/op %" PRId64 " bytes live/op\n",
+            nr, ns/nr, bench_memuse() - mem0);
+    if (xpath){
+        free(xpath);
+        xpath = NULL;
+    }
+    if (nsc){
+        xml_nsctx_free(nsc);
+        nsc = NULL;
+    }
+    if (cplist){
+        clixon_path_free(cplist);
+        cplist = NULL;
+    }
+    /* Eval phase: the full find call (includes a parse of the expression) */
+    for (i=0; i<warmup+nr+1; i++){
+        if (i == warmup)
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (i == warmup+nr){
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            mem0 = bench_memuse();
+        }
+        if (api_path_p)
+            ret = clixon_xml_find_api_path(x, yspec, &xvec, &xlen, "%s", path);
+        else
+            ret = clixon_xml_find_instance_id(x, yspec, &xvec, &xlen, "%s", path);
+        if (ret < 0)
+            goto done;
+        if (ret == 0){
+            fprintf(stderr, "Fail %d %s\n", clicon_errno, clicon_err_reason);
+            goto done;
+        }
+        if (i < warmup+nr && xvec){
+            free(xvec);
+            xvec = NULL;
+            xlen = 0;
+        }
+    }
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000000 + (t1.tv_nsec - t0.tv_nsec);
+    fprintf(stdout, "eval:  %d ops %" PRIu64 " ns/op %" PRId64 " bytes live/op\n",
+            nr, ns/nr, bench_memuse() - mem0);
+    retval = 0;
+ done:
+    if (xpath)
+        free(xpath);
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (cplist)
+        clixon_path_free(cplist);
+    if (xvec)
+        free(xvec);
+    return retval;
+}
+
 int
 main(int    argc,
      char **argv)
@@ -111,6 +258,8 @@ main(int    argc,
     cxobj        *xerr = NULL; /* malloced must be freed */
     int           nr = 1;
     int           dbg = 0;
+    int           bench = 0;
+    int           warmup = 0;
         
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init("api-path", LOG_DEBUG, CLICON_LOG_STDERR); 
@@ -157,6 +306,14 @@ main(int    argc,
         case 'n':
             nr = atoi(optarg);
             break;
+        case 'b': /* Benchmark iterations */
+            if (sscanf(optarg, "%d", &bench) != 1 || bench < 1)
+                usage(argv0);
+            break;
+        case 'w': /* Benchmark warmup iterations */
+            if (sscanf(optarg, "%d", &warmup) != 1 || warmup < 0)
+                usage(argv0);
+            break;
         default:
             usage(argv[0]);
             break;
@@ -261,6 +418,13 @@ main(int    argc,
         }
 
     }
+    /* Benchmark mode: time parse/eval phases, skip result printing */
+    if (bench){
+        if (bench_path(x, yspec, path, api_path_p, bench, warmup) < 0)
+            goto done;
+        retval = 0;
+        goto done;
+    }
     /* Repeat for performance profiling (default is nr = 1) */
     xvec = NULL;
     for (i=0; i<nr; i++){
@@ -48,11 +48,20 @@ See https://www.w3.org/TR/xpath/
 #include <string.h>
 #include <limits.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/stat.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define BENCH_MALLINFO /* mallinfo2(3) available for allocation stats */
+#endif
+#endif
+
 /* cligen */
 #include <cligen/cligen.h>
 
@@ -60,7 +69,7 @@ See https://www.w3.org/TR/xpath/
 #include "clixon/clixon.h"
 
 /* Command line options to be passed to getopt(3) */
-#define XPATH_OPTS "hD:f:p:i:In:cl:y:Y:"
+#define XPATH_OPTS "hD:f:p:i:IEn:cl:y:Y:b:w:"
 
 static int
 usage(char *argv0)
@@ -73,11 +82,14 @@ usage(char *argv0)
             "\t-p <xpath> \tPrimary XPATH string\n"
             "\t-i <xpath0>\t(optional) Initial XPATH string\n"
             "\t-I \t\tCheck inverse, map back xml result to xpath and check if equal\n"
+            "\t-E \t\tExplain: print parsed plan, binary-search fastpath eligibility and measured eval\n"
             "\t-n <pfx:id>\tNamespace binding (pfx=NULL for default)\n"
             "\t-c \t\tMap xpath to canonical form\n"
             "\t-l <s|e|o|f<file>> \tLog on (s)yslog, std(e)rr, std(o)ut or (f)ile (stderr is default)\n"
             "\t-y <filename> \tYang filename or dir (load all files)\n"
             "\t-Y <dir> \tYang dirs (can be several)\n"
+            "\t-b <n> \tBenchmark: time <n> iterations of parse and eval, print ns/op\n"
+            "\t-w <n> \tBenchmark warmup iterations before timing (use with -b)\n"
             "and the following extra rules:\n"
             "\tif -f is not given, XML input is expected on stdin\n"
             "\tif -p is not given, <xpath> is expected as the first line on stdin\n"
@@ -118,6 +130,102 @@ ctx_print2(cbuf   *cb,
     return retval;
 }
 
+/*! Net bytes currently allocated from the heap, 0 where unsupported
+ */
+static int64_t
+bench_memuse(void)
+{
+#ifdef BENCH_MALLINFO
+    struct mallinfo2 mi;
+
+    mi = mallinfo2();
+    return (int64_t)mi.uordblks + (int64_t)mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+/*! Benchmark xpath parse and eval phases separately over a loaded corpus
+ *
+ * Each phase is timed over nr iterations after untimed warmup rounds. Besides
+ * ns/op, the heap bytes held by one parsed tree / one evaluated result are
+ * reported (0 on non-glibc where mallinfo2 is unavailable). Note that eval
+ * includes an internal parse of the expression.
+ * @param[in]  x       XML node to evaluate over
+ * @param[in]  nsc     Namespace context
+ * @param[in]  xpath   XPath expression
+ * @param[in]  nr      Number of timed iterations
+ * @param[in]  warmup  Untimed iterations run first
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+bench_xpath(cxobj *x,
+            cvec  *nsc,
+            char  *xpath,
+            int    nr,
+            int    warmup)
+{
+    int             retval = -1;
+    struct timespec t0;
+    struct timespec t1;
+    uint64_t        ns;
+    int64_t         mem0;
+    xpath_tree     *xpt = NULL;
+    xp_ctx         *xc = NULL;
+    int             i;
+
+    for (i=0; i<warmup; i++){
+        if (xpath_parse(xpath, &xpt) < 0)
+            goto done;
+        xpath_tree_free(xpt);
+        xpt = NULL;
+        if (xpath_vec_ctx(x, nsc, xpath, 0, &xc) < 0)
+            goto done;
+        ctx_free(xc);
+        xc = NULL;
+    }
+    /* Parse phase */
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i=0; i<nr; i++){
+        if (xpath_parse(xpath, &xpt) < 0)
+            goto done;
+        xpath_tree_free(xpt);
+        xpt = NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000000 + (t1.tv_nsec - t0.tv_nsec);
+    mem0 = bench_memuse();
+    if (xpath_parse(xpath, &xpt) < 0)
+        goto done;
+    fprintf(stdout, "parse: %d ops %" PRIu64 " ns/op %" PRId64 " bytes live/op\n",
+            nr, ns/nr, bench_memuse() - mem0);
+    xpath_tree_free(xpt);
+    xpt = NULL;
+    /* Eval phase */
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i=0; i<nr; i++){
+        if (xpath_vec_ctx(x, nsc, xpath, 0, &xc) < 0)
+            goto done;
+        ctx_free(xc);
+        xc = NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = (uint64_t)(t1.tv_sec - t0.tv_sec)*1000000000 + (t1.tv_nsec - t0.tv_nsec);
+    mem0 = bench_memuse();
+    if (xpath_vec_ctx(x, nsc, xpath, 0, &xc) < 0)
+        goto done;
+    fprintf(stdout, "eval:  %d ops %" PRIu64 " ns/op %" PRId64 " bytes live/op\n",
+            nr, ns/nr, bench_memuse() - mem0);
+    retval = 0;
+ done:
+    if (xpt)
+        xpath_tree_free(xpt);
+    if (xc)
+        ctx_free(xc);
+    return retval;
+}
+
 int
 main(int    argc,
      char **argv)
@@ -149,6 +257,9 @@ main(int    argc,
     int         logdst = CLICON_LOG_STDERR;
     int         dbg = 0;
     int         xpath_inverse = 0;
+    int         explain = 0;
+    int         bench = 0;
+    int         warmup = 0;
 
     /* In the startup, logs to stderr & debug flag set later */
     clicon_log_init("xpath", LOG_DEBUG, logdst); 
@@ -188,6 +299,9 @@ main(int    argc,
         case 'I': /* Check inverse */
             xpath_inverse++;
             break;
+        case 'E': /* Explain */
+            explain++;
+            break;
         case 'n':{ /* Namespace binding */
             char *prefix;
             char *id;
@@ -226,11 +340,19 @@ main(int    argc,
             if (clicon_option_add(h, "CLICON_YANG_DIR", optarg) < 0)
                 goto done;
             break;
+        case 'b': /* Benchmark iterations */
+            if (sscanf(optarg, "%d", &bench) != 1 || bench < 1)
+                usage(argv0);
+            break;
+        case 'w': /* Benchmark warmup iterations */
+            if (sscanf(optarg, "%d", &warmup) != 1 || warmup < 0)
+                usage(argv0);
+            break;
         default:
             usage(argv[0]);
             break;
         }
-    /* 
+    /*
      * Logs, error and debug to stderr or syslog, set debug level
      */
     clicon_log_init("xpath", dbg?LOG_DEBUG:LOG_INFO, logdst);
@@ -367,6 +489,23 @@ main(int    argc,
     }
     else
         x = x0;
+    /* Benchmark mode: time parse/eval phases, skip result printing */
+    if (bench){
+        if (bench_xpath(x, nsc, xpath, bench, warmup) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Explain mode: plan, fastpath eligibility and measured eval, no result printing */
+    if (explain){
+        if ((cb = cbuf_new()) == NULL){
+            clicon_err(OE_XML, errno, "cbuf_new");
+            goto done;
+        }
+        if (xpath_explain(x, nsc, xpath, cb) < 0)
+            goto done;
+        fprintf(stdout, "%s", cbuf_get(cb));
+        goto ok;
+    }
 #if 0 // filter syntax errors
     {
         xpath_tree *xptree = NULL;